@@ -1,5 +1,7 @@
 #include "AudioBufferStore.hpp"
 #include "grove/common/common.hpp"
+#include <algorithm>
+#include <chrono>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -16,80 +18,166 @@ AudioBufferChunk make_single_chunk(const AudioBufferDescriptor& descriptor, unsi
   return result;
 }
 
+//  The handle's backing memory is freed only once the removal is adopted by the render thread, so
+//  a handle can be present in the backing store but already pending removal.
+template <typename BackingStore, typename Commands>
+bool can_remove(const BackingStore& store, const Commands& pending, AudioBufferHandle handle) {
+  if (store.count(handle) == 0) {
+    return false;
+  }
+  for (auto& pend : pending) {
+    if (pend.handle == handle && pend.ui_remove_future) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr auto io_idle_sleep_duration = std::chrono::milliseconds(2);
+
 } //  anon
 
+AudioBufferStore::~AudioBufferStore() {
+  io_thread_keep_running.store(false);
+  if (io_thread.joinable()) {
+    io_thread.join();
+  }
+}
+
 bool AudioBufferStore::ui_list(std::vector<BufferInfo>& into) const {
-  if (in_memory_audio_buffer_accessor.writer_can_modify()) {
-    //  I.e., we're not waiting for the audio thread to swap read and write pointers.
-    for (auto& [handle, chunk] : *in_memory_audio_buffer_accessor.writer_ptr()) {
-      BufferInfo info{};
-      info.descriptor = chunk.descriptor;
-      info.handle = handle;
-      into.push_back(info);
-    }
+  for (auto& [handle, chunk] : in_memory_audio_buffer_accessor.writer_read()) {
+    BufferInfo info{};
+    info.descriptor = chunk.descriptor;
+    info.handle = handle;
+    into.push_back(info);
+  }
 
-    return true;
-  } else {
-    return false;
+  for (auto& [handle, stream] : streaming_audio_buffer_accessor.writer_read()) {
+    BufferInfo info{};
+    info.descriptor = stream->get_descriptor();
+    info.handle = handle;
+    into.push_back(info);
   }
+
+  return true;
 }
 
 void AudioBufferStore::ui_update() {
-  if (!pending_ui_submit.empty()) {
-    if (auto* write_to = in_memory_audio_buffer_accessor.writer_begin_modification()) {
-      for (auto& pend : pending_ui_submit) {
-        if (pend.handle.backing_store_type == BackingStoreType::InMemory) {
-          //  In memory backing store.
-          if (pend.type == CommandType::Add) {
-            auto chunk = make_single_chunk(pend.descriptor, pend.data);
-            //  Add the chunk to the writer's buffer store.
-            write_to->emplace(pend.handle, chunk);
-
-          } else if (pend.type == CommandType::Remove) {
-            if (write_to->erase(pend.handle) > 0) {
-              pend.ui_remove_future->data.success = true;
-            } else {
-              //  No such handle.
-              pend.ui_remove_future->data.success = false;
-            }
-          } else {
-            //  Other command types not handled.
-            assert(false);
-          }
-          //  Wait for confirmation from the audio thread.
-          pending_reader_swap.push_back(pend);
-        } else {
-          //  Other backing store types not yet implemented.
-          assert(false);
-        }
-      }
+  for (auto& pend : pending_ui_submit) {
+    if (pend.handle.backing_store_type == BackingStoreType::InMemory) {
+      //  In memory backing store.
+      auto& accessor = in_memory_audio_buffer_accessor;
+      InMemoryAccessor::Op op{pend.handle, {}, false};
 
-      pending_ui_submit.clear();
-    }
-  }
-
-  auto update_res = in_memory_audio_buffer_accessor.writer_update();
-  if (update_res.changed) {
-    //  The audio thread has now seen all pending modifications.
-    for (auto& pend : pending_reader_swap) {
       if (pend.type == CommandType::Add) {
-        pend.ui_add_future->mark_ready();
+        op.value = make_single_chunk(pend.descriptor, pend.data);
 
       } else if (pend.type == CommandType::Remove) {
-        //  Free memory.
-        in_memory_backing_store.erase(pend.handle);
-        pend.ui_remove_future->mark_ready();
+        //  False if no such handle.
+        pend.ui_remove_future->data.success =
+          can_remove(in_memory_backing_store, pending_reader_swap, pend.handle);
+        op.remove = true;
 
       } else {
+        //  Other command types not handled.
         assert(false);
       }
+
+      //  Wait for confirmation from the audio thread.
+      pend.epoch = accessor.writer_epoch();
+      accessor.writer_push(op);
+      pending_reader_swap.push_back(pend);
+
+    } else if (pend.handle.backing_store_type == BackingStoreType::File) {
+      //  Streaming backing store.
+      auto& accessor = streaming_audio_buffer_accessor;
+      StreamingAccessor::Op op{pend.handle, pend.stream, false};
+
+      if (pend.type == CommandType::Remove) {
+        pend.ui_remove_future->data.success =
+          can_remove(streaming_backing_store, pending_streaming_reader_swap, pend.handle);
+        op.remove = true;
+      } else {
+        assert(pend.type == CommandType::Add);
+      }
+
+      pend.epoch = accessor.writer_epoch();
+      accessor.writer_push(op);
+      pending_streaming_reader_swap.push_back(pend);
+
+    } else {
+      //  Other backing store types not yet implemented.
+      assert(false);
     }
-    pending_reader_swap.clear();
   }
+  pending_ui_submit.clear();
+
+  ui_update_in_memory_adopted();
+  ui_update_streaming_adopted();
+}
+
+void AudioBufferStore::ui_update_in_memory_adopted() {
+  const uint64_t adopted_epoch = in_memory_audio_buffer_accessor.writer_update().adopted_epoch;
+
+  auto it = pending_reader_swap.begin();
+  for (; it != pending_reader_swap.end() && it->epoch <= adopted_epoch; ++it) {
+    //  The audio thread has now seen this modification.
+    if (it->type == CommandType::Add) {
+      it->ui_add_future->mark_ready();
+
+    } else if (it->type == CommandType::Remove) {
+      //  Free memory.
+      if (it->ui_remove_future->data.success) {
+        in_memory_backing_store.erase(it->handle);
+      }
+      it->ui_remove_future->mark_ready();
+
+    } else {
+      assert(false);
+    }
+  }
+  pending_reader_swap.erase(pending_reader_swap.begin(), it);
+}
+
+void AudioBufferStore::ui_update_streaming_adopted() {
+  const uint64_t adopted_epoch = streaming_audio_buffer_accessor.writer_update().adopted_epoch;
+
+  auto it = pending_streaming_reader_swap.begin();
+  for (; it != pending_streaming_reader_swap.end() && it->epoch <= adopted_epoch; ++it) {
+    if (it->type == CommandType::Add) {
+      it->ui_add_future->mark_ready();
+
+    } else if (it->type == CommandType::Remove) {
+      //  The render thread no longer refers to the stream; detach it from the I/O thread
+      //  before freeing it.
+      auto store_it = streaming_backing_store.find(it->handle);
+      if (it->ui_remove_future->data.success && store_it != streaming_backing_store.end()) {
+        {
+          std::lock_guard<std::mutex> lock{io_mutex};
+          auto io_it = std::find(io_streams.begin(), io_streams.end(), store_it->second.get());
+          if (io_it != io_streams.end()) {
+            io_streams.erase(io_it);
+          }
+        }
+        streaming_backing_store.erase(store_it);
+      }
+      it->ui_remove_future->mark_ready();
+
+    } else {
+      assert(false);
+    }
+  }
+  pending_streaming_reader_swap.erase(pending_streaming_reader_swap.begin(), it);
 }
 
 void AudioBufferStore::render_update() {
   in_memory_audio_buffer_accessor.reader_maybe_swap();
+  streaming_audio_buffer_accessor.reader_maybe_swap();
+
+  //  Chunks handed out during the previous render quantum are no longer referenced.
+  for (auto& [handle, stream] : streaming_audio_buffer_accessor.read()) {
+    stream->render_release_slots();
+  }
 }
 
 std::unique_ptr<Future<AudioBufferHandle>>
@@ -122,6 +210,40 @@ AudioBufferStore::ui_add_in_memory(const AudioBufferDescriptor& descriptor, cons
   return ui_add_in_memory(descriptor, std::move(to_store));
 }
 
+std::unique_ptr<Future<AudioBufferHandle>>
+AudioBufferStore::ui_add_streaming(const std::string& file_path) {
+  auto stream = StreamingAudioBuffer::open(file_path);
+  if (!stream) {
+    return nullptr;
+  }
+
+  auto* stream_ptr = stream.get();
+  AudioBufferHandle handle{next_buffer_handle_id++, audio::BufferBackingStoreType::File};
+  streaming_backing_store[handle] = std::move(stream);
+
+  {
+    //  Begin prefetching right away.
+    std::lock_guard<std::mutex> lock{io_mutex};
+    io_streams.push_back(stream_ptr);
+  }
+  if (!io_thread.joinable()) {
+    start_io_thread();
+  }
+
+  auto fut = std::make_unique<Future<AudioBufferHandle>>();
+  fut->data = handle;
+
+  Command command{};
+  command.type = CommandType::Add;
+  command.stream = stream_ptr;
+  command.handle = handle;
+  command.descriptor = stream_ptr->get_descriptor();
+  command.ui_add_future = fut.get();
+
+  pending_ui_submit.push_back(command);
+  return fut;
+}
+
 std::unique_ptr<Future<AudioBufferStore::RemoveResult>>
 AudioBufferStore::ui_remove(AudioBufferHandle handle) {
   auto fut = std::make_unique<Future<RemoveResult>>();
@@ -149,6 +271,15 @@ AudioBufferStore::render_get(AudioBufferHandle handle, uint64_t frame_begin, uin
     (void) frame_end;
     return Optional<AudioBufferChunk>(it->second);
 
+  } else if (handle.backing_store_type == BackingStoreType::File) {
+    const auto& store = streaming_audio_buffer_accessor.read();
+    auto it = store.find(handle);
+    if (it == store.end()) {
+      return NullOpt{};
+    } else {
+      return it->second->render_get(frame_begin, frame_end);
+    }
+
   } else {
     //  Not yet supported.
     return NullOpt{};
@@ -157,25 +288,52 @@ AudioBufferStore::render_get(AudioBufferHandle handle, uint64_t frame_begin, uin
 
 Optional<AudioBufferChunk> AudioBufferStore::ui_load(AudioBufferHandle handle) const {
   if (handle.backing_store_type == BackingStoreType::InMemory) {
-    if (in_memory_audio_buffer_accessor.writer_can_modify()) {
-      const auto& writer_store = *in_memory_audio_buffer_accessor.writer_ptr();
-      auto it = writer_store.find(handle);
-      if (it == writer_store.end()) {
-        return NullOpt{};
-      } else {
-        assert(it->second.is_complete());
-        return Optional<AudioBufferChunk>(it->second);
-      }
-    } else {
-      //  We're waiting for the audio thread to non-atomically swap the read and write pointers,
-      //  so it's not safe to access any part of the buffer.
+    const auto& writer_store = in_memory_audio_buffer_accessor.writer_read();
+    auto it = writer_store.find(handle);
+    if (it == writer_store.end()) {
       return NullOpt{};
+    } else {
+      assert(it->second.is_complete());
+      return Optional<AudioBufferChunk>(it->second);
     }
 
   } else {
-    //  Other types not yet handled.
+    //  Other types not yet handled. Streamed buffers are never fully resident.
     return NullOpt{};
   }
 }
 
+AudioBufferStore::StreamingStats AudioBufferStore::ui_get_streaming_stats() const {
+  StreamingStats result{};
+  for (auto& [handle, stream] : streaming_backing_store) {
+    auto stream_stats = stream->get_stats();
+    result.num_streams++;
+    result.num_misses += stream_stats.num_misses;
+    result.num_chunks_loaded += stream_stats.num_chunks_loaded;
+  }
+  return result;
+}
+
+void AudioBufferStore::start_io_thread() {
+  io_thread_keep_running.store(true);
+  io_thread = std::thread([this]() {
+    io_thread_loop();
+  });
+}
+
+void AudioBufferStore::io_thread_loop() {
+  while (io_thread_keep_running.load()) {
+    bool any_loaded{};
+    {
+      std::lock_guard<std::mutex> lock{io_mutex};
+      for (auto* stream : io_streams) {
+        any_loaded |= stream->io_update();
+      }
+    }
+    if (!any_loaded) {
+      std::this_thread::sleep_for(io_idle_sleep_duration);
+    }
+  }
+}
+
 GROVE_NAMESPACE_END
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "audio_buffer.hpp"
-#include "DoubleBuffer.hpp"
+#include "DeltaDoubleBuffer.hpp"
+#include "StreamingAudioBuffer.hpp"
 #include "grove/common/Future.hpp"
 #include "grove/common/Optional.hpp"
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -22,6 +27,13 @@ public:
     bool success{};
   };
 
+  struct StreamingStats {
+    int num_streams;
+    //  Number of `render_get` requests for a streamed range that was not yet loaded.
+    uint64_t num_misses;
+    uint64_t num_chunks_loaded;
+  };
+
 private:
   enum class CommandType {
     Add,
@@ -33,6 +45,10 @@ private:
     AudioBufferHandle handle;
     AudioBufferDescriptor descriptor;
     unsigned char* data{};
+    StreamingAudioBuffer* stream{};
+    //  The command's effect is visible to the render thread once the accessor's adopted epoch
+    //  reaches this value.
+    uint64_t epoch{};
 
     Future<AudioBufferHandle>* ui_add_future{};
     Future<RemoveResult>* ui_remove_future{};
@@ -45,19 +61,41 @@ private:
   using InMemoryBackingStore =
     std::unordered_map<AudioBufferHandle, std::unique_ptr<unsigned char[]>, AudioBufferHandle::Hash>;
 
-  struct InMemoryAccessorTraits {
-    //  Copy the map of in-memory chunks.
-    static inline InMemoryAudioBuffers_* on_reader_swap(InMemoryAudioBuffers_* write_to,
-                                                        const InMemoryAudioBuffers_* read_from) {
-      *write_to = *read_from;
-      return write_to;
+  template <typename Map>
+  struct MapAccessorTraits {
+    struct Op {
+      AudioBufferHandle handle;
+      typename Map::mapped_type value;
+      bool remove;
+    };
+
+    static void apply(Map& map, const Op& op) {
+      if (op.remove) {
+        map.erase(op.handle);
+      } else {
+        map[op.handle] = op.value;
+      }
     }
   };
 
   using InMemoryAccessor =
-    audio::DoubleBufferAccessor<InMemoryAudioBuffers_, InMemoryAccessorTraits>;
+    audio::DeltaDoubleBufferAccessor<InMemoryAudioBuffers_,
+                                     MapAccessorTraits<InMemoryAudioBuffers_>>;
+
+  using StreamingAudioBuffers_ =
+    std::unordered_map<AudioBufferHandle, StreamingAudioBuffer*, AudioBufferHandle::Hash>;
+  using StreamingAudioBuffers = audio::DoubleBuffer<StreamingAudioBuffers_>;
+
+  using StreamingBackingStore = std::unordered_map<
+    AudioBufferHandle, std::unique_ptr<StreamingAudioBuffer>, AudioBufferHandle::Hash>;
+
+  using StreamingAccessor =
+    audio::DeltaDoubleBufferAccessor<StreamingAudioBuffers_,
+                                     MapAccessorTraits<StreamingAudioBuffers_>>;
 
 public:
+  ~AudioBufferStore();
+
   void ui_update();
   bool ui_list(std::vector<BufferInfo>& into) const;
 
@@ -69,12 +107,26 @@ public:
   std::unique_ptr<Future<AudioBufferHandle>>
   ui_add_in_memory(const AudioBufferDescriptor& descriptor, std::unique_ptr<unsigned char[]> data);
 
+  //  Stream the wav file at `file_path` from disk rather than loading it into memory. See
+  //  StreamingAudioBuffer. Returns null if the file cannot be opened.
+  std::unique_ptr<Future<AudioBufferHandle>> ui_add_streaming(const std::string& file_path);
+
   std::unique_ptr<Future<RemoveResult>> ui_remove(AudioBufferHandle handle);
 
+  StreamingStats ui_get_streaming_stats() const;
+
+  //  Chunk covering the frames [frame_begin, frame_end) of the buffer. In-memory buffers are
+  //  always complete; streamed buffers are served a chunk at a time. See StreamingAudioBuffer.
   Optional<AudioBufferChunk> render_get(AudioBufferHandle handle,
                                         uint64_t frame_begin,
                                         uint64_t frame_end) const;
 
+  //  The complete buffer, for readers that index it freely (e.g. granular samplers). Streamed
+  //  buffers are only complete if they fit in their resident region.
+  Optional<AudioBufferChunk> render_get_complete(AudioBufferHandle handle) const {
+    return render_get(handle, 0, ~uint64_t(0));
+  }
+
   Optional<AudioBufferChunk>
   render_get(AudioBufferHandle handle, double frame_index, const AudioRenderInfo& info) const {
     return render_get(handle, uint64_t(frame_index), uint64_t(frame_index) + info.num_frames);
@@ -82,14 +134,31 @@ public:
 
   Optional<AudioBufferChunk> ui_load(AudioBufferHandle handle) const;
 
+private:
+  void ui_update_in_memory_adopted();
+  void ui_update_streaming_adopted();
+  void start_io_thread();
+  void io_thread_loop();
+
 private:
   std::vector<Command> pending_ui_submit;
   std::vector<Command> pending_reader_swap;
+  std::vector<Command> pending_streaming_reader_swap;
   uint64_t next_buffer_handle_id{1};
 
   InMemoryBackingStore in_memory_backing_store;
   InMemoryAudioBuffers in_memory_audio_buffers;
   InMemoryAccessor in_memory_audio_buffer_accessor{in_memory_audio_buffers};
+
+  StreamingBackingStore streaming_backing_store;
+  StreamingAudioBuffers streaming_audio_buffers;
+  StreamingAccessor streaming_audio_buffer_accessor{streaming_audio_buffers};
+
+  std::thread io_thread;
+  std::atomic<bool> io_thread_keep_running{false};
+  //  Guards `io_streams`, which is shared between the ui and I/O threads.
+  std::mutex io_mutex;
+  std::vector<StreamingAudioBuffer*> io_streams;
 };
 
 }
\ No newline at end of file
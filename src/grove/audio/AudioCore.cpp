@@ -99,6 +99,34 @@ AudioCore::FrameInfo AudioCore::get_frame_info() const {
   return result;
 }
 
+OfflineRenderResult AudioCore::ui_render_offline(const OfflineRenderParams& params) {
+  //  Nothing else may render while rendering offline.
+  const bool stream_was_started = audio_stream.is_stream_started();
+  if (stream_was_started) {
+    audio_stream.stop();
+  }
+#if !GROVE_RENDER_AUDIO_IN_CALLBACK
+  const bool thread_was_active = audio_thread.is_active();
+  if (thread_was_active) {
+    audio_thread.stop();
+  }
+#endif
+
+  auto result = render_offline(renderer, params);
+
+  //  The stream's parameters are re-applied on the next render.
+#if !GROVE_RENDER_AUDIO_IN_CALLBACK
+  if (thread_was_active) {
+    audio_thread.start();
+  }
+#endif
+  if (stream_was_started) {
+    audio_stream.start();
+  }
+
+  return result;
+}
+
 void AudioCore::toggle_stream_started() {
   if (audio_stream.is_stream_started()) {
     audio_stream.stop();
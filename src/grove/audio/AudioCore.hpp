@@ -4,6 +4,7 @@
 #include "AudioThread.hpp"
 #include "AudioStream.hpp"
 #include "AudioRecorder.hpp"
+#include "offline_render.hpp"
 #include "audio_config.hpp"
 
 namespace grove {
@@ -33,6 +34,9 @@ public:
   bool change_stream(const AudioDeviceInfo& target_device);
 
   FrameInfo get_frame_info() const;
+  //  Pause the stream and audio thread, render `params.duration_s` seconds as fast as possible,
+  //  then resume. See `render_offline`.
+  OfflineRenderResult ui_render_offline(const OfflineRenderParams& params);
   void push_render_modification(const AudioRenderer::Modification& mod);
 
   static AudioRenderer::Modification make_add_renderable_modification(AudioRenderable* renderable);
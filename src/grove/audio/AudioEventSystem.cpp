@@ -197,6 +197,9 @@ struct AudioEventSystem {
 
   std::atomic<bool> dropped_events{};
   std::atomic<bool> render_buffer_overflow{};
+  //  Guards pushes to render-side allocators, which can come from multiple threads when the
+  //  audio graph is rendered in parallel.
+  std::atomic<bool> render_push_in_use{};
   std::atomic<uint32_t> latest_num_events_required{};
   std::vector<std::unique_ptr<AudioEventPacket>> packet_store;
   UIAudioEvents ui_events;
@@ -723,7 +726,15 @@ void audio_event_system::render_end_process(double output_buffer_dac_time, doubl
 }
 
 bool audio_event_system::render_push_event(AudioEventStreamHandle stream, const AudioEvent& event) {
-  return push_event(get_allocator(&global_event_system, stream), event);
+  auto& in_use = global_event_system.render_push_in_use;
+  bool acquired{false};
+  while (!in_use.compare_exchange_weak(acquired, true)) {
+    acquired = false;
+  }
+
+  const bool result = push_event(get_allocator(&global_event_system, stream), event);
+  in_use.store(false);
+  return result;
 }
 
 AudioEventUpdateResult audio_event_system::ui_update(const Optional<double>& time) {
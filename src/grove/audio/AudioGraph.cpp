@@ -173,6 +173,8 @@ AudioGraph::ConnectionResult AudioGraph::disconnect_impl(const OutputAudioPort&
   }
 
   layout_needs_reevaluation = true;
+  layout_modified_nodes.insert(output_node);
+  layout_modified_nodes.insert(connected_input_node);
 
   ConnectionResult result{};
   result.connections.push_back({output, connected_input});
@@ -281,6 +283,8 @@ AudioGraph::ConnectionResult AudioGraph::connect_impl(const OutputAudioPort& out
   }
 
   layout_needs_reevaluation = true;
+  layout_modified_nodes.insert(output_node);
+  layout_modified_nodes.insert(input_node);
   return connect_status;
 }
 
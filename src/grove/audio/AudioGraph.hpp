@@ -59,6 +59,10 @@ public:
   const GraphNodeSet& get_output_nodes() const {
     return output_nodes;
   }
+  //  Nodes whose connections changed since the layout was last re-evaluated.
+  const GraphNodeSet& get_layout_modified_nodes() const {
+    return layout_modified_nodes;
+  }
 
 private:
   ConnectionResult connect_impl(const OutputAudioPort& output,
@@ -73,6 +77,7 @@ private:
 
 private:
   bool layout_needs_reevaluation{false};
+  GraphNodeSet layout_modified_nodes;
 
   std::unordered_map<InputAudioPort, OutputAudioPort, AudioPort::Hash> connected_input_ports;
   std::unordered_map<OutputAudioPort, InputAudioPort, AudioPort::Hash> connected_output_ports;
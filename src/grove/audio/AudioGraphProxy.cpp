@@ -72,9 +72,10 @@ void AudioGraphProxy::update(AudioGraph& graph,
     }
     pending_commands.clear();
 
-    if (graph.layout_needs_reevaluation) {
+    if (graph.layout_needs_reevaluation || render_data.needs_rebuild()) {
       render_data.modify(graph, reserve_frames);
       graph.layout_needs_reevaluation = false;
+      graph.layout_modified_nodes.clear();
 
 #ifdef GROVE_DEBUG
       graph.sanity_check_node_sets();
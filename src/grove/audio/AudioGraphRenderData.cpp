@@ -3,6 +3,7 @@
 #include "grove/common/common.hpp"
 #include "grove/common/logging.hpp"
 #include "grove/common/profile.hpp"
+#include <algorithm>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -312,6 +313,7 @@ void prepare_subgraph(const NodeStack& topo_sorted,
     renderable.output.descriptors = std::move(output_descriptors);
     renderable.node = ori;
     renderable.requires_allocation = !has_output_buffer;
+    renderable.render_serially = outs.empty();
 
     result.ready_to_render.push_back(std::move(renderable));
 
@@ -324,26 +326,16 @@ void prepare_subgraph(const NodeStack& topo_sorted,
   }
 }
 
-} //  anon
-
-/*
- * AudioGraphRenderData
- */
-
-AudioGraphRenderData AudioGraphRenderData::build(const AudioGraph& graph,
-                                                 AudioMemoryArenas& arenas,
-                                                 int num_frames) {
-  auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("AudioGraphRenderData/build");
-
-  arenas.make_all_available();
-
+void append_subgraphs(const AudioGraph& graph,
+                      NodeSet& all_visited,
+                      AudioMemoryArenas& arenas,
+                      int num_frames,
+                      AudioGraphRenderData& result) {
   const auto& graph_output_nodes = graph.get_output_nodes();
   std::vector<AudioProcessorNode*> sources{graph_output_nodes.begin(),
                                            graph_output_nodes.end()};
 
-  NodeSet all_visited;
   RebuildGraphData rebuild_data;
-  AudioGraphRenderData result;
 
   while (!sources.empty()) {
     auto src = sources.back();
@@ -365,13 +357,147 @@ AudioGraphRenderData AudioGraphRenderData::build(const AudioGraph& graph,
       continue;
     }
 
+    AudioGraphRenderData::Subgraph subgraph{};
+    subgraph.begin = int(result.ready_to_render.size());
+    subgraph.alloc_begin = int(result.alloc_info.size());
     prepare_subgraph(topo_sorted, graph, rebuild_data, arenas, result, num_frames);
-    arenas.make_all_available();
+    subgraph.end = int(result.ready_to_render.size());
+    subgraph.alloc_end = int(result.alloc_info.size());
+    subgraph.parallel = std::all_of(
+      result.ready_to_render.begin() + subgraph.begin,
+      result.ready_to_render.begin() + subgraph.end, [](const auto& renderable) {
+        return renderable.render_serially || renderable.node->allow_parallel_render();
+      });
+    result.subgraphs.push_back(subgraph);
+
+    if (!result.independent_subgraphs) {
+      //  Subgraphs are rendered one after the other, so their buffers can alias.
+      arenas.make_all_available();
+    }
+  }
+}
+
+bool contains_any(const AudioGraphRenderData& data,
+                  const AudioGraphRenderData::Subgraph& subgraph,
+                  const NodeSet& nodes) {
+  for (int i = subgraph.begin; i < subgraph.end; i++) {
+    if (nodes.count(data.ready_to_render[i].node) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//  Move the kept subgraphs to the front of `data`, preserving their order, and drop the rest.
+void compact_subgraphs(AudioGraphRenderData& data, const std::vector<bool>& keep) {
+  int num_subgraphs{};
+  int num_ready{};
+  int num_alloc{};
+
+  for (int s = 0; s < int(data.subgraphs.size()); s++) {
+    if (!keep[s]) {
+      continue;
+    }
+
+    const auto src = data.subgraphs[s];
+    const int alloc_offset = num_alloc - src.alloc_begin;
+
+    AudioGraphRenderData::Subgraph subgraph{};
+    subgraph.begin = num_ready;
+    subgraph.alloc_begin = num_alloc;
+
+    for (int i = src.alloc_begin; i < src.alloc_end; i++, num_alloc++) {
+      if (num_alloc != i) {
+        data.alloc_info[num_alloc] = std::move(data.alloc_info[i]);
+      }
+    }
+    for (int i = src.begin; i < src.end; i++, num_ready++) {
+      auto& dst = data.ready_to_render[num_ready];
+      if (num_ready != i) {
+        dst = std::move(data.ready_to_render[i]);
+      }
+      dst.output_buffer_index += alloc_offset;
+      if (dst.input_buffer_index >= 0) {
+        dst.input_buffer_index += alloc_offset;
+      }
+    }
+
+    subgraph.end = num_ready;
+    subgraph.alloc_end = num_alloc;
+    subgraph.parallel = src.parallel;
+    data.subgraphs[num_subgraphs++] = subgraph;
+  }
+
+  data.subgraphs.resize(num_subgraphs);
+  data.ready_to_render.erase(data.ready_to_render.begin() + num_ready,
+                             data.ready_to_render.end());
+  data.alloc_info.erase(data.alloc_info.begin() + num_alloc, data.alloc_info.end());
+}
+
+void index_parallel_subgraphs(AudioGraphRenderData& data) {
+  data.parallel_subgraphs.clear();
+  for (int s = 0; s < int(data.subgraphs.size()); s++) {
+    if (data.subgraphs[s].parallel) {
+      data.parallel_subgraphs.push_back(s);
+    }
   }
+}
+
+} //  anon
+
+/*
+ * AudioGraphRenderData
+ */
+
+AudioGraphRenderData AudioGraphRenderData::build(const AudioGraph& graph,
+                                                 AudioMemoryArenas& arenas,
+                                                 int num_frames,
+                                                 bool independent_subgraphs) {
+  auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("AudioGraphRenderData/build");
+
+  arenas.make_all_available();
+
+  NodeSet all_visited;
+  AudioGraphRenderData result;
+  result.independent_subgraphs = independent_subgraphs;
+  append_subgraphs(graph, all_visited, arenas, num_frames, result);
+  index_parallel_subgraphs(result);
 
   return result;
 }
 
+void AudioGraphRenderData::patch(AudioGraphRenderData& data,
+                                 const AudioGraph& graph,
+                                 const NodeSet& modified_nodes,
+                                 AudioMemoryArenas& arenas,
+                                 int num_frames) {
+  auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("AudioGraphRenderData/patch");
+
+  std::vector<bool> keep(data.subgraphs.size());
+  for (int s = 0; s < int(data.subgraphs.size()); s++) {
+    keep[s] = !contains_any(data, data.subgraphs[s], modified_nodes);
+  }
+
+  compact_subgraphs(data, keep);
+
+  //  Nodes of kept subgraphs are not revisited. Modified nodes are only ever found in the
+  //  subgraphs being rebuilt, so every kept node still belongs to the same complete subgraph.
+  NodeSet all_visited;
+  std::unordered_set<AudioMemoryArena*> arenas_in_use;
+  for (auto& renderable : data.ready_to_render) {
+    all_visited.insert(renderable.node);
+  }
+  if (data.independent_subgraphs) {
+    for (auto& alloc_info : data.alloc_info) {
+      arenas_in_use.insert(alloc_info.arena);
+    }
+  }
+
+  arenas.make_all_available_except(arenas_in_use);
+  append_subgraphs(graph, all_visited, arenas, num_frames, data);
+  index_parallel_subgraphs(data);
+}
+
 /*
  * AudioGraphDoubleBuffer
  */
@@ -381,9 +507,34 @@ bool AudioGraphDoubleBuffer::can_modify() const {
 }
 
 void AudioGraphDoubleBuffer::modify(const AudioGraph& graph, int reserve_frames) {
-  auto res = render_data_accessor.writer_modify(graph, *write_arenas, reserve_frames);
+  if (reserve_frames != built_reserve_frames) {
+    built_reserve_frames = reserve_frames;
+    write_stale->rebuild_all = true;
+    read_stale->rebuild_all = true;
+  }
+
+  for (auto* node : graph.get_layout_modified_nodes()) {
+    write_stale->modified_nodes.insert(node);
+    read_stale->modified_nodes.insert(node);
+  }
+
+  auto res = render_data_accessor.writer_modify(
+    graph, *write_arenas, reserve_frames, independent_subgraphs, *write_stale);
   assert(res);
   (void) res;
+  rebuild_pending = false;
+
+  write_stale->modified_nodes.clear();
+  write_stale->rebuild_all = false;
+}
+
+void AudioGraphDoubleBuffer::set_independent_subgraphs(bool enable) {
+  if (enable != independent_subgraphs) {
+    independent_subgraphs = enable;
+    rebuild_pending = true;
+    write_stale->rebuild_all = true;
+    read_stale->rebuild_all = true;
+  }
 }
 
 AudioGraphDoubleBuffer::Accessor::WriterUpdateResult
@@ -391,6 +542,7 @@ AudioGraphDoubleBuffer::update() {
   auto res = render_data_accessor.writer_update();
   if (res.changed) {
     std::swap(write_arenas, read_arenas);
+    std::swap(write_stale, read_stale);
   }
 
   return res;
@@ -400,8 +552,15 @@ using AccessorTraits = AudioGraphDoubleBuffer::AccessorTraits;
 void AccessorTraits::modify(AudioGraphRenderData& data,
                             const AudioGraph& graph,
                             AudioMemoryArenas& arenas,
-                            int reserve_frames) {
-  data = AudioGraphRenderData::build(graph, arenas, reserve_frames);
+                            int reserve_frames,
+                            bool independent_subgraphs,
+                            const StaleRenderData& stale) {
+  if (stale.rebuild_all) {
+    data = AudioGraphRenderData::build(graph, arenas, reserve_frames, independent_subgraphs);
+  } else {
+    assert(data.independent_subgraphs == independent_subgraphs);
+    AudioGraphRenderData::patch(data, graph, stale.modified_nodes, arenas, reserve_frames);
+  }
 }
 
 /*
@@ -415,6 +574,17 @@ void AudioMemoryArenas::make_all_available() {
   }
 }
 
+void AudioMemoryArenas::make_all_available_except(
+  const std::unordered_set<AudioMemoryArena*>& in_use) {
+  //
+  free_list.clear();
+  for (int i = 0; i < int(arenas.size()); i++) {
+    if (in_use.count(arenas[i].get()) == 0) {
+      free_list.push_back(i);
+    }
+  }
+}
+
 AudioMemoryArena* AudioMemoryArenas::require() {
   AudioMemoryArena* arena;
 
@@ -4,6 +4,7 @@
 #include "data_channel.hpp"
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 namespace grove {
 
@@ -18,6 +19,7 @@ struct AudioMemoryArenas {
 public:
   AudioMemoryArena* require();
   void make_all_available();
+  void make_all_available_except(const std::unordered_set<AudioMemoryArena*>& in_use);
 
 public:
   std::vector<std::unique_ptr<AudioMemoryArena>> arenas;
@@ -43,16 +45,51 @@ public:
     AudioProcessData input;
     AudioProcessData output;
     bool requires_allocation{false};
+    //  True for nodes without outputs (e.g. `DestinationNode`), which write to shared state and
+    //  are therefore deferred to the render thread when subgraphs are rendered in parallel.
+    bool render_serially{false};
+    //  Time spent in `node->process` during the most recent quantum. Only measured while node
+    //  timing or profiling is enabled on the renderer.
+    double elapsed_ms{};
   };
 
+  //  Contiguous range [begin, end) of `ready_to_render` that shares no buffers or nodes with
+  //  any other subgraph. Its buffers are the range [alloc_begin, alloc_end) of `alloc_info`.
+  struct Subgraph {
+    int begin{};
+    int end{};
+    int alloc_begin{};
+    int alloc_end{};
+    //  True if every node of the subgraph that is not rendered serially allows parallel render.
+    bool parallel{};
+  };
+
+  using NodeSet = std::unordered_set<AudioProcessorNode*>;
+
 public:
   static AudioGraphRenderData build(const AudioGraph& graph,
                                     AudioMemoryArenas& arenas,
-                                    int num_frames);
+                                    int num_frames,
+                                    bool independent_subgraphs = false);
+
+  //  Bring `data`, previously built from `graph` with `arenas`, up to date after the connections
+  //  of `modified_nodes` changed. Only the subgraphs containing a modified node are rebuilt; the
+  //  rest are kept as they are.
+  static void patch(AudioGraphRenderData& data,
+                    const AudioGraph& graph,
+                    const NodeSet& modified_nodes,
+                    AudioMemoryArenas& arenas,
+                    int num_frames);
 
 public:
   std::vector<ReadyToRender> ready_to_render;
   std::vector<AllocInfo> alloc_info;
+  std::vector<Subgraph> subgraphs;
+  //  Indices into `subgraphs` of the subgraphs that can be rendered on worker threads.
+  std::vector<int> parallel_subgraphs;
+  //  True if no memory arena is shared between subgraphs, such that they can be rendered
+  //  concurrently.
+  bool independent_subgraphs{false};
 };
 
 /*
@@ -63,6 +100,13 @@ class AudioGraphDoubleBuffer {
 public:
   using BufferedRenderData = audio::DoubleBuffer<AudioGraphRenderData>;
 
+  //  Changes that a buffer has yet to reflect. Each buffer lags behind the graph by the edits
+  //  made since it was last written to, so each is tracked separately.
+  struct StaleRenderData {
+    AudioGraphRenderData::NodeSet modified_nodes;
+    bool rebuild_all{true};
+  };
+
   struct AccessorTraits {
     static constexpr bool enable_mutable_read() {
       return true;
@@ -71,7 +115,9 @@ public:
     static void modify(AudioGraphRenderData& data,
                        const AudioGraph& graph,
                        AudioMemoryArenas& arenas,
-                       int reserve_frames);
+                       int reserve_frames,
+                       bool independent_subgraphs,
+                       const StaleRenderData& stale);
 
     static inline AudioGraphRenderData* on_reader_swap(AudioGraphRenderData* write_to,
                                                        AudioGraphRenderData*) {
@@ -86,6 +132,13 @@ public:
   void modify(const AudioGraph& graph, int reserve_frames);
   Accessor::WriterUpdateResult update();
 
+  //  Build render data whose subgraphs do not share memory arenas, at the cost of additional
+  //  memory, so that they can be rendered in parallel. Takes effect on the next call to modify().
+  void set_independent_subgraphs(bool enable);
+  bool needs_rebuild() const {
+    return rebuild_pending;
+  }
+
   AudioGraphRenderData& maybe_swap_and_read() noexcept {
     return render_data_accessor.maybe_swap_and_read_mut();
   }
@@ -99,6 +152,16 @@ private:
 
   AudioMemoryArenas* write_arenas{&arenas0};
   AudioMemoryArenas* read_arenas{&arenas1};
+
+  StaleRenderData stale0;
+  StaleRenderData stale1;
+
+  StaleRenderData* write_stale{&stale0};
+  StaleRenderData* read_stale{&stale1};
+
+  int built_reserve_frames{-1};
+  bool independent_subgraphs{};
+  bool rebuild_pending{};
 };
 
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 #include "AudioGraph.hpp"
 #include "AudioGraphProxy.hpp"
 #include "AudioNodeIsolator.hpp"
+#include "AudioRenderer.hpp"
 #include "grove/common/common.hpp"
+#include <algorithm>
+#include <chrono>
 
 #define ENABLE_NODE_ISOLATOR (1)
 
@@ -10,48 +13,127 @@ GROVE_NAMESPACE_BEGIN
 
 namespace {
 
-void render(AudioGraphRenderData& render_data, AudioEvents* events, const AudioRenderInfo& info) {
-  for (auto& renderable : render_data.ready_to_render) {
-    assert(renderable.output_buffer_index >= 0);
+using RenderClock = std::chrono::steady_clock;
 
-    auto& alloc_info = render_data.alloc_info[renderable.output_buffer_index];
-    const auto& channel_set = alloc_info.channel_set;
+static_assert(AudioGraphRenderer::max_num_parallel_render_frames >=
+              AudioRenderer::max_render_quantum_frames(1));
 
-    auto& output = renderable.output;
-    auto& input = renderable.input;
+struct ParallelRenderContext {
+  AudioGraphRenderData* render_data;
+  AudioGraphRenderer::WorkerScratch* worker_scratch;
+  const AudioRenderInfo* info;
+  bool timed;
+};
 
-    if (renderable.requires_allocation) {
-      alloc_info.buffer = channel_set.allocate(*alloc_info.arena, info.num_frames);
-      alloc_info.buffer.zero();
-    }
+double elapsed_ms(RenderClock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(RenderClock::now() - t0).count();
+}
 
-    if (renderable.input_buffer_index >= 0) {
-      input.buffer = render_data.alloc_info[renderable.input_buffer_index].buffer;
-    } else {
-      assert(std::all_of(input.descriptors.begin(), input.descriptors.end(), [](const auto& descr) {
-        return descr.is_missing();
-      }));
-    }
+void render_one(AudioGraphRenderData& render_data,
+                AudioGraphRenderData::ReadyToRender& renderable,
+                AudioEvents* events, const AudioRenderInfo& info, bool timed) {
+  assert(renderable.output_buffer_index >= 0);
+
+  auto& alloc_info = render_data.alloc_info[renderable.output_buffer_index];
+  const auto& channel_set = alloc_info.channel_set;
 
-    output.buffer = alloc_info.buffer;
+  auto& output = renderable.output;
+  auto& input = renderable.input;
+
+  if (renderable.requires_allocation) {
+    alloc_info.buffer = channel_set.allocate(*alloc_info.arena, info.num_frames);
+    alloc_info.buffer.zero();
+  }
+
+  if (renderable.input_buffer_index >= 0) {
+    input.buffer = render_data.alloc_info[renderable.input_buffer_index].buffer;
+  } else {
+    assert(std::all_of(input.descriptors.begin(), input.descriptors.end(), [](const auto& descr) {
+      return descr.is_missing();
+    }));
+  }
+
+  output.buffer = alloc_info.buffer;
 
 #if ENABLE_NODE_ISOLATOR
-    const uint32_t node_id = renderable.node->get_id();
-    GROVE_MAYBE_ISOLATE_INPUT(node_id, input, info);
+  const uint32_t node_id = renderable.node->get_id();
+  GROVE_MAYBE_ISOLATE_INPUT(node_id, input, info);
 #endif
 
+  if (timed) {
+    const auto t0 = RenderClock::now();
+    renderable.node->process(input, output, events, info);
+    renderable.elapsed_ms = elapsed_ms(t0);
+  } else {
     renderable.node->process(input, output, events, info);
+  }
 
 #if ENABLE_NODE_ISOLATOR
-    GROVE_MAYBE_ISOLATE_OUTPUT(node_id, output, info);
+  GROVE_MAYBE_ISOLATE_OUTPUT(node_id, output, info);
 #endif
+}
+
+void render(AudioGraphRenderData& render_data, AudioEvents* events,
+            const AudioRenderInfo& info, bool timed) {
+  for (auto& renderable : render_data.ready_to_render) {
+    render_one(render_data, renderable, events, info, timed);
+  }
+}
+
+void render_subgraph_task(void* context, int task_index, int worker_index) {
+  auto* ctx = static_cast<ParallelRenderContext*>(context);
+  auto& render_data = *ctx->render_data;
+  auto& scratch = ctx->worker_scratch[worker_index];
+  const auto t0 = RenderClock::now();
+
+  auto& subgraph = render_data.subgraphs[render_data.parallel_subgraphs[task_index]];
+  for (int i = subgraph.begin; i < subgraph.end; i++) {
+    auto& renderable = render_data.ready_to_render[i];
+    if (!renderable.render_serially) {
+      render_one(render_data, renderable, scratch.events.get(), *ctx->info, ctx->timed);
+    }
   }
+
+  scratch.max_task_ms = std::max(scratch.max_task_ms, elapsed_ms(t0));
+}
+
+bool can_render_parallel(const AudioGraphRenderData& render_data) {
+  return render_data.independent_subgraphs && render_data.parallel_subgraphs.size() > 1;
+}
+
+using NodeProfile = AudioGraphRenderer::NodeProfile;
+using NodeProfileWindow = AudioGraphRenderer::NodeProfileWindow;
+
+NodeProfile make_node_profile(uint32_t node_id, const NodeProfileWindow& window) {
+  NodeProfile result{};
+  result.node_id = node_id;
+  result.num_samples = window.num_samples;
+  if (window.num_samples == 0) {
+    return result;
+  }
+
+  float sorted[AudioGraphRenderer::node_profile_window_size];
+  std::copy(window.samples, window.samples + window.num_samples, sorted);
+  std::sort(sorted, sorted + window.num_samples);
+
+  double sum{};
+  for (int i = 0; i < window.num_samples; i++) {
+    sum += sorted[i];
+  }
+
+  const int p99_index = std::min(window.num_samples - 1, (window.num_samples * 99) / 100);
+  result.min_ms = sorted[0];
+  result.max_ms = sorted[window.num_samples - 1];
+  result.mean_ms = sum / double(window.num_samples);
+  result.p99_ms = sorted[p99_index];
+  return result;
 }
 
 } //  anon
 
 AudioGraphRenderer::AudioGraphRenderer(AudioGraphDoubleBuffer* double_buffer) :
-  double_buffer{double_buffer} {
+  double_buffer{double_buffer},
+  node_timings{std::make_unique<NodeTiming[]>(max_num_timed_nodes)} {
   //
 }
 
@@ -63,7 +145,201 @@ void AudioGraphRenderer::render(const AudioRenderer&,
   destination_nodes.set_output_sample_buffer(samples);
 
   auto& use_render_data = double_buffer->maybe_swap_and_read();
-  grove::render(use_render_data, events, info);
+  const bool timing = node_timing_enabled.load();
+  const bool profiling = node_profiling_enabled.load();
+  const bool timed = timing || profiling;
+
+  if (parallel_render_enabled.load() &&
+      info.num_frames <= max_num_parallel_render_frames &&
+      can_render_parallel(use_render_data)) {
+    render_parallel(use_render_data, events, info, timed);
+  } else {
+    grove::render(use_render_data, events, info, timed);
+  }
+
+  if (timing) {
+    accumulate_node_timings(use_render_data);
+  }
+  if (profiling) {
+    push_node_profile_samples(use_render_data, info);
+  }
+}
+
+void AudioGraphRenderer::render_parallel(AudioGraphRenderData& render_data, AudioEvents* events,
+                                         const AudioRenderInfo& info, bool timed) {
+  const auto t0 = RenderClock::now();
+
+  for (auto& scratch : worker_scratch) {
+    assert(scratch.num_event_frames >= info.num_frames);
+    scratch.max_task_ms = 0.0;
+  }
+
+  ParallelRenderContext context{&render_data, worker_scratch.data(), &info, timed};
+  worker_pool.run(render_subgraph_task, &context, int(render_data.parallel_subgraphs.size()));
+
+  //  Merge events generated on each worker, in worker order.
+  double critical_path_ms{};
+  for (auto& scratch : worker_scratch) {
+    for (int i = 0; i < info.num_frames; i++) {
+      for (auto& evt : scratch.events[i]) {
+        events[i].push_back(evt);
+      }
+      scratch.events[i].clear();
+    }
+    critical_path_ms = std::max(critical_path_ms, scratch.max_task_ms);
+  }
+
+  //  Subgraphs with nodes that do not allow parallel render are rendered here, in full. Nodes
+  //  without outputs consume buffers produced by their subgraph, which remain valid until the next
+  //  quantum because subgraphs do not share memory arenas.
+  for (auto& subgraph : render_data.subgraphs) {
+    for (int i = subgraph.begin; i < subgraph.end; i++) {
+      auto& renderable = render_data.ready_to_render[i];
+      if (!subgraph.parallel || renderable.render_serially) {
+        render_one(render_data, renderable, events, info, timed);
+      }
+    }
+  }
+
+  latest_critical_path_ms.store(critical_path_ms);
+  max_critical_path_ms.store(std::max(max_critical_path_ms.load(), critical_path_ms));
+  latest_render_ms.store(elapsed_ms(t0));
+  latest_num_subgraphs.store(int(render_data.parallel_subgraphs.size()));
+}
+
+void AudioGraphRenderer::accumulate_node_timings(const AudioGraphRenderData& render_data) {
+  const int num_slots = std::min(int(render_data.ready_to_render.size()), max_num_timed_nodes);
+  for (int i = 0; i < num_slots; i++) {
+    auto& renderable = render_data.ready_to_render[i];
+    auto& timing = node_timings[i];
+    if (timing.node != renderable.node) {
+      timing = {};
+      timing.node = renderable.node;
+      timing.node_id = renderable.node->get_id();
+    }
+    timing.total_ms += renderable.elapsed_ms;
+    timing.num_quanta++;
+  }
+  num_node_timings = std::max(num_node_timings, num_slots);
+}
+
+void AudioGraphRenderer::push_node_profile_samples(const AudioGraphRenderData& render_data,
+                                                   const AudioRenderInfo& info) {
+  node_profile_quantum_budget_ms.store(double(info.num_frames) / info.sample_rate * 1e3);
+
+  const auto num_renderables = int(render_data.ready_to_render.size());
+  const int num_write = std::min(num_renderables, node_profile_samples.num_free());
+  for (int i = 0; i < num_write; i++) {
+    auto& renderable = render_data.ready_to_render[i];
+    NodeProfileSample sample{};
+    sample.node_id = renderable.node->get_id();
+    sample.elapsed_ms = float(renderable.elapsed_ms);
+    node_profile_samples.write(sample);
+  }
+
+  if (num_write < num_renderables) {
+    num_dropped_node_profile_samples += uint64_t(num_renderables - num_write);
+  }
+}
+
+void AudioGraphRenderer::ui_set_node_profiling_enabled(bool enable) {
+  if (node_profiling_enabled.load() == enable) {
+    return;
+  }
+
+  node_profiling_enabled.store(enable);
+  //  Discard samples pushed before the toggle, so that a new session does not start with stale
+  //  samples and a stopped one is not extended by samples still in flight.
+  node_profile_samples.clear();
+  if (enable) {
+    ui_node_profiles.clear();
+    num_dropped_node_profile_samples.store(0);
+  }
+}
+
+void AudioGraphRenderer::ui_update_node_profiles() {
+  //  Forget nodes not rendered during this many updates, e.g. because they were deleted.
+  constexpr uint64_t max_num_updates_without_samples = 120;
+
+  const uint64_t update = ++ui_node_profile_update;
+  const int num_read = node_profile_samples.size();
+  for (int i = 0; i < num_read; i++) {
+    const NodeProfileSample sample = node_profile_samples.read();
+    auto& window = ui_node_profiles[sample.node_id];
+    window.samples[window.next] = sample.elapsed_ms;
+    window.next = (window.next + 1) % node_profile_window_size;
+    window.num_samples = std::min(window.num_samples + 1, node_profile_window_size);
+    window.last_update = update;
+  }
+
+  if (!node_profiling_enabled.load()) {
+    return;
+  }
+
+  for (auto it = ui_node_profiles.begin(); it != ui_node_profiles.end();) {
+    if (update - it->second.last_update > max_num_updates_without_samples) {
+      it = ui_node_profiles.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void AudioGraphRenderer::ui_get_node_profiles(std::vector<NodeProfile>& into) const {
+  for (auto& [node_id, window] : ui_node_profiles) {
+    into.push_back(make_node_profile(node_id, window));
+  }
+}
+
+AudioGraphRenderer::NodeProfileStats AudioGraphRenderer::ui_get_node_profile_stats() const {
+  NodeProfileStats result{};
+  result.quantum_budget_ms = node_profile_quantum_budget_ms.load();
+  result.num_dropped_samples = num_dropped_node_profile_samples.load();
+  result.enabled = node_profiling_enabled.load();
+  return result;
+}
+
+void AudioGraphRenderer::set_node_timing_enabled(bool enable) {
+  node_timing_enabled.store(enable);
+}
+
+void AudioGraphRenderer::get_node_timings(std::vector<NodeTiming>& into) const {
+  for (int i = 0; i < num_node_timings; i++) {
+    into.push_back(node_timings[i]);
+  }
+}
+
+void AudioGraphRenderer::clear_node_timings() {
+  std::fill(node_timings.get(), node_timings.get() + num_node_timings, NodeTiming{});
+  num_node_timings = 0;
+}
+
+void AudioGraphRenderer::ui_initialize_parallel_render(int num_worker_threads) {
+  assert(worker_scratch.empty() && !parallel_render_enabled.load());
+  //  One slot for the render thread + one per worker. Event buffers are sized for the largest
+  //  render quantum, so that the render thread never allocates them.
+  worker_scratch.resize(num_worker_threads + 1);
+  for (auto& scratch : worker_scratch) {
+    scratch.events = std::make_unique<AudioEvents[]>(max_num_parallel_render_frames);
+    scratch.num_event_frames = max_num_parallel_render_frames;
+  }
+  worker_pool.start(num_worker_threads);
+}
+
+void AudioGraphRenderer::ui_set_parallel_render_enabled(bool enable) {
+  assert(!enable || !worker_scratch.empty());
+  parallel_render_enabled.store(enable && !worker_scratch.empty());
+}
+
+AudioGraphRenderer::ParallelRenderStats AudioGraphRenderer::ui_get_parallel_render_stats() const {
+  ParallelRenderStats result{};
+  result.latest_critical_path_ms = latest_critical_path_ms.load();
+  result.max_critical_path_ms = max_critical_path_ms.load();
+  result.latest_render_ms = latest_render_ms.load();
+  result.latest_num_subgraphs = latest_num_subgraphs.load();
+  result.num_worker_threads = worker_pool.num_workers();
+  result.enabled = parallel_render_enabled.load();
+  return result;
 }
 
 DestinationNode* AudioGraphRenderer::create_destination(AudioParameterID node_id,
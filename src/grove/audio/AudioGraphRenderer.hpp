@@ -3,8 +3,12 @@
 #include "audio_processor_nodes/DestinationNode.hpp"
 #include "AudioGraphRenderData.hpp"
 #include "AudioRenderable.hpp"
+#include "AudioRenderWorkerPool.hpp"
 #include "audio_config.hpp"
+#include "grove/common/RingBuffer.hpp"
 #include <mutex>
+#include <atomic>
+#include <unordered_map>
 
 namespace grove {
 
@@ -28,6 +32,73 @@ public:
     std::vector<std::unique_ptr<DestinationNode>> nodes;
   };
 
+  struct ParallelRenderStats {
+    //  Duration of the longest-running subgraph in the most recent parallel render quantum, i.e.,
+    //  a lower bound on the quantum's render time given unlimited threads.
+    double latest_critical_path_ms{};
+    double max_critical_path_ms{};
+    //  Wall-clock duration of the most recent parallel render quantum.
+    double latest_render_ms{};
+    //  Number of subgraphs rendered on worker threads in the most recent parallel render quantum.
+    int latest_num_subgraphs{};
+    int num_worker_threads{};
+    bool enabled{};
+  };
+
+  struct NodeTiming {
+    AudioProcessorNode* node{};
+    uint32_t node_id{};
+    double total_ms{};
+    uint64_t num_quanta{};
+  };
+
+  //  Quanta with more frames than this are rendered serially.
+  static constexpr int max_num_parallel_render_frames = 2048;
+
+  //  Nodes rendered beyond this many in a quantum are not timed.
+  static constexpr int max_num_timed_nodes = 1024;
+
+  static constexpr int node_profile_window_size = 256;
+  static constexpr int node_profile_ring_buffer_size = 4096;
+
+  //  Distribution of the time spent processing a node, over its most recent
+  //  `node_profile_window_size` render quanta.
+  struct NodeProfile {
+    uint32_t node_id{};
+    double min_ms{};
+    double mean_ms{};
+    double max_ms{};
+    double p99_ms{};
+    int num_samples{};
+  };
+
+  struct NodeProfileStats {
+    //  Duration of audio produced by the most recent render quantum, i.e., the time available
+    //  to render it.
+    double quantum_budget_ms{};
+    //  Samples discarded because the ui thread did not drain them quickly enough.
+    uint64_t num_dropped_samples{};
+    bool enabled{};
+  };
+
+  struct NodeProfileSample {
+    uint32_t node_id{};
+    float elapsed_ms{};
+  };
+
+  struct NodeProfileWindow {
+    float samples[node_profile_window_size]{};
+    int num_samples{};
+    int next{};
+    uint64_t last_update{};
+  };
+
+  struct WorkerScratch {
+    std::unique_ptr<AudioEvents[]> events;
+    int num_event_frames{};
+    double max_task_ms{};
+  };
+
 public:
   explicit AudioGraphRenderer(AudioGraphDoubleBuffer* double_buffer);
   ~AudioGraphRenderer() override = default;
@@ -42,9 +113,65 @@ public:
                                       int num_outputs);
   void delete_destination(DestinationNode* node);
 
+  //  Start `num_worker_threads` real-time worker threads used to render independent subgraphs
+  //  concurrently. Call once, from the ui thread, before enabling parallel rendering.
+  void ui_initialize_parallel_render(int num_worker_threads);
+  //  Parallel rendering also requires that `double_buffer` build render data with independent
+  //  subgraphs; see `AudioGraphDoubleBuffer::set_independent_subgraphs`. Only subgraphs whose nodes
+  //  all opt in via `AudioProcessorNode::allow_parallel_render` are rendered on worker threads;
+  //  the rest are rendered on the render thread.
+  void ui_set_parallel_render_enabled(bool enable);
+  ParallelRenderStats ui_get_parallel_render_stats() const;
+
+  //  Measure the time spent processing each node on the render thread, and make the samples
+  //  available to the ui thread. Call `ui_update_node_profiles` regularly while enabled.
+  void ui_set_node_profiling_enabled(bool enable);
+  //  Drain samples published by the render thread into per-node windows. Nodes that have not
+  //  been rendered in a while are forgotten.
+  void ui_update_node_profiles();
+  void ui_get_node_profiles(std::vector<NodeProfile>& into) const;
+  NodeProfileStats ui_get_node_profile_stats() const;
+
+  //  Accumulate the time spent processing each node. Timings are owned by the thread calling
+  //  render(), so they can only be read in between render calls made from the reading thread,
+  //  e.g. when rendering offline. Timings are kept per render slot, so a slot's total restarts
+  //  when the graph changes such that a different node is rendered in it.
+  void set_node_timing_enabled(bool enable);
+  void get_node_timings(std::vector<NodeTiming>& into) const;
+  void clear_node_timings();
+
+private:
+  void render_parallel(AudioGraphRenderData& render_data, AudioEvents* events,
+                       const AudioRenderInfo& info, bool timed);
+  void accumulate_node_timings(const AudioGraphRenderData& render_data);
+  void push_node_profile_samples(const AudioGraphRenderData& render_data,
+                                 const AudioRenderInfo& info);
+
 private:
   AudioGraphDoubleBuffer* double_buffer;
   DestinationNodes destination_nodes;
+
+  AudioRenderWorkerPool worker_pool;
+  std::vector<WorkerScratch> worker_scratch;
+  std::atomic<bool> parallel_render_enabled{false};
+
+  std::atomic<double> latest_critical_path_ms{};
+  std::atomic<double> max_critical_path_ms{};
+  std::atomic<double> latest_render_ms{};
+  std::atomic<int> latest_num_subgraphs{};
+
+  std::atomic<bool> node_timing_enabled{false};
+  std::unique_ptr<NodeTiming[]> node_timings;
+  int num_node_timings{};
+
+  std::atomic<bool> node_profiling_enabled{false};
+  std::atomic<double> node_profile_quantum_budget_ms{};
+  std::atomic<uint64_t> num_dropped_node_profile_samples{};
+  RingBuffer<NodeProfileSample, node_profile_ring_buffer_size,
+             RingBufferHeapStorage<NodeProfileSample, node_profile_ring_buffer_size>>
+    node_profile_samples;
+  std::unordered_map<uint32_t, NodeProfileWindow> ui_node_profiles;
+  uint64_t ui_node_profile_update{};
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "AudioRenderWorkerPool.hpp"
+#include "grove/common/common.hpp"
+#include <chrono>
+#include <cassert>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr int num_spin_iterations = 256;
+constexpr int num_yield_iterations = 64;
+constexpr auto idle_sleep_duration = std::chrono::microseconds(50);
+
+uint32_t job_epoch(uint64_t word) {
+  return uint32_t(word >> 32u);
+}
+
+uint32_t job_num_tasks(uint64_t word) {
+  return uint32_t((word >> 16u) & 0xffffu);
+}
+
+uint32_t job_next_task(uint64_t word) {
+  return uint32_t(word & 0xffffu);
+}
+
+} //  anon
+
+AudioRenderWorkerPool::~AudioRenderWorkerPool() {
+  stop();
+}
+
+void AudioRenderWorkerPool::start(int num_worker_threads) {
+  assert(threads.empty() && num_worker_threads >= 0);
+  keep_running.store(true);
+
+  for (int i = 0; i < num_worker_threads; i++) {
+    threads.emplace_back([this, i]() {
+      worker_loop(i + 1);
+    });
+  }
+
+  num_active_workers.store(num_worker_threads);
+}
+
+void AudioRenderWorkerPool::stop() {
+  num_active_workers.store(0);
+  keep_running.store(false);
+
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  threads.clear();
+}
+
+bool AudioRenderWorkerPool::try_execute_one(uint32_t at_epoch, int worker_index) noexcept {
+  uint64_t word = job_word.load();
+
+  while (true) {
+    //  Reject claims against a job other than the one this thread observed. The task and context
+    //  are published before the word of their job, and cannot change until every task of the job
+    //  has completed, so after a successful claim they belong to `at_epoch`.
+    const uint32_t num_tasks = job_num_tasks(word);
+    if (job_epoch(word) != at_epoch || job_next_task(word) >= num_tasks) {
+      return false;
+    }
+
+    const uint32_t task_index = job_next_task(word);
+    const uint64_t claimed = make_job_word(at_epoch, num_tasks, task_index + 1);
+    if (job_word.compare_exchange_weak(word, claimed)) {
+      auto task = job_task.load();
+      task(job_context.load(), int(task_index), worker_index);
+      num_remaining_tasks.fetch_sub(1);
+      return true;
+    }
+  }
+}
+
+void AudioRenderWorkerPool::worker_loop(int worker_index) noexcept {
+  uint32_t last_epoch{};
+  int num_idle_iterations{};
+
+  while (keep_running.load()) {
+    const uint32_t curr_epoch = job_epoch(job_word.load());
+
+    if (curr_epoch != last_epoch) {
+      last_epoch = curr_epoch;
+      num_idle_iterations = 0;
+      while (try_execute_one(curr_epoch, worker_index)) {
+        //
+      }
+      continue;
+    }
+
+    num_idle_iterations++;
+    if (num_idle_iterations < num_spin_iterations) {
+      continue;
+    } else if (num_idle_iterations < num_spin_iterations + num_yield_iterations) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(idle_sleep_duration);
+    }
+  }
+}
+
+void AudioRenderWorkerPool::run(Task task, void* context, int num_tasks) noexcept {
+  if (num_tasks <= 0) {
+    return;
+  }
+
+  assert(uint32_t(num_tasks) <= max_num_tasks);
+  //  Every task of the previous job has been claimed, so the previous word admits no further
+  //  claims; no worker can claim a task until the new word is published below.
+  epoch++;
+  job_task.store(task);
+  job_context.store(context);
+  num_remaining_tasks.store(num_tasks);
+  job_word.store(make_job_word(epoch, uint32_t(num_tasks), 0));
+
+  while (try_execute_one(epoch, 0)) {
+    //
+  }
+
+  while (num_remaining_tasks.load() > 0) {
+    //  Spin; the remaining tasks are already executing on other threads.
+  }
+}
+
+GROVE_NAMESPACE_END
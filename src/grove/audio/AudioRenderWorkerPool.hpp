@@ -0,0 +1,64 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace grove {
+
+/*
+ * AudioRenderWorkerPool
+ *
+ * Fixed pool of worker threads that cooperate with the render thread to execute a batch of
+ * independent tasks. Workers never block on a mutex; they poll an atomic job word with a
+ * spin -> yield -> short sleep backoff, so that waking them is a single atomic store.
+ */
+
+class AudioRenderWorkerPool {
+public:
+  //  `worker_index` is 0 for the calling (render) thread, and in [1, num_workers()] otherwise.
+  using Task = void(*)(void* context, int task_index, int worker_index);
+
+  static constexpr uint32_t max_num_tasks = 0xffff;
+
+public:
+  ~AudioRenderWorkerPool();
+
+  //  Call from a non-render thread, before the render thread makes use of the pool.
+  void start(int num_worker_threads);
+  void stop();
+
+  //  Number of threads that may execute tasks, excluding the calling thread.
+  int num_workers() const noexcept {
+    return num_active_workers.load();
+  }
+
+  //  Execute `num_tasks` tasks across the workers and the calling thread, returning once every
+  //  task has completed. `num_tasks` must not exceed `max_num_tasks`.
+  void run(Task task, void* context, int num_tasks) noexcept;
+
+private:
+  void worker_loop(int worker_index) noexcept;
+  bool try_execute_one(uint32_t epoch, int worker_index) noexcept;
+
+  static uint64_t make_job_word(uint32_t epoch, uint32_t num_tasks, uint32_t next_task) noexcept {
+    return (uint64_t(epoch) << 32u) | (uint64_t(num_tasks) << 16u) | uint64_t(next_task);
+  }
+
+private:
+  std::vector<std::thread> threads;
+  std::atomic<int> num_active_workers{0};
+  std::atomic<bool> keep_running{false};
+
+  //  High 32 bits: job epoch. Bits 16-31: number of tasks. Low 16 bits: index of the next
+  //  unclaimed task. A claim is a CAS on the whole word, so it can only succeed against the epoch
+  //  and task count it was checked against.
+  std::atomic<uint64_t> job_word{0};
+  std::atomic<Task> job_task{nullptr};
+  std::atomic<void*> job_context{nullptr};
+  std::atomic<int> num_remaining_tasks{0};
+  uint32_t epoch{0};
+};
+
+}
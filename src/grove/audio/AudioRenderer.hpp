@@ -4,7 +4,7 @@
 #include "grove/common/RingBuffer.hpp"
 #include "audio_events.hpp"
 #include "AudioBufferStore.hpp"
-#include "DoubleBuffer.hpp"
+#include "DeltaDoubleBuffer.hpp"
 #include <array>
 #include <vector>
 #include <memory>
@@ -31,8 +31,9 @@ public:
   template <typename T>
   using DoubleBuffer = audio::DoubleBuffer<T>;
 
+  //  Adding or removing an element publishes only that change, rather than a copy of the list.
   template <typename T>
-  using DoubleBufferAccessor = audio::DoubleBufferAccessor<T>;
+  using DoubleBufferAccessor = audio::DeltaDoubleBufferAccessor<T>;
 
   template <typename T>
   using Vec = std::vector<T>;
@@ -104,6 +105,15 @@ public:
   int render_quantum_samples() const;
   int num_samples_to_read() const;
 
+  //  Largest power-of-two render quantum whose samples and events fit in the output buffers.
+  static constexpr int max_render_quantum_frames(int num_output_channels) {
+    int frames = event_buffer_size / 2;
+    while (frames > 1 && frames * num_output_channels >= sample_buffer_size) {
+      frames /= 2;
+    }
+    return frames;
+  }
+
   AudioBufferStore* get_audio_buffer_store() {
     return audio_buffer_store.get();
   }
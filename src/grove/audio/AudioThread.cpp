@@ -46,6 +46,10 @@ bool AudioThread::proceed() const {
   return can_proceed;
 }
 
+bool AudioThread::is_active() const {
+  return thread_active;
+}
+
 void AudioThread::start() {
   std::lock_guard<std::mutex> lock(mutex);
   assert(!thread_active);
@@ -20,6 +20,7 @@ public:
   void start();
   void stop();
   bool proceed() const;
+  bool is_active() const;
 
   void finished();
   std::thread::id thread_id() const;
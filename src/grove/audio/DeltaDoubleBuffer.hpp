@@ -0,0 +1,220 @@
+#pragma once
+
+#include "DoubleBuffer.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace grove::audio {
+
+/*
+ * DeltaDoubleBufferAccessor
+ *
+ * Like `DoubleBufferAccessor`, but modifications are recorded as operations (`Traits::Op`)
+ * rather than made to the write buffer only. After the reader swaps, the writer replays the
+ * operations it published onto the buffer the reader just released, instead of copying the whole
+ * of T into it. Publishing a change thus costs O(number of operations) rather than O(size of T).
+ *
+ * The writer never has to wait for the reader: operations pushed while a batch is awaiting the
+ * reader's swap are queued, and applied once the swap is observed in `writer_update`.
+ *
+ * Each published batch of operations is tagged with an epoch. Once `writer_adopted_epoch()` is
+ * at least the `writer_epoch()` at which an operation was pushed, the reader has adopted a
+ * buffer including that operation and will never again read a buffer that predates it. This is
+ * the point at which e.g. memory referenced by a removed entry can be reclaimed.
+ *
+ * Traits must provide `using Op = ...` and `static void apply(T& target, const Op& op)`. Each
+ * operation is applied to both buffers, so it must be copyable and its application
+ * deterministic. `writer_add` and `writer_remove` additionally require `make_add_op` and
+ * `make_remove_op`.
+ */
+
+namespace detail {
+  template <typename T>
+  struct DeltaDoubleBufferAsSetTraits {
+    using Value = std::decay_t<decltype(*std::declval<T&>().begin())>;
+
+    struct Op {
+      Value value;
+      bool remove;
+    };
+
+    template <typename U>
+    static Op make_add_op(U&& value) noexcept {
+      return Op{std::forward<U>(value), false};
+    }
+
+    template <typename U>
+    static Op make_remove_op(U&& value) noexcept {
+      return Op{std::forward<U>(value), true};
+    }
+
+    static void apply(T& array, const Op& op) noexcept {
+      if (op.remove) {
+        DoubleBufferAsSetTraits<T>::remove(array, op.value);
+      } else {
+        DoubleBufferAsSetTraits<T>::add(array, op.value);
+      }
+    }
+  };
+}
+
+template <typename T, typename Traits = detail::DeltaDoubleBufferAsSetTraits<T>>
+class DeltaDoubleBufferAccessor : public Traits {
+  enum class WriteState {
+    None,
+    AwaitingSubmit,
+    AwaitingSwap
+  };
+
+public:
+  using Op = typename Traits::Op;
+
+  struct WriterUpdateResult {
+    bool changed{false};
+    uint64_t adopted_epoch{};
+  };
+
+public:
+  explicit DeltaDoubleBufferAccessor(DoubleBuffer<T>& buffer) :
+    DeltaDoubleBufferAccessor{&buffer.a, &buffer.b} {
+    //
+  }
+
+  //  `a` and `b` must be equal.
+  DeltaDoubleBufferAccessor(T* a, T* b) : buffers{a, b} {
+    assert(a != b);
+  }
+
+  //  Always true; operations pushed while awaiting the reader's swap are queued.
+  bool writer_can_modify() const noexcept {
+    return true;
+  }
+
+  void writer_push(const Op& op) {
+    if (write_state == WriteState::AwaitingSwap) {
+      queued_ops.push_back(op);
+    } else {
+      Traits::apply(*buffers[write_index], op);
+      open_ops.push_back(op);
+      write_state = WriteState::AwaitingSubmit;
+    }
+  }
+
+  template <typename U>
+  bool writer_add(U&& value) {
+    writer_push(Traits::make_add_op(std::forward<U>(value)));
+    return true;
+  }
+
+  template <typename U>
+  bool writer_remove(U&& value) {
+    writer_push(Traits::make_remove_op(std::forward<U>(value)));
+    return true;
+  }
+
+  WriterUpdateResult writer_update() {
+    WriterUpdateResult result{};
+
+    if (write_state == WriteState::AwaitingSwap) {
+      bool maybe_swapped{true};
+
+      if (swapped.compare_exchange_strong(maybe_swapped, false)) {
+        //  The reader now reads the buffer we published; bring the one it released up to date.
+        write_index = 1 - write_index;
+        T& write_to = *buffers[write_index];
+        for (auto& op : published_ops) {
+          Traits::apply(write_to, op);
+        }
+        published_ops.clear();
+        adopted_epoch = published_epoch;
+
+        for (auto& op : queued_ops) {
+          Traits::apply(write_to, op);
+        }
+        std::swap(open_ops, queued_ops);
+        queued_ops.clear();
+        write_state = open_ops.empty() ? WriteState::None : WriteState::AwaitingSubmit;
+
+        result.changed = true;
+      }
+    }
+
+    if (write_state == WriteState::AwaitingSubmit) {
+      submit();
+    }
+
+    result.adopted_epoch = adopted_epoch;
+    return result;
+  }
+
+  //  Epoch of the batch that will contain operations pushed now.
+  uint64_t writer_epoch() const noexcept {
+    return open_epoch;
+  }
+
+  //  The reader has adopted every operation pushed at or before this epoch.
+  uint64_t writer_adopted_epoch() const noexcept {
+    return adopted_epoch;
+  }
+
+  //  Contents as of the most recently applied operation; excludes operations queued while
+  //  awaiting the reader's swap. The writer never modifies this buffer while the reader might
+  //  access it, so this is always safe to call from the writing thread.
+  const T& writer_read() const noexcept {
+    return *buffers[write_index];
+  }
+
+  void reader_maybe_swap() noexcept {
+    bool maybe_changed{true};
+    if (changed.compare_exchange_strong(maybe_changed, false)) {
+      read_index = 1 - read_index;
+      swapped.store(true);
+    }
+  }
+
+  const T& maybe_swap_and_read() noexcept {
+    reader_maybe_swap();
+    return read();
+  }
+
+  const T& read() const noexcept {
+    return *buffers[read_index];
+  }
+
+private:
+  void submit() {
+    assert(!changed.load() && published_ops.empty());
+    std::swap(published_ops, open_ops);
+    published_epoch = open_epoch++;
+    write_state = WriteState::AwaitingSwap;
+    changed.store(true);
+  }
+
+private:
+  T* buffers[2];
+  //  Owned by the writer and reader, respectively.
+  int write_index{0};
+  int read_index{1};
+
+  std::atomic<bool> changed{false};
+  std::atomic<bool> swapped{false};
+
+  WriteState write_state{};
+  //  Applied to the write buffer, not yet published.
+  std::vector<Op> open_ops;
+  //  Applied to the buffer awaiting the reader's swap; to be replayed onto the other one.
+  std::vector<Op> published_ops;
+  //  Pushed while awaiting the reader's swap; not yet applied to either buffer.
+  std::vector<Op> queued_ops;
+
+  uint64_t open_epoch{1};
+  uint64_t published_epoch{};
+  uint64_t adopted_epoch{};
+};
+
+}
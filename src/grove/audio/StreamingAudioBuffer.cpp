@@ -0,0 +1,280 @@
+#include "StreamingAudioBuffer.hpp"
+#include "grove/common/common.hpp"
+#include <algorithm>
+#include <cassert>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+/*
+ * Slot word: bits [0, 2) hold the state, bit 2 is set while the render thread holds a chunk
+ * referring to the slot, and bits [8, 64) hold the index of the chunk in the slot.
+ */
+
+enum class SlotState : uint64_t {
+  Empty = 0,
+  Loading = 1,
+  Ready = 2
+};
+
+constexpr uint64_t slot_state_mask = 3u;
+constexpr uint64_t slot_pinned_bit = 4u;
+constexpr uint64_t slot_chunk_shift = 8u;
+
+uint64_t make_slot_word(SlotState state, uint64_t chunk_index) {
+  return uint64_t(state) | (chunk_index << slot_chunk_shift);
+}
+
+SlotState slot_state(uint64_t word) {
+  return SlotState(word & slot_state_mask);
+}
+
+uint64_t slot_chunk_index(uint64_t word) {
+  return word >> slot_chunk_shift;
+}
+
+bool slot_pinned(uint64_t word) {
+  return (word & slot_pinned_bit) != 0;
+}
+
+} //  anon
+
+std::unique_ptr<StreamingAudioBuffer> StreamingAudioBuffer::open(const std::string& file_path) {
+  wav::FormatDescriptor format{};
+  uint32_t data_offset{};
+  if (!wav::read_wav_format(file_path, &format, &data_offset) || format.num_channels == 0) {
+    return nullptr;
+  }
+
+  auto result = std::make_unique<StreamingAudioBuffer>();
+  result->file.open(file_path.c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!result->file.good()) {
+    return nullptr;
+  }
+
+  result->format = format;
+  result->data_offset = data_offset;
+  result->num_frames = format.num_frames;
+  result->num_channels = format.num_channels;
+  result->descriptor = AudioBufferDescriptor::from_interleaved_float(
+    format.sample_rate, int(format.num_frames), format.num_channels);
+
+  const uint64_t frame_samples = uint64_t(format.num_channels);
+  result->resident_frame_size = std::min(result->num_frames, resident_frames + guard_frames);
+  result->resident_data = std::make_unique<float[]>(result->resident_frame_size * frame_samples);
+  if (!result->read_frames(0, result->resident_frame_size, result->resident_data.get())) {
+    return nullptr;
+  }
+
+  if (result->num_frames > resident_frames) {
+    for (auto& slot : result->slots) {
+      slot.data = std::make_unique<float[]>((chunk_frames + guard_frames) * frame_samples);
+    }
+  }
+
+  return result;
+}
+
+AudioBufferChunk StreamingAudioBuffer::make_chunk(uint64_t frame_offset, uint64_t frame_size,
+                                                  const float* data) const {
+  AudioBufferChunk result{};
+  result.descriptor = descriptor;
+  result.frame_offset = frame_offset;
+  result.frame_size = frame_size;
+  result.data = (unsigned char*) data;
+  return result;
+}
+
+bool StreamingAudioBuffer::read_frames(uint64_t frame_begin, uint64_t num_read, float* dst) {
+  const uint64_t bytes_per_sample = format.bits_per_sample / 8;
+  const uint64_t num_samples = num_read * num_channels;
+  const uint64_t num_bytes = num_samples * bytes_per_sample;
+  read_scratch.resize(num_bytes);
+
+  file.clear();
+  file.seekg(std::streamoff(data_offset + frame_begin * num_channels * bytes_per_sample));
+  file.read((char*) read_scratch.data(), std::streamsize(num_bytes));
+  if (!file.good()) {
+    std::fill(dst, dst + num_samples, 0.0f);
+    return false;
+  }
+
+  wav::source_data_to_float(format, read_scratch.data(), uint32_t(num_samples), dst);
+  return true;
+}
+
+void StreamingAudioBuffer::render_add_cursor(uint64_t chunk_index) {
+  for (int i = 0; i < num_render_cursors; i++) {
+    if (render_cursors[i] == chunk_index) {
+      return;
+    }
+  }
+  if (num_render_cursors < max_num_readers) {
+    render_cursors[num_render_cursors++] = chunk_index;
+  }
+}
+
+Optional<AudioBufferChunk> StreamingAudioBuffer::render_get(uint64_t frame_begin,
+                                                            uint64_t frame_end) {
+  if (frame_begin >= num_frames) {
+    return NullOpt{};
+  }
+
+  frame_end = std::min(std::max(frame_end, frame_begin + 1), num_frames);
+  if (frame_end <= resident_frame_size) {
+    render_add_cursor(frame_begin / chunk_frames);
+    return Optional<AudioBufferChunk>(make_chunk(0, resident_frame_size, resident_data.get()));
+  }
+
+  const uint64_t chunk_index = frame_begin / chunk_frames;
+  const uint64_t chunk_begin = chunk_index * chunk_frames;
+  const uint64_t chunk_size = std::min(chunk_frames + guard_frames, num_frames - chunk_begin);
+  if (frame_begin < resident_frames || frame_end > chunk_begin + chunk_size) {
+    //  Too long to be served from one chunk.
+    return NullOpt{};
+  }
+
+  render_add_cursor(chunk_index);
+  for (int i = 0; i < num_slots; i++) {
+    auto& slot = slots[i];
+    uint64_t word = slot.word.load();
+
+    while (slot_state(word) == SlotState::Ready && slot_chunk_index(word) == chunk_index) {
+      if (slot_pinned(word) ||
+          slot.word.compare_exchange_weak(word, word | slot_pinned_bit)) {
+        render_pinned_slots |= 1u << uint32_t(i);
+        return Optional<AudioBufferChunk>(make_chunk(chunk_begin, chunk_size, slot.data.get()));
+      }
+    }
+  }
+
+  num_misses++;
+  return NullOpt{};
+}
+
+void StreamingAudioBuffer::render_release_slots() {
+  for (int i = 0; i < num_slots; i++) {
+    if (render_pinned_slots & (1u << uint32_t(i))) {
+      slots[i].word.fetch_and(~slot_pinned_bit);
+    }
+  }
+  render_pinned_slots = 0;
+
+  if (num_render_cursors > 0) {
+    for (int i = 0; i < max_num_readers; i++) {
+      const uint64_t cursor = i < num_render_cursors ? render_cursors[i] + 1 : 0;
+      reader_cursors[i].store(cursor);
+    }
+    num_render_cursors = 0;
+  }
+}
+
+bool StreamingAudioBuffer::io_update() {
+  if (num_frames <= resident_frames) {
+    return false;
+  }
+
+  const uint64_t first_chunk = resident_frames / chunk_frames;
+  const uint64_t last_chunk = (num_frames - 1) / chunk_frames;
+
+  //  Before the first request, prefetch from the end of the resident region.
+  uint64_t cursor_chunks[max_num_readers];
+  int num_cursors{};
+  for (auto& reader_cursor : reader_cursors) {
+    if (const uint64_t cursor = reader_cursor.load()) {
+      cursor_chunks[num_cursors++] = std::min(std::max(first_chunk, cursor - 1), last_chunk);
+    }
+  }
+  if (num_cursors == 0) {
+    cursor_chunks[num_cursors++] = first_chunk;
+  }
+
+  //  Each reader keeps the chunk behind its cursor, and as many ahead of it as its share of the
+  //  slots allows.
+  const uint64_t window_size = std::max(2, num_slots / num_cursors);
+  auto window_begin = [&](uint64_t cursor_chunk) {
+    return cursor_chunk > first_chunk ? cursor_chunk - 1 : first_chunk;
+  };
+  auto window_end = [&](uint64_t cursor_chunk) {
+    return std::min(window_begin(cursor_chunk) + window_size, last_chunk + 1);
+  };
+  auto in_any_window = [&](uint64_t chunk_index) {
+    for (int i = 0; i < num_cursors; i++) {
+      if (chunk_index >= window_begin(cursor_chunks[i]) &&
+          chunk_index < window_end(cursor_chunks[i])) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto is_resident = [this](uint64_t chunk_index) {
+    for (auto& slot : slots) {
+      const uint64_t word = slot.word.load();
+      if (slot_state(word) != SlotState::Empty && slot_chunk_index(word) == chunk_index) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto find_victim = [&](uint64_t* word) -> Slot* {
+    for (auto& slot : slots) {
+      *word = slot.word.load();
+      const bool in_window = in_any_window(slot_chunk_index(*word));
+      if (slot_state(*word) == SlotState::Empty || (!slot_pinned(*word) && !in_window)) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  };
+
+  //  Round-robin over the readers: each cursor's own chunk first, then the ones ahead of it,
+  //  then the one behind it.
+  for (uint64_t i = 0; i < window_size; i++) {
+    for (int r = 0; r < num_cursors; r++) {
+      const uint64_t cursor_chunk = cursor_chunks[r];
+      const uint64_t begin = window_begin(cursor_chunk);
+      const uint64_t end = window_end(cursor_chunk);
+      if (i >= end - begin) {
+        continue;
+      }
+
+      const uint64_t chunk_index = cursor_chunk + i < end ? cursor_chunk + i : begin;
+      if (is_resident(chunk_index)) {
+        continue;
+      }
+
+      uint64_t word{};
+      Slot* slot = find_victim(&word);
+      if (!slot) {
+        return false;
+      }
+
+      //  Fails if the render thread pinned the slot in the meantime.
+      const uint64_t loading = make_slot_word(SlotState::Loading, chunk_index);
+      if (!slot->word.compare_exchange_strong(word, loading)) {
+        return false;
+      }
+
+      const uint64_t chunk_begin = chunk_index * chunk_frames;
+      const uint64_t chunk_size = std::min(chunk_frames + guard_frames, num_frames - chunk_begin);
+      (void) read_frames(chunk_begin, chunk_size, slot->data.get());
+      slot->word.store(make_slot_word(SlotState::Ready, chunk_index));
+      num_chunks_loaded++;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+StreamingAudioBuffer::Stats StreamingAudioBuffer::get_stats() const {
+  Stats result{};
+  result.num_misses = num_misses.load();
+  result.num_chunks_loaded = num_chunks_loaded.load();
+  return result;
+}
+
+GROVE_NAMESPACE_END
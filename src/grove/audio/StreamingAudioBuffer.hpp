@@ -0,0 +1,111 @@
+#pragma once
+
+#include "audio_buffer.hpp"
+#include "grove/common/Optional.hpp"
+#include "grove/load/wav.hpp"
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace grove {
+
+/*
+ * StreamingAudioBuffer
+ *
+ * Disk-backed, read-only view of a WAV file. The first `resident_frames` frames are loaded when
+ * the buffer is opened and stay in memory, so that playback from the start of the file never
+ * waits on I/O. The rest of the file is served from a fixed ring of `num_slots` chunks of
+ * `chunk_frames` frames, which an I/O thread keeps filled ahead of each reader.
+ *
+ * Each chunk holds `guard_frames` frames past its end, so a request whose range starts in a chunk
+ * and spans no more than `guard_frames` frames is fully covered by that chunk. Longer requests
+ * are only served from the resident region.
+ *
+ * Readers are not registered: each distinct chunk requested during a render quantum counts as
+ * one reader's cursor, up to `max_num_readers`. The cursors are published to the I/O thread at
+ * the end of the quantum, and kept as they are through quanta without requests. Voices of a
+ * sampler, or timeline clips, reading different parts of the same file thus each keep their own
+ * chunks loaded, and the ring is shared evenly between them.
+ *
+ * Slots are shared with the I/O thread through a single atomic word each. The render thread pins
+ * a slot when handing out a chunk that refers to it; pinned slots are not reused until
+ * `render_release_slots`, which the owning store calls at the start of each render quantum.
+ */
+
+class StreamingAudioBuffer {
+public:
+  static constexpr uint64_t chunk_frames = 1u << 15u;
+  static constexpr uint64_t guard_frames = 4096;
+  static constexpr uint64_t resident_frames = chunk_frames * 2;
+  static constexpr int num_slots = 8;
+  static constexpr int max_num_readers = num_slots;
+
+  struct Stats {
+    uint64_t num_misses;
+    uint64_t num_chunks_loaded;
+  };
+
+private:
+  struct Slot {
+    //  See `make_slot_word`.
+    std::atomic<uint64_t> word{0};
+    std::unique_ptr<float[]> data;
+  };
+
+public:
+  //  Call from the ui thread. Reads the header and resident region of `file_path`.
+  static std::unique_ptr<StreamingAudioBuffer> open(const std::string& file_path);
+
+  const AudioBufferDescriptor& get_descriptor() const {
+    return descriptor;
+  }
+
+  //  Chunk covering the frames [frame_begin, frame_end), clamped to the end of the file, or
+  //  NullOpt if no chunk covers the range or the chunk is not (yet) loaded. Counts a miss in the
+  //  latter case. An empty range requests the single frame `frame_begin`. The returned chunk is
+  //  valid until the next call to `render_release_slots`.
+  Optional<AudioBufferChunk> render_get(uint64_t frame_begin, uint64_t frame_end);
+  //  Ends the render quantum: releases the chunks handed out and publishes the readers' cursors.
+  void render_release_slots();
+
+  //  Call from the I/O thread. Loads at most one missing chunk near a reader's cursor; returns
+  //  whether a chunk was loaded.
+  bool io_update();
+
+  Stats get_stats() const;
+
+private:
+  AudioBufferChunk make_chunk(uint64_t frame_offset, uint64_t frame_size,
+                              const float* data) const;
+  bool read_frames(uint64_t frame_begin, uint64_t num_frames, float* dst);
+  void render_add_cursor(uint64_t chunk_index);
+
+private:
+  AudioBufferDescriptor descriptor;
+  wav::FormatDescriptor format;
+  uint64_t data_offset{};
+  uint64_t num_frames{};
+  int num_channels{};
+
+  std::unique_ptr<float[]> resident_data;
+  uint64_t resident_frame_size{};
+
+  Slot slots[num_slots];
+  uint32_t render_pinned_slots{};
+  //  Chunk indices requested during the current render quantum, one per reader.
+  uint64_t render_cursors[max_num_readers]{};
+  int num_render_cursors{};
+  //  Cursors of the last render quantum with requests, as chunk index + 1, or 0 if unused.
+  std::atomic<uint64_t> reader_cursors[max_num_readers]{};
+
+  //  Used only by the I/O thread after `open`.
+  std::ifstream file;
+  std::vector<unsigned char> read_scratch;
+
+  std::atomic<uint64_t> num_misses{0};
+  std::atomic<uint64_t> num_chunks_loaded{0};
+};
+
+}
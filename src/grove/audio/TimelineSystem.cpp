@@ -276,8 +276,13 @@ void render_timeline_audio_track(const TimelineAudioTrack& track, const AudioPro
     }
 
     auto interp = util::make_linear_interpolation_info(sample_index, buff.num_frames_in_source());
+    if (!buff.is_in_bounds(interp.i0) || !buff.is_in_bounds(interp.i1)) {
+      //  Streamed buffers serve a chunk of the source around `sample_index`.
+      continue;
+    }
+
     for (int j = 0; j < num_channels; j++) {
-      const float v = util::tick_interpolated_float(buff.data, buff.channel_descriptor(j), interp);
+      const float v = util::tick_interpolated_float(buff, buff.channel_descriptor(j), interp);
       dst.descriptors[j].write(dst.buffer.data, i, &v);
     }
   }
@@ -1,5 +1,4 @@
 #include "SpectrumAnalyzer.hpp"
-#include "../dft.hpp"
 #include "grove/common/logging.hpp"
 #include "grove/common/common.hpp"
 
@@ -13,6 +12,22 @@ AudioEvent make_dft_event(uint32_t id) {
   return evt;
 }
 
+//  Full spectrum of `block_size` real samples, normalized by 1 / block_size.
+void spectrum(const RealFFTPlan& plan, const Sample* src, Sample* dst) {
+  const int n = plan.size;
+  real_fft(plan, src, dst);
+
+  for (int k = n / 2 + 1; k < n; k++) {
+    dst[k * 2] = dst[(n - k) * 2];
+    dst[k * 2 + 1] = -dst[(n - k) * 2 + 1];
+  }
+
+  const Sample inv_n = Sample(1) / Sample(n);
+  for (int i = 0; i < n * 2; i++) {
+    dst[i] *= inv_n;
+  }
+}
+
 } //  anon
 
 /*
@@ -21,6 +36,7 @@ AudioEvent make_dft_event(uint32_t id) {
 
 SpectrumAnalyzer::SpectrumAnalyzer() :
   samples(new Sample[block_size]{}),
+  fft_plan(make_real_fft_plan(block_size)),
   frame_index(0),
   interval_index(0),
   enabled(true) {
@@ -47,7 +63,7 @@ void SpectrumAnalyzer::process(Sample* source_samples,
       if (free_spectra.size() > 0 && !pending_spectra.full()) {
         auto frame = free_spectra.read();
         frame.id = next_analysis_frame_id++;
-        dft(source_samples, frame.buffer.get(), block_size);
+        spectrum(fft_plan, source_samples, frame.buffer.get());
 
         out_events[i].push_back(make_dft_event(frame.id));
         pending_spectra.write(std::move(frame));
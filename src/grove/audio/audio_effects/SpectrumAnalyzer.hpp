@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../AudioEffect.hpp"
+#include "../fft.hpp"
 #include "grove/common/RingBuffer.hpp"
 #include <atomic>
 #include <unordered_map>
@@ -46,6 +47,7 @@ private:
 
 private:
   SampleBuffer samples;
+  RealFFTPlan fft_plan;
   int frame_index;
   int interval_index;
 
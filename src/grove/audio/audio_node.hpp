@@ -125,6 +125,14 @@ public:
                        AudioEvents* events,
                        const AudioRenderInfo& info) = 0;
 
+  //  True if `process` touches no state other than the node's own and its buffers, such that the
+  //  node can be processed concurrently with nodes of other subgraphs. Render-thread APIs such as
+  //  the parameter, scale and buffer systems are not thread-safe, so nodes using them must not
+  //  opt in.
+  virtual bool allow_parallel_render() const {
+    return false;
+  }
+
   template <int N>
   Optional<AudioProcessData> match_process_data_to_inputs(const AudioProcessData& src) const;
 
@@ -21,6 +21,9 @@ public:
                const AudioProcessData& out,
                AudioEvents* events,
                const AudioRenderInfo& info) override;
+  bool allow_parallel_render() const override {
+    return true;
+  }
 
 public:
   T value{};
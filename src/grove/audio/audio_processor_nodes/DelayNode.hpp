@@ -16,6 +16,9 @@ public:
                const AudioProcessData& out,
                AudioEvents* events,
                const AudioRenderInfo& info) override;
+  bool allow_parallel_render() const override {
+    return true;
+  }
 private:
   int read_ptr(int delay_frames) const;
   void make_buffer();
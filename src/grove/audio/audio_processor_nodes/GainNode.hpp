@@ -18,6 +18,9 @@ public:
                const AudioProcessData& out,
                AudioEvents* events,
                const AudioRenderInfo& info) override;
+  bool allow_parallel_render() const override {
+    return true;
+  }
 
 private:
   InputAudioPorts input_ports;
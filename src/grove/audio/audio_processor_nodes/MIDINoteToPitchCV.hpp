@@ -13,6 +13,10 @@ public:
   ~MIDINoteToPitchCV() override = default;
   GROVE_DECLARE_AUDIO_NODE_INTERFACE()
 
+  bool allow_parallel_render() const override {
+    return true;
+  }
+
 private:
   InputAudioPorts input_ports;
   OutputAudioPorts output_ports;
@@ -1,5 +1,6 @@
 #include "ModulatedOscillatorNode.hpp"
 #include "../AudioScale.hpp"
+#include "../voice_kernels.hpp"
 #include "grove/common/common.hpp"
 
 GROVE_NAMESPACE_BEGIN
@@ -63,38 +64,55 @@ void ModulatedOscillatorNode::process(const AudioProcessData& in,
   oscillator.set_sample_rate(info.sample_rate);
   center_frequency = note_number_to_frequency_equal_temperament(current_note_number, *tuning);
 
-  for (int i = 0; i < info.num_frames; i++) {
-    float freq_mod;
-    float gain_mod;
-    MIDIMessage midi_note;
-
-    freq_mod_descriptor.read<float>(in.buffer.data, i, &freq_mod);
-    gain_mod_descriptor.read<float>(in.buffer.data, i, &gain_mod);
-    midi_note_descriptor.read<MIDIMessage>(in.buffer.data, i, &midi_note);
-
-    if (midi_note.is_note_on()) {
-      current_note_number = midi_note.note_number();
-      center_frequency = note_number_to_frequency_equal_temperament(current_note_number, *tuning);
+  //  Phases are advanced frame by frame; the table is then read 4 frames at a time.
+  constexpr int block_size = 64;
+  double phases[block_size];
+  double gains[block_size];
+  float samples[block_size];
+
+  for (int i0 = 0; i0 < info.num_frames; i0 += block_size) {
+    const int num_block_frames = std::min(block_size, info.num_frames - i0);
+
+    for (int i = 0; i < num_block_frames; i++) {
+      const int frame = i0 + i;
+      float freq_mod;
+      float gain_mod;
+      MIDIMessage midi_note;
+
+      freq_mod_descriptor.read<float>(in.buffer.data, frame, &freq_mod);
+      gain_mod_descriptor.read<float>(in.buffer.data, frame, &gain_mod);
+      midi_note_descriptor.read<MIDIMessage>(in.buffer.data, frame, &midi_note);
+
+      if (midi_note.is_note_on()) {
+        current_note_number = midi_note.note_number();
+        center_frequency = note_number_to_frequency_equal_temperament(current_note_number, *tuning);
+      }
+      oscillator.set_frequency(center_frequency + freq_mod * freq_mod_depth);
+      phases[i] = oscillator.tick_phase();
+      gains[i] = gain_mod * gain_mod_depth;
     }
-    oscillator.set_frequency(center_frequency + freq_mod * freq_mod_depth);
 
+    audio::wavetable_read(oscillator.data(), phases, samples, num_block_frames);
+
+    for (int i = 0; i < num_block_frames; i++) {
 #if USE_FLOAT_OUTPUT
-    auto scalar_sample = float(oscillator.tick() * (gain_mod * gain_mod_depth));
+      auto scalar_sample = float(samples[i] * gains[i]);
 
-    for (auto& descr : out.descriptors) {
-      assert(descr.is_float());
-      descr.write<float>(out.buffer.data, i, &scalar_sample);
-    }
+      for (auto& descr : out.descriptors) {
+        assert(descr.is_float());
+        descr.write<float>(out.buffer.data, i0 + i, &scalar_sample);
+      }
 #else
-    auto scalar_sample = Sample(oscillator.tick() * (gain_mod * gain_mod_depth));
-    Sample2 sample;
-    sample.assign(scalar_sample);
-
-    for (auto& descr : out.descriptors) {
-      assert(descr.is_sample2());
-      descr.write<Sample2>(out.buffer.data, i, &sample);
-    }
+      auto scalar_sample = Sample(samples[i] * gains[i]);
+      Sample2 sample;
+      sample.assign(scalar_sample);
+
+      for (auto& descr : out.descriptors) {
+        assert(descr.is_sample2());
+        descr.write<Sample2>(out.buffer.data, i0 + i, &sample);
+      }
 #endif
+    }
   }
 }
 
@@ -2,6 +2,7 @@
 #include "../AudioParameterSystem.hpp"
 #include "grove/common/common.hpp"
 #include "grove/audio/Transport.hpp"
+#include "grove/audio/voice_kernels.hpp"
 
 GROVE_NAMESPACE_BEGIN
 
@@ -104,23 +105,35 @@ void OscillatorNode::process(const AudioProcessData& in,
     cursor = transport->render_get_cursor_location();
   }
 
-  for (int i = 0; i < info.num_frames; i++) {
-    const float f01 = params.frequency.evaluate();
-    cursor.wrapped_add_beats(bps, num);
-    oscillator.set_frequency(lerp(f01, 0.1f, 10.0f));
-
-    float sample;
-    if (params.tempo_sync.value == 0) {
-      sample = oscillator.tick();
-    } else {
-      const auto f = float(1.0 / f01_to_beat_div(f01) * num);
-      const auto phase = wrap_within_range(cursor.beat * f, num) / num;
-      sample = oscillator.read(phase * double(osc::WaveTable::size));
+  //  Phases are advanced frame by frame; the table is then read 4 frames at a time.
+  constexpr int block_size = 64;
+  double phases[block_size];
+  float samples[block_size];
+
+  for (int i0 = 0; i0 < info.num_frames; i0 += block_size) {
+    const int num_block_frames = std::min(block_size, info.num_frames - i0);
+
+    for (int i = 0; i < num_block_frames; i++) {
+      const float f01 = params.frequency.evaluate();
+      cursor.wrapped_add_beats(bps, num);
+      oscillator.set_frequency(lerp(f01, 0.1f, 10.0f));
+
+      if (params.tempo_sync.value == 0) {
+        phases[i] = oscillator.tick_phase();
+      } else {
+        const auto f = float(1.0 / f01_to_beat_div(f01) * num);
+        const auto phase = wrap_within_range(cursor.beat * f, num) / num;
+        phases[i] = phase * double(osc::WaveTable::size);
+      }
     }
 
-    for (int j = 0; j < num_descriptors; j++) {
-      assert(out.descriptors[j].is_float());
-      out.descriptors[j].write<float>(out.buffer.data, i, &sample);
+    audio::wavetable_read(oscillator.data(), phases, samples, num_block_frames);
+
+    for (int i = 0; i < num_block_frames; i++) {
+      for (int j = 0; j < num_descriptors; j++) {
+        assert(out.descriptors[j].is_float());
+        out.descriptors[j].write<float>(out.buffer.data, i0 + i, samples + i);
+      }
     }
   }
 }
@@ -16,6 +16,9 @@ public:
                const AudioProcessData& out,
                AudioEvents* events,
                const AudioRenderInfo& info) override;
+  bool allow_parallel_render() const override {
+    return true;
+  }
 private:
   InputAudioPorts input_ports;
   OutputAudioPorts output_ports;
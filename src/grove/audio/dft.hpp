@@ -25,6 +25,7 @@ void complex_moduli(const T* data, T* dst, int num_elements) {
   }
 }
 
+//  Reference O(n^2) transform, normalized by 1 / n. Prefer the plan-based transforms in fft.hpp.
 template <typename T>
 void dft(const T* source, T* dest, int n) {
   double inv_n = 1.0 / double(n);
@@ -1,62 +1,66 @@
 #include "fdft.hpp"
+#include "fft.hpp"
 #include <cmath>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 namespace grove {
 
 namespace {
 
 constexpr double two_pi = 6.28318530717958647692528676655900576;
-constexpr int max_num_levels = 10;
-constexpr int max_size = 1 << (max_num_levels + 1);
-double twiddles[max_num_levels][max_size];
 
-template <typename T>
-void cmul(T a, T ci, T b, T dj, T* oa, T* oi) {
-  //  (a + ci)(b + dj)
-  //  ab + adj + cbi + cdji
-  //  (ab - cd) + (adj + cbi)
-  *oa = a * b - ci * dj;
-  *oi = a * dj + ci * b;
+struct FDFTPlans {
+  RealFFTPlan real_plans[max_fdft_log2_size + 1];
+  //  e^(-2*pi*i*k / max_fdft_size), k in [0, max_fdft_size / 2)
+  std::vector<double> double_twiddles;
+  bool initialized{};
+} plans;
+
+int ilog2(int n) {
+  int r{};
+  while ((1 << r) < n) {
+    r++;
+  }
+  return r;
 }
 
+//  Fill bins (n/2, n) of a real-input spectrum from the conjugate-symmetric lower half.
 template <typename T>
-void fdft(T* out, const T* in, int n, int s, int level) {
-  if (n == 1) {
-    out[0] = in[0];
-  } else {
-    assert(level > 0);
-
-    const int n2 = n >> 1;
-    const int s2 = s << 1;
-
-    fdft(out, in, n2, s2, level - 1);
-    fdft(out + n, in + s, n2, s2, level - 1);  //  would be out + n/2, but * 2
-
-    for (int k = 0; k < n2; k++) {
-      T* p = out + k * 2;
-      T* q = out + (k * 2 + n);
-
-      const T p0 = p[0];
-      const T p1 = p[1];
-#if 1
-      const T re = T(twiddles[level - 1][k * 2 + 0]);
-      const T im = T(twiddles[level - 1][k * 2 + 1]);
-#else
-      (void) level;
-      const T w = T(-grove::two_pi()) / T(n) * T(k);
-      const T re = std::cos(w);
-      const T im = std::sin(w);
-#endif
-      T q0;
-      T q1;
-      cmul(re, im, q[0], q[1], &q0, &q1);
-
-      p[0] = p0 + q0;
-      p[1] = p1 + q1;
-      q[0] = p0 - q0;
-      q[1] = p1 - q1;
+void mirror_conjugate_half(T* out, int n) {
+  for (int k = n / 2 + 1; k < n; k++) {
+    out[k * 2] = out[(n - k) * 2];
+    out[k * 2 + 1] = -out[(n - k) * 2 + 1];
+  }
+}
+
+void fdft_double(double* out, const double* in, int n) {
+  const int log2_n = ilog2(n);
+  for (int i = 0; i < n; i++) {
+    int j{};
+    for (int b = 0; b < log2_n; b++) {
+      j = (j << 1) | ((i >> b) & 1);
+    }
+    out[j * 2] = in[i];
+    out[j * 2 + 1] = 0.0;
+  }
+
+  for (int h = 1; h < n; h <<= 1) {
+    const int stride = max_fdft_size / (h * 2);
+    for (int s = 0; s < n; s += h * 2) {
+      for (int k = 0; k < h; k++) {
+        const double wr = plans.double_twiddles[k * stride * 2];
+        const double wi = plans.double_twiddles[k * stride * 2 + 1];
+        double* p = out + (s + k) * 2;
+        double* q = p + h * 2;
+        const double qr = wr * q[0] - wi * q[1];
+        const double qi = wr * q[1] + wi * q[0];
+        q[0] = p[0] - qr;
+        q[1] = p[1] - qi;
+        p[0] += qr;
+        p[1] += qi;
+      }
     }
   }
 }
@@ -64,32 +68,40 @@ void fdft(T* out, const T* in, int n, int s, int level) {
 } //  anon
 
 void init_fdft() {
-  for (int i = 0; i < max_num_levels; i++) {
-    const int n = 1 << (i + 1);
-    for (int j = 0; j < n / 2; j++) {
-      const double w = -two_pi / double(n) * double(j);
-      twiddles[i][j * 2 + 0] = std::cos(w);
-      twiddles[i][j * 2 + 1] = std::sin(w);
-    }
+  if (plans.initialized) {
+    return;
+  }
+
+  for (int i = 1; i <= max_fdft_log2_size; i++) {
+    plans.real_plans[i] = make_real_fft_plan(1 << i);
+  }
+
+  plans.double_twiddles.resize(max_fdft_size);
+  for (int k = 0; k < max_fdft_size / 2; k++) {
+    const double w = -two_pi * double(k) / double(max_fdft_size);
+    plans.double_twiddles[k * 2 + 0] = std::cos(w);
+    plans.double_twiddles[k * 2 + 1] = std::sin(w);
   }
+
+  plans.initialized = true;
 }
 
 void fdft(float* out, const float* in, int n) {
-  if (n > 0) {
-    assert((n & (n - 1)) == 0 && n <= max_size);
-    const int level = int(std::log2(double(n)));
-    memset(out, 0, n * 2 * sizeof(float));
-    fdft(out, in, n, 1, level);
+  if (n == 1) {
+    out[0] = in[0];
+    out[1] = 0.0f;
+  } else if (n > 1) {
+    assert(plans.initialized && (n & (n - 1)) == 0 && n <= max_fdft_size);
+    real_fft(plans.real_plans[ilog2(n)], in, out);
+    mirror_conjugate_half(out, n);
   }
 }
 
 void fdft(double* out, const double* in, int n) {
   if (n > 0) {
-    assert((n & (n - 1)) == 0 && n <= max_size);
-    const int level = int(std::log2(double(n)));
-    memset(out, 0, n * 2 * sizeof(double));
-    fdft(out, in, n, 1, level);
+    assert(plans.initialized && (n & (n - 1)) == 0 && n <= max_fdft_size);
+    fdft_double(out, in, n);
   }
 }
 
-}
\ No newline at end of file
+}
@@ -2,8 +2,17 @@
 
 namespace grove {
 
+constexpr int max_fdft_log2_size = 14;
+constexpr int max_fdft_size = 1 << max_fdft_log2_size;
+
+//  Precompute plans for all power-of-two sizes up to `max_fdft_size`. Call once, before the
+//  render thread starts.
 void init_fdft();
+
+//  Full (`n` complex bins, interleaved) unnormalized spectrum of `n` real values. `n` must be a
+//  power of two no greater than `max_fdft_size`. See fft.hpp for plan-based transforms of
+//  arbitrary power-of-two size.
 void fdft(float* out, const float* in, int n);
 void fdft(double* out, const double* in, int n);
 
-}
\ No newline at end of file
+}
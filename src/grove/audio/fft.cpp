@@ -0,0 +1,340 @@
+#include "fft.hpp"
+#include "grove/math/simd.hpp"
+#include "grove/common/common.hpp"
+#include <cmath>
+#include <cassert>
+#include <utility>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr double two_pi = 6.28318530717958647692528676655900576;
+
+//  Per pair of butterflies (j, j + 1): {w1, w2, w3} x {re re re re, -im im -im im}
+constexpr int twiddle_floats_per_pair = 24;
+
+int ilog2(int n) {
+  int r{};
+  while ((1 << r) < n) {
+    r++;
+  }
+  return r;
+}
+
+uint32_t reverse_bits(uint32_t v, int num_bits) {
+  uint32_t r{};
+  for (int i = 0; i < num_bits; i++) {
+    r = (r << 1u) | ((v >> uint32_t(i)) & 1u);
+  }
+  return r;
+}
+
+void push_twiddle_pair(std::vector<float>& dst, int j, int m) {
+  for (int p = 1; p <= 3; p++) {
+    float re[2];
+    float im[2];
+    for (int i = 0; i < 2; i++) {
+      const double w = -two_pi * double(p * (j + i)) / double(4 * m);
+      re[i] = float(std::cos(w));
+      im[i] = float(std::sin(w));
+    }
+    dst.insert(dst.end(), {re[0], re[0], re[1], re[1]});
+    dst.insert(dst.end(), {-im[0], im[0], -im[1], im[1]});
+  }
+}
+
+void permute(const FFTPlan& plan, float* data) {
+  const auto& swaps = plan.bit_reverse_swaps;
+  for (size_t i = 0; i < swaps.size(); i += 2) {
+    const uint32_t a = swaps[i] * 2;
+    const uint32_t b = swaps[i + 1] * 2;
+    std::swap(data[a], data[b]);
+    std::swap(data[a + 1], data[b + 1]);
+  }
+}
+
+void radix2_pass(float* data, int n) {
+  for (int k = 0; k < n; k += 2) {
+    float* a = data + k * 2;
+    float* b = a + 2;
+    const float ar = a[0];
+    const float ai = a[1];
+    a[0] = ar + b[0];
+    a[1] = ai + b[1];
+    b[0] = ar - b[0];
+    b[1] = ai - b[1];
+  }
+}
+
+//  Radix-4 pass with m = 1; all twiddles are 1.
+void radix4_pass_unit(float* data, int n) {
+  for (int s = 0; s < n; s += 4) {
+    float* x = data + s * 2;
+    const float ar = x[0] + x[2];
+    const float ai = x[1] + x[3];
+    const float br = x[0] - x[2];
+    const float bi = x[1] - x[3];
+    const float cr = x[4] + x[6];
+    const float ci = x[5] + x[7];
+    //  (c - d) * -i
+    const float dr = x[5] - x[7];
+    const float di = -(x[4] - x[6]);
+    x[0] = ar + cr;
+    x[1] = ai + ci;
+    x[2] = br + dr;
+    x[3] = bi + di;
+    x[4] = ar - cr;
+    x[5] = ai - ci;
+    x[6] = br - dr;
+    x[7] = bi - di;
+  }
+}
+
+#if GROVE_SIMD_ENABLED
+
+inline simd::F4 cmul(simd::F4 x, const float* tw) {
+  return x * simd::load(tw) + simd::swap_pairs(x) * simd::load(tw + 4);
+}
+
+void radix4_pass(float* data, int n, int m, const float* twiddles) {
+  using namespace simd;
+  const F4 neg_i_sign = set(1.0f, -1.0f, 1.0f, -1.0f);
+
+  for (int s = 0; s < n; s += 4 * m) {
+    float* pa = data + s * 2;
+    float* pb = pa + m * 2;
+    float* pc = pb + m * 2;
+    float* pd = pc + m * 2;
+    const float* tw = twiddles;
+
+    for (int j = 0; j < m; j += 2) {
+      const int o = j * 2;
+      const F4 a = load(pa + o);
+      const F4 b = cmul(load(pb + o), tw + 8);
+      const F4 c = cmul(load(pc + o), tw);
+      const F4 d = cmul(load(pd + o), tw + 16);
+
+      const F4 A = a + b;
+      const F4 B = a - b;
+      const F4 C = c + d;
+      const F4 D = swap_pairs(c - d) * neg_i_sign;
+
+      store(pa + o, A + C);
+      store(pb + o, B + D);
+      store(pc + o, A - C);
+      store(pd + o, B - D);
+      tw += twiddle_floats_per_pair;
+    }
+  }
+}
+
+#else
+
+inline void cmul(const float* x, const float* tw, int lane, float* re, float* im) {
+  const float wr = tw[lane * 2];
+  const float wi = tw[4 + lane * 2 + 1];
+  *re = x[0] * wr - x[1] * wi;
+  *im = x[0] * wi + x[1] * wr;
+}
+
+void radix4_pass(float* data, int n, int m, const float* twiddles) {
+  for (int s = 0; s < n; s += 4 * m) {
+    for (int j = 0; j < m; j++) {
+      const float* tw = twiddles + (j / 2) * twiddle_floats_per_pair;
+      const int lane = j & 1;
+      float* pa = data + (s + j) * 2;
+      float* pb = pa + m * 2;
+      float* pc = pb + m * 2;
+      float* pd = pc + m * 2;
+
+      float br, bi, cr, ci, dr, di;
+      cmul(pb, tw + 8, lane, &br, &bi);
+      cmul(pc, tw, lane, &cr, &ci);
+      cmul(pd, tw + 16, lane, &dr, &di);
+
+      const float Ar = pa[0] + br;
+      const float Ai = pa[1] + bi;
+      const float Br = pa[0] - br;
+      const float Bi = pa[1] - bi;
+      const float Cr = cr + dr;
+      const float Ci = ci + di;
+      const float Dr = ci - di;
+      const float Di = -(cr - dr);
+
+      pa[0] = Ar + Cr;
+      pa[1] = Ai + Ci;
+      pb[0] = Br + Dr;
+      pb[1] = Bi + Di;
+      pc[0] = Ar - Cr;
+      pc[1] = Ai - Ci;
+      pd[0] = Br - Dr;
+      pd[1] = Bi - Di;
+    }
+  }
+}
+
+#endif
+
+void conjugate(float* data, int n) {
+  for (int i = 0; i < n; i++) {
+    data[i * 2 + 1] = -data[i * 2 + 1];
+  }
+}
+
+} //  anon
+
+FFTPlan make_fft_plan(int size) {
+  assert(size > 0 && (size & (size - 1)) == 0);
+
+  FFTPlan plan;
+  plan.size = size;
+  plan.log2_size = ilog2(size);
+
+  for (int i = 0; i < size; i++) {
+    auto j = int(reverse_bits(uint32_t(i), plan.log2_size));
+    if (i < j) {
+      plan.bit_reverse_swaps.push_back(uint32_t(i));
+      plan.bit_reverse_swaps.push_back(uint32_t(j));
+    }
+  }
+
+  //  The first pass (radix-2 for odd powers of two, radix-4 otherwise) has unit twiddles.
+  for (int m = (plan.log2_size & 1) ? 2 : 4; m < size; m *= 4) {
+    plan.pass_twiddle_offsets.push_back(int(plan.twiddles.size()));
+    for (int j = 0; j < m; j += 2) {
+      push_twiddle_pair(plan.twiddles, j, m);
+    }
+  }
+
+  return plan;
+}
+
+RealFFTPlan make_real_fft_plan(int size) {
+  assert(size >= 2 && (size & (size - 1)) == 0);
+
+  RealFFTPlan plan;
+  plan.size = size;
+  plan.half_plan = make_fft_plan(size / 2);
+
+  const int n = size / 2;
+  for (int k = 0; k <= n / 2; k++) {
+    const double w = -two_pi * double(k) / double(size);
+    plan.twiddles.push_back(float(std::cos(w)));
+    plan.twiddles.push_back(float(std::sin(w)));
+  }
+
+  return plan;
+}
+
+void fft(const FFTPlan& plan, float* data) {
+  const int n = plan.size;
+  if (n <= 1) {
+    return;
+  }
+
+  permute(plan, data);
+
+  int m = 1;
+  if (plan.log2_size & 1) {
+    radix2_pass(data, n);
+    m = 2;
+  } else {
+    radix4_pass_unit(data, n);
+    m = 4;
+  }
+
+  for (int pass = 0; m < n; m *= 4, pass++) {
+    assert(pass < int(plan.pass_twiddle_offsets.size()));
+    radix4_pass(data, n, m, plan.twiddles.data() + plan.pass_twiddle_offsets[pass]);
+  }
+}
+
+void ifft(const FFTPlan& plan, float* data) {
+  const int n = plan.size;
+  conjugate(data, n);
+  fft(plan, data);
+  conjugate(data, n);
+
+  const float inv_n = 1.0f / float(n);
+  for (int i = 0; i < n * 2; i++) {
+    data[i] *= inv_n;
+  }
+}
+
+void real_fft(const RealFFTPlan& plan, const float* in, float* out) {
+  const int n = plan.size / 2;
+
+  //  Treat even / odd samples as the real / imaginary parts of `n` complex values.
+  std::copy(in, in + n * 2, out);
+  fft(plan.half_plan, out);
+  out[n * 2 + 0] = out[0];
+  out[n * 2 + 1] = out[1];
+
+  for (int k = 0; k <= n / 2; k++) {
+    const int nk = n - k;
+    const float zr = out[k * 2];
+    const float zi = out[k * 2 + 1];
+    const float zcr = out[nk * 2];
+    const float zci = -out[nk * 2 + 1];
+
+    //  fe = (z[k] + conj(z[n-k])) / 2; fo = -i/2 * (z[k] - conj(z[n-k]))
+    const float fer = 0.5f * (zr + zcr);
+    const float fei = 0.5f * (zi + zci);
+    const float for_ = 0.5f * (zi - zci);
+    const float foi = -0.5f * (zr - zcr);
+
+    const float wr = plan.twiddles[k * 2];
+    const float wi = plan.twiddles[k * 2 + 1];
+    const float wfr = wr * for_ - wi * foi;
+    const float wfi = wr * foi + wi * for_;
+
+    out[k * 2] = fer + wfr;
+    out[k * 2 + 1] = fei + wfi;
+    if (nk != k) {
+      out[nk * 2] = fer - wfr;
+      out[nk * 2 + 1] = -(fei - wfi);
+    }
+  }
+}
+
+void real_ifft(const RealFFTPlan& plan, const float* in, float* out) {
+  const int n = plan.size / 2;
+  assert(in != out);
+
+  //  Rebuild z[k] = fe[k] + i * fo[k], where fe / fo are the spectra of the even / odd samples:
+  //  fe = (x[k] + conj(x[n-k])) / 2; fo = (x[k] - conj(x[n-k])) * conj(w^k) / 2
+  for (int k = 0; k <= n / 2; k++) {
+    const int nk = n - k;
+    const float xr = in[k * 2];
+    const float xi = in[k * 2 + 1];
+    const float xcr = in[nk * 2];
+    const float xci = -in[nk * 2 + 1];
+
+    const float fer = 0.5f * (xr + xcr);
+    const float fei = 0.5f * (xi + xci);
+    const float dr = 0.5f * (xr - xcr);
+    const float di = 0.5f * (xi - xci);
+
+    const float wr = plan.twiddles[k * 2];
+    const float wi = -plan.twiddles[k * 2 + 1];
+    const float for_ = dr * wr - di * wi;
+    const float foi = dr * wi + di * wr;
+
+    out[k * 2] = fer - foi;
+    out[k * 2 + 1] = fei + for_;
+    if (nk != k && nk < n) {
+      //  Same terms for bin n - k, using w^(n-k) = -conj(w^k).
+      const float ner = fer;
+      const float nei = -fei;
+      const float nor = for_;
+      const float noi = -foi;
+      out[nk * 2] = ner - noi;
+      out[nk * 2 + 1] = nei + nor;
+    }
+  }
+
+  ifft(plan.half_plan, out);
+}
+
+GROVE_NAMESPACE_END
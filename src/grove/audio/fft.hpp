@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace grove {
+
+/*
+ * FFTPlan
+ *
+ * Precomputed bit-reversal permutation and twiddle factors for an in-place, iterative radix-4
+ * (+ one radix-2 pass for odd powers of two) decimation-in-time transform of `size` complex
+ * values. Complex values are interleaved as [re0, im0, re1, im1, ...].
+ */
+
+struct FFTPlan {
+  int size{};
+  int log2_size{};
+  std::vector<uint32_t> bit_reverse_swaps;  //  pairs (i, j), i < j
+  std::vector<float> twiddles;
+  std::vector<int> pass_twiddle_offsets;
+};
+
+/*
+ * RealFFTPlan
+ *
+ * Transform of `size` real values via a complex transform of `size / 2` values. Produces the
+ * `size / 2 + 1` non-redundant bins of the (conjugate-symmetric) spectrum.
+ */
+
+struct RealFFTPlan {
+  int size{};
+  FFTPlan half_plan;
+  std::vector<float> twiddles;
+};
+
+//  `size` must be a power of two.
+FFTPlan make_fft_plan(int size);
+RealFFTPlan make_real_fft_plan(int size);
+
+//  Forward transform, unnormalized.
+void fft(const FFTPlan& plan, float* data);
+//  Inverse transform, normalized by 1 / size.
+void ifft(const FFTPlan& plan, float* data);
+
+//  `in` has `plan.size` real values; `out` receives `plan.size / 2 + 1` interleaved complex
+//  values. Unnormalized.
+void real_fft(const RealFFTPlan& plan, const float* in, float* out);
+//  Inverse of `real_fft`: `in` has `plan.size / 2 + 1` interleaved complex values; `out`
+//  receives `plan.size` real values. Normalized by 1 / size. `in` and `out` must not alias.
+void real_ifft(const RealFFTPlan& plan, const float* in, float* out);
+
+}
@@ -0,0 +1,115 @@
+#include "offline_render.hpp"
+#include "AudioRenderer.hpp"
+#include "AudioStream.hpp"
+#include "grove/load/wav.hpp"
+#include "grove/common/common.hpp"
+#include <algorithm>
+#include <chrono>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//  Samples rendered before the call (e.g. by the audio thread) are not part of the output.
+void discard_pending_output(AudioRenderer& renderer, std::vector<Sample>& scratch,
+                            int num_channels, int quantum) {
+  while (renderer.num_samples_to_read() >= num_channels) {
+    const int num_frames = std::min(quantum, renderer.num_samples_to_read() / num_channels);
+    renderer.output(scratch.data(), num_frames, 0.0);
+  }
+}
+
+void gather_node_timings(const AudioGraphRenderer& graph_renderer, double duration_s,
+                         OfflineRenderResult& result) {
+  std::vector<AudioGraphRenderer::NodeTiming> timings;
+  graph_renderer.get_node_timings(timings);
+
+  for (auto& timing : timings) {
+    OfflineRenderNodeTiming node_timing{};
+    node_timing.node = timing.node;
+    node_timing.node_id = timing.node_id;
+    node_timing.total_ms = timing.total_ms;
+    node_timing.realtime_factor = timing.total_ms > 0.0 ?
+      duration_s * 1e3 / timing.total_ms : 0.0;
+    result.node_timings.push_back(node_timing);
+  }
+
+  std::sort(result.node_timings.begin(), result.node_timings.end(), [](auto& a, auto& b) {
+    return a.total_ms > b.total_ms;
+  });
+}
+
+} //  anon
+
+OfflineRenderResult render_offline(AudioRenderer& renderer, const OfflineRenderParams& params) {
+  OfflineRenderResult result{};
+  if (params.num_output_channels <= 0 || params.sample_rate <= 0.0) {
+    return result;
+  }
+
+  const int num_channels = params.num_output_channels;
+  const int quantum = std::max(1, std::min(
+    params.frames_per_render_quantum, AudioRenderer::max_render_quantum_frames(num_channels)));
+
+  AudioStreamInfo stream_info{};
+  stream_info.num_output_channels = num_channels;
+  stream_info.sample_rate = params.sample_rate;
+  stream_info.frames_per_buffer = quantum;
+  stream_info.frames_per_render_quantum = quantum;
+  renderer.maybe_apply_new_stream_info(stream_info);
+
+  std::vector<Sample> output(quantum * num_channels);
+  discard_pending_output(renderer, output, num_channels, quantum);
+
+  wav::FileWriter writer;
+  const bool write_output = !params.wav_file_path.empty();
+  if (write_output && !wav::open_wav_file_writer(
+    &writer, params.wav_file_path, uint16_t(num_channels), uint32_t(params.sample_rate))) {
+    return result;
+  }
+
+  if (params.graph_renderer) {
+    params.graph_renderer->clear_node_timings();
+    params.graph_renderer->set_node_timing_enabled(true);
+  }
+
+  const auto total_frames = uint64_t(std::max(0.0, params.duration_s) * params.sample_rate);
+  bool wrote_output{true};
+  uint64_t frame{};
+  const auto t0 = Clock::now();
+
+  while (frame < total_frames) {
+    const double time = double(frame) / params.sample_rate;
+    renderer.render(time);
+    renderer.output(output.data(), quantum, time);
+
+    const auto num_write = uint32_t(std::min(uint64_t(quantum), total_frames - frame));
+    if (write_output) {
+      wrote_output &= wav::write_wav_frames(&writer, output.data(), num_write);
+    }
+    frame += num_write;
+  }
+
+  result.elapsed_s = std::chrono::duration<double>(Clock::now() - t0).count();
+  result.num_frames = total_frames;
+  result.frames_per_render_quantum = quantum;
+
+  const double duration_s = double(total_frames) / params.sample_rate;
+  result.realtime_factor = result.elapsed_s > 0.0 ? duration_s / result.elapsed_s : 0.0;
+
+  if (params.graph_renderer) {
+    params.graph_renderer->set_node_timing_enabled(false);
+    gather_node_timings(*params.graph_renderer, duration_s, result);
+  }
+
+  if (write_output) {
+    wrote_output &= wav::close_wav_file_writer(&writer);
+  }
+
+  result.success = wrote_output;
+  return result;
+}
+
+GROVE_NAMESPACE_END
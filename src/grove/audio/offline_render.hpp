@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AudioGraphRenderer.hpp"
+#include <string>
+#include <vector>
+
+namespace grove {
+
+class AudioRenderer;
+
+/*
+ * render_offline
+ *
+ * Drive `AudioRenderer::render` without an audio device, as fast as possible, and optionally
+ * write the output to a 16-bit wav file. Whatever is registered with the renderer (graph
+ * renderers, timeline systems, transports, ...) is rendered as it would be by the audio thread,
+ * so the result also serves as a benchmark of the whole render path.
+ *
+ * The caller must ensure that no other thread renders with `renderer` for the duration of the
+ * call; see `AudioCore::ui_render_offline`. Render-side state such as transport positions
+ * advances as if the session had played for `duration_s` seconds.
+ */
+
+struct OfflineRenderParams {
+  double sample_rate{44.1e3};
+  int num_output_channels{2};
+  //  Clamped to `AudioRenderer::max_render_quantum_frames`.
+  int frames_per_render_quantum{2048};
+  double duration_s{};
+  //  If empty, the output is discarded.
+  std::string wav_file_path;
+  //  If non-null, per-node timings are collected from this graph renderer.
+  AudioGraphRenderer* graph_renderer{};
+};
+
+struct OfflineRenderNodeTiming {
+  AudioProcessorNode* node{};
+  uint32_t node_id{};
+  double total_ms{};
+  //  Duration of rendered audio divided by the time spent processing this node.
+  double realtime_factor{};
+};
+
+struct OfflineRenderResult {
+  bool success{};
+  uint64_t num_frames{};
+  int frames_per_render_quantum{};
+  double elapsed_s{};
+  //  Duration of rendered audio divided by the elapsed time; > 1 is faster than real time.
+  double realtime_factor{};
+  //  Sorted by decreasing `total_ms`.
+  std::vector<OfflineRenderNodeTiming> node_timings;
+};
+
+OfflineRenderResult render_offline(AudioRenderer& renderer, const OfflineRenderParams& params);
+
+}
@@ -94,6 +94,13 @@ public:
 
   Sample tick();
   Sample read(double phase) const;
+  //  Returns the phase `tick` would read at, and advances it as `tick` does.
+  double tick_phase();
+
+  //  `size + 1` samples; the last repeats the first, for interpolation.
+  const Sample* data() const {
+    return table.data();
+  }
 
 private:
   double period_over_sr;
@@ -137,6 +144,12 @@ inline Sample WaveTable::tick() {
   return Sample(sample);
 }
 
+inline double WaveTable::tick_phase() {
+  const double phase = current_phase;
+  detail::increment_phase(current_phase, period_over_sr * frequency, double(size));
+  return phase;
+}
+
 /*
  * Sin impl.
  */
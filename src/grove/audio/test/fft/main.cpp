@@ -0,0 +1,146 @@
+#include "grove/audio/fft.hpp"
+#include "grove/audio/fdft.hpp"
+#include "grove/audio/dft.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr double two_pi = 6.28318530717958647692528676655900576;
+
+/*
+ * The previous recursive, out-of-place radix-2 transform with per-level twiddle tables, kept
+ * here as a baseline.
+ */
+
+std::vector<std::vector<float>> recursive_twiddles;
+
+void init_recursive_fdft() {
+  for (int i = 0; i < max_fdft_log2_size; i++) {
+    const int n = 1 << (i + 1);
+    std::vector<float> level(n);
+    for (int j = 0; j < n / 2; j++) {
+      const double w = -two_pi / double(n) * double(j);
+      level[j * 2 + 0] = float(std::cos(w));
+      level[j * 2 + 1] = float(std::sin(w));
+    }
+    recursive_twiddles.push_back(std::move(level));
+  }
+}
+
+void recursive_fdft(float* out, const float* in, int n, int s, int level) {
+  if (n == 1) {
+    out[0] = in[0];
+    return;
+  }
+
+  const int n2 = n >> 1;
+  recursive_fdft(out, in, n2, s << 1, level - 1);
+  recursive_fdft(out + n, in + s, n2, s << 1, level - 1);
+
+  const float* twiddles = recursive_twiddles[level - 1].data();
+  for (int k = 0; k < n2; k++) {
+    float* p = out + k * 2;
+    float* q = out + (k * 2 + n);
+    const float re = twiddles[k * 2 + 0];
+    const float im = twiddles[k * 2 + 1];
+    const float q0 = re * q[0] - im * q[1];
+    const float q1 = re * q[1] + im * q[0];
+    const float p0 = p[0];
+    const float p1 = p[1];
+    p[0] = p0 + q0;
+    p[1] = p1 + q1;
+    q[0] = p0 - q0;
+    q[1] = p1 - q1;
+  }
+}
+
+template <typename F>
+double time_per_call_us(int num_iters, F&& f) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_iters; i++) {
+    f();
+  }
+  auto t1 = Clock::now();
+  return std::chrono::duration<double>(t1 - t0).count() * 1e6 / double(num_iters);
+}
+
+float max_abs_diff(const float* a, const float* b, int n) {
+  float res{};
+  for (int i = 0; i < n; i++) {
+    res = std::max(res, std::abs(a[i] - b[i]));
+  }
+  return res;
+}
+
+} //  anon
+
+int main(int, char**) {
+  init_fdft();
+  init_recursive_fdft();
+
+  for (int n = 64, level = 6; n <= max_fdft_size; n *= 2, level++) {
+    std::vector<float> src(n);
+    for (int i = 0; i < n; i++) {
+      src[i] = float(std::sin(double(i) * 0.05) + 0.25 * std::cos(double(i) * 1.7));
+    }
+
+    std::vector<float> ref_out(n * 2);
+    std::vector<float> fdft_out(n * 2);
+    std::vector<float> complex_out(n * 2);
+    std::vector<float> real_out(n + 2);
+    std::vector<float> inverse_out(n);
+
+    auto plan = make_fft_plan(n);
+    auto real_plan = make_real_fft_plan(n);
+    const int num_iters = std::max(8, (1 << 22) / n);
+
+    const double recursive_us = time_per_call_us(num_iters, [&]() {
+      std::memset(ref_out.data(), 0, ref_out.size() * sizeof(float));
+      recursive_fdft(ref_out.data(), src.data(), n, 1, level);
+    });
+    const double fdft_us = time_per_call_us(num_iters, [&]() {
+      fdft(fdft_out.data(), src.data(), n);
+    });
+    const double complex_us = time_per_call_us(num_iters, [&]() {
+      for (int i = 0; i < n; i++) {
+        complex_out[i * 2] = src[i];
+        complex_out[i * 2 + 1] = 0.0f;
+      }
+      fft(plan, complex_out.data());
+    });
+    const double real_us = time_per_call_us(num_iters, [&]() {
+      real_fft(real_plan, src.data(), real_out.data());
+    });
+    const double real_inverse_us = time_per_call_us(num_iters, [&]() {
+      real_ifft(real_plan, real_out.data(), inverse_out.data());
+    });
+
+    std::cout << "n = " << n
+              << "; recursive: " << recursive_us << "us"
+              << "; fdft: " << fdft_us << "us"
+              << "; fft: " << complex_us << "us"
+              << "; real_fft: " << real_us << "us"
+              << "; real_ifft: " << real_inverse_us << "us"
+              << "; max err: " << max_abs_diff(ref_out.data(), fdft_out.data(), n * 2)
+              << "; round trip err: " << max_abs_diff(src.data(), inverse_out.data(), n)
+              << std::endl;
+
+    if (n <= 1024) {
+      std::vector<float> dft_out(n * 2);
+      const double dft_us = time_per_call_us(4, [&]() {
+        dft(src.data(), dft_out.data(), n);
+      });
+      std::cout << "\tdft: " << dft_us << "us" << std::endl;
+    }
+  }
+
+  return 0;
+}
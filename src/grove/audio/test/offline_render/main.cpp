@@ -0,0 +1,96 @@
+#include "grove/audio/offline_render.hpp"
+#include "grove/audio/AudioRenderer.hpp"
+#include "grove/audio/AudioGraph.hpp"
+#include "grove/audio/AudioGraphRenderer.hpp"
+#include "grove/audio/AudioParameterSystem.hpp"
+#include "grove/audio/AudioEventSystem.hpp"
+#include "grove/audio/Transport.hpp"
+#include "grove/audio/fdft.hpp"
+#include "grove/audio/audio_processor_nodes/OscillatorNode.hpp"
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace grove;
+
+/*
+ * Renders a fixed graph of oscillators feeding destination nodes for `duration_s` seconds without
+ * an audio device, and reports the real-time factor of the whole render and of each node.
+ * Pass a file path to also write the output as wav.
+ */
+
+namespace {
+
+constexpr int num_voices = 64;
+constexpr int num_channels = 2;
+constexpr double duration_s = 60.0;
+
+} //  anon
+
+int main(int argc, char** argv) {
+  init_fdft();
+  audio_event_system::ui_initialize();
+
+  auto* param_sys = param_system::get_global_audio_parameter_system();
+
+  AudioRenderer renderer;
+  Transport transport;
+  AudioGraph graph;
+  AudioGraphDoubleBuffer double_buffer;
+  AudioGraphRenderer graph_renderer{&double_buffer};
+  param_system::ui_initialize(param_sys, &transport);
+
+  std::vector<std::unique_ptr<OscillatorNode>> oscillators;
+  for (int i = 0; i < num_voices; i++) {
+    auto osc = std::make_unique<OscillatorNode>(
+      uint32_t(i * 2 + 1), param_sys, &transport, num_channels);
+    auto* dest = graph_renderer.create_destination(uint32_t(i * 2 + 2), param_sys, num_channels);
+
+    auto outs = osc->outputs();
+    auto ins = dest->inputs();
+    for (int j = 0; j < num_channels; j++) {
+      auto res = graph.connect(outs[j], ins[j]);
+      if (!res.success()) {
+        std::cout << "Failed to connect: " << to_string(res.status) << std::endl;
+        return 1;
+      }
+    }
+
+    oscillators.push_back(std::move(osc));
+  }
+
+  OfflineRenderParams params{};
+  params.num_output_channels = num_channels;
+  params.duration_s = duration_s;
+  params.graph_renderer = &graph_renderer;
+  if (argc > 1) {
+    params.wav_file_path = argv[1];
+  }
+
+  double_buffer.modify(graph, AudioRenderer::max_render_quantum_frames(num_channels));
+  (void) double_buffer.update();
+
+  auto accessors = renderer.get_accessors();
+  accessors.transports->writer_add(&transport);
+  accessors.renderables->writer_add(&graph_renderer);
+  (void) accessors.transports->writer_update();
+  (void) accessors.renderables->writer_update();
+
+  auto res = render_offline(renderer, params);
+  audio_event_system::ui_terminate();
+  if (!res.success) {
+    std::cout << "Offline render failed." << std::endl;
+    return 1;
+  }
+
+  std::cout << "Rendered " << res.num_frames << " frames in " << res.elapsed_s << "s"
+            << " (quantum: " << res.frames_per_render_quantum << " frames)"
+            << "; real-time factor: " << res.realtime_factor << std::endl;
+
+  for (auto& timing : res.node_timings) {
+    std::cout << "\tnode " << timing.node_id << ": " << timing.total_ms << "ms"
+              << "; real-time factor: " << timing.realtime_factor << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,375 @@
+#include "grove/audio/voice_kernels.hpp"
+#include "grove/audio/envelope.hpp"
+#include "grove/audio/oscillator.hpp"
+#include "grove/audio/filter.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+constexpr int num_voices = 32;
+constexpr int num_groups = num_voices / audio::num_voice_lanes;
+constexpr int num_frames = 256;
+static_assert(num_frames % 64 == 0);
+constexpr int num_quanta = 2000;
+constexpr double sample_rate = 44.1e3;
+
+/*
+ * Per-sample ladder filter, as used by MoogLPFilterNode before it was moved to the block kernel.
+ */
+
+struct ScalarMoogLPFilter {
+  void update(double sr, float cut, float res) {
+    auto f = float((cut + cut) / sr);
+    p = f * (1.8f - 0.8f * f);
+    k = p + p - 1.0f;
+    auto t = (1.0f - p) * 1.386249f;
+    auto t2 = 12.0f + t * t;
+    r = res * (t2 + 6.0f * t) / (t2 - 6.0f * t);
+  }
+
+  float tick(float curr) {
+    x = curr - r * y4;
+    y1 = x * p + last_x * p - k * y1;
+    y2 = y1 * p + last_y1 * p - k * y2;
+    y3 = y2 * p + last_y2 * p - k * y3;
+    y4 = y3 * p + last_y3 * p - k * y4;
+    y4 -= (y4 * y4 * y4) / 6.0f;
+    last_x = x;
+    last_y1 = y1;
+    last_y2 = y2;
+    last_y3 = y3;
+    return y4;
+  }
+
+  float y1{}, y2{}, y3{}, y4{}, last_x{}, last_y1{}, last_y2{}, last_y3{}, x{}, r{}, p{}, k{};
+};
+
+float cutoff(int v) {
+  return 400.0f + float(v) * 100.0f;
+}
+
+Envelope::Params envelope_params(int v) {
+  auto params = Envelope::Params::default_exp(false);
+  if (v % 4 == 3) {
+    //  Segments several seconds long, as in SteerableSynth1.
+    params.attack_time = 1.0 + 0.25 * v;
+    params.decay_time = 2.0;
+    params.sustain_time = 0.5;
+    params.release_time = 0.0;
+  } else {
+    params.attack_time = 0.01 + 0.001 * v;
+    params.decay_time = 0.05;
+    params.sustain_time = 0.2;
+    params.release_time = 0.1;
+  }
+  return params;
+}
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+void report(const char* name, double scalar_ms, double block_ms, double max_err) {
+  const double num_samples = double(num_voices) * num_frames * num_quanta;
+  std::cout << name
+            << "; scalar: " << scalar_ms * 1e6 / num_samples << "ns/sample"
+            << "; block: " << block_ms * 1e6 / num_samples << "ns/sample"
+            << "; speedup: " << scalar_ms / block_ms << "x"
+            << "; max err: " << max_err
+            << std::endl;
+}
+
+double frequency(int v) {
+  return 110.0 * std::pow(2.0, double(v) / 12.0);
+}
+
+//  Coefficients of the FDN filters in Reverb1.
+const double biquad_b[4][3] = {
+  {0.025176114554401, 0.050352229108803, 0.025176114554401},
+  {0.057200372524856, 0.114400745049711, 0.057200372524856},
+  {0.083159869929952, 0.166319739859905, 0.083159869929952},
+  {0.112055205606069, 0.224110411212137, 0.112055205606069},
+};
+const double biquad_a[4][3] = {
+  {1.0, -1.503695341299222, 0.604399799516827},
+  {1.0, -1.218879336445587, 0.447680826545010},
+  {1.0, -1.035171209738942, 0.367810689458751},
+  {1.0, -0.855989502672595, 0.304210325096870},
+};
+
+template <typename T>
+T max_abs_diff(const std::vector<T>& scalar, const std::vector<T>& block) {
+  T res{};
+  for (int v = 0; v < num_voices; v++) {
+    const int g = v / audio::num_voice_lanes;
+    const int lane = v % audio::num_voice_lanes;
+    for (int i = 0; i < num_frames; i++) {
+      const T a = scalar[v * num_frames + i];
+      const T b = block[(g * num_frames + i) * audio::num_voice_lanes + lane];
+      res = std::max(res, std::abs(a - b));
+    }
+  }
+  return res;
+}
+
+template <typename T = float>
+std::vector<T> make_input() {
+  std::vector<T> result(num_voices * num_frames);
+  for (int v = 0; v < num_voices; v++) {
+    for (int i = 0; i < num_frames; i++) {
+      result[v * num_frames + i] = T(float(std::sin(double(i) * 0.03 * (v + 1))));
+    }
+  }
+  return result;
+}
+
+template <typename T>
+std::vector<T> interleave(const std::vector<T>& src) {
+  std::vector<T> result(src.size());
+  for (int v = 0; v < num_voices; v++) {
+    const int g = v / audio::num_voice_lanes;
+    const int lane = v % audio::num_voice_lanes;
+    for (int i = 0; i < num_frames; i++) {
+      result[(g * num_frames + i) * audio::num_voice_lanes + lane] = src[v * num_frames + i];
+    }
+  }
+  return result;
+}
+
+float bench_wavetable() {
+  std::vector<osc::WaveTable> scalar(num_voices);
+  std::vector<audio::WaveTableVoices4> block(num_groups);
+  for (int v = 0; v < num_voices; v++) {
+    scalar[v].set_sample_rate(sample_rate);
+    scalar[v].set_frequency(frequency(v));
+    scalar[v].fill_tri(4);
+    block[v / audio::num_voice_lanes].set_frequency(
+      v % audio::num_voice_lanes, sample_rate, frequency(v), osc::WaveTable::size);
+  }
+
+  const float* table = scalar[0].data();
+  std::vector<float> scalar_out(num_voices * num_frames);
+  std::vector<float> block_out(num_voices * num_frames);
+
+  double scalar_ms{};
+  double block_ms{};
+  float max_err{};
+  for (int q = 0; q < num_quanta; q++) {
+    scalar_ms += time_ms([&]() {
+      for (int v = 0; v < num_voices; v++) {
+        for (int i = 0; i < num_frames; i++) {
+          scalar_out[v * num_frames + i] = scalar[v].tick();
+        }
+      }
+    });
+    block_ms += time_ms([&]() {
+      for (int g = 0; g < num_groups; g++) {
+        auto* out = block_out.data() + g * num_frames * audio::num_voice_lanes;
+        block[g].process(table, osc::WaveTable::size, out, num_frames);
+      }
+    });
+    max_err = std::max(max_err, max_abs_diff(scalar_out, block_out));
+  }
+
+  report("wavetable", scalar_ms, block_ms, max_err);
+  return max_err;
+}
+
+/*
+ * A single frequency-modulated voice, as rendered by ModulatedOscillatorNode.
+ */
+float bench_wavetable_read() {
+  osc::WaveTable scalar;
+  osc::WaveTable block;
+  for (auto* osc : {&scalar, &block}) {
+    osc->set_sample_rate(sample_rate);
+    osc->fill_tri(4);
+  }
+
+  const auto mod = make_input();
+  std::vector<float> scalar_out(num_voices * num_frames);
+  std::vector<float> block_out(num_voices * num_frames);
+
+  double scalar_ms{};
+  double block_ms{};
+  float max_err{};
+  for (int q = 0; q < num_quanta; q++) {
+    //  Each of `num_voices` consecutive quanta of one voice.
+    scalar_ms += time_ms([&]() {
+      for (int v = 0; v < num_voices; v++) {
+        const double f = frequency(v);
+        for (int i = 0; i < num_frames; i++) {
+          scalar.set_frequency(f + mod[v * num_frames + i] * 5.0);
+          scalar_out[v * num_frames + i] = scalar.tick();
+        }
+      }
+    });
+    block_ms += time_ms([&]() {
+      for (int v = 0; v < num_voices; v++) {
+        const double f = frequency(v);
+        //  In blocks of 64 frames, as in the oscillator nodes.
+        for (int i0 = 0; i0 < num_frames; i0 += 64) {
+          double phases[64];
+          for (int i = 0; i < 64; i++) {
+            block.set_frequency(f + mod[v * num_frames + i0 + i] * 5.0);
+            phases[i] = block.tick_phase();
+          }
+          audio::wavetable_read(block.data(), phases, &block_out[v * num_frames + i0], 64);
+        }
+      }
+    });
+    for (int i = 0; i < num_voices * num_frames; i++) {
+      max_err = std::max(max_err, std::abs(scalar_out[i] - block_out[i]));
+    }
+  }
+
+  report("wavetable_read", scalar_ms, block_ms, max_err);
+  return max_err;
+}
+
+double bench_biquad() {
+  using Filter = audio::LinearFilter<double, 3, 3>;
+  std::vector<Filter> scalar(num_voices);
+  std::vector<audio::Biquad4> block(num_groups);
+  for (int v = 0; v < num_voices; v++) {
+    const int lane = v % audio::num_voice_lanes;
+    scalar[v].set_b(biquad_b[lane], 3);
+    scalar[v].set_a(biquad_a[lane], 3);
+    block[v / audio::num_voice_lanes].set_coefficients(lane, biquad_b[lane], biquad_a[lane]);
+  }
+
+  const auto input = make_input<double>();
+  const auto interleaved_input = interleave(input);
+  auto scalar_out = input;
+  auto block_out = interleaved_input;
+
+  double scalar_ms{};
+  double block_ms{};
+  double max_err{};
+  for (int q = 0; q < num_quanta; q++) {
+    scalar_ms += time_ms([&]() {
+      scalar_out = input;
+      for (int v = 0; v < num_voices; v++) {
+        scalar[v].process(scalar_out.data() + v * num_frames, num_frames);
+      }
+    });
+    block_ms += time_ms([&]() {
+      block_out = interleaved_input;
+      for (int g = 0; g < num_groups; g++) {
+        block[g].process(block_out.data() + g * num_frames * audio::num_voice_lanes, num_frames);
+      }
+    });
+    max_err = std::max(max_err, max_abs_diff(scalar_out, block_out));
+  }
+
+  report("biquad", scalar_ms, block_ms, max_err);
+  return max_err;
+}
+
+void bench_moog() {
+  std::vector<ScalarMoogLPFilter> scalar(num_voices);
+  std::vector<audio::MoogLPFilter4> block(num_groups);
+  for (int v = 0; v < num_voices; v++) {
+    scalar[v].update(sample_rate, cutoff(v), 0.5f);
+    block[v / audio::num_voice_lanes].set_coefficients(
+      v % audio::num_voice_lanes, sample_rate, cutoff(v), 0.5f);
+  }
+
+  const auto input = make_input();
+  const auto interleaved_input = interleave(input);
+  auto scalar_out = input;
+  auto block_out = interleaved_input;
+
+  const double scalar_ms = time_ms([&]() {
+    for (int q = 0; q < num_quanta; q++) {
+      scalar_out = input;
+      for (int v = 0; v < num_voices; v++) {
+        for (int i = 0; i < num_frames; i++) {
+          auto& s = scalar_out[v * num_frames + i];
+          s = scalar[v].tick(s);
+        }
+      }
+    }
+  });
+  const double block_ms = time_ms([&]() {
+    for (int q = 0; q < num_quanta; q++) {
+      block_out = interleaved_input;
+      for (int g = 0; g < num_groups; g++) {
+        block[g].process(block_out.data() + g * num_frames * audio::num_voice_lanes, num_frames);
+      }
+    }
+  });
+
+  report("moog_lp", scalar_ms, block_ms, max_abs_diff(scalar_out, block_out));
+}
+
+float bench_adsr() {
+  std::vector<env::ADSRExp<float>> scalar(num_voices);
+  std::vector<audio::ADSRExp4> block(num_groups);
+  for (int v = 0; v < num_voices; v++) {
+    scalar[v].configure(envelope_params(v));
+    block[v / audio::num_voice_lanes].configure(v % audio::num_voice_lanes, envelope_params(v));
+  }
+
+  auto note_on_all = [&]() {
+    for (int v = 0; v < num_voices; v++) {
+      scalar[v].note_on();
+      block[v / audio::num_voice_lanes].note_on(v % audio::num_voice_lanes);
+    }
+  };
+
+  std::vector<float> scalar_out(num_voices * num_frames);
+  std::vector<float> block_out(num_voices * num_frames);
+  //  Retrigger every few seconds, so that some of the long envelopes are interrupted.
+  const int retrigger_interval = int(6.0 * sample_rate) / num_frames;
+
+  double scalar_ms{};
+  double block_ms{};
+  float max_err{};
+  for (int q = 0; q < num_quanta; q++) {
+    if (q % retrigger_interval == 0) {
+      note_on_all();
+    }
+    scalar_ms += time_ms([&]() {
+      for (int v = 0; v < num_voices; v++) {
+        for (int i = 0; i < num_frames; i++) {
+          scalar_out[v * num_frames + i] = scalar[v].tick(sample_rate);
+        }
+      }
+    });
+    block_ms += time_ms([&]() {
+      for (int g = 0; g < num_groups; g++) {
+        auto* out = block_out.data() + g * num_frames * audio::num_voice_lanes;
+        block[g].process(sample_rate, out, num_frames);
+      }
+    });
+    max_err = std::max(max_err, max_abs_diff(scalar_out, block_out));
+  }
+
+  report("adsr_exp", scalar_ms, block_ms, max_err);
+  return max_err;
+}
+
+} //  anon
+
+int main(int, char**) {
+  std::cout << num_voices << " voices, " << num_frames << " frames per quantum" << std::endl;
+  //  Except for the ladder filter, the block kernels compute what the scalar code computes, so the
+  //  output should match exactly.
+  bool exact = bench_wavetable() == 0.0f;
+  exact = bench_wavetable_read() == 0.0f && exact;
+  exact = bench_biquad() == 0.0 && exact;
+  bench_moog();
+  exact = bench_adsr() == 0.0f && exact;
+  return exact ? 0 : 1;
+}
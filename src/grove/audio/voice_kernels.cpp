@@ -0,0 +1,348 @@
+#include "voice_kernels.hpp"
+#include "grove/math/simd.hpp"
+#include "grove/common/common.hpp"
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+//  Interpolates the samples at phases (lo0, lo1, hi0, hi1) as `osc::WaveTable::read` does.
+simd::F4 wavetable_interpolate4(const float* table, simd::D2 phase_lo, simd::D2 phase_hi) {
+  using namespace simd;
+
+  int32_t index[4];
+  truncate_to_int(phase_lo, index);
+  truncate_to_int(phase_hi, index + 2);
+
+  const D2 frac_lo = phase_lo - truncate(phase_lo);
+  const D2 frac_hi = phase_hi - truncate(phase_hi);
+  const D2 x0_lo = setd(table[index[0]], table[index[1]]);
+  const D2 x0_hi = setd(table[index[2]], table[index[3]]);
+  const D2 x1_lo = setd(table[index[0] + 1], table[index[1] + 1]);
+  const D2 x1_hi = setd(table[index[2] + 1], table[index[3] + 1]);
+
+  const D2 one = set1d(1.0);
+  const D2 s_lo = (one - frac_lo) * x0_lo + frac_lo * x1_lo;
+  const D2 s_hi = (one - frac_hi) * x0_hi + frac_hi * x1_hi;
+  return to_float(s_lo, s_hi);
+}
+
+//  As `osc::detail::increment_phase`, per lane.
+simd::D2 wrap_phase(simd::D2 phase, simd::D2 period) {
+  using namespace simd;
+
+  D2 over = ge(phase, period);
+  while (any(over)) {
+    phase = select(over, phase - period, phase);
+    over = ge(phase, period);
+  }
+
+  const D2 zero = set1d(0.0);
+  D2 under = lt(phase, zero);
+  while (any(under)) {
+    phase = select(under, phase + period, phase);
+    under = lt(phase, zero);
+  }
+
+  return phase;
+}
+
+} //  anon
+
+/*
+ * WaveTableVoices4
+ */
+
+void audio::WaveTableVoices4::set_frequency(int lane, double sample_rate, double frequency,
+                                            int table_size) {
+  assert(lane >= 0 && lane < num_voice_lanes);
+  //  As `osc::WaveTable`: (size / sample_rate) * frequency.
+  increment[lane] = (double(table_size) / sample_rate) * frequency;
+}
+
+void audio::WaveTableVoices4::process(const float* table, int table_size, float* out,
+                                      int num_frames) {
+  using namespace simd;
+
+  const D2 period = set1d(double(table_size));
+  const D2 inc_lo = load(increment);
+  const D2 inc_hi = load(increment + 2);
+  D2 phase_lo = load(phase);
+  D2 phase_hi = load(phase + 2);
+
+  for (int i = 0; i < num_frames; i++) {
+    store(out + i * 4, wavetable_interpolate4(table, phase_lo, phase_hi));
+    phase_lo = wrap_phase(phase_lo + inc_lo, period);
+    phase_hi = wrap_phase(phase_hi + inc_hi, period);
+  }
+
+  store(phase, phase_lo);
+  store(phase + 2, phase_hi);
+}
+
+void audio::wavetable_read(const float* table, const double* phases, float* out,
+                           int num_frames) {
+  int i{};
+  for (; i + 4 <= num_frames; i += 4) {
+    const auto s = wavetable_interpolate4(table, simd::load(phases + i), simd::load(phases + i + 2));
+    simd::store(out + i, s);
+  }
+
+  for (; i < num_frames; i++) {
+    const int index = int(phases[i]);
+    const double frac = phases[i] - index;
+    out[i] = float((1.0 - frac) * table[index] + frac * table[index + 1]);
+  }
+}
+
+/*
+ * MoogLPFilter4
+ */
+
+void audio::MoogLPFilter4::set_coefficients(int lane, double sample_rate, float cut, float res) {
+  assert(lane >= 0 && lane < num_voice_lanes);
+  const auto f = float((cut + cut) / sample_rate);
+  p[lane] = f * (1.8f - 0.8f * f);
+  k[lane] = p[lane] + p[lane] - 1.0f;
+
+  const auto t = (1.0f - p[lane]) * 1.386249f;
+  const auto t2 = 12.0f + t * t;
+  r[lane] = res * (t2 + 6.0f * t) / (t2 - 6.0f * t);
+}
+
+void audio::MoogLPFilter4::process(float* in_out, int num_frames) {
+  using namespace simd;
+
+  const F4 vr = load(r);
+  const F4 vp = load(p);
+  const F4 vk = load(k);
+  const F4 six = set1(6.0f);
+
+  F4 v1 = load(y1);
+  F4 v2 = load(y2);
+  F4 v3 = load(y3);
+  F4 v4 = load(y4);
+  F4 lx = load(last_x);
+  F4 l1 = load(last_y1);
+  F4 l2 = load(last_y2);
+  F4 l3 = load(last_y3);
+
+  for (int i = 0; i < num_frames; i++) {
+    float* p_in_out = in_out + i * 4;
+    const F4 x = load(p_in_out) - vr * v4;
+
+    v1 = x * vp + lx * vp - vk * v1;
+    v2 = v1 * vp + l1 * vp - vk * v2;
+    v3 = v2 * vp + l2 * vp - vk * v3;
+    v4 = v3 * vp + l3 * vp - vk * v4;
+    v4 = v4 - (v4 * v4 * v4) / six;
+
+    lx = x;
+    l1 = v1;
+    l2 = v2;
+    l3 = v3;
+    store(p_in_out, v4);
+  }
+
+  store(y1, v1);
+  store(y2, v2);
+  store(y3, v3);
+  store(y4, v4);
+  store(last_x, lx);
+  store(last_y1, l1);
+  store(last_y2, l2);
+  store(last_y3, l3);
+}
+
+/*
+ * Biquad4
+ */
+
+void audio::Biquad4::set_coefficients(int lane, const double* b, const double* a) {
+  assert(lane >= 0 && lane < num_voice_lanes);
+  b0[lane] = b[0];
+  b1[lane] = b[1];
+  b2[lane] = b[2];
+  a0[lane] = a[0];
+  a1[lane] = a[1];
+  a2[lane] = a[2];
+}
+
+void audio::Biquad4::process(double* in_out, int num_frames) {
+  using namespace simd;
+
+  //  Lanes (0, 1) and (2, 3) are independent; filter each pair over the whole block in turn.
+  for (int h = 0; h < num_voice_lanes; h += 2) {
+    const D2 vb0 = load(b0 + h);
+    const D2 vb1 = load(b1 + h);
+    const D2 vb2 = load(b2 + h);
+    const D2 va0 = load(a0 + h);
+    const D2 va1 = load(a1 + h);
+    const D2 va2 = load(a2 + h);
+    D2 vx1 = load(x1 + h);
+    D2 vx2 = load(x2 + h);
+    D2 vy1 = load(y1 + h);
+    D2 vy2 = load(y2 + h);
+
+    for (int i = 0; i < num_frames; i++) {
+      double* p_in_out = in_out + i * 4 + h;
+      const D2 s = load(p_in_out);
+
+      //  Same order of operations as `linear_filter_tick`.
+      D2 fir = s * vb0;
+      fir = fir + vb1 * vx1;
+      fir = fir + vb2 * vx2;
+      D2 iir = fir - va1 * vy1;
+      iir = iir - va2 * vy2;
+      const D2 y = iir * va0;
+
+      vx2 = vx1;
+      vx1 = s;
+      vy2 = vy1;
+      vy1 = y;
+      store(p_in_out, y);
+    }
+
+    store(x1 + h, vx1);
+    store(x2 + h, vx2);
+    store(y1 + h, vy1);
+    store(y2 + h, vy2);
+  }
+}
+
+/*
+ * ADSRExp4
+ */
+
+void audio::ADSRExp4::configure(int lane, const Params& params) {
+  assert(lane >= 0 && lane < num_voice_lanes);
+  attack_time[lane] = float(params.attack_time);
+  decay_time[lane] = float(params.decay_time);
+  release_time[lane] = float(params.release_time);
+  sustain_time[lane] = params.infinite_sustain ?
+    std::numeric_limits<float>::infinity() : float(params.sustain_time);
+  peak_amp[lane] = float(params.peak_amp);
+  sustain_amp[lane] = float(params.sustain_amp);
+}
+
+void audio::ADSRExp4::note_on(int lane) {
+  begin_segment(lane, Epoch::Attack);
+}
+
+void audio::ADSRExp4::note_off(int lane) {
+  if (epoch[lane] != Epoch::Elapsed) {
+    begin_segment(lane, Epoch::Release);
+  }
+}
+
+void audio::ADSRExp4::begin_segment(int lane, Epoch to) {
+  assert(lane >= 0 && lane < num_voice_lanes);
+  switch (to) {
+    case Epoch::Attack:
+      target[lane] = peak_amp[lane];
+      tau[lane] = attack_time[lane] / 3.0f;
+      duration[lane] = attack_time[lane];
+      break;
+    case Epoch::Decay:
+      target[lane] = sustain_amp[lane];
+      tau[lane] = decay_time[lane] / 3.0f;
+      duration[lane] = decay_time[lane];
+      break;
+    case Epoch::Sustain:
+      duration[lane] = sustain_time[lane];
+      break;
+    case Epoch::Release:
+      target[lane] = 0.0f;
+      tau[lane] = release_time[lane] / 3.0f;
+      duration[lane] = release_time[lane];
+      break;
+    default:
+      break;
+  }
+
+  epoch[lane] = to;
+  elapsed_time[lane] = 0.0f;
+}
+
+void audio::ADSRExp4::transition(int lane) {
+  switch (epoch[lane]) {
+    case Epoch::Attack:
+      begin_segment(lane, Epoch::Decay);
+      break;
+    case Epoch::Decay:
+      begin_segment(lane, Epoch::Sustain);
+      break;
+    case Epoch::Sustain:
+      begin_segment(lane, Epoch::Release);
+      break;
+    default:
+      epoch[lane] = Epoch::Elapsed;
+      break;
+  }
+}
+
+void audio::ADSRExp4::process(double sr, float* out, int num_frames) {
+  using namespace simd;
+
+  const F4 dt = set1(float(1.0 / sr));
+  const F4 zero4 = zero();
+
+  int frame{};
+  while (frame < num_frames) {
+    //  Coefficients of each lane's current segment. Sustained and elapsed lanes hold their value
+    //  (1.0 * v + 0.0 == v); elapsed lanes never end and output silence.
+    alignas(16) double a[num_voice_lanes];
+    alignas(16) double b[num_voice_lanes];
+    alignas(16) float end_time[num_voice_lanes];
+    alignas(16) float active[num_voice_lanes];
+    for (int i = 0; i < num_voice_lanes; i++) {
+      a[i] = 1.0;
+      b[i] = 0.0;
+      end_time[i] = duration[i];
+      active[i] = 1.0f;
+      if (epoch[i] == Epoch::Elapsed) {
+        end_time[i] = std::numeric_limits<float>::infinity();
+        active[i] = 0.0f;
+      } else if (epoch[i] != Epoch::Sustain) {
+        //  As in `ADSRExp::Segment::tick`.
+        a[i] = std::exp(-(1.0 / sr) / double(tau[i]));
+        b[i] = (1.0 - a[i]) * double(target[i]);
+      }
+    }
+
+    const D2 a_lo = load(a);
+    const D2 a_hi = load(a + 2);
+    const D2 b_lo = load(b);
+    const D2 b_hi = load(b + 2);
+    const F4 end = load(end_time);
+    const F4 on = gt(load(active), zero4);
+    F4 v = load(last);
+    F4 t = load(elapsed_time);
+
+    //  Render until the block or any lane's segment ends. As in `ADSRExp`, a segment ends after
+    //  the frame at which its (single precision) elapsed time reaches its duration.
+    int ended{};
+    while (frame < num_frames && !ended) {
+      const D2 v_lo = a_lo * to_double_lo(v) + b_lo;
+      const D2 v_hi = a_hi * to_double_hi(v) + b_hi;
+      v = to_float(v_lo, v_hi);
+      store(out + frame * num_voice_lanes, select(on, v, zero4));
+      t = t + dt;
+      ended = move_mask(le(end, t));
+      frame++;
+    }
+
+    store(last, v);
+    store(elapsed_time, t);
+    for (int i = 0; i < num_voice_lanes; i++) {
+      if (ended & (1 << i)) {
+        transition(i);
+      }
+    }
+  }
+}
+
+GROVE_NAMESPACE_END
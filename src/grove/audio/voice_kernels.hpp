@@ -0,0 +1,135 @@
+#pragma once
+
+#include "envelope.hpp"
+#include <cstdint>
+
+namespace grove::audio {
+
+/*
+ * Block kernels that process `num_voice_lanes` independent voices at once.
+ *
+ * Buffers are lane-interleaved: sample `i` of the voice in lane `v` is at `[i * 4 + v]`. Per-voice
+ * settings are made between calls to `process`, which renders a whole block (typically a render
+ * quantum) with those settings. Unused lanes can be left at their defaults; they produce silence
+ * or pass input through unchanged.
+ *
+ * Kernels documented as matching a scalar counterpart do so exactly, provided neither is compiled
+ * with floating-point contraction into fused multiply-adds (e.g. -march=native on x64, or clang's
+ * default on arm64); otherwise results can differ in the last bit.
+ */
+
+constexpr int num_voice_lanes = 4;
+
+/*
+ * WaveTableVoices4
+ *
+ * Linearly interpolated wavetable oscillators reading from a shared table of `table_size + 1`
+ * samples, e.g. `osc::WaveTable::data()`. Phases are kept and interpolated in double precision,
+ * matching `osc::WaveTable::tick` sample for sample.
+ */
+
+struct WaveTableVoices4 {
+  void set_frequency(int lane, double sample_rate, double frequency, int table_size);
+  void process(const float* table, int table_size, float* out, int num_frames);
+
+  double phase[num_voice_lanes]{};
+  double increment[num_voice_lanes]{};
+};
+
+/*
+ * Reads `num_frames` samples of a single voice from `table` at `phases`, 4 frames at a time. Each
+ * sample is interpolated as in `osc::WaveTable::read`.
+ */
+void wavetable_read(const float* table, const double* phases, float* out, int num_frames);
+
+/*
+ * MoogLPFilter4
+ *
+ * 4-pole ladder lowpass approximation (musicdsp.org "Moog VCF, variation 1") with a cubic soft
+ * clip on the output.
+ */
+
+struct MoogLPFilter4 {
+  void set_coefficients(int lane, double sample_rate, float cutoff, float resonance);
+  void process(float* in_out, int num_frames);
+
+  float y1[num_voice_lanes]{};
+  float y2[num_voice_lanes]{};
+  float y3[num_voice_lanes]{};
+  float y4[num_voice_lanes]{};
+  float last_x[num_voice_lanes]{};
+  float last_y1[num_voice_lanes]{};
+  float last_y2[num_voice_lanes]{};
+  float last_y3[num_voice_lanes]{};
+  float r[num_voice_lanes]{};
+  float p[num_voice_lanes]{};
+  float k[num_voice_lanes]{};
+};
+
+/*
+ * Biquad4
+ *
+ * Second-order direct form I filters, matching `LinearFilter<double, 3, 3>` sample for sample.
+ * Coefficients are given as for `LinearFilter::set_b` / `set_a`. Lanes pass their input through
+ * unchanged until configured.
+ */
+
+struct Biquad4 {
+  void set_coefficients(int lane, const double* b, const double* a);
+  void process(double* in_out, int num_frames);
+
+  double b0[num_voice_lanes]{1.0, 1.0, 1.0, 1.0};
+  double b1[num_voice_lanes]{};
+  double b2[num_voice_lanes]{};
+  double a0[num_voice_lanes]{1.0, 1.0, 1.0, 1.0};
+  double a1[num_voice_lanes]{};
+  double a2[num_voice_lanes]{};
+  double x1[num_voice_lanes]{};
+  double x2[num_voice_lanes]{};
+  double y1[num_voice_lanes]{};
+  double y2[num_voice_lanes]{};
+};
+
+/*
+ * ADSRExp4
+ *
+ * Exponential ADSR envelopes, matching `env::ADSRExp<float>` sample for sample. The block is
+ * rendered in spans between segment boundaries of any lane, with segment coefficients computed
+ * once per span rather than every sample. Within a span, the 4 lanes are updated together in
+ * double precision, as in `ADSRExp`; single precision drifts from `ADSRExp` over segments several
+ * seconds long.
+ */
+
+class ADSRExp4 : public Envelope {
+public:
+  void configure(int lane, const Params& params);
+  void note_on(int lane);
+  void note_off(int lane);
+  bool elapsed(int lane) const {
+    return epoch[lane] == Epoch::Elapsed;
+  }
+
+  void process(double sample_rate, float* out, int num_frames);
+
+private:
+  void begin_segment(int lane, Epoch to);
+  void transition(int lane);
+
+private:
+  float attack_time[num_voice_lanes]{1.0f, 1.0f, 1.0f, 1.0f};
+  float decay_time[num_voice_lanes]{1.0f, 1.0f, 1.0f, 1.0f};
+  float sustain_time[num_voice_lanes]{1.0f, 1.0f, 1.0f, 1.0f};
+  float release_time[num_voice_lanes]{1.0f, 1.0f, 1.0f, 1.0f};
+  float peak_amp[num_voice_lanes]{1.0f, 1.0f, 1.0f, 1.0f};
+  float sustain_amp[num_voice_lanes]{0.5f, 0.5f, 0.5f, 0.5f};
+
+  Epoch epoch[num_voice_lanes]{Epoch::Elapsed, Epoch::Elapsed, Epoch::Elapsed, Epoch::Elapsed};
+  float last[num_voice_lanes]{};
+  float target[num_voice_lanes]{};
+  float tau[num_voice_lanes]{};
+  float duration[num_voice_lanes]{};
+  //  Accumulated in single precision, as in `ADSRExp`, so that segments end on the same frame.
+  float elapsed_time[num_voice_lanes]{};
+};
+
+}
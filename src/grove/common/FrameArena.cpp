@@ -0,0 +1,162 @@
+#include "FrameArena.hpp"
+#include "common.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+GROVE_NAMESPACE_BEGIN
+
+struct FrameArena::ThreadChunks {
+  struct Chunk {
+    std::unique_ptr<unsigned char[]> data;
+    size_t size;
+  };
+
+  size_t num_bytes_used() const {
+    return num_bytes_in_prev_chunks + size(&alloc);
+  }
+
+  std::thread::id thread_id;
+  std::vector<Chunk> chunks;
+  uint32_t chunk_index;
+  LinearAllocator alloc;
+  size_t num_bytes_in_prev_chunks;
+  uint64_t num_chunk_allocations;
+};
+
+namespace {
+
+using ThreadChunks = FrameArena::ThreadChunks;
+
+struct ThreadCache {
+  uint64_t arena_id;
+  ThreadChunks* chunks;
+};
+
+std::atomic<uint64_t> next_arena_id{1};
+thread_local ThreadCache thread_cache{};
+
+void push_chunk(ThreadChunks& tc, size_t size) {
+  ThreadChunks::Chunk chunk{};
+  chunk.data = std::make_unique<unsigned char[]>(size);
+  chunk.size = size;
+  tc.chunks.push_back(std::move(chunk));
+  tc.num_chunk_allocations++;
+}
+
+void use_chunk(ThreadChunks& tc, uint32_t ci) {
+  auto& chunk = tc.chunks[ci];
+  tc.chunk_index = ci;
+  tc.alloc = make_linear_allocator(chunk.data.get(), chunk.data.get() + chunk.size);
+}
+
+void* allocate_in_next_chunk(ThreadChunks& tc, size_t chunk_size, size_t size, size_t align) {
+  tc.num_bytes_in_prev_chunks += grove::size(&tc.alloc);
+  const size_t required = size + align;
+
+  uint32_t ci = tc.chunk_index + 1;
+  while (ci < uint32_t(tc.chunks.size()) && tc.chunks[ci].size < required) {
+    ci++;
+  }
+  if (ci == uint32_t(tc.chunks.size())) {
+    push_chunk(tc, std::max(chunk_size, required));
+  }
+
+  use_chunk(tc, ci);
+  auto* res = grove::allocate(&tc.alloc, size, align);
+  assert(res);
+  return res;
+}
+
+struct {
+  FrameArena arena;
+} globals;
+
+} //  anon
+
+FrameArena::FrameArena(size_t chunk_size) :
+  id{next_arena_id.fetch_add(1)},
+  chunk_size{chunk_size} {
+  //
+}
+
+FrameArena::~FrameArena() = default;
+
+FrameArena::ThreadChunks& FrameArena::require_thread_chunks() {
+  if (thread_cache.arena_id == id) {
+    return *thread_cache.chunks;
+  }
+
+  std::lock_guard<std::mutex> lock{thread_chunks_mutex};
+  const auto thread_id = std::this_thread::get_id();
+  ThreadChunks* result{};
+  for (auto& tc : thread_chunks) {
+    if (tc->thread_id == thread_id) {
+      result = tc.get();
+      break;
+    }
+  }
+
+  if (!result) {
+    auto& tc = thread_chunks.emplace_back(std::make_unique<ThreadChunks>());
+    result = tc.get();
+    result->thread_id = thread_id;
+    push_chunk(*result, chunk_size);
+    use_chunk(*result, 0);
+  }
+
+  thread_cache = ThreadCache{id, result};
+  return *result;
+}
+
+void* FrameArena::allocate(size_t size, size_t align) {
+  auto& tc = require_thread_chunks();
+  if (auto* res = grove::allocate(&tc.alloc, size, align)) {
+    return res;
+  } else {
+    return allocate_in_next_chunk(tc, chunk_size, size, align);
+  }
+}
+
+void FrameArena::reset() {
+  std::lock_guard<std::mutex> lock{thread_chunks_mutex};
+  size_t num_bytes_used{};
+  for (auto& tc : thread_chunks) {
+    num_bytes_used += tc->num_bytes_used();
+    if (tc->chunk_index > 0) {
+      //  Overflowed during the frame; coalesce so the next frame fits in one chunk.
+      size_t tot_size{};
+      for (auto& chunk : tc->chunks) {
+        tot_size += chunk.size;
+      }
+      tc->chunks.clear();
+      push_chunk(*tc, tot_size);
+    }
+    use_chunk(*tc, 0);
+    tc->num_bytes_in_prev_chunks = 0;
+  }
+  max_num_bytes_used = std::max(max_num_bytes_used, num_bytes_used);
+}
+
+FrameArena::Stats FrameArena::get_stats() const {
+  std::lock_guard<std::mutex> lock{thread_chunks_mutex};
+  Stats result{};
+  result.num_threads = uint32_t(thread_chunks.size());
+  result.max_num_bytes_used = max_num_bytes_used;
+  for (auto& tc : thread_chunks) {
+    result.num_bytes_used += tc->num_bytes_used();
+    result.num_chunk_allocations += tc->num_chunk_allocations;
+    for (auto& chunk : tc->chunks) {
+      result.num_bytes_reserved += chunk.size;
+    }
+  }
+  return result;
+}
+
+FrameArena* get_global_frame_arena() {
+  return &globals.arena;
+}
+
+GROVE_NAMESPACE_END
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace grove {
+
+/*
+ * FrameArena
+ *
+ * Linear allocator for transient data that does not outlive a frame. Each thread that allocates
+ * from the arena gets its own chain of chunks, so allocation only takes a lock on a thread's
+ * first use of the arena. `reset()` rewinds every thread's chain; a chain that overflowed its
+ * first chunk during the frame is replaced by a single chunk large enough for that frame, so
+ * in steady state allocating from the arena does not touch the heap.
+ *
+ * Memory is returned uninitialized and destructors are never run, so only trivially
+ * destructible types may be allocated. `reset()` and `get_stats()` must not run concurrently with
+ * `allocate()`.
+ */
+class FrameArena {
+public:
+  struct Stats {
+    uint32_t num_threads;
+    size_t num_bytes_used;
+    size_t num_bytes_reserved;
+    size_t max_num_bytes_used;
+    uint64_t num_chunk_allocations;
+  };
+
+  struct ThreadChunks;
+
+public:
+  explicit FrameArena(size_t chunk_size = 1024 * 1024);
+  ~FrameArena();
+
+  FrameArena(const FrameArena& other) = delete;
+  FrameArena& operator=(const FrameArena& other) = delete;
+
+  void* allocate(size_t size, size_t align);
+
+  template <typename T>
+  T* allocate_n(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  void reset();
+  Stats get_stats() const;
+
+private:
+  ThreadChunks& require_thread_chunks();
+
+private:
+  uint64_t id;
+  size_t chunk_size;
+  mutable std::mutex thread_chunks_mutex;
+  std::vector<std::unique_ptr<ThreadChunks>> thread_chunks;
+  size_t max_num_bytes_used{};
+};
+
+FrameArena* get_global_frame_arena();
+
+}
@@ -1,5 +1,6 @@
 #include "StatStopwatch.hpp"
 #include "grove/common/common.hpp"
+#include "grove/common/memory.hpp"
 #include "grove/math/constants.hpp"
 #include "logging.hpp"
 #include <iostream>
@@ -17,7 +18,9 @@ StatStopwatch::Stats::Stats() :
   mean(grove::nan()),
   max(grove::nan()),
   min(grove::nan()),
-  iters(0.0) {
+  iters(0.0),
+  mean_heap_allocations(0.0),
+  max_heap_allocations(0) {
   //
 }
 
@@ -31,6 +34,10 @@ std::string StatStopwatch::Stats::to_string_in_ms() const {
   stream << "mean: " << std::setprecision(3) << mean_ms
          << "ms max: " << max_ms << "ms min: " << min_ms << "ms";
 
+  if (heap_allocations_counted()) {
+    stream << " allocs mean: " << mean_heap_allocations << " max: " << max_heap_allocations;
+  }
+
   return stream.str();
 }
 
@@ -44,19 +51,23 @@ StatStopwatch::StatStopwatch() : StatStopwatch(0) {
 
 StatStopwatch::StatStopwatch(int num_history_samples) :
   t0(std::chrono::high_resolution_clock::now()),
+  heap_allocations0(num_heap_allocations()),
   history(num_history_samples),
+  heap_allocation_history(num_history_samples),
   history_sample_index(0) {
   //
 }
 
 void StatStopwatch::tick() {
+  heap_allocations0 = num_heap_allocations();
   t0 = std::chrono::high_resolution_clock::now();
 }
 
 StatStopwatch::duration_t StatStopwatch::tock() {
   duration_t elapsed = std::chrono::high_resolution_clock::now() - t0;
-  update_history(elapsed);
-  update_lifetime_stats(elapsed);
+  const uint64_t num_allocs = num_heap_allocations() - heap_allocations0;
+  update_history(elapsed, num_allocs);
+  update_lifetime_stats(elapsed, num_allocs);
   
   return elapsed;
 }
@@ -65,12 +76,18 @@ StatStopwatch::Stats StatStopwatch::get_history_stats() const {
   Stats result;
   
   for (int i = 0; i < history_sample_index; i++) {
+    const auto num_allocs = heap_allocation_history[i];
     if (i == 0) {
       result.mean = history[i];
       result.max = history[i];
       result.min = history[i];
+      result.mean_heap_allocations = double(num_allocs);
+      result.max_heap_allocations = num_allocs;
     } else {
       result.mean = (result.mean * result.iters + history[i]) / (result.iters + 1.0);
+      result.mean_heap_allocations =
+        (result.mean_heap_allocations * result.iters + double(num_allocs)) / (result.iters + 1.0);
+      result.max_heap_allocations = std::max(result.max_heap_allocations, num_allocs);
       
       if (history[i] < result.min) {
         result.min = history[i];
@@ -87,29 +104,37 @@ StatStopwatch::Stats StatStopwatch::get_history_stats() const {
   return result;
 }
 
-void StatStopwatch::update_history(const duration_t& elapsed) {
+void StatStopwatch::update_history(const duration_t& elapsed, uint64_t num_allocs) {
   const int max_num_samples = int(history.size());
   
   if (history_sample_index < max_num_samples) {
+    heap_allocation_history[history_sample_index] = num_allocs;
     history[history_sample_index++] = elapsed;
   } else {
     for (int i = history_sample_index-1; i > 0; i--) {
       history[i-1] = history[i];
+      heap_allocation_history[i-1] = heap_allocation_history[i];
     }
     
     if (history_sample_index > 0) {
       history[history_sample_index-1] = elapsed;
+      heap_allocation_history[history_sample_index-1] = num_allocs;
     }
   }
 }
 
-void StatStopwatch::update_lifetime_stats(const duration_t& elapsed) {
+void StatStopwatch::update_lifetime_stats(const duration_t& elapsed, uint64_t num_allocs) {
   if (stats.iters == 0.0) {
     stats.mean = elapsed;
     stats.max = elapsed;
     stats.min = elapsed;
+    stats.mean_heap_allocations = double(num_allocs);
+    stats.max_heap_allocations = num_allocs;
   } else {
     stats.mean = (stats.mean * stats.iters + elapsed) / (stats.iters + 1.0);
+    stats.mean_heap_allocations =
+      (stats.mean_heap_allocations * stats.iters + double(num_allocs)) / (stats.iters + 1.0);
+    stats.max_heap_allocations = std::max(stats.max_heap_allocations, num_allocs);
     
     if (elapsed > stats.max) {
       stats.max = elapsed;
@@ -149,6 +174,12 @@ void StatStopwatch::summarize_stats(std::stringstream& stream, const char* messa
   stream << "mean: " << std::setprecision(3)
          << mean_ms << "ms mean(" << history.size() <<  "): "
          << latest_mean_ms << "ms max: " << max_ms << "ms min: " << min_ms << "ms";
+
+  if (heap_allocations_counted()) {
+    stream << " allocs mean: " << lifetime_stats.mean_heap_allocations
+           << " mean(" << history.size() << "): " << history_stats.mean_heap_allocations
+           << " max: " << history_stats.max_heap_allocations;
+  }
 }
 
 GROVE_NAMESPACE_END
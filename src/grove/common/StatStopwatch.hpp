@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -20,6 +21,10 @@ public:
     duration_t max;
     duration_t min;
     double iters;
+    //  Heap allocations made by the calling thread between `tick()` and `tock()`; zero unless
+    //  allocations are counted.
+    double mean_heap_allocations;
+    uint64_t max_heap_allocations;
   };
   
 public:
@@ -39,12 +44,14 @@ public:
   void summarize_stats(std::stringstream& into, const char* message = nullptr) const;
   
 private:
-  void update_history(const duration_t& elapsed);
-  void update_lifetime_stats(const duration_t& elapsed);
+  void update_history(const duration_t& elapsed, uint64_t num_allocs);
+  void update_lifetime_stats(const duration_t& elapsed, uint64_t num_allocs);
   
 private:
   std::chrono::high_resolution_clock::time_point t0;
+  uint64_t heap_allocations0;
   Stats stats;
   std::vector<duration_t> history;
+  std::vector<uint64_t> heap_allocation_history;
   int history_sample_index;
 };
@@ -0,0 +1,182 @@
+#include "TaskPool.hpp"
+#include "grove/common/common.hpp"
+#include <algorithm>
+#include <cassert>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+uint64_t make_range(uint32_t begin, uint32_t end) {
+  return uint64_t(begin) | (uint64_t(end) << 32u);
+}
+
+uint32_t range_begin(uint64_t word) {
+  return uint32_t(word & 0xffffffffu);
+}
+
+uint32_t range_end(uint64_t word) {
+  return uint32_t(word >> 32u);
+}
+
+} //  anon
+
+TaskPool::~TaskPool() {
+  stop();
+}
+
+int TaskPool::default_num_worker_threads() {
+  return std::max(0, int(std::thread::hardware_concurrency()) - 1);
+}
+
+void TaskPool::start(int num_worker_threads) {
+  assert(threads.empty() && num_worker_threads >= 0);
+  num_ranges = num_worker_threads + 1;
+  ranges = std::make_unique<TaskRange[]>(num_ranges);
+
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    keep_running = true;
+  }
+
+  for (int i = 0; i < num_worker_threads; i++) {
+    threads.emplace_back([this, i]() {
+      worker_loop(i + 1);
+    });
+  }
+
+  num_active_workers.store(num_worker_threads);
+}
+
+void TaskPool::stop() {
+  //  Wait for a batch in progress to complete.
+  std::lock_guard<std::mutex> run_lock{run_mutex};
+  num_active_workers.store(0);
+
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    keep_running = false;
+  }
+  job_available.notify_all();
+
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  threads.clear();
+}
+
+bool TaskPool::pop_front(int worker_index, uint32_t* task_index) {
+  auto& range = ranges[worker_index].word;
+  uint64_t word = range.load();
+
+  while (range_begin(word) < range_end(word)) {
+    const uint32_t begin = range_begin(word);
+    if (range.compare_exchange_weak(word, make_range(begin + 1, range_end(word)))) {
+      *task_index = begin;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool TaskPool::steal(int worker_index) {
+  //  Only the owner of a range stores to it, and only once it is empty; thieves compare-exchange
+  //  against a non-empty range. Since a range word fully describes the set of tasks it holds, a
+  //  successful exchange is valid even if the range was emptied and refilled in the meantime.
+  for (int i = 1; i < num_ranges; i++) {
+    auto& victim = ranges[(worker_index + i) % num_ranges].word;
+    uint64_t word = victim.load();
+
+    while (range_begin(word) < range_end(word)) {
+      const uint32_t begin = range_begin(word);
+      const uint32_t end = range_end(word);
+      const uint32_t num_take = (end - begin + 1) / 2;
+      if (victim.compare_exchange_weak(word, make_range(begin, end - num_take))) {
+        ranges[worker_index].word.store(make_range(end - num_take, end));
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void TaskPool::execute(int worker_index) {
+  do {
+    uint32_t task_index;
+    while (pop_front(worker_index, &task_index)) {
+      auto task = job_task.load();
+      task(job_context.load(), int(task_index), worker_index);
+
+      if (num_remaining_tasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock{mutex};
+        job_complete.notify_all();
+      }
+    }
+  } while (steal(worker_index));
+}
+
+void TaskPool::worker_loop(int worker_index) {
+  uint64_t last_epoch{};
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      job_available.wait(lock, [this, last_epoch]() {
+        return !keep_running || job_epoch != last_epoch;
+      });
+      if (!keep_running) {
+        return;
+      }
+      last_epoch = job_epoch;
+    }
+
+    execute(worker_index);
+  }
+}
+
+void TaskPool::run(Task task, void* context, int num_tasks) {
+  if (num_tasks <= 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> run_lock{run_mutex, std::try_to_lock};
+  if (!run_lock.owns_lock() || num_active_workers.load() == 0) {
+    for (int i = 0; i < num_tasks; i++) {
+      task(context, i, 0);
+    }
+    return;
+  }
+
+  //  Every task of the previous batch has completed, so every range is empty. The task and context
+  //  are published before the ranges, so that a worker still scanning for tasks of the previous
+  //  batch can only claim tasks of this one once they are visible.
+  job_task.store(task);
+  job_context.store(context);
+  num_remaining_tasks.store(num_tasks);
+
+  for (int i = 0; i < num_ranges; i++) {
+    const auto begin = uint32_t(int64_t(num_tasks) * i / num_ranges);
+    const auto end = uint32_t(int64_t(num_tasks) * (i + 1) / num_ranges);
+    ranges[i].word.store(make_range(begin, end));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    job_epoch++;
+  }
+  job_available.notify_all();
+
+  execute(0);
+
+  std::unique_lock<std::mutex> lock{mutex};
+  job_complete.wait(lock, [this]() {
+    return num_remaining_tasks.load() == 0;
+  });
+}
+
+GROVE_NAMESPACE_END
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace grove {
+
+/*
+ * TaskPool
+ *
+ * General purpose pool of worker threads that cooperate with the calling thread to execute a batch
+ * of independent tasks. Tasks are initially divided evenly between the threads; a thread that runs
+ * out of tasks steals half of the remaining tasks of another. Idle workers block on a condition
+ * variable, so the pool is cheap to keep around but not suited to the audio render thread (see
+ * `AudioRenderWorkerPool`).
+ *
+ * `run` executes the batch serially on the calling thread if the pool has no workers, or if
+ * another batch is already in progress (including when called from within a task).
+ */
+
+class TaskPool {
+public:
+  //  `worker_index` is 0 for the calling thread, and in [1, num_workers()] otherwise.
+  using Task = void(*)(void* context, int task_index, int worker_index);
+
+public:
+  ~TaskPool();
+
+  void start(int num_worker_threads);
+  void stop();
+
+  //  Number of threads that may execute tasks, excluding the calling thread.
+  int num_workers() const noexcept {
+    return num_active_workers.load();
+  }
+
+  //  Execute `num_tasks` tasks across the workers and the calling thread, returning once every
+  //  task has completed.
+  void run(Task task, void* context, int num_tasks);
+
+  //  As `run`, for a callable invoked as `f(task_index, worker_index)`.
+  template <typename F>
+  void parallel_for(int num_tasks, F&& f) {
+    run([](void* context, int task_index, int worker_index) {
+      (*static_cast<std::remove_reference_t<F>*>(context))(task_index, worker_index);
+    }, (void*) &f, num_tasks);
+  }
+
+  static int default_num_worker_threads();
+
+private:
+  struct alignas(64) TaskRange {
+    //  Low 32 bits: index of the first task. High 32 bits: one past the index of the last task.
+    std::atomic<uint64_t> word{0};
+  };
+
+  void worker_loop(int worker_index);
+  void execute(int worker_index);
+  bool pop_front(int worker_index, uint32_t* task_index);
+  bool steal(int worker_index);
+
+private:
+  std::vector<std::thread> threads;
+  std::atomic<int> num_active_workers{0};
+  std::unique_ptr<TaskRange[]> ranges;
+  int num_ranges{};
+
+  std::mutex run_mutex;
+  std::mutex mutex;
+  std::condition_variable job_available;
+  std::condition_variable job_complete;
+  uint64_t job_epoch{};
+  bool keep_running{};
+
+  std::atomic<Task> job_task{nullptr};
+  std::atomic<void*> job_context{nullptr};
+  std::atomic<int> num_remaining_tasks{0};
+};
+
+}
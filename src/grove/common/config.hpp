@@ -6,4 +6,8 @@
 #define GROVE_LOGGING_ENABLED (0)
 #endif
 
-#define GROVE_PROFILING_ENABLED (1)
\ No newline at end of file
+#define GROVE_PROFILING_ENABLED (1)
+
+#ifndef GROVE_COUNT_HEAP_ALLOCATIONS
+#define GROVE_COUNT_HEAP_ALLOCATIONS (0)
+#endif
\ No newline at end of file
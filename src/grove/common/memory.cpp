@@ -1,12 +1,20 @@
 #include "memory.hpp"
 #include "./common.hpp"
 #include "./platform.hpp"
+#include <algorithm>
 #include <cassert>
+#include <new>
 
 #ifndef GROVE_WIN
 #include <cstdlib>
 #endif
 
+#if GROVE_COUNT_HEAP_ALLOCATIONS
+namespace {
+thread_local uint64_t thread_num_heap_allocations{0};
+} //  anon
+#endif
+
 GROVE_NAMESPACE_BEGIN
 
 //  https://github.com/SaschaWillems/Vulkan/blob/master/examples/dynamicuniformbuffer/dynamicuniformbuffer.cpp
@@ -111,4 +119,97 @@ make_linear_allocators_from_heap(const size_t* sizes, LinearAllocator* allocs, s
   return result;
 }
 
+uint64_t num_heap_allocations() {
+#if GROVE_COUNT_HEAP_ALLOCATIONS
+  return thread_num_heap_allocations;
+#else
+  return 0;
+#endif
+}
+
 GROVE_NAMESPACE_END
+
+#if GROVE_COUNT_HEAP_ALLOCATIONS
+
+/*
+ * global operator new / delete
+ */
+
+namespace {
+
+void* counted_malloc(std::size_t size) {
+  thread_num_heap_allocations++;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* counted_aligned_malloc(std::size_t size, std::align_val_t align) {
+  thread_num_heap_allocations++;
+  const auto al = std::max(static_cast<std::size_t>(align), sizeof(void*));
+  return grove::aligned_malloc(size == 0 ? al : size, al);
+}
+
+} //  anon
+
+void* operator new(std::size_t size) {
+  if (void* p = counted_malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_malloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+  if (void* p = counted_aligned_malloc(size, align)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+  return ::operator new(size, align);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  grove::aligned_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  grove::aligned_free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  grove::aligned_free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  grove::aligned_free(p);
+}
+
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "config.hpp"
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <memory>
 #include <cassert>
@@ -154,4 +156,17 @@ std::unique_ptr<unsigned char[]>
 make_linear_allocators_from_heap(const size_t* sizes, LinearAllocator* allocs, size_t num_allocs,
                                  size_t* full_size = nullptr);
 
+/*
+ * heap allocation counting
+ */
+
+constexpr bool heap_allocations_counted() {
+  return GROVE_COUNT_HEAP_ALLOCATIONS == 1;
+}
+
+//  Number of calls to the global `operator new` made by the calling thread since it started, so
+//  that a scope timed on one thread (e.g. the render thread) is not charged for allocations made
+//  concurrently on others. Always 0 unless built with GROVE_COUNT_HEAP_ALLOCATIONS.
+uint64_t num_heap_allocations();
+
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "profile.hpp"
+#include "memory.hpp"
 #include <mutex>
 #include <thread>
 
@@ -59,6 +60,27 @@ double Samples::mean_elapsed_ms() const {
   return mean / iters;
 }
 
+double Samples::mean_heap_allocations() const {
+  if (samples.empty()) {
+    return 0.0;
+  }
+
+  double mean = 0.0;
+  for (auto& sample : samples) {
+    mean += double(sample.num_heap_allocations);
+  }
+
+  return mean / double(samples.size());
+}
+
+uint64_t Samples::max_heap_allocations() const {
+  uint64_t result{};
+  for (auto& sample : samples) {
+    result = std::max(result, sample.num_heap_allocations);
+  }
+  return result;
+}
+
 double Samples::last_elapsed_ms() const {
   return samples.empty() ? 0.0 : samples.back().elapsed_ms;
 }
@@ -66,9 +88,18 @@ double Samples::last_elapsed_ms() const {
 std::string Samples::stat_str() const {
   constexpr int data_size = 1024;
   char data[data_size];
-  auto num_written = std::snprintf(
-    data, data_size, "mean: %0.2fms, min: %0.2fms, max: %0.2fms, last: %0.2fms",
-    mean_elapsed_ms(), min_elapsed_ms(), max_elapsed_ms(), last_elapsed_ms());
+  int num_written;
+  if (heap_allocations_counted()) {
+    num_written = std::snprintf(
+      data, data_size,
+      "mean: %0.2fms, min: %0.2fms, max: %0.2fms, last: %0.2fms, allocs mean: %0.1f, max: %llu",
+      mean_elapsed_ms(), min_elapsed_ms(), max_elapsed_ms(), last_elapsed_ms(),
+      mean_heap_allocations(), (unsigned long long) max_heap_allocations());
+  } else {
+    num_written = std::snprintf(
+      data, data_size, "mean: %0.2fms, min: %0.2fms, max: %0.2fms, last: %0.2fms",
+      mean_elapsed_ms(), min_elapsed_ms(), max_elapsed_ms(), last_elapsed_ms());
+  }
 
   if (num_written < data_size && num_written > 0) {
     return std::string{data};
@@ -113,12 +144,16 @@ bool Profiler::tic(std::string_view id, const Clock::time_point& now) {
     return false;
   }
 
-  tics[id] = now;
+  auto& entry = tics[id];
+  entry.time = now;
+  //  Read after insertion so that the profiler's own allocation isn't attributed to `id`.
+  entry.num_heap_allocations = num_heap_allocations();
   return true;
 }
 
 bool Profiler::toc(std::string_view id, const Clock::time_point& now,
                    const ProfileParameters& params) {
+  const uint64_t num_allocs = num_heap_allocations();
   TryLock lock{in_use};
   if (!lock.acquired) {
     return false;
@@ -127,7 +162,7 @@ bool Profiler::toc(std::string_view id, const Clock::time_point& now,
   auto maybe_tic = tics.find(id);
 
   if (maybe_tic == tics.end() ||
-      maybe_tic->second == Clock::time_point{} ||
+      maybe_tic->second.time == Clock::time_point{} ||
       params.num_samples <= 0) {
     //  tic() should precede call to toc()
     return false;
@@ -139,8 +174,9 @@ bool Profiler::toc(std::string_view id, const Clock::time_point& now,
     maybe_samples = samples.find(id);
   }
 
-  auto elapsed_ms = std::chrono::duration<double>(now - maybe_tic->second).count() * 1e3;
-  Sample sample{elapsed_ms};
+  auto& entry = maybe_tic->second;
+  auto elapsed_ms = std::chrono::duration<double>(now - entry.time).count() * 1e3;
+  Sample sample{elapsed_ms, num_allocs - entry.num_heap_allocations};
 
   auto& curr_samples = maybe_samples->second.samples;
   if (curr_samples.size() < params.num_samples) {
@@ -158,7 +194,7 @@ bool Profiler::toc(std::string_view id, const Clock::time_point& now,
     curr_samples.back() = sample;
   }
 
-  tics[id] = Clock::time_point{};
+  entry = {};
   return true;
 }
 
@@ -21,6 +21,7 @@ struct ProfileParameters {
 
 struct Sample {
   double elapsed_ms{0.0};
+  uint64_t num_heap_allocations{};
 };
 
 struct Samples {
@@ -29,6 +30,8 @@ public:
   double mean_elapsed_ms() const;
   double min_elapsed_ms() const;
   double max_elapsed_ms() const;
+  double mean_heap_allocations() const;
+  uint64_t max_heap_allocations() const;
   int num_samples() const {
     return int(samples.size());
   }
@@ -91,6 +94,11 @@ class Profiler {
 public:
   using Clock = std::chrono::high_resolution_clock;
 
+  struct Tic {
+    Clock::time_point time;
+    uint64_t num_heap_allocations;
+  };
+
   static constexpr std::chrono::milliseconds refresh_interval() {
     return std::chrono::milliseconds(20);
   }
@@ -108,7 +116,7 @@ private:
 
 private:
   std::unordered_map<std::string_view, Samples> samples;
-  std::unordered_map<std::string_view, Clock::time_point> tics;
+  std::unordered_map<std::string_view, Tic> tics;
   RingBuffer<SampleInfoRequest*, 16> sample_info_requests;
 
   std::atomic<bool> in_use{false};
@@ -0,0 +1,121 @@
+#include "grove/common/FrameArena.hpp"
+#include "grove/common/memory.hpp"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace grove;
+
+namespace {
+
+/*
+ * A frame that outgrows the arena's chunk size spills into additional chunks; `reset` coalesces
+ * them, so the next frame of the same size is served from one chunk without allocating.
+ */
+
+constexpr size_t chunk_size = 256;
+constexpr int num_allocs_per_frame = 64;
+constexpr int num_threads = 4;
+
+//  Fill `num_allocs_per_frame` allocations of increasing size with values derived from `tag`,
+//  then check that none were overwritten. Returns false if any were.
+bool fill_and_check_frame(FrameArena& arena, uint64_t tag) {
+  std::vector<uint64_t*> allocs;
+  for (int i = 0; i < num_allocs_per_frame; i++) {
+    auto* p = arena.allocate_n<uint64_t>(i + 1);
+    if (!p || uintptr_t(p) % alignof(uint64_t) != 0) {
+      return false;
+    }
+    for (int j = 0; j <= i; j++) {
+      p[j] = tag * 1000000 + i * 1000 + j;
+    }
+    allocs.push_back(p);
+  }
+
+  bool ok{true};
+  for (int i = 0; i < num_allocs_per_frame; i++) {
+    for (int j = 0; j <= i; j++) {
+      ok = ok && allocs[i][j] == tag * 1000000 + i * 1000 + j;
+    }
+  }
+  return ok;
+}
+
+bool test_reset() {
+  FrameArena arena{chunk_size};
+  auto* p0 = arena.allocate_n<uint32_t>(4);
+  const auto used = arena.get_stats().num_bytes_used;
+  arena.reset();
+
+  auto stats = arena.get_stats();
+  auto* p1 = arena.allocate_n<uint32_t>(4);
+  return used >= 4 * sizeof(uint32_t) && stats.num_bytes_used == 0 &&
+    stats.max_num_bytes_used == used && p0 == p1;
+}
+
+bool test_coalesce() {
+  FrameArena arena{chunk_size};
+  if (!fill_and_check_frame(arena, 0)) {
+    return false;
+  }
+
+  const auto overflowed = arena.get_stats();
+  arena.reset();
+  const auto coalesced = arena.get_stats();
+
+  const uint64_t allocs0 = num_heap_allocations();
+  bool ok = fill_and_check_frame(arena, 1);
+  const auto steady = arena.get_stats();
+  arena.reset();
+  const uint64_t num_allocs = num_heap_allocations() - allocs0;
+
+  ok = ok && overflowed.num_chunk_allocations > 1;
+  //  One chunk holding everything the overflowed chain held.
+  ok = ok && coalesced.num_chunk_allocations == overflowed.num_chunk_allocations + 1;
+  ok = ok && coalesced.num_bytes_reserved == overflowed.num_bytes_reserved;
+  ok = ok && steady.num_chunk_allocations == coalesced.num_chunk_allocations;
+  ok = ok && steady.num_bytes_used == overflowed.num_bytes_used;
+  //  Only `fill_and_check_frame`'s own vector of pointers may touch the heap.
+  ok = ok && (!heap_allocations_counted() || num_allocs <= 8);
+  return ok;
+}
+
+bool test_per_thread_chains() {
+  FrameArena arena{chunk_size};
+  bool ok{true};
+  for (int frame = 0; frame < 3; frame++) {
+    bool thread_ok[num_threads]{};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&arena, &thread_ok, t, frame]() {
+        thread_ok[t] = fill_and_check_frame(arena, uint64_t(frame * num_threads + t));
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (bool thread_res : thread_ok) {
+      ok = ok && thread_res;
+    }
+
+    //  Threads of later frames may reuse the ids of earlier ones, and so their chains.
+    auto stats = arena.get_stats();
+    ok = ok && stats.num_threads >= num_threads;
+    arena.reset();
+  }
+  return ok;
+}
+
+} //  anon
+
+int main(int, char**) {
+  bool success{true};
+  for (auto& [name, test] : {std::make_pair("reset", test_reset),
+                             std::make_pair("coalesce", test_coalesce),
+                             std::make_pair("per-thread chains", test_per_thread_chains)}) {
+    const bool ok = test();
+    std::cout << name << ": " << (ok ? "ok" : "failed") << std::endl;
+    success = success && ok;
+  }
+  return success ? 0 : 1;
+}
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <cassert>
 #include <limits>
+#include <cstring>
+#include <cmath>
 
 namespace grove {
 
@@ -51,6 +53,62 @@ bool read_data_sub_chunk_size(std::ifstream& file, uint32_t* chunk_size) {
   return true;
 }
 
+void write_header(std::ofstream& file, uint16_t num_channels, uint32_t sample_rate,
+                  uint32_t num_frames) {
+  const uint16_t bits_per_sample = 16;
+  const uint16_t block_align = uint16_t(num_channels * (bits_per_sample / 8));
+  const uint32_t byte_rate = sample_rate * block_align;
+  const uint32_t data_size = num_frames * block_align;
+  const uint32_t riff_size = data_offset_bytes - 8 + data_size;
+  const uint32_t fmt_size = 16;
+  const uint16_t pcm_format = 1;
+
+  file.seekp(0);
+  file.write("RIFF", 4);
+  file.write((const char*) &riff_size, sizeof(uint32_t));
+  file.write("WAVE", 4);
+  file.write("fmt ", 4);
+  file.write((const char*) &fmt_size, sizeof(uint32_t));
+  file.write((const char*) &pcm_format, sizeof(uint16_t));
+  file.write((const char*) &num_channels, sizeof(uint16_t));
+  file.write((const char*) &sample_rate, sizeof(uint32_t));
+  file.write((const char*) &byte_rate, sizeof(uint32_t));
+  file.write((const char*) &block_align, sizeof(uint16_t));
+  file.write((const char*) &bits_per_sample, sizeof(uint16_t));
+  file.write("data", 4);
+  file.write((const char*) &data_size, sizeof(uint32_t));
+  assert(!file.good() || int(file.tellp()) == data_offset_bytes);
+}
+
+//  Read and validate the format descriptor and data sub chunk size, leaving `file` positioned
+//  at the start of the sample data.
+bool read_header(std::ifstream& file, wav::FormatDescriptor* descriptor, uint32_t* chunk_size) {
+  file.seekg(0, file.end);
+  const auto length = file.tellg();
+  file.seekg(0, file.beg);
+
+  if (length < data_offset_bytes) {
+    return false;
+  }
+
+  if (!read_format_descriptor(file, descriptor)) {
+    return false;
+  }
+
+  if (!read_data_sub_chunk_size(file, chunk_size)) {
+    return false;
+  }
+
+  if (int(length) - data_offset_bytes != int(*chunk_size)) {
+    return false;
+  }
+
+  const auto bytes_per_sample = descriptor->bits_per_sample / 8;
+  descriptor->num_samples = *chunk_size / bytes_per_sample;
+  descriptor->num_frames = descriptor->num_samples / descriptor->num_channels;
+  return true;
+}
+
 }
 
 /*
@@ -76,40 +134,12 @@ wav::FileReadResult wav::read_wav_file(const std::string& file_path) {
     return result;
   }
 
-  wav_file.seekg(0, wav_file.end);
-  const auto length = wav_file.tellg();
-  wav_file.seekg(0, wav_file.beg);
-
-  if (length < data_offset_bytes) {
-    result.error = Err::InvalidFormat;
-    return result;
-  }
-
-  const bool fmt_success = read_format_descriptor(wav_file, &result.format_descriptor);
-  if (!fmt_success) {
-    result.error = Err::InvalidFormat;
-    return result;
-  }
-
   uint32_t chunk_size;
-  const bool chunk_success = read_data_sub_chunk_size(wav_file, &chunk_size);
-  if (!chunk_success) {
-    result.error = Err::InvalidFormat;
-    return result;
-  }
-
-  if (int(length) - data_offset_bytes != int(chunk_size)) {
+  if (!read_header(wav_file, &result.format_descriptor, &chunk_size)) {
     result.error = Err::InvalidFormat;
     return result;
   }
 
-  const auto bytes_per_sample = result.format_descriptor.bits_per_sample / 8;
-  const auto num_samples = chunk_size / bytes_per_sample;
-  const auto num_channels = result.format_descriptor.num_channels;
-
-  result.format_descriptor.num_samples = num_samples;
-  result.format_descriptor.num_frames = num_samples / num_channels;
-
   result.data.reset(new unsigned char[chunk_size]);
   wav_file.read((char*) result.data.get(), chunk_size);
   result.error = Err::NoError;
@@ -117,6 +147,28 @@ wav::FileReadResult wav::read_wav_file(const std::string& file_path) {
   return result;
 }
 
+/*
+ * read_wav_format
+ */
+
+bool wav::read_wav_format(const std::string& file_path, FormatDescriptor* descriptor,
+                          uint32_t* data_offset) {
+  std::ifstream wav_file;
+  wav_file.open(file_path.c_str(), std::ios_base::in | std::ios_base::binary);
+
+  if (!wav_file.good()) {
+    return false;
+  }
+
+  uint32_t chunk_size;
+  if (!read_header(wav_file, descriptor, &chunk_size)) {
+    return false;
+  }
+
+  *data_offset = data_offset_bytes;
+  return true;
+}
+
 /*
  * wav_file_data_to_float
  */
@@ -127,14 +179,29 @@ wav::wav_file_data_to_float(const FileReadResult& res, bool normalize, bool max_
     return nullptr;
   }
 
-  auto out = std::make_unique<float[]>(res.format_descriptor.num_samples);
+  const auto& fmt = res.format_descriptor;
+  auto out = std::make_unique<float[]>(fmt.num_samples);
+  source_data_to_float(fmt, res.data.get(), fmt.num_samples, out.get(), normalize);
+
+  if (max_normalize) {
+    abs_max_normalize(out.get(), out.get() + fmt.num_samples);
+  }
+
+  return out;
+}
+
+/*
+ * source_data_to_float
+ */
 
-  if (res.format_descriptor.source_format == wav::SourceFormat::UInt8) {
+void wav::source_data_to_float(const FormatDescriptor& descriptor, const unsigned char* src,
+                               uint32_t num_samples, float* out, bool normalize) {
+  if (descriptor.source_format == wav::SourceFormat::UInt8) {
     constexpr auto uint8_max = float(std::numeric_limits<uint8_t>::max());
     constexpr float uint8_min = 0.0f;
 
-    for (uint32_t i = 0; i < res.format_descriptor.num_samples; i++) {
-      auto val = float(uint8_t(res.data[i]));
+    for (uint32_t i = 0; i < num_samples; i++) {
+      auto val = float(uint8_t(src[i]));
 
       if (normalize) {
         val = (val - uint8_min) / (uint8_max - uint8_min) * 2.0f - 1.0f;
@@ -143,14 +210,13 @@ wav::wav_file_data_to_float(const FileReadResult& res, bool normalize, bool max_
       out[i] = val;
     }
 
-  } else if (res.format_descriptor.source_format == wav::SourceFormat::Int16) {
+  } else if (descriptor.source_format == wav::SourceFormat::Int16) {
     constexpr auto int16_max = float(std::numeric_limits<int16_t>::max());
     constexpr auto int16_min = float(std::numeric_limits<int16_t>::min());
 
-    const auto* src = res.data.get();
     uint32_t off = 0;
 
-    for (uint32_t i = 0; i < res.format_descriptor.num_samples; i++) {
+    for (uint32_t i = 0; i < num_samples; i++) {
       int16_t v;
       std::memcpy(&v, src + off, 2);
       off += 2;
@@ -166,12 +232,61 @@ wav::wav_file_data_to_float(const FileReadResult& res, bool normalize, bool max_
   } else {
     assert(false && "Unhandled source format.");
   }
+}
 
-  if (max_normalize) {
-    abs_max_normalize(out.get(), out.get() + res.format_descriptor.num_samples);
+/*
+ * FileWriter
+ */
+
+bool wav::open_wav_file_writer(FileWriter* writer, const std::string& file_path,
+                               uint16_t num_channels, uint32_t sample_rate) {
+  assert(num_channels > 0);
+  writer->file.open(file_path.c_str(), std::ios_base::out | std::ios_base::binary);
+  if (!writer->file.good()) {
+    return false;
   }
 
-  return out;
+  writer->num_channels = num_channels;
+  writer->sample_rate = sample_rate;
+  writer->num_frames = 0;
+  write_header(writer->file, num_channels, sample_rate, 0);
+  return writer->file.good();
+}
+
+bool wav::write_wav_frames(FileWriter* writer, const float* interleaved, uint32_t num_frames) {
+  constexpr auto int16_max = float(std::numeric_limits<int16_t>::max());
+  constexpr auto int16_min = float(std::numeric_limits<int16_t>::min());
+
+  const uint32_t num_samples = num_frames * writer->num_channels;
+  writer->scratch.resize(num_samples);
+
+  for (uint32_t i = 0; i < num_samples; i++) {
+    //  Inverse of the Int16 normalization in `source_data_to_float`.
+    const float v = clamp(interleaved[i], -1.0f, 1.0f);
+    const float val = (v + 1.0f) * 0.5f * (int16_max - int16_min) + int16_min;
+    writer->scratch[i] = int16_t(std::round(val));
+  }
+
+  writer->file.write((const char*) writer->scratch.data(), num_samples * sizeof(int16_t));
+  writer->num_frames += num_frames;
+  return writer->file.good();
+}
+
+bool wav::close_wav_file_writer(FileWriter* writer) {
+  write_header(writer->file, writer->num_channels, writer->sample_rate, writer->num_frames);
+  const bool success = writer->file.good();
+  writer->file.close();
+  return success;
+}
+
+bool wav::write_wav_file(const std::string& file_path, const float* interleaved,
+                         uint32_t num_frames, uint16_t num_channels, uint32_t sample_rate) {
+  FileWriter writer;
+  if (!open_wav_file_writer(&writer, file_path, num_channels, sample_rate)) {
+    return false;
+  }
+  const bool wrote = write_wav_frames(&writer, interleaved, num_frames);
+  return close_wav_file_writer(&writer) && wrote;
 }
 
 }
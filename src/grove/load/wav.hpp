@@ -3,6 +3,8 @@
 #include <string>
 #include <cstdint>
 #include <memory>
+#include <fstream>
+#include <vector>
 
 namespace grove::wav {
   enum class SourceFormat {
@@ -37,7 +39,36 @@ namespace grove::wav {
 
   FileReadResult read_wav_file(const std::string& file_path);
 
+  //  Read and validate only the header of `file_path`. On success, `num_samples` and
+  //  `num_frames` are filled in and `data_offset` receives the byte offset of the first sample,
+  //  for reading the sample data incrementally.
+  bool read_wav_format(const std::string& file_path, FormatDescriptor* descriptor,
+                       uint32_t* data_offset);
+
+  //  Convert `num_samples` samples of raw `descriptor.source_format` data to float.
+  void source_data_to_float(const FormatDescriptor& descriptor, const unsigned char* src,
+                            uint32_t num_samples, float* dst, bool normalize = true);
+
   std::unique_ptr<float[]> wav_file_data_to_float(const FileReadResult& result,
                                                   bool normalize = true,
                                                   bool max_normalize = false);
+
+  //  Writes 16-bit PCM wav files incrementally, e.g. as audio is rendered. Samples are converted
+  //  from float in [-1, 1] such that `read_wav_file` + `wav_file_data_to_float` recovers them.
+  struct FileWriter {
+    std::ofstream file;
+    uint16_t num_channels{};
+    uint32_t sample_rate{};
+    uint32_t num_frames{};
+    std::vector<int16_t> scratch;
+  };
+
+  //  Write a header with placeholder sizes; `close_wav_file_writer` fills them in.
+  bool open_wav_file_writer(FileWriter* writer, const std::string& file_path,
+                            uint16_t num_channels, uint32_t sample_rate);
+  bool write_wav_frames(FileWriter* writer, const float* interleaved, uint32_t num_frames);
+  bool close_wav_file_writer(FileWriter* writer);
+
+  bool write_wav_file(const std::string& file_path, const float* interleaved,
+                      uint32_t num_frames, uint16_t num_channels, uint32_t sample_rate);
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "resolve.hpp"
 #include "interpret.hpp"
 #include "grove/common/common.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/common/Temporary.hpp"
+#include <algorithm>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -10,20 +13,25 @@ namespace {
 
 using namespace ls;
 
-struct CopyResultString {
-  std::vector<uint8_t> str_data;
-  std::vector<uint32_t> str;
-  std::vector<ResultStringSpans> spans;
+struct Config {
+  static constexpr uint32_t min_num_items_per_chunk = 256;
+  static constexpr int max_num_chunks_per_thread = 4;
 };
 
+template <typename T>
+void append(std::vector<T>* dst, const void* src, size_t count) {
+  const size_t beg = dst->size();
+  dst->resize(beg + count);
+  if (count > 0) {
+    memcpy(dst->data() + beg, src, count * sizeof(T));
+  }
+}
+
 Span add_result_str(std::vector<uint32_t>* dst,
                     const uint8_t* str,
                     uint32_t str_size) {
   auto dst_str_beg = dst->size();
-  dst->resize(dst->size() + str_size);
-  if (str_size > 0) {
-    memcpy(dst->data() + dst_str_beg, str, str_size * sizeof(uint32_t));
-  }
+  append(dst, str, str_size);
   return Span{uint32_t(dst_str_beg), str_size};
 }
 
@@ -31,124 +39,148 @@ Span add_result_str_data(std::vector<uint8_t>* dst,
                          const uint8_t* str_data,
                          uint32_t str_data_size) {
   auto dst_dat_beg = dst->size();
-  dst->resize(dst->size() + str_data_size);
-  if (str_data_size > 0) {
-    memcpy(dst->data() + dst_dat_beg, str_data, str_data_size);
-  }
+  append(dst, str_data, str_data_size);
   return Span{uint32_t(dst_dat_beg), str_data_size};
 }
 
-uint32_t sum_module_type_sizes(const DeriveContext* ctx, const uint32_t* str, uint32_t str_size) {
-  return sum_module_type_sizes(
-    ctx->type_nodes,
-    ctx->storage,
-    str,
-    str_size).unwrap();
+void copy_modules(const DerivingString* str, const uint32_t* module_data_offsets,
+                  uint32_t begin, uint32_t end, DeriveResult* result) {
+  const uint32_t data_beg = module_data_offsets[begin];
+  append(&result->str, str->str + begin, end - begin);
+  append(&result->str_data, str->str_data + data_beg, module_data_offsets[end] - data_beg);
+}
+
+/*
+ * memo
+ */
+
+uint64_t hash_bytes(const uint8_t* bytes, size_t size, uint64_t seed) {
+  //  FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ull ^ seed;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+const DeriveMemo::Entry* find_memo_entry(const DeriveMemo* memo, uint64_t hash,
+                                         const uint8_t* key, uint32_t key_size) {
+  auto it = memo->first_entries.find(hash);
+  if (it == memo->first_entries.end()) {
+    return nullptr;
+  }
+  for (uint32_t i = it->second; i != ~0u; i = memo->entries[i].next) {
+    auto& entry = memo->entries[i];
+    if (entry.hash == hash && entry.key.size == key_size &&
+        memcmp(memo->data.data() + entry.key.begin, key, key_size) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+InterpretResult to_interpret_result(const DeriveMemo* memo, const DeriveMemo::Entry& entry) {
+  auto* strs = reinterpret_cast<const uint8_t*>(memo->strs.data());
+  const uint8_t* data = memo->data.data();
+  InterpretResult result{};
+  result.ok = true;
+  result.match = true;
+  result.succ_str = strs + entry.succ.str.begin * sizeof(uint32_t);
+  result.succ_str_size = entry.succ.str.size;
+  result.succ_str_data = data + entry.succ.data.begin;
+  result.succ_str_data_size = entry.succ.data.size;
+  result.res_str = strs + entry.res.str.begin * sizeof(uint32_t);
+  result.res_str_size = entry.res.str.size;
+  result.res_str_data = data + entry.res.data.begin;
+  result.res_str_data_size = entry.res.data.size;
+  return result;
+}
+
+size_t memo_size(const DeriveMemo* memo) {
+  return memo->data.size() + memo->strs.size() * sizeof(uint32_t) +
+         memo->entries.size() * sizeof(DeriveMemo::Entry);
+}
+
+void add_memo_entry(DeriveMemo* memo, uint64_t hash, const uint8_t* key, uint32_t key_size,
+                    const uint8_t* random_state, uint32_t random_state_size,
+                    const InterpretResult& res) {
+  if (memo_size(memo) > memo->max_num_bytes) {
+    clear_derive_memo(memo);
+  }
+
+  DeriveMemo::Entry entry{};
+  entry.hash = hash;
+  entry.next = ~0u;
+  entry.key = add_result_str_data(&memo->data, key, key_size);
+  entry.random_state = add_result_str_data(&memo->data, random_state, random_state_size);
+  entry.succ.str = add_result_str(&memo->strs, res.succ_str, res.succ_str_size);
+  entry.succ.data = add_result_str_data(
+    &memo->data, res.succ_str_data, uint32_t(res.succ_str_data_size));
+  entry.res.str = add_result_str(&memo->strs, res.res_str, res.res_str_size);
+  entry.res.data = add_result_str_data(
+    &memo->data, res.res_str_data, uint32_t(res.res_str_data_size));
+
+  const auto entry_index = uint32_t(memo->entries.size());
+  auto it = memo->first_entries.find(hash);
+  if (it != memo->first_entries.end()) {
+    entry.next = it->second;
+    it->second = entry_index;
+  } else {
+    memo->first_entries[hash] = entry_index;
+  }
+  memo->entries.push_back(entry);
 }
 
-CopyResultString interpret(DeriveContext* ctx, const DerivingString* str,
-                           const StringSplice* splices, uint32_t num_matches,
-                           DeriveResult* result) {
-  CopyResultString copy_succ_str;
-  for (uint32_t i = 0; i < num_matches; i++) {
+//  Evaluate the splices in [begin, end), copying forward the modules that precede each one. The
+//  last chunk also copies the modules that follow the last splice.
+void derive_splices(const DeriveContext* ctx, const DerivingString* str,
+                    const uint32_t* module_data_offsets,
+                    const StringSplice* splices, uint32_t num_splices,
+                    uint32_t begin, uint32_t end, uint8_t* frame, uint8_t* stack,
+                    DeriveMemoCounts* memo_counts, DeriveResult* result) {
+  for (uint32_t i = begin; i < end; i++) {
     auto& splice = splices[i];
     assert(splice.size > 0);
-    auto& instr_span = ctx->rule_instruction_spans[splice.rule];
-    const uint8_t* rule_inst = ctx->rule_instructions + instr_span.begin;
-    const uint32_t rule_inst_size = instr_span.size;
-    auto& rule_scope = ctx->scopes[ctx->rule_si[splice.rule]];
+    const uint32_t prev_end = i == 0 ? 0 : splices[i-1].str_begin + splices[i-1].size;
+    //  Copy old string
+    copy_modules(str, module_data_offsets, prev_end, splice.str_begin, result);
 
-    const uint32_t str_off =
-      grove::sum_module_type_sizes(ctx, str->str, splice.str_begin);
-    const uint32_t str_sz =
-      grove::sum_module_type_sizes(ctx, str->str + splice.str_begin, splice.size);
+    auto& rule_scope = ctx->scopes[ctx->rule_si[splice.rule]];
+    const uint32_t str_off = module_data_offsets[splice.str_begin];
+    const uint32_t str_sz = module_data_offsets[splice.str_begin + splice.size] - str_off;
     assert(str_sz <= rule_scope.stack_size);
 
     const uint32_t rule_off = rule_scope.stack_offset;
     assert(str_off + str_sz <= str->str_data_size);
     assert(rule_off + str_sz <= ctx->frame_size);
-    memcpy(ctx->frame + rule_off, str->str_data + str_off, str_sz);
-
-    auto interp_ctx = make_interpret_context(
-      ctx->frame,
-      ctx->frame_size,
-      ctx->stack,
-      uint32_t(ctx->stack_size));
-    auto interp_res = interpret(&interp_ctx, rule_inst, rule_inst_size);
-
-    ResultStringSpans succ_spans{};
-    succ_spans.str = add_result_str(
-      &copy_succ_str.str,
-      interp_res.succ_str,
-      interp_res.succ_str_size);
-    succ_spans.data = add_result_str_data(
-      &copy_succ_str.str_data,
-      interp_res.succ_str_data,
-      interp_res.succ_str_data_size);
-    copy_succ_str.spans.push_back(succ_spans);
+    memcpy(frame + rule_off, str->str_data + str_off, str_sz);
+
+    //  Chunks evaluated in parallel have their own frames, and only read the memo.
+    auto interp_res = detail::evaluate_rule(
+      ctx, splice.rule, str_sz, frame, stack, frame == ctx->frame, memo_counts);
+
+    //  Splice in new string
+    append(&result->str, interp_res.succ_str, interp_res.succ_str_size);
+    append(&result->str_data, interp_res.succ_str_data, interp_res.succ_str_data_size);
 
     ResultStringSpans res_spans{};
     res_spans.str = add_result_str(
       &result->result_strs, interp_res.res_str, interp_res.res_str_size);
     res_spans.data = add_result_str_data(
-      &result->result_str_datas, interp_res.res_str_data, interp_res.res_str_data_size);
+      &result->result_str_datas, interp_res.res_str_data, uint32_t(interp_res.res_str_data_size));
     result->result_spans.push_back(res_spans);
   }
-  return copy_succ_str;
-}
-
-void splice_string(DeriveContext* ctx, const DerivingString* str,
-                   const StringSplice* splices, uint32_t num_matches,
-                   const CopyResultString* copy_succ_str,
-                   DeriveResult* result) {
-  for (uint32_t i = 0; i < num_matches; i++) {
-    const uint32_t prev_end = i == 0 ? 0 :
-      splices[i-1].str_begin + splices[i-1].size;
-    const uint32_t str_beg = splices[i].str_begin;
-    const uint32_t copy_str_off =
-      grove::sum_module_type_sizes(ctx, str->str, prev_end);
-    const uint32_t copy_str_sz =
-      grove::sum_module_type_sizes(ctx, str->str + prev_end, str_beg - prev_end);
-    //  Copy old string types
-    for (uint32_t j = prev_end; j < str_beg; j++) {
-      result->str.push_back(str->str[j]);
-    }
-    //  Copy old string data
-    auto str_data_beg = result->str_data.size();
-    result->str_data.resize(result->str_data.size() + copy_str_sz);
-    if (copy_str_sz > 0) {
-      memcpy(result->str_data.data() + str_data_beg, str->str_data + copy_str_off, copy_str_sz);
-    }
-#ifdef GROVE_DEBUG
-    {
-      auto next_sz = grove::sum_module_type_sizes(ctx, result->str.data(), result->str.size());
-      assert(next_sz == result->str_data.size());
-    }
-#endif
 
-    //  Splice in new types
-    auto& spans = copy_succ_str->spans[i];
-    auto& succ_span = spans.str;
-    auto& succ_data_span = spans.data;
-    result->str.insert(
-      result->str.end(),
-      copy_succ_str->str.data() + succ_span.begin,
-      copy_succ_str->str.data() + succ_span.begin + succ_span.size);
-    result->str_data.insert(
-      result->str_data.end(),
-      copy_succ_str->str_data.data() + succ_data_span.begin,
-      copy_succ_str->str_data.data() + succ_data_span.begin + succ_data_span.size);
-#ifdef GROVE_DEBUG
-    {
-      auto next_sz = grove::sum_module_type_sizes(ctx, result->str.data(), result->str.size());
-      assert(next_sz == result->str_data.size());
-    }
-#endif
+  if (end == num_splices) {
+    const uint32_t prev_end = end == 0 ? 0 : splices[end-1].str_begin + splices[end-1].size;
+    copy_modules(str, module_data_offsets, prev_end, str->str_size, result);
   }
 }
 
-auto match(DeriveContext* ctx, const DerivingString* str, uint32_t* num_matches) {
-  std::vector<StringSplice> splices(str->str_size);
+void match(DeriveContext* ctx, const DerivingString* str, DeriveScratch* scratch,
+           uint32_t* num_matches) {
+  auto& splices = scratch->splices;
+  splices.resize(str->str_size);
   MatchContext match_ctx{};
   match_ctx.str_tis = str->str;
   match_ctx.str_size = str->str_size;
@@ -158,18 +190,271 @@ auto match(DeriveContext* ctx, const DerivingString* str, uint32_t* num_matches)
   match_ctx.branch_in_t = ctx->branch_in_t;
   match_ctx.branch_out_t = ctx->branch_out_t;
   *num_matches = match(match_ctx, splices.data());
-  return splices;
 }
 
 } //  anon
 
+void ls::detail::compute_module_data_offsets(const DeriveContext* ctx, const DerivingString* str,
+                                             std::vector<uint32_t>* offsets) {
+  offsets->resize(str->str_size + 1);
+  uint32_t cum_off{};
+  for (uint32_t i = 0; i < str->str_size; i++) {
+    (*offsets)[i] = cum_off;
+    cum_off += module_type_size(ctx->type_nodes, ctx->storage, str->str[i]).unwrap();
+  }
+  (*offsets)[str->str_size] = cum_off;
+  assert(cum_off == str->str_data_size);
+}
+
+int ls::detail::prepare_derive_chunks(const DeriveContext* ctx, uint32_t num_items,
+                                      DeriveScratch* scratch) {
+  if (!ctx->task_pool || ctx->task_pool->num_workers() == 0) {
+    return 0;
+  }
+
+  const int max_num_chunks = (ctx->task_pool->num_workers() + 1) *
+                             Config::max_num_chunks_per_thread;
+  const int num_chunks = std::min(
+    max_num_chunks, int(num_items / Config::min_num_items_per_chunk));
+  if (num_chunks < 2) {
+    return 0;
+  }
+
+  if (int(scratch->chunks.size()) < num_chunks) {
+    scratch->chunks.resize(num_chunks);
+  }
+  for (int i = 0; i < num_chunks; i++) {
+    auto& chunk = scratch->chunks[i];
+    clear(&chunk.result);
+    chunk.frame.assign(ctx->frame, ctx->frame + ctx->frame_size);
+    chunk.stack.resize(ctx->stack_size);
+    chunk.memo_counts = {};
+  }
+  return num_chunks;
+}
+
+InterpretResult ls::detail::evaluate_rule(const DeriveContext* ctx, uint32_t rule,
+                                          uint32_t args_size, uint8_t* frame, uint8_t* stack,
+                                          bool memo_insert,
+                                          DeriveMemoCounts* memo_counts) {
+  assert(rule < ctx->num_rules);
+  DeriveMemo* memo = ctx->memo;
+  uint64_t rule_hash = memo ? memo->rule_hashes[rule] : 0;
+  const bool random = rule_hash && memo->rule_random[rule];
+  if (random && !memo_insert) {
+    rule_hash = 0;
+  }
+
+  const uint8_t* args = frame + ctx->scopes[ctx->rule_si[rule]].stack_offset;
+  const uint8_t* key = args;
+  uint32_t key_size = args_size;
+  //  Rules may assign to their arguments, so keep the originals for the key.
+  Temporary<uint8_t, 256> store_key;
+  if (rule_hash && (memo_insert || random)) {
+    key_size += random ? memo->random_state_size : 0;
+    uint8_t* key_copy = store_key.require(int(key_size));
+    memcpy(key_copy, args, args_size);
+    if (random) {
+      memo->get_random_state(key_copy + args_size);
+    }
+    key = key_copy;
+  }
+
+  uint64_t hash{};
+  if (rule_hash) {
+    hash = hash_bytes(key, key_size, rule_hash);
+    if (auto* entry = find_memo_entry(memo, hash, key, key_size)) {
+      memo_counts->num_hits++;
+      if (random) {
+        memo->set_random_state(memo->data.data() + entry->random_state.begin);
+      }
+      return to_interpret_result(memo, *entry);
+    }
+    memo_counts->num_misses++;
+  }
+
+  auto interp_ctx = make_interpret_context(frame, ctx->frame_size, stack, ctx->stack_size);
+  InterpretResult result;
+  if (ctx->rule_programs && !ctx->rule_programs[rule].empty()) {
+    result = interpret(&interp_ctx, ctx->rule_programs[rule]);
+  } else {
+    auto& instr_span = ctx->rule_instruction_spans[rule];
+    result = interpret(&interp_ctx, ctx->rule_instructions + instr_span.begin, instr_span.size);
+  }
+  assert(result.ok && result.match);
+
+  if (rule_hash && memo_insert) {
+    Temporary<uint8_t, 64> store_random_state;
+    uint8_t* random_state{};
+    if (random) {
+      random_state = store_random_state.require(int(memo->random_state_size));
+      memo->get_random_state(random_state);
+    }
+    add_memo_entry(memo, hash, key, key_size, random_state,
+                   random ? memo->random_state_size : 0, result);
+  }
+  return result;
+}
+
+void ls::detail::add_memo_counts(const DeriveContext* ctx, const DeriveMemoCounts& counts) {
+  if (ctx->memo) {
+    ctx->memo->num_hits += counts.num_hits;
+    ctx->memo->num_misses += counts.num_misses;
+  }
+}
+
+void ls::prepare_derive_memo(DeriveMemo* memo, const DeriveContext* ctx) {
+  memo->rule_hashes.resize(ctx->num_rules);
+  memo->rule_random.resize(ctx->num_rules);
+  const bool can_memoize_random =
+    memo->memoize_random_rules && memo->get_random_state && memo->set_random_state;
+  std::vector<ForeignFunction*> funcs;
+  for (uint32_t i = 0; i < ctx->num_rules; i++) {
+    auto& span = ctx->rule_instruction_spans[i];
+    const uint8_t* inst = ctx->rule_instructions + span.begin;
+    funcs.clear();
+    bool memoized = find_called_functions(inst, span.size, &funcs);
+    bool random{};
+    for (auto* func : funcs) {
+      auto& pure_funcs = memo->pure_functions;
+      auto& random_funcs = memo->random_functions;
+      if (can_memoize_random &&
+          std::find(random_funcs.begin(), random_funcs.end(), func) != random_funcs.end()) {
+        random = true;
+      } else {
+        memoized = memoized &&
+          std::find(pure_funcs.begin(), pure_funcs.end(), func) != pure_funcs.end();
+      }
+    }
+    //  0 marks a rule that is not memoized.
+    memo->rule_hashes[i] = memoized ? std::max(uint64_t(1), hash_bytes(inst, span.size, 0)) : 0;
+    memo->rule_random[i] = uint8_t(memoized && random);
+  }
+}
+
+void ls::clear_derive_memo(DeriveMemo* memo) {
+  memo->first_entries.clear();
+  memo->entries.clear();
+  memo->strs.clear();
+  memo->data.clear();
+}
+
+void ls::detail::clear(DeriveResult* result) {
+  result->str.clear();
+  result->str_data.clear();
+  result->result_strs.clear();
+  result->result_str_datas.clear();
+  result->result_spans.clear();
+}
+
+void ls::detail::gather_derive_chunks(const DeriveContext* ctx, DeriveScratch* scratch,
+                                      int num_chunks, DeriveResult* result) {
+  struct Offsets {
+    size_t str;
+    size_t str_data;
+    size_t result_strs;
+    size_t result_str_datas;
+    size_t result_spans;
+  };
+
+  Temporary<Offsets, 64> store_offsets;
+  Offsets* offsets = store_offsets.require(num_chunks + 1);
+  offsets[0] = {};
+  for (int i = 0; i < num_chunks; i++) {
+    auto& src = scratch->chunks[i].result;
+    auto& off = offsets[i + 1];
+    off = offsets[i];
+    off.str += src.str.size();
+    off.str_data += src.str_data.size();
+    off.result_strs += src.result_strs.size();
+    off.result_str_datas += src.result_str_datas.size();
+    off.result_spans += src.result_spans.size();
+  }
+
+  DeriveMemoCounts memo_counts{};
+  for (int i = 0; i < num_chunks; i++) {
+    memo_counts.num_hits += scratch->chunks[i].memo_counts.num_hits;
+    memo_counts.num_misses += scratch->chunks[i].memo_counts.num_misses;
+  }
+  add_memo_counts(ctx, memo_counts);
+
+  auto& total = offsets[num_chunks];
+  result->str.resize(total.str);
+  result->str_data.resize(total.str_data);
+  result->result_strs.resize(total.result_strs);
+  result->result_str_datas.resize(total.result_str_datas);
+  result->result_spans.resize(total.result_spans);
+
+  ctx->task_pool->parallel_for(num_chunks, [&](int i, int) {
+    auto& src = scratch->chunks[i].result;
+    auto& off = offsets[i];
+    std::copy(src.str.begin(), src.str.end(), result->str.begin() + off.str);
+    std::copy(src.str_data.begin(), src.str_data.end(), result->str_data.begin() + off.str_data);
+    std::copy(src.result_strs.begin(), src.result_strs.end(),
+              result->result_strs.begin() + off.result_strs);
+    std::copy(src.result_str_datas.begin(), src.result_str_datas.end(),
+              result->result_str_datas.begin() + off.result_str_datas);
+    for (size_t j = 0; j < src.result_spans.size(); j++) {
+      auto spans = src.result_spans[j];
+      spans.str.begin += uint32_t(off.result_strs);
+      spans.data.begin += uint32_t(off.result_str_datas);
+      result->result_spans[off.result_spans + j] = spans;
+    }
+  });
+}
+
+std::vector<RegisterProgram> ls::make_register_programs(const DeriveContext* ctx) {
+  std::vector<RegisterProgram> result(ctx->num_rules);
+  for (uint32_t i = 0; i < ctx->num_rules; i++) {
+    auto& span = ctx->rule_instruction_spans[i];
+    result[i] = make_register_program(
+      ctx->rule_instructions + span.begin, span.size, ctx->stack_size);
+  }
+  return result;
+}
+
 DeriveResult ls::derive(DeriveContext* ctx, const DerivingString* str) {
+  DeriveScratch scratch;
   DeriveResult result;
-  uint32_t num_matches;
-  auto splices = grove::match(ctx, str, &num_matches);
-  auto copy_succ_str = grove::interpret(ctx, str, splices.data(), num_matches, &result);
-  splice_string(ctx, str, splices.data(), num_matches, &copy_succ_str, &result);
+  derive(ctx, str, &scratch, &result);
   return result;
 }
 
+void ls::derive(DeriveContext* ctx, const DerivingString* str,
+                DeriveScratch* scratch, DeriveResult* result) {
+  detail::clear(result);
+  detail::compute_module_data_offsets(ctx, str, &scratch->module_data_offsets);
+  uint32_t num_matches;
+  grove::match(ctx, str, scratch, &num_matches);
+
+  const uint32_t* offsets = scratch->module_data_offsets.data();
+  const StringSplice* splices = scratch->splices.data();
+  const int num_chunks = detail::prepare_derive_chunks(ctx, num_matches, scratch);
+  if (num_chunks == 0) {
+    DeriveMemoCounts memo_counts{};
+    derive_splices(
+      ctx, str, offsets, splices, num_matches, 0, num_matches,
+      ctx->frame, ctx->stack, &memo_counts, result);
+    detail::add_memo_counts(ctx, memo_counts);
+  } else {
+    ctx->task_pool->parallel_for(num_chunks, [&](int i, int) {
+      auto& chunk = scratch->chunks[i];
+      const auto begin = uint32_t(uint64_t(num_matches) * i / num_chunks);
+      const auto end = uint32_t(uint64_t(num_matches) * (i + 1) / num_chunks);
+      derive_splices(
+        ctx, str, offsets, splices, num_matches, begin, end,
+        chunk.frame.data(), chunk.stack.data(), &chunk.memo_counts, &chunk.result);
+    });
+    detail::gather_derive_chunks(ctx, scratch, num_chunks, result);
+  }
+
+#ifdef GROVE_DEBUG
+  {
+    auto next_sz = sum_module_type_sizes(
+      ctx->type_nodes, ctx->storage, result->str.data(), uint32_t(result->str.size())).unwrap();
+    assert(next_sz == result->str_data.size());
+  }
+#endif
+}
+
 GROVE_NAMESPACE_END
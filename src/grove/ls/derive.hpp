@@ -1,10 +1,18 @@
 #pragma once
 
 #include "common.hpp"
+#include "interpret.hpp"
+#include <unordered_map>
 #include <vector>
 
+namespace grove {
+class TaskPool;
+}
+
 namespace grove::ls {
 
+struct DeriveMemo;
+
 struct DeriveContext {
   const Scope* scopes;
   const TypeNode* type_nodes;
@@ -22,6 +30,19 @@ struct DeriveContext {
 
   uint32_t branch_in_t;
   uint32_t branch_out_t;
+
+  //  Optional. Register forms of the rule instructions, one per rule (see
+  //  `make_register_programs`). Rules with an empty program are interpreted from their
+  //  instructions.
+  const RegisterProgram* rule_programs;
+  //  Optional. If non-null, rules are evaluated in parallel over chunks of the string, each chunk
+  //  with its own copy of `frame` and `stack`. Foreign functions called by rules must then be
+  //  thread safe; the result matches that of serial derivation if they are also independent of the
+  //  order in which they are called.
+  TaskPool* task_pool;
+  //  Optional. Rule evaluations are read from and added to `memo`. When rules are evaluated in
+  //  parallel, the memo is only read.
+  DeriveMemo* memo;
 };
 
 struct ResultStringSpans {
@@ -37,6 +58,116 @@ struct DeriveResult {
   std::vector<ResultStringSpans> result_spans;
 };
 
+struct BranchedRuleMatch {
+  bool is_pred;
+  bool is_first_pred;
+  uint32_t rule_index;
+  uint32_t rule_arg_begin;
+  uint32_t rule_arg_size;
+  uint32_t rule_pred_offset;
+  uint32_t rule_pred_size;
+};
+
+//  Memo lookups made while deriving the string, or one chunk of it.
+struct DeriveMemoCounts {
+  uint64_t num_hits;
+  uint64_t num_misses;
+};
+
+//  Intermediate buffers of a derivation step. Passing the same scratch to successive steps avoids
+//  reallocating them each generation.
+struct DeriveScratch {
+  struct Chunk {
+    DeriveResult result;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> stack;
+    DeriveMemoCounts memo_counts;
+  };
+
+  std::vector<uint32_t> module_data_offsets;
+  std::vector<StringSplice> splices;
+  std::vector<BranchedRuleMatch> branched_matches;
+  std::vector<Chunk> chunks;
+};
+
+/*
+ * DeriveMemo
+ *
+ * Results of earlier rule evaluations, keyed by a hash of the rule's instructions and the bytes of
+ * its arguments. A rule is memoized only if each foreign function it calls is listed in
+ * `pure_functions` or `random_functions`, so that its result depends on its instructions and
+ * arguments alone. Keys do not depend on rule indices, so after a system is recompiled, entries
+ * remain valid for the rules whose instructions did not change. Entries are discarded once they
+ * occupy more than `max_num_bytes`.
+ *
+ * `random_functions` draw from a random stream whose state of `random_state_size` bytes is read
+ * with `get_random_state` and restored with `set_random_state`. If `memoize_random_rules` is set,
+ * then for rules that call them, the state before the evaluation is part of the key, and a hit
+ * restores the state after it. These rules hit only when the stream repeats, e.g. when re-deriving
+ * from the same seed; a derive from a new seed pays to key and store every evaluation without a
+ * hit, so this is off by default. They are not memoized when evaluated in parallel, since the
+ * stream is then shared between threads.
+ */
+struct DeriveMemo {
+  struct Entry {
+    uint64_t hash;
+    uint32_t next;
+    Span key;
+    Span random_state;
+    ResultStringSpans succ;
+    ResultStringSpans res;
+  };
+
+  std::vector<ForeignFunction*> pure_functions;
+  std::vector<ForeignFunction*> random_functions;
+  uint32_t random_state_size{};
+  void (*get_random_state)(uint8_t* dst){};
+  void (*set_random_state)(const uint8_t* src){};
+  bool memoize_random_rules{};
+  size_t max_num_bytes{size_t(64) * 1024 * 1024};
+
+  //  Hash of each rule's instructions, or 0 if the rule is not memoized.
+  std::vector<uint64_t> rule_hashes;
+  //  Whether each rule calls one of `random_functions`.
+  std::vector<uint8_t> rule_random;
+  std::unordered_map<uint64_t, uint32_t> first_entries;
+  std::vector<Entry> entries;
+  std::vector<uint32_t> strs;
+  std::vector<uint8_t> data;
+  uint64_t num_hits{};
+  uint64_t num_misses{};
+};
+
+//  Hashes the rules of `ctx`. Call whenever the rules change, e.g. after recompiling the system.
+void prepare_derive_memo(DeriveMemo* memo, const DeriveContext* ctx);
+void clear_derive_memo(DeriveMemo* memo);
+
 DeriveResult derive(DeriveContext* ctx, const DerivingString* str);
+//  As above, but reuses the storage of `scratch` and `result`. `str` must not point into `result`.
+void derive(DeriveContext* ctx, const DerivingString* str,
+            DeriveScratch* scratch, DeriveResult* result);
+
+std::vector<RegisterProgram> make_register_programs(const DeriveContext* ctx);
+
+namespace detail {
+
+//  Shared by `derive` and `derive_branched`.
+void compute_module_data_offsets(const DeriveContext* ctx, const DerivingString* str,
+                                 std::vector<uint32_t>* offsets);
+int prepare_derive_chunks(const DeriveContext* ctx, uint32_t str_size, DeriveScratch* scratch);
+//  `rule`'s arguments, `args_size` bytes, have been copied into `frame`. If `ctx->memo` is set,
+//  the result is read from or, if `memo_insert` is true, added to it, and the lookup is counted in
+//  `memo_counts`. A memoized result remains valid until the next evaluation.
+InterpretResult evaluate_rule(const DeriveContext* ctx, uint32_t rule, uint32_t args_size,
+                              uint8_t* frame, uint8_t* stack, bool memo_insert,
+                              DeriveMemoCounts* memo_counts);
+//  Adds `counts` to `ctx->memo`'s totals, if set. Called once the derivation is complete, so that
+//  chunks evaluated in parallel do not write to the memo.
+void add_memo_counts(const DeriveContext* ctx, const DeriveMemoCounts& counts);
+void clear(DeriveResult* result);
+void gather_derive_chunks(const DeriveContext* ctx, DeriveScratch* scratch, int num_chunks,
+                          DeriveResult* result);
+
+}
 
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 #include "interpret.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/Optional.hpp"
+#include "grove/common/TaskPool.hpp"
 
 GROVE_NAMESPACE_BEGIN
 
@@ -11,16 +12,6 @@ namespace {
 
 using namespace ls;
 
-struct RuleMatch {
-  bool is_pred;
-  bool is_first_pred;
-  uint32_t rule_index;
-  uint32_t rule_arg_begin;
-  uint32_t rule_arg_size;
-  uint32_t rule_pred_offset;
-  uint32_t rule_pred_size;
-};
-
 void find_pred(const RuleParameter* params, uint32_t param_size, uint32_t* first_pred,
                uint32_t* pred_size) {
   for (uint32_t i = 0; i < param_size; i++) {
@@ -95,11 +86,8 @@ Optional<uint32_t> look_back_n(const DeriveContext* ctx, const uint32_t* str,
   return i == n ? Optional<uint32_t>(str_p) : NullOpt{};
 }
 
-auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
-  struct Result {
-    std::vector<RuleMatch> matches;
-  };
-
+void match(DeriveContext* ctx, const DerivingString* deriving_str,
+           std::vector<BranchedRuleMatch>* matches) {
   const uint32_t* str = deriving_str->str;
   const uint32_t str_size = deriving_str->str_size;
 
@@ -107,7 +95,8 @@ auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
   //  spliced out in the next derivation step. Otherwise, it will be copied forward.
   //  potential_matches[i].is_first_pred is true if the module is the first predecessor argument
   //  to a rule, in which case the rule should be executed.
-  std::vector<RuleMatch> potential_matches(str_size);
+  auto& potential_matches = *matches;
+  potential_matches.assign(str_size, BranchedRuleMatch{});
 
   int branch_depth{};
   for (uint32_t str_p = 0; str_p < str_size; str_p++) {
@@ -125,7 +114,7 @@ auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
       continue;
     }
 
-    Optional<RuleMatch> best_match;
+    Optional<BranchedRuleMatch> best_match;
     for (uint32_t ri = 0; ri < ctx->num_rules; ri++) {
       auto& rule_params = ctx->rule_param_spans[ri];
       assert(rule_params.size > 0);
@@ -149,7 +138,7 @@ auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
 
       const bool matched = i == rule_params.size;
       if (matched && (!best_match || rule_params.size > best_match.value().rule_arg_size)) {
-        RuleMatch rule_match{};
+        BranchedRuleMatch rule_match{};
         rule_match.rule_index = ri;
         rule_match.rule_arg_begin = pre_p.value();
         rule_match.rule_arg_size = rule_params.size;
@@ -160,7 +149,7 @@ auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
     }
 
     if (best_match) {
-      RuleMatch match = best_match.value(); //  @note by value
+      BranchedRuleMatch match = best_match.value(); //  @note by value
       match.is_pred = true;
       match.is_first_pred = true;
 
@@ -173,10 +162,6 @@ auto match(DeriveContext* ctx, const DerivingString* deriving_str) {
       }
     }
   }
-
-  Result result{};
-  result.matches = std::move(potential_matches);
-  return result;
 }
 
 void append_successor_str(DeriveResult& result, const InterpretResult& interp_res) {
@@ -193,52 +178,36 @@ void append_successor_str(DeriveResult& result, const InterpretResult& interp_re
   memcpy(dst_data.data() + curr_data_size, interp_res.succ_str_data, interp_res.succ_str_data_size);
 }
 
-} //  anon
-
-ls::DeriveResult ls::derive_branched(DeriveContext* ctx, const DerivingString* deriving_str) {
-  auto match_res = match(ctx, deriving_str);
-
+//  Derive the modules in [begin, end).
+void derive_modules(const DeriveContext* ctx, const DerivingString* deriving_str,
+                    const uint32_t* module_data_offsets, const BranchedRuleMatch* matches,
+                    uint32_t begin, uint32_t end, uint8_t* frame, uint8_t* stack,
+                    DeriveMemoCounts* memo_counts, DeriveResult* result) {
   const uint32_t* str = deriving_str->str;
   const uint32_t str_size = deriving_str->str_size;
   const uint8_t* str_data = deriving_str->str_data;
-  const uint32_t str_data_size = deriving_str->str_data_size;
-  (void) str_data_size;
-
-  std::vector<size_t> module_data_sizes(str_size);
-  std::vector<size_t> module_data_offsets(str_size);
-  {
-    size_t cum_off{};
-    for (uint32_t i = 0; i < str_size; i++) {
-      module_data_sizes[i] = module_type_size(ctx->type_nodes, ctx->storage, str[i]).unwrap();
-      module_data_offsets[i] = cum_off;
-      cum_off += module_data_sizes[i];
-    }
-  }
 
-  ls::DeriveResult result;
-  auto& dst_str = result.str;
-  auto& dst_data = result.str_data;
+  auto& dst_str = result->str;
+  auto& dst_data = result->str_data;
 
-  size_t str_data_p{};
-  for (uint32_t str_p = 0; str_p < str_size; str_p++) {
-    const auto& match_info = match_res.matches[str_p];
-    auto mod_size = module_data_sizes[str_p];
-    assert(str_data_p + mod_size <= str_data_size);
+  for (uint32_t str_p = begin; str_p < end; str_p++) {
+    const auto& match_info = matches[str_p];
+    const uint32_t str_data_p = module_data_offsets[str_p];
+    const uint32_t mod_size = module_data_offsets[str_p + 1] - str_data_p;
 
     if (!match_info.is_pred) {
       //  Not a predecessor, so copy to derived string.
       assert(!match_info.is_first_pred);
       dst_str.push_back(str[str_p]);
-      size_t dst_off = dst_data.size();
-      dst_data.resize(dst_data.size() + mod_size);
-      memcpy(dst_data.data() + dst_off, str_data + str_data_p, mod_size);
+      if (mod_size > 0) {
+        size_t dst_off = dst_data.size();
+        dst_data.resize(dst_data.size() + mod_size);
+        memcpy(dst_data.data() + dst_off, str_data + str_data_p, mod_size);
+      }
 
     } else if (match_info.is_first_pred) {
       //  Evaluate the rule and produce the successor string.
       assert(match_info.rule_index < ctx->num_rules);
-      auto& instr_span = ctx->rule_instruction_spans[match_info.rule_index];
-      const uint8_t* rule_inst = ctx->rule_instructions + instr_span.begin;
-      const uint32_t rule_inst_size = instr_span.size;
       auto& rule_scope = ctx->scopes[ctx->rule_si[match_info.rule_index]];
 
       //  Copy the module arguments from the existing string's data into the rule's stack frame.
@@ -246,24 +215,59 @@ ls::DeriveResult ls::derive_branched(DeriveContext* ctx, const DerivingString* d
       for (uint32_t i = 0; i < match_info.rule_arg_size; i++) {
         Optional<uint32_t> curr_p = look_ahead_n(ctx, str, str_size, match_info.rule_arg_begin, i);
         assert(curr_p);
-        auto curr_mod_size = module_data_sizes[curr_p.value()];
+        const uint32_t curr_off = module_data_offsets[curr_p.value()];
+        const uint32_t curr_mod_size = module_data_offsets[curr_p.value() + 1] - curr_off;
         assert(rule_off + curr_mod_size <= ctx->frame_size);
-        memcpy(ctx->frame + rule_off, str_data + module_data_offsets[curr_p.value()], curr_mod_size);
-        rule_off += uint32_t(curr_mod_size);
+        memcpy(frame + rule_off, str_data + curr_off, curr_mod_size);
+        rule_off += curr_mod_size;
       }
 
       //  Evaluate the rule.
-      auto interp_ctx = make_interpret_context(
-        ctx->frame, ctx->frame_size, ctx->stack, uint32_t(ctx->stack_size));
-      auto interp_res = interpret(&interp_ctx, rule_inst, rule_inst_size);
-      assert(interp_res.ok && interp_res.match);
-      append_successor_str(result, interp_res);
+      const uint32_t args_size = rule_off - rule_scope.stack_offset;
+      //  Chunks evaluated in parallel have their own frames, and only read the memo.
+      auto interp_res = detail::evaluate_rule(
+        ctx, match_info.rule_index, args_size, frame, stack, frame == ctx->frame, memo_counts);
+      append_successor_str(*result, interp_res);
     }
-
-    str_data_p += mod_size;
   }
+}
+
+} //  anon
 
+ls::DeriveResult ls::derive_branched(DeriveContext* ctx, const DerivingString* deriving_str) {
+  DeriveScratch scratch;
+  DeriveResult result;
+  derive_branched(ctx, deriving_str, &scratch, &result);
   return result;
 }
 
+void ls::derive_branched(DeriveContext* ctx, const DerivingString* deriving_str,
+                         DeriveScratch* scratch, DeriveResult* result) {
+  detail::clear(result);
+  grove::match(ctx, deriving_str, &scratch->branched_matches);
+  detail::compute_module_data_offsets(ctx, deriving_str, &scratch->module_data_offsets);
+
+  const uint32_t str_size = deriving_str->str_size;
+  const uint32_t* offsets = scratch->module_data_offsets.data();
+  const BranchedRuleMatch* matches = scratch->branched_matches.data();
+  const int num_chunks = detail::prepare_derive_chunks(ctx, str_size, scratch);
+  if (num_chunks == 0) {
+    DeriveMemoCounts memo_counts{};
+    derive_modules(
+      ctx, deriving_str, offsets, matches, 0, str_size,
+      ctx->frame, ctx->stack, &memo_counts, result);
+    detail::add_memo_counts(ctx, memo_counts);
+  } else {
+    ctx->task_pool->parallel_for(num_chunks, [&](int i, int) {
+      auto& chunk = scratch->chunks[i];
+      const auto begin = uint32_t(uint64_t(str_size) * i / num_chunks);
+      const auto end = uint32_t(uint64_t(str_size) * (i + 1) / num_chunks);
+      derive_modules(
+        ctx, deriving_str, offsets, matches, begin, end,
+        chunk.frame.data(), chunk.stack.data(), &chunk.memo_counts, &chunk.result);
+    });
+    detail::gather_derive_chunks(ctx, scratch, num_chunks, result);
+  }
+}
+
 GROVE_NAMESPACE_END
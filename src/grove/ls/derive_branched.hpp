@@ -4,8 +4,12 @@ namespace grove::ls {
 
 struct DeriveResult;
 struct DeriveContext;
+struct DeriveScratch;
 struct DerivingString;
 
 DeriveResult derive_branched(DeriveContext* ctx, const DerivingString* str);
+//  As above, but reuses the storage of `scratch` and `result`. `str` must not point into `result`.
+void derive_branched(DeriveContext* ctx, const DerivingString* str,
+                     DeriveScratch* scratch, DeriveResult* result);
 
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include "interpret.hpp"
 #include "grove/common/common.hpp"
 #include <cassert>
+#include <limits>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -42,6 +43,201 @@ void reads_v3_2(const uint8_t* stack, uint32_t* sp, float* arg1, float* arg2) {
   arg1[0] = reads<float>(stack, sp);
 }
 
+
+/*
+ * register form
+ */
+
+constexpr uint32_t max_register_offset() {
+  return std::numeric_limits<uint16_t>::max();
+}
+
+float read_float(const uint8_t* src) {
+  float v;
+  memcpy(&v, src, sizeof(float));
+  return v;
+}
+
+void write_float(uint8_t* dst, float v) {
+  memcpy(dst, &v, sizeof(float));
+}
+
+void write_int32(uint8_t* dst, int32_t v) {
+  memcpy(dst, &v, sizeof(int32_t));
+}
+
+RegisterOp to_register_op(uint8_t inst) {
+  switch (inst) {
+    case Instructions::addf:
+      return RegisterOp::AddF;
+    case Instructions::subf:
+      return RegisterOp::SubF;
+    case Instructions::mulf:
+      return RegisterOp::MulF;
+    case Instructions::divf:
+      return RegisterOp::DivF;
+    case Instructions::ltf:
+      return RegisterOp::LtF;
+    case Instructions::gtf:
+      return RegisterOp::GtF;
+    case Instructions::lef:
+      return RegisterOp::LeF;
+    case Instructions::gef:
+      return RegisterOp::GeF;
+    case Instructions::testf:
+      return RegisterOp::TestF;
+    default:
+      assert(false);
+      return RegisterOp::Unreachable;
+  }
+}
+
+RegisterOp to_register_vop(uint8_t inst) {
+  switch (inst) {
+    case Instructions::addf:
+      return RegisterOp::AddV3;
+    case Instructions::subf:
+      return RegisterOp::SubV3;
+    case Instructions::mulf:
+      return RegisterOp::MulV3;
+    case Instructions::divf:
+      return RegisterOp::DivV3;
+    default:
+      return RegisterOp::Unreachable;
+  }
+}
+
+//  One instruction of the source bytecode, with its effect on the stack depth.
+struct DecodedInstruction {
+  RegisterOp op;
+  uint32_t begin;
+  uint32_t size;
+  uint32_t pop;
+  uint32_t push;
+  uint16_t frame_offset;
+  uint32_t imm;
+  uint32_t target;
+  bool has_target;
+  bool falls_through;
+  ForeignFunction* func;
+  RegisterReturn ret;
+};
+
+bool decode(const uint8_t* insts, size_t inst_size, uint32_t* ip, DecodedInstruction* out) {
+  DecodedInstruction res{};
+  res.begin = *ip;
+  res.falls_through = true;
+  auto inst = insts[(*ip)++];
+  switch (inst) {
+    case Instructions::load:
+    case Instructions::store: {
+      if (*ip + 2 * sizeof(uint16_t) > inst_size) {
+        return false;
+      }
+      res.frame_offset = readi<uint16_t>(insts, inst_size, ip);
+      res.imm = readi<uint16_t>(insts, inst_size, ip);
+      if (inst == Instructions::load) {
+        res.op = RegisterOp::Load;
+        res.push = res.imm;
+      } else {
+        res.op = RegisterOp::Store;
+        res.pop = res.imm;
+      }
+      break;
+    }
+    case Instructions::constantf: {
+      if (*ip + sizeof(float) > inst_size) {
+        return false;
+      }
+      res.op = RegisterOp::ConstantF;
+      res.imm = readi<uint32_t>(insts, inst_size, ip);
+      res.push = sizeof(float);
+      break;
+    }
+    case Instructions::addf:
+    case Instructions::subf:
+    case Instructions::mulf:
+    case Instructions::divf:
+    case Instructions::testf:
+    case Instructions::gtf:
+    case Instructions::ltf:
+    case Instructions::gef:
+    case Instructions::lef: {
+      res.op = to_register_op(inst);
+      res.pop = 2 * sizeof(float);
+      res.push = sizeof(float);
+      break;
+    }
+    case Instructions::vop: {
+      if (*ip + 2 > inst_size) {
+        return false;
+      }
+      const auto vec_len = readi<uint8_t>(insts, inst_size, ip);
+      res.op = to_register_vop(readi<uint8_t>(insts, inst_size, ip));
+      if (vec_len != 3 || res.op == RegisterOp::Unreachable) {
+        return false;
+      }
+      res.pop = 6 * sizeof(float);
+      res.push = 3 * sizeof(float);
+      break;
+    }
+    case Instructions::jump_if:
+    case Instructions::jump: {
+      if (*ip + sizeof(uint16_t) > inst_size) {
+        return false;
+      }
+      res.target = readi<uint16_t>(insts, inst_size, ip);
+      res.has_target = true;
+      if (inst == Instructions::jump_if) {
+        res.op = RegisterOp::JumpIf;
+        res.pop = sizeof(int32_t);
+      } else {
+        res.op = RegisterOp::Jump;
+        res.falls_through = false;
+      }
+      break;
+    }
+    case Instructions::call: {
+      if (*ip + sizeof(uint64_t) + 2 * sizeof(uint16_t) > inst_size) {
+        return false;
+      }
+      res.op = RegisterOp::Call;
+      res.func = (ForeignFunction*) readi<uint64_t>(insts, inst_size, ip);
+      res.pop = readi<uint16_t>(insts, inst_size, ip);
+      res.push = readi<uint16_t>(insts, inst_size, ip);
+      break;
+    }
+    case Instructions::ret: {
+      if (*ip + 1 + 4 * sizeof(uint32_t) > inst_size) {
+        return false;
+      }
+      auto& ret = res.ret;
+      ret.match = readi<uint8_t>(insts, inst_size, ip);
+      ret.succ_str_data_size = readi<uint32_t>(insts, inst_size, ip);
+      ret.succ_str_size = readi<uint32_t>(insts, inst_size, ip);
+      ret.res_str_data_size = readi<uint32_t>(insts, inst_size, ip);
+      ret.res_str_size = readi<uint32_t>(insts, inst_size, ip);
+      const size_t strs_size = size_t(ret.succ_str_size + ret.res_str_size) * sizeof(uint32_t);
+      if (*ip + strs_size > inst_size) {
+        return false;
+      }
+      ret.succ_str = insts + *ip;
+      ret.res_str = insts + *ip + sizeof(uint32_t) * ret.succ_str_size;
+      *ip += uint32_t(strs_size);
+      res.op = RegisterOp::Ret;
+      //  Not popped, but must be present.
+      res.imm = ret.succ_str_data_size + ret.res_str_data_size;
+      res.falls_through = false;
+      break;
+    }
+    default:
+      return false;
+  }
+  res.size = *ip - res.begin;
+  *out = res;
+  return true;
+}
+
 } //  anon
 
 uint32_t ls::ith_return_string_ti(const uint8_t* str, uint32_t i) {
@@ -256,4 +452,263 @@ InterpretResult ls::interpret(InterpretContext* context, const uint8_t* insts, s
   return result;
 }
 
+RegisterProgram ls::make_register_program(const uint8_t* insts, size_t inst_size,
+                                          size_t stack_size) {
+  //  Decode each instruction, and map the byte offset of each to its index.
+  std::vector<DecodedInstruction> decoded;
+  std::vector<uint32_t> index_of(inst_size + 1, ~0u);
+  uint32_t ip{};
+  while (ip < inst_size) {
+    index_of[ip] = uint32_t(decoded.size());
+    if (!decode(insts, inst_size, &ip, &decoded.emplace_back())) {
+      return {};
+    }
+  }
+  const auto end_index = uint32_t(decoded.size());
+  index_of[inst_size] = end_index;
+
+  for (auto& inst : decoded) {
+    if (inst.has_target) {
+      if (inst.target > inst_size || index_of[inst.target] == ~0u) {
+        return {};
+      }
+      inst.target = index_of[inst.target];
+    }
+  }
+
+  //  Propagate the stack depth along each path, requiring it to agree where paths join.
+  const uint32_t max_depth = uint32_t(std::min(stack_size, size_t(max_register_offset())));
+  std::vector<uint32_t> depths(decoded.size() + 1, ~0u);
+  std::vector<uint32_t> pending;
+  auto visit = [&](uint32_t i, uint32_t depth) {
+    if (depths[i] == ~0u) {
+      depths[i] = depth;
+      pending.push_back(i);
+      return true;
+    } else {
+      return depths[i] == depth;
+    }
+  };
+
+  visit(0, 0);
+  while (!pending.empty()) {
+    const uint32_t i = pending.back();
+    pending.pop_back();
+    if (i == end_index) {
+      continue;
+    }
+    auto& inst = decoded[i];
+    const uint32_t depth = depths[i];
+    const uint32_t required_depth = inst.op == RegisterOp::Ret ? inst.imm : inst.pop;
+    if (depth < required_depth) {
+      return {};
+    }
+    const uint32_t next_depth = depth - inst.pop + inst.push;
+    if (next_depth > max_depth) {
+      return {};
+    }
+    if (inst.falls_through && !visit(i + 1, next_depth)) {
+      return {};
+    }
+    if (inst.has_target && !visit(inst.target, next_depth)) {
+      return {};
+    }
+  }
+
+  RegisterProgram result{};
+  result.instructions.resize(decoded.size() + 1);
+  for (uint32_t i = 0; i < end_index; i++) {
+    auto& src = decoded[i];
+    auto& dst = result.instructions[i];
+    if (depths[i] == ~0u) {
+      dst.op = RegisterOp::Unreachable;
+      continue;
+    }
+
+    const auto depth = depths[i];
+    const auto args = uint16_t(depth - src.pop);
+    dst.op = src.op;
+    switch (src.op) {
+      case RegisterOp::Load:
+        dst.dst = uint16_t(depth);
+        dst.a = src.frame_offset;
+        dst.imm = src.imm;
+        result.frame_size = std::max(result.frame_size, src.frame_offset + src.imm);
+        break;
+      case RegisterOp::Store:
+        dst.dst = src.frame_offset;
+        dst.a = args;
+        dst.imm = src.imm;
+        result.frame_size = std::max(result.frame_size, src.frame_offset + src.imm);
+        break;
+      case RegisterOp::ConstantF:
+        dst.dst = uint16_t(depth);
+        dst.imm = src.imm;
+        break;
+      case RegisterOp::JumpIf:
+        dst.a = args;
+        dst.imm = src.target;
+        break;
+      case RegisterOp::Jump:
+        dst.imm = src.target;
+        break;
+      case RegisterOp::Call:
+        dst.dst = args;
+        dst.a = uint16_t(src.pop);
+        dst.b = uint16_t(src.push);
+        dst.imm = uint32_t(result.functions.size());
+        result.functions.push_back(src.func);
+        break;
+      case RegisterOp::Ret: {
+        auto ret = src.ret;
+        ret.succ_str_data_offset = depth - src.imm;
+        ret.res_str_data_offset = depth - ret.res_str_data_size;
+        dst.imm = uint32_t(result.returns.size());
+        result.returns.push_back(ret);
+        break;
+      }
+      default: {
+        //  Binary operators: operands are the top two values, the result replaces the first.
+        const auto operand_size = uint16_t(src.pop / 2);
+        dst.dst = args;
+        dst.a = args;
+        dst.b = uint16_t(args + operand_size);
+        break;
+      }
+    }
+    result.stack_size = std::max(result.stack_size, std::max(depth, depth - src.pop + src.push));
+  }
+  result.instructions[end_index].op = RegisterOp::End;
+  return result;
+}
+
+bool ls::find_called_functions(const uint8_t* insts, size_t inst_size,
+                               std::vector<ForeignFunction*>* out) {
+  uint32_t ip{};
+  while (ip < inst_size) {
+    DecodedInstruction inst;
+    if (!decode(insts, inst_size, &ip, &inst)) {
+      return false;
+    }
+    if (inst.op == RegisterOp::Call) {
+      out->push_back(inst.func);
+    }
+  }
+  return true;
+}
+
+InterpretResult ls::interpret(InterpretContext* context, const RegisterProgram& program) {
+  assert(!program.empty());
+  assert(program.frame_size <= context->frame_size && program.stack_size <= context->stack_size);
+  InterpretResult result{};
+  uint8_t* stack = context->stack;
+  uint8_t* frame = context->frame;
+  const RegisterInstruction* insts = program.instructions.data();
+  uint32_t ip{};
+  while (true) {
+    const RegisterInstruction& inst = insts[ip++];
+    uint8_t* dst = stack + inst.dst;
+    const uint8_t* a = stack + inst.a;
+    const uint8_t* b = stack + inst.b;
+    switch (inst.op) {
+      case RegisterOp::Load:
+        memcpy(dst, frame + inst.a, inst.imm);
+        break;
+      case RegisterOp::Store:
+        memcpy(frame + inst.dst, a, inst.imm);
+        break;
+      case RegisterOp::ConstantF:
+        memcpy(dst, &inst.imm, sizeof(float));
+        break;
+      case RegisterOp::AddF:
+        write_float(dst, read_float(a) + read_float(b));
+        break;
+      case RegisterOp::SubF:
+        write_float(dst, read_float(a) - read_float(b));
+        break;
+      case RegisterOp::MulF:
+        write_float(dst, read_float(a) * read_float(b));
+        break;
+      case RegisterOp::DivF:
+        write_float(dst, read_float(a) / read_float(b));
+        break;
+      case RegisterOp::AddV3:
+      case RegisterOp::SubV3:
+      case RegisterOp::MulV3:
+      case RegisterOp::DivV3: {
+        float r[3];
+        for (int i = 0; i < 3; i++) {
+          const float ai = read_float(a + i * sizeof(float));
+          const float bi = read_float(b + i * sizeof(float));
+          switch (inst.op) {
+            case RegisterOp::AddV3:
+              r[i] = ai + bi;
+              break;
+            case RegisterOp::SubV3:
+              r[i] = ai - bi;
+              break;
+            case RegisterOp::MulV3:
+              r[i] = ai * bi;
+              break;
+            default:
+              r[i] = ai / bi;
+              break;
+          }
+        }
+        memcpy(dst, r, sizeof(r));
+        break;
+      }
+      case RegisterOp::LtF:
+        write_int32(dst, int32_t(read_float(a) < read_float(b)));
+        break;
+      case RegisterOp::GtF:
+        write_int32(dst, int32_t(read_float(a) > read_float(b)));
+        break;
+      case RegisterOp::LeF:
+        write_int32(dst, int32_t(read_float(a) <= read_float(b)));
+        break;
+      case RegisterOp::GeF:
+        write_int32(dst, int32_t(read_float(a) >= read_float(b)));
+        break;
+      case RegisterOp::TestF:
+        write_int32(dst, int32_t(read_float(a) == read_float(b)));
+        break;
+      case RegisterOp::JumpIf: {
+        int32_t cond;
+        memcpy(&cond, a, sizeof(int32_t));
+        assert(cond == 1 || cond == 0);
+        if (!cond) {
+          ip = inst.imm;
+        }
+        break;
+      }
+      case RegisterOp::Jump:
+        ip = inst.imm;
+        break;
+      case RegisterOp::Call:
+        program.functions[inst.imm](inst.a, inst.b, dst);
+        break;
+      case RegisterOp::Ret: {
+        auto& ret = program.returns[inst.imm];
+        result.ok = true;
+        result.match = ret.match;
+        result.succ_str = ret.succ_str;
+        result.succ_str_size = ret.succ_str_size;
+        result.succ_str_data = stack + ret.succ_str_data_offset;
+        result.succ_str_data_size = ret.succ_str_data_size;
+        result.res_str = ret.res_str;
+        result.res_str_size = ret.res_str_size;
+        result.res_str_data = stack + ret.res_str_data_offset;
+        result.res_str_data_size = ret.res_str_data_size;
+        return result;
+      }
+      case RegisterOp::End:
+        return result;
+      case RegisterOp::Unreachable:
+        assert(false);
+        return result;
+    }
+  }
+}
+
 GROVE_NAMESPACE_END
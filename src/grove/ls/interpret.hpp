@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.hpp"
+#include <vector>
 
 namespace grove::ls {
 
@@ -33,4 +34,82 @@ InterpretContext make_interpret_context(uint8_t* frame,
                                         uint8_t* stack,
                                         size_t stack_size);
 
+/*
+ * RegisterProgram
+ *
+ * Instructions translated to a register form. The compiler fixes the stack depth at each
+ * instruction, so every stack operand resolves to a constant offset into the stack, and operands
+ * are decoded once rather than on each evaluation. Results are identical to those of interpreting
+ * the source instructions, and point into the same stack.
+ */
+
+enum class RegisterOp : uint8_t {
+  Load,
+  Store,
+  ConstantF,
+  AddF,
+  SubF,
+  MulF,
+  DivF,
+  AddV3,
+  SubV3,
+  MulV3,
+  DivV3,
+  LtF,
+  GtF,
+  LeF,
+  GeF,
+  TestF,
+  JumpIf,
+  Jump,
+  Call,
+  Ret,
+  End,
+  Unreachable
+};
+
+//  `dst`, `a` and `b` are byte offsets into the stack or frame; `imm` is a size, constant,
+//  instruction index, or index into the program's functions or returns.
+struct RegisterInstruction {
+  RegisterOp op;
+  uint16_t dst;
+  uint16_t a;
+  uint16_t b;
+  uint32_t imm;
+};
+
+struct RegisterReturn {
+  bool match;
+  const uint8_t* succ_str;
+  uint32_t succ_str_size;
+  uint32_t succ_str_data_offset;
+  uint32_t succ_str_data_size;
+  const uint8_t* res_str;
+  uint32_t res_str_size;
+  uint32_t res_str_data_offset;
+  uint32_t res_str_data_size;
+};
+
+struct RegisterProgram {
+  bool empty() const {
+    return instructions.empty();
+  }
+
+  std::vector<RegisterInstruction> instructions;
+  std::vector<RegisterReturn> returns;
+  std::vector<ForeignFunction*> functions;
+  uint32_t frame_size;
+  uint32_t stack_size;
+};
+
+//  Returns an empty program if the stack depth at some instruction depends on the path taken to
+//  reach it, or exceeds `stack_size`. Returned strings point into `inst`, which must outlive the
+//  program.
+RegisterProgram make_register_program(const uint8_t* inst, size_t inst_size, size_t stack_size);
+InterpretResult interpret(InterpretContext* context, const RegisterProgram& program);
+
+//  Appends the foreign functions called by `inst`. Returns false if `inst` cannot be decoded.
+bool find_called_functions(const uint8_t* inst, size_t inst_size,
+                           std::vector<ForeignFunction*>* out);
+
 }
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "grove/ls/ls.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace grove;
+using namespace grove::ls;
+
+namespace {
+
+/*
+ * `derive` copies forward the modules that no rule matches, including those that follow the last
+ * module a rule matched. `A` doubles each step; `B` has no rule.
+ */
+
+const char* grammar = R"(
+module A(x: float) end
+module B(x: float) end
+
+system S()
+  axiom { B(0), A(1), B(2), B(3) }
+
+  rule (a: A)
+    b := a
+    b.x = a.x + 1
+    return {a, b}
+  end
+end
+)";
+
+struct Pipeline {
+  StringRegistry string_registry;
+  TypeIDStore type_id_store;
+  ParseResult parse_result;
+  ResolveResult resolve_result;
+  CompileParams::ForeignFunctions foreign_functions;
+
+  std::vector<RuleParameter> rule_params;
+  std::vector<Span> rule_param_spans;
+  std::vector<uint8_t> rule_instructions;
+  std::vector<Span> rule_instruction_spans;
+  std::vector<uint32_t> rule_si;
+  uint32_t num_rules;
+
+  std::vector<uint8_t> frame;
+  std::vector<uint8_t> stack;
+  std::vector<uint32_t> axiom;
+  std::vector<uint8_t> axiom_data;
+};
+
+bool create_pipeline(const std::string& src, Pipeline& pipe) {
+  auto scan_res = scan(src.data(), int64_t(src.size()));
+  if (!scan_res.errors.empty()) {
+    return false;
+  }
+
+  ParseParams parse_params;
+  parse_params.source = src.data();
+  parse_params.str_registry = &pipe.string_registry;
+  pipe.parse_result = parse(
+    scan_res.tokens.data(), int64_t(scan_res.tokens.size()), &parse_params);
+  if (!pipe.parse_result.errors.empty() || pipe.parse_result.systems.empty()) {
+    return false;
+  }
+
+  auto& parse_res = pipe.parse_result;
+  auto res_params = to_resolve_params(parse_res, &pipe.string_registry, &pipe.type_id_store);
+  ResolveContext res_ctx{};
+  if (!init_resolve_context(&res_ctx, &res_params)) {
+    return false;
+  }
+  pipe.resolve_result = resolve(&res_ctx);
+  if (!pipe.resolve_result.errors.empty()) {
+    return false;
+  }
+
+  auto& res_res = pipe.resolve_result;
+  auto comp_params = to_compile_params(parse_res, res_res, &pipe.foreign_functions);
+  const uint32_t sysi = parse_res.systems[0];
+  auto& sys = parse_res.nodes[sysi].system;
+  for (uint32_t i = 0; i < sys.rule_size; i++) {
+    auto ri = parse_res.rules[sys.rule_begin + i];
+    auto rsi = res_res.scopes_by_node.at(ri);
+    pipe.rule_si.push_back(rsi);
+    auto& rule = parse_res.nodes[ri].rule;
+    auto comp_res = compile_rule(&comp_params, ri);
+
+    pipe.rule_instruction_spans.push_back(
+      Span{uint32_t(pipe.rule_instructions.size()), uint32_t(comp_res.instructions.size())});
+    pipe.rule_instructions.insert(
+      pipe.rule_instructions.end(), comp_res.instructions.begin(), comp_res.instructions.end());
+
+    Span param_span{uint32_t(pipe.rule_params.size()), rule.param_size};
+    pipe.rule_param_spans.push_back(param_span);
+    pipe.rule_params.resize(pipe.rule_params.size() + rule.param_size);
+    if (!get_rule_parameter_info(
+      rule, parse_res.nodes.data(), parse_res.parameters.data(), res_res.scopes.data(),
+      rsi, pipe.rule_params.data() + param_span.begin)) {
+      return false;
+    }
+  }
+  pipe.num_rules = sys.rule_size;
+
+  pipe.frame.resize(res_res.scope_range);
+  pipe.stack.resize(1024);
+
+  auto axiom_res = compile_axiom(&comp_params, parse_res.axioms[sys.axiom_begin]);
+  auto interp_ctx = make_interpret_context(
+    pipe.frame.data(), uint32_t(pipe.frame.size()), pipe.stack.data(), pipe.stack.size());
+  auto interp_res = interpret(
+    &interp_ctx, axiom_res.instructions.data(), axiom_res.instructions.size());
+  if (!interp_res.ok) {
+    return false;
+  }
+  pipe.axiom.resize(interp_res.succ_str_size);
+  memcpy(pipe.axiom.data(), interp_res.succ_str, interp_res.succ_str_size * sizeof(uint32_t));
+  pipe.axiom_data.assign(
+    interp_res.succ_str_data, interp_res.succ_str_data + interp_res.succ_str_data_size);
+  return true;
+}
+
+DeriveContext make_derive_context(Pipeline& pipe) {
+  auto& res_res = pipe.resolve_result;
+  DeriveContext ctx{};
+  ctx.scopes = res_res.scopes.data();
+  ctx.type_nodes = res_res.type_nodes.data();
+  ctx.storage = res_res.storage_locations.data();
+  ctx.num_rules = pipe.num_rules;
+  ctx.rule_params = pipe.rule_params.data();
+  ctx.rule_param_spans = pipe.rule_param_spans.data();
+  ctx.rule_instructions = pipe.rule_instructions.data();
+  ctx.rule_instruction_spans = pipe.rule_instruction_spans.data();
+  ctx.rule_si = pipe.rule_si.data();
+  ctx.frame = pipe.frame.data();
+  ctx.frame_size = uint32_t(pipe.frame.size());
+  ctx.stack = pipe.stack.data();
+  ctx.stack_size = uint32_t(pipe.stack.size());
+  ctx.branch_in_t = res_res.branch_in_t;
+  ctx.branch_out_t = res_res.branch_out_t;
+  return ctx;
+}
+
+DeriveResult derive_steps(DeriveContext* ctx, const Pipeline& pipe, int num_steps) {
+  DeriveScratch scratch;
+  DeriveResult results[2];
+  results[0].str = pipe.axiom;
+  results[0].str_data = pipe.axiom_data;
+  for (int i = 0; i < num_steps; i++) {
+    auto& src = results[i % 2];
+    DerivingString str{};
+    str.str = src.str.data();
+    str.str_size = uint32_t(src.str.size());
+    str.str_data = src.str_data.data();
+    str.str_data_size = uint32_t(src.str_data.size());
+    derive(ctx, &str, &scratch, &results[(i + 1) % 2]);
+  }
+  return std::move(results[num_steps % 2]);
+}
+
+//  After `num_steps`, B(0) followed by 2^num_steps A, with x = 1 + the number of set bits in the
+//  index of each, followed by B(2), B(3).
+bool is_expected(const DeriveResult& res, const Pipeline& pipe, int num_steps) {
+  const uint32_t b_t = pipe.axiom[0];
+  const uint32_t a_t = pipe.axiom[1];
+  const uint32_t num_a = 1u << uint32_t(num_steps);
+  if (res.str.size() != num_a + 3 || res.str_data.size() != (num_a + 3) * sizeof(float)) {
+    return false;
+  }
+
+  auto check = [&](uint32_t i, uint32_t t, float x) {
+    float v;
+    memcpy(&v, res.str_data.data() + i * sizeof(float), sizeof(float));
+    return res.str[i] == t && v == x;
+  };
+
+  bool ok = check(0, b_t, 0.0f);
+  for (uint32_t i = 0; i < num_a; i++) {
+    uint32_t num_bits{};
+    for (uint32_t j = i; j > 0; j >>= 1u) {
+      num_bits += j & 1u;
+    }
+    ok = ok && check(i + 1, a_t, 1.0f + float(num_bits));
+  }
+  return ok && check(num_a + 1, b_t, 2.0f) && check(num_a + 2, b_t, 3.0f);
+}
+
+} //  anon
+
+int main(int, char**) {
+  Pipeline pipe;
+  if (!create_pipeline(grammar, pipe)) {
+    std::cout << "failed to compile" << std::endl;
+    return 1;
+  }
+
+  auto ctx = make_derive_context(pipe);
+  bool success{true};
+  for (int num_steps : {1, 4}) {
+    const bool ok = is_expected(derive_steps(&ctx, pipe, num_steps), pipe, num_steps);
+    std::cout << "serial, " << num_steps << " steps: " << (ok ? "ok" : "failed") << std::endl;
+    success = success && ok;
+  }
+
+  //  Enough modules to be split into chunks; only the last chunk copies the trailing modules.
+  TaskPool pool;
+  pool.start(3);
+  ctx.task_pool = &pool;
+  const int num_steps = 12;
+  const bool ok = is_expected(derive_steps(&ctx, pipe, num_steps), pipe, num_steps);
+  std::cout << "parallel, " << num_steps << " steps: " << (ok ? "ok" : "failed") << std::endl;
+  success = success && ok;
+  ctx.task_pool = nullptr;
+  pool.stop();
+
+  return success ? 0 : 1;
+}
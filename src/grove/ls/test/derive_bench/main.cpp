@@ -0,0 +1,528 @@
+#include "grove/ls/ls.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace grove;
+using namespace grove::ls;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+/*
+ * Grammars
+ */
+
+//  As assets/lsystem/branch.txt.
+const char* branch_grammar = R"(
+module A(v: v3, ord: float, spooky: bool) end
+module I(v: float, p: v3, d: v3, l: float, ord: float) is internode end
+module C() end
+
+system S(
+  urand3: () -> v3,
+  urand: () -> float,
+  norm3: (v3) -> v3,
+  print: (float) -> void)
+
+  axiom { A(v3(0, 1, 0), 0, false) }
+
+  rule (a: A)
+    spooky := a.spooky
+
+    two := v3(2,2,2)
+    one := v3(1,1,1)
+    zero := v3(0,0,0)
+
+    len := 1
+    p := zero
+    i := I(1, p, v3(1, 2, 3), len, a.ord)
+
+    r := 0.3
+    up_pref := 1
+
+    if spooky
+      up_pref = 2 - a.ord
+    end
+
+    i.d = norm3(a.v + v3(r,r,r) * (urand3() * two - one) + v3(0, up_pref, 0))
+
+    i2 := i
+    r2 := 0.4
+    i2.d = norm3(i.d + (urand3() * two - one) * v3(r2,r2,r2))
+
+    i3 := i2
+    i3.d = norm3(i.d + (urand3() * two - one) * v3(r2,r2,r2))
+
+    la := a
+    lb := a
+    lc := a
+
+    la.ord = la.ord + 1
+    lb.ord = lb.ord + 1
+    lc.ord = lc.ord + 2
+
+    la.v = norm3((urand3() * two - one) * v3(1, 0.05, 1))
+    lb.v = norm3((urand3() * two - one) * v3(1, 0.05, 1))
+    lc.v = norm3((urand3() * two - one) * v3(1, 0.05, 1))
+
+    if spooky
+      return {i, [la, [lc]], [lb], i2, a}
+    else
+      return {i, [la], [lb], i2, a}
+    end
+  end
+
+  rule (i: I)
+    two := v3(2,2,2)
+    one := v3(1,1,1)
+
+    rscl := 0.5
+    if i.ord > 0
+      rscl = 0.5 * i.ord
+    end
+
+    i2 := i
+    r := 0.3 * rscl
+    i2.d = norm3(i2.d + (urand3() * two - one) * v3(r,r,r))
+
+    if true
+      i2.l = 0.5
+    end
+
+    return {i, i2}
+  end
+end
+)";
+
+//  Binary branching with arithmetic on the module parameters of each apex and segment.
+const char* fork_grammar = R"(
+module A(l: float, w: float, ord: float) end
+module F(l: float, w: float, d: v3) end
+
+system T(norm3: (v3) -> v3)
+  axiom { A(1, 1, 0) }
+
+  rule (a: A)
+    f := F(a.l, a.w, v3(0, 1, 0))
+    left := a
+    right := a
+    left.l = a.l * 0.8
+    left.w = a.w * 0.7
+    left.ord = a.ord + 1
+    right.l = a.l * 0.7
+    right.w = a.w * 0.6
+    right.ord = a.ord + 1
+    if a.ord > 2
+      f.d = norm3(v3(a.ord, 1, 0 - a.ord))
+    else
+      f.d = norm3(v3(1, a.ord, 1))
+    end
+    return {f, [left], right}
+  end
+
+  rule (f: F)
+    g := f
+    g.w = f.w * 1.02 + 0.001
+    if f.w > 1
+      g.l = f.l * 1.01
+    end
+    g.d = norm3(f.d + v3(0, 0.1, 0))
+    return {g}
+  end
+end
+)";
+
+struct Grammar {
+  const char* name;
+  const char* source;
+  int num_steps;
+};
+
+/*
+ * Foreign functions
+ *
+ * `urand` and `urand3` return fixed values so that results are independent of the order in which
+ * rules are evaluated, and can be compared across serial and parallel derivation. While
+ * `random_stream.enabled` is set, they instead draw from a counter-based stream, whose state is
+ * the counter.
+ */
+
+struct {
+  bool enabled;
+  uint64_t counter;
+} random_stream;
+
+float next_random() {
+  uint64_t x = 0x9e3779b97f4a7c15ull * ++random_stream.counter;
+  x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27u)) * 0x94d049bb133111ebull;
+  x ^= x >> 31u;
+  return float(x >> 40u) * (1.0f / float(1u << 24u));
+}
+
+void get_random_stream_state(uint8_t* dst) {
+  memcpy(dst, &random_stream.counter, sizeof(uint64_t));
+}
+
+void set_random_stream_state(const uint8_t* src) {
+  memcpy(&random_stream.counter, src, sizeof(uint64_t));
+}
+
+void bench_urand(uint32_t, uint32_t, uint8_t* data) {
+  const float res = random_stream.enabled ? next_random() : 0.25f;
+  memcpy(data, &res, sizeof(float));
+}
+
+void bench_urand3(uint32_t, uint32_t, uint8_t* data) {
+  float res[3]{0.25f, 0.5f, 0.75f};
+  if (random_stream.enabled) {
+    for (float& v : res) {
+      v = next_random();
+    }
+  }
+  memcpy(data, res, sizeof(res));
+}
+
+void bench_norm3(uint32_t, uint32_t, uint8_t* data) {
+  float v[3];
+  memcpy(v, data, sizeof(v));
+  const float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+  for (float& x : v) {
+    x /= len;
+  }
+  memcpy(data, v, sizeof(v));
+}
+
+void bench_print(uint32_t, uint32_t, uint8_t*) {
+  //
+}
+
+/*
+ * Pipeline
+ */
+
+struct Pipeline {
+  StringRegistry string_registry;
+  TypeIDStore type_id_store;
+  std::vector<ModuleDescriptor> module_meta_types;
+  std::vector<ModuleFieldDescriptor> module_meta_type_fields;
+  ParseResult parse_result;
+  ResolveResult resolve_result;
+  CompileParams::ForeignFunctions foreign_functions;
+
+  std::vector<RuleParameter> rule_params;
+  std::vector<Span> rule_param_spans;
+  std::vector<uint8_t> rule_instructions;
+  std::vector<Span> rule_instruction_spans;
+  std::vector<uint32_t> rule_si;
+  uint32_t num_rules;
+
+  std::vector<uint8_t> frame;
+  std::vector<uint8_t> stack;
+  std::vector<uint32_t> axiom;
+  std::vector<uint8_t> axiom_data;
+};
+
+void create_meta_types(Pipeline& pipe, uint32_t v3_t, uint32_t float_t) {
+  auto* str_reg = &pipe.string_registry;
+  auto& desc = pipe.module_meta_types.emplace_back();
+  desc.name = str_reg->emplace("internode");
+  desc.field_descriptors.begin = uint32_t(pipe.module_meta_type_fields.size());
+  pipe.module_meta_type_fields.push_back({str_reg->emplace("p"), v3_t});
+  pipe.module_meta_type_fields.push_back({str_reg->emplace("d"), v3_t});
+  pipe.module_meta_type_fields.push_back({str_reg->emplace("l"), float_t});
+  desc.field_descriptors.size = 3;
+}
+
+bool create_pipeline(const std::string& src, Pipeline& pipe) {
+  auto scan_res = scan(src.data(), int64_t(src.size()));
+  if (!scan_res.errors.empty()) {
+    return false;
+  }
+
+  ParseParams parse_params;
+  parse_params.source = src.data();
+  parse_params.str_registry = &pipe.string_registry;
+  pipe.parse_result = parse(
+    scan_res.tokens.data(), int64_t(scan_res.tokens.size()), &parse_params);
+  if (!pipe.parse_result.errors.empty() || pipe.parse_result.systems.empty()) {
+    return false;
+  }
+
+  auto& parse_res = pipe.parse_result;
+  auto res_params = to_resolve_params(parse_res, &pipe.string_registry, &pipe.type_id_store);
+  ResolveContext res_ctx{};
+  if (!init_resolve_context(&res_ctx, &res_params)) {
+    return false;
+  }
+  create_meta_types(pipe, res_ctx.v3_t, res_ctx.float_t);
+  res_params.module_meta_types = make_view(pipe.module_meta_types);
+  res_params.module_meta_type_fields = make_view(pipe.module_meta_type_fields);
+  pipe.resolve_result = resolve(&res_ctx);
+  if (!pipe.resolve_result.errors.empty()) {
+    return false;
+  }
+
+  auto& res_res = pipe.resolve_result;
+  for (auto& pend : res_res.pending_foreign_functions) {
+    const auto& name = pipe.string_registry.get(pend.identifier);
+    if (name == "urand") {
+      pipe.foreign_functions[pend] = bench_urand;
+    } else if (name == "urand3") {
+      pipe.foreign_functions[pend] = bench_urand3;
+    } else if (name == "norm3") {
+      pipe.foreign_functions[pend] = bench_norm3;
+    } else if (name == "print") {
+      pipe.foreign_functions[pend] = bench_print;
+    } else {
+      return false;
+    }
+  }
+
+  auto comp_params = to_compile_params(parse_res, res_res, &pipe.foreign_functions);
+  const uint32_t sysi = parse_res.systems[0];
+  auto& sys = parse_res.nodes[sysi].system;
+  for (uint32_t i = 0; i < sys.rule_size; i++) {
+    auto ri = parse_res.rules[sys.rule_begin + i];
+    auto rsi = res_res.scopes_by_node.at(ri);
+    pipe.rule_si.push_back(rsi);
+    auto& rule = parse_res.nodes[ri].rule;
+    auto comp_res = compile_rule(&comp_params, ri);
+
+    pipe.rule_instruction_spans.push_back(
+      Span{uint32_t(pipe.rule_instructions.size()), uint32_t(comp_res.instructions.size())});
+    pipe.rule_instructions.insert(
+      pipe.rule_instructions.end(), comp_res.instructions.begin(), comp_res.instructions.end());
+
+    Span param_span{uint32_t(pipe.rule_params.size()), rule.param_size};
+    pipe.rule_param_spans.push_back(param_span);
+    pipe.rule_params.resize(pipe.rule_params.size() + rule.param_size);
+    if (!get_rule_parameter_info(
+      rule, parse_res.nodes.data(), parse_res.parameters.data(), res_res.scopes.data(),
+      rsi, pipe.rule_params.data() + param_span.begin)) {
+      return false;
+    }
+  }
+  pipe.num_rules = sys.rule_size;
+
+  pipe.frame.resize(res_res.scope_range);
+  pipe.stack.resize(1024 * 2);
+
+  const Variable* var;
+  uint32_t var_si;
+  const auto sys_si = res_res.scopes_by_node.at(sysi);
+  if (lookup_variable(
+    res_res.scopes.data(), sys_si, pipe.string_registry.emplace("true"), &var, &var_si)) {
+    const int32_t true_dat = 1;
+    memcpy(pipe.frame.data() + res_res.storage_locations[var->storage].offset,
+           &true_dat, sizeof(int32_t));
+  }
+
+  auto axiom_res = compile_axiom(&comp_params, parse_res.axioms[sys.axiom_begin]);
+  auto interp_ctx = make_interpret_context(
+    pipe.frame.data(), uint32_t(pipe.frame.size()), pipe.stack.data(), pipe.stack.size());
+  auto interp_res = interpret(
+    &interp_ctx, axiom_res.instructions.data(), axiom_res.instructions.size());
+  if (!interp_res.ok) {
+    return false;
+  }
+  pipe.axiom.resize(interp_res.succ_str_size);
+  memcpy(pipe.axiom.data(), interp_res.succ_str, interp_res.succ_str_size * sizeof(uint32_t));
+  pipe.axiom_data.assign(
+    interp_res.succ_str_data, interp_res.succ_str_data + interp_res.succ_str_data_size);
+  return true;
+}
+
+DeriveContext make_derive_context(Pipeline& pipe) {
+  auto& res_res = pipe.resolve_result;
+  DeriveContext ctx{};
+  ctx.scopes = res_res.scopes.data();
+  ctx.type_nodes = res_res.type_nodes.data();
+  ctx.storage = res_res.storage_locations.data();
+  ctx.num_rules = pipe.num_rules;
+  ctx.rule_params = pipe.rule_params.data();
+  ctx.rule_param_spans = pipe.rule_param_spans.data();
+  ctx.rule_instructions = pipe.rule_instructions.data();
+  ctx.rule_instruction_spans = pipe.rule_instruction_spans.data();
+  ctx.rule_si = pipe.rule_si.data();
+  ctx.frame = pipe.frame.data();
+  ctx.frame_size = uint32_t(pipe.frame.size());
+  ctx.stack = pipe.stack.data();
+  ctx.stack_size = uint32_t(pipe.stack.size());
+  ctx.branch_in_t = res_res.branch_in_t;
+  ctx.branch_out_t = res_res.branch_out_t;
+  return ctx;
+}
+
+DerivingString to_deriving_string(const DeriveResult& res) {
+  DerivingString str{};
+  str.str = res.str.data();
+  str.str_size = uint32_t(res.str.size());
+  str.str_data = res.str_data.data();
+  str.str_data_size = uint32_t(res.str_data.size());
+  return str;
+}
+
+/*
+ * Runs
+ */
+
+struct RunResult {
+  DeriveResult result;
+  double elapsed_ms;
+};
+
+//  Allocates each step's result, as before `DeriveScratch`.
+RunResult run_allocating(DeriveContext* ctx, const Pipeline& pipe, int num_steps) {
+  RunResult res{};
+  res.result.str = pipe.axiom;
+  res.result.str_data = pipe.axiom_data;
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_steps; i++) {
+    auto str = to_deriving_string(res.result);
+    res.result = derive_branched(ctx, &str);
+  }
+  res.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return res;
+}
+
+RunResult run_reusing(DeriveContext* ctx, const Pipeline& pipe, int num_steps) {
+  DeriveScratch scratch;
+  DeriveResult results[2];
+  results[0].str = pipe.axiom;
+  results[0].str_data = pipe.axiom_data;
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_steps; i++) {
+    auto str = to_deriving_string(results[i % 2]);
+    derive_branched(ctx, &str, &scratch, &results[(i + 1) % 2]);
+  }
+  RunResult res{};
+  res.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  res.result = std::move(results[num_steps % 2]);
+  return res;
+}
+
+bool equal(const DeriveResult& a, const DeriveResult& b) {
+  return a.str == b.str && a.str_data == b.str_data;
+}
+
+bool run_grammar(const Grammar& grammar) {
+  Pipeline pipe;
+  if (!create_pipeline(grammar.source, pipe)) {
+    std::cout << grammar.name << ": failed to compile" << std::endl;
+    return false;
+  }
+
+  auto ctx = make_derive_context(pipe);
+  const auto programs = make_register_programs(&ctx);
+  int num_register_programs{};
+  for (auto& program : programs) {
+    num_register_programs += int(!program.empty());
+  }
+
+  const auto baseline = run_allocating(&ctx, pipe, grammar.num_steps);
+  std::cout << grammar.name << ": " << grammar.num_steps << " steps; "
+            << baseline.result.str.size() << " modules; "
+            << num_register_programs << " of " << programs.size() << " rules in register form"
+            << std::endl;
+  std::cout << "  allocating, stack interpreter: " << baseline.elapsed_ms << "ms" << std::endl;
+
+  bool all_equal{true};
+  auto report = [&](const char* desc, const RunResult& res) {
+    const bool same = equal(baseline.result, res.result);
+    all_equal = all_equal && same;
+    std::cout << "  " << desc << ": " << res.elapsed_ms << "ms"
+              << "; speedup: " << baseline.elapsed_ms / res.elapsed_ms << "x"
+              << "; matches: " << (same ? "yes" : "no") << std::endl;
+  };
+
+  report("reusing, stack interpreter", run_reusing(&ctx, pipe, grammar.num_steps));
+  ctx.rule_programs = programs.data();
+  report("reusing, register interpreter", run_reusing(&ctx, pipe, grammar.num_steps));
+
+  //  A warm memo stands in for re-deriving after a change to the system that leaves these rules
+  //  intact.
+  DeriveMemo memo;
+  memo.pure_functions = {bench_norm3};
+  prepare_derive_memo(&memo, &ctx);
+  ctx.memo = &memo;
+  report("memoized, cold", run_reusing(&ctx, pipe, grammar.num_steps));
+  const auto num_cold_hits = memo.num_hits;
+  const auto num_cold_misses = memo.num_misses;
+  report("memoized, warm", run_reusing(&ctx, pipe, grammar.num_steps));
+  std::cout << "  memo; cold: " << num_cold_hits << " hits, " << num_cold_misses << " misses"
+            << "; warm: " << memo.num_hits - num_cold_hits << " hits, "
+            << memo.num_misses - num_cold_misses << " misses" << std::endl;
+  ctx.memo = nullptr;
+
+  {
+    //  With `memoize_random_rules` set, rules that call `urand` are memoized on the state of the
+    //  random stream, and hit when deriving again from the same seed.
+    random_stream.enabled = true;
+    random_stream.counter = 0;
+    const auto random_baseline = run_reusing(&ctx, pipe, grammar.num_steps);
+    const uint64_t final_counter = random_stream.counter;
+
+    DeriveMemo random_memo;
+    random_memo.pure_functions = {bench_norm3};
+    random_memo.random_functions = {bench_urand, bench_urand3};
+    random_memo.random_state_size = uint32_t(sizeof(uint64_t));
+    random_memo.get_random_state = get_random_stream_state;
+    random_memo.set_random_state = set_random_stream_state;
+    random_memo.memoize_random_rules = true;
+    prepare_derive_memo(&random_memo, &ctx);
+    ctx.memo = &random_memo;
+    for (const char* desc : {"random, memoized, cold", "random, memoized, warm"}) {
+      const auto num_hits = random_memo.num_hits;
+      const auto num_misses = random_memo.num_misses;
+      random_stream.counter = 0;
+      const auto res = run_reusing(&ctx, pipe, grammar.num_steps);
+      const bool same = equal(random_baseline.result, res.result) &&
+                        random_stream.counter == final_counter;
+      all_equal = all_equal && same;
+      std::cout << "  " << desc << ": " << res.elapsed_ms << "ms"
+                << "; unmemoized: " << random_baseline.elapsed_ms << "ms; "
+                << random_memo.num_hits - num_hits << " hits, "
+                << random_memo.num_misses - num_misses << " misses"
+                << "; matches: " << (same ? "yes" : "no") << std::endl;
+    }
+    ctx.memo = nullptr;
+    random_stream.enabled = false;
+  }
+
+  const int max_num_threads = std::max(1, int(std::thread::hardware_concurrency()));
+  for (int num_threads = 2; num_threads <= max_num_threads; num_threads *= 2) {
+    TaskPool pool;
+    pool.start(num_threads - 1);
+    ctx.task_pool = &pool;
+    ctx.memo = &memo;
+    auto desc = std::to_string(num_threads) + " threads, register interpreter, warm memo";
+    report(desc.c_str(), run_reusing(&ctx, pipe, grammar.num_steps));
+    ctx.task_pool = nullptr;
+    ctx.memo = nullptr;
+  }
+
+  return all_equal;
+}
+
+} //  anon
+
+int main(int, char**) {
+  const Grammar grammars[] = {
+    {"branch", branch_grammar, 11},
+    {"fork", fork_grammar, 17},
+  };
+
+  bool success{true};
+  for (auto& grammar : grammars) {
+    success = run_grammar(grammar) && success;
+  }
+  return success ? 0 : 1;
+}
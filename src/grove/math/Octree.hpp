@@ -69,6 +69,9 @@ public:
   Octree(float initial_span_size, float max_span_size_split);
   void insert(Data&& data);
   void intersects(const Data& data, std::vector<const Data*>& hit) const;
+  //  Indices of active elements in leaves overlapping `bounds`, in ascending order. Candidates for
+  //  `intersects` before the per-element test, for callers that test them in batches.
+  void gather_candidates(const Bounds3f& bounds, std::vector<uint32_t>& element_indices) const;
   void deactivate(const Data& data);
   template <typename F>
   size_t deactivate_if(F&& func);
@@ -79,12 +82,24 @@ public:
   size_t num_elements() const {
     return elements.size();
   }
+  const Data& element(uint32_t index) const {
+    return elements[index];
+  }
+  void deactivate_element(uint32_t index);
   void num_contents_per_node(uint32_t* out) const;
-  size_t num_inactive() const;
+  size_t num_inactive() const {
+    return num_inactive_elements;
+  }
+  //  While enabled, the indices of elements deactivated by `deactivate`, `deactivate_if` or
+  //  `deactivate_element` are logged, so that a copy of the tree built incrementally can follow
+  //  deactivations made after elements were copied.
+  void set_record_deactivations(bool record);
+  void swap_recorded_deactivations(std::vector<uint32_t>& dst);
   static Octree rebuild_active(Octree&& src, float initial_span_size, float max_span_size_split);
 
 private:
   uint32_t require_root(const Bounds3f& bounds);
+  void on_deactivate(Data& element, uint32_t index);
 
   template <typename F, typename Oct>
   static void map_elements(F&& func, Oct&& oct, const Bounds3f& bounds);
@@ -95,6 +110,9 @@ private:
   std::vector<Node> nodes;
   uint32_t root{};
   std::vector<Data> elements;
+  size_t num_inactive_elements{};
+  std::vector<uint32_t> recorded_deactivations;
+  bool record_deactivations{};
   bool odd_expand{true};
 };
 
@@ -174,6 +192,7 @@ void Octree<Data, Traits>::insert(Data&& data) {
   std::vector<uint32_t> node_indices{require_root(data_bounds)};
 
   const auto data_ind = uint32_t(elements.size());
+  num_inactive_elements += size_t(!Traits::active(data));
   elements.push_back(std::move(data));
 
   bool did_insert{};
@@ -228,14 +247,23 @@ void Octree<Data, Traits>::insert(Data&& data) {
   assert(did_insert);
 }
 
+template <typename Data, typename Traits>
+void Octree<Data, Traits>::on_deactivate(Data& element, uint32_t index) {
+  num_inactive_elements += size_t(Traits::active(element));
+  Traits::deactivate(element);
+  if (record_deactivations) {
+    recorded_deactivations.push_back(index);
+  }
+}
+
 template <typename Data, typename Traits>
 template <typename F>
 size_t Octree<Data, Traits>::deactivate_if(F&& func) {
   size_t ct{};
-  for (Data& element : elements) {
-    const Data* el = &element;
+  for (uint32_t i = 0; i < uint32_t(elements.size()); i++) {
+    const Data* el = &elements[i];
     if (func(el)) {
-      Traits::deactivate(element);
+      on_deactivate(elements[i], i);
       ct++;
     }
   }
@@ -244,9 +272,9 @@ size_t Octree<Data, Traits>::deactivate_if(F&& func) {
 
 template <typename Data, typename Traits>
 void Octree<Data, Traits>::deactivate(const Data& data) {
-  auto f = [&data](Data& el, uint32_t) -> bool {
+  auto f = [this, &data](Data& el, uint32_t ci) -> bool {
     if (Traits::equal(el, data)) {
-      Traits::deactivate(el);
+      on_deactivate(el, ci);
       return false;
     }
     return true;
@@ -254,6 +282,26 @@ void Octree<Data, Traits>::deactivate(const Data& data) {
   map_elements(std::move(f), *this, Traits::get_aabb(data));
 };
 
+template <typename Data, typename Traits>
+void Octree<Data, Traits>::deactivate_element(uint32_t index) {
+  assert(index < elements.size());
+  on_deactivate(elements[index], index);
+}
+
+template <typename Data, typename Traits>
+void Octree<Data, Traits>::set_record_deactivations(bool record) {
+  record_deactivations = record;
+  if (!record) {
+    recorded_deactivations.clear();
+  }
+}
+
+template <typename Data, typename Traits>
+void Octree<Data, Traits>::swap_recorded_deactivations(std::vector<uint32_t>& dst) {
+  dst.clear();
+  std::swap(dst, recorded_deactivations);
+}
+
 #if 1
 template <typename Data, typename Traits>
 void Octree<Data, Traits>::intersects(const Data& data, std::vector<const Data*>& hit) const {
@@ -315,6 +363,23 @@ void Octree<Data, Traits>::intersects(const Data& data, std::vector<const Data*>
 }
 #endif
 
+template <typename Data, typename Traits>
+void Octree<Data, Traits>::gather_candidates(const Bounds3f& bounds,
+                                             std::vector<uint32_t>& element_indices) const {
+  element_indices.clear();
+  auto f = [&element_indices](const Data& el, uint32_t ci) -> bool {
+    if (Traits::active(el)) {
+      element_indices.push_back(ci);
+    }
+    return true;
+  };
+  map_elements(std::move(f), *this, bounds);
+
+  std::sort(element_indices.begin(), element_indices.end());
+  auto end = std::unique(element_indices.begin(), element_indices.end());
+  element_indices.erase(end, element_indices.end());
+}
+
 template <typename Data, typename Traits>
 void Octree<Data, Traits>::validate() const {
   std::vector<uint32_t> node_indices{root};
@@ -360,17 +425,6 @@ void Octree<Data, Traits>::num_contents_per_node(uint32_t* out) const {
   }
 }
 
-template <typename Data, typename Traits>
-size_t Octree<Data, Traits>::num_inactive() const {
-  size_t sum{};
-  for (auto& el : elements) {
-    if (!Traits::active(el)) {
-      sum++;
-    }
-  }
-  return sum;
-}
-
 template <typename Data, typename Traits>
 Octree<Data, Traits> Octree<Data, Traits>::rebuild_active(Octree<Data, Traits>&& src,
                                                           float initial_span_size,
@@ -0,0 +1,419 @@
+#include "bvh.hpp"
+#include "intersect.hpp"
+#include "simd.hpp"
+#include "grove/common/common.hpp"
+#include "grove/common/Temporary.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+using namespace bvh;
+
+struct Config {
+  static constexpr int num_bins = 16;
+  static constexpr uint32_t max_num_leaf_triangles = 4;
+  static constexpr uint32_t max_num_forced_leaf_triangles = 32;
+  static constexpr float traversal_cost = 1.0f;
+  static constexpr int stack_size = 64;
+  //  Far slab distances are scaled up slightly so that rounding in the slab test does not cull
+  //  triangles lying in the plane of a box face.
+  static constexpr float far_t_scale = 1.0f + 4.0f * std::numeric_limits<float>::epsilon();
+};
+
+struct Box {
+  Vec3f p0{std::numeric_limits<float>::infinity()};
+  Vec3f p1{-std::numeric_limits<float>::infinity()};
+};
+
+struct BuildTask {
+  uint32_t begin;
+  uint32_t end;
+  uint32_t parent;
+  int depth;
+  bool is_right;
+};
+
+struct Split {
+  int axis;
+  int bin;
+  float cost;
+};
+
+void extend(Box& box, const Vec3f& p) {
+  box.p0 = min(box.p0, p);
+  box.p1 = max(box.p1, p);
+}
+
+void extend(Box& box, const Box& other) {
+  box.p0 = min(box.p0, other.p0);
+  box.p1 = max(box.p1, other.p1);
+}
+
+float half_area(const Box& box) {
+  auto s = box.p1 - box.p0;
+  return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+int bin_index(float c, float lo, float scale) {
+  return std::min(int((c - lo) * scale), Config::num_bins - 1);
+}
+
+Split find_split(const Box* boxes, const Vec3f* centroids, const uint32_t* indices,
+                 uint32_t begin, uint32_t end, const Box& centroid_box) {
+  Split best{-1, 0, std::numeric_limits<float>::infinity()};
+  for (int axis = 0; axis < 3; axis++) {
+    const float lo = centroid_box.p0[axis];
+    const float extent = centroid_box.p1[axis] - lo;
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+
+    Box bins[Config::num_bins];
+    uint32_t counts[Config::num_bins]{};
+    const float scale = float(Config::num_bins) / extent;
+    for (uint32_t i = begin; i < end; i++) {
+      const uint32_t ti = indices[i];
+      const int b = bin_index(centroids[ti][axis], lo, scale);
+      extend(bins[b], boxes[ti]);
+      counts[b]++;
+    }
+
+    float right_areas[Config::num_bins]{};
+    uint32_t right_counts[Config::num_bins]{};
+    Box acc;
+    uint32_t count{};
+    for (int b = Config::num_bins - 1; b > 0; b--) {
+      extend(acc, bins[b]);
+      count += counts[b];
+      right_areas[b] = count > 0 ? half_area(acc) : 0.0f;
+      right_counts[b] = count;
+    }
+
+    acc = {};
+    count = 0;
+    for (int b = 0; b < Config::num_bins - 1; b++) {
+      extend(acc, bins[b]);
+      count += counts[b];
+      if (count == 0 || right_counts[b + 1] == 0) {
+        continue;
+      }
+      const float cost = half_area(acc) * float(count) +
+                         right_areas[b + 1] * float(right_counts[b + 1]);
+      if (cost < best.cost) {
+        best = Split{axis, b + 1, cost};
+      }
+    }
+  }
+  return best;
+}
+
+float safe_inverse(float d) {
+  constexpr float eps = 1e-20f;
+  return 1.0f / (std::abs(d) > eps ? d : std::copysign(eps, d));
+}
+
+Vec3f safe_inverse(const Vec3f& d) {
+  return Vec3f{safe_inverse(d.x), safe_inverse(d.y), safe_inverse(d.z)};
+}
+
+bool ray_box_intersect(const TriangleBVHNode& node, const Vec3f& ro, const Vec3f& inv_rd,
+                       float max_t) {
+  float t0 = 0.0f;
+  float t1 = max_t;
+  for (int i = 0; i < 3; i++) {
+    float near_t = (node.p0[i] - ro[i]) * inv_rd[i];
+    float far_t = (node.p1[i] - ro[i]) * inv_rd[i];
+    if (near_t > far_t) {
+      std::swap(near_t, far_t);
+    }
+    t0 = std::max(t0, near_t);
+    t1 = std::min(t1, far_t * Config::far_t_scale);
+    if (t0 > t1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool is_closer_hit(float t, uint32_t ti, float best_t, uint32_t best_ti) {
+  return t < best_t || (t == best_t && ti < best_ti);
+}
+
+template <typename Index>
+void intersect_leaf(const TriangleBVH& bvh, const TriangleBVHNode& node, const Index* tris,
+                    const Vec3f* ps, const Ray& ray, uint32_t* best_ti, float* best_t) {
+  const uint32_t stride = bvh.vertex_stride;
+  for (uint32_t i = 0; i < node.num_triangles; i++) {
+    const uint32_t ti = bvh.triangles[node.index + i];
+    const Index* tri = tris + ti * 3;
+    const Vec3f& p0 = ps[tri[0] * stride];
+    const Vec3f& p1 = ps[tri[1] * stride];
+    const Vec3f& p2 = ps[tri[2] * stride];
+    float t;
+    if (ray_triangle_intersect(ray.origin, ray.direction, p0, p1, p2, &t) &&
+        is_closer_hit(t, ti, *best_t, *best_ti)) {
+      *best_t = t;
+      *best_ti = ti;
+    }
+  }
+}
+
+template <typename Index>
+void intersect_packet(const TriangleBVH& bvh, const Index* tris, const Vec3f* ps,
+                      const Ray* rays, int num_rays, RayHit* hits) {
+  assert(num_rays > 0 && num_rays <= 4);
+  alignas(16) float ox[4];
+  alignas(16) float oy[4];
+  alignas(16) float oz[4];
+  alignas(16) float ix[4];
+  alignas(16) float iy[4];
+  alignas(16) float iz[4];
+  alignas(16) float best_t[4];
+  uint32_t best_ti[4];
+  for (int i = 0; i < 4; i++) {
+    auto& ray = rays[std::min(i, num_rays - 1)];
+    const auto inv_rd = safe_inverse(ray.direction);
+    ox[i] = ray.origin.x;
+    oy[i] = ray.origin.y;
+    oz[i] = ray.origin.z;
+    ix[i] = inv_rd.x;
+    iy[i] = inv_rd.y;
+    iz[i] = inv_rd.z;
+    //  Unused lanes never pass the box test.
+    best_t[i] = i < num_rays ? std::numeric_limits<float>::infinity() : -1.0f;
+    best_ti[i] = no_hit();
+  }
+
+  const auto vox = simd::load(ox);
+  const auto voy = simd::load(oy);
+  const auto voz = simd::load(oz);
+  const auto vix = simd::load(ix);
+  const auto viy = simd::load(iy);
+  const auto viz = simd::load(iz);
+  const auto far_scale = simd::set1(Config::far_t_scale);
+  auto vbest_t = simd::load(best_t);
+
+  Temporary<uint32_t, Config::stack_size> store_stack;
+  uint32_t* stack = store_stack.require(bvh.max_depth + 2);
+  int stack_size{};
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const uint32_t ni = stack[--stack_size];
+    auto& node = bvh.nodes[ni];
+    const auto tx0 = (simd::set1(node.p0.x) - vox) * vix;
+    const auto tx1 = (simd::set1(node.p1.x) - vox) * vix;
+    const auto ty0 = (simd::set1(node.p0.y) - voy) * viy;
+    const auto ty1 = (simd::set1(node.p1.y) - voy) * viy;
+    const auto tz0 = (simd::set1(node.p0.z) - voz) * viz;
+    const auto tz1 = (simd::set1(node.p1.z) - voz) * viz;
+    const auto t0 = simd::max(
+      simd::max(simd::min(tx0, tx1), simd::min(ty0, ty1)),
+      simd::max(simd::min(tz0, tz1), simd::zero()));
+    const auto t1 = simd::min(
+      simd::min(simd::max(tx0, tx1), simd::max(ty0, ty1)) * far_scale,
+      simd::min(simd::max(tz0, tz1) * far_scale, vbest_t));
+    const int mask = simd::move_mask(simd::le(t0, t1));
+    if (mask == 0) {
+      continue;
+    }
+
+    if (node.is_leaf()) {
+      for (int i = 0; i < 4; i++) {
+        if (mask & (1 << i)) {
+          intersect_leaf(bvh, node, tris, ps, rays[i], best_ti + i, best_t + i);
+        }
+      }
+      vbest_t = simd::load(best_t);
+    } else {
+      int first_lane{};
+      while (!(mask & (1 << first_lane))) {
+        first_lane++;
+      }
+      uint32_t near_ni = ni + 1;
+      uint32_t far_ni = node.index;
+      if (rays[first_lane].direction[node.axis] < 0.0f) {
+        std::swap(near_ni, far_ni);
+      }
+      stack[stack_size++] = far_ni;
+      stack[stack_size++] = near_ni;
+    }
+  }
+
+  for (int i = 0; i < num_rays; i++) {
+    hits[i] = RayHit{best_ti[i], best_ti[i] == no_hit() ? 0.0f : best_t[i]};
+  }
+}
+
+template <typename Index>
+TriangleBVH build_bvh(const Index* tris, uint32_t num_tris, const Vec3f* ps,
+                      uint32_t vertex_stride) {
+  TriangleBVH result;
+  result.vertex_stride = vertex_stride;
+  if (num_tris == 0) {
+    return result;
+  }
+
+  std::vector<Box> boxes(num_tris);
+  std::vector<Vec3f> centroids(num_tris);
+  result.triangles.resize(num_tris);
+  for (uint32_t ti = 0; ti < num_tris; ti++) {
+    auto& box = boxes[ti];
+    for (int i = 0; i < 3; i++) {
+      extend(box, ps[tris[ti * 3 + i] * vertex_stride]);
+    }
+    centroids[ti] = (box.p0 + box.p1) * 0.5f;
+    result.triangles[ti] = ti;
+  }
+
+  auto* indices = result.triangles.data();
+  result.nodes.reserve(2 * (num_tris / Config::max_num_leaf_triangles) + 1);
+
+  std::vector<BuildTask> tasks;
+  tasks.push_back(BuildTask{0, num_tris, no_hit(), 0, false});
+  while (!tasks.empty()) {
+    const auto task = tasks.back();
+    tasks.pop_back();
+
+    const auto ni = uint32_t(result.nodes.size());
+    result.nodes.emplace_back();
+    if (task.is_right) {
+      result.nodes[task.parent].index = ni;
+    }
+    result.max_depth = std::max(result.max_depth, task.depth);
+
+    Box box;
+    Box centroid_box;
+    for (uint32_t i = task.begin; i < task.end; i++) {
+      extend(box, boxes[indices[i]]);
+      extend(centroid_box, centroids[indices[i]]);
+    }
+
+    const uint32_t count = task.end - task.begin;
+    uint32_t mid = task.begin;
+    int axis{};
+    if (count > Config::max_num_leaf_triangles) {
+      const auto split = find_split(
+        boxes.data(), centroids.data(), indices, task.begin, task.end, centroid_box);
+      const float leaf_cost = float(count) * half_area(box);
+      const float split_cost = Config::traversal_cost * half_area(box) + split.cost;
+      const bool force_split = count > Config::max_num_forced_leaf_triangles;
+      if (split.axis >= 0 && (split_cost < leaf_cost || force_split)) {
+        const float lo = centroid_box.p0[split.axis];
+        const float scale = float(Config::num_bins) / (centroid_box.p1[split.axis] - lo);
+        auto* mid_it = std::partition(
+          indices + task.begin, indices + task.end, [&](uint32_t ti) {
+            return bin_index(centroids[ti][split.axis], lo, scale) < split.bin;
+          });
+        mid = uint32_t(mid_it - indices);
+        axis = split.axis;
+      } else if (split.axis < 0 && force_split) {
+        //  Coincident centroids.
+        mid = task.begin + count / 2;
+        axis = max_dimension(box.p1 - box.p0);
+      }
+    }
+
+    auto& node = result.nodes[ni];
+    node.p0 = box.p0;
+    node.p1 = box.p1;
+    if (mid == task.begin || mid == task.end) {
+      node.index = task.begin;
+      node.num_triangles = uint16_t(count);
+    } else {
+      node.num_triangles = 0;
+      node.axis = uint16_t(axis);
+      tasks.push_back(BuildTask{mid, task.end, ni, task.depth + 1, true});
+      tasks.push_back(BuildTask{task.begin, mid, ni, task.depth + 1, false});
+    }
+  }
+
+  return result;
+}
+
+template <typename Index>
+bool intersect_ray(const TriangleBVH& bvh, const Index* tris, const Vec3f* ps,
+                   const Ray& ray, uint32_t* hit_ti, float* hit_t) {
+  if (bvh.empty()) {
+    return false;
+  }
+
+  const auto inv_rd = safe_inverse(ray.direction);
+  uint32_t best_ti = no_hit();
+  float best_t = std::numeric_limits<float>::infinity();
+
+  Temporary<uint32_t, Config::stack_size> store_stack;
+  uint32_t* stack = store_stack.require(bvh.max_depth + 2);
+  int stack_size{};
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const uint32_t ni = stack[--stack_size];
+    auto& node = bvh.nodes[ni];
+    if (!ray_box_intersect(node, ray.origin, inv_rd, best_t)) {
+      continue;
+    }
+    if (node.is_leaf()) {
+      intersect_leaf(bvh, node, tris, ps, ray, &best_ti, &best_t);
+    } else {
+      uint32_t near_ni = ni + 1;
+      uint32_t far_ni = node.index;
+      if (ray.direction[node.axis] < 0.0f) {
+        std::swap(near_ni, far_ni);
+      }
+      stack[stack_size++] = far_ni;
+      stack[stack_size++] = near_ni;
+    }
+  }
+
+  if (best_ti != no_hit()) {
+    *hit_ti = best_ti;
+    *hit_t = best_t;
+    return true;
+  } else {
+    return false;
+  }
+}
+
+} //  anon
+
+bvh::TriangleBVH bvh::build_triangle_bvh(const uint32_t* tris, uint32_t num_tris,
+                                         const Vec3f* ps, uint32_t vertex_stride) {
+  return build_bvh(tris, num_tris, ps, vertex_stride);
+}
+
+bvh::TriangleBVH bvh::build_triangle_bvh(const uint16_t* tris, uint32_t num_tris,
+                                         const Vec3f* ps, uint32_t vertex_stride) {
+  return build_bvh(tris, num_tris, ps, vertex_stride);
+}
+
+bool bvh::ray_intersect(const TriangleBVH& bvh, const uint32_t* tris, const Vec3f* ps,
+                        const Ray& ray, uint32_t* hit_ti, float* hit_t) {
+  return intersect_ray(bvh, tris, ps, ray, hit_ti, hit_t);
+}
+
+bool bvh::ray_intersect(const TriangleBVH& bvh, const uint16_t* tris, const Vec3f* ps,
+                        const Ray& ray, uint32_t* hit_ti, float* hit_t) {
+  return intersect_ray(bvh, tris, ps, ray, hit_ti, hit_t);
+}
+
+void bvh::ray_intersect(const TriangleBVH& bvh, const uint32_t* tris, const Vec3f* ps,
+                        const Ray* rays, uint32_t num_rays, RayHit* hits) {
+  if (bvh.empty()) {
+    for (uint32_t i = 0; i < num_rays; i++) {
+      hits[i] = RayHit{no_hit(), 0.0f};
+    }
+    return;
+  }
+  for (uint32_t i = 0; i < num_rays; i += 4) {
+    const int num_packet = int(std::min(4u, num_rays - i));
+    intersect_packet(bvh, tris, ps, rays + i, num_packet, hits + i);
+  }
+}
+
+GROVE_NAMESPACE_END
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Vec3.hpp"
+#include "Ray.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace grove::bvh {
+
+/*
+ * TriangleBVH
+ *
+ * Bounding volume hierarchy over an indexed triangle soup, split with a binned surface area
+ * heuristic. Nodes are stored depth-first: the left child of an interior node directly follows
+ * it and `index` is the right child. A leaf references `num_triangles` consecutive entries of
+ * `triangles`, starting at `index`, which are indices of source triangles.
+ *
+ * Queries take the same `tris` and `ps` arrays the hierarchy was built from. Consecutive positions
+ * are `vertex_stride` elements of `ps` apart, e.g. 2 for interleaved positions and normals.
+ */
+
+struct TriangleBVHNode {
+  bool is_leaf() const {
+    return num_triangles > 0;
+  }
+
+  Vec3f p0;
+  uint32_t index;
+  Vec3f p1;
+  uint16_t num_triangles;
+  uint16_t axis;
+};
+
+struct TriangleBVH {
+  bool empty() const {
+    return nodes.empty();
+  }
+
+  std::vector<TriangleBVHNode> nodes;
+  std::vector<uint32_t> triangles;
+  int max_depth{};
+  uint32_t vertex_stride{1};
+};
+
+struct RayHit {
+  uint32_t ti;
+  float t;
+};
+
+constexpr uint32_t no_hit() {
+  return ~0u;
+}
+
+TriangleBVH build_triangle_bvh(const uint32_t* tris, uint32_t num_tris, const Vec3f* ps,
+                               uint32_t vertex_stride = 1);
+TriangleBVH build_triangle_bvh(const uint16_t* tris, uint32_t num_tris, const Vec3f* ps,
+                               uint32_t vertex_stride = 1);
+
+//  Nearest intersection with `t > 0`, matching a linear `ray_triangle_intersect` over all
+//  triangles: ties resolve to the lowest triangle index.
+bool ray_intersect(const TriangleBVH& bvh, const uint32_t* tris, const Vec3f* ps,
+                   const Ray& ray, uint32_t* hit_ti, float* hit_t);
+bool ray_intersect(const TriangleBVH& bvh, const uint16_t* tris, const Vec3f* ps,
+                   const Ray& ray, uint32_t* hit_ti, float* hit_t);
+
+//  Traces `rays` in packets of 4, testing each node's bounds against all rays of a packet at
+//  once. `hits[i].ti` is `no_hit()` if ray `i` misses.
+void ray_intersect(const TriangleBVH& bvh, const uint32_t* tris, const Vec3f* ps,
+                   const Ray* rays, uint32_t num_rays, RayHit* hits);
+
+}
@@ -10,7 +10,9 @@
 #ifdef GROVE_MACOS
 #pragma clang diagnostic pop
 #endif
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -18,6 +20,16 @@ namespace {
 
 using namespace cdt;
 
+struct Config {
+  static constexpr uint32_t hilbert_order = 16;
+  static constexpr uint32_t max_num_brio_rounds = 24;
+};
+
+struct CavityEdge {
+  uint64_t key;
+  uint32_t ti;
+};
+
 template <typename T>
 T ccw(T index) {
   assert(index >= 0 && index < 3);
@@ -30,6 +42,14 @@ T cw(T index) {
   return index == T(0) ? T(2) : index - T(1);
 }
 
+[[maybe_unused]] bool has_duplicate(const Point* points, uint32_t num_points) {
+  std::vector<Point> sorted(points, points + num_points);
+  std::sort(sorted.begin(), sorted.end(), [](const Point& a, const Point& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  return std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end();
+}
+
 [[maybe_unused]] bool is_duplicate(const std::vector<Point>& points, const Point& p) {
   for (auto& point : points) {
     if (point == p) {
@@ -46,6 +66,10 @@ Edge make_edge(uint32_t ai, uint32_t bi) {
   return Edge{ai, bi};
 }
 
+uint64_t edge_key(uint32_t ai, uint32_t bi) {
+  return (uint64_t(ai) << 32u) | uint64_t(bi);
+}
+
 int find_point_index(const Triangle& tri, uint32_t pi) {
   for (int i = 0; i < 3; i++) {
     if (tri.i[i] == pi) {
@@ -55,6 +79,19 @@ int find_point_index(const Triangle& tri, uint32_t pi) {
   return -1;
 }
 
+//  Index `k` of the edge from vertex `k` to vertex `ccw(k)` that joins `ai` and `bi`, in either
+//  order.
+int find_edge_index(const Triangle& tri, uint32_t ai, uint32_t bi) {
+  for (int k = 0; k < 3; k++) {
+    const uint32_t i0 = tri.i[k];
+    const uint32_t i1 = tri.i[ccw(k)];
+    if ((i0 == ai && i1 == bi) || (i0 == bi && i1 == ai)) {
+      return k;
+    }
+  }
+  return -1;
+}
+
 bool has_point_index(const Triangle& tri, uint32_t pi) {
   return tri.i[0] == pi || tri.i[1] == pi || tri.i[2] == pi;
 }
@@ -67,6 +104,11 @@ bool is_on_edge(TriPtLoc loc) {
   return loc == TriPtLoc::Edge0 || loc == TriPtLoc::Edge1 || loc == TriPtLoc::Edge2;
 }
 
+int edge_index(TriPtLoc loc) {
+  assert(is_on_edge(loc));
+  return loc == TriPtLoc::Edge0 ? 0 : loc == TriPtLoc::Edge1 ? 1 : 2;
+}
+
 bool is_ccw(const Point& a, const Point& b, const Point& c) {
   return det3_implicit(a, b, c) > 0;
 }
@@ -96,10 +138,21 @@ uint32_t num_points(const Triangulation& tri) {
   return uint32_t(tri.points.size());
 }
 
-uint32_t add_triangle(Triangulation& tri, const Triangle& t) {
+void set_triangle(Triangulation& tri, uint32_t ti, const Triangle& t) {
   assert(is_ccw(tri, t.i[0], t.i[1], t.i[2]));
+  tri.triangles[ti] = t;
+  for (uint32_t vi : t.i) {
+    tri.vertex_triangles[vi] = ti;
+  }
+}
+
+uint32_t add_triangle(Triangulation& tri, const Triangle& t) {
   auto ti = uint32_t(tri.triangles.size());
-  tri.triangles.push_back(t);
+  tri.triangles.emplace_back();
+  for (int i = 0; i < 3; i++) {
+    tri.adjacency.push_back(invalid_index());
+  }
+  set_triangle(tri, ti, t);
   return ti;
 }
 
@@ -110,9 +163,28 @@ uint32_t add_point(Triangulation& tri, const Point& p) {
   assert(std::isfinite(p.x) && std::isfinite(p.y));
   auto pi = num_points(tri);
   tri.points.push_back(p);
+  tri.vertex_triangles.push_back(invalid_index());
   return pi;
 }
 
+uint32_t adjacent_triangle(const Triangulation& tri, uint32_t ti, uint32_t ai, uint32_t bi) {
+  int k = find_edge_index(tri.triangles[ti], ai, bi);
+  assert(k >= 0);
+  return tri.adjacency[ti * 3 + k];
+}
+
+//  Marks `ti` and `adj_ti` as adjacent across the edge joining `ai` and `bi`.
+void set_adjacent(Triangulation& tri, uint32_t ti, uint32_t ai, uint32_t bi, uint32_t adj_ti) {
+  int k = find_edge_index(tri.triangles[ti], ai, bi);
+  assert(k >= 0);
+  tri.adjacency[ti * 3 + k] = adj_ti;
+  if (adj_ti != invalid_index()) {
+    int adj_k = find_edge_index(tri.triangles[adj_ti], ai, bi);
+    assert(adj_k >= 0);
+    tri.adjacency[adj_ti * 3 + adj_k] = ti;
+  }
+}
+
 bool is_fixed_edge(const Triangulation& tri, const Edge& e) {
   return tri.fixed_edges.count(e) > 0;
 }
@@ -147,22 +219,42 @@ bool has_edge(const Triangle& t, const Edge& edge) {
   return has_ai && has_bi;
 }
 
-bool has_edge(const Triangulation& tri, const Edge& e) {
-  for (auto& t : tri.triangles) {
-    if (has_edge(t, e)) {
+//  Calls `f(ti)` for each triangle incident to point `pi`, until `f` returns true.
+template <typename F>
+bool visit_vertex_triangles(const Triangulation& tri, uint32_t pi, F&& f) {
+  const uint32_t start_ti = tri.vertex_triangles[pi];
+  assert(start_ti != invalid_index());
+  uint32_t ti = start_ti;
+  do {
+    if (f(ti)) {
       return true;
     }
+    int k = find_point_index(tri.triangles[ti], pi);
+    assert(k >= 0);
+    ti = tri.adjacency[ti * 3 + cw(k)];
+  } while (ti != start_ti && ti != invalid_index());
+
+  if (ti == invalid_index()) {
+    //  The fan around `pi` is open; visit the remaining triangles in the other direction.
+    ti = start_ti;
+    while (true) {
+      int k = find_point_index(tri.triangles[ti], pi);
+      assert(k >= 0);
+      ti = tri.adjacency[ti * 3 + k];
+      if (ti == invalid_index()) {
+        break;
+      } else if (f(ti)) {
+        return true;
+      }
+    }
   }
   return false;
 }
 
-uint32_t edge_neighbor(const Triangle* tris, uint32_t num_tris, uint32_t t, const Edge& e) {
-  for (uint32_t ti = 0; ti < num_tris; ti++) {
-    if (ti != t && has_edge(tris[ti], e)) {
-      return ti;
-    }
-  }
-  return invalid_index();
+bool has_edge(const Triangulation& tri, const Edge& e) {
+  return visit_vertex_triangles(tri, e.ai, [&](uint32_t ti) {
+    return has_point_index(tri.triangles[ti], e.bi);
+  });
 }
 
 uint32_t setdiff_edge(const Triangle& t, const Edge& edge) {
@@ -175,95 +267,135 @@ uint32_t setdiff_edge(const Triangle& t, const Edge& edge) {
   return invalid_index();
 }
 
-Edge setdiff_point(const Triangle& t, uint32_t pi) {
-  for (uint32_t i = 0; i < 3; i++) {
-    auto i0 = i;
-    auto i1 = ccw(i);
-    if (t.i[i0] != pi && t.i[i1] != pi) {
-      return make_edge(t.i[i0], t.i[i1]);
-    }
-  }
-  assert(false);
-  return {};
-}
-
-bool is_edge(const Edge* edges, uint32_t num_edges, const Edge& edge) {
-  for (uint32_t i = 0; i < num_edges; i++) {
-    if (Edge::EqualOrderIndependent{}(edges[i], edge)) {
-      return true;
-    }
-  }
-  return false;
+std::tuple<uint32_t, Edge> opposed_triangle(const Triangulation& tri, uint32_t ti, uint32_t pi) {
+  auto& t = tri.triangles[ti];
+  int k = find_point_index(t, pi);
+  assert(k >= 0);
+  const uint32_t ek = ccw(uint32_t(k));
+  auto shared_edge = make_edge(t.i[ek], t.i[ccw(ek)]);
+  return std::make_tuple(tri.adjacency[ti * 3 + ek], shared_edge);
 }
 
-uint32_t adjacent_triangle(const Triangle* tris, uint32_t num_tris, uint32_t ti, const Edge& edge) {
-  for (uint32_t i = 0; i < num_tris; i++) {
-    if (i != ti && has_edge(tris[i], edge)) {
-      return i;
+uint32_t locate_point_linear(const Triangulation& tri, const Point& p, TriPtLoc* loc) {
+  for (uint32_t ti = 0; ti < num_triangles(tri); ti++) {
+    auto [p0, p1, p2] = read_vertices(tri.points.data(), tri.triangles[ti]);
+    auto query_loc = triangle_point_location(*p0, *p1, *p2, p);
+    if (query_loc != TriPtLoc::Outside) {
+      *loc = query_loc;
+      return ti;
     }
   }
+  *loc = TriPtLoc::Outside;
   return invalid_index();
 }
 
-std::tuple<uint32_t, Edge> opposed_triangle(const Triangle* tris, uint32_t num_tris,
-                                            uint32_t ti, uint32_t pi) {
-  auto shared_edge = setdiff_point(tris[ti], pi);
-  auto adj_ti = adjacent_triangle(tris, num_tris, ti, shared_edge);
-  if (adj_ti == invalid_index()) {
-    return std::make_tuple(invalid_index(), Edge{});
-  } else {
-    return std::make_tuple(adj_ti, shared_edge);
+//  Samples about cbrt(n) triangles and returns the one whose first vertex is closest to `p`.
+uint32_t jump(const Triangulation& tri, const Point& p, uint32_t hint_ti) {
+  const uint32_t num_tris = num_triangles(tri);
+  uint32_t best_ti = hint_ti;
+  double best_dist = std::numeric_limits<double>::infinity();
+  if (hint_ti != invalid_index()) {
+    best_dist = (tri.points[tri.triangles[hint_ti].i[0]] - p).length_squared();
   }
+  const auto num_samples = std::max(1u, uint32_t(std::cbrt(double(num_tris))));
+  for (uint32_t s = 0; s < num_samples; s++) {
+    auto ti = uint32_t((uint64_t(s) * num_tris) / num_samples);
+    auto dist = (tri.points[tri.triangles[ti].i[0]] - p).length_squared();
+    if (dist < best_dist) {
+      best_dist = dist;
+      best_ti = ti;
+    }
+  }
+  return best_ti;
 }
 
-std::tuple<uint32_t, uint32_t, Edge>
-triangles_containing_point(const Triangulation& tri, const Point& p) {
-  for (uint32_t ti = 0; ti < num_triangles(tri); ti++) {
-    auto [p0, p1, p2] = read_vertices(tri.points.data(), tri.triangles[ti]);
-    auto query_loc = triangle_point_location(*p0, *p1, *p2, p);
-    if (is_on_edge(query_loc)) {
-      auto shared_edge = edge_indices(tri.triangles[ti], query_loc);
-      const uint32_t neighbor_ti = edge_neighbor(
-        tri.triangles.data(), uint32_t(tri.triangles.size()), ti, shared_edge);
-      assert(neighbor_ti != invalid_index() && neighbor_ti != ti);
-      return std::make_tuple(ti, neighbor_ti, shared_edge);
-    } else if (query_loc == TriPtLoc::Inside) {
-      return std::make_tuple(ti, invalid_index(), Edge{});
+//  Stochastic visibility walk: cross any edge separating the current triangle from `p`, trying
+//  edges in a pseudo-random order so that the walk terminates in constrained triangulations too.
+uint32_t walk(const Triangulation& tri, uint32_t ti, const Point& p, TriPtLoc* loc) {
+  const uint64_t max_num_steps = 4 * uint64_t(num_triangles(tri)) + 16;
+  uint32_t prev_ti = invalid_index();
+  uint32_t rand_state = ti * 2654435761u + 1u;
+  for (uint64_t step = 0; step < max_num_steps; step++) {
+    auto& t = tri.triangles[ti];
+    rand_state = rand_state * 1664525u + 1013904223u;
+    const uint32_t k0 = (rand_state >> 16u) % 3u;
+    int exit_k = -1;
+    for (uint32_t j = 0; j < 3; j++) {
+      const uint32_t k = (k0 + j) % 3u;
+      const uint32_t adj_ti = tri.adjacency[ti * 3 + k];
+      if (adj_ti != prev_ti &&
+          hyperplane_side(tri.points[t.i[k]], tri.points[t.i[ccw(k)]], p) < 0) {
+        exit_k = int(k);
+        break;
+      }
+    }
+    if (exit_k < 0) {
+      auto [p0, p1, p2] = read_vertices(tri.points.data(), t);
+      *loc = triangle_point_location(*p0, *p1, *p2, p);
+      assert(*loc != TriPtLoc::Outside);
+      return ti;
+    }
+    prev_ti = ti;
+    ti = tri.adjacency[ti * 3 + exit_k];
+    if (ti == invalid_index()) {
+      *loc = TriPtLoc::Outside;
+      return invalid_index();
     }
   }
-  assert(false && "No triangle found.");
-  return {};
+  assert(false && "Walk did not terminate.");
+  return locate_point_linear(tri, p, loc);
 }
 
 void add_point_in_triangle(Triangulation& tri, uint32_t ti, uint32_t pi, uint32_t* new_ti) {
-  auto& t = tri.triangles[ti];
+  const auto t = tri.triangles[ti];
   uint32_t ai = t.i[0];
   uint32_t bi = t.i[1];
   uint32_t ci = t.i[2];
+  const uint32_t adj_ab = tri.adjacency[ti * 3 + 0];
+  const uint32_t adj_bc = tri.adjacency[ti * 3 + 1];
+  const uint32_t adj_ca = tri.adjacency[ti * 3 + 2];
   auto t0 = make_triangle(ai, pi, ci);
   auto t1 = make_triangle(pi, bi, ci);
   auto t2 = make_triangle(ai, bi, pi);
-  t = t0;
+  set_triangle(tri, ti, t0);
   new_ti[0] = ti;
   new_ti[1] = add_triangle(tri, t1);
   new_ti[2] = add_triangle(tri, t2);
+  set_adjacent(tri, new_ti[0], ci, ai, adj_ca);
+  set_adjacent(tri, new_ti[1], bi, ci, adj_bc);
+  set_adjacent(tri, new_ti[2], ai, bi, adj_ab);
+  set_adjacent(tri, new_ti[0], ai, pi, new_ti[2]);
+  set_adjacent(tri, new_ti[0], pi, ci, new_ti[1]);
+  set_adjacent(tri, new_ti[1], pi, bi, new_ti[2]);
 }
 
 void add_point_on_edge(Triangulation& tri, uint32_t ti0, uint32_t ti1,
                        uint32_t pi, const Edge& shared_edge, uint32_t* new_ti) {
-  auto& t0 = tri.triangles[ti0];
-  auto& t1 = tri.triangles[ti1];
+  const auto t0 = tri.triangles[ti0];
+  const auto t1 = tri.triangles[ti1];
   assert(has_edge(t0, shared_edge) && has_edge(t1, shared_edge) && ti0 != ti1);
   uint32_t ai = setdiff_edge(t0, shared_edge);
   uint32_t bi = shared_edge.ai;
   uint32_t ci = setdiff_edge(t1, shared_edge);
   uint32_t di = shared_edge.bi;
+  const uint32_t adj_ab = adjacent_triangle(tri, ti0, ai, bi);
+  const uint32_t adj_da = adjacent_triangle(tri, ti0, di, ai);
+  const uint32_t adj_bc = adjacent_triangle(tri, ti1, bi, ci);
+  const uint32_t adj_cd = adjacent_triangle(tri, ti1, ci, di);
   new_ti[0] = ti0;
   new_ti[1] = ti1;
-  t0 = require_ccw(tri, ai, bi, pi);
-  t1 = require_ccw(tri, pi, di, ai);
+  set_triangle(tri, ti0, require_ccw(tri, ai, bi, pi));
+  set_triangle(tri, ti1, require_ccw(tri, pi, di, ai));
   new_ti[2] = add_triangle(tri, require_ccw(tri, bi, ci, pi));
   new_ti[3] = add_triangle(tri, require_ccw(tri, ci, di, pi));
+  set_adjacent(tri, new_ti[0], ai, bi, adj_ab);
+  set_adjacent(tri, new_ti[1], di, ai, adj_da);
+  set_adjacent(tri, new_ti[2], bi, ci, adj_bc);
+  set_adjacent(tri, new_ti[3], ci, di, adj_cd);
+  set_adjacent(tri, new_ti[0], bi, pi, new_ti[2]);
+  set_adjacent(tri, new_ti[0], pi, ai, new_ti[1]);
+  set_adjacent(tri, new_ti[1], pi, di, new_ti[3]);
+  set_adjacent(tri, new_ti[2], ci, pi, new_ti[3]);
 }
 
 bool is_in_circumcircle(const Point& v0, const Point& v1, const Point& v2, const Point& p) {
@@ -272,43 +404,141 @@ bool is_in_circumcircle(const Point& v0, const Point& v1, const Point& v2, const
 }
 
 void edge_swap(Triangulation& tri, uint32_t ti, uint32_t ti_op, const Edge& edge, uint32_t pi) {
-  auto& t = tri.triangles[ti];
-  auto& t_op = tri.triangles[ti_op];
   uint32_t ai = edge.ai;
   uint32_t bi = edge.bi;
-  uint32_t ci = setdiff_edge(t_op, edge);
-  t = require_ccw(tri, pi, bi, ci);
-  t_op = require_ccw(tri, ai, pi, ci);
+  uint32_t ci = setdiff_edge(tri.triangles[ti_op], edge);
+  const uint32_t adj_pa = adjacent_triangle(tri, ti, pi, ai);
+  const uint32_t adj_bp = adjacent_triangle(tri, ti, bi, pi);
+  const uint32_t adj_bc = adjacent_triangle(tri, ti_op, bi, ci);
+  const uint32_t adj_ca = adjacent_triangle(tri, ti_op, ci, ai);
+  set_triangle(tri, ti, require_ccw(tri, pi, bi, ci));
+  set_triangle(tri, ti_op, require_ccw(tri, ai, pi, ci));
+  set_adjacent(tri, ti, bi, pi, adj_bp);
+  set_adjacent(tri, ti, bi, ci, adj_bc);
+  set_adjacent(tri, ti_op, pi, ai, adj_pa);
+  set_adjacent(tri, ti_op, ci, ai, adj_ca);
+  set_adjacent(tri, ti, pi, ci, ti_op);
 }
 
-std::vector<uint32_t> divide_triangle(Triangulation& tri, const Point& point, uint32_t pi) {
-  auto [ti0, ti1, neighbor_edge] = triangles_containing_point(tri, point);
-  std::vector<uint32_t> ti_stack;
+//  Inserts the stored point `pi` and restores the Delaunay property around it. Returns a triangle
+//  incident to `pi`.
+uint32_t insert_point(Triangulation& tri, uint32_t pi, uint32_t hint_ti,
+                      std::vector<uint32_t>& ti_stack) {
+  const Point point = tri.points[pi];
+  TriPtLoc loc{};
+  const uint32_t ti0 = locate_point(tri, point, &loc, hint_ti);
+  assert(ti0 != invalid_index() && loc != TriPtLoc::Outside);
+
   uint32_t new_tris[4];
   uint32_t num_add;
-  if (ti1 == invalid_index()) {
+  if (loc == TriPtLoc::Inside) {
     add_point_in_triangle(tri, ti0, pi, new_tris);
     num_add = 3;
   } else {
-    add_point_on_edge(tri, ti0, ti1, pi, neighbor_edge, new_tris);
+    auto shared_edge = edge_indices(tri.triangles[ti0], loc);
+    const uint32_t ti1 = tri.adjacency[ti0 * 3 + edge_index(loc)];
+    assert(ti1 != invalid_index() && ti1 != ti0);
+    add_point_on_edge(tri, ti0, ti1, pi, shared_edge, new_tris);
     num_add = 4;
   }
+
+  ti_stack.clear();
   for (uint32_t i = 0; i < num_add; i++) {
     ti_stack.push_back(new_tris[i]);
   }
-  return ti_stack;
+  while (!ti_stack.empty()) {
+    uint32_t ti = ti_stack.back();
+    ti_stack.pop_back();
+    auto [ti_op, shared_edge] = opposed_triangle(tri, ti, pi);
+    if (ti_op == invalid_index()) {
+      continue;
+    }
+    if (!is_fixed_edge(tri, shared_edge)) {
+      auto [p0, p1, p2] = read_vertices(tri.points.data(), tri.triangles[ti_op]);
+      if (is_in_circumcircle(*p0, *p1, *p2, point)) {
+        edge_swap(tri, ti, ti_op, shared_edge, pi);
+        ti_stack.push_back(ti);
+        ti_stack.push_back(ti_op);
+      }
+    }
+  }
+  return tri.vertex_triangles[pi];
+}
+
+uint32_t hilbert_index(uint32_t x, uint32_t y) {
+  constexpr uint32_t n = 1u << Config::hilbert_order;
+  uint32_t d{};
+  for (uint32_t s = n >> 1u; s > 0; s >>= 1u) {
+    const uint32_t rx = (x & s) > 0;
+    const uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+//  Geometrically distributed round index, so that each round holds about twice as many points as
+//  the one before it.
+uint32_t brio_round(uint32_t i) {
+  uint32_t h = i * 0x9e3779b9u;
+  h ^= h >> 16u;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13u;
+  uint32_t round{};
+  while (round < Config::max_num_brio_rounds && (h & 1u)) {
+    h >>= 1u;
+    round++;
+  }
+  return round;
+}
+
+//  Order in which to insert `points`: rounds of increasing size, each sorted along a Hilbert
+//  curve, so that consecutive points are close and each walk is short.
+std::vector<uint32_t> brio_order(const Point* points, uint32_t num_points) {
+  Point p0{std::numeric_limits<double>::infinity()};
+  Point p1{-std::numeric_limits<double>::infinity()};
+  for (uint32_t i = 0; i < num_points; i++) {
+    p0 = min(p0, points[i]);
+    p1 = max(p1, points[i]);
+  }
+  const double grid_size = double((1u << Config::hilbert_order) - 1);
+  const Point span = p1 - p0;
+  const Point scale{
+    span.x > 0.0 ? grid_size / span.x : 0.0,
+    span.y > 0.0 ? grid_size / span.y : 0.0};
+
+  std::vector<uint64_t> keys(num_points);
+  for (uint32_t i = 0; i < num_points; i++) {
+    const Point g = (points[i] - p0) * scale;
+    const auto hilbert = hilbert_index(uint32_t(g.x), uint32_t(g.y));
+    const auto round = Config::max_num_brio_rounds - brio_round(i);
+    keys[i] = (uint64_t(round) << 32u) | hilbert;
+  }
+  std::vector<uint32_t> order(num_points);
+  for (uint32_t i = 0; i < num_points; i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) {
+    return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+  });
+  return order;
 }
 
 std::tuple<uint32_t, uint32_t, uint32_t>
 triangle_cutting_edge(const Triangulation& tri, const Edge& edge) {
   auto& ea = tri.points[edge.ai];
   auto& eb = tri.points[edge.bi];
-  for (uint32_t ti = 0; ti < num_triangles(tri); ti++) {
+  auto result = std::make_tuple(invalid_index(), invalid_index(), invalid_index());
+  [[maybe_unused]] bool found = visit_vertex_triangles(tri, edge.ai, [&](uint32_t ti) {
     auto& t = tri.triangles[ti];
     int eai = find_point_index(t, edge.ai);
-    if (eai == -1) {
-      continue;
-    }
+    assert(eai >= 0);
     uint32_t ivu = t.i[cw(eai)];
     uint32_t ivl = t.i[ccw(eai)];
     auto& v0 = tri.points[ivu];
@@ -322,7 +552,8 @@ triangle_cutting_edge(const Triangulation& tri, const Edge& edge) {
         //          v0
         //  line a ----- b
         //          v1
-        return std::make_tuple(ti, ivu, ivl);
+        result = std::make_tuple(ti, ivu, ivl);
+        return true;
       }
       if (cw_side == 0) {
         //  b
@@ -333,16 +564,19 @@ triangle_cutting_edge(const Triangulation& tri, const Edge& edge) {
         //  | /
         //  |/
         //  a
-        return std::make_tuple(invalid_index(), ivu, ivl);
+        result = std::make_tuple(invalid_index(), ivu, ivl);
+        return true;
       }
     }
-  }
-  assert(false);
-  return std::make_tuple(invalid_index(), invalid_index(), invalid_index());
+    return false;
+  });
+  assert(found);
+  return result;
 }
 
-void triangulate_pseudo_polygon(Triangulation& tri, const uint32_t* pi_beg, const uint32_t* pi_end,
-                                uint32_t ai, uint32_t bi) {
+void triangulate_pseudo_polygon(const Triangulation& tri, const uint32_t* pi_beg,
+                                const uint32_t* pi_end, uint32_t ai, uint32_t bi,
+                                std::vector<Triangle>& out) {
   assert(pi_end >= pi_beg && ai != bi);
   const auto pi_sz = uint32_t(pi_end - pi_beg);
   if (pi_sz == 0) {
@@ -362,9 +596,67 @@ void triangulate_pseudo_polygon(Triangulation& tri, const uint32_t* pi_beg, cons
   const uint32_t* pe_end = pi_beg + ci_ind;
   const uint32_t* pd_beg = pi_beg + ci_ind + 1;
   const uint32_t* pd_end = pi_end;
-  triangulate_pseudo_polygon(tri, pe_beg, pe_end, ai, ci);
-  triangulate_pseudo_polygon(tri, pd_beg, pd_end, ci, bi);
-  add_triangle(tri, require_ccw(tri, ai, bi, ci));
+  triangulate_pseudo_polygon(tri, pe_beg, pe_end, ai, ci, out);
+  triangulate_pseudo_polygon(tri, pd_beg, pd_end, ci, bi, out);
+  out.push_back(require_ccw(tri, ai, bi, ci));
+}
+
+bool cavity_edge_less(const CavityEdge& a, const CavityEdge& b) {
+  return a.key < b.key;
+}
+
+const CavityEdge* find_cavity_edge(const std::vector<CavityEdge>& edges, uint64_t key) {
+  auto it = std::lower_bound(
+    edges.begin(), edges.end(), CavityEdge{key, 0}, cavity_edge_less);
+  return it != edges.end() && it->key == key ? &*it : nullptr;
+}
+
+//  Replaces the triangles `slots` of a cavity with `new_tris`, which triangulate the same region,
+//  and links them to each other and to the triangles around the cavity.
+void replace_cavity(Triangulation& tri, std::vector<uint32_t>& slots,
+                    const std::vector<Triangle>& new_tris) {
+  assert(slots.size() == new_tris.size());
+  std::sort(slots.begin(), slots.end());
+
+  std::vector<CavityEdge> boundary;
+  for (uint32_t ti : slots) {
+    auto& t = tri.triangles[ti];
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t adj_ti = tri.adjacency[ti * 3 + k];
+      if (adj_ti == invalid_index() ||
+          !std::binary_search(slots.begin(), slots.end(), adj_ti)) {
+        boundary.push_back(CavityEdge{edge_key(t.i[k], t.i[ccw(k)]), adj_ti});
+      }
+    }
+  }
+  std::sort(boundary.begin(), boundary.end(), cavity_edge_less);
+
+  std::vector<CavityEdge> interior;
+  for (uint32_t i = 0; i < uint32_t(slots.size()); i++) {
+    auto& t = new_tris[i];
+    set_triangle(tri, slots[i], t);
+    for (uint32_t k = 0; k < 3; k++) {
+      interior.push_back(CavityEdge{edge_key(t.i[k], t.i[ccw(k)]), slots[i]});
+    }
+  }
+  std::sort(interior.begin(), interior.end(), cavity_edge_less);
+
+  for (uint32_t ti : slots) {
+    auto& t = tri.triangles[ti];
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t ai = t.i[k];
+      const uint32_t bi = t.i[ccw(k)];
+      //  Triangles on either side of an edge traverse it in opposite directions, whereas the
+      //  cavity boundary keeps its direction.
+      if (auto* outer = find_cavity_edge(boundary, edge_key(ai, bi))) {
+        set_adjacent(tri, ti, ai, bi, outer->ti);
+      } else if (auto* inner = find_cavity_edge(interior, edge_key(bi, ai))) {
+        tri.adjacency[ti * 3 + k] = inner->ti;
+      } else {
+        assert(false);
+      }
+    }
+  }
 }
 
 void plus_edge_indices(Edge* e, uint32_t n) {
@@ -430,8 +722,7 @@ void add_edge(Triangulation& tri, Edge edge, std::vector<Edge>& edges) {
       break;
     }
 
-    auto [topi, shared_edge] = opposed_triangle(
-      tri.triangles.data(), num_triangles(tri), ti, vi);
+    auto [topi, shared_edge] = opposed_triangle(tri, ti, vi);
     assert(topi != invalid_index());
     intersected_ti.push_back(topi);
 
@@ -454,13 +745,10 @@ void add_edge(Triangulation& tri, Edge edge, std::vector<Edge>& edges) {
     ti = topi;
   }
 
-  std::sort(intersected_ti.begin(), intersected_ti.end(), std::greater<uint32_t>{});
-  for (uint32_t rem_ti : intersected_ti) {
-    tri.triangles.erase(tri.triangles.begin() + rem_ti);
-  }
-
-  triangulate_pseudo_polygon(tri, pu.data(), pu.data() + pu.size(), ai, target_bi);
-  triangulate_pseudo_polygon(tri, pl.data(), pl.data() + pl.size(), ai, target_bi);
+  std::vector<Triangle> new_tris;
+  triangulate_pseudo_polygon(tri, pu.data(), pu.data() + pu.size(), ai, target_bi, new_tris);
+  triangulate_pseudo_polygon(tri, pl.data(), pl.data() + pl.size(), ai, target_bi, new_tris);
+  replace_cavity(tri, intersected_ti, new_tris);
 
   if (target_bi != bi) {
     assert(false);  //  @TODO
@@ -509,6 +797,18 @@ int cdt::hyperplane_side(const Point& a, const Point& b, const Point& qp) {
   }
 }
 
+uint32_t cdt::locate_point(const Triangulation& tri, const Point& p, TriPtLoc* loc,
+                           uint32_t hint_ti) {
+  if (tri.triangles.empty()) {
+    *loc = TriPtLoc::Outside;
+    return invalid_index();
+  }
+  if (hint_ti == invalid_index()) {
+    hint_ti = jump(tri, p, hint_ti);
+  }
+  return walk(tri, hint_ti, p, loc);
+}
+
 void cdt::initialize_super_triangle(Triangulation& tri, const Point*, uint32_t) {
   //  @TODO
   assert(num_triangles(tri) == 0 && num_points(tri) == 0);
@@ -522,46 +822,64 @@ void cdt::initialize_super_triangle(Triangulation& tri, const Point*, uint32_t)
 void cdt::remove_super_triangle(Triangulation& tri) {
   assert(num_points(tri) >= 3);
   tri.points.erase(tri.points.begin(), tri.points.begin() + 3);
-  auto it = tri.triangles.begin();
-  while (it != tri.triangles.end()) {
-    auto& t = *it;
+
+  std::vector<uint32_t> remap(tri.triangles.size(), invalid_index());
+  uint32_t num_kept{};
+  for (uint32_t ti = 0; ti < num_triangles(tri); ti++) {
+    auto t = tri.triangles[ti];
     if (has_point_index(t, 0) || has_point_index(t, 1) || has_point_index(t, 2)) {
-      it = tri.triangles.erase(it);
-    } else {
-      for (auto& vi : t.i) {
-        assert(vi >= 3);
-        vi -= 3;
-      }
-      ++it;
+      continue;
+    }
+    for (auto& vi : t.i) {
+      assert(vi >= 3);
+      vi -= 3;
+    }
+    remap[ti] = num_kept;
+    tri.triangles[num_kept] = t;
+    std::copy_n(tri.adjacency.begin() + ti * 3, 3, tri.adjacency.begin() + num_kept * 3);
+    num_kept++;
+  }
+  tri.triangles.resize(num_kept);
+  tri.adjacency.resize(num_kept * 3);
+  for (auto& adj_ti : tri.adjacency) {
+    if (adj_ti != invalid_index()) {
+      adj_ti = remap[adj_ti];
+    }
+  }
+
+  tri.vertex_triangles.assign(tri.points.size(), invalid_index());
+  for (uint32_t ti = 0; ti < num_kept; ti++) {
+    for (uint32_t vi : tri.triangles[ti].i) {
+      tri.vertex_triangles[vi] = ti;
     }
   }
 }
 
 void cdt::add_point(Triangulation& tri, const Point& point) {
   uint32_t pi = grove::add_point(tri, point);
-  auto ti_stack = divide_triangle(tri, point, pi);
-  while (!ti_stack.empty()) {
-    uint32_t ti = ti_stack.back();
-    ti_stack.pop_back();
-    auto [ti_op, shared_edge] = opposed_triangle(
-      tri.triangles.data(), num_triangles(tri), ti, pi);
-    if (ti_op == invalid_index()) {
-      continue;
-    }
-    if (!is_fixed_edge(tri, shared_edge)) {
-      auto [p0, p1, p2] = read_vertices(tri.points.data(), tri.triangles[ti_op]);
-      if (is_in_circumcircle(*p0, *p1, *p2, point)) {
-        edge_swap(tri, ti, ti_op, shared_edge, pi);
-        ti_stack.push_back(ti);
-        ti_stack.push_back(ti_op);
-      }
-    }
-  }
+  std::vector<uint32_t> ti_stack;
+  insert_point(tri, pi, invalid_index(), ti_stack);
 }
 
 void cdt::add_points(Triangulation& tri, const Point* points, uint32_t num_points) {
+#ifdef GROVE_DEBUG
+  assert(!has_duplicate(points, num_points));
+#endif
+  const uint32_t pi0 = grove::num_points(tri);
+  tri.points.reserve(pi0 + num_points);
+  tri.vertex_triangles.reserve(pi0 + num_points);
+  tri.triangles.reserve(tri.triangles.size() + 2 * size_t(num_points));
+  tri.adjacency.reserve(tri.adjacency.size() + 6 * size_t(num_points));
   for (uint32_t i = 0; i < num_points; i++) {
-    add_point(tri, points[i]);
+    assert(std::isfinite(points[i].x) && std::isfinite(points[i].y));
+    tri.points.push_back(points[i]);
+    tri.vertex_triangles.push_back(invalid_index());
+  }
+
+  std::vector<uint32_t> ti_stack;
+  uint32_t hint_ti = invalid_index();
+  for (uint32_t i : brio_order(points, num_points)) {
+    hint_ti = insert_point(tri, pi0 + i, hint_ti, ti_stack);
   }
 }
 
@@ -585,22 +903,53 @@ std::vector<Edge> cdt::add_edges(Triangulation& tri, const Edge* edges, uint32_t
 }
 
 void cdt::validate(const Triangulation& tri) {
-  for (auto& t : tri.triangles) {
+  assert(tri.adjacency.size() == tri.triangles.size() * 3);
+  assert(tri.vertex_triangles.size() == tri.points.size());
+  for (uint32_t ti = 0; ti < num_triangles(tri); ti++) {
+    auto& t = tri.triangles[ti];
     for (auto& vi : t.i) {
       assert(vi < tri.points.size());
       (void) vi;
     }
     assert(is_ccw(tri, t.i[0], t.i[1], t.i[2]));
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t adj_ti = tri.adjacency[ti * 3 + k];
+      if (adj_ti != invalid_index()) {
+        [[maybe_unused]] const uint32_t ai = t.i[k];
+        [[maybe_unused]] const uint32_t bi = t.i[ccw(k)];
+        assert(adjacent_triangle(tri, adj_ti, ai, bi) == ti);
+      }
+    }
+  }
+  for (uint32_t pi = 0; pi < num_points(tri); pi++) {
+    const uint32_t ti = tri.vertex_triangles[pi];
+    assert(ti == invalid_index() || has_point_index(tri.triangles[ti], pi));
+    (void) ti;
   }
 }
 
 std::vector<uint32_t> cdt::find_excluding_hole(const Triangle* tris, uint32_t num_tris,
                                                const Edge* edges, uint32_t num_edges, uint32_t pvi) {
+  std::vector<uint64_t> constrained(num_edges);
+  for (uint32_t i = 0; i < num_edges; i++) {
+    constrained[i] = edge_key(
+      std::min(edges[i].ai, edges[i].bi), std::max(edges[i].ai, edges[i].bi));
+  }
+  std::sort(constrained.begin(), constrained.end());
+
+  std::vector<CavityEdge> tri_edges(size_t(num_tris) * 3);
+  for (uint32_t ti = 0; ti < num_tris; ti++) {
+    for (uint32_t k = 0; k < 3; k++) {
+      tri_edges[ti * 3 + k] = CavityEdge{edge_key(tris[ti].i[k], tris[ti].i[ccw(k)]), ti};
+    }
+  }
+  std::sort(tri_edges.begin(), tri_edges.end(), cavity_edge_less);
+
   std::vector<uint32_t> pend;
-  std::unordered_set<uint32_t> visited;
+  std::vector<bool> visited(num_tris);
   for (uint32_t ti = 0; ti < num_tris; ti++) {
     if (has_point_index(tris[ti], pvi)) {
-      visited.insert(ti);
+      visited[ti] = true;
       pend.push_back(ti);
     }
   }
@@ -612,27 +961,20 @@ std::vector<uint32_t> cdt::find_excluding_hole(const Triangle* tris, uint32_t nu
     keep_ti.push_back(ti);
     auto& t = tris[ti];
     for (uint32_t i = 0; i < 3; i++) {
-      auto ei0 = i;
-      auto ei1 = ccw(ei0);
-      auto edge = make_edge(t.i[ei0], t.i[ei1]);
-      if (!is_edge(edges, num_edges, edge)) {
-        uint32_t adj_ti = adjacent_triangle(tris, num_tris, ti, edge);
-        if (adj_ti != invalid_index() && visited.count(adj_ti) == 0) {
-          visited.insert(adj_ti);
-          pend.push_back(adj_ti);
+      const uint32_t ai = t.i[i];
+      const uint32_t bi = t.i[ccw(i)];
+      if (std::binary_search(
+        constrained.begin(), constrained.end(), edge_key(std::min(ai, bi), std::max(ai, bi)))) {
+        continue;
+      }
+      if (auto* adj = find_cavity_edge(tri_edges, edge_key(bi, ai))) {
+        if (!visited[adj->ti]) {
+          visited[adj->ti] = true;
+          pend.push_back(adj->ti);
         }
       }
     }
   }
-#ifdef GROVE_DEBUG
-  {
-    std::unordered_set<uint32_t> kept;
-    for (uint32_t ki : keep_ti) {
-      assert(kept.count(ki) == 0);
-      kept.insert(ki);
-    }
-  }
-#endif
   return keep_ti;
 }
 
@@ -672,7 +1014,7 @@ std::vector<Triangle> cdt::triangulate_simple(const Point* points, uint32_t num_
   cdt::initialize_super_triangle(tri, points, num_points);
   cdt::add_points(tri, points, num_points);
   cdt::remove_super_triangle(tri);
-  return tri.triangles;
+  return std::move(tri.triangles);
 }
 
 std::vector<Triangle> cdt::triangulate_simple(const std::vector<Point>& points) {
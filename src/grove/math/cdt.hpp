@@ -64,15 +64,22 @@ constexpr uint32_t invalid_index() {
   return ~0u;
 }
 
+//  `adjacency` holds 3 entries per triangle: entry `3 * ti + k` is the triangle across the edge
+//  from vertex `k` to vertex `(k + 1) % 3` of triangle `ti`, or `invalid_index()`.
+//  `vertex_triangles` holds one triangle incident to each point.
 struct Triangulation {
   std::vector<Triangle> triangles;
   std::vector<Point> points;
+  std::vector<uint32_t> adjacency;
+  std::vector<uint32_t> vertex_triangles;
   std::unordered_set<Edge, Edge::Hash, Edge::EqualOrderIndependent> fixed_edges;
 };
 
 void initialize_super_triangle(Triangulation& tri, const Point* points, uint32_t num_points);
 void remove_super_triangle(Triangulation& tri);
 void add_point(Triangulation& tri, const Point& point);
+//  Points are stored in the given order, but inserted in a biased randomized insertion order
+//  (rounds of increasing size, each sorted along a Hilbert curve).
 void add_points(Triangulation& tri, const Point* points, uint32_t num_points);
 [[nodiscard]] std::vector<Edge> add_edge(Triangulation& tri, Edge edge);
 [[nodiscard]] std::vector<Edge> add_edges(Triangulation& tri, const Edge* edges, uint32_t num_edges);
@@ -80,6 +87,11 @@ void validate(const Triangulation& tri);
 
 int hyperplane_side(const Point& line_a, const Point& line_b, const Point& p);
 TriPtLoc triangle_point_location(const Point& v0, const Point& v1, const Point& v2, const Point& a);
+//  Index of a triangle containing `p`, found by walking from a triangle near `p`, or
+//  `invalid_index()` if `p` lies outside the triangulation. `loc` receives the location of `p` in
+//  the triangle.
+uint32_t locate_point(const Triangulation& tri, const Point& p, TriPtLoc* loc,
+                      uint32_t hint_ti = invalid_index());
 
 uint32_t point_index_not_in_edges(const Edge* edges, uint32_t num_edges, uint32_t num_points);
 std::vector<uint32_t> find_excluding_hole(const Triangle* tris, uint32_t num_tris,
@@ -0,0 +1,165 @@
+#include "obb_batch.hpp"
+#include "simd.hpp"
+#include "grove/common/common.hpp"
+#include <algorithm>
+#include <cassert>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+using namespace simd;
+
+struct F4x3 {
+  F4 x;
+  F4 y;
+  F4 z;
+};
+
+F4x3 broadcast(const Vec3f& v) {
+  return F4x3{set1(v.x), set1(v.y), set1(v.z)};
+}
+
+F4x3 load_vec3(const float* block, uint32_t component) {
+  return F4x3{
+    load(block + component * 4),
+    load(block + (component + 1) * 4),
+    load(block + (component + 2) * 4)
+  };
+}
+
+//  Same operation order as the scalar `dot`, `cross` and `Vec3 * T`, so that batched results
+//  match `obb_obb_intersect` exactly.
+F4 dot(const F4x3& a, const F4x3& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+F4x3 cross(const F4x3& a, const F4x3& b) {
+  return F4x3{
+    a.y * b.z - a.z * b.y,
+    a.z * b.x - a.x * b.z,
+    a.x * b.y - a.y * b.x
+  };
+}
+
+F4x3 scale(const F4x3& a, F4 v) {
+  return F4x3{a.x * v, a.y * v, a.z * v};
+}
+
+//  Axes and half-size-scaled axes of one box.
+struct BoxAxes {
+  F4x3 axes[3];
+  F4x3 extents[3];
+};
+
+F4 projected_radius(const BoxAxes& box, const F4x3& l) {
+  return abs(dot(box.extents[0], l)) + abs(dot(box.extents[1], l)) + abs(dot(box.extents[2], l));
+}
+
+F4 overlapping_axis(const BoxAxes& a, const BoxAxes& b, const F4x3& t, const F4x3& l) {
+  return le(abs(dot(t, l)), projected_radius(a, l) + projected_radius(b, l));
+}
+
+//  Lanes of `mask` whose boxes overlap `a` on every axis tested before all lanes were separated.
+F4 sat(const BoxAxes& a, const BoxAxes& b, const F4x3& t) {
+  F4 mask = overlapping_axis(a, b, t, a.axes[0]);
+  for (int i = 1; i < 3 && any(mask); i++) {
+    mask = bit_and(mask, overlapping_axis(a, b, t, a.axes[i]));
+  }
+  for (int i = 0; i < 3 && any(mask); i++) {
+    mask = bit_and(mask, overlapping_axis(a, b, t, b.axes[i]));
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3 && any(mask); j++) {
+      mask = bit_and(mask, overlapping_axis(a, b, t, cross(a.axes[i], b.axes[j])));
+    }
+  }
+  return mask;
+}
+
+} //  anon
+
+void OBB3fBatch::reserve(uint32_t count) {
+  data.reserve(((count + block_size - 1) / block_size) * block_size * num_components);
+}
+
+void OBB3fBatch::push_back(const OBB3f& obb) {
+  const uint32_t lane = num_obbs % block_size;
+  if (lane == 0) {
+    data.resize(data.size() + block_size * num_components);
+  }
+
+  const float components[num_components]{
+    obb.i.x, obb.i.y, obb.i.z,
+    obb.j.x, obb.j.y, obb.j.z,
+    obb.k.x, obb.k.y, obb.k.z,
+    obb.position.x, obb.position.y, obb.position.z,
+    obb.half_size.x, obb.half_size.y, obb.half_size.z
+  };
+
+  float* dst = data.data() + (num_obbs / block_size) * block_size * num_components;
+  for (uint32_t c = 0; c < num_components; c++) {
+    for (uint32_t l = lane; l < block_size; l++) {
+      dst[c * block_size + l] = components[c];
+    }
+  }
+  num_obbs++;
+}
+
+OBB3f OBB3fBatch::get(uint32_t index) const {
+  assert(index < num_obbs);
+  const float* src = block(index / block_size) + index % block_size;
+  float components[num_components];
+  for (uint32_t c = 0; c < num_components; c++) {
+    components[c] = src[c * block_size];
+  }
+  OBB3f result;
+  result.i = Vec3f{components[0], components[1], components[2]};
+  result.j = Vec3f{components[3], components[4], components[5]};
+  result.k = Vec3f{components[6], components[7], components[8]};
+  result.position = Vec3f{components[9], components[10], components[11]};
+  result.half_size = Vec3f{components[12], components[13], components[14]};
+  return result;
+}
+
+uint32_t obb_obb_intersect(const OBB3f& a, const OBB3fBatch& bs, uint32_t* hit_indices) {
+  BoxAxes a_axes{};
+  a_axes.axes[0] = broadcast(a.i);
+  a_axes.axes[1] = broadcast(a.j);
+  a_axes.axes[2] = broadcast(a.k);
+  a_axes.extents[0] = broadcast(a.i * a.half_size.x);
+  a_axes.extents[1] = broadcast(a.j * a.half_size.y);
+  a_axes.extents[2] = broadcast(a.k * a.half_size.z);
+  const F4x3 a_position = broadcast(a.position);
+
+  uint32_t num_hit{};
+  const uint32_t num_blocks = bs.num_blocks();
+  for (uint32_t bi = 0; bi < num_blocks; bi++) {
+    const float* block = bs.block(bi);
+    BoxAxes b_axes;
+    for (uint32_t i = 0; i < 3; i++) {
+      b_axes.axes[i] = load_vec3(block, i * 3);
+      b_axes.extents[i] = scale(b_axes.axes[i], load(block + (12 + i) * 4));
+    }
+    const F4x3 b_position = load_vec3(block, 9);
+    const F4x3 t{
+      b_position.x - a_position.x,
+      b_position.y - a_position.y,
+      b_position.z - a_position.z
+    };
+
+    int mask = move_mask(sat(a_axes, b_axes, t));
+    const uint32_t base = bi * OBB3fBatch::block_size;
+    const uint32_t num_lanes = std::min(OBB3fBatch::block_size, bs.size() - base);
+    mask &= (1 << num_lanes) - 1;
+    for (uint32_t l = 0; l < num_lanes; l++) {
+      if (mask & (1 << l)) {
+        hit_indices[num_hit++] = base + l;
+      }
+    }
+  }
+
+  return num_hit;
+}
+
+GROVE_NAMESPACE_END
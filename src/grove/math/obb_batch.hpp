@@ -0,0 +1,50 @@
+#pragma once
+
+#include "OBB3.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace grove {
+
+/*
+ * OBB3fBatch
+ *
+ * Oriented bounding boxes stored in blocks of 4, with each component of the 4 boxes contiguous
+ * (i.x of boxes 0-3, then i.y of boxes 0-3, and so on), so that one box can be tested against 4
+ * others at a time. The last block is padded with copies of the last box.
+ */
+class OBB3fBatch {
+public:
+  static constexpr uint32_t block_size = 4;
+  static constexpr uint32_t num_components = 15;
+
+public:
+  void clear() {
+    data.clear();
+    num_obbs = 0;
+  }
+  void reserve(uint32_t count);
+  void push_back(const OBB3f& obb);
+  OBB3f get(uint32_t index) const;
+
+  uint32_t size() const {
+    return num_obbs;
+  }
+  uint32_t num_blocks() const {
+    return (num_obbs + block_size - 1) / block_size;
+  }
+  const float* block(uint32_t index) const {
+    return data.data() + index * block_size * num_components;
+  }
+
+private:
+  std::vector<float> data;
+  uint32_t num_obbs{};
+};
+
+//  Separating axis test of `a` against every box in `bs`, 4 boxes at a time. Writes the indices of
+//  intersecting boxes, in ascending order, to `hit_indices` (which must hold `bs.size()` indices),
+//  and returns how many there are. Results match `obb_obb_intersect(a, b)` for each box.
+uint32_t obb_obb_intersect(const OBB3f& a, const OBB3fBatch& bs, uint32_t* hit_indices);
+
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+/*
+ * Minimal 4-wide float (and 2-wide double) vector abstraction over SSE2 / NEON, with a scalar
+ * fallback.
+ *
+ * AVX is intentionally not required; none of our build configurations enable it by default, and
+ * SSE2 / NEON are baseline on every platform we ship to (x64 Windows, arm64 macOS).
+ */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GROVE_SIMD_NEON (1)
+#define GROVE_SIMD_SSE2 (0)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GROVE_SIMD_NEON (0)
+#define GROVE_SIMD_SSE2 (1)
+#else
+#define GROVE_SIMD_NEON (0)
+#define GROVE_SIMD_SSE2 (0)
+#endif
+
+#define GROVE_SIMD_ENABLED (GROVE_SIMD_NEON || GROVE_SIMD_SSE2)
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace grove::simd {
+
+struct alignas(16) F4 {
+#if GROVE_SIMD_NEON
+  float32x4_t v;
+#elif GROVE_SIMD_SSE2
+  __m128 v;
+#else
+  float v[4];
+#endif
+};
+
+#if GROVE_SIMD_NEON
+
+inline F4 load(const float* p) { return {vld1q_f32(p)}; }
+inline void store(float* p, F4 a) { vst1q_f32(p, a.v); }
+inline F4 set1(float a) { return {vdupq_n_f32(a)}; }
+inline F4 set(float a, float b, float c, float d) {
+  const float tmp[4]{a, b, c, d};
+  return {vld1q_f32(tmp)};
+}
+inline F4 zero() { return {vdupq_n_f32(0.0f)}; }
+inline F4 operator+(F4 a, F4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline F4 operator-(F4 a, F4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline F4 operator*(F4 a, F4 b) { return {vmulq_f32(a.v, b.v)}; }
+inline F4 operator/(F4 a, F4 b) { return {vdivq_f32(a.v, b.v)}; }
+inline F4 min(F4 a, F4 b) { return {vminq_f32(a.v, b.v)}; }
+inline F4 max(F4 a, F4 b) { return {vmaxq_f32(a.v, b.v)}; }
+inline F4 sqrt(F4 a) { return {vsqrtq_f32(a.v)}; }
+inline F4 abs(F4 a) { return {vabsq_f32(a.v)}; }
+inline F4 lt(F4 a, F4 b) { return {vreinterpretq_f32_u32(vcltq_f32(a.v, b.v))}; }
+inline F4 le(F4 a, F4 b) { return {vreinterpretq_f32_u32(vcleq_f32(a.v, b.v))}; }
+inline F4 gt(F4 a, F4 b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))}; }
+inline F4 bit_and(F4 a, F4 b) {
+  return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+}
+inline F4 bit_or(F4 a, F4 b) {
+  return {vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+}
+//  mask ? a : b
+inline F4 select(F4 mask, F4 a, F4 b) {
+  return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+}
+//  (a0, a1, a2, a3) -> (a1, a0, a3, a2)
+inline F4 swap_pairs(F4 a) { return {vrev64q_f32(a.v)}; }
+//  Bit i is set if lane i of `mask` is set.
+inline int move_mask(F4 mask) {
+  uint32_t tmp[4];
+  vst1q_u32(tmp, vreinterpretq_u32_f32(mask.v));
+  return int((tmp[0] >> 31) | ((tmp[1] >> 31) << 1) | ((tmp[2] >> 31) << 2) | ((tmp[3] >> 31) << 3));
+}
+
+#elif GROVE_SIMD_SSE2
+
+inline F4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+inline void store(float* p, F4 a) { _mm_storeu_ps(p, a.v); }
+inline F4 set1(float a) { return {_mm_set1_ps(a)}; }
+inline F4 set(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+inline F4 zero() { return {_mm_setzero_ps()}; }
+inline F4 operator+(F4 a, F4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F4 operator-(F4 a, F4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline F4 operator*(F4 a, F4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F4 operator/(F4 a, F4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline F4 min(F4 a, F4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline F4 max(F4 a, F4 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline F4 sqrt(F4 a) { return {_mm_sqrt_ps(a.v)}; }
+inline F4 abs(F4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+inline F4 lt(F4 a, F4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline F4 le(F4 a, F4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline F4 gt(F4 a, F4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline F4 bit_and(F4 a, F4 b) { return {_mm_and_ps(a.v, b.v)}; }
+inline F4 bit_or(F4 a, F4 b) { return {_mm_or_ps(a.v, b.v)}; }
+inline F4 select(F4 mask, F4 a, F4 b) {
+  return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+}
+inline F4 swap_pairs(F4 a) { return {_mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1))}; }
+inline int move_mask(F4 mask) { return _mm_movemask_ps(mask.v); }
+
+#else
+
+namespace detail {
+
+template <typename F>
+inline F4 map(F4 a, F4 b, F&& f) {
+  F4 r;
+  for (int i = 0; i < 4; i++) {
+    r.v[i] = f(a.v[i], b.v[i]);
+  }
+  return r;
+}
+
+inline float mask_value(bool v) {
+  uint32_t bits = v ? 0xffffffffu : 0u;
+  float r;
+  std::memcpy(&r, &bits, sizeof(float));
+  return r;
+}
+
+inline uint32_t bits_of(float v) {
+  uint32_t r;
+  std::memcpy(&r, &v, sizeof(float));
+  return r;
+}
+
+inline float float_of(uint32_t v) {
+  float r;
+  std::memcpy(&r, &v, sizeof(float));
+  return r;
+}
+
+} //  detail
+
+inline F4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float* p, F4 a) { std::memcpy(p, a.v, 4 * sizeof(float)); }
+inline F4 set1(float a) { return {{a, a, a, a}}; }
+inline F4 set(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+inline F4 zero() { return set1(0.0f); }
+inline F4 operator+(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return x + y; }); }
+inline F4 operator-(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return x - y; }); }
+inline F4 operator*(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return x * y; }); }
+inline F4 operator/(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return x / y; }); }
+inline F4 min(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return y < x ? y : x; }); }
+inline F4 max(F4 a, F4 b) { return detail::map(a, b, [](float x, float y) { return x < y ? y : x; }); }
+inline F4 sqrt(F4 a) { return detail::map(a, a, [](float x, float) { return std::sqrt(x); }); }
+inline F4 abs(F4 a) { return detail::map(a, a, [](float x, float) { return std::abs(x); }); }
+inline F4 lt(F4 a, F4 b) {
+  return detail::map(a, b, [](float x, float y) { return detail::mask_value(x < y); });
+}
+inline F4 le(F4 a, F4 b) {
+  return detail::map(a, b, [](float x, float y) { return detail::mask_value(x <= y); });
+}
+inline F4 gt(F4 a, F4 b) {
+  return detail::map(a, b, [](float x, float y) { return detail::mask_value(x > y); });
+}
+inline F4 bit_and(F4 a, F4 b) {
+  return detail::map(a, b, [](float x, float y) {
+    return detail::float_of(detail::bits_of(x) & detail::bits_of(y));
+  });
+}
+inline F4 bit_or(F4 a, F4 b) {
+  return detail::map(a, b, [](float x, float y) {
+    return detail::float_of(detail::bits_of(x) | detail::bits_of(y));
+  });
+}
+inline F4 select(F4 mask, F4 a, F4 b) {
+  F4 r;
+  for (int i = 0; i < 4; i++) {
+    r.v[i] = detail::bits_of(mask.v[i]) ? a.v[i] : b.v[i];
+  }
+  return r;
+}
+inline F4 swap_pairs(F4 a) { return {{a.v[1], a.v[0], a.v[3], a.v[2]}}; }
+inline int move_mask(F4 mask) {
+  int r{};
+  for (int i = 0; i < 4; i++) {
+    r |= int(detail::bits_of(mask.v[i]) >> 31) << i;
+  }
+  return r;
+}
+
+#endif
+
+inline F4 operator-(F4 a) {
+  return zero() - a;
+}
+
+//  a * b + c
+inline F4 madd(F4 a, F4 b, F4 c) {
+  return a * b + c;
+}
+
+inline F4 clamp(F4 v, F4 lo, F4 hi) {
+  return max(lo, min(v, hi));
+}
+
+inline bool any(F4 mask) {
+  return move_mask(mask) != 0;
+}
+
+inline bool all(F4 mask) {
+  return move_mask(mask) == 0xf;
+}
+
+inline float lane(F4 a, int i) {
+  alignas(16) float tmp[4];
+  store(tmp, a);
+  return tmp[i];
+}
+
+/*
+ * D2
+ *
+ * 2-wide double vector, for kernels that have to reproduce double-precision scalar code exactly.
+ * Four lanes are processed as a pair of D2, with F4 <-> D2 conversions in between.
+ */
+
+#if GROVE_SIMD_NEON && defined(__aarch64__)
+
+struct alignas(16) D2 {
+  float64x2_t v;
+};
+
+inline D2 load(const double* p) { return {vld1q_f64(p)}; }
+inline void store(double* p, D2 a) { vst1q_f64(p, a.v); }
+inline D2 set1d(double a) { return {vdupq_n_f64(a)}; }
+inline D2 setd(double a, double b) {
+  const double tmp[2]{a, b};
+  return {vld1q_f64(tmp)};
+}
+inline D2 operator+(D2 a, D2 b) { return {vaddq_f64(a.v, b.v)}; }
+inline D2 operator-(D2 a, D2 b) { return {vsubq_f64(a.v, b.v)}; }
+inline D2 operator*(D2 a, D2 b) { return {vmulq_f64(a.v, b.v)}; }
+inline D2 lt(D2 a, D2 b) { return {vreinterpretq_f64_u64(vcltq_f64(a.v, b.v))}; }
+inline D2 ge(D2 a, D2 b) { return {vreinterpretq_f64_u64(vcgeq_f64(a.v, b.v))}; }
+inline D2 select(D2 mask, D2 a, D2 b) {
+  return {vbslq_f64(vreinterpretq_u64_f64(mask.v), a.v, b.v)};
+}
+inline bool any(D2 mask) {
+  return vmaxvq_u32(vreinterpretq_u32_f64(mask.v)) != 0;
+}
+//  Round toward zero.
+inline D2 truncate(D2 a) { return {vrndq_f64(a.v)}; }
+inline void truncate_to_int(D2 a, int32_t* out) {
+  const int64x2_t i = vcvtq_s64_f64(a.v);
+  out[0] = int32_t(vgetq_lane_s64(i, 0));
+  out[1] = int32_t(vgetq_lane_s64(i, 1));
+}
+//  (a0, a1, a2, a3) -> (a0, a1), (a2, a3)
+inline D2 to_double_lo(F4 a) { return {vcvt_f64_f32(vget_low_f32(a.v))}; }
+inline D2 to_double_hi(F4 a) { return {vcvt_high_f64_f32(a.v)}; }
+inline F4 to_float(D2 lo, D2 hi) { return {vcombine_f32(vcvt_f32_f64(lo.v), vcvt_f32_f64(hi.v))}; }
+
+#elif GROVE_SIMD_SSE2
+
+struct alignas(16) D2 {
+  __m128d v;
+};
+
+inline D2 load(const double* p) { return {_mm_loadu_pd(p)}; }
+inline void store(double* p, D2 a) { _mm_storeu_pd(p, a.v); }
+inline D2 set1d(double a) { return {_mm_set1_pd(a)}; }
+inline D2 setd(double a, double b) { return {_mm_setr_pd(a, b)}; }
+inline D2 operator+(D2 a, D2 b) { return {_mm_add_pd(a.v, b.v)}; }
+inline D2 operator-(D2 a, D2 b) { return {_mm_sub_pd(a.v, b.v)}; }
+inline D2 operator*(D2 a, D2 b) { return {_mm_mul_pd(a.v, b.v)}; }
+inline D2 lt(D2 a, D2 b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+inline D2 ge(D2 a, D2 b) { return {_mm_cmpge_pd(a.v, b.v)}; }
+inline D2 select(D2 mask, D2 a, D2 b) {
+  return {_mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v))};
+}
+inline bool any(D2 mask) { return _mm_movemask_pd(mask.v) != 0; }
+//  Round toward zero. Lanes must be within the range of int32_t.
+inline D2 truncate(D2 a) { return {_mm_cvtepi32_pd(_mm_cvttpd_epi32(a.v))}; }
+inline void truncate_to_int(D2 a, int32_t* out) {
+  const __m128i i = _mm_cvttpd_epi32(a.v);
+  out[0] = _mm_cvtsi128_si32(i);
+  out[1] = _mm_cvtsi128_si32(_mm_srli_si128(i, 4));
+}
+inline D2 to_double_lo(F4 a) { return {_mm_cvtps_pd(a.v)}; }
+inline D2 to_double_hi(F4 a) { return {_mm_cvtps_pd(_mm_movehl_ps(a.v, a.v))}; }
+inline F4 to_float(D2 lo, D2 hi) {
+  return {_mm_movelh_ps(_mm_cvtpd_ps(lo.v), _mm_cvtpd_ps(hi.v))};
+}
+
+#else
+
+struct alignas(16) D2 {
+  double v[2];
+};
+
+namespace detail {
+
+template <typename F>
+inline D2 map(D2 a, D2 b, F&& f) {
+  return {{f(a.v[0], b.v[0]), f(a.v[1], b.v[1])}};
+}
+
+inline double mask_value_d(bool v) {
+  uint64_t bits = v ? ~uint64_t(0) : uint64_t(0);
+  double r;
+  std::memcpy(&r, &bits, sizeof(double));
+  return r;
+}
+
+inline uint64_t bits_of(double v) {
+  uint64_t r;
+  std::memcpy(&r, &v, sizeof(double));
+  return r;
+}
+
+} //  detail
+
+inline D2 load(const double* p) { return {{p[0], p[1]}}; }
+inline void store(double* p, D2 a) { std::memcpy(p, a.v, 2 * sizeof(double)); }
+inline D2 set1d(double a) { return {{a, a}}; }
+inline D2 setd(double a, double b) { return {{a, b}}; }
+inline D2 operator+(D2 a, D2 b) { return detail::map(a, b, [](double x, double y) { return x + y; }); }
+inline D2 operator-(D2 a, D2 b) { return detail::map(a, b, [](double x, double y) { return x - y; }); }
+inline D2 operator*(D2 a, D2 b) { return detail::map(a, b, [](double x, double y) { return x * y; }); }
+inline D2 lt(D2 a, D2 b) {
+  return detail::map(a, b, [](double x, double y) { return detail::mask_value_d(x < y); });
+}
+inline D2 ge(D2 a, D2 b) {
+  return detail::map(a, b, [](double x, double y) { return detail::mask_value_d(x >= y); });
+}
+inline D2 select(D2 mask, D2 a, D2 b) {
+  return {{detail::bits_of(mask.v[0]) ? a.v[0] : b.v[0],
+           detail::bits_of(mask.v[1]) ? a.v[1] : b.v[1]}};
+}
+inline bool any(D2 mask) {
+  return detail::bits_of(mask.v[0]) != 0 || detail::bits_of(mask.v[1]) != 0;
+}
+inline D2 truncate(D2 a) { return {{double(int32_t(a.v[0])), double(int32_t(a.v[1]))}}; }
+inline void truncate_to_int(D2 a, int32_t* out) {
+  out[0] = int32_t(a.v[0]);
+  out[1] = int32_t(a.v[1]);
+}
+inline D2 to_double_lo(F4 a) {
+  float tmp[4];
+  store(tmp, a);
+  return {{double(tmp[0]), double(tmp[1])}};
+}
+inline D2 to_double_hi(F4 a) {
+  float tmp[4];
+  store(tmp, a);
+  return {{double(tmp[2]), double(tmp[3])}};
+}
+inline F4 to_float(D2 lo, D2 hi) {
+  const float tmp[4]{float(lo.v[0]), float(lo.v[1]), float(hi.v[0]), float(hi.v[1])};
+  return load(tmp);
+}
+
+#endif
+
+}
@@ -0,0 +1,172 @@
+#include "grove/math/bvh.hpp"
+#include "grove/math/intersect.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr uint32_t grid_dim = 256;
+  static constexpr uint32_t num_rays = 512;
+  static constexpr uint32_t num_bvh_repeats = 100;
+  //  Small enough for 16-bit indices.
+  static constexpr uint32_t interleaved_grid_dim = 128;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+struct Mesh {
+  std::vector<Vec3f> ps;
+  std::vector<uint32_t> tris;
+};
+
+//  Height field over [-1, 1]^2 with random bumps, similar to a scanned terrain or imported model.
+Mesh make_noisy_grid(uint32_t dim, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+  Mesh result;
+  for (uint32_t i = 0; i <= dim; i++) {
+    for (uint32_t j = 0; j <= dim; j++) {
+      const float x = float(j) / float(dim) * 2.0f - 1.0f;
+      const float z = float(i) / float(dim) * 2.0f - 1.0f;
+      const float y = 0.25f * std::sin(x * 5.0f) * std::cos(z * 3.0f) + dis(gen) * 0.01f;
+      result.ps.push_back(Vec3f{x, y, z});
+    }
+  }
+  for (uint32_t i = 0; i < dim; i++) {
+    for (uint32_t j = 0; j < dim; j++) {
+      const uint32_t a = i * (dim + 1) + j;
+      const uint32_t b = a + 1;
+      const uint32_t c = a + dim + 1;
+      const uint32_t d = c + 1;
+      result.tris.insert(result.tris.end(), {a, c, b, b, c, d});
+    }
+  }
+  return result;
+}
+
+std::vector<Ray> make_rays(uint32_t num_rays, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+  std::vector<Ray> result(num_rays);
+  for (uint32_t i = 0; i < num_rays; i++) {
+    Ray ray{};
+    ray.origin = Vec3f{dis(gen), 1.0f, dis(gen)};
+    if (i % 4 == 0) {
+      //  Straight down, as when placing points on a surface.
+      ray.direction = Vec3f{0.0f, -1.0f, 0.0f};
+    } else {
+      ray.direction = normalize(Vec3f{dis(gen) * 0.5f, -1.0f, dis(gen) * 0.5f});
+    }
+    result[i] = ray;
+  }
+  return result;
+}
+
+//  Positions interleaved with normals and 16-bit indices, as in the architecture geometry.
+uint32_t count_interleaved_mismatches(const std::vector<Ray>& rays) {
+  auto mesh = make_noisy_grid(Config::interleaved_grid_dim, 3);
+  std::vector<Vec3f> ps_ns;
+  for (auto& p : mesh.ps) {
+    ps_ns.push_back(p);
+    ps_ns.push_back(Vec3f{0.0f, 1.0f, 0.0f});
+  }
+  std::vector<uint16_t> tris(mesh.tris.begin(), mesh.tris.end());
+  const auto num_tris = uint32_t(tris.size() / 3);
+
+  auto tri_bvh = bvh::build_triangle_bvh(tris.data(), num_tris, ps_ns.data(), 2);
+  uint32_t num_mismatch{};
+  for (auto& ray : rays) {
+    size_t lin_ti{};
+    float lin_t{};
+    const bool lin_hit = ray_triangle_intersect(
+      ray, ps_ns.data(), 2 * sizeof(Vec3f), 0, tris.data(), num_tris, 0, nullptr, &lin_ti, &lin_t);
+    uint32_t hit_ti{};
+    float hit_t{};
+    const bool hit = bvh::ray_intersect(tri_bvh, tris.data(), ps_ns.data(), ray, &hit_ti, &hit_t);
+    num_mismatch += uint32_t(lin_hit != hit || (hit && (lin_ti != hit_ti || lin_t != hit_t)));
+  }
+  return num_mismatch;
+}
+
+} //  anon
+
+int main(int, char**) {
+  auto mesh = make_noisy_grid(Config::grid_dim, 1);
+  const auto num_tris = uint32_t(mesh.tris.size() / 3);
+  auto rays = make_rays(Config::num_rays, 2);
+
+  bvh::TriangleBVH tri_bvh;
+  const double build_ms = time_ms([&]() {
+    tri_bvh = bvh::build_triangle_bvh(mesh.tris.data(), num_tris, mesh.ps.data());
+  });
+  std::cout << num_tris << " triangles; build: " << build_ms << "ms; "
+            << tri_bvh.nodes.size() << " nodes; depth: " << tri_bvh.max_depth << std::endl;
+
+  std::vector<bvh::RayHit> linear_hits(rays.size());
+  const double linear_ms = time_ms([&]() {
+    for (uint32_t i = 0; i < uint32_t(rays.size()); i++) {
+      int hit_ti{};
+      float hit_t{};
+      bool hit = ray_triangle_intersect(
+        rays[i], mesh.ps.data(), mesh.tris.data(), int(num_tris), &hit_ti, &hit_t);
+      linear_hits[i] = bvh::RayHit{hit ? uint32_t(hit_ti) : bvh::no_hit(), hit ? hit_t : 0.0f};
+    }
+  });
+
+  std::vector<bvh::RayHit> single_hits(rays.size());
+  const double single_ms = time_ms([&]() {
+    for (uint32_t r = 0; r < Config::num_bvh_repeats; r++) {
+      for (uint32_t i = 0; i < uint32_t(rays.size()); i++) {
+        uint32_t hit_ti{};
+        float hit_t{};
+        bool hit = bvh::ray_intersect(
+          tri_bvh, mesh.tris.data(), mesh.ps.data(), rays[i], &hit_ti, &hit_t);
+        single_hits[i] = bvh::RayHit{hit ? hit_ti : bvh::no_hit(), hit ? hit_t : 0.0f};
+      }
+    }
+  }) / double(Config::num_bvh_repeats);
+
+  std::vector<bvh::RayHit> packet_hits(rays.size());
+  const double packet_ms = time_ms([&]() {
+    for (uint32_t r = 0; r < Config::num_bvh_repeats; r++) {
+      bvh::ray_intersect(
+        tri_bvh, mesh.tris.data(), mesh.ps.data(),
+        rays.data(), uint32_t(rays.size()), packet_hits.data());
+    }
+  }) / double(Config::num_bvh_repeats);
+
+  uint32_t num_hit{};
+  uint32_t num_single_mismatch{};
+  uint32_t num_packet_mismatch{};
+  for (uint32_t i = 0; i < uint32_t(rays.size()); i++) {
+    auto& lin = linear_hits[i];
+    num_hit += uint32_t(lin.ti != bvh::no_hit());
+    num_single_mismatch += uint32_t(lin.ti != single_hits[i].ti || lin.t != single_hits[i].t);
+    num_packet_mismatch += uint32_t(lin.ti != packet_hits[i].ti || lin.t != packet_hits[i].t);
+  }
+
+  std::cout << rays.size() << " rays (" << num_hit << " hit); linear: " << linear_ms << "ms"
+            << "; bvh: " << single_ms << "ms"
+            << "; bvh packets: " << packet_ms << "ms" << std::endl;
+  const uint32_t num_interleaved_mismatch = count_interleaved_mismatches(rays);
+  std::cout << "mismatches; bvh: " << num_single_mismatch
+            << "; bvh packets: " << num_packet_mismatch
+            << "; interleaved, 16-bit indices: " << num_interleaved_mismatch << std::endl;
+
+  return num_single_mismatch == 0 && num_packet_mismatch == 0 &&
+         num_interleaved_mismatch == 0 ? 0 : 1;
+}
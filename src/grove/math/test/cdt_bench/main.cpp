@@ -0,0 +1,377 @@
+#include "grove/math/cdt.hpp"
+#include "GeometricPredicates/predicates.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace grove;
+using namespace grove::cdt;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr uint32_t num_legacy_points = 10000;
+  static constexpr uint32_t point_counts[3] = {10000, 100000, 1000000};
+  static constexpr uint32_t num_constrained_points = 100000;
+  static constexpr double hole_min = 0.25;
+  static constexpr double hole_max = 0.75;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+std::vector<Point> make_points(uint32_t num_points, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+  std::vector<Point> result(num_points);
+  for (auto& p : result) {
+    p = Point{dis(gen), dis(gen)};
+  }
+  return result;
+}
+
+/*
+ * Legacy
+ *
+ * Point insertion before the adjacency table: every point location and neighbor query scans all
+ * triangles.
+ */
+
+namespace legacy {
+
+uint32_t ccw(uint32_t i) {
+  return (i + 1) % 3;
+}
+
+bool has_point_index(const Triangle& t, uint32_t pi) {
+  return t.i[0] == pi || t.i[1] == pi || t.i[2] == pi;
+}
+
+bool has_edge(const Triangle& t, const Edge& e) {
+  return has_point_index(t, e.ai) && has_point_index(t, e.bi);
+}
+
+uint32_t setdiff_edge(const Triangle& t, const Edge& e) {
+  for (auto vi : t.i) {
+    if (vi != e.ai && vi != e.bi) {
+      return vi;
+    }
+  }
+  return invalid_index();
+}
+
+Triangle require_ccw(const std::vector<Point>& ps, uint32_t ai, uint32_t bi, uint32_t ci) {
+  if (hyperplane_side(ps[ai], ps[bi], ps[ci]) > 0) {
+    return Triangle{{ai, bi, ci}};
+  } else {
+    return Triangle{{ai, ci, bi}};
+  }
+}
+
+uint32_t adjacent_triangle(const std::vector<Triangle>& tris, uint32_t ti, const Edge& e) {
+  for (uint32_t i = 0; i < uint32_t(tris.size()); i++) {
+    if (i != ti && has_edge(tris[i], e)) {
+      return i;
+    }
+  }
+  return invalid_index();
+}
+
+std::tuple<uint32_t, Edge> opposed_triangle(const std::vector<Triangle>& tris,
+                                            uint32_t ti, uint32_t pi) {
+  auto& t = tris[ti];
+  for (uint32_t i = 0; i < 3; i++) {
+    if (t.i[i] != pi && t.i[ccw(i)] != pi) {
+      Edge e{t.i[i], t.i[ccw(i)]};
+      return std::make_tuple(adjacent_triangle(tris, ti, e), e);
+    }
+  }
+  return std::make_tuple(invalid_index(), Edge{});
+}
+
+void add_point(std::vector<Triangle>& tris, std::vector<Point>& ps, const Point& p) {
+  const auto pi = uint32_t(ps.size());
+  ps.push_back(p);
+
+  std::vector<uint32_t> ti_stack;
+  for (uint32_t ti = 0; ti < uint32_t(tris.size()); ti++) {
+    const auto t = tris[ti];
+    auto loc = triangle_point_location(ps[t.i[0]], ps[t.i[1]], ps[t.i[2]], p);
+    if (loc == TriPtLoc::Inside) {
+      tris[ti] = Triangle{{t.i[0], pi, t.i[2]}};
+      tris.push_back(Triangle{{pi, t.i[1], t.i[2]}});
+      tris.push_back(Triangle{{t.i[0], t.i[1], pi}});
+      ti_stack = {ti, uint32_t(tris.size() - 2), uint32_t(tris.size() - 1)};
+      break;
+    } else if (loc != TriPtLoc::Outside) {
+      const uint32_t k = loc == TriPtLoc::Edge0 ? 0 : loc == TriPtLoc::Edge1 ? 1 : 2;
+      Edge e{t.i[k], t.i[ccw(k)]};
+      const uint32_t ti1 = adjacent_triangle(tris, ti, e);
+      const uint32_t ai = setdiff_edge(t, e);
+      const uint32_t ci = setdiff_edge(tris[ti1], e);
+      tris[ti] = require_ccw(ps, ai, e.ai, pi);
+      tris[ti1] = require_ccw(ps, pi, e.bi, ai);
+      tris.push_back(require_ccw(ps, e.ai, ci, pi));
+      tris.push_back(require_ccw(ps, ci, e.bi, pi));
+      ti_stack = {ti, ti1, uint32_t(tris.size() - 2), uint32_t(tris.size() - 1)};
+      break;
+    }
+  }
+
+  while (!ti_stack.empty()) {
+    const uint32_t ti = ti_stack.back();
+    ti_stack.pop_back();
+    auto [ti_op, e] = opposed_triangle(tris, ti, pi);
+    if (ti_op == invalid_index()) {
+      continue;
+    }
+    auto& t_op = tris[ti_op];
+    using namespace predicates::adaptive;
+    if (incircle(&ps[t_op.i[0]].x, &ps[t_op.i[1]].x, &ps[t_op.i[2]].x, &p.x) > 0.0) {
+      const uint32_t ci = setdiff_edge(t_op, e);
+      tris[ti] = require_ccw(ps, pi, e.bi, ci);
+      tris[ti_op] = require_ccw(ps, e.ai, pi, ci);
+      ti_stack.push_back(ti);
+      ti_stack.push_back(ti_op);
+    }
+  }
+}
+
+std::vector<Triangle> triangulate(const std::vector<Point>& points) {
+  const double scl = 2048.0;
+  std::vector<Point> ps{Point{-1.0, -1.0} * scl, Point{1.0, -1.0} * scl, Point{0.0, 1.0} * scl};
+  std::vector<Triangle> tris{Triangle{{0, 1, 2}}};
+  for (auto& p : points) {
+    add_point(tris, ps, p);
+  }
+  std::vector<Triangle> result;
+  for (auto& t : tris) {
+    if (t.i[0] >= 3 && t.i[1] >= 3 && t.i[2] >= 3) {
+      result.push_back(Triangle{{t.i[0] - 3, t.i[1] - 3, t.i[2] - 3}});
+    }
+  }
+  return result;
+}
+
+} //  legacy
+
+/*
+ * Checks
+ */
+
+uint64_t edge_key(uint32_t ai, uint32_t bi) {
+  return (uint64_t(ai) << 32u) | uint64_t(bi);
+}
+
+//  Triangles rotated so that their smallest index comes first, in sorted order.
+std::vector<Triangle> canonical(std::vector<Triangle> tris) {
+  for (auto& t : tris) {
+    while (t.i[0] > t.i[1] || t.i[0] > t.i[2]) {
+      t = Triangle{{t.i[1], t.i[2], t.i[0]}};
+    }
+  }
+  std::sort(tris.begin(), tris.end(), [](const Triangle& a, const Triangle& b) {
+    return std::lexicographical_compare(a.i, a.i + 3, b.i, b.i + 3);
+  });
+  return tris;
+}
+
+struct DirectedEdge {
+  uint64_t key;
+  uint32_t opposite;
+};
+
+std::vector<DirectedEdge> directed_edges(const std::vector<Triangle>& tris) {
+  std::vector<DirectedEdge> result;
+  for (auto& t : tris) {
+    for (uint32_t k = 0; k < 3; k++) {
+      result.push_back({edge_key(t.i[k], t.i[(k + 1) % 3]), t.i[(k + 2) % 3]});
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const DirectedEdge& a, const DirectedEdge& b) {
+    return a.key < b.key;
+  });
+  return result;
+}
+
+const DirectedEdge* find_edge(const std::vector<DirectedEdge>& edges, uint64_t key) {
+  auto it = std::lower_bound(
+    edges.begin(), edges.end(), key, [](const DirectedEdge& a, uint64_t k) {
+      return a.key < k;
+    });
+  return it != edges.end() && it->key == key ? &*it : nullptr;
+}
+
+//  Every triangle is counter-clockwise, every edge is used at most once in each direction, and no
+//  point opposite an edge lies in the circumcircle of the triangle on the other side, unless the
+//  edge is constrained.
+bool is_delaunay(const std::vector<Point>& ps, const std::vector<Triangle>& tris,
+                 const std::vector<Edge>& constrained) {
+  using namespace predicates::adaptive;
+  auto edges = directed_edges(tris);
+  for (size_t i = 1; i < edges.size(); i++) {
+    if (edges[i].key == edges[i - 1].key) {
+      return false;
+    }
+  }
+  std::vector<uint64_t> fixed;
+  for (auto& e : constrained) {
+    fixed.push_back(edge_key(e.ai, e.bi));
+    fixed.push_back(edge_key(e.bi, e.ai));
+  }
+  std::sort(fixed.begin(), fixed.end());
+
+  for (auto& t : tris) {
+    if (hyperplane_side(ps[t.i[0]], ps[t.i[1]], ps[t.i[2]]) <= 0) {
+      return false;
+    }
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t ai = t.i[k];
+      const uint32_t bi = t.i[(k + 1) % 3];
+      if (std::binary_search(fixed.begin(), fixed.end(), edge_key(ai, bi))) {
+        continue;
+      }
+      if (auto* op = find_edge(edges, edge_key(bi, ai))) {
+        auto& p0 = ps[t.i[0]];
+        auto& p1 = ps[t.i[1]];
+        auto& p2 = ps[t.i[2]];
+        if (incircle(&p0.x, &p1.x, &p2.x, &ps[op->opposite].x) > 0.0) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool uses_all_points(const std::vector<Triangle>& tris, uint32_t num_points) {
+  std::vector<bool> used(num_points);
+  for (auto& t : tris) {
+    for (auto vi : t.i) {
+      used[vi] = true;
+    }
+  }
+  return std::all_of(used.begin(), used.end(), [](bool u) { return u; });
+}
+
+double area(const std::vector<Point>& ps, const std::vector<Triangle>& tris) {
+  double result{};
+  for (auto& t : tris) {
+    auto a = ps[t.i[1]] - ps[t.i[0]];
+    auto b = ps[t.i[2]] - ps[t.i[0]];
+    result += 0.5 * (a.x * b.y - a.y * b.x);
+  }
+  return result;
+}
+
+bool in_hole(const Point& p) {
+  return p.x > Config::hole_min && p.x < Config::hole_max &&
+         p.y > Config::hole_min && p.y < Config::hole_max;
+}
+
+//  Unit square with a square hole: boundary and hole corners first, then interior points outside
+//  the hole.
+std::tuple<std::vector<Point>, std::vector<Edge>> make_square_with_hole(uint32_t num_points) {
+  const double lo = Config::hole_min;
+  const double hi = Config::hole_max;
+  std::vector<Point> ps{
+    Point{0.0, 0.0}, Point{1.0, 0.0}, Point{1.0, 1.0}, Point{0.0, 1.0},
+    Point{lo, lo}, Point{hi, lo}, Point{hi, hi}, Point{lo, hi}
+  };
+  std::vector<Edge> edges;
+  for (uint32_t i = 0; i < 4; i++) {
+    edges.push_back(Edge{i, (i + 1) % 4});
+    edges.push_back(Edge{4 + i, 4 + (i + 1) % 4});
+  }
+  for (auto& p : make_points(num_points, 3)) {
+    if (!in_hole(p) && p.x > 0.0 && p.y > 0.0) {
+      ps.push_back(p);
+    }
+  }
+  return std::make_tuple(std::move(ps), std::move(edges));
+}
+
+bool matches_square_with_hole(const std::vector<Point>& ps, const std::vector<Triangle>& tris,
+                              const std::vector<Edge>& edges) {
+  const double hole_size = Config::hole_max - Config::hole_min;
+  const double expect_area = 1.0 - hole_size * hole_size;
+  if (std::abs(area(ps, tris) - expect_area) > 1e-9) {
+    return false;
+  }
+  for (auto& t : tris) {
+    auto c = (ps[t.i[0]] + ps[t.i[1]] + ps[t.i[2]]) / 3.0;
+    if (in_hole(c)) {
+      return false;
+    }
+  }
+  auto tri_edges = directed_edges(tris);
+  for (auto& e : edges) {
+    if (!find_edge(tri_edges, edge_key(e.ai, e.bi)) &&
+        !find_edge(tri_edges, edge_key(e.bi, e.ai))) {
+      return false;
+    }
+  }
+  return uses_all_points(tris, uint32_t(ps.size())) && is_delaunay(ps, tris, edges);
+}
+
+} //  anon
+
+int main(int, char**) {
+  bool success{true};
+
+  {
+    auto ps = make_points(Config::num_legacy_points, 1);
+    std::vector<Triangle> legacy_tris;
+    std::vector<Triangle> tris;
+    const double legacy_ms = time_ms([&]() {
+      legacy_tris = legacy::triangulate(ps);
+    });
+    const double ms = time_ms([&]() {
+      tris = triangulate_simple(ps);
+    });
+    const bool same = canonical(legacy_tris) == canonical(tris);
+    std::cout << ps.size() << " points; legacy: " << legacy_ms << "ms"
+              << "; walk: " << ms << "ms; same triangles: " << (same ? "yes" : "no") << std::endl;
+    success = success && same;
+  }
+
+  for (uint32_t num_points : Config::point_counts) {
+    auto ps = make_points(num_points, 2);
+    std::vector<Triangle> tris;
+    const double ms = time_ms([&]() {
+      tris = triangulate_simple(ps);
+    });
+    const bool ok = uses_all_points(tris, num_points) && is_delaunay(ps, tris, {});
+    std::cout << num_points << " points: " << ms << "ms"
+              << " (" << double(num_points) / ms << " points/ms)"
+              << "; " << tris.size() << " triangles"
+              << "; delaunay: " << (ok ? "yes" : "no") << std::endl;
+    success = success && ok;
+  }
+
+  {
+    auto [ps, edges] = make_square_with_hole(Config::num_constrained_points);
+    std::vector<Triangle> tris;
+    const double ms = time_ms([&]() {
+      tris = triangulate_remove_holes_simple(
+        ps.data(), uint32_t(ps.size()), edges.data(), uint32_t(edges.size()));
+    });
+    const bool ok = matches_square_with_hole(ps, tris, edges);
+    std::cout << ps.size() << " points with hole: " << ms << "ms"
+              << "; " << tris.size() << " triangles; valid: " << (ok ? "yes" : "no") << std::endl;
+    success = success && ok;
+  }
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include "grove/math/triangle_search.hpp"
+#include "grove/math/triangle.hpp"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr uint32_t grid_dim = 128;
+  static constexpr uint32_t num_queries = 100000;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+//  Grid of quads with every 7th triangle flipped, so that some neighbors have inconsistent
+//  winding, and every 11th triangle removed, so that there are holes with boundary edges.
+std::vector<uint32_t> make_grid_tris(uint32_t dim) {
+  std::vector<uint32_t> result;
+  uint32_t ti{};
+  for (uint32_t i = 0; i < dim; i++) {
+    for (uint32_t j = 0; j < dim; j++) {
+      const uint32_t a = i * (dim + 1) + j;
+      const uint32_t b = a + 1;
+      const uint32_t c = a + dim + 1;
+      const uint32_t d = c + 1;
+      const uint32_t quad[6] = {a, c, b, b, c, d};
+      for (int k = 0; k < 2; k++, ti++) {
+        const uint32_t* t = quad + k * 3;
+        if (ti % 11 == 0) {
+          continue;
+        } else if (ti % 7 == 0) {
+          result.insert(result.end(), {t[0], t[2], t[1]});
+        } else {
+          result.insert(result.end(), {t[0], t[1], t[2]});
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/*
+ * Legacy
+ *
+ * Edge lookup before the flat half-edge table: an unordered_map keyed by unordered vertex pairs.
+ */
+
+namespace legacy {
+
+struct Edge {
+  uint32_t i0;
+  uint32_t i1;
+};
+
+struct HashEdge {
+  std::size_t operator()(const Edge& edge) const noexcept {
+    return std::hash<uint32_t>{}(edge.i0) ^ std::hash<uint32_t>{}(edge.i1);
+  }
+};
+
+struct EqualEdge {
+  bool operator()(const Edge& a, const Edge& b) const noexcept {
+    return (a.i0 == b.i0 && a.i1 == b.i1) || (a.i0 == b.i1 && a.i1 == b.i0);
+  }
+};
+
+using EdgeToIndex = std::unordered_map<Edge, tri::EdgeTriangles, HashEdge, EqualEdge>;
+
+EdgeToIndex build_edge_to_index_map(const uint32_t* tris, uint32_t num_tris) {
+  EdgeToIndex result;
+  for (uint32_t i = 0; i < num_tris; i++) {
+    for (int j0 = 0; j0 < 3; j0++) {
+      const int j1 = (j0 + 1) % 3;
+      Edge edge{tris[i * 3 + j0], tris[i * 3 + j1]};
+      auto it = result.find(edge);
+      if (it == result.end()) {
+        tri::EdgeTriangles indices{};
+        indices.tis[indices.num_tis++] = i;
+        result[edge] = indices;
+      } else {
+        auto& indices = it->second;
+        assert(indices.num_tis == 1);
+        indices.tis[indices.num_tis++] = i;
+      }
+    }
+  }
+  return result;
+}
+
+tri::EdgeTriangles find_ti_with_edge(const EdgeToIndex& map, uint32_t pia, uint32_t pib) {
+  auto it = map.find(Edge{pia, pib});
+  return it == map.end() ? tri::EdgeTriangles{} : it->second;
+}
+
+uint32_t find_adjacent(const EdgeToIndex& map, uint32_t ti, uint32_t ia, uint32_t ib) {
+  auto indices = find_ti_with_edge(map, ia, ib);
+  for (uint8_t i = 0; i < indices.num_tis; i++) {
+    if (indices.tis[i] != ti) {
+      return indices.tis[i];
+    }
+  }
+  return tri::no_adjacent_triangle();
+}
+
+} //  legacy
+
+struct Query {
+  uint32_t ti;
+  uint32_t ia;
+  uint32_t ib;
+};
+
+//  Mostly edges of the queried triangle, as when walking across a mesh, plus arbitrary vertex
+//  pairs that usually are not edges.
+std::vector<Query> make_queries(const std::vector<uint32_t>& tris, uint32_t num_verts,
+                                uint32_t num_queries, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  const auto num_tris = uint32_t(tris.size() / 3);
+  std::vector<Query> result(num_queries);
+  for (auto& q : result) {
+    q.ti = uint32_t(gen() % num_tris);
+    if (gen() % 8 == 0) {
+      q.ia = uint32_t(gen() % num_verts);
+      q.ib = uint32_t(gen() % num_verts);
+    } else {
+      const auto k = uint32_t(gen() % 3);
+      q.ia = tris[q.ti * 3 + k];
+      q.ib = tris[q.ti * 3 + (k + 1) % 3];
+      if (gen() % 2) {
+        std::swap(q.ia, q.ib);
+      }
+    }
+  }
+  return result;
+}
+
+} //  anon
+
+int main(int, char**) {
+  auto tris = make_grid_tris(Config::grid_dim);
+  const auto num_tris = uint32_t(tris.size() / 3);
+  const uint32_t num_verts = (Config::grid_dim + 1) * (Config::grid_dim + 1);
+  auto queries = make_queries(tris, num_verts, Config::num_queries, 1);
+
+  legacy::EdgeToIndex legacy_map;
+  tri::HalfEdges edges;
+  const double legacy_build_ms = time_ms([&]() {
+    legacy_map = legacy::build_edge_to_index_map(tris.data(), num_tris);
+  });
+  const double build_ms = time_ms([&]() {
+    edges = tri::build_half_edges(tris.data(), num_tris);
+  });
+
+  std::vector<uint32_t> legacy_adjacent(queries.size());
+  std::vector<uint32_t> adjacent(queries.size());
+  const double legacy_query_ms = time_ms([&]() {
+    for (size_t i = 0; i < queries.size(); i++) {
+      auto& q = queries[i];
+      legacy_adjacent[i] = legacy::find_adjacent(legacy_map, q.ti, q.ia, q.ib);
+    }
+  });
+  const double query_ms = time_ms([&]() {
+    for (size_t i = 0; i < queries.size(); i++) {
+      auto& q = queries[i];
+      adjacent[i] = tri::find_adjacent(edges, q.ti, q.ia, q.ib);
+    }
+  });
+
+  uint32_t num_mismatch{};
+  for (size_t i = 0; i < queries.size(); i++) {
+    auto& q = queries[i];
+    num_mismatch += uint32_t(legacy_adjacent[i] != adjacent[i]);
+    auto legacy_tis = legacy::find_ti_with_edge(legacy_map, q.ia, q.ib);
+    auto tis = tri::find_ti_with_edge(edges, q.ia, q.ib);
+    bool same = legacy_tis.num_tis == tis.num_tis;
+    for (uint8_t j = 0; same && j < tis.num_tis; j++) {
+      same = legacy_tis.tis[j] == tis.tis[j];
+    }
+    same = same && bool(tri::has_edge_order_independent(edges, q.ia, q.ib)) == (tis.num_tis > 0);
+    num_mismatch += uint32_t(!same);
+  }
+
+  std::cout << num_tris << " triangles; build legacy: " << legacy_build_ms << "ms"
+            << "; half edges: " << build_ms << "ms" << std::endl;
+  std::cout << queries.size() << " queries; legacy: " << legacy_query_ms << "ms"
+            << "; half edges: " << query_ms << "ms; mismatches: " << num_mismatch << std::endl;
+
+  return num_mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#include "grove/math/obb_batch.hpp"
+#include "grove/math/intersect.hpp"
+#include "grove/math/Octree.hpp"
+#include "grove/math/frame.hpp"
+#include "grove/math/bounds.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr uint32_t num_obbs = 4096;
+  static constexpr uint32_t num_queries = 256;
+  static constexpr uint32_t num_octree_obbs = 50000;
+  static constexpr uint32_t num_octree_queries = 4096;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+//  Randomly oriented boxes in a cube of side `span`, with every 8th box axis-aligned and every
+//  16th box a copy of the previous one, so that exact contact and coincident faces are covered.
+std::vector<OBB3f> make_obbs(uint32_t count, float span, float max_size, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> size_dis(0.05f, 1.0f);
+
+  std::vector<OBB3f> result(count);
+  for (uint32_t i = 0; i < count; i++) {
+    auto& obb = result[i];
+    obb.position = Vec3f{dis(gen), dis(gen), dis(gen)} * span * 0.5f;
+    obb.half_size = Vec3f{size_dis(gen), size_dis(gen), size_dis(gen)} * max_size;
+    if (i % 8 == 0) {
+      obb = OBB3f::axis_aligned(obb.position, obb.half_size);
+    } else {
+      auto up = normalize(Vec3f{dis(gen), dis(gen), dis(gen)});
+      make_coordinate_system_y(up, &obb.i, &obb.j, &obb.k);
+    }
+    if (i % 16 == 1) {
+      obb = result[i - 1];
+    }
+  }
+  return result;
+}
+
+struct Box {
+  OBB3f bounds;
+};
+
+struct BoxTraits {
+  static Bounds3f get_aabb(const Box& box) {
+    return obb3_to_aabb(box.bounds);
+  }
+  static bool active(const Box&) {
+    return true;
+  }
+  static bool data_intersect(const Box& a, const Box& b) {
+    return obb_obb_intersect(a.bounds, b.bounds);
+  }
+  static bool equal(const Box&, const Box&) {
+    return false;
+  }
+  static void deactivate(Box&) {
+    //
+  }
+};
+
+using BoxOctree = Octree<Box, BoxTraits>;
+
+} //  anon
+
+int main(int, char**) {
+  uint32_t num_mismatch{};
+
+  {
+    auto obbs = make_obbs(Config::num_obbs, 16.0f, 1.0f, 1);
+    auto queries = make_obbs(Config::num_queries, 16.0f, 2.0f, 2);
+    OBB3fBatch batch;
+    for (auto& obb : obbs) {
+      batch.push_back(obb);
+    }
+
+    std::vector<std::vector<uint32_t>> scalar_hits(queries.size());
+    const double scalar_ms = time_ms([&]() {
+      for (size_t q = 0; q < queries.size(); q++) {
+        for (uint32_t i = 0; i < uint32_t(obbs.size()); i++) {
+          if (obb_obb_intersect(queries[q], obbs[i])) {
+            scalar_hits[q].push_back(i);
+          }
+        }
+      }
+    });
+
+    std::vector<std::vector<uint32_t>> batch_hits(queries.size());
+    std::vector<uint32_t> hits(batch.size());
+    const double batch_ms = time_ms([&]() {
+      for (size_t q = 0; q < queries.size(); q++) {
+        auto num_hit = obb_obb_intersect(queries[q], batch, hits.data());
+        batch_hits[q].assign(hits.begin(), hits.begin() + num_hit);
+      }
+    });
+
+    size_t num_hit{};
+    for (size_t q = 0; q < queries.size(); q++) {
+      num_mismatch += uint32_t(scalar_hits[q] != batch_hits[q]);
+      num_hit += scalar_hits[q].size();
+    }
+    for (uint32_t i = 0; i < batch.size(); i++) {
+      auto obb = batch.get(i);
+      num_mismatch += uint32_t(std::memcmp(&obb, &obbs[i], sizeof(OBB3f)) != 0);
+    }
+
+    const double num_tests = double(queries.size() * obbs.size());
+    std::cout << queries.size() << " queries x " << obbs.size() << " obbs (" << num_hit
+              << " hit); scalar: " << scalar_ms << "ms (" << scalar_ms * 1e6 / num_tests
+              << "ns/test); batch: " << batch_ms << "ms (" << batch_ms * 1e6 / num_tests
+              << "ns/test)" << std::endl;
+  }
+
+  {
+    auto obbs = make_obbs(Config::num_octree_obbs, 128.0f, 1.0f, 3);
+    auto queries = make_obbs(Config::num_octree_queries, 128.0f, 4.0f, 4);
+    BoxOctree octree{8.0f, 2.0f};
+    for (auto& obb : obbs) {
+      octree.insert(Box{obb});
+    }
+
+    std::vector<const Box*> hit;
+    std::vector<size_t> scalar_offsets;
+    std::vector<const Box*> scalar_hit;
+    const double scalar_ms = time_ms([&]() {
+      for (auto& query : queries) {
+        hit.clear();
+        octree.intersects(Box{query}, hit);
+        scalar_offsets.push_back(scalar_hit.size());
+        scalar_hit.insert(scalar_hit.end(), hit.begin(), hit.end());
+      }
+    });
+
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> hits;
+    OBB3fBatch batch;
+    std::vector<size_t> batch_offsets;
+    std::vector<const Box*> batch_hit;
+    const double batch_ms = time_ms([&]() {
+      for (auto& query : queries) {
+        octree.gather_candidates(obb3_to_aabb(query), candidates);
+        batch.clear();
+        for (uint32_t ci : candidates) {
+          batch.push_back(octree.element(ci).bounds);
+        }
+        hits.resize(candidates.size());
+        const uint32_t num_hit = obb_obb_intersect(query, batch, hits.data());
+        batch_offsets.push_back(batch_hit.size());
+        for (uint32_t i = 0; i < num_hit; i++) {
+          batch_hit.push_back(&octree.element(candidates[hits[i]]));
+        }
+      }
+    });
+
+    num_mismatch += uint32_t(scalar_offsets != batch_offsets);
+    num_mismatch += uint32_t(scalar_hit != batch_hit);
+    std::cout << queries.size() << " octree queries over " << obbs.size() << " obbs ("
+              << scalar_hit.size() << " hit); scalar: " << scalar_ms << "ms; batch: "
+              << batch_ms << "ms" << std::endl;
+  }
+
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+  return num_mismatch == 0 ? 0 : 1;
+}
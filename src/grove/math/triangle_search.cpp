@@ -1,32 +1,84 @@
 #include "triangle_search.hpp"
 #include "triangle.hpp"
 #include "grove/common/common.hpp"
+#include <algorithm>
 #include <cassert>
 
 GROVE_NAMESPACE_BEGIN
 
 namespace {
 
+uint32_t source_vertex(const tri::HalfEdges& edges, uint32_t he) {
+  const uint32_t ti = he / 3;
+  const uint32_t k = he - ti * 3;
+  return edges.targets[ti * 3 + (k == 0 ? 2 : k - 1)];
+}
+
+//  Half-edge from `pia` to `pib` other than `exclude`, or ~0u.
+uint32_t find_half_edge(const tri::HalfEdges& edges, uint32_t pia, uint32_t pib,
+                        uint32_t exclude = tri::no_adjacent_triangle()) {
+  if (pia >= edges.num_vertices()) {
+    return tri::no_adjacent_triangle();
+  }
+  const uint32_t beg = edges.vertex_offsets[pia];
+  const uint32_t end = edges.vertex_offsets[pia + 1];
+  for (uint32_t i = beg; i < end; i++) {
+    const uint32_t he = edges.vertex_half_edges[i];
+    if (edges.targets[he] == pib && he != exclude) {
+      return he;
+    }
+  }
+  return tri::no_adjacent_triangle();
+}
+
 template <typename I>
-tri::EdgeToIndex<uint32_t> build_edge_to_index_map(const I* tris, uint32_t num_tris) {
-  using Edge = tri::EdgeToIndex<uint32_t>::Edge;
-  using Indices = tri::EdgeToIndex<uint32_t>::Indices;
-
-  tri::EdgeToIndex<uint32_t> result;
-  for (uint32_t i = 0; i < num_tris; i++) {
-    for (int j0 = 0; j0 < 3; j0++) {
-      const int j1 = (j0 + 1) % 3;
-      Edge edge{tris[i * 3 + j0], tris[i * 3 + j1]};
-      auto it = result.map.find(edge);
-      if (it == result.map.end()) {
-        Indices indices{};
-        indices.tis[indices.num_tis++] = i;
-        result.map[edge] = indices;
-      } else {
-        auto& indices = it->second;
-        assert(indices.num_tis == 1);
-        indices.tis[indices.num_tis++] = i;
-      }
+tri::HalfEdges build_half_edges(const I* tris, uint32_t num_tris) {
+  tri::HalfEdges result;
+  const uint32_t num_half_edges = num_tris * 3;
+  result.targets.resize(num_half_edges);
+  result.twins.resize(num_half_edges, tri::no_adjacent_triangle());
+
+  uint32_t num_verts{};
+  for (uint32_t i = 0; i < num_half_edges; i++) {
+    num_verts = std::max(num_verts, uint32_t(tris[i]) + 1);
+  }
+
+  //  Group half-edges by source vertex.
+  result.vertex_offsets.resize(num_verts + 1);
+  for (uint32_t i = 0; i < num_half_edges; i++) {
+    result.vertex_offsets[tris[i] + 1]++;
+  }
+  for (uint32_t i = 0; i < num_verts; i++) {
+    result.vertex_offsets[i + 1] += result.vertex_offsets[i];
+  }
+  result.vertex_half_edges.resize(num_half_edges);
+  std::vector<uint32_t> fill(result.vertex_offsets.begin(), result.vertex_offsets.end() - 1);
+  for (uint32_t ti = 0; ti < num_tris; ti++) {
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t he = ti * 3 + k;
+      result.targets[he] = tris[ti * 3 + (k + 1) % 3];
+      result.vertex_half_edges[fill[tris[he]]++] = he;
+    }
+  }
+
+  for (uint32_t he = 0; he < num_half_edges; he++) {
+    if (result.twins[he] != tri::no_adjacent_triangle()) {
+      continue;
+    }
+    const uint32_t pia = tris[he];
+    const uint32_t pib = result.targets[he];
+    uint32_t twin = find_half_edge(result, pib, pia);
+    if (twin == tri::no_adjacent_triangle()) {
+      //  Neighbor with inconsistent winding.
+      twin = find_half_edge(result, pia, pib, he);
+    }
+    const bool pair = twin != tri::no_adjacent_triangle() &&
+                      result.twins[twin] == tri::no_adjacent_triangle();
+    //  Edges shared by more than two triangles keep the first pairing.
+    assert(twin == tri::no_adjacent_triangle() || pair);
+    if (pair) {
+      result.twins[he] = twin;
+      result.twins[twin] = he;
     }
   }
 
@@ -35,40 +87,56 @@ tri::EdgeToIndex<uint32_t> build_edge_to_index_map(const I* tris, uint32_t num_t
 
 } //  anon
 
-tri::EdgeToIndex<uint32_t> tri::build_edge_to_index_map(const uint16_t* tris, uint32_t num_tris) {
-  return grove::build_edge_to_index_map<uint16_t>(tris, num_tris);
+tri::HalfEdges tri::build_half_edges(const uint16_t* tris, uint32_t num_tris) {
+  return grove::build_half_edges<uint16_t>(tris, num_tris);
 }
 
-tri::EdgeToIndex<uint32_t> tri::build_edge_to_index_map(const uint32_t* tris, uint32_t num_tris) {
-  return grove::build_edge_to_index_map<uint32_t>(tris, num_tris);
+tri::HalfEdges tri::build_half_edges(const uint32_t* tris, uint32_t num_tris) {
+  return grove::build_half_edges<uint32_t>(tris, num_tris);
 }
 
-tri::EdgeToIndex<uint32_t>::Indices tri::find_ti_with_edge(const EdgeToIndex<uint32_t>& map,
-                                                           uint32_t pia, uint32_t pib) {
-  tri::EdgeToIndex<uint32_t>::Edge edge{pia, pib};
-  auto it = map.map.find(edge);
-  if (it == map.map.end()) {
-    return {};
-  } else {
-    return it->second;
+tri::EdgeTriangles tri::find_ti_with_edge(const HalfEdges& edges, uint32_t pia, uint32_t pib) {
+  EdgeTriangles result{};
+  uint32_t he = find_half_edge(edges, pia, pib);
+  if (he == no_adjacent_triangle()) {
+    he = find_half_edge(edges, pib, pia);
+  }
+  if (he != no_adjacent_triangle()) {
+    result.tis[result.num_tis++] = he / 3;
+    if (edges.twins[he] != no_adjacent_triangle()) {
+      result.tis[result.num_tis++] = edges.twins[he] / 3;
+      if (result.tis[1] < result.tis[0]) {
+        std::swap(result.tis[0], result.tis[1]);
+      }
+    }
   }
+  return result;
 }
 
-uint32_t tri::has_edge_order_independent(const EdgeToIndex<uint32_t>& map,
-                                         uint32_t pia, uint32_t pib) {
-  tri::EdgeToIndex<uint32_t>::Edge edge{pia, pib};
-  return map.map.count(edge) > 0;
+uint32_t tri::has_edge_order_independent(const HalfEdges& edges, uint32_t pia, uint32_t pib) {
+  return find_half_edge(edges, pia, pib) != no_adjacent_triangle() ||
+         find_half_edge(edges, pib, pia) != no_adjacent_triangle();
 }
 
-uint32_t tri::find_adjacent(const EdgeToIndex<uint32_t>& map, uint32_t ti, uint32_t ia, uint32_t ib) {
-  auto indices = find_ti_with_edge(map, ia, ib);
+uint32_t tri::find_adjacent(const HalfEdges& edges, uint32_t ti, uint32_t ia, uint32_t ib) {
+  if (ti < edges.num_triangles()) {
+    for (uint32_t k = 0; k < 3; k++) {
+      const uint32_t he = ti * 3 + k;
+      const uint32_t src = source_vertex(edges, he);
+      const uint32_t dst = edges.targets[he];
+      if ((src == ia && dst == ib) || (src == ib && dst == ia)) {
+        const uint32_t twin = edges.twins[he];
+        return twin == no_adjacent_triangle() ? no_adjacent_triangle() : twin / 3;
+      }
+    }
+  }
+  auto indices = find_ti_with_edge(edges, ia, ib);
   for (uint8_t i = 0; i < indices.num_tis; i++) {
     if (indices.tis[i] != ti) {
       return indices.tis[i];
     }
   }
-  return tri::no_adjacent_triangle();
+  return no_adjacent_triangle();
 }
 
 GROVE_NAMESPACE_END
-
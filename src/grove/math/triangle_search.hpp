@@ -1,43 +1,45 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 namespace grove::tri {
 
-template <typename T>
-struct EdgeToIndex {
-  struct Edge {
-    T i0;
-    T i1;
-  };
-
-  struct HashEdge {
-    std::size_t operator()(const Edge& edge) const noexcept {
-      return std::hash<T>{}(edge.i0) ^ std::hash<T>{}(edge.i1);
-    }
-  };
-
-  struct EqualEdge {
-    bool operator()(const Edge& a, const Edge& b) const noexcept {
-      return (a.i0 == b.i0 && a.i1 == b.i1) || (a.i0 == b.i1 && a.i1 == b.i0);
-    }
-  };
-
-  struct Indices {
-    T tis[2];
-    uint8_t num_tis;
-  };
-
-  std::unordered_map<Edge, Indices, HashEdge, EqualEdge> map;
+/*
+ * HalfEdges
+ *
+ * Flat half-edge adjacency of an indexed triangle mesh. Half-edge `3 * ti + k` runs from vertex
+ * `k` to vertex `(k + 1) % 3` of triangle `ti`, and `targets` holds its end vertex. `twins` holds
+ * the other half-edge on the same edge, in either direction, or `~0u` on a boundary. The
+ * half-edges leaving vertex `vi` are `vertex_half_edges[vertex_offsets[vi]]` up to
+ * `vertex_half_edges[vertex_offsets[vi + 1]]`.
+ */
+struct HalfEdges {
+  uint32_t num_triangles() const {
+    return uint32_t(targets.size() / 3);
+  }
+  uint32_t num_vertices() const {
+    return vertex_offsets.empty() ? 0 : uint32_t(vertex_offsets.size() - 1);
+  }
+
+  std::vector<uint32_t> targets;
+  std::vector<uint32_t> twins;
+  std::vector<uint32_t> vertex_offsets;
+  std::vector<uint32_t> vertex_half_edges;
 };
 
-EdgeToIndex<uint32_t> build_edge_to_index_map(const uint16_t* tris, uint32_t num_tris);
-EdgeToIndex<uint32_t> build_edge_to_index_map(const uint32_t* tris, uint32_t num_tris);
+struct EdgeTriangles {
+  uint32_t tis[2];
+  uint8_t num_tis;
+};
+
+HalfEdges build_half_edges(const uint16_t* tris, uint32_t num_tris);
+HalfEdges build_half_edges(const uint32_t* tris, uint32_t num_tris);
 //  Find triangle adjacent to `ti` by edge with vertex indices `pia` and `pib`
-uint32_t find_adjacent(const EdgeToIndex<uint32_t>& map, uint32_t ti, uint32_t pia, uint32_t pib);
-uint32_t has_edge_order_independent(const EdgeToIndex<uint32_t>& map, uint32_t pia, uint32_t pib);
+uint32_t find_adjacent(const HalfEdges& edges, uint32_t ti, uint32_t pia, uint32_t pib);
+uint32_t has_edge_order_independent(const HalfEdges& edges, uint32_t pia, uint32_t pib);
 
-EdgeToIndex<uint32_t>::Indices find_ti_with_edge(const EdgeToIndex<uint32_t>& map,
-                                                 uint32_t pia, uint32_t pib);
+//  Triangles with the edge joining `pia` and `pib`, in either direction.
+EdgeTriangles find_ti_with_edge(const HalfEdges& edges, uint32_t pia, uint32_t pib);
 
-}
\ No newline at end of file
+}
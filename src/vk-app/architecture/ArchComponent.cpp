@@ -345,7 +345,7 @@ void update_pending_projection_onto_structure(
       auto vine_inst = tree::create_vine_instance(info.vine_system, radius);
       auto vine_seg = tree::emplace_vine_from_internodes(
         info.vine_system, info.render_vine_system, vine_inst,
-        inodes.data(), mesh_ns.data(), int(inodes.size()));
+        inodes.data(), mesh_ns.data(), int(inodes.size()), info.task_pool);
 
       const int tip_ind = tree::axis_tip_index(inodes, 0);
       assert(tip_ind >= 0 && tip_ind < int(mesh_ns.size()));
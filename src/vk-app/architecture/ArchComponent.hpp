@@ -6,6 +6,7 @@ template <typename T>
 struct OBB3;
 
 struct Ray;
+class TaskPool;
 
 namespace tree {
 struct TreeSystem;
@@ -49,6 +50,7 @@ struct ArchComponentUpdateInfo {
   bool left_clicked;
   const tree::Internode* proj_internodes;
   int num_proj_internodes;
+  TaskPool* task_pool;
 };
 
 struct ArchComponentParams {
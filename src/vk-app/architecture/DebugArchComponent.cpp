@@ -97,6 +97,7 @@ struct StructureGeometry {
 
   std::vector<Vec3f> aggregate_geometry;
   std::vector<uint16_t> aggregate_triangles;
+  bvh::TriangleBVH aggregate_bvh;
   std::vector<Vec3f> growing_geometry_src;
   std::vector<Vec3f> growing_geometry_dst;
   std::vector<uint32_t> growing_triangles_src;
@@ -426,6 +427,7 @@ size_t growing_geometry_dst_size(const StructureGeometry* geom) {
 void reset_structure_geometry(StructureGeometry* geom) {
   geom->aggregate_geometry.clear();
   geom->aggregate_triangles.clear();
+  geom->aggregate_bvh = {};
   geom->growing_geometry_src.clear();
   geom->growing_geometry_dst.clear();
   geom->growing_triangles_src.clear();
@@ -866,7 +868,7 @@ void push_face_connector_edge_indices(const arch::FaceConnectorIndices& i0, uint
 void push_mutual_non_adjacent_connections_y(ray_project::NonAdjacentConnections* connections,
                                             const std::vector<uint32_t>& i0,
                                             const std::vector<uint32_t>& i1,
-                                            const tri::EdgeToIndex<uint32_t>& edge_indices,
+                                            const tri::HalfEdges& edge_indices,
                                             const void* data, uint32_t stride,
                                             uint32_t p_off, float tol) {
   constexpr int axis = 1;
@@ -912,6 +914,7 @@ DebugComputeWallGeometryResult compute_wall_geometry(DebugArchComponent& compone
   auto& params = component.params;
   auto& wall_holes = component.wall_holes;
   auto& store_wall_hole_res = component.store_wall_hole_result;
+  auto& store_wall_hole_bvh = component.store_wall_hole_bvh;
 #if 0
   place_walls_on_grid(*this);
 #else
@@ -1010,6 +1013,9 @@ DebugComputeWallGeometryResult compute_wall_geometry(DebugArchComponent& compone
         uint32_t i3[3]{wall_tris[i * 3], wall_tris[i * 3 + 1], wall_tris[i * 3 + 2]};
         memcpy(t.i, i3, 3 * sizeof(uint32_t));
       }
+      store_wall_hole_bvh = bvh::build_triangle_bvh(
+        cdt::unsafe_cast_to_uint32(store_wall_hole_res.triangles.data()),
+        uint32_t(store_wall_hole_res.triangles.size()), store_wall_hole_res.positions.data());
     }
 #endif
 #if 1 //  add curved segments
@@ -1171,7 +1177,7 @@ DebugComputeWallGeometryResult compute_wall_geometry(DebugArchComponent& compone
 #endif
 
   ray_project::NonAdjacentConnections non_adjacent_connections;
-  auto edge_indices = tri::build_edge_to_index_map(wall_tris.data(), uint32_t(wall_tris.size()/3));
+  auto edge_indices = tri::build_half_edges(wall_tris.data(), uint32_t(wall_tris.size()/3));
   const float non_adj_eps = 1e-3f;
 //  const float non_adj_eps = 2.0f;
   for (uint32_t i = 1; i < wall_i; i++) {
@@ -1218,6 +1224,9 @@ DebugComputeWallGeometryResult compute_wall_geometry(DebugArchComponent& compone
     uint32_t i3[3]{wall_tris[i * 3], wall_tris[i * 3 + 1], wall_tris[i * 3 + 2]};
     memcpy(t.i, i3, 3 * sizeof(uint32_t));
   }
+  store_wall_hole_bvh = bvh::build_triangle_bvh(
+    cdt::unsafe_cast_to_uint32(store_wall_hole_res.triangles.data()),
+    uint32_t(store_wall_hole_res.triangles.size()), store_wall_hole_res.positions.data());
 #endif
 
   DebugComputeWallGeometryResult result;
@@ -1324,6 +1333,9 @@ void append_grown_geometry(StructureGeometry* geom) {
     dsti[orig_tri_size + ind] = uint16_t(pi);
     ind++;
   }
+
+  geom->aggregate_bvh = bvh::build_triangle_bvh(
+    dsti.data(), geom->num_aggregate_triangles(), dst.data(), 2);
 }
 
 void initialize_triangle_growth(StructureGeometry* geom,
@@ -2270,7 +2282,7 @@ void maybe_connect_non_adjacent_structure_pieces(SegmentedStructure* structure)
   const auto vert_stride = uint32_t(structure->geometry.aggregate_geometry_vertex_stride_bytes());
 
   auto* connections = &structure->non_adjacent_connections;
-  auto edge_indices = tri::build_edge_to_index_map(
+  auto edge_indices = tri::build_half_edges(
     tris.data(), structure->geometry.num_aggregate_triangles());
 
   std::vector<uint32_t> posi(compute_num_non_adjacent_edge_indices(prev_pos, 0));
@@ -2313,19 +2325,15 @@ void maybe_connect_non_adjacent_structure_pieces(SegmentedStructure* structure)
 }
 
 Optional<uint32_t> pick_growing_structure_triangle(const StructureGeometry& geom, const Ray& ray) {
-  size_t hit_tri{};
+  uint32_t hit_tri{};
   float hit_t{};
-  bool any_hit = ray_triangle_intersect(
-    ray,
-    geom.aggregate_geometry.data(),
-    geom.aggregate_geometry_vertex_stride_bytes(),
-    0,
+  bool any_hit = bvh::ray_intersect(
+    geom.aggregate_bvh,
     geom.aggregate_triangles.data(),
-    geom.num_aggregate_triangles(),
-    0,
-    nullptr, &hit_tri, &hit_t);
+    geom.aggregate_geometry.data(),
+    ray, &hit_tri, &hit_t);
   if (any_hit) {
-    return Optional<uint32_t>(uint32_t(hit_tri));
+    return Optional<uint32_t>(hit_tri);
   } else {
     return NullOpt{};
   }
@@ -2334,18 +2342,15 @@ Optional<uint32_t> pick_growing_structure_triangle(const StructureGeometry& geom
 Optional<uint32_t>
 pick_debug_structure_triangle(const DebugArchComponent& component, const Ray& ray) {
   const auto& geom = component.store_wall_hole_result;
-  size_t hit_tri{};
+  uint32_t hit_tri{};
   float hit_t{};
-  bool any_hit = ray_triangle_intersect(
-    ray,
-    geom.positions.data(),
-    sizeof(Vec3f),
-    0,
+  bool any_hit = bvh::ray_intersect(
+    component.store_wall_hole_bvh,
     cdt::unsafe_cast_to_uint32(geom.triangles.data()),
-    geom.triangles.size(),
-    0, nullptr, &hit_tri, &hit_t);
+    geom.positions.data(),
+    ray, &hit_tri, &hit_t);
   if (any_hit) {
-    return Optional<uint32_t>(uint32_t(hit_tri));
+    return Optional<uint32_t>(hit_tri);
   } else {
     return NullOpt{};
   }
@@ -2897,7 +2902,7 @@ DebugNodeProjectResult debug_project_internodes_onto_mesh(const DebugArchCompone
   auto& proj_ps = store_wall_hole_result.positions;
   uint32_t* proj_tri_u32 = cdt::unsafe_cast_to_uint32(proj_tris.data());
   tri::require_ccw(proj_tri_u32, uint32_t(proj_tris.size()), proj_ps.data());
-  auto edge_indices = tri::build_edge_to_index_map(proj_tri_u32, uint32_t(proj_tris.size()));
+  auto edge_indices = tri::build_half_edges(proj_tri_u32, uint32_t(proj_tris.size()));
   auto* non_adjacent_connections = &component.debug_non_adjacent_connections;
 
   tree::Internodes alt_internodes;
@@ -3010,7 +3015,7 @@ void project_internodes_onto_structure(DebugArchComponent& component,
     len_scale = piece.bounds.half_size.y / 8.0f;
   }
 
-  auto edge_indices = tri::build_edge_to_index_map(tris.data(), num_tris);
+  auto edge_indices = tri::build_half_edges(tris.data(), num_tris);
   tree::ProjectNodesOntoMeshParams proj_params{};
   proj_params.tris = tris.data();
   proj_params.num_tris = num_tris;
@@ -14,6 +14,7 @@
 #include "grid.hpp"
 #include "structure_growth.hpp"
 #include "grove/math/OBB3.hpp"
+#include "grove/math/bvh.hpp"
 #include "grove/common/Stopwatch.hpp"
 
 namespace grove {
@@ -223,6 +224,7 @@ public:
   bool need_pick_debug_structure_triangle{};
   arch::GridCache grid_cache;
   arch::WallHoleResult store_wall_hole_result;
+  bvh::TriangleBVH store_wall_hole_bvh;
   Params params;
   tree::Internodes src_tree_internodes;
   tree::Internodes src_tree_internodes1;
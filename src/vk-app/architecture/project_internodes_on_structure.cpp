@@ -50,7 +50,7 @@ find_piece(const std::vector<StructureGeometryPiece>& pieces, StructureGeometryP
 }
 
 void build_tri_edge_index_map(ProjectInternodesOnStructureContext& ctx) {
-  ctx.edge_index_map = tri::build_edge_to_index_map(ctx.tris.data(), uint32_t(ctx.tris.size() / 3));
+  ctx.edge_index_map = tri::build_half_edges(ctx.tris.data(), uint32_t(ctx.tris.size() / 3));
 }
 
 void build_non_adjacent_connections(ProjectInternodesOnStructureContext& ctx) {
@@ -23,7 +23,7 @@ struct ProjectInternodesOnStructureContext {
   std::vector<Vec3f> ps;
   std::vector<Vec3f> ns;
   ray_project::NonAdjacentConnections non_adjacent_connections;
-  tri::EdgeToIndex<uint32_t> edge_index_map;
+  tri::HalfEdges edge_index_map;
 
   uint32_t initial_proj_ti;
   double ray_theta_offset;
@@ -251,31 +251,8 @@ auto maybe_traverse_to_non_adjacent(const NonAdjacentConnections* non_adjacent,
   return result;
 }
 
-uint32_t adjacent_triangle(const uint32_t* tris, uint32_t num_tris, uint32_t ti, const Edge& edge) {
-  assert(edge.i0 != edge.i1);
-  for (uint32_t i = 0; i < num_tris; i++) {
-    if (i != ti) {
-      uint32_t match_count{};
-      for (uint32_t j = 0; j < 3; j++) {
-        uint32_t ind = tris[i * 3 + j];
-        if (edge.i0 == ind) {
-          match_count++;
-        }
-        if (edge.i1 == ind) {
-          match_count++;
-        }
-      }
-      if (match_count == 2) {
-        return i;
-      }
-    }
-  }
-  return tri::no_adjacent_triangle();
-}
-
-auto find_next_triangle(uint32_t ti, Edge adj_edge, double rt,
-                        const uint32_t* tris, uint32_t num_tris, const Vec3f* ps,
-                        const ProjectRayEdgeIndices* edge_indices,
+auto find_next_triangle(uint32_t ti, Edge adj_edge, double rt, const Vec3f* ps,
+                        const ProjectRayEdgeIndices& edge_indices,
                         const NonAdjacentConnections* non_adjacent) {
   struct Result {
     double rt;
@@ -285,15 +262,8 @@ auto find_next_triangle(uint32_t ti, Edge adj_edge, double rt,
 
   Result result{};
 
-  uint32_t adj_ti;
-  if (edge_indices) {
-    adj_ti = tri::find_adjacent(*edge_indices, ti, adj_edge.i0, adj_edge.i1);
-#ifdef GROVE_DEBUG
-    assert(adj_ti == adjacent_triangle(tris, num_tris, ti, adj_edge));
-#endif
-  } else {
-    adj_ti = adjacent_triangle(tris, num_tris, ti, adj_edge);
-  }
+  assert(adj_edge.i0 != adj_edge.i1);
+  uint32_t adj_ti = tri::find_adjacent(edge_indices, ti, adj_edge.i0, adj_edge.i1);
 
   if (non_adjacent && adj_ti == tri::no_adjacent_triangle()) {
     auto adj_res = maybe_traverse_to_non_adjacent(non_adjacent, ti, adj_edge, ps, rt);
@@ -379,6 +349,13 @@ ProjectRayResult project_ray_onto_mesh(const uint32_t* tris, uint32_t num_tris,
   uint32_t ti = src_ti;
   double remaining_len = ray_len;
 
+  //  Without precomputed adjacency, build it once instead of searching every triangle per step.
+  ProjectRayEdgeIndices tmp_edge_indices;
+  if (!edge_indices) {
+    tmp_edge_indices = tri::build_half_edges(tris, num_tris);
+    edge_indices = &tmp_edge_indices;
+  }
+
   ProjectRayResult result{};
   bool required_flip = false;
   uint32_t iter{};
@@ -437,8 +414,7 @@ ProjectRayResult project_ray_onto_mesh(const uint32_t* tris, uint32_t num_tris,
       entry_p, edge_isect.exit_p, ti, tri, ray_theta, required_flip));
 
     const auto next_tri = find_next_triangle(
-      ti, edge_isect.adj_edge, edge_isect.exit_t,
-      tris, num_tris, ps, edge_indices, non_adjacent_connections);
+      ti, edge_isect.adj_edge, edge_isect.exit_t, ps, *edge_indices, non_adjacent_connections);
 
     const uint32_t adj_ti = next_tri.adj_ti;
     const Edge adj_edge = next_tri.adj_edge;
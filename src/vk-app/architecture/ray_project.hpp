@@ -11,7 +11,7 @@ namespace ray_project {
 struct NonAdjacentConnections;
 }
 
-using ProjectRayEdgeIndices = tri::EdgeToIndex<uint32_t>;
+using ProjectRayEdgeIndices = tri::HalfEdges;
 
 struct ProjectRayResultEntry {
   Vec3<double> entry_p;
@@ -100,7 +100,7 @@ ray_project::find_non_adjacent_connections(const NonAdjacentConnections* connect
 void ray_project::push_axis_aligned_non_adjacent_connections(NonAdjacentConnections* connections,
                                                              const uint32_t* i0, uint32_t i0_size,
                                                              const uint32_t* i1, uint32_t i1_size,
-                                                             const tri::EdgeToIndex<uint32_t>& edge_indices,
+                                                             const tri::HalfEdges& edge_indices,
                                                              const void* vertices,
                                                              uint32_t stride, uint32_t p_off,
                                                              float tol, int axis) {
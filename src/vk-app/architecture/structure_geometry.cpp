@@ -201,6 +201,11 @@ void add_index_offset(StructureGeometry* geom, uint32_t beg, uint32_t end, uint3
   }
 }
 
+void rebuild_bvh(StructureGeometry* geom) {
+  geom->bvh = bvh::build_triangle_bvh(
+    geom->triangles.data(), geom->num_triangles(), geom->geometry.data(), 2);
+}
+
 const StructureGeometryPiece* find_piece(const StructureGeometry& geom,
                                          StructureGeometryPieceHandle handle) {
   for (auto& piece : geom.pieces) {
@@ -218,13 +223,10 @@ struct {
 } //  anon
 
 Optional<uint32_t> arch::StructureGeometry::ray_intersect(const Ray& ray) const {
-  size_t hit_tri{};
+  uint32_t hit_tri{};
   float hit_t{};
-  bool any_hit = ray_triangle_intersect(
-    ray, geometry.data(), vertex_stride_bytes(), 0,
-    triangles.data(), num_triangles(), 0, nullptr, &hit_tri, &hit_t);
-  if (any_hit) {
-    return Optional<uint32_t>(uint32_t(hit_tri));
+  if (bvh::ray_intersect(bvh, triangles.data(), geometry.data(), ray, &hit_tri, &hit_t)) {
+    return Optional<uint32_t>(hit_tri);
   } else {
     return NullOpt{};
   }
@@ -359,6 +361,7 @@ StructureGeometryPieceHandle arch::extrude_wall(
   next_piece.curved_connector_positive_x = curved_connector_positive_x;
   next_piece.curved_connector_negative_x = curved_connector_negative_x;
   next_piece.curved_connector_xi = curved_connector_xi;
+  rebuild_bvh(structure);
   return next_piece.handle;
 }
 
@@ -380,7 +383,7 @@ void push_face_connector_edge_indices(const arch::FaceConnectorIndices& i0, uint
 void push_mutual_non_adjacent_connections_y(ray_project::NonAdjacentConnections* connections,
                                             const std::vector<uint32_t>& i0,
                                             const std::vector<uint32_t>& i1,
-                                            const tri::EdgeToIndex<uint32_t>& edge_indices,
+                                            const tri::HalfEdges& edge_indices,
                                             const void* data, uint32_t stride,
                                             uint32_t p_off, float tol) {
   constexpr int axis = 1;
@@ -403,7 +406,7 @@ void push_mutual_non_adjacent_connections_y(ray_project::NonAdjacentConnections*
 bool arch::try_connect_non_adjacent_structure_pieces(
   const std::vector<Vec3f>& geom,
   bool geom_is_interleaved,
-  const tri::EdgeToIndex<uint32_t>& edge_indices,
+  const tri::HalfEdges& edge_indices,
   const StructureGeometryPiece& prev, const StructureGeometryPiece& curr,
   ray_project::NonAdjacentConnections* connections) {
   //
@@ -554,6 +557,7 @@ void arch::remove_last_piece(StructureGeometry* geom) {
   uint32_t new_ni = (geom->num_triangles() - piece.num_triangles) * 3;
   geom->geometry.resize(new_np * 2);
   geom->triangles.resize(new_ni);
+  rebuild_bvh(geom);
 }
 
 GROVE_NAMESPACE_END
@@ -4,14 +4,14 @@
 #include "grove/common/identifier.hpp"
 #include "grove/common/Optional.hpp"
 #include "grove/math/OBB3.hpp"
+#include "grove/math/bvh.hpp"
 
 namespace grove {
 struct Ray;
 }
 
 namespace grove::tri {
-template <typename T>
-struct EdgeToIndex;
+struct HalfEdges;
 }
 
 namespace grove::ray_project {
@@ -53,6 +53,8 @@ struct StructureGeometry {
   std::vector<StructureGeometryPiece> pieces;
   std::vector<Vec3f> geometry;
   std::vector<uint32_t> triangles;
+  //  Rebuilt whenever a piece is added or removed.
+  bvh::TriangleBVH bvh;
 };
 
 struct GrowingStructureGeometry {
@@ -75,7 +77,7 @@ StructureGeometryPieceHandle extrude_wall(
 bool try_connect_non_adjacent_structure_pieces(
   const std::vector<Vec3f>& geometry,
   bool interleaved_geometry,  //  true if geometry is position + normal + ... ; false if geometry is positions only
-  const tri::EdgeToIndex<uint32_t>& tri_edge_indices,
+  const tri::HalfEdges& tri_edge_indices,
   const StructureGeometryPiece& prev, const StructureGeometryPiece& curr,
   ray_project::NonAdjacentConnections* connects);
 
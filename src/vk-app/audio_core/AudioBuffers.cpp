@@ -59,4 +59,8 @@ const char** AudioBuffers::addtl_audio_buffer_file_names_no_max_norm(int* count)
   return files;
 }
 
+const char* AudioBuffers::convolution_reverb_ir_file_name() {
+  return "convolution_reverb_ir.wav";
+}
+
 GROVE_NAMESPACE_END
@@ -24,6 +24,9 @@ public:
   static std::string audio_buffer_full_path(const char* file);
   static std::vector<std::string> default_audio_buffer_file_names();
   static const char** addtl_audio_buffer_file_names_no_max_norm(int* count);
+  //  Impulse response of ConvolutionReverbNode. If the file is absent from the asset directory,
+  //  a synthetic IR is registered under this name instead.
+  static const char* convolution_reverb_ir_file_name();
 
 private:
   std::vector<Buffer> audio_buffer_handles;
@@ -1,5 +1,6 @@
 #include "AudioComponent.hpp"
 #include "UITrackSystem.hpp"
+#include "../audio_processors/ConvolutionReverbNode.hpp"
 #include "grove/audio/audio_config.hpp"
 #include "grove/audio/io.hpp"
 #include "grove/audio/AudioRenderBufferSystem.hpp"
@@ -46,6 +47,21 @@ void initialize_audio_buffer_store(AudioComponent& component) {
   for (int i = 0; i < num_no_max_norm; i++) {
     (void) component.simple_load_wav_audio_buffer(files[i]);
   }
+
+  const char* ir_file = AudioBuffers::convolution_reverb_ir_file_name();
+  if (!component.simple_load_wav_audio_buffer(ir_file)) {
+    const double rt60_s = 2.5;
+    auto ir = ConvolutionReverbNode::make_synthetic_impulse_response(
+      default_sample_rate(), rt60_s);
+
+    audio::PendingAudioBufferAvailable pend{};
+    pend.descriptor = ir.descriptor;
+    pend.data = std::move(ir.data);
+    pend.callback = [ir_file, buffs = &component.audio_buffers](AudioBufferHandle handle) {
+      buffs->push(ir_file, handle);
+    };
+    component.add_pending_audio_buffer(std::move(pend));
+  }
 }
 
 bool record_state_transition(AudioComponent& component,
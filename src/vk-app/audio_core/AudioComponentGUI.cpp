@@ -53,6 +53,15 @@ void try_to_load_wav_audio_buffer(AudioComponent& component, const char* file_pa
   }
 }
 
+void try_to_stream_wav_audio_buffer(AudioComponent& component, const char* file_path) {
+  auto full_path = AudioBuffers::audio_buffer_full_path(file_path);
+  if (auto fut = component.get_audio_buffer_store()->ui_add_streaming(full_path)) {
+    component.ui_audio_buffer_store.on_buffer_available(std::move(fut));
+  } else {
+    GROVE_LOG_ERROR_CAPTURE_META("Failed to open wav file for streaming.", logging_id());
+  }
+}
+
 } //  anon
 
 AudioComponentGUI::UpdateResult
@@ -170,6 +179,16 @@ AudioComponentGUI::render_gui(AudioComponent& component,
     try_to_load_wav_audio_buffer(component, text_buffer);
   }
 
+  memset(text_buffer, 0, 1024);
+  if (ImGui::InputText("StreamWav", text_buffer, 1024, enter_flag)) {
+    try_to_stream_wav_audio_buffer(component, text_buffer);
+  }
+
+  auto stream_stats = component.get_audio_buffer_store()->ui_get_streaming_stats();
+  ImGui::Text("Streamed buffers: %d; Chunks loaded: %d; Misses: %d",
+              stream_stats.num_streams, int(stream_stats.num_chunks_loaded),
+              int(stream_stats.num_misses));
+
   if (ImGui::Button("Close")) {
     result.close_window = true;
   }
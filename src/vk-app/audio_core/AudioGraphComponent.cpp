@@ -1,9 +1,20 @@
 #include "AudioGraphComponent.hpp"
 #include "grove/audio/audio_config.hpp"
 #include "grove/common/common.hpp"
+#include <thread>
 
 GROVE_NAMESPACE_BEGIN
 
+namespace {
+
+int num_parallel_render_worker_threads() {
+  //  Leave one core for the ui thread, and one for the render thread itself.
+  const int num_cores = int(std::thread::hardware_concurrency());
+  return std::max(1, num_cores - 2);
+}
+
+} //  anon
+
 AudioGraphComponent::InitResult AudioGraphComponent::initialize() {
   InitResult result;
   result.render_modifications.push_back(
@@ -11,8 +22,29 @@ AudioGraphComponent::InitResult AudioGraphComponent::initialize() {
   return result;
 }
 
+void AudioGraphComponent::set_parallel_render_enabled(bool enable) {
+  if (enable && !parallel_render_initialized) {
+    renderer.ui_initialize_parallel_render(num_parallel_render_worker_threads());
+    parallel_render_initialized = true;
+  }
+
+  //  Render data built with shared arenas are always rendered serially, so the order of these
+  //  calls doesn't matter.
+  double_buffer.set_independent_subgraphs(enable);
+  renderer.ui_set_parallel_render_enabled(enable);
+  parallel_render_enabled = enable;
+}
+
+void AudioGraphComponent::set_node_profiling_enabled(bool enable) {
+  renderer.ui_set_node_profiling_enabled(enable);
+  node_profiling_enabled = enable;
+}
+
 void AudioGraphComponent::update(int frames_per_buffer) {
   graph_proxy.update(graph, double_buffer, frames_per_buffer);
+  if (node_profiling_enabled) {
+    renderer.ui_update_node_profiles();
+  }
 }
 
 GROVE_NAMESPACE_END
@@ -16,9 +16,25 @@ public:
   InitResult initialize();
   void update(int frames_per_buffer);
 
+  //  Render independent subgraphs of the audio graph concurrently. Worker threads are started
+  //  the first time parallel rendering is enabled.
+  void set_parallel_render_enabled(bool enable);
+  bool is_parallel_render_enabled() const {
+    return parallel_render_enabled;
+  }
+
+  //  Measure the time spent processing each node; see `AudioGraphRenderer::NodeProfile`.
+  void set_node_profiling_enabled(bool enable);
+  bool is_node_profiling_enabled() const {
+    return node_profiling_enabled;
+  }
+
 private:
   AudioGraph graph;
   AudioGraphDoubleBuffer double_buffer;
+  bool parallel_render_initialized{};
+  bool parallel_render_enabled{};
+  bool node_profiling_enabled{};
 
 public:
   AudioGraphProxy graph_proxy;
@@ -27,20 +27,38 @@ void update_cable_paths(UIAudioConnectionManager& ui_connection_manager,
   const auto& new_connections = update_info.new_connections;
   const auto& new_disconnections = update_info.new_disconnections;
 
+  //  Route every new connection with known end points as one batch.
+  std::vector<CableRoute> routes;
+  std::vector<bool> has_route;
   for (const auto& connection : new_connections) {
-    auto new_cable_path = make_empty_cable_path(ui_connection_manager);
+    const bool has_positions =
+      port_placement->has_path_finding_position(connection.first.id) &&
+      port_placement->has_path_finding_position(connection.second.id);
+    has_route.push_back(has_positions);
 
-    if (port_placement->has_path_finding_position(connection.first.id) &&
-        port_placement->has_path_finding_position(connection.second.id)) {
-      //
+    if (has_positions) {
       auto first_pos =
         port_placement->get_path_finding_position(connection.first.id);
       auto second_pos =
         port_placement->get_path_finding_position(connection.second.id);
 
-      auto p0 = Vec2f(first_pos.x, first_pos.z);
-      auto p1 = Vec2f(second_pos.x, second_pos.z);
-      auto path_result = path_finder->compute_path(p0, p1);
+      CableRoute route{};
+      route.source = Vec2f(first_pos.x, first_pos.z);
+      route.target = Vec2f(second_pos.x, second_pos.z);
+      routes.push_back(std::move(route));
+    }
+  }
+
+  TaskPool* task_pool = routes.size() > 1 ? update_info.task_pool : nullptr;
+  path_finder->compute_paths(routes.data(), int(routes.size()), task_pool);
+
+  int route_index{};
+  for (int i = 0; i < int(new_connections.size()); i++) {
+    const auto& connection = new_connections[i];
+    auto new_cable_path = make_empty_cable_path(ui_connection_manager);
+
+    if (has_route[i]) {
+      auto& path_result = routes[route_index++].result;
 
       if (path_result.success) {
         new_cable_path.positions = std::move(path_result.path_positions);
@@ -4,6 +4,7 @@
 #include "audio_port_placement.hpp"
 #include "../cabling/CablePathFinder.hpp"
 #include "grove/common/DynamicArray.hpp"
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
@@ -11,6 +12,7 @@
 namespace grove {
 
 class CablePathFinder;
+class TaskPool;
 
 struct UIAudioConnectionManager {
 public:
@@ -22,6 +24,8 @@ public:
     const SelectedInstrumentComponents* selected_components;
     ArrayView<AudioConnectionManager::Connection> new_connections;
     ArrayView<AudioConnectionManager::Connection> new_disconnections;
+    //  Optional. Paths are computed in parallel if set.
+    TaskPool* task_pool;
   };
 
   struct UpdateResult {
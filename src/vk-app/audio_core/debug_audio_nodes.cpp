@@ -6,6 +6,7 @@
 #include "../audio_processors/MultiComponentSampler.hpp"
 #include "../audio_processors/ChimeSampler.hpp"
 #include "../audio_processors/AltReverbNode.hpp"
+#include "../audio_processors/ConvolutionReverbNode.hpp"
 #include "../audio_processors/Skittering1.hpp"
 #include "../audio_processors/GaussDistributedPitches1.hpp"
 #include "../audio_processors/TransientsSampler1.hpp"
@@ -93,6 +94,24 @@ DebugNode create_alt_reverb(const debug::DebugAudioNodesContext& context) {
   return node;
 }
 
+DebugNode create_convolution_reverb(const debug::DebugAudioNodesContext& context) {
+  auto* audio_component = &context.audio_component;
+  auto node_ctor = [audio_component](AudioNodeStorage::NodeID node_id) {
+    auto* buff_store = audio_component->get_audio_buffer_store();
+    auto* param_sys = audio_component->get_parameter_system();
+    auto buff = audio_component->audio_buffers.find_by_name(
+      AudioBuffers::convolution_reverb_ir_file_name());
+    auto buff_handle = buff ? buff.value() : AudioBufferHandle{};
+    return new ConvolutionReverbNode(node_id, param_sys, buff_store, buff_handle);
+  };
+
+  DebugNode node{};
+  node.id = audio_component->audio_node_storage.create_node(
+    node_ctor, make_port_descriptors_from_audio_node_ctor(node_ctor));
+  node.name = "ConvolutionReverb";
+  return node;
+}
+
 DebugNode create_osc_swell(const debug::DebugAudioNodesContext& context) {
   auto* audio_component = &context.audio_component;
   auto node_ctor = [scale = audio_component->get_scale()](AudioNodeStorage::NodeID node_id) {
@@ -257,6 +276,7 @@ void debug::render_audio_nodes_gui(const DebugAudioNodesContext& context) {
   make_nodes[num_make_nodes++] = {"MultiComponentSampler", create_multi_component_sampler};
   make_nodes[num_make_nodes++] = {"ChimeSampler", create_chime_sampler};
   make_nodes[num_make_nodes++] = {"AltReverbNode", create_alt_reverb};
+  make_nodes[num_make_nodes++] = {"ConvolutionReverbNode", create_convolution_reverb};
   make_nodes[num_make_nodes++] = {"SimpleFM1", create_simple_fm1};
   make_nodes[num_make_nodes++] = {"OscSwell", create_osc_swell};
 
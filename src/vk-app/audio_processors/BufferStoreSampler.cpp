@@ -61,7 +61,7 @@ void BufferStoreSampler::process(const AudioProcessData& in, const AudioProcessD
   auto& in0 = in.descriptors[0];
   auto& in1 = in.descriptors[1];
 
-  auto maybe_buffer_chunk = buffer_store->render_get(buffer_handle, 0, info);
+  auto maybe_buffer_chunk = buffer_store->render_get_complete(buffer_handle);
   if (!maybe_buffer_chunk) {
     GROVE_LOG_WARNING_CAPTURE_META("Failed to load buffer.", "BufferStoreSampler");
     return;
@@ -207,7 +207,7 @@ void ChimeSampler::process(
     return;
   }
 
-  auto maybe_bg_chunk = buffer_store->render_get(bg_buff_handle, 0, 0);
+  auto maybe_bg_chunk = buffer_store->render_get_complete(bg_buff_handle);
   if (!maybe_bg_chunk || !maybe_bg_chunk.value().descriptor.is_n_channel_float(2)) {
     return;
   }
@@ -216,7 +216,7 @@ void ChimeSampler::process(
   constexpr int max_num_chunks = 4;
   AudioBufferChunk note_chunks[max_num_chunks];
   for (int i = 0; i < num_note_buff_handles; i++) {
-    auto chunk = buffer_store->render_get(note_buff_handles[i], 0, 0);
+    auto chunk = buffer_store->render_get_complete(note_buff_handles[i]);
     if (!chunk || !chunk.value().descriptor.is_n_channel_float(2)) {
       return;
     }
@@ -0,0 +1,370 @@
+#include "ConvolutionReverbNode.hpp"
+#include "grove/audio/AudioBufferStore.hpp"
+#include "grove/audio/AudioParameterSystem.hpp"
+#include "grove/math/simd.hpp"
+#include "grove/common/common.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+using Stage = ConvolutionReverbNode::Stage;
+
+/*
+ * Partition spectra are stored per pair of bins (k, k + 1) as {re re re re, -im im -im im},
+ * followed by the Nyquist bin as {re, im}, so that a pair of complex products is two multiplies
+ * and a lane swap.
+ */
+
+int num_bin_pairs(const Stage& stage) {
+  return stage.block_size / 2;
+}
+
+void pack_partition_spectrum(const float* spectrum, int num_pairs, float* dst) {
+  for (int j = 0; j < num_pairs; j++) {
+    const float* s = spectrum + j * 4;
+    float* d = dst + j * 8;
+    d[0] = s[0];
+    d[1] = s[0];
+    d[2] = s[2];
+    d[3] = s[2];
+    d[4] = -s[1];
+    d[5] = s[1];
+    d[6] = -s[3];
+    d[7] = s[3];
+  }
+  dst[num_pairs * 8] = spectrum[num_pairs * 4];
+  dst[num_pairs * 8 + 1] = spectrum[num_pairs * 4 + 1];
+}
+
+//  accum += x * h
+void multiply_accumulate(const float* x, const float* h, float* accum, int num_pairs) {
+#if GROVE_SIMD_ENABLED
+  using namespace simd;
+  for (int j = 0; j < num_pairs; j++) {
+    const F4 xs = load(x + j * 4);
+    const float* hs = h + j * 8;
+    const F4 prod = xs * load(hs) + swap_pairs(xs) * load(hs + 4);
+    store(accum + j * 4, load(accum + j * 4) + prod);
+  }
+#else
+  for (int j = 0; j < num_pairs; j++) {
+    for (int lane = 0; lane < 2; lane++) {
+      const float* xs = x + j * 4 + lane * 2;
+      const float hr = h[j * 8 + lane * 2];
+      const float hi = h[j * 8 + 4 + lane * 2 + 1];
+      float* acc = accum + j * 4 + lane * 2;
+      acc[0] += xs[0] * hr - xs[1] * hi;
+      acc[1] += xs[0] * hi + xs[1] * hr;
+    }
+  }
+#endif
+  const int k = num_pairs * 2;
+  const float xr = x[k * 2];
+  const float xi = x[k * 2 + 1];
+  const float hr = h[num_pairs * 8];
+  const float hi = h[num_pairs * 8 + 1];
+  accum[k * 2] += xr * hr - xi * hi;
+  accum[k * 2 + 1] += xr * hi + xi * hr;
+}
+
+void initialize_stage(Stage& stage, int block_size, int ir_offset, int max_num_partitions,
+                      bool defer_work) {
+  stage.block_size = block_size;
+  stage.ir_offset = ir_offset;
+  stage.max_num_partitions = max_num_partitions;
+  stage.defer_work = defer_work;
+  stage.plan = make_real_fft_plan(block_size * 2);
+  stage.spectrum_stride = (block_size + 1) * 2 + 2;
+  stage.partition_stride = num_bin_pairs(stage) * 8 + 4;
+
+  for (auto& ir : stage.ir_partitions) {
+    ir.resize(size_t(stage.partition_stride) * max_num_partitions);
+  }
+  for (auto& channel : stage.channels) {
+    channel.input.resize(block_size * 2);
+    channel.work_input.resize(block_size * 2);
+    channel.delay_line.resize(size_t(stage.spectrum_stride) * max_num_partitions);
+    channel.accum.resize(stage.spectrum_stride);
+    channel.output.resize(block_size);
+    channel.next_output.resize(block_size);
+  }
+  stage.time_scratch.resize(block_size * 2);
+  stage.spectrum_scratch.resize(stage.spectrum_stride);
+}
+
+void prepare_ir_partition(Stage& stage, const AudioBufferChunk& chunk, int num_ir_channels,
+                          uint64_t ir_end) {
+  const int p = stage.num_prepared_ir_partitions;
+  const uint64_t frame_begin = uint64_t(stage.ir_offset) + uint64_t(p) * stage.block_size;
+
+  for (int c = 0; c < num_ir_channels; c++) {
+    auto channel_descriptor = chunk.channel_descriptor(c);
+    std::fill(stage.time_scratch.begin(), stage.time_scratch.end(), 0.0f);
+    for (int i = 0; i < stage.block_size; i++) {
+      const uint64_t frame = frame_begin + i;
+      if (frame >= ir_end) {
+        break;
+      } else if (chunk.is_in_bounds(frame)) {
+        chunk.read(channel_descriptor, frame, &stage.time_scratch[i]);
+      }
+    }
+    real_fft(stage.plan, stage.time_scratch.data(), stage.spectrum_scratch.data());
+    float* dst = stage.ir_partitions[c].data() + size_t(p) * stage.partition_stride;
+    pack_partition_spectrum(stage.spectrum_scratch.data(), num_bin_pairs(stage), dst);
+  }
+
+  stage.num_prepared_ir_partitions++;
+}
+
+void do_work(Stage& stage, int num_ir_channels, int target) {
+  const int num_pairs = num_bin_pairs(stage);
+  const int num_partitions = stage.num_work_partitions;
+
+  for (; stage.work_done < target; stage.work_done++) {
+    const int unit = stage.work_done;
+    if (unit == 0) {
+      //  Forward transform of the completed block into the head of the delay line.
+      stage.delay_line_head = (stage.delay_line_head + 1) % stage.max_num_partitions;
+      for (auto& channel : stage.channels) {
+        const size_t off = size_t(stage.delay_line_head) * stage.spectrum_stride;
+        real_fft(stage.plan, channel.work_input.data(), channel.delay_line.data() + off);
+      }
+
+    } else if (unit <= num_partitions) {
+      const int p = unit - 1;
+      const int slot =
+        (stage.delay_line_head - p + stage.max_num_partitions) % stage.max_num_partitions;
+      for (int c = 0; c < 2; c++) {
+        auto& channel = stage.channels[c];
+        const int ir_channel = std::min(c, num_ir_channels - 1);
+        const float* x = channel.delay_line.data() + size_t(slot) * stage.spectrum_stride;
+        const float* h =
+          stage.ir_partitions[ir_channel].data() + size_t(p) * stage.partition_stride;
+        multiply_accumulate(x, h, channel.accum.data(), num_pairs);
+      }
+
+    } else {
+      //  Inverse transform; the last `block_size` frames are the valid (non-aliased) output.
+      for (auto& channel : stage.channels) {
+        real_ifft(stage.plan, channel.accum.data(), stage.time_scratch.data());
+        std::copy(
+          stage.time_scratch.begin() + stage.block_size,
+          stage.time_scratch.end(), channel.next_output.begin());
+        std::fill(channel.accum.begin(), channel.accum.end(), 0.0f);
+      }
+    }
+  }
+}
+
+void complete_block(Stage& stage, int num_ir_channels) {
+  const int block_size = stage.block_size;
+
+  do_work(stage, num_ir_channels, stage.work_total);
+  if (stage.defer_work) {
+    for (auto& channel : stage.channels) {
+      std::swap(channel.output, channel.next_output);
+    }
+  }
+
+  for (auto& channel : stage.channels) {
+    std::copy(channel.input.begin(), channel.input.end(), channel.work_input.begin());
+    std::copy(channel.input.begin() + block_size, channel.input.end(), channel.input.begin());
+  }
+
+  stage.num_work_partitions = num_ir_channels > 0 ? stage.num_prepared_ir_partitions : 0;
+  stage.work_done = 0;
+  stage.work_total = stage.num_work_partitions > 0 ? stage.num_work_partitions + 2 : 0;
+  stage.frame = 0;
+
+  if (!stage.defer_work) {
+    do_work(stage, num_ir_channels, stage.work_total);
+    for (auto& channel : stage.channels) {
+      if (stage.work_total > 0) {
+        std::swap(channel.output, channel.next_output);
+      } else {
+        std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+      }
+    }
+  } else if (stage.work_total == 0) {
+    for (auto& channel : stage.channels) {
+      std::fill(channel.next_output.begin(), channel.next_output.end(), 0.0f);
+    }
+  }
+}
+
+} //  anon
+
+ConvolutionReverbNode::ConvolutionReverbNode(AudioParameterID node_id,
+                                             const AudioParameterSystem* parameter_system,
+                                             const AudioBufferStore* buffer_store,
+                                             AudioBufferHandle ir_handle) :
+  node_id{node_id},
+  parameter_system{parameter_system},
+  buffer_store{buffer_store},
+  ir_handle{ir_handle} {
+  //
+  static_assert(tail_block_size % head_block_size == 0, "Expected aligned block sizes.");
+  initialize_stage(head, head_block_size, 0, max_num_head_partitions, false);
+  initialize_stage(tail, tail_block_size, tail_ir_offset, max_num_tail_partitions, true);
+}
+
+ConvolutionReverbNode::ImpulseResponse
+ConvolutionReverbNode::make_synthetic_impulse_response(double sample_rate, double rt60_s) {
+  const int num_frames = std::max(1, std::min(int(sample_rate * rt60_s), max_ir_frames));
+
+  ImpulseResponse result;
+  result.descriptor = AudioBufferDescriptor::from_interleaved_float(sample_rate, num_frames, 2);
+  result.data = std::make_unique<unsigned char[]>(result.descriptor.size);
+  auto* dst = reinterpret_cast<float*>(result.data.get());
+
+  //  Fixed seed, so that the room sounds the same from run to run.
+  std::mt19937 gen{0x1234u};
+  std::uniform_real_distribution<float> dis{-1.0f, 1.0f};
+  const double decay = std::log(1e-3) / (rt60_s * sample_rate);
+
+  for (int ch = 0; ch < 2; ch++) {
+    double energy{};
+    float lp{};
+    for (int i = 0; i < num_frames; i++) {
+      //  One-pole lowpass whose cutoff falls over the IR, so high frequencies decay first.
+      const float t = float(i) / float(num_frames);
+      lp += (1.0f - 0.8f * t) * (dis(gen) - lp);
+      const auto v = float(lp * std::exp(decay * i));
+      dst[i * 2 + ch] = v;
+      energy += double(v) * v;
+    }
+
+    const auto scale = energy > 0.0 ? float(1.0 / std::sqrt(energy)) : 0.0f;
+    for (int i = 0; i < num_frames; i++) {
+      dst[i * 2 + ch] *= scale;
+    }
+  }
+
+  return result;
+}
+
+void ConvolutionReverbNode::prepare_ir(const AudioBufferChunk& chunk) {
+  const uint64_t ir_end = std::min(chunk.frame_end(), uint64_t(max_ir_frames));
+
+  if (!ir_initialized) {
+    num_ir_channels = 0;
+    for (int i = 0; i < std::min(2, int(chunk.descriptor.num_channels())); i++) {
+      if (!chunk.channel_descriptor(i).is_float()) {
+        break;
+      }
+      num_ir_channels++;
+    }
+
+    const auto head_end = std::min(ir_end, uint64_t(tail_ir_offset));
+    head.num_ir_partitions = int((head_end + head_block_size - 1) / head_block_size);
+    if (ir_end > uint64_t(tail_ir_offset)) {
+      const auto tail_size = ir_end - tail_ir_offset;
+      tail.num_ir_partitions = int((tail_size + tail_block_size - 1) / tail_block_size);
+    }
+    if (num_ir_channels == 0) {
+      head.num_ir_partitions = 0;
+      tail.num_ir_partitions = 0;
+    }
+    ir_initialized = true;
+  }
+
+  int budget = max_num_partitions_prepared_per_render;
+  for (Stage* stage : {&head, &tail}) {
+    while (budget > 0 && stage->num_prepared_ir_partitions < stage->num_ir_partitions) {
+      prepare_ir_partition(*stage, chunk, num_ir_channels, ir_end);
+      budget--;
+    }
+  }
+}
+
+void ConvolutionReverbNode::process(
+  const AudioProcessData& in, const AudioProcessData& out, AudioEvents*,
+  const AudioRenderInfo& info) {
+  //
+  const auto& param_changes = param_system::render_read_changes(parameter_system);
+  const auto self_changes = param_changes.view_by_parent(node_id);
+  const auto mix_changes = self_changes.view_by_parameter(0);
+  int mix_change_index{};
+
+  const bool need_prepare = !ir_initialized ||
+    head.num_prepared_ir_partitions < head.num_ir_partitions ||
+    tail.num_prepared_ir_partitions < tail.num_ir_partitions;
+  if (need_prepare) {
+    if (auto chunk = buffer_store->render_get_complete(ir_handle)) {
+      prepare_ir(chunk.value());
+    }
+  }
+
+  //  Pass the input through until the IR is available.
+  const bool have_ir = num_ir_channels > 0;
+
+  int i{};
+  while (i < info.num_frames) {
+    //  Split at short block boundaries; long block boundaries are a subset of these.
+    const int num_segment_frames = std::min(head_block_size - head.frame, info.num_frames - i);
+
+    for (int f = 0; f < num_segment_frames; f++) {
+      const int frame = i + f;
+      maybe_apply_change(mix_changes, mix_change_index, mix, frame);
+      const float mix_value = have_ir ? mix.evaluate() : 0.0f;
+
+      for (int c = 0; c < 2; c++) {
+        float dry;
+        in.descriptors[c].read(in.buffer.data, frame, &dry);
+        head.channels[c].input[head_block_size + head.frame + f] = dry;
+        tail.channels[c].input[tail_block_size + tail.frame + f] = dry;
+
+        const float wet = head.channels[c].output[head.frame + f] +
+          tail.channels[c].output[tail.frame + f];
+        const float s = lerp(mix_value, dry, wet);
+        out.descriptors[c].write(out.buffer.data, frame, &s);
+      }
+    }
+
+    i += num_segment_frames;
+    head.frame += num_segment_frames;
+    tail.frame += num_segment_frames;
+
+    //  Keep the deferred work proportional to the progress through the current long block.
+    do_work(tail, num_ir_channels, (tail.work_total * tail.frame) / tail_block_size);
+
+    if (tail.frame == tail_block_size) {
+      complete_block(tail, num_ir_channels);
+    }
+    if (head.frame == head_block_size) {
+      complete_block(head, num_ir_channels);
+    }
+  }
+}
+
+void ConvolutionReverbNode::parameter_descriptors(
+  TemporaryViewStack<AudioParameterDescriptor>& mem) const {
+  //
+  auto* dst = mem.push(1);
+  dst[0] = mix.make_descriptor(node_id, 0, 0.5f, "mix");
+}
+
+InputAudioPorts ConvolutionReverbNode::inputs() const {
+  InputAudioPorts result;
+  for (int i = 0; i < 2; i++) {
+    result.push_back(InputAudioPort{
+      BufferDataType::Float, const_cast<ConvolutionReverbNode*>(this), i});
+  }
+  return result;
+}
+
+OutputAudioPorts ConvolutionReverbNode::outputs() const {
+  OutputAudioPorts result;
+  for (int i = 0; i < 2; i++) {
+    result.push_back(OutputAudioPort{
+      BufferDataType::Float, const_cast<ConvolutionReverbNode*>(this), i});
+  }
+  return result;
+}
+
+GROVE_NAMESPACE_END
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "grove/audio/audio_node.hpp"
+#include "grove/audio/audio_buffer.hpp"
+#include "grove/audio/fft.hpp"
+#include <memory>
+#include <vector>
+
+namespace grove {
+
+class AudioBufferStore;
+struct AudioParameterSystem;
+
+/*
+ * ConvolutionReverbNode
+ *
+ * Stereo convolution with a sampled impulse response, using two-stage non-uniformly
+ * partitioned overlap-save FFT convolution. Latency is `head_block_size` frames.
+ *
+ * The head of the IR is split into short partitions that are convolved in full whenever a
+ * short input block completes. The rest of the IR is split into long partitions; the work for a
+ * completed long input block (forward transform, multiply-accumulate against each partition,
+ * inverse transform) is spread evenly over the frames of the following long block, so the
+ * render cost per frame stays flat regardless of the IR length. The tail partitions begin
+ * `2 * tail_block_size - head_block_size` frames into the IR, which is exactly the delay
+ * introduced by deferring their work by one block.
+ *
+ * IR partition spectra are prepared a few at a time on the render thread once the buffer is
+ * available, so the tail fades in over the first quanta. Mono IRs are applied to both channels.
+ * The IR is used at its native sample rate.
+ *
+ * `make_synthetic_impulse_response` builds a stereo IR of a diffuse room for use when no
+ * recorded IR is available.
+ */
+
+class ConvolutionReverbNode : public AudioProcessorNode {
+public:
+  static constexpr int head_block_size = 128;
+  static constexpr int tail_block_size = 1024;
+  static constexpr int tail_ir_offset = tail_block_size * 2 - head_block_size;
+  static constexpr int max_num_head_partitions = tail_ir_offset / head_block_size;
+  static constexpr int max_num_tail_partitions = 128;
+  static constexpr int max_ir_frames =
+    tail_ir_offset + max_num_tail_partitions * tail_block_size;
+  static constexpr int max_num_partitions_prepared_per_render = 2;
+
+  struct Stage {
+    struct Channel {
+      //  Previous block followed by the block being collected; `block_size * 2` frames.
+      std::vector<float> input;
+      //  Input of the block whose work is in progress.
+      std::vector<float> work_input;
+      //  Ring of input spectra; `max_num_partitions` x `spectrum_stride`.
+      std::vector<float> delay_line;
+      std::vector<float> accum;
+      std::vector<float> output;
+      std::vector<float> next_output;
+    };
+
+    int block_size{};
+    int ir_offset{};
+    int max_num_partitions{};
+    int spectrum_stride{};
+    int partition_stride{};
+    bool defer_work{};
+    RealFFTPlan plan;
+
+    //  Per IR channel; `max_num_partitions` x `partition_stride`.
+    std::vector<float> ir_partitions[2];
+    int num_ir_partitions{};
+    int num_prepared_ir_partitions{};
+
+    Channel channels[2];
+    std::vector<float> time_scratch;
+    std::vector<float> spectrum_scratch;
+
+    int frame{};
+    int delay_line_head{};
+    int num_work_partitions{};
+    int work_done{};
+    int work_total{};
+  };
+
+  struct ImpulseResponse {
+    AudioBufferDescriptor descriptor;
+    std::unique_ptr<unsigned char[]> data;
+  };
+
+public:
+  ConvolutionReverbNode(AudioParameterID node_id, const AudioParameterSystem* parameter_system,
+                        const AudioBufferStore* buffer_store, AudioBufferHandle ir_handle);
+  ~ConvolutionReverbNode() override = default;
+  GROVE_DECLARE_AUDIO_NODE_INTERFACE()
+  GROVE_DECLARE_AUDIO_NODE_PARAMETER_DESCRIPTORS()
+  uint32_t get_id() const override {
+    return node_id;
+  }
+
+  //  Decorrelated noise per channel that decays by 60dB over `rt60_s` seconds and darkens as it
+  //  decays, normalized to unit energy per channel. Truncated to `max_ir_frames`.
+  static ImpulseResponse make_synthetic_impulse_response(double sample_rate, double rt60_s);
+
+private:
+  void prepare_ir(const AudioBufferChunk& chunk);
+
+private:
+  AudioParameterID node_id;
+  const AudioParameterSystem* parameter_system;
+  const AudioBufferStore* buffer_store;
+  AudioBufferHandle ir_handle;
+
+  AudioParameter<float, StaticLimits01<float>> mix{0.5f};
+
+  Stage head;
+  Stage tail;
+  int num_ir_channels{};
+  bool ir_initialized{};
+};
+
+}
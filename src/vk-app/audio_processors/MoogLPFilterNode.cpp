@@ -51,30 +51,58 @@ void MoogLPFilterNode::process(
   int cutoff_change_ind{};
   int res_change_ind{};
 
-  for (int i = 0; i < info.num_frames; i++) {
-    maybe_apply_change(cutoff_changes, cutoff_change_ind, cutoff, i);
-    maybe_apply_change(res_changes, res_change_ind, resonance, i);
-
-    float cut = cutoff.evaluate();
-    const float res = resonance.evaluate();
-
-    if (!in.descriptors[2].is_missing()) {
-      float mod_11{};
-      in.descriptors[2].read(in.buffer.data, i, &mod_11);
-      mod_11 = clamp(mod_11, -1.0f, 1.0f) * 2.5e3f;
-      cut = clamp(cut + mod_11, CutoffLimits::min, CutoffLimits::max);
+  //  Channels are filtered together in spans of frames over which the cutoff and resonance are
+  //  constant, which is usually the whole block.
+  constexpr int block_size = 64;
+  constexpr int num_lanes = audio::num_voice_lanes;
+  float lanes[block_size * num_lanes]{};
+
+  for (int i0 = 0; i0 < info.num_frames; i0 += block_size) {
+    const int num_block_frames = std::min(block_size, info.num_frames - i0);
+
+    int span_begin{};
+    float span_cut{};
+    float span_res{};
+    auto process_span = [&](int span_end) {
+      for (int j = 0; j < 2; j++) {
+        filter.set_coefficients(j, info.sample_rate, span_cut, span_res);
+      }
+      filter.process(lanes + span_begin * num_lanes, span_end - span_begin);
+      span_begin = span_end;
+    };
+
+    for (int i = 0; i < num_block_frames; i++) {
+      const int frame = i0 + i;
+      maybe_apply_change(cutoff_changes, cutoff_change_ind, cutoff, frame);
+      maybe_apply_change(res_changes, res_change_ind, resonance, frame);
+
+      float cut = cutoff.evaluate();
+      const float res = resonance.evaluate();
+
+      if (!in.descriptors[2].is_missing()) {
+        float mod_11{};
+        in.descriptors[2].read(in.buffer.data, frame, &mod_11);
+        mod_11 = clamp(mod_11, -1.0f, 1.0f) * 2.5e3f;
+        cut = clamp(cut + mod_11, CutoffLimits::min, CutoffLimits::max);
+      }
+
+      if (i > 0 && (cut != span_cut || res != span_res)) {
+        process_span(i);
+      }
+      span_cut = cut;
+      span_res = res;
+
+      for (int j = 0; j < 2; j++) {
+        in.descriptors[j].read(in.buffer.data, frame, lanes + i * num_lanes + j);
+      }
     }
 
-    for (auto& st : state) {
-      st.update(info.sample_rate, cut, res);
-    }
-
-    for (int j = 0; j < 2; j++) {
-      float in_v;
-      in.descriptors[j].read(in.buffer.data, i, &in_v);
+    process_span(num_block_frames);
 
-      float out_v = state[j].tick(in_v);
-      out.descriptors[j].write(out.buffer.data, i, &out_v);
+    for (int i = 0; i < num_block_frames; i++) {
+      for (int j = 0; j < 2; j++) {
+        out.descriptors[j].write(out.buffer.data, i0 + i, lanes + i * num_lanes + j);
+      }
     }
   }
 }
@@ -1,8 +1,7 @@
 #pragma once
 
-#include "filters.hpp"
 #include "grove/audio/audio_node.hpp"
-#include <array>
+#include "grove/audio/voice_kernels.hpp"
 
 namespace grove {
 
@@ -33,7 +32,8 @@ private:
   AudioParameter<float, CutoffLimits> cutoff{cutoff_default};
   AudioParameter<float, ResonanceLimits> resonance{resonance_default};
 
-  std::array<MoogLPFilterState, 2> state{};
+  //  Left and right channels in lanes 0 and 1.
+  audio::MoogLPFilter4 filter{};
 };
 
 }
\ No newline at end of file
@@ -126,7 +126,7 @@ void MultiComponentSampler::process(
   AudioBufferChunk chunks[max_num_voices]{};
   int num_chunks{};
   for (int i = 0; i < num_buff_handles; i++) {
-    if (auto chunk = buffer_store->render_get(buff_handles[i], 0, 0)) {
+    if (auto chunk = buffer_store->render_get_complete(buff_handles[i])) {
       if (chunk.value().descriptor.is_n_channel_float(2) && chunk.value().frame_size > 0) {
         chunks[num_chunks++] = chunk.value();
       }
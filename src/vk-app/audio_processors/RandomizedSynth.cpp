@@ -145,8 +145,7 @@ void RandomizedSynth::process(const AudioProcessData& in,
     //  granulator.
     global_gain = 0.5f;
 
-    auto maybe_chunk = buffer_store->render_get(
-      buffer_handle, granulator.get_frame_index(), info);
+    auto maybe_chunk = buffer_store->render_get_complete(buffer_handle);
 
     if (maybe_chunk &&
         maybe_chunk.value().descriptor.is_n_channel_float(2) &&
@@ -7,8 +7,7 @@ GROVE_NAMESPACE_BEGIN
 
 namespace {
 
-template <typename T>
-void configure_fdn_filters(T&& filters) {
+void configure_fdn_filters(audio::Biquad4& filters) {
   const double b0s[3] = {0.025176114554401, 0.050352229108803, 0.025176114554401};
   const double a0s[3] = {1.0, -1.503695341299222, 0.604399799516827};
 
@@ -24,10 +23,8 @@ void configure_fdn_filters(T&& filters) {
   const double* bs[4] = {b0s, b1s, b2s, b3s};
   const double* as[4] = {a0s, a1s, a2s, a3s};
 
-  for (int i = 0; i < filters.size(); i++) {
-    const auto coeff_ind = i % 4;
-    filters[i].set_b(bs[coeff_ind], 3);
-    filters[i].set_a(as[coeff_ind], 3);
+  for (int i = 0; i < audio::num_voice_lanes; i++) {
+    filters.set_coefficients(i, bs[i], as[i]);
   }
 }
 
@@ -51,8 +48,6 @@ Reverb1::Reverb1() {
 
   const int fdn_delays[4] = {1331, 2197, 4913, 6859};
   for (const auto& del : fdn_delays) {
-    fdn_filters0.emplace_back();
-    fdn_filters1.emplace_back();
     fdn_delays0.emplace_back(del);
     fdn_delays1.emplace_back(del + 33);
   }
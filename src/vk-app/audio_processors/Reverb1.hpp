@@ -1,6 +1,7 @@
 #pragma once
 
 #include "grove/audio/filter.hpp"
+#include "grove/audio/voice_kernels.hpp"
 #include "grove/audio/delay.hpp"
 #include "grove/audio/audio_parameters.hpp"
 #include "grove/math/Mat4.hpp"
@@ -10,7 +11,8 @@ namespace grove {
 namespace impl {
 
 using FDNDelays = DynamicArray<audio::SimpleDelayLine<float>, 4>;
-using FDNFilters = DynamicArray<audio::LinearFilter<double, 3, 3>, 4>;
+//  One lane per delay line.
+using FDNFilters = audio::Biquad4;
 
 constexpr Mat4<double> hadamard4() {
   return Mat4<double>{
@@ -23,12 +25,17 @@ constexpr Mat4<double> hadamard4() {
 
 inline Sample fdn_tick(Sample u, FDNDelays& delays, FDNFilters& filters,
                        const Mat4<double>& A, double feedback) {
-  const auto n =
-    std::min(4, std::min(int(delays.size()), int(filters.size())));
+  const auto n = std::min(audio::num_voice_lanes, int(delays.size()));
+
+  double filtered[audio::num_voice_lanes]{};
+  for (int j = 0; j < n; j++) {
+    filtered[j] = delays[j].current();
+  }
+  filters.process(filtered, 1);
 
   Vec4<double> v0{};
   for (int j = 0; j < n; j++) {
-    v0[j] = filters[j].tick(delays[j].current());
+    v0[j] = filtered[j];
   }
 
   auto mixed = A * v0;
@@ -51,7 +51,7 @@ void Skittering1::process(
   const AudioProcessData& in, const AudioProcessData& out,
   AudioEvents*, const AudioRenderInfo& info) {
   //
-  auto buff_chunk = buffer_store->render_get(buffer_handle, 0, 0);
+  auto buff_chunk = buffer_store->render_get_complete(buffer_handle);
   if (!buff_chunk || !buff_chunk.value().descriptor.is_n_channel_float(2) ||
       buff_chunk.value().empty()) {
     return;
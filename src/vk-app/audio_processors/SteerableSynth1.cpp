@@ -32,8 +32,8 @@ SteerableSynth1::SteerableSynth1(
   node_id{node_id}, parameter_system{param_sys}, scale{scale},
   pitch_sample_group_id{pitch_sample_group_id} {
   //
-  for (auto& env : envelopes) {
-    env.configure(randomized_params());
+  for (int i = 0; i < num_voices; i++) {
+    envelopes.configure(i, randomized_params());
   }
   for (auto& osc : oscillators) {
     osc = osc::Sin{default_sample_rate(), frequency_a4()};
@@ -80,8 +80,7 @@ void SteerableSynth1::process(const AudioProcessData& in, const AudioProcessData
   }
 
   for (int i = 0; i < num_voices; i++) {
-    auto& env = envelopes[i];
-    if (env.elapsed() && grove::urand() > 0.95) {
+    if (envelopes.elapsed(i) && grove::urand() > 0.95) {
       if (num_pending_notes > 0) {
         active_notes[i] = pending_notes[0];
         left_shift(pending_notes, num_pending_notes);
@@ -93,8 +92,8 @@ void SteerableSynth1::process(const AudioProcessData& in, const AudioProcessData
         PitchSampleSetGroupHandle{pitch_sample_group_id}, 0, 0.0);
       active_notes[i] = uint8_t(clamp(double(latest_note_number) + st_off, 0.0, 255.0));
 #endif
-      env.configure(randomized_params());
-      env.note_on();
+      envelopes.configure(i, randomized_params());
+      envelopes.note_on(i);
     }
   }
   for (int i = 0; i < num_voices; i++) {
@@ -114,8 +113,17 @@ void SteerableSynth1::process(const AudioProcessData& in, const AudioProcessData
   const auto& out_desc0 = out.descriptors[0];
   const auto& out_desc1 = out.descriptors[1];
 
+  //  Envelopes are rendered a block at a time, with voice `v` in lane `v`.
+  constexpr int block_size = 64;
+  float env_block[block_size * num_voices];
+
   float latest_signal_val;
   for (int i = 0; i < info.num_frames; i++) {
+    const int block_frame = i % block_size;
+    if (block_frame == 0) {
+      envelopes.process(info.sample_rate, env_block, std::min(block_size, info.num_frames - i));
+    }
+
     MIDIMessage message;
     in_note_desc.read(in.buffer.data, i, &message);
     if (message.is_note_on()) {
@@ -149,7 +157,7 @@ void SteerableSynth1::process(const AudioProcessData& in, const AudioProcessData
         note_number_to_semitone(active_notes[v]) + pb_amt, *tuning);
 #endif
       oscillators[v].set_frequency(freq);
-      s += envelopes[v].tick(info.sample_rate) * oscillators[v].tick();
+      s += env_block[block_frame * num_voices + v] * oscillators[v].tick();
     }
 
     float gain_adj = std::max(0.0f, noise_amp_lfo.tick() * 0.1f);
@@ -2,6 +2,7 @@
 
 #include "grove/audio/audio_node.hpp"
 #include "grove/audio/envelope.hpp"
+#include "grove/audio/voice_kernels.hpp"
 #include "grove/audio/oscillator.hpp"
 #include "Reverb1.hpp"
 
@@ -13,6 +14,7 @@ struct AudioParameterSystem;
 class SteerableSynth1 : public AudioProcessorNode {
 public:
   static constexpr int num_voices = 4;
+  static_assert(num_voices == audio::num_voice_lanes);
 
 public:
   SteerableSynth1(uint32_t node_id, const AudioParameterSystem* param_sys, const AudioScale* scale,
@@ -31,7 +33,8 @@ private:
   const AudioScale* scale;
   uint32_t pitch_sample_group_id;
 
-  env::ADSRExp<float> envelopes[num_voices];
+  //  One voice per lane.
+  audio::ADSRExp4 envelopes;
   audio::ExpInterpolated<float> pitch_bend{};
   audio::ExpInterpolated<float> amp_mod_gain{1.0f};
   osc::Sin oscillators[num_voices];
@@ -37,7 +37,7 @@ void TransientsSampler1::process(
     return;
   }
 
-  auto maybe_chunk = buff_store->render_get(buff_handle, 0, 0);
+  auto maybe_chunk = buff_store->render_get_complete(buff_handle);
   if (!maybe_chunk || !maybe_chunk.value().descriptor.is_n_channel_float(2)) {
     return;
   }
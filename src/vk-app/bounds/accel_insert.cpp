@@ -5,11 +5,12 @@ GROVE_NAMESPACE_BEGIN
 
 int bounds::insert_bounds(const InsertBoundsParams& params) {
   std::vector<const bounds::Element*> hit;
+  bounds::AccelIntersectScratch scratch;
   int num_inserted{};
 
   for (int i = 0; i < params.num_bounds; i++) {
     const auto& obb = params.bounds[i];
-    params.accel->intersects(bounds::make_query_element(obb), hit);
+    bounds::intersects(params.accel, bounds::make_query_element(obb), hit, scratch);
 
     bool accept = true;
     for (const bounds::Element* el : hit) {
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "grove/math/obb_batch.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace grove::bounds {
+
+struct AccelIntersectScratch {
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> hits;
+  OBB3fBatch bounds;
+};
+
+}
\ No newline at end of file
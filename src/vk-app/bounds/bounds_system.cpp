@@ -71,7 +71,7 @@ void release_write(BoundsSystem::Instance* inst, AccessorID id) {
 }
 
 bool can_launch(const BoundsSystem::Instance& inst) {
-  return !inst.rebuilding_accel && !inst.deactivating;
+  return !inst.deactivating;
 }
 
 template <typename F>
@@ -108,36 +108,115 @@ void update_pending_deactivation(BoundsSystem::Instance* inst) {
   }
 }
 
+void update_stats(BoundsSystem::Instance* inst, const Accel& accel) {
+  auto& stats = inst->stats;
+  stats.num_elements = uint32_t(accel.num_elements());
+  stats.num_inactive = uint32_t(accel.num_inactive());
+  stats.compacting = inst->compacting;
+  if (inst->compacting) {
+    auto& comp = inst->compaction;
+    stats.num_compaction_elements_visited = uint32_t(comp.dst_indices.size());
+    stats.num_compaction_elements_migrated = comp.num_migrated;
+    stats.compaction_progress = stats.num_elements == 0 ? 1.0f :
+      float(double(stats.num_compaction_elements_visited) / double(stats.num_elements));
+  }
+}
+
+void begin_compaction(BoundsSystem::Instance* inst, Accel& src) {
+  auto& comp = inst->compaction;
+  comp.accel = Accel{inst->rebuild_params.initial_span_size,
+                     inst->rebuild_params.max_span_size_split};
+  comp.dst_indices.clear();
+  comp.num_migrated = 0;
+  src.set_record_deactivations(true);
+  inst->compacting = true;
+}
+
+//  Apply deactivations made to `src` since the last call to the elements already copied, then
+//  copy up to `max_num_elements` more. Requires that `src` is not being written to.
+void compact(BoundsSystem::Instance* inst, Accel& src, uint32_t max_num_elements) {
+  auto& comp = inst->compaction;
+  src.swap_recorded_deactivations(comp.deactivated);
+  for (uint32_t src_ind : comp.deactivated) {
+    //  Elements not yet visited are skipped when visited.
+    if (src_ind < comp.dst_indices.size() && comp.dst_indices[src_ind] != ~0u) {
+      comp.accel.deactivate_element(comp.dst_indices[src_ind]);
+    }
+  }
+
+  auto beg = uint32_t(comp.dst_indices.size());
+  auto end = uint32_t(std::min(src.num_elements(), size_t(beg) + max_num_elements));
+  for (uint32_t i = beg; i < end; i++) {
+    auto& el = src.element(i);
+    if (ElementTraits::active(el)) {
+      comp.dst_indices.push_back(uint32_t(comp.accel.num_elements()));
+      comp.accel.insert(Element{el});
+      comp.num_migrated++;
+    } else {
+      comp.dst_indices.push_back(~0u);
+    }
+  }
+}
+
+void finish_compaction(BoundsSystem::Instance* inst, Accel& src) {
+  auto& comp = inst->compaction;
+  compact(inst, src, ~0u);
+  assert(comp.dst_indices.size() == src.num_elements());
+  std::swap(src, comp.accel);
+  comp.accel = Accel{};
+  comp.dst_indices = {};
+  comp.deactivated = {};
+  inst->compacting = false;
+  inst->stats.num_compactions++;
+}
+
 void update_rebuild(BoundsSystem::Instance* inst) {
-  if (can_launch(*inst) && inst->need_rebuild_accel) {
-    if (auto* accel = request_write(inst, inst->self_id)) {
-      auto task = [accel, inst, params = inst->rebuild_params]() {
-        *accel = Accel::rebuild_active(
-          std::move(*accel),
-          params.initial_span_size,
-          params.max_span_size_split);
-        inst->async_complete.store(true);
-      };
-      async_launch(inst, std::move(task));
+  if (inst->need_rebuild_accel && !inst->compacting) {
+    if (request_read(inst, inst->self_id)) {
+      begin_compaction(inst, inst->accel);
+      release_read(inst, inst->self_id);
       inst->need_rebuild_accel = false;
-      inst->rebuilding_accel = true;
     }
   }
-  if (inst->rebuilding_accel && async_complete(inst)) {
-    on_async_write_complete(inst);
-    inst->rebuilding_accel = false;
+  if (!inst->compacting) {
+    return;
+  }
+
+  //  Once every element has been visited, swap in the compacted accel as soon as no one holds the
+  //  original. Until then, copy a bounded number of elements per update, alongside other readers.
+  auto& comp = inst->compaction;
+  //  Under read access, only the deactivation log of the original is modified, which other readers
+  //  do not touch.
+  if (request_read(inst, inst->self_id)) {
+    auto& src = inst->accel;
+    const bool visited_all = comp.dst_indices.size() == src.num_elements();
+    if (!visited_all) {
+      compact(inst, src, inst->max_num_compaction_elements_per_update);
+    }
+    update_stats(inst, src);
+    release_read(inst, inst->self_id);
+    if (!visited_all) {
+      return;
+    }
+  }
+  if (auto* accel = request_write(inst, inst->self_id)) {
+    finish_compaction(inst, *accel);
+    update_stats(inst, *accel);
+    release_write(inst, inst->self_id);
   }
 }
 
 void update_trigger_auto_rebuild(BoundsSystem::Instance* inst) {
-  if (!inst->need_check_auto_rebuild) {
+  if (!inst->need_check_auto_rebuild || inst->compacting) {
     return;
   }
   if (auto* accel = request_read(inst, inst->self_id)) {
+    update_stats(inst, *accel);
     auto num_els = double(accel->num_elements());
     if (num_els > 0.0) {
       auto num_inactive = double(accel->num_inactive());
-      if (float(num_inactive / num_els) >= inst->auto_rebuild_proportion_threshold) {
+      inst->stats.pending_inactive_ratio = float(num_inactive / num_els);
+      if (inst->stats.pending_inactive_ratio >= inst->auto_rebuild_proportion_threshold) {
         inst->need_rebuild_accel = true;
       }
     }
@@ -227,6 +306,12 @@ size_t bounds::deactivate_element(bounds::Accel* accel, bounds::ElementID id) {
   return deactivate(accel, id);
 }
 
+AccelInstanceStats bounds::get_stats(const BoundsSystem* sys, AccelInstanceHandle handle) {
+  auto* inst = find_instance(const_cast<BoundsSystem*>(sys), handle);
+  assert(inst);
+  return inst->stats;
+}
+
 void bounds::rebuild_accel(BoundsSystem* sys, AccelInstanceHandle handle,
                            const CreateAccelInstanceParams& params) {
   auto* inst = find_instance(sys, handle);
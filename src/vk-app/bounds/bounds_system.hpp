@@ -19,8 +19,32 @@ struct CreateAccelInstanceParams {
   float max_span_size_split;
 };
 
+//  Counts are as of the last `update()` that could read the accel.
+struct AccelInstanceStats {
+  uint32_t num_elements;
+  uint32_t num_inactive;
+  //  Proportion of inactive elements as of the last auto-rebuild check.
+  float pending_inactive_ratio;
+  bool compacting;
+  //  Elements of the current accel visited by the compaction in progress.
+  uint32_t num_compaction_elements_visited;
+  uint32_t num_compaction_elements_migrated;
+  float compaction_progress;
+  uint32_t num_compactions;
+};
+
 struct BoundsSystem {
 public:
+  //  Copy of an instance's accel containing only its active elements, built a bounded number of
+  //  elements per update while the original remains readable, and swapped in once complete.
+  struct Compaction {
+    Accel accel;
+    //  Index in `accel` of each visited element of the original, or ~0u if it was inactive.
+    std::vector<uint32_t> dst_indices;
+    std::vector<uint32_t> deactivated;
+    uint32_t num_migrated;
+  };
+
   struct Instance {
     uint32_t id{};
     Accel accel;
@@ -30,11 +54,15 @@ public:
 
     //  Automatically rebuild if the proportion of inactive elements is greater than this threshold.
     float auto_rebuild_proportion_threshold{0.25f};
+    //  Maximum number of elements copied into the compacted accel per call to `update()`.
+    uint32_t max_num_compaction_elements_per_update{2048};
     bool need_check_auto_rebuild{};
     bool need_rebuild_accel{};
-    bool rebuilding_accel{};
+    bool compacting{};
     bool deactivating{};
+    AccelInstanceStats stats{};
     CreateAccelInstanceParams rebuild_params{};
+    Compaction compaction;
     std::vector<bounds::ElementID> pending_deactivation;
     std::future<void> async_future;
     std::atomic<bool> async_complete{};
@@ -60,6 +88,7 @@ void push_pending_deactivation(BoundsSystem* sys, AccelInstanceHandle instance,
 void push_pending_deactivation(BoundsSystem* sys, AccelInstanceHandle instance,
                                std::vector<ElementID>&& ids);
 size_t deactivate_element(bounds::Accel* accel, bounds::ElementID id);
+AccelInstanceStats get_stats(const BoundsSystem* sys, AccelInstanceHandle instance);
 void update(BoundsSystem* sys);
 
 }
\ No newline at end of file
@@ -26,4 +26,24 @@ ElementTag bounds::ElementTag::create() {
   return ElementTag{next_element_tag++};
 }
 
+void bounds::intersects(const Accel* accel, const Element& query,
+                        std::vector<const Element*>& hit, AccelIntersectScratch& scratch) {
+  accel->gather_candidates(ElementTraits::get_aabb(query), scratch.candidates);
+  const auto num_candidates = uint32_t(scratch.candidates.size());
+  if (num_candidates == 0) {
+    return;
+  }
+
+  scratch.bounds.clear();
+  for (uint32_t ci : scratch.candidates) {
+    scratch.bounds.push_back(accel->element(ci).bounds);
+  }
+
+  scratch.hits.resize(num_candidates);
+  const uint32_t num_hit = obb_obb_intersect(query.bounds, scratch.bounds, scratch.hits.data());
+  for (uint32_t i = 0; i < num_hit; i++) {
+    hit.push_back(&accel->element(scratch.candidates[scratch.hits[i]]));
+  }
+}
+
 GROVE_NAMESPACE_END
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "accel_intersect_scratch.hpp"
 #include "grove/math/Octree.hpp"
+#include "grove/math/obb_batch.hpp"
 #include "grove/math/intersect.hpp"
 #include "grove/common/identifier.hpp"
 
@@ -73,4 +75,9 @@ struct ElementTraits {
 
 using Accel = Octree<Element, ElementTraits>;
 
+//  As `accel->intersects(query, hit)`, but testing candidate elements against `query` in batches.
+//  `scratch` can be reused across queries to avoid allocating.
+void intersects(const Accel* accel, const Element& query, std::vector<const Element*>& hit,
+                AccelIntersectScratch& scratch);
+
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "grove/math/intersect.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/logging.hpp"
+#include "grove/common/TaskPool.hpp"
 #include "grove/math/string_cast.hpp"
 #include <iostream>
 #include <sstream>
@@ -11,18 +12,6 @@ GROVE_NAMESPACE_BEGIN
 
 namespace {
 
-inline bool point_obstacle_intersect(const CablePathObstacles& obstacles, const Vec2f& p) {
-  for (const auto& obstacle : obstacles) {
-    const auto& cp = obstacle.position;
-    const auto& cr = obstacle.radius;
-
-    if (point_circle_intersect(p, cp, cr)) {
-      return true;
-    }
-  }
-  return false;
-}
-
 std::vector<Vec2f> make_smooth_path(const std::vector<Vec2f>& raw_path, int num_points_insert) {
   int64_t num_raw = raw_path.size();
 
@@ -92,13 +81,136 @@ std::stringstream make_debug_timing_info(const Vec2f& source, const Vec2f& targe
   return info;
 }
 
-} //  anon
+//  Paths are repaired if an obstacle changes within this distance of one of their segments.
+constexpr float repair_corridor_radius = CablePathFind::large_grid_size;
+constexpr int max_num_obstacle_changes = 256;
 
-CablePathResult CablePathFinder::compute_path(const Vec2f& source, const Vec2f& target) const {
-  if (point_obstacle_intersect(obstacles, source) ||
-      point_obstacle_intersect(obstacles, target)) {
+Bounds2f obstacle_bounds(const CablePathObstacle& obstacle) {
+  //  The segment test of `CablePathFind` treats the radius as a squared radius.
+  const float r = std::max(obstacle.radius, std::sqrt(std::max(0.0f, obstacle.radius)));
+  return Bounds2f{obstacle.position - r, obstacle.position + r};
+}
+
+bool path_corridor_intersects(const std::vector<Vec2f>& path, const Bounds2f& bounds) {
+  for (size_t i = 0; i + 1 < path.size(); i++) {
+    Bounds2f segment{min(path[i], path[i + 1]) - repair_corridor_radius,
+                     max(path[i], path[i + 1]) + repair_corridor_radius};
+    if (aabb_aabb_intersect_closed(segment, bounds)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void log_route(const Vec2f& source, const Vec2f& target, const CablePathResult& result,
+               bool end_points_intersect_obstacle, bool end_point_failed,
+               double dur_ms, double dur_end_pts, int end_pt_iters) {
+  if (end_points_intersect_obstacle) {
     GROVE_LOG_ERROR_CAPTURE_META("Failed to compute path; end points intersect obstacle.",
                                  "CablePathFinder");
+    return;
+  }
+
+  if (end_point_failed) {
+    GROVE_LOG_ERROR_CAPTURE_META("Failed to compute path to end point.", "CablePathFinder");
+  }
+
+  if (dur_ms > 2.0) {
+    auto info = make_debug_timing_info(
+      source, target, result, dur_ms, dur_end_pts, end_pt_iters);
+    std::cout << info.str() << std::endl;
+//    GROVE_LOG_WARNING_CAPTURE_META(info.str().c_str(), "CablePathFinder");
+  }
+
+  if (!result.success) {
+    GROVE_LOG_ERROR_CAPTURE_META("Failed to compute path.", "CablePathFinder");
+  }
+}
+
+} //  anon
+
+CablePathResult CablePathFinder::compute_path(const Vec2f& source, const Vec2f& target) const {
+  CablePathSearchScratch scratch;
+  RouteInfo info{};
+  auto result = compute_route(source, target, scratch, &info);
+  log_route(source, target, result, info.end_points_intersect_obstacle, info.end_point_failed,
+            info.dur_ms, info.dur_end_pts_ms, 0);
+  return result;
+}
+
+void CablePathFinder::compute_paths(CableRoute* routes, int num_routes,
+                                    TaskPool* task_pool) const {
+  require_obstacle_grid();
+
+  const int num_scratch = task_pool ? task_pool->num_workers() + 1 : 1;
+  std::vector<CablePathSearchScratch> scratch(num_scratch);
+  std::vector<RouteInfo> infos(num_routes);
+
+  auto compute = [&](int i, int worker) {
+    auto& route = routes[i];
+    route.result = compute_route(route.source, route.target, scratch[worker], &infos[i]);
+    route.obstacle_version = obstacle_version;
+  };
+
+  if (task_pool) {
+    task_pool->parallel_for(num_routes, compute);
+  } else {
+    for (int i = 0; i < num_routes; i++) {
+      compute(i, 0);
+    }
+  }
+
+  //  Logging is not thread safe.
+  for (int i = 0; i < num_routes; i++) {
+    auto& info = infos[i];
+    log_route(routes[i].source, routes[i].target, routes[i].result,
+              info.end_points_intersect_obstacle, info.end_point_failed,
+              info.dur_ms, info.dur_end_pts_ms, 0);
+  }
+}
+
+void CablePathFinder::repair_paths(CableRoute* routes, int num_routes, TaskPool* task_pool,
+                                   std::vector<int>* repaired) {
+  std::vector<CableRoute> to_repair;
+  std::vector<int> to_repair_indices;
+  for (int i = 0; i < num_routes; i++) {
+    auto& route = routes[i];
+    if (route.obstacle_version == obstacle_version) {
+      continue;
+    }
+    bool affected = !route.result.success;
+    for (auto& change : obstacle_changes) {
+      if (affected) {
+        break;
+      }
+      affected = change.version > route.obstacle_version &&
+                 path_corridor_intersects(route.result.path_positions, change.bounds);
+    }
+    if (affected) {
+      to_repair.push_back({route.source, route.target, {}, 0});
+      to_repair_indices.push_back(i);
+    } else {
+      route.obstacle_version = obstacle_version;
+    }
+  }
+
+  compute_paths(to_repair.data(), int(to_repair.size()), task_pool);
+  obstacle_changes.clear();
+
+  for (size_t i = 0; i < to_repair.size(); i++) {
+    routes[to_repair_indices[i]] = std::move(to_repair[i]);
+  }
+  if (repaired) {
+    repaired->insert(repaired->end(), to_repair_indices.begin(), to_repair_indices.end());
+  }
+}
+
+CablePathResult CablePathFinder::compute_route(const Vec2f& source, const Vec2f& target,
+                                               CablePathSearchScratch& scratch,
+                                               RouteInfo* info) const {
+  auto& grid = require_obstacle_grid();
+  if (grid.point_intersects(source) || grid.point_intersects(target)) {
+    info->end_points_intersect_obstacle = true;
     return {};
   }
 
@@ -109,24 +221,24 @@ CablePathResult CablePathFinder::compute_path(const Vec2f& source, const Vec2f&
   CablePathInstanceData instance_data{&obstacles};
   instance_data.source = source;
   instance_data.target = target;
+  instance_data.obstacle_grid = &grid;
 
   const int num_points_insert_in_path = 3;
 
-  auto path_find_result = CablePathFind::compute_path(instance_data, params);
+  auto path_find_result = CablePathFind::compute_path(instance_data, params, &scratch);
   auto smoothed_path_positions =
     make_smooth_path(path_find_result.path_positions, num_points_insert_in_path);
 
-  double dur_end_pts = 0.0;
-  int end_pt_iters = 0;
-
   if (path_find_result.success && !path_find_result.path_positions.empty()) {
     auto t00 = std::chrono::high_resolution_clock::now();
 
     auto& p0 = path_find_result.path_positions.front();
     auto& p1 = path_find_result.path_positions.back();
 
-    auto from_source = compute_path_end_point(instance_data.source, p0);
-    auto to_target = compute_path_end_point(p1, instance_data.target);
+    auto from_source =
+      compute_path_end_point(instance_data.source, p0, scratch, &info->end_point_failed);
+    auto to_target =
+      compute_path_end_point(p1, instance_data.target, scratch, &info->end_point_failed);
 
     smoothed_path_positions.insert(smoothed_path_positions.begin(),
                                    from_source.begin(), from_source.end());
@@ -134,35 +246,29 @@ CablePathResult CablePathFinder::compute_path(const Vec2f& source, const Vec2f&
               std::back_inserter(smoothed_path_positions));
 
     auto t11 = std::chrono::high_resolution_clock::now();
-    dur_end_pts = std::chrono::duration<double>(t11 - t00).count() * 1e3;
+    info->dur_end_pts_ms = std::chrono::duration<double>(t11 - t00).count() * 1e3;
   }
 
   smoothed_path_positions.insert(smoothed_path_positions.begin(), instance_data.source);
   smoothed_path_positions.push_back(instance_data.target);
 
   auto t1 = std::chrono::high_resolution_clock::now();
-  auto dur_total = std::chrono::duration<double>(t1 - t0);
-  double dur_ms = dur_total.count() * 1e3;
-
-  if (dur_ms > 2.0) {
-    auto info = make_debug_timing_info(
-      source, target, path_find_result, dur_ms, dur_end_pts, end_pt_iters);
-    std::cout << info.str() << std::endl;
-//    GROVE_LOG_WARNING_CAPTURE_META(info.str().c_str(), "CablePathFinder");
-  }
+  info->dur_ms = std::chrono::duration<double>(t1 - t0).count() * 1e3;
 
   if (path_find_result.success) {
     path_find_result.path_positions = std::move(smoothed_path_positions);
-  } else {
-    GROVE_LOG_ERROR_CAPTURE_META("Failed to compute path.", "CablePathFinder");
   }
 
   return path_find_result;
 }
 
-std::vector<Vec2f> CablePathFinder::compute_path_end_point(const Vec2f& p0, const Vec2f& p1) const {
+std::vector<Vec2f> CablePathFinder::compute_path_end_point(const Vec2f& p0, const Vec2f& p1,
+                                                           CablePathSearchScratch& scratch,
+                                                           bool* failed) const {
   CablePathFind::Parameters end_pt_params{};
   end_pt_params.grid_cell_size = CablePathFind::end_point_grid_size;
+  end_pt_params.fail_if_reaches_num_iterations =
+    CablePathFind::end_point_fail_if_reaches_num_iterations;
 
   auto end_pt_dist = (p1 - p0).length();
 
@@ -170,20 +276,44 @@ std::vector<Vec2f> CablePathFinder::compute_path_end_point(const Vec2f& p0, cons
     CablePathInstanceData end_pt_instance{&obstacles};
     end_pt_instance.source = p0;
     end_pt_instance.target = p1;
+    end_pt_instance.obstacle_grid = &require_obstacle_grid();
 
-    auto end_pt_result = CablePathFind::compute_path(end_pt_instance, end_pt_params);
+    auto end_pt_result = CablePathFind::compute_path(end_pt_instance, end_pt_params, &scratch);
 
     if (end_pt_result.success) {
       return end_pt_result.path_positions;
 
     } else {
-      GROVE_LOG_ERROR_CAPTURE_META("Failed to compute path to end point.", "CablePathFinder");
+      *failed = true;
     }
   }
 
   return {};
 }
 
+const CablePathObstacleGrid& CablePathFinder::require_obstacle_grid() const {
+  if (obstacle_grid_dirty) {
+    obstacle_grid.build(obstacles, CablePathFind::large_grid_size);
+    obstacle_grid_dirty = false;
+  }
+  return obstacle_grid;
+}
+
+void CablePathFinder::obstacle_changed(const CablePathObstacle& obstacle) {
+  if (int(obstacle_changes.size()) >= max_num_obstacle_changes) {
+    //  Conservatively merge older changes into one, as of the newest of them, so that routes
+    //  computed between the oldest and newest change are still checked against it.
+    auto merged = obstacle_changes.back();
+    for (auto& change : obstacle_changes) {
+      merged.bounds = union_of(merged.bounds, change.bounds);
+    }
+    obstacle_changes.clear();
+    obstacle_changes.push_back(merged);
+  }
+  obstacle_changes.push_back({obstacle_bounds(obstacle), ++obstacle_version});
+  obstacle_grid_dirty = true;
+}
+
 void CablePathFinder::add_obstacles(const Vec3f* positions,
                                     int num_positions,
                                     float radius,
@@ -208,8 +338,10 @@ void CablePathFinder::modify_obstacle(ObstacleID by_id, const Vec2f& position, f
 
   if (it != obstacle_ids.end()) {
     auto idx = it - obstacle_ids.begin();
+    obstacle_changed(obstacles[idx]);
     obstacles[idx].position = position;
     obstacles[idx].radius = radius;
+    obstacle_changed(obstacles[idx]);
   }
 }
 
@@ -217,6 +349,7 @@ CablePathFinder::ObstacleID CablePathFinder::add_obstacle(const CablePathObstacl
   auto next_id = next_obstacle_id++;
   obstacles.push_back(obstacle);
   obstacle_ids.push_back(next_id);
+  obstacle_changed(obstacle);
   return next_id;
 }
 
@@ -228,6 +361,7 @@ void CablePathFinder::remove_obstacle(ObstacleID id) {
   }
 
   auto idx = it - obstacle_ids.begin();
+  obstacle_changed(obstacles[idx]);
   obstacle_ids.erase(it);
   obstacles.erase(obstacles.begin() + idx);
 }
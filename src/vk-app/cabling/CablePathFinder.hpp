@@ -1,9 +1,19 @@
 #pragma once
 
 #include "path_find.hpp"
+#include "grove/math/Bounds2.hpp"
 
 namespace grove {
 
+class TaskPool;
+
+struct CableRoute {
+  Vec2f source;
+  Vec2f target;
+  CablePathResult result;
+  uint64_t obstacle_version{};  //  Version of the obstacles `result` was computed against.
+};
+
 class CablePathFinder {
   using ObstacleID = uint64_t;
 
@@ -19,15 +29,46 @@ public:
 
 public:
   CablePathResult compute_path(const Vec2f& source, const Vec2f& target) const;
+  //  Computes the `result` of each route, in parallel if `task_pool` is non-null.
+  void compute_paths(CableRoute* routes, int num_routes, TaskPool* task_pool) const;
+  //  Recomputes the routes that failed, or whose path passes near an obstacle added, removed or
+  //  moved since the route was computed. `routes` should hold every route of this finder:
+  //  afterwards, changes that every route reflects are forgotten. Indices of recomputed routes
+  //  are appended to `repaired`, if non-null.
+  void repair_paths(CableRoute* routes, int num_routes, TaskPool* task_pool,
+                    std::vector<int>* repaired = nullptr);
 
 private:
-  std::vector<Vec2f> compute_path_end_point(const Vec2f& p0, const Vec2f& p1) const;
+  struct RouteInfo {
+    bool end_points_intersect_obstacle;
+    bool end_point_failed;
+    double dur_ms;
+    double dur_end_pts_ms;
+  };
+
+  CablePathResult compute_route(const Vec2f& source, const Vec2f& target,
+                                CablePathSearchScratch& scratch, RouteInfo* info) const;
+  std::vector<Vec2f> compute_path_end_point(const Vec2f& p0, const Vec2f& p1,
+                                            CablePathSearchScratch& scratch,
+                                            bool* failed) const;
+  const CablePathObstacleGrid& require_obstacle_grid() const;
   ObstacleID add_obstacle(const CablePathObstacle& obstacle);
+  void obstacle_changed(const CablePathObstacle& obstacle);
 
 private:
   std::vector<CablePathObstacle> obstacles;
   std::vector<ObstacleID> obstacle_ids;
   uint64_t next_obstacle_id{1};
+
+  struct ObstacleChange {
+    Bounds2f bounds;
+    uint64_t version;
+  };
+
+  mutable CablePathObstacleGrid obstacle_grid;
+  mutable bool obstacle_grid_dirty{true};
+  uint64_t obstacle_version{};
+  std::vector<ObstacleChange> obstacle_changes;
 };
 
-}
\ No newline at end of file
+}
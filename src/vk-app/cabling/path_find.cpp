@@ -4,10 +4,9 @@
 #include "grove/math/constants.hpp"
 #include "grove/math/string_cast.hpp"
 #include "grove/math/random.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
-#include <unordered_map>
-#include <unordered_set>
-#include <queue>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -16,14 +15,9 @@ namespace {
 using CellIndex = Vec2<int32_t>;
 using CellKey = uint64_t;
 
-struct Score {
-  float f;
-  float g;
-};
-
-template <typename T>
-using ScoreMap = std::unordered_map<CellKey, T>;
+using Node = CablePathSearchScratch::Node;
 
+constexpr int32_t no_node = -1;
 inline CellIndex cell_index(const Vec2f& position, float grid_cell_size) {
   auto ind = grove::floor(position / grid_cell_size);
   return {int32_t(ind.x), int32_t(ind.y)};
@@ -64,29 +58,55 @@ inline Vec2f cell_position(const CellIndex& index, float grid_cell_size) {
   return res * grid_cell_size;
 }
 
+//  Obstacles can be within reach of a test up to this far outside the circle, due to rounding.
+constexpr float obstacle_bounds_padding = 1e-3f;
+
+//  `ray_circle_intersect` takes the squared radius, so the ray test uses a circle of radius
+//  sqrt(radius) where the point test uses one of radius `radius`.
+inline float obstacle_reach(const CablePathObstacle& obstacle) {
+  const float r = std::max(obstacle.radius, std::sqrt(std::max(0.0f, obstacle.radius)));
+  return r + obstacle_bounds_padding;
+}
+
+inline bool point_intersects(const CablePathObstacle& obstacle, const Vec2f& p) {
+  return point_circle_intersect(p, obstacle.position, obstacle.radius);
+}
+
+inline bool ray_intersects(const CablePathObstacle& obstacle, const Vec2f& ro, const Vec2f& rd) {
+  float t0;
+  float t1;
+  return ray_circle_intersect(ro, rd, obstacle.position, obstacle.radius, &t0, &t1) &&
+         t0 >= 0 && t1 >= 0 && (t0 < 1 || t1 < 1);
+}
+
 inline bool point_obstacle_intersect(const CablePathObstacles& obstacles, const Vec2f& p) {
   for (const auto& obstacle : obstacles) {
-    const auto& cp = obstacle.position;
-    const auto& cr = obstacle.radius;
-
-    if (point_circle_intersect(p, cp, cr)) {
+    if (point_intersects(obstacle, p)) {
       return true;
     }
   }
   return false;
 }
 
+inline bool point_obstacle_intersect(const CablePathInstanceData& instance, const Vec2f& p) {
+  if (instance.obstacle_grid) {
+    return instance.obstacle_grid->point_intersects(p);
+  } else {
+    return point_obstacle_intersect(*instance.obstacles, p);
+  }
+}
+
 inline bool ray_obstacle_intersect(const CablePathInstanceData& instance,
                                    const Vec2f& p0, const Vec2f& p1) {
+  if (instance.obstacle_grid) {
+    return instance.obstacle_grid->ray_intersects(p0, p1);
+  }
+
   auto rd = p1 - p0;
   auto ro = p0;
 
   for (const auto& obstacle : *instance.obstacles) {
-    float t0;
-    float t1;
-
-    if (ray_circle_intersect(ro, rd, obstacle.position, obstacle.radius, &t0, &t1) &&
-        t0 >= 0 && t1 >= 0 && (t0 < 1 || t1 < 1)) {
+    if (ray_intersects(obstacle, ro, rd)) {
       return true;
     }
   }
@@ -97,7 +117,7 @@ inline bool ray_obstacle_intersect(const CablePathInstanceData& instance,
 inline float cost_function(const CablePathInstanceData& instance, const Vec2f& node_position) {
   const auto targ = instance.target;
 
-  if (point_obstacle_intersect(*instance.obstacles, node_position)) {
+  if (point_obstacle_intersect(instance, node_position)) {
     return grove::infinityf();
   } else {
     auto to_targ = node_position - targ;
@@ -105,44 +125,259 @@ inline float cost_function(const CablePathInstanceData& instance, const Vec2f& n
   }
 }
 
-std::vector<Vec2f> reconstruct_path(const ScoreMap<CellKey>& came_from,
-                                    CellIndex current,
-                                    float grid_cell_size) {
-  std::vector<Vec2f> result;
+/*
+ * Node table
+ */
 
+inline uint64_t hash_cell_key(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdull;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ull;
+  key ^= key >> 33;
+  return key;
+}
+
+void insert_slot(std::vector<int32_t>& slots, CellKey key, int32_t node) {
+  const auto mask = uint64_t(slots.size() - 1);
+  auto slot = hash_cell_key(key) & mask;
+  while (slots[slot] != no_node) {
+    slot = (slot + 1) & mask;
+  }
+  slots[slot] = node;
+}
+
+int32_t find_node(const CablePathSearchScratch& scratch, CellKey key) {
+  const auto mask = uint64_t(scratch.slots.size() - 1);
+  auto slot = hash_cell_key(key) & mask;
   while (true) {
-    auto key = cell_index_key(current);
+    const int32_t node = scratch.slots[slot];
+    if (node == no_node || scratch.nodes[node].key == key) {
+      return node;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+int32_t add_node(CablePathSearchScratch& scratch, CellKey key) {
+  const auto node = int32_t(scratch.nodes.size());
+  scratch.nodes.push_back({key, infinityf(), infinityf(), no_node, no_node});
+
+  if (scratch.nodes.size() * 2 > scratch.slots.size()) {
+    scratch.slots.assign(scratch.slots.size() * 2, no_node);
+    for (int32_t i = 0; i < int32_t(scratch.nodes.size()); i++) {
+      insert_slot(scratch.slots, scratch.nodes[i].key, i);
+    }
+  } else {
+    insert_slot(scratch.slots, key, node);
+  }
+
+  return node;
+}
+
+/*
+ * Open set
+ */
 
-    if (came_from.count(key) == 0) {
+inline bool heap_less(const CablePathSearchScratch& scratch, int32_t a, int32_t b) {
+  const auto& na = scratch.nodes[a];
+  const auto& nb = scratch.nodes[b];
+  //  Among equal estimates, prefer the node further along its path.
+  return na.f < nb.f || (na.f == nb.f && na.g > nb.g);
+}
+
+inline void heap_set(CablePathSearchScratch& scratch, int32_t index, int32_t node) {
+  scratch.heap[index] = node;
+  scratch.nodes[node].heap_index = index;
+}
+
+void heap_sift_up(CablePathSearchScratch& scratch, int32_t index) {
+  const int32_t node = scratch.heap[index];
+  while (index > 0) {
+    const int32_t parent = (index - 1) / 2;
+    if (!heap_less(scratch, node, scratch.heap[parent])) {
+      break;
+    }
+    heap_set(scratch, index, scratch.heap[parent]);
+    index = parent;
+  }
+  heap_set(scratch, index, node);
+}
+
+void heap_sift_down(CablePathSearchScratch& scratch, int32_t index) {
+  const auto size = int32_t(scratch.heap.size());
+  const int32_t node = scratch.heap[index];
+  while (true) {
+    int32_t child = index * 2 + 1;
+    if (child >= size) {
       break;
     }
+    if (child + 1 < size && heap_less(scratch, scratch.heap[child + 1], scratch.heap[child])) {
+      child++;
+    }
+    if (!heap_less(scratch, scratch.heap[child], node)) {
+      break;
+    }
+    heap_set(scratch, index, scratch.heap[child]);
+    index = child;
+  }
+  heap_set(scratch, index, node);
+}
+
+void heap_push(CablePathSearchScratch& scratch, int32_t node) {
+  scratch.heap.push_back(node);
+  heap_sift_up(scratch, int32_t(scratch.heap.size()) - 1);
+}
+
+int32_t heap_pop(CablePathSearchScratch& scratch) {
+  const int32_t top = scratch.heap[0];
+  const int32_t last = scratch.heap.back();
+  scratch.heap.pop_back();
+  if (!scratch.heap.empty()) {
+    heap_set(scratch, 0, last);
+    heap_sift_down(scratch, 0);
+  }
+  scratch.nodes[top].heap_index = no_node;
+  return top;
+}
+
+void heap_update(CablePathSearchScratch& scratch, int32_t node) {
+  const int32_t index = scratch.nodes[node].heap_index;
+  heap_sift_up(scratch, index);
+  heap_sift_down(scratch, scratch.nodes[node].heap_index);
+}
+
+std::vector<Vec2f> reconstruct_path(const CablePathSearchScratch& scratch,
+                                    int32_t current,
+                                    float grid_cell_size) {
+  std::vector<Vec2f> result;
 
-    auto from = key_to_cell_index(came_from.at(key));
-    auto from_p = cell_position(from, grid_cell_size);
-    result.insert(result.begin(), from_p);
-    current = from;
+  while (scratch.nodes[current].came_from != no_node) {
+    current = scratch.nodes[current].came_from;
+    auto from = key_to_cell_index(scratch.nodes[current].key);
+    result.push_back(cell_position(from, grid_cell_size));
   }
 
+  std::reverse(result.begin(), result.end());
   return result;
 }
 
 } //  anon
 
-struct ScoreComparator {
-  ScoreComparator(const ScoreMap<Score>* scores) : scores(scores) {
-    //
+/*
+ * CablePathObstacleGrid
+ */
+
+void CablePathObstacleGrid::build(const CablePathObstacles& obstacles, float size) {
+  bin_offsets.clear();
+  binned_obstacles.clear();
+  num_bins = {};
+
+  if (obstacles.empty()) {
+    bin_offsets.push_back(0);
+    return;
+  }
+
+  Vec2f p0{infinityf()};
+  Vec2f p1{-infinityf()};
+  for (auto& obstacle : obstacles) {
+    const float r = obstacle_reach(obstacle);
+    p0 = min(p0, obstacle.position - r);
+    p1 = max(p1, obstacle.position + r);
+  }
+
+  const auto span = p1 - p0;
+  const auto max_bins = float(max_num_bins_per_dim);
+  origin = p0;
+  bin_size = std::max(size, std::max(span.x, span.y) / max_bins);
+  num_bins.x = std::min(max_num_bins_per_dim, int(span.x / bin_size) + 1);
+  num_bins.y = std::min(max_num_bins_per_dim, int(span.y / bin_size) + 1);
+
+  auto bin_range = [this](const CablePathObstacle& obstacle, Vec2<int>* b0, Vec2<int>* b1) {
+    const float r = obstacle_reach(obstacle);
+    auto f0 = grove::floor((obstacle.position - r - origin) / bin_size);
+    auto f1 = grove::floor((obstacle.position + r - origin) / bin_size);
+    *b0 = {std::max(0, int(f0.x)), std::max(0, int(f0.y))};
+    *b1 = {std::min(num_bins.x - 1, int(f1.x)), std::min(num_bins.y - 1, int(f1.y))};
+  };
+
+  bin_offsets.resize(num_bins.x * num_bins.y + 1);
+  for (auto& obstacle : obstacles) {
+    Vec2<int> b0;
+    Vec2<int> b1;
+    bin_range(obstacle, &b0, &b1);
+    for (int j = b0.y; j <= b1.y; j++) {
+      for (int i = b0.x; i <= b1.x; i++) {
+        bin_offsets[j * num_bins.x + i + 1]++;
+      }
+    }
+  }
+
+  for (size_t i = 1; i < bin_offsets.size(); i++) {
+    bin_offsets[i] += bin_offsets[i - 1];
+  }
+
+  std::vector<uint32_t> next(bin_offsets.begin(), bin_offsets.end() - 1);
+  binned_obstacles.resize(bin_offsets.back());
+  for (auto& obstacle : obstacles) {
+    Vec2<int> b0;
+    Vec2<int> b1;
+    bin_range(obstacle, &b0, &b1);
+    for (int j = b0.y; j <= b1.y; j++) {
+      for (int i = b0.x; i <= b1.x; i++) {
+        binned_obstacles[next[j * num_bins.x + i]++] = obstacle;
+      }
+    }
   }
+}
 
-  inline bool operator()(const CellIndex& a, const CellIndex& b) const noexcept {
-    auto key_a = cell_index_key(a);
-    auto key_b = cell_index_key(b);
-    return scores->at(key_a).f > scores->at(key_b).f;
+template <typename F>
+bool CablePathObstacleGrid::any_in_bins(const Vec2f& p0, const Vec2f& p1, F&& f) const {
+  const Vec2f max_bin{float(num_bins.x), float(num_bins.y)};
+  auto f0 = clamp_each(grove::floor((p0 - origin) / bin_size), Vec2f{-1.0f}, max_bin);
+  auto f1 = clamp_each(grove::floor((p1 - origin) / bin_size), Vec2f{-1.0f}, max_bin);
+  const int i0 = std::max(0, int(f0.x));
+  const int j0 = std::max(0, int(f0.y));
+  const int i1 = std::min(num_bins.x - 1, int(f1.x));
+  const int j1 = std::min(num_bins.y - 1, int(f1.y));
+
+  for (int j = j0; j <= j1; j++) {
+    for (int i = i0; i <= i1; i++) {
+      const int bin = j * num_bins.x + i;
+      for (uint32_t k = bin_offsets[bin]; k < bin_offsets[bin + 1]; k++) {
+        if (f(binned_obstacles[k])) {
+          return true;
+        }
+      }
+    }
   }
 
-  const ScoreMap<Score>* scores;
-};
+  return false;
+}
+
+bool CablePathObstacleGrid::point_intersects(const Vec2f& p) const {
+  return any_in_bins(p, p, [&p](const CablePathObstacle& obstacle) {
+    return grove::point_intersects(obstacle, p);
+  });
+}
+
+bool CablePathObstacleGrid::ray_intersects(const Vec2f& p0, const Vec2f& p1) const {
+  const auto rd = p1 - p0;
+  return any_in_bins(min(p0, p1), max(p0, p1), [&p0, &rd](const CablePathObstacle& obstacle) {
+    return grove::ray_intersects(obstacle, p0, rd);
+  });
+}
 
-using OpenSet = std::priority_queue<CellIndex, std::vector<CellIndex>, ScoreComparator>;
+/*
+ * CablePathSearchScratch
+ */
+
+void CablePathSearchScratch::clear() {
+  constexpr size_t min_num_slots = 256;
+  nodes.clear();
+  heap.clear();
+  slots.assign(std::max(min_num_slots, slots.size()), no_node);
+}
 
 /*
  * CablePathInstanceData
@@ -158,47 +393,35 @@ CablePathInstanceData::CablePathInstanceData(const std::vector<CablePathObstacle
  */
 
 CablePathResult CablePathFind::compute_path(CablePathInstanceData& instance,
-                                            const Parameters& params) {
+                                            const Parameters& params,
+                                            CablePathSearchScratch* scratch) {
   CablePathResult result;
   result.success = false;
   result.computed_in_num_iters = -1;
 
-  ScoreMap<CellKey> came_from;
-  ScoreMap<Score> scores;
-  std::unordered_set<CellKey> in_open_set;
+  CablePathSearchScratch local_scratch;
+  auto& search = scratch ? *scratch : local_scratch;
+  search.clear();
 
   const auto cell_size = params.grid_cell_size;
   auto index_source = cell_index(instance.source, cell_size);
-  auto key_source = cell_index_key(index_source);
-
-  scores[key_source] = {
-    cost_function(instance, cell_position(index_source, cell_size)),
-    0
-  };
-
-  ScoreComparator score_comparator{&scores};
-  OpenSet open_set{score_comparator};
-
-  open_set.push(index_source);
-  in_open_set.insert(key_source);
+  auto source_node = add_node(search, cell_index_key(index_source));
+  search.nodes[source_node].f = cost_function(instance, cell_position(index_source, cell_size));
+  search.nodes[source_node].g = 0;
+  heap_push(search, source_node);
 
   int64_t num_iters = 0;
 
-  while (!open_set.empty()) {
+  while (!search.heap.empty()) {
     num_iters++;
 
-    auto current = open_set.top();
-    open_set.pop();
+    const int32_t current_node = heap_pop(search);
+    const auto current = key_to_cell_index(search.nodes[current_node].key);
+    const auto g_current = search.nodes[current_node].g;
+    const auto p_current = cell_position(current, cell_size);
 
-    auto key_current = cell_index_key(current);
-    auto g_current = scores.at(key_current).g;
-    auto p_current = cell_position(current, cell_size);
-
-    in_open_set.erase(key_current);
-    assert(in_open_set.size() == open_set.size());
-
-    if (in_open_set.size() >= CablePathFind::fail_if_open_set_reaches_size ||
-        num_iters >= CablePathFind::fail_if_reaches_num_iterations) {
+    if (int64_t(search.heap.size()) >= CablePathFind::fail_if_open_set_reaches_size ||
+        num_iters >= params.fail_if_reaches_num_iterations) {
       return result;
     }
 
@@ -209,7 +432,7 @@ CablePathResult CablePathFind::compute_path(CablePathInstanceData& instance,
     if (success_stop_crit) {
       result.success = true;
       result.computed_in_num_iters = num_iters;
-      result.path_positions = reconstruct_path(came_from, current, cell_size);
+      result.path_positions = reconstruct_path(search, current_node, cell_size);
       return result;
     }
 
@@ -228,35 +451,31 @@ CablePathResult CablePathFind::compute_path(CablePathInstanceData& instance,
         auto neighbor = current + neighbor_offset;
         auto p_neighbor = cell_position(neighbor, cell_size);
 
-        float edge_weight;
-
         if (ray_obstacle_intersect(instance, p_current, p_neighbor)) {
-          edge_weight = infinityf();
-        } else {
-          edge_weight = (p_neighbor - p_current).length();
+          //  An infinite edge weight never improves the neighbor's score.
+          continue;
         }
 
-        auto tentative_score = g_current + edge_weight;
+        auto tentative_score = g_current + (p_neighbor - p_current).length();
         auto key_neighbor = cell_index_key(neighbor);
 
-        float g_neighbor = infinityf();
-        if (scores.count(key_neighbor) > 0) {
-          g_neighbor = scores.at(key_neighbor).g;
+        int32_t neighbor_node = find_node(search, key_neighbor);
+        if (neighbor_node != no_node && !(tentative_score < search.nodes[neighbor_node].g)) {
+          continue;
+        }
+        if (neighbor_node == no_node) {
+          neighbor_node = add_node(search, key_neighbor);
         }
 
-        if (tentative_score < g_neighbor) {
-          auto f_neighbor = cost_function(instance, p_neighbor);
-
-          came_from[key_neighbor] = key_current;
-          scores[key_neighbor] = {
-            tentative_score + f_neighbor,
-            tentative_score
-          };
+        auto& node = search.nodes[neighbor_node];
+        node.came_from = current_node;
+        node.g = tentative_score;
+        node.f = tentative_score + cost_function(instance, p_neighbor);
 
-          if (in_open_set.count(key_neighbor) == 0) {
-            open_set.push(neighbor);
-            in_open_set.insert(key_neighbor);
-          }
+        if (node.heap_index == no_node) {
+          heap_push(search, neighbor_node);
+        } else {
+          heap_update(search, neighbor_node);
         }
       }
     }
@@ -12,6 +12,59 @@ struct CablePathObstacle {
 
 using CablePathObstacles = std::vector<CablePathObstacle>;
 
+/*
+ * CablePathObstacleGrid
+ *
+ * Copies of the obstacles binned into a uniform grid, so that point and segment tests visit only
+ * the obstacles near the query. Results match testing every obstacle.
+ */
+class CablePathObstacleGrid {
+public:
+  static constexpr int max_num_bins_per_dim = 512;
+
+public:
+  void build(const CablePathObstacles& obstacles, float bin_size);
+
+  bool point_intersects(const Vec2f& p) const;
+  //  True if the segment p0-p1 enters an obstacle; segments that start inside one do not count.
+  bool ray_intersects(const Vec2f& p0, const Vec2f& p1) const;
+
+private:
+  template <typename F>
+  bool any_in_bins(const Vec2f& p0, const Vec2f& p1, F&& f) const;
+
+private:
+  Vec2f origin{};
+  float bin_size{1.0f};
+  Vec2<int> num_bins{};
+  //  Obstacles of bin `i` are binned_obstacles[bin_offsets[i], bin_offsets[i + 1]).
+  std::vector<uint32_t> bin_offsets;
+  std::vector<CablePathObstacle> binned_obstacles;
+};
+
+/*
+ * CablePathSearchScratch
+ *
+ * Search state reused across calls to `CablePathFind::compute_path`. Visited cells are stored
+ * in a flat array, indexed through an open-addressed table of cell keys; the open set is a
+ * binary heap of node indices.
+ */
+struct CablePathSearchScratch {
+  struct Node {
+    uint64_t key;
+    float f;
+    float g;
+    int32_t came_from;
+    int32_t heap_index;  //  -1 if not in the open set.
+  };
+
+  void clear();
+
+  std::vector<Node> nodes;
+  std::vector<int32_t> slots;
+  std::vector<int32_t> heap;
+};
+
 struct CablePathResult {
   bool success{};
   std::vector<Vec2f> path_positions;
@@ -32,6 +85,8 @@ public:
   Vec2f target;
 
   const CablePathObstacles* obstacles;
+  //  If non-null, used for obstacle tests in place of `obstacles`.
+  const CablePathObstacleGrid* obstacle_grid{};
 };
 
 class CablePathFind {
@@ -40,15 +95,19 @@ public:
   static constexpr int64_t fail_if_reaches_num_iterations = int64_t(1e5);
   static constexpr float large_grid_size = 2.0f;
   static constexpr float end_point_grid_size = 0.5f;
+  //  End point searches span a few cells; one that runs longer is walled in by obstacles.
+  static constexpr int64_t end_point_fail_if_reaches_num_iterations = 2000;
 
 public:
   struct Parameters {
     float grid_cell_size = large_grid_size;
+    int64_t fail_if_reaches_num_iterations = CablePathFind::fail_if_reaches_num_iterations;
   };
 
 public:
   static CablePathResult compute_path(CablePathInstanceData& instance,
-                                      const Parameters& params);
+                                      const Parameters& params,
+                                      CablePathSearchScratch* scratch = nullptr);
 };
 
 }
\ No newline at end of file
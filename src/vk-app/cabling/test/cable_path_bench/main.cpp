@@ -0,0 +1,329 @@
+#include "vk-app/cabling/CablePathFinder.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/math/intersect.hpp"
+#include "grove/math/constants.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_obstacles = 3000;
+  static constexpr float world_span = 300.0f;
+  static constexpr int num_tests = 200000;
+  static constexpr int num_routes = 64;
+  static constexpr float min_route_length = 20.0f;
+  static constexpr float max_route_length = 100.0f;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+bool any_point_intersect(const CablePathObstacles& obstacles, const Vec2f& p) {
+  for (auto& obstacle : obstacles) {
+    if (point_circle_intersect(p, obstacle.position, obstacle.radius)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool any_ray_intersect(const CablePathObstacles& obstacles, const Vec2f& p0, const Vec2f& p1) {
+  for (auto& obstacle : obstacles) {
+    float t0;
+    float t1;
+    if (ray_circle_intersect(p0, p1 - p0, obstacle.position, obstacle.radius, &t0, &t1) &&
+        t0 >= 0 && t1 >= 0 && (t0 < 1 || t1 < 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * The previous search: a std::priority_queue open set ordered by scores in a std::unordered_map,
+ * with every obstacle tested for every cell and edge.
+ */
+
+using CellIndex = Vec2<int32_t>;
+
+uint64_t to_key(const CellIndex& index) {
+  return uint64_t(uint32_t(index.x)) | (uint64_t(uint32_t(index.y)) << 32);
+}
+
+CellIndex to_cell(uint64_t key) {
+  return {int32_t(uint32_t(key)), int32_t(uint32_t(key >> 32))};
+}
+
+CablePathResult reference_compute_path(const CablePathObstacles& obstacles, const Vec2f& source,
+                                       const Vec2f& target, float cell_size) {
+  struct Score {
+    float f;
+    float g;
+  };
+  std::unordered_map<uint64_t, uint64_t> came_from;
+  std::unordered_map<uint64_t, Score> scores;
+  std::unordered_set<uint64_t> in_open_set;
+
+  auto position = [cell_size](const CellIndex& c) {
+    return Vec2f{float(c.x), float(c.y)} * cell_size;
+  };
+  auto cost = [&](const Vec2f& p) {
+    return any_point_intersect(obstacles, p) ? infinityf() : (p - target).length();
+  };
+  auto cmp = [&scores](const CellIndex& a, const CellIndex& b) {
+    return scores.at(to_key(a)).f > scores.at(to_key(b)).f;
+  };
+  std::priority_queue<CellIndex, std::vector<CellIndex>, decltype(cmp)> open_set{cmp};
+
+  CablePathResult result;
+  auto ind = floor(source / cell_size);
+  CellIndex src{int32_t(ind.x), int32_t(ind.y)};
+  scores[to_key(src)] = {cost(position(src)), 0};
+  open_set.push(src);
+  in_open_set.insert(to_key(src));
+
+  int64_t num_iters = 0;
+  while (!open_set.empty()) {
+    num_iters++;
+    auto current = open_set.top();
+    open_set.pop();
+    auto key_current = to_key(current);
+    auto g_current = scores.at(key_current).g;
+    auto p_current = position(current);
+    in_open_set.erase(key_current);
+
+    if (int64_t(in_open_set.size()) >= CablePathFind::fail_if_open_set_reaches_size ||
+        num_iters >= CablePathFind::fail_if_reaches_num_iterations) {
+      return result;
+    }
+
+    if (std::abs(p_current.x - target.x) <= cell_size &&
+        std::abs(p_current.y - target.y) <= cell_size) {
+      result.success = true;
+      result.computed_in_num_iters = num_iters;
+      while (came_from.count(to_key(current))) {
+        current = to_cell(came_from.at(to_key(current)));
+        result.path_positions.insert(result.path_positions.begin(), position(current));
+      }
+      return result;
+    }
+
+    for (int i = -1; i <= 1; i++) {
+      for (int j = -1; j <= 1; j++) {
+        if (i == 0 && j == 0) {
+          continue;
+        }
+        auto neighbor = current + CellIndex{i, j};
+        auto p_neighbor = position(neighbor);
+        float edge_weight = any_ray_intersect(obstacles, p_current, p_neighbor) ?
+          infinityf() : (p_neighbor - p_current).length();
+        auto tentative = g_current + edge_weight;
+        auto key_neighbor = to_key(neighbor);
+        float g_neighbor = scores.count(key_neighbor) ? scores.at(key_neighbor).g : infinityf();
+        if (tentative < g_neighbor) {
+          came_from[key_neighbor] = key_current;
+          scores[key_neighbor] = {tentative + cost(p_neighbor), tentative};
+          if (in_open_set.count(key_neighbor) == 0) {
+            open_set.push(neighbor);
+            in_open_set.insert(key_neighbor);
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+float path_length(const std::vector<Vec2f>& path) {
+  float result{};
+  for (size_t i = 1; i < path.size(); i++) {
+    result += (path[i] - path[i - 1]).length();
+  }
+  return result;
+}
+
+bool same_path(const CablePathResult& a, const CablePathResult& b) {
+  return a.success == b.success && a.path_positions.size() == b.path_positions.size() &&
+         std::memcmp(a.path_positions.data(), b.path_positions.data(),
+                     a.path_positions.size() * sizeof(Vec2f)) == 0;
+}
+
+} //  anon
+
+int main(int, char**) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<float> pos_dis(-Config::world_span * 0.5f,
+                                                Config::world_span * 0.5f);
+  std::uniform_real_distribution<float> radius_dis(0.5f, 2.5f);
+
+  CablePathFinder finder;
+  CablePathObstacles obstacles;
+  std::vector<uint64_t> obstacle_ids;
+  for (int i = 0; i < Config::num_obstacles; i++) {
+    CablePathObstacle obstacle{Vec2f{pos_dis(gen), pos_dis(gen)}, radius_dis(gen)};
+    obstacles.push_back(obstacle);
+    obstacle_ids.push_back(finder.add_obstacle(obstacle.position, obstacle.radius));
+  }
+
+  uint32_t num_mismatch{};
+
+  {
+    CablePathObstacleGrid grid;
+    grid.build(obstacles, CablePathFind::large_grid_size);
+
+    std::uniform_real_distribution<float> step_dis(-3.0f, 3.0f);
+    std::vector<Vec2f> ps(Config::num_tests);
+    std::vector<Vec2f> steps(Config::num_tests);
+    for (int i = 0; i < Config::num_tests; i++) {
+      ps[i] = Vec2f{pos_dis(gen), pos_dis(gen)} * 1.1f;
+      steps[i] = Vec2f{step_dis(gen), step_dis(gen)};
+    }
+
+    int num_hit{};
+    std::vector<uint8_t> scan_hits(Config::num_tests * 2);
+    const double scan_ms = time_ms([&]() {
+      for (int i = 0; i < Config::num_tests; i++) {
+        scan_hits[i * 2] = any_point_intersect(obstacles, ps[i]);
+        scan_hits[i * 2 + 1] = any_ray_intersect(obstacles, ps[i], ps[i] + steps[i]);
+      }
+    });
+    std::vector<uint8_t> grid_hits(Config::num_tests * 2);
+    const double grid_ms = time_ms([&]() {
+      for (int i = 0; i < Config::num_tests; i++) {
+        grid_hits[i * 2] = grid.point_intersects(ps[i]);
+        grid_hits[i * 2 + 1] = grid.ray_intersects(ps[i], ps[i] + steps[i]);
+      }
+    });
+    for (size_t i = 0; i < scan_hits.size(); i++) {
+      num_mismatch += uint32_t(scan_hits[i] != grid_hits[i]);
+      num_hit += scan_hits[i];
+    }
+    std::cout << Config::num_tests << " point and segment tests against " << obstacles.size()
+              << " obstacles (" << num_hit << " hit); scan: " << scan_ms << "ms; grid: "
+              << grid_ms << "ms" << std::endl;
+  }
+
+  std::vector<CableRoute> routes;
+  std::uniform_real_distribution<float> length_dis(Config::min_route_length,
+                                                   Config::max_route_length);
+  std::uniform_real_distribution<float> angle_dis(0.0f, 2.0f * pif());
+  while (int(routes.size()) < Config::num_routes) {
+    Vec2f p0{pos_dis(gen), pos_dis(gen)};
+    const float theta = angle_dis(gen);
+    Vec2f p1 = p0 + Vec2f{std::cos(theta), std::sin(theta)} * length_dis(gen);
+    if (!any_point_intersect(obstacles, p0) && !any_point_intersect(obstacles, p1)) {
+      routes.push_back({p0, p1, {}});
+    }
+  }
+
+  {
+    std::vector<CablePathResult> ref_results(routes.size());
+    const double ref_ms = time_ms([&]() {
+      for (size_t i = 0; i < routes.size(); i++) {
+        ref_results[i] = reference_compute_path(
+          obstacles, routes[i].source, routes[i].target, CablePathFind::large_grid_size);
+      }
+    });
+
+    CablePathObstacleGrid grid;
+    grid.build(obstacles, CablePathFind::large_grid_size);
+    CablePathSearchScratch scratch;
+    std::vector<CablePathResult> results(routes.size());
+    const double ms = time_ms([&]() {
+      for (size_t i = 0; i < routes.size(); i++) {
+        CablePathInstanceData instance{&obstacles};
+        instance.source = routes[i].source;
+        instance.target = routes[i].target;
+        instance.obstacle_grid = &grid;
+        CablePathFind::Parameters params{};
+        results[i] = CablePathFind::compute_path(instance, params, &scratch);
+      }
+    });
+
+    int num_success{};
+    double length_ratio{};
+    for (size_t i = 0; i < routes.size(); i++) {
+      num_mismatch += uint32_t(ref_results[i].success != results[i].success);
+      if (ref_results[i].success && results[i].success) {
+        num_success++;
+        length_ratio += path_length(results[i].path_positions) /
+                        std::max(1e-3f, path_length(ref_results[i].path_positions));
+      }
+    }
+    std::cout << routes.size() << " searches (" << num_success << " found); reference: "
+              << ref_ms << "ms; heap + grid: " << ms << "ms; mean path length ratio: "
+              << length_ratio / std::max(1, num_success) << std::endl;
+  }
+
+  {
+    std::vector<CableRoute> serial_routes = routes;
+    const double serial_ms = time_ms([&]() {
+      finder.compute_paths(serial_routes.data(), int(serial_routes.size()), nullptr);
+    });
+
+    TaskPool pool;
+    pool.start(TaskPool::default_num_worker_threads());
+    const double parallel_ms = time_ms([&]() {
+      finder.compute_paths(routes.data(), int(routes.size()), &pool);
+    });
+    for (size_t i = 0; i < routes.size(); i++) {
+      num_mismatch += uint32_t(!same_path(routes[i].result, serial_routes[i].result));
+    }
+    std::cout << routes.size() << " routes; serial: " << serial_ms << "ms; "
+              << pool.num_workers() + 1 << " thread(s): " << parallel_ms << "ms" << std::endl;
+
+    //  Move an obstacle onto the first route; only routes near its old or new position are
+    //  recomputed, and they match routing from scratch.
+    auto& path = routes[0].result.path_positions;
+    const Vec2f moved_to = path[path.size() / 2];
+    std::vector<int> repaired;
+    finder.repair_paths(routes.data(), int(routes.size()), &pool, &repaired);
+    num_mismatch += uint32_t(!repaired.empty());
+
+    finder.modify_obstacle(obstacle_ids[0], moved_to, 1.0f);
+    const double repair_ms = time_ms([&]() {
+      finder.repair_paths(routes.data(), int(routes.size()), &pool, &repaired);
+    });
+    num_mismatch += uint32_t(repaired.empty() || repaired[0] != 0);
+
+    auto fresh_routes = routes;
+    finder.compute_paths(fresh_routes.data(), int(fresh_routes.size()), &pool);
+    for (int i : repaired) {
+      num_mismatch += uint32_t(!same_path(routes[i].result, fresh_routes[i].result));
+    }
+    std::cout << "repair after moving an obstacle: " << repaired.size() << " of "
+              << routes.size() << " routes in " << repair_ms << "ms" << std::endl;
+
+    //  Recompute the first route after adding a far away obstacle, move another obstacle onto
+    //  it, then move the far away obstacle enough times that the log of changes is merged. The
+    //  first route is still repaired.
+    const Vec2f far_away{Config::world_span * 10.0f};
+    const uint64_t far_id = finder.add_obstacle(far_away, 1.0f);
+    finder.compute_paths(routes.data(), 1, nullptr);
+    finder.modify_obstacle(obstacle_ids[1], path[path.size() / 2], 1.0f);
+    for (int i = 0; i < 512; i++) {
+      finder.modify_obstacle(far_id, far_away, 1.0f);
+    }
+    repaired.clear();
+    finder.repair_paths(routes.data(), int(routes.size()), &pool, &repaired);
+    num_mismatch += uint32_t(repaired.empty() || repaired[0] != 0);
+    pool.stop();
+  }
+
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+  return num_mismatch == 0 ? 0 : 1;
+}
@@ -240,25 +240,24 @@ void FogComponent::update(const UpdateInfo& info) {
     }
   } else if (recompute_noise && !fog_image_future) {
     auto noise_p = worley_noise_params;
+    auto octaves = worley_noise_octaves;
     auto num_im_components = num_fog_image_components;
-    worley_noise_future = std::async(std::launch::async, [noise_p, num_im_components]() {
+    auto* task_pool = info.task_pool;
+    auto gen_noise = [noise_p, octaves, num_im_components, task_pool]() {
       int px_dims[3];
       get_image_dims_px(noise_p, px_dims);
       size_t num_image_px = num_im_components * worley::get_image_size_px(px_dims);
       auto image_data = std::make_unique<uint8_t[]>(num_image_px);
 
-      auto num_grid_px = get_sample_grid_size_px(noise_p);
-      auto point_grid = std::make_unique<uint8_t[]>(num_grid_px);
-
       for (int i = 0; i < num_im_components; i++) {
-        worley::generate_sample_grid<uint8_t>(num_grid_px, point_grid.get());
-        worley::generate(
+        worley::generate_octaves<uint8_t>(
           noise_p,
+          octaves,
           px_dims,
-          point_grid.get(),
           image_data.get(),
           num_im_components,
-          i);
+          i,
+          task_pool);
       }
 
       WorleyNoiseFutureData result{};
@@ -268,7 +267,8 @@ void FogComponent::update(const UpdateInfo& info) {
         image::Channels::make_uint8n(num_im_components)
       };
       return result;
-    });
+    };
+    worley_noise_future = std::async(std::launch::async, std::move(gen_noise));
     recompute_noise = false;
     awaiting_noise_result = true;
   }
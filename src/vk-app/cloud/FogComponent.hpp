@@ -40,6 +40,8 @@ public:
     const Camera& camera;
     const Terrain& terrain;
     const SpatiallyVaryingWind& wind;
+    //  Optional. Used by the noise task, so it must outlive this component.
+    TaskPool* task_pool;
   };
 
   struct WorleyNoiseFutureData {
@@ -73,6 +75,7 @@ public:
   float weather_driven_density_scale{1.0f};
   Vec3f fog_color{1.0f};
   worley::Parameters worley_noise_params{};
+  worley::OctaveParameters worley_noise_octaves{3, 0.5f};
   std::future<WorleyNoiseFutureData> worley_noise_future;
 
   Optional<CloudRenderer::VolumeDrawableHandle> debug_fog_drawable;
@@ -0,0 +1,143 @@
+#include "../../worley.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace grove;
+using namespace grove::worley;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_cells = 8;
+  static constexpr int cell_size_px = 16;
+  static constexpr int num_repeats = 2;
+  static constexpr int num_octaves = 3;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < Config::num_repeats; i++) {
+    f();
+  }
+  auto t = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return t / double(Config::num_repeats);
+}
+
+std::mt19937 random_engine;
+
+struct SeededRandom {
+  static float evaluate() {
+    return std::uniform_real_distribution<float>(0.0f, 1.0f)(random_engine);
+  }
+};
+
+template <typename T>
+uint32_t count_mismatches(const std::vector<T>& a, const std::vector<T>& b) {
+  uint32_t result{};
+  for (size_t i = 0; i < a.size(); i++) {
+    result += uint32_t(a[i] != b[i]);
+  }
+  return result;
+}
+
+} //  anon
+
+int main(int, char**) {
+  Parameters params{};
+  for (int i = 0; i < 3; i++) {
+    params.num_cells[i] = Config::num_cells;
+    params.cell_sizes_px[i] = Config::cell_size_px;
+  }
+  params.invert = true;
+
+  int px_dims[3];
+  get_image_dims_px(params, px_dims);
+  const size_t num_px = get_image_size_px(px_dims);
+  const double num_mvox = double(num_px) * 1e-6;
+
+  std::vector<uint8_t> point_grid(get_sample_grid_size_px(params));
+  generate_sample_grid<uint8_t, SeededRandom>(point_grid.size(), point_grid.data());
+
+  std::vector<uint8_t> reference(num_px);
+  const double reference_ms = time_ms([&]() {
+    generate(params, px_dims, point_grid.data(), reference.data(), 1, 0);
+  });
+
+  std::cout << px_dims[0] << "x" << px_dims[1] << "x" << px_dims[2] << " (" << num_mvox
+            << " megavoxels)" << std::endl;
+  std::cout << "reference: " << reference_ms / num_mvox << "ms/megavoxel" << std::endl;
+
+  uint32_t num_mismatch{};
+  std::vector<uint8_t> result(num_px);
+  const double no_pool_ms = time_ms([&]() {
+    generate(params, px_dims, point_grid.data(), result.data(), 1, 0, nullptr);
+  });
+  num_mismatch += count_mismatches(reference, result);
+  std::cout << "vectorized, no pool: " << no_pool_ms / num_mvox << "ms/megavoxel" << std::endl;
+
+  const int max_num_threads = std::max(4, TaskPool::default_num_worker_threads() + 1);
+  for (int num_threads = 1; num_threads <= max_num_threads; num_threads *= 2) {
+    TaskPool pool;
+    pool.start(num_threads - 1);
+    std::fill(result.begin(), result.end(), uint8_t(0));
+    const double ms = time_ms([&]() {
+      generate(params, px_dims, point_grid.data(), result.data(), 1, 0, &pool);
+    });
+    num_mismatch += count_mismatches(reference, result);
+    std::cout << "vectorized, " << num_threads << " thread(s): " << ms / num_mvox
+              << "ms/megavoxel" << std::endl;
+    pool.stop();
+  }
+
+  {
+    //  A single octave of the float sum matches `generate` given the same sample grid.
+    OctaveParameters octaves{1, 0.5f};
+    random_engine.seed(1);
+    std::vector<float> single(num_px);
+    generate_octaves<float, SeededRandom>(params, octaves, px_dims, single.data(), 1, 0, nullptr);
+
+    random_engine.seed(1);
+    std::vector<float> single_grid(get_sample_grid_size_px(params));
+    generate_sample_grid<float, SeededRandom>(single_grid.size(), single_grid.data());
+    std::vector<float> single_reference(num_px);
+    generate(params, px_dims, single_grid.data(), single_reference.data(), 1, 0);
+    num_mismatch += count_mismatches(single_reference, single);
+  }
+
+  {
+    //  Cell sizes not divisible by 2^octave, down to 1px cells, cover the image with every octave.
+    Parameters odd_params = params;
+    odd_params.cell_sizes_px[0] = 12;
+    odd_params.cell_sizes_px[2] = 5;
+    int odd_px_dims[3];
+    get_image_dims_px(odd_params, odd_px_dims);
+    std::vector<float> odd(get_image_size_px(odd_px_dims));
+    OctaveParameters odd_octaves{6, 0.5f};
+    generate_octaves<float>(odd_params, odd_octaves, odd_px_dims, odd.data(), 1, 0, nullptr);
+    for (float v : odd) {
+      num_mismatch += uint32_t(!(v >= 0.0f && v <= 1.0f));
+    }
+  }
+
+  TaskPool pool;
+  pool.start(TaskPool::default_num_worker_threads());
+  OctaveParameters octaves{Config::num_octaves, 0.5f};
+  std::vector<uint8_t> fbm(num_px);
+  const double octaves_ms = time_ms([&]() {
+    generate_octaves<uint8_t>(params, octaves, px_dims, fbm.data(), 1, 0, &pool);
+  });
+  std::cout << Config::num_octaves << " octaves, " << pool.num_workers() + 1 << " thread(s): "
+            << octaves_ms / num_mvox << "ms/megavoxel" << std::endl;
+  pool.stop();
+
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+  return num_mismatch == 0 ? 0 : 1;
+}
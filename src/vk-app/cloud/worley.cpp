@@ -1,9 +1,52 @@
 #include "worley.hpp"
 #include "grove/common/common.hpp"
 #include "grove/math/random.hpp"
+#include "grove/math/simd.hpp"
+#include <algorithm>
 
 GROVE_NAMESPACE_BEGIN
 
+namespace {
+
+using namespace worley;
+
+struct FeaturePoints {
+  float coords[3][27];
+};
+
+//  Feature points, in pixels, of the 27 cells around `cell_ind`, computed as in `min_distance`.
+void gather_feature_points(const Parameters& params, const float* point_grid01,
+                           const int cell_ind[3], FeaturePoints* out) {
+  const int* cell_size = params.cell_sizes_px;
+  const int* num_cells = params.num_cells;
+  int p{};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      for (int k = 0; k < 3; k++) {
+        int offs[3] = {i - 1, j - 1, k - 1};
+        int true_ind[3];
+        int sample_ind[3];
+        for (int h = 0; h < 3; h++) {
+          int adj_ind = offs[h] + cell_ind[h];
+          true_ind[h] = adj_ind;
+          sample_ind[h] = adj_ind < 0 ? num_cells[h] - 1 : adj_ind >= num_cells[h] ? 0 : adj_ind;
+        }
+        const int linear_grid_ind = 3 * to_linear_index(
+          sample_ind[0], sample_ind[1], sample_ind[2], num_cells);
+
+        for (int h = 0; h < 3; h++) {
+          const float samplef = point_grid01[linear_grid_ind + h];
+          out->coords[h][p] =
+            samplef * float(cell_size[h]) + float(cell_size[h]) * float(true_ind[h]);
+        }
+        p++;
+      }
+    }
+  }
+}
+
+} //  anon
+
 float worley::DefaultRandom::evaluate() {
   return urandf();
 }
@@ -37,4 +80,69 @@ float worley::maximum_pixel_distance(const Parameters& params) {
   return std::sqrt(rx * rx + ry * ry + rz * rz);
 }
 
+worley::Parameters worley::get_octave_parameters(const Parameters& params, int octave) {
+  Parameters result = params;
+  for (int i = 0; i < 3; i++) {
+    //  Cells are at least 1px. If the cell size is not divisible by 2^octave, round the number of
+    //  cells up so that the octave still covers the image; it then no longer tiles exactly.
+    const int image_px = params.num_cells[i] * params.cell_sizes_px[i];
+    const int cell_size = std::max(1, params.cell_sizes_px[i] >> std::min(octave, 30));
+    result.cell_sizes_px[i] = cell_size;
+    result.num_cells[i] = std::max(1, (image_px + cell_size - 1) / cell_size);
+  }
+  return result;
+}
+
+void worley::impl::min_distance_row(const Parameters& params, const float* point_grid01,
+                                    int i, int k, int num_j, float* out) {
+  using namespace simd;
+
+  //  The minimum distance is taken over squared distances, with a single square root at the end;
+  //  the square root is monotonic and correctly rounded, so this matches `min_distance`.
+  const float max_dist = maximum_pixel_distance(params);
+  const F4 max_dist4 = set1(max_dist);
+  const F4 one = set1(1.0f);
+  const F4 pi = set1(float(i));
+  const F4 pk = set1(float(k));
+
+  const int cell_size_j = params.cell_sizes_px[1];
+  for (int j0 = 0; j0 < num_j;) {
+    const int cell_ind[3]{
+      i / params.cell_sizes_px[0], j0 / cell_size_j, k / params.cell_sizes_px[2]
+    };
+    const int j_end = std::min(num_j, (cell_ind[1] + 1) * cell_size_j);
+
+    FeaturePoints points;
+    gather_feature_points(params, point_grid01, cell_ind, &points);
+
+    for (int j = j0; j < j_end; j += 4) {
+      const auto jf = float(j);
+      const F4 pj = set(jf, jf + 1.0f, jf + 2.0f, jf + 3.0f);
+      F4 min_len_sq = set1(infinityf());
+      for (int p = 0; p < 27; p++) {
+        const F4 c0 = set1(points.coords[0][p]) - pi;
+        const F4 c1 = set1(points.coords[1][p]) - pj;
+        const F4 c2 = set1(points.coords[2][p]) - pk;
+        min_len_sq = min(min_len_sq, c0 * c0 + c1 * c1 + c2 * c2);
+      }
+
+      F4 normed = min(sqrt(min_len_sq), max_dist4) / max_dist4;
+      if (params.invert) {
+        normed = one - normed;
+      }
+
+      const int num_valid = j_end - j;
+      if (num_valid >= 4) {
+        store(out + j, normed);
+      } else {
+        float tmp[4];
+        store(tmp, normed);
+        std::copy(tmp, tmp + num_valid, out + j);
+      }
+    }
+
+    j0 = j_end;
+  }
+}
+
 GROVE_NAMESPACE_END
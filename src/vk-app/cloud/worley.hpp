@@ -1,8 +1,11 @@
 #pragma once
 
 #include "grove/math/constants.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/common/Temporary.hpp"
 #include <cstdint>
 #include <cmath>
+#include <vector>
 
 namespace grove::worley {
 
@@ -12,6 +15,11 @@ struct Parameters {
   bool invert;
 };
 
+struct OctaveParameters {
+  int num_octaves;
+  float persistence;
+};
+
 struct DefaultRandom {
   static float evaluate();
 };
@@ -21,6 +29,10 @@ size_t get_sample_grid_size_px(const Parameters& params);
 size_t get_image_size_px(const int px_dims[3]);
 void get_image_dims_px(const Parameters& params, int out[3]);
 float maximum_pixel_distance(const Parameters& params);
+//  Parameters of octave `octave` of `params`: twice as many cells per octave, each half as large,
+//  so that every octave spans (and tiles over) the same image. Cells are at least 1px; octaves
+//  whose cell sizes are not divisible by 2^octave cover the image but do not tile exactly.
+Parameters get_octave_parameters(const Parameters& params, int octave);
 
 inline int to_linear_index(int i, int j, int k, const int dims[3]) {
   int slab = k * dims[0] * dims[1];
@@ -113,6 +125,47 @@ Element min_distance(const Element* point_grid,
   return impl::FloatConversion<Element>::from_float01(normed);
 }
 
+//  Normalized distances (as computed by `min_distance`, before conversion to `Element`) of the
+//  pixels (i, [0, num_j), k), 4 pixels at a time. `point_grid01` holds the sample grid as floats in
+//  [0, 1].
+void min_distance_row(const Parameters& params, const float* point_grid01, int i, int k,
+                      int num_j, float* out);
+
+template <typename Element>
+std::vector<float> to_float01(const Element* point_grid, size_t num_px) {
+  std::vector<float> result(num_px);
+  for (size_t i = 0; i < num_px; i++) {
+    result[i] = FloatConversion<Element>::to_float01(point_grid[i]);
+  }
+  return result;
+}
+
+//  Invokes `f(i, k, row)` for each row of `px_dims[1]` pixels, across the threads of `task_pool`
+//  if it is non-null. `row` is scratch space for `px_dims[1]` floats.
+template <typename F>
+void for_each_row(const int px_dims[3], TaskPool* task_pool, F&& f) {
+  constexpr int rows_per_task = 16;
+  const int num_rows = px_dims[0] * px_dims[2];
+  const int num_tasks = (num_rows + rows_per_task - 1) / rows_per_task;
+
+  auto run = [&](int task, int) {
+    Temporary<float, 512> store_row;
+    float* row = store_row.require(px_dims[1]);
+    const int end = std::min(num_rows, (task + 1) * rows_per_task);
+    for (int r = task * rows_per_task; r < end; r++) {
+      f(r % px_dims[0], r / px_dims[0], row);
+    }
+  };
+
+  if (task_pool) {
+    task_pool->parallel_for(num_tasks, run);
+  } else {
+    for (int i = 0; i < num_tasks; i++) {
+      run(i, 0);
+    }
+  }
+}
+
 } //  impl
 
 template <typename Element, typename Random = DefaultRandom>
@@ -149,4 +202,64 @@ void generate(const Parameters& params,
   }
 }
 
+//  As `generate`, but with rows of pixels evaluated 4 at a time, in parallel across the threads of
+//  `task_pool` if it is non-null. The result is identical.
+template <typename Element>
+void generate(const Parameters& params,
+              const int px_dims[3],
+              const Element* point_grid,
+              Element* dst,
+              size_t dst_stride,
+              size_t dst_offset,
+              TaskPool* task_pool) {
+  const auto point_grid01 = impl::to_float01(point_grid, get_sample_grid_size_px(params));
+  impl::for_each_row(px_dims, task_pool, [&](int i, int k, float* row) {
+    impl::min_distance_row(params, point_grid01.data(), i, k, px_dims[1], row);
+    const size_t dst_ind = (size_t(k) * px_dims[0] + i) * px_dims[1];
+    for (int j = 0; j < px_dims[1]; j++) {
+      const Element v = impl::FloatConversion<Element>::from_float01(row[j]);
+      dst[(dst_ind + j) * dst_stride + dst_offset] = v;
+    }
+  });
+}
+
+//  Sum of `octaves.num_octaves` octaves of noise (see `get_octave_parameters`), with the weight of
+//  each octave `octaves.persistence` times that of the previous one, normalized to [0, 1]. Each
+//  octave tiles, so the sum does too.
+template <typename Element, typename Random = DefaultRandom>
+void generate_octaves(const Parameters& params,
+                      const OctaveParameters& octaves,
+                      const int px_dims[3],
+                      Element* dst,
+                      size_t dst_stride,
+                      size_t dst_offset,
+                      TaskPool* task_pool) {
+  std::vector<float> sum(get_image_size_px(px_dims));
+  std::vector<float> point_grid01;
+
+  float weight{1.0f};
+  float total_weight{};
+  for (int o = 0; o < octaves.num_octaves; o++) {
+    const auto octave_params = get_octave_parameters(params, o);
+    point_grid01.resize(get_sample_grid_size_px(octave_params));
+    generate_sample_grid<float, Random>(point_grid01.size(), point_grid01.data());
+
+    impl::for_each_row(px_dims, task_pool, [&](int i, int k, float* row) {
+      impl::min_distance_row(octave_params, point_grid01.data(), i, k, px_dims[1], row);
+      float* dst_row = sum.data() + (size_t(k) * px_dims[0] + i) * px_dims[1];
+      for (int j = 0; j < px_dims[1]; j++) {
+        dst_row[j] += row[j] * weight;
+      }
+    });
+
+    total_weight += weight;
+    weight *= octaves.persistence;
+  }
+
+  const float norm = total_weight > 0.0f ? 1.0f / total_weight : 0.0f;
+  for (size_t i = 0; i < sum.size(); i++) {
+    dst[i * dst_stride + dst_offset] = impl::FloatConversion<Element>::from_float01(sum[i] * norm);
+  }
+}
+
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include "grove/common/profile.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/util.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/math/simd.hpp"
+#include <cassert>
 
 #ifdef GROVE_MACOS
 #define GROVE_USE_PAR_EXEC (0)
@@ -25,10 +28,12 @@ namespace {
 using namespace gen;
 using Config = SlimeMoldConfig;
 
+constexpr int data_texture_size(int tex_dim) {
+  return tex_dim * tex_dim * Config::num_texture_channels;
+}
+
 constexpr int data_texture_size() {
-  constexpr int tex_dim = Config::texture_dim;
-  constexpr int num_channels = Config::num_texture_channels;
-  return tex_dim * tex_dim * num_channels;
+  return data_texture_size(Config::texture_dim);
 }
 
 Vec3f channel_weights(float center_scale, float rand_scale, float gain) {
@@ -67,8 +72,8 @@ SlimeParticle make_particle(const Config& config, const Vec2f& pos, float headin
   return result;
 }
 
-std::unique_ptr<float[]> make_texture_data() {
-  return std::make_unique<float[]>(data_texture_size());
+std::unique_ptr<float[]> make_texture_data(int tex_dim = Config::texture_dim) {
+  return std::make_unique<float[]>(data_texture_size(tex_dim));
 }
 
 void set_random_data(float* out, int r, int c, int nc) {
@@ -302,24 +307,23 @@ void diffuse(float* a, float* b, float* tmp, float decay, float diff_speed, int
   im_decay(a, a, decay);
 }
 
-void set_perturb_data(const Config& config, const float* im, float* out) {
-  constexpr auto dim = Config::texture_dim;
+void set_perturb_data(const Config& config, int dim, const float* im, float* out) {
   constexpr auto nc = Config::num_texture_channels;
   static_assert(nc == 3);
 
   if (config.perturb_event_type == 1) {
     set_random_data(out, dim, dim, nc);
 
-    auto tmp0 = make_texture_data();
-    auto tmp1 = make_texture_data();
+    auto tmp0 = make_texture_data(dim);
+    auto tmp1 = make_texture_data(dim);
     box_filter<nc>(out, tmp0.get(), tmp1.get(), dim, dim, 5);
-    std::copy(tmp0.get(), tmp0.get() + data_texture_size(), out);
+    std::copy(tmp0.get(), tmp0.get() + data_texture_size(dim), out);
 
     component_wise([out, im](int off) {
       out[off] = (1.0f - im[off]) * std::min(1.0f, std::pow(out[off], 8.0f) * 2.0f);
-    });
+    }, dim, dim, nc);
   } else {
-    std::fill(out, out + data_texture_size(), 0.0f);
+    std::fill(out, out + data_texture_size(dim), 0.0f);
     for (int i = 0; i < config.num_perturb_circles; i++) {
       Vec2f center{urandf(), urandf()};
       const auto r = 0.1f;
@@ -380,6 +384,287 @@ void set_right_only(SlimeParticle* parts, int num_parts, bool v) {
   }
 }
 
+
+/*
+ * SlimeMoldSimulation
+ */
+
+constexpr int particles_per_task = 1024;
+constexpr int rows_per_task = 16;
+
+//  Calls `f(i0, i1, worker_index)` for blocks of `block_size` indices in [0, n).
+template <typename F>
+void for_each_block(TaskPool* task_pool, int n, int block_size, F&& f) {
+  const int num_tasks = (n + block_size - 1) / block_size;
+  auto run = [&](int task, int worker) {
+    const int i0 = task * block_size;
+    f(i0, std::min(n, i0 + block_size), worker);
+  };
+  if (task_pool) {
+    task_pool->parallel_for(num_tasks, run);
+  } else {
+    for (int i = 0; i < num_tasks; i++) {
+      run(i, 0);
+    }
+  }
+}
+
+void set_particle(SlimeParticles& dst, int i, const SlimeParticle& part) {
+  using P = SlimeParticles;
+  const auto head = to_vec(part.heading);
+  const auto left = to_vec(part.left_sensor);
+  const auto right = to_vec(part.right_sensor);
+  const float values[P::num_attributes]{
+    part.position.x, part.position.y,
+    head.x, head.y,
+    left.x, left.y,
+    right.x, right.y,
+    part.sensor_step_size,
+    part.sensor_size,
+    part.speed,
+    part.deposit,
+    part.channel_weights.x, part.channel_weights.y, part.channel_weights.z,
+    part.sensor_speed_sensitivity,
+    part.sensor_speed_sensitivity_scale,
+    part.turn_speed,
+    part.right_only ? 0.0f : 1.0f,
+    1.0f, 0.0f
+  };
+  for (int a = 0; a < P::num_attributes; a++) {
+    dst.attributes[a][i] = values[a];
+  }
+}
+
+void scale_attribute(SlimeParticles& parts, SlimeParticles::Attribute attr, float scale) {
+  auto* data = parts.data(attr);
+  for (int i = 0; i < parts.num_padded; i++) {
+    data[i] *= scale;
+  }
+}
+
+int row_prefix_sums_size(int tex_dim) {
+  return tex_dim * (tex_dim + 1) * Config::num_texture_channels;
+}
+
+//  Row `j` of `out` holds, for each i in [0, tex_dim], the sum of texels [0, i) of row `j` of `im`.
+void compute_row_prefix_sums(const float* im, float* out, int r0, int r1, int tex_dim) {
+  constexpr int nc = Config::num_texture_channels;
+  for (int j = r0; j < r1; j++) {
+    const float* src = im + data_offset(0, j, tex_dim, nc);
+    float* dst = out + j * (tex_dim + 1) * nc;
+    float acc[nc]{};
+    for (int i = 0; i < tex_dim; i++) {
+      for (int k = 0; k < nc; k++) {
+        dst[i * nc + k] = acc[k];
+        acc[k] += src[i * nc + k];
+      }
+    }
+    for (int k = 0; k < nc; k++) {
+      dst[tex_dim * nc + k] = acc[k];
+    }
+  }
+}
+
+//  Sum of the texels in the window, as `sense`, from the row prefix sums of the texture.
+Vec3f sense_window(const float* row_sums, int tex_dim, const Vec2f& p, float win_size) {
+  constexpr int nc = Config::num_texture_channels;
+  auto [i0, j0] = to_ij(p - win_size * 0.5f, tex_dim, tex_dim);
+  auto [i1, j1] = to_ij(p + win_size * 0.5f, tex_dim, tex_dim);
+  i0 = std::max(0, i0);
+  j0 = std::max(0, j0);
+  i1 = std::min(tex_dim - 1, i1);
+  j1 = std::min(tex_dim - 1, j1);
+
+  Vec3f result{};
+  if (i0 > i1) {
+    return result;
+  }
+  for (int j = j0; j <= j1; j++) {
+    const float* row = row_sums + j * (tex_dim + 1) * nc;
+    for (int k = 0; k < nc; k++) {
+      result[k] += row[(i1 + 1) * nc + k] - row[i0 * nc + k];
+    }
+  }
+  return result;
+}
+
+//  Strength of the texture sensed by particle `i` through the sensor with direction (`dx`, `dy`),
+//  as in `update_particle`.
+float sense_particle(const SlimeParticles& parts, int i, const float* row_sums, int tex_dim,
+                     SlimeParticles::Attribute dx, SlimeParticles::Attribute dy) {
+  using P = SlimeParticles;
+  const Vec2f pos{parts.data(P::PositionX)[i], parts.data(P::PositionY)[i]};
+  const Vec2f dir{parts.data(dx)[i], parts.data(dy)[i]};
+  const Vec3f weights{
+    parts.data(P::ChannelWeight0)[i],
+    parts.data(P::ChannelWeight1)[i],
+    parts.data(P::ChannelWeight2)[i]
+  };
+  auto v = sense_window(row_sums, tex_dim, pos + dir * parts.data(P::SensorStepSize)[i],
+                        parts.data(P::SensorSize)[i]);
+  v *= weights;
+  return v.length();
+}
+
+//  Senses, turns and moves particles [b, b + 4).
+void update_particle_group(const Config& config, SlimeParticles& parts, int b,
+                           const float* row_sums, int tex_dim) {
+  using namespace simd;
+  using P = SlimeParticles;
+  auto at = [&parts, b](P::Attribute attr) {
+    return parts.data(attr) + b;
+  };
+
+  float turn_sign[4];
+  float speed_sens[4];
+  for (int l = 0; l < 4; l++) {
+    const int i = b + l;
+    const float vs[3]{
+      sense_particle(parts, i, row_sums, tex_dim, P::HeadingX, P::HeadingY),
+      sense_particle(parts, i, row_sums, tex_dim, P::LeftSensorX, P::LeftSensorY),
+      sense_particle(parts, i, row_sums, tex_dim, P::RightSensorX, P::RightSensorY)
+    };
+    const auto max_i = int(std::max_element(vs, vs + 3) - vs);
+    turn_sign[l] = max_i == 0 ? 0.0f : max_i == 1 ? parts.data(P::LeftTurnSign)[i] : -1.0f;
+    speed_sens[l] = 1.0f - std::exp(-vs[max_i] * parts.data(P::SensorSpeedSensitivity)[i]);
+  }
+
+  //  Rotate by +/- the turn angle, or not at all if the sign is 0.
+  const F4 one = set1(1.0f);
+  const F4 sgn = load(turn_sign);
+  const F4 sgn_abs = abs(sgn);
+  const F4 ca = load(at(P::TurnCos)) * sgn_abs + (one - sgn_abs);
+  const F4 sa = load(at(P::TurnSin)) * sgn;
+  const F4 hx0 = load(at(P::HeadingX));
+  const F4 hy0 = load(at(P::HeadingY));
+  F4 hx = hx0 * ca - hy0 * sa;
+  F4 hy = hx0 * sa + hy0 * ca;
+  const F4 inv_len = one / sqrt(hx * hx + hy * hy);
+  hx = hx * inv_len;
+  hy = hy * inv_len;
+
+  const F4 speed = load(at(P::Speed)) + load(at(P::SensorSpeedSensitivityScale)) * load(speed_sens);
+  const F4 step = speed * set1(config.dt());
+  F4 px = load(at(P::PositionX)) + hx * step;
+  F4 py = load(at(P::PositionY)) + hy * step;
+
+  if (config.circular_world) {
+    const F4 zero4 = zero();
+    px = px + select(lt(px, zero4), one, zero4);
+    py = py + select(lt(py, zero4), one, zero4);
+    px = px - select(lt(px, one), zero4, one);
+    py = py - select(lt(py, one), zero4, one);
+  }
+
+  store(at(P::PositionX), px);
+  store(at(P::PositionY), py);
+  store(at(P::HeadingX), hx);
+  store(at(P::HeadingY), hy);
+
+  for (int l = 0; l < 4; l++) {
+    float& x = at(P::PositionX)[l];
+    float& y = at(P::PositionY)[l];
+    if (config.circular_world) {
+      //  Only reached for steps longer than the world.
+      x = wrap01(x);
+      y = wrap01(y);
+    } else if (x < 0.0f || y < 0.0f || x >= 1.0f || y >= 1.0f) {
+      const float eps = 0.001f;
+      x = clamp(x, eps, 1.0f - eps);
+      y = clamp(y, eps, 1.0f - eps);
+      const auto head = to_vec(urandf() * 2.0f * pif());
+      at(P::HeadingX)[l] = head.x;
+      at(P::HeadingY)[l] = head.y;
+    }
+  }
+}
+
+void deposit_particle(const SlimeParticles& parts, int i, int tex_dim,
+                      float* buffer, uint8_t* buffer_rows) {
+  using P = SlimeParticles;
+  constexpr auto nc = Config::num_texture_channels;
+  const Vec2f pos{parts.data(P::PositionX)[i], parts.data(P::PositionY)[i]};
+  const auto [ti, tj] = to_ij(pos, tex_dim, tex_dim);
+  auto* out = buffer + data_offset(ti, tj, tex_dim, nc);
+  const float amount = parts.data(P::Deposit)[i];
+  out[0] += amount * parts.data(P::ChannelWeight0)[i];
+  out[1] += amount * parts.data(P::ChannelWeight1)[i];
+  out[2] += amount * parts.data(P::ChannelWeight2)[i];
+  buffer_rows[tj] = 1;
+}
+
+//  Horizontal pass of `image::simple_box_filter` for rows [r0, r1) of `a`, into `tmp`.
+void box_filter_rows(const float* a, float* tmp, int r0, int r1, int dim, int k_size) {
+  using namespace simd;
+  constexpr int nc = Config::num_texture_channels;
+  const int row_size = dim * nc;
+  const float v = 1.0f / float(k_size);
+  const int k2 = k_size / 2;
+  //  Columns [j0, j1) have all `k_size` neighbors in range.
+  const int j0 = std::min(dim, k2);
+  const int j1 = std::max(j0, dim - (k_size - 1 - k2));
+  const F4 v4 = set1(v);
+
+  auto filter_scalar = [&](const float* src, float* dst, int f) {
+    const int j = f / nc;
+    float acc{};
+    for (int k = 0; k < k_size; k++) {
+      const int col = k - k2 + j;
+      if (col >= 0 && col < dim) {
+        acc += src[f + (k - k2) * nc] * v;
+      }
+    }
+    dst[f] = acc;
+  };
+
+  for (int r = r0; r < r1; r++) {
+    const float* src = a + r * row_size;
+    float* dst = tmp + r * row_size;
+    int f = 0;
+    for (; f < j0 * nc; f++) {
+      filter_scalar(src, dst, f);
+    }
+    for (; f + 4 <= j1 * nc; f += 4) {
+      F4 acc = zero();
+      for (int k = 0; k < k_size; k++) {
+        acc = acc + load(src + f + (k - k2) * nc) * v4;
+      }
+      store(dst + f, acc);
+    }
+    for (; f < row_size; f++) {
+      filter_scalar(src, dst, f);
+    }
+  }
+}
+
+//  Vertical pass of `image::simple_box_filter` for rows [r0, r1) of `tmp`, followed by `im_lerp`
+//  and `im_decay` into `a`.
+void box_filter_columns_lerp_decay(const float* tmp, float* a, int r0, int r1, int dim,
+                                   int k_size, float diff_speed, float decay) {
+  using namespace simd;
+  constexpr int nc = Config::num_texture_channels;
+  const int row_size = dim * nc;
+  const F4 v4 = set1(1.0f / float(k_size));
+  const int k2 = k_size / 2;
+  const F4 t = set1(diff_speed);
+  const F4 one_minus_t = set1(1.0f - diff_speed);
+  const F4 decay4 = set1(decay);
+
+  for (int r = r0; r < r1; r++) {
+    const int k0 = std::max(0, k2 - r);
+    const int k1 = std::min(k_size, dim + k2 - r);
+    float* dst = a + r * row_size;
+    for (int f = 0; f < row_size; f += 4) {
+      F4 acc = zero();
+      for (int k = k0; k < k1; k++) {
+        acc = acc + load(tmp + (r + k - k2) * row_size + f) * v4;
+      }
+      const F4 lerped = one_minus_t * load(dst + f) + t * acc;
+      store(dst + f, max(zero(), lerped - decay4));
+    }
+  }
+}
+
 } //  anon
 
 std::unique_ptr<float[]> gen::make_slime_mold_texture_data() {
@@ -433,13 +718,13 @@ void gen::update_slime_mold_particles(SlimeParticle* particles,
   }
 
   if (!context->set_perturb_data) {
-    set_perturb_data(config, data0, context->perturb_data);
+    set_perturb_data(config, Config::texture_dim, data0, context->perturb_data);
     context->set_perturb_data = true;
   }
 
   context->tot_iter++;
   if (config.allow_perturb_event && (context->tot_iter % config.perturb_interval == 0)) {
-    set_perturb_data(config, data0, context->perturb_data);
+    set_perturb_data(config, Config::texture_dim, data0, context->perturb_data);
     context->perturb_state = 1;
   }
 
@@ -508,4 +793,183 @@ void gen::add_value(float* data,
   clamped_add(data, tex_dim, tex_dim, tex_components, p01, radius01, v);
 }
 
+void gen::SlimeMoldSimulation::initialize(const SlimeMoldConfig& config,
+                                          int texture_dim, int num_particles) {
+  assert(texture_dim > 0 && texture_dim % 4 == 0);
+  tex_dim = texture_dim;
+  texture = make_texture_data(tex_dim);
+  diffuse_tmp = make_texture_data(tex_dim);
+  row_sums = std::make_unique<float[]>(row_prefix_sums_size(tex_dim));
+  perturb_data = make_texture_data(tex_dim);
+  deposit_buffers.clear();
+  deposit_rows.clear();
+  initialized_perturb_data = false;
+  perturb_state = 0;
+  perturb_iters = 0;
+  tot_iter = 0;
+
+  particles.num_particles = num_particles;
+  particles.num_padded = (num_particles + 3) & ~3;
+  particles.turn_dt = -1.0f;
+  for (auto& attr : particles.attributes) {
+    attr.resize(particles.num_padded);
+  }
+  for (int i = 0; i < num_particles; i++) {
+    auto pos = Vec2f{urand_11f(), urand_11f()} * Config::starting_offset_span + 0.5f;
+    auto head = urandf() * 2.0f * pif();
+    set_particle(particles, i, make_particle(config, pos, head));
+  }
+  //  Padding particles are moved, but do not deposit.
+  for (int i = num_particles; i < particles.num_padded; i++) {
+    for (auto& attr : particles.attributes) {
+      attr[i] = attr[0];
+    }
+  }
+}
+
+void gen::SlimeMoldSimulation::update_particles(const SlimeMoldConfig& config,
+                                                TaskPool* task_pool) {
+  using P = SlimeParticles;
+  const float dt = config.dt();
+  if (particles.turn_dt != dt) {
+    const auto* turn_speed = particles.data(P::TurnSpeed);
+    auto* turn_cos = particles.data(P::TurnCos);
+    auto* turn_sin = particles.data(P::TurnSin);
+    for (int i = 0; i < particles.num_padded; i++) {
+      turn_cos[i] = std::cos(turn_speed[i] * dt);
+      turn_sin[i] = std::sin(turn_speed[i] * dt);
+    }
+    particles.turn_dt = dt;
+  }
+
+  const int num_buffers = task_pool ? task_pool->num_workers() + 1 : 1;
+  while (int(deposit_buffers.size()) < num_buffers) {
+    deposit_buffers.push_back(make_texture_data(tex_dim));
+    deposit_rows.push_back(std::make_unique<uint8_t[]>(tex_dim));
+  }
+
+  const float* im = texture.get();
+  float* sums = row_sums.get();
+  for_each_block(task_pool, tex_dim, rows_per_task, [&](int r0, int r1, int) {
+    compute_row_prefix_sums(im, sums, r0, r1, tex_dim);
+  });
+
+  for_each_block(task_pool, particles.num_padded, particles_per_task,
+                 [&](int i0, int i1, int worker) {
+    for (int b = i0; b < i1; b += 4) {
+      update_particle_group(config, particles, b, sums, tex_dim);
+    }
+    float* buffer = deposit_buffers[worker].get();
+    uint8_t* buffer_rows = deposit_rows[worker].get();
+    for (int i = i0; i < std::min(i1, particles.num_particles); i++) {
+      deposit_particle(particles, i, tex_dim, buffer, buffer_rows);
+    }
+  });
+}
+
+void gen::SlimeMoldSimulation::merge_deposits(TaskPool* task_pool) {
+  using namespace simd;
+  const int row_size = tex_dim * Config::num_texture_channels;
+  for_each_block(task_pool, tex_dim, rows_per_task, [&](int r0, int r1, int) {
+    const F4 one = set1(1.0f);
+    for (int r = r0; r < r1; r++) {
+      float* dst = texture.get() + r * row_size;
+      for (size_t b = 0; b < deposit_buffers.size(); b++) {
+        if (!deposit_rows[b][r]) {
+          continue;
+        }
+        float* src = deposit_buffers[b].get() + r * row_size;
+        for (int f = 0; f < row_size; f += 4) {
+          store(dst + f, min(one, load(dst + f) + load(src + f)));
+          store(src + f, zero());
+        }
+        deposit_rows[b][r] = 0;
+      }
+    }
+  });
+}
+
+void gen::SlimeMoldSimulation::diffuse(const SlimeMoldConfig& config, TaskPool* task_pool) {
+  float* a = texture.get();
+  float* tmp = diffuse_tmp.get();
+  const int k_size = config.filter_size;
+  for_each_block(task_pool, tex_dim, rows_per_task, [&](int r0, int r1, int) {
+    box_filter_rows(a, tmp, r0, r1, tex_dim, k_size);
+  });
+  for_each_block(task_pool, tex_dim, rows_per_task, [&](int r0, int r1, int) {
+    box_filter_columns_lerp_decay(
+      tmp, a, r0, r1, tex_dim, k_size, config.diffuse_speed, config.decay);
+  });
+}
+
+void gen::SlimeMoldSimulation::update(const SlimeMoldConfig& config,
+                                      const SlimeMoldParams& params, TaskPool* task_pool) {
+  constexpr auto nc = Config::num_texture_channels;
+  update_particles(config, task_pool);
+  merge_deposits(task_pool);
+
+  if (config.diffuse_enabled) {
+    diffuse(config, task_pool);
+  }
+
+  float* data0 = texture.get();
+  if (!initialized_perturb_data) {
+    set_perturb_data(config, tex_dim, data0, perturb_data.get());
+    initialized_perturb_data = true;
+  }
+
+  tot_iter++;
+  if (config.allow_perturb_event && (tot_iter % config.perturb_interval == 0)) {
+    set_perturb_data(config, tex_dim, data0, perturb_data.get());
+    perturb_state = 1;
+  }
+
+  if (config.allow_signal_influence) {
+    //  Equivalent to `set_signal_data` followed by `apply_signal`, touching only the circle.
+    const auto add = params.channel_mask * params.signal_value;
+    const float add_array[3] = {add.x, add.y, add.z};
+    apply_in_circle(data0, tex_dim, tex_dim, nc, params.signal_position,
+                    params.signal_radius, add_array, [](float a, float b) {
+      return std::max(clamp(b, 0.0f, 1.0f), a);
+    });
+  }
+
+  if (perturb_state == 1) {
+    const int row_size = tex_dim * nc;
+    const float* perturb = perturb_data.get();
+    for_each_block(task_pool, tex_dim, rows_per_task, [&](int r0, int r1, int) {
+      for (int off = r0 * row_size; off < r1 * row_size; off++) {
+        data0[off] = std::min(1.0f, data0[off] + perturb[off]);
+      }
+    });
+    if (perturb_iters++ >= config.num_perturb_iters) {
+      perturb_iters = 0;
+      perturb_state = 0;
+    }
+  }
+}
+
+void gen::SlimeMoldSimulation::set_particle_turn_speed_power(SlimeMoldConfig& config,
+                                                             int new_power) {
+  float scale = power_to_scale(config.turn_speed_power, new_power);
+  if (scale != 1.0f) {
+    scale_attribute(particles, SlimeParticles::TurnSpeed, scale);
+    particles.turn_dt = -1.0f;
+    config.turn_speed_power = new_power;
+  }
+}
+
+void gen::SlimeMoldSimulation::set_particle_speed_power(SlimeMoldConfig& config, int new_power) {
+  float scale = power_to_scale(config.scale_speed_power, new_power);
+  if (scale != 1.0f) {
+    scale_attribute(particles, SlimeParticles::Speed, scale);
+    config.scale_speed_power = new_power;
+  }
+}
+
+void gen::SlimeMoldSimulation::set_particle_right_only(SlimeMoldConfig&, bool value) {
+  std::fill(particles.attributes[SlimeParticles::LeftTurnSign].begin(),
+            particles.attributes[SlimeParticles::LeftTurnSign].end(), value ? 0.0f : 1.0f);
+}
+
 GROVE_NAMESPACE_END
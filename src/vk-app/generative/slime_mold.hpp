@@ -2,6 +2,11 @@
 
 #include "grove/math/vector.hpp"
 #include <memory>
+#include <vector>
+
+namespace grove {
+class TaskPool;
+}
 
 namespace grove::gen {
 
@@ -39,6 +44,10 @@ struct SlimeMoldConfig {
   int scale_speed_power{0};
   int turn_speed_power{0};
   bool only_right_turns{true};
+
+  //  Used by `SlimeMoldSimulation`.
+  int num_steps_per_update{1};
+  bool update_off_main_thread{false};
 };
 
 struct SlimeMoldParams {
@@ -107,4 +116,107 @@ void update_slime_mold_particles(SlimeParticle* particles,
                                  const SlimeMoldConfig& config,
                                  SlimeMoldSimulationContext* context);
 
+/*
+ * SlimeParticles
+ *
+ * `SlimeParticle`s stored as one array per attribute, padded to a multiple of 4 particles. Headings
+ * and sensor angles are stored as unit vectors, so that turning is a rotation rather than a
+ * trigonometric function evaluation.
+ */
+struct SlimeParticles {
+  static constexpr int num_attributes = 21;
+
+  enum Attribute {
+    PositionX = 0,
+    PositionY,
+    HeadingX,
+    HeadingY,
+    LeftSensorX,
+    LeftSensorY,
+    RightSensorX,
+    RightSensorY,
+    SensorStepSize,
+    SensorSize,
+    Speed,
+    Deposit,
+    ChannelWeight0,
+    ChannelWeight1,
+    ChannelWeight2,
+    SensorSpeedSensitivity,
+    SensorSpeedSensitivityScale,
+    TurnSpeed,
+    LeftTurnSign,  //  0 if the particle only turns right, else 1.
+    TurnCos,       //  cos(TurnSpeed * dt) for the dt of the last update.
+    TurnSin,
+  };
+
+  float* data(Attribute attr) {
+    return attributes[attr].data();
+  }
+  const float* data(Attribute attr) const {
+    return attributes[attr].data();
+  }
+
+  int num_particles{};
+  int num_padded{};
+  float turn_dt{-1.0f};  //  dt for which TurnCos and TurnSin were computed, or -1.
+  std::vector<float> attributes[num_attributes];
+};
+
+/*
+ * SlimeMoldSimulation
+ *
+ * Data-parallel counterpart to `update_slime_mold_particles`, for larger textures and particle
+ * counts. Particles are sensed, turned and moved 4 at a time, across the threads of a `TaskPool`;
+ * sensing sums each window from per-row prefix sums of the texture, so its cost grows with the
+ * window's height rather than its area. Each thread deposits into its own accumulation buffer,
+ * and the buffers are merged by row.
+ * Diffusion is a separable box filter over blocks of rows, with the same arithmetic as
+ * `update_slime_mold_particles`.
+ */
+class SlimeMoldSimulation {
+public:
+  void initialize(const SlimeMoldConfig& config, int texture_dim, int num_particles);
+  void update(const SlimeMoldConfig& config, const SlimeMoldParams& params, TaskPool* task_pool);
+
+  int texture_dim() const {
+    return tex_dim;
+  }
+  float* texture_data() {
+    return texture.get();
+  }
+  const float* texture_data() const {
+    return texture.get();
+  }
+  const SlimeParticles& read_particles() const {
+    return particles;
+  }
+
+  void set_particle_turn_speed_power(SlimeMoldConfig& config, int new_power);
+  void set_particle_speed_power(SlimeMoldConfig& config, int new_power);
+  void set_particle_right_only(SlimeMoldConfig& config, bool value);
+
+private:
+  void update_particles(const SlimeMoldConfig& config, TaskPool* task_pool);
+  void merge_deposits(TaskPool* task_pool);
+  void diffuse(const SlimeMoldConfig& config, TaskPool* task_pool);
+
+private:
+  int tex_dim{};
+  SlimeParticles particles;
+  std::unique_ptr<float[]> texture;
+  std::unique_ptr<float[]> diffuse_tmp;
+  std::unique_ptr<float[]> row_sums;
+  std::unique_ptr<float[]> perturb_data;
+
+  //  One deposit buffer per thread, and a flag per buffer row that is set if the row has deposits.
+  std::vector<std::unique_ptr<float[]>> deposit_buffers;
+  std::vector<std::unique_ptr<uint8_t[]>> deposit_rows;
+
+  bool initialized_perturb_data{};
+  int perturb_state{};
+  int perturb_iters{};
+  uint64_t tot_iter{};
+};
+
 }
\ No newline at end of file
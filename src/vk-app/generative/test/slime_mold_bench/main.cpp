@@ -0,0 +1,161 @@
+#include "vk-app/generative/slime_mold.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_particles = 20000;
+  static constexpr int num_large_particles = 100000;
+  static constexpr int large_texture_dim = 1024;
+  static constexpr int num_steps = 20;
+  static constexpr int num_diffuse_steps = 8;
+};
+
+template <typename F>
+double ms_per_step(F&& f, int num_steps = Config::num_steps) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_steps; i++) {
+    f();
+  }
+  auto t = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return t / double(num_steps);
+}
+
+void set_random_texture(float* data, int size, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+  for (int i = 0; i < size; i++) {
+    data[i] = dis(gen);
+  }
+}
+
+int texture_size(int dim) {
+  return dim * dim * gen::SlimeMoldConfig::num_texture_channels;
+}
+
+//  Number of texels outside [0, 1] and particles outside [0, 1).
+uint32_t count_out_of_range(const gen::SlimeMoldSimulation& sim) {
+  uint32_t result{};
+  const float* data = sim.texture_data();
+  for (int i = 0; i < texture_size(sim.texture_dim()); i++) {
+    result += uint32_t(!(data[i] >= 0.0f && data[i] <= 1.0f));
+  }
+  using P = gen::SlimeParticles;
+  auto& parts = sim.read_particles();
+  for (auto attr : {P::PositionX, P::PositionY}) {
+    for (int i = 0; i < parts.num_particles; i++) {
+      const float v = parts.data(attr)[i];
+      result += uint32_t(!(v >= 0.0f && v < 1.0f));
+    }
+  }
+  return result;
+}
+
+} //  anon
+
+int main(int, char**) {
+  TaskPool pool;
+  pool.start(TaskPool::default_num_worker_threads());
+
+  gen::SlimeMoldConfig config{};
+  config.num_particles = Config::num_particles;
+  gen::SlimeMoldParams params{};
+  params.signal_value = 1.0f;
+
+  constexpr int dim = gen::SlimeMoldConfig::texture_dim;
+  uint32_t num_mismatch{};
+
+  {
+    //  Diffusion alone matches `update_slime_mold_particles` exactly.
+    auto diffuse_config = config;
+    diffuse_config.num_particles = 0;
+    diffuse_config.allow_perturb_event = false;
+    diffuse_config.allow_signal_influence = false;
+
+    auto tex_data = gen::make_default_slime_mold_texture_data();
+    gen::SlimeMoldSimulationContext context{};
+    context.texture_data0 = tex_data.texture_data0.get();
+    context.texture_data1 = tex_data.texture_data1.get();
+    context.texture_data2 = tex_data.texture_data2.get();
+    context.perturb_data = tex_data.perturb_data.get();
+    context.signal_data = tex_data.signal_data.get();
+    context.params = &params;
+    set_random_texture(context.texture_data0, texture_size(dim), 1);
+
+    for (TaskPool* task_pool : {(TaskPool*) nullptr, &pool}) {
+      gen::SlimeMoldSimulation sim;
+      sim.initialize(diffuse_config, dim, 0);
+      set_random_texture(sim.texture_data(), texture_size(dim), 1);
+
+      auto ref = gen::make_slime_mold_texture_data();
+      std::copy(context.texture_data0, context.texture_data0 + texture_size(dim), ref.get());
+      gen::SlimeMoldSimulationContext ref_context = context;
+      ref_context.texture_data0 = ref.get();
+      for (int i = 0; i < Config::num_diffuse_steps; i++) {
+        gen::update_slime_mold_particles(nullptr, diffuse_config, &ref_context);
+        sim.update(diffuse_config, params, task_pool);
+      }
+      const size_t num_bytes = texture_size(dim) * sizeof(float);
+      num_mismatch += uint32_t(std::memcmp(ref.get(), sim.texture_data(), num_bytes) != 0);
+    }
+  }
+
+  {
+    auto tex_data = gen::make_default_slime_mold_texture_data();
+    auto particles = gen::make_slime_mold_particles(config);
+    gen::SlimeMoldSimulationContext context{};
+    context.texture_data0 = tex_data.texture_data0.get();
+    context.texture_data1 = tex_data.texture_data1.get();
+    context.texture_data2 = tex_data.texture_data2.get();
+    context.perturb_data = tex_data.perturb_data.get();
+    context.signal_data = tex_data.signal_data.get();
+    context.params = &params;
+    const double reference_ms = ms_per_step([&]() {
+      gen::update_slime_mold_particles(particles.get(), config, &context);
+    });
+
+    gen::SlimeMoldSimulation sim;
+    sim.initialize(config, dim, config.num_particles);
+    const double serial_ms = ms_per_step([&]() {
+      sim.update(config, params, nullptr);
+    });
+    const double parallel_ms = ms_per_step([&]() {
+      sim.update(config, params, &pool);
+    });
+    num_mismatch += count_out_of_range(sim);
+
+    std::cout << dim << "^2, " << config.num_particles << " particles; reference: "
+              << reference_ms << "ms/step; serial: " << serial_ms << "ms/step; "
+              << pool.num_workers() + 1 << " thread(s): " << parallel_ms << "ms/step" << std::endl;
+  }
+
+  {
+    auto large_config = config;
+    large_config.num_particles = Config::num_large_particles;
+    large_config.circular_world = false;
+
+    gen::SlimeMoldSimulation sim;
+    sim.initialize(large_config, Config::large_texture_dim, large_config.num_particles);
+    const double parallel_ms = ms_per_step([&]() {
+      sim.update(large_config, params, &pool);
+    });
+    num_mismatch += count_out_of_range(sim);
+
+    std::cout << Config::large_texture_dim << "^2, " << large_config.num_particles
+              << " particles; " << pool.num_workers() + 1 << " thread(s): " << parallel_ms
+              << "ms/step" << std::endl;
+  }
+
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+  pool.stop();
+  return num_mismatch == 0 ? 0 : 1;
+}
@@ -14,6 +14,7 @@
 #include "grove/common/Temporary.hpp"
 #include "./imgui.hpp"
 #include <imgui/imgui.h>
+#include <algorithm>
 
 #if GROVE_INCLUDE_IMPLOT
 #include <implot.h>
@@ -178,6 +179,52 @@ void render_render_buffer_system() {
   ImGui::Text("NumPendingFree: %d", int(stats.num_pending_free));
 }
 
+void render_graph_node_profiles(const AudioComponent& component, AudioGUIUpdateResult& result) {
+  const auto& graph_component = component.audio_graph_component;
+  bool profiling_enabled = graph_component.is_node_profiling_enabled();
+  if (ImGui::Checkbox("Enabled", &profiling_enabled)) {
+    result.graph_node_profiling_enabled = profiling_enabled;
+  }
+
+  auto stats = graph_component.renderer.ui_get_node_profile_stats();
+  ImGui::Text("QuantumBudgetMs: %0.3f", stats.quantum_budget_ms);
+  ImGui::Text("NumDroppedSamples: %d", int(stats.num_dropped_samples));
+
+  std::vector<AudioGraphRenderer::NodeProfile> profiles;
+  graph_component.renderer.ui_get_node_profiles(profiles);
+  std::sort(profiles.begin(), profiles.end(), [](const auto& a, const auto& b) {
+    return a.p99_ms > b.p99_ms;
+  });
+
+  const double budget_ms = stats.quantum_budget_ms;
+  for (auto& profile : profiles) {
+    const double budget_frac = budget_ms > 0.0 ? profile.p99_ms / budget_ms : 0.0;
+    ImGui::Text("%d: Min %0.4f | Mean %0.4f | Max %0.4f | P99 %0.4f (%0.1f%%)",
+                int(profile.node_id), profile.min_ms, profile.mean_ms, profile.max_ms,
+                profile.p99_ms, budget_frac * 100.0);
+  }
+}
+
+void render_graph_renderer(const AudioComponent& component, AudioGUIUpdateResult& result) {
+  const auto& graph_component = component.audio_graph_component;
+  bool parallel_enabled = graph_component.is_parallel_render_enabled();
+  if (ImGui::Checkbox("ParallelRender", &parallel_enabled)) {
+    result.parallel_graph_render_enabled = parallel_enabled;
+  }
+
+  auto stats = graph_component.renderer.ui_get_parallel_render_stats();
+  ImGui::Text("NumWorkerThreads: %d", stats.num_worker_threads);
+  ImGui::Text("NumParallelSubgraphs: %d", stats.latest_num_subgraphs);
+  ImGui::Text("RenderMs: %0.3f", stats.latest_render_ms);
+  ImGui::Text("CriticalPathMs: %0.3f", stats.latest_critical_path_ms);
+  ImGui::Text("MaxCriticalPathMs: %0.3f", stats.max_critical_path_ms);
+
+  if (ImGui::TreeNode("NodeProfiles")) {
+    render_graph_node_profiles(component, result);
+    ImGui::TreePop();
+  }
+}
+
 bool is_spectrum_node(uint32_t node_id, const AudioNodeStorage& node_storage) {
   if (node_storage.node_exists(node_id) && node_storage.is_instance_created(node_id)) {
     if (auto* base = node_storage.get_audio_processor_node_instance(node_id)) {
@@ -422,6 +469,11 @@ AudioGUIUpdateResult AudioGUI::render(const AudioComponent& component,
     ImGui::TreePop();
   }
 
+  if (ImGui::TreeNode("AudioGraphRenderer")) {
+    render_graph_renderer(component, result);
+    ImGui::TreePop();
+  }
+
   const auto* tuning = component.ui_audio_scale.get_tuning();
   auto ref_st = int(tuning->reference_semitone);
   if (default_input_int("ReferenceSemitone", &ref_st)) {
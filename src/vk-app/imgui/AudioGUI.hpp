@@ -19,6 +19,8 @@ struct AudioGUIUpdateResult {
   Optional<AudioCore::FrameInfo> new_frame_info;
   Optional<bool> tuning_controlled_by_environment;
   Optional<bool> metronome_enabled;
+  Optional<bool> parallel_graph_render_enabled;
+  Optional<bool> graph_node_profiling_enabled;
   Optional<double> new_bpm;
   bool toggle_stream_started{};
   bool close{};
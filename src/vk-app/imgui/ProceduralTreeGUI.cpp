@@ -340,6 +340,16 @@ ProceduralTreeGUI::render(ProceduralTreeComponent& component, const tree::Growth
       result.deserialize_from_file_path = std::string{buff};
     }
 
+    memset(buff, 0, 1024);
+    if (ImGui::InputText("SaveSnapshot", buff, 1024, enter_flag())) {
+      result.save_snapshot_to_file_path = std::string{buff};
+    }
+
+    memset(buff, 0, 1024);
+    if (ImGui::InputText("LoadSnapshot", buff, 1024, enter_flag())) {
+      result.load_snapshot_from_file_path = std::string{buff};
+    }
+
     auto deser_trans = component.deserialized_tree_translation;
     if (ImGui::InputFloat3("DeserializedTreeTranslation", &deser_trans.x, "%0.3f", enter_flag())) {
       result.deserialized_tree_translation = deser_trans;
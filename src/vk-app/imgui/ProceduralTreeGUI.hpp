@@ -53,6 +53,8 @@ public:
     Optional<Vec3f> deserialized_tree_translation;
     Optional<std::string> serialize_selected_to_file_path;
     Optional<std::string> deserialize_from_file_path;
+    Optional<std::string> save_snapshot_to_file_path;
+    Optional<std::string> load_snapshot_from_file_path;
     Optional<float> resource_spiral_theta;
     Optional<float> resource_spiral_vel;
     Optional<bool> vine_growth_by_signal;
@@ -104,6 +104,16 @@ SoilGUIUpdateResult SoilGUI::render(const SoilComponent& component,
     result.speed_power = soil_config.scale_speed_power - 1;
   }
 
+  int num_steps = soil_config.num_steps_per_update;
+  if (ImGui::SliderInt("StepsPerUpdate", &num_steps, 1, 16)) {
+    result.num_steps_per_update = num_steps;
+  }
+
+  bool off_main_thread = soil_config.update_off_main_thread;
+  if (ImGui::Checkbox("UpdateOffMainThread", &off_main_thread)) {
+    result.update_off_main_thread = off_main_thread;
+  }
+
   if (ImGui::Button("Close")) {
     result.close = true;
   }
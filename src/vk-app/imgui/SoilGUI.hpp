@@ -26,6 +26,8 @@ struct SoilGUIUpdateResult {
   Optional<bool> only_right_turns;
   Optional<int> turn_speed_power;
   Optional<int> speed_power;
+  Optional<int> num_steps_per_update;
+  Optional<bool> update_off_main_thread;
   bool close{};
 };
 
@@ -85,6 +85,8 @@
 #include "grove/input/controllers/KeyboardMouse.hpp"
 #include "grove/math/random.hpp"
 #include "grove/math/string_cast.hpp"
+#include "grove/common/FrameArena.hpp"
+#include "grove/common/TaskPool.hpp"
 #include "grove/env.hpp"
 
 #include <GLFW/glfw3.h>
@@ -157,6 +159,8 @@ struct App {
     bool need_quit{};
   };
 
+  //  Shared by subsystems that parallelize work; declared first so that it outlives them.
+  TaskPool task_pool;
   vk::GLFWContext glfw_context;
   vk::GraphicsContext graphics_context;
   gfx::Context* opaque_graphics_context{};
@@ -748,6 +752,7 @@ void initialize_debug_arch_component(App& app) {
 }
 
 void initialize_tree_systems(App& app) {
+  app.tree_growth_system.task_pool = &app.task_pool;
   tree::destroy_render_tree_system(&app.render_tree_system);
   app.render_tree_system = tree::create_render_tree_system();
   tree::initialize(app.render_tree_system, {});
@@ -778,7 +783,8 @@ void initialize_debug_procedural_tree_component(App& app) {
     ArchRenderer::make_add_resource_context(app.graphics_context),
     app.render_component.arch_renderer,
     app.render_component.procedural_flower_stem_renderer,
-    app.terrain_component.get_terrain()
+    app.terrain_component.get_terrain(),
+    &app.task_pool
   });
 }
 
@@ -861,6 +867,7 @@ void initialize_procedural_flower_component(App& app) {
 }
 
 bool initialize(App& app, const cmd::Arguments& args) {
+  app.task_pool.start(TaskPool::default_num_worker_threads());
   if (!initialize_glfw(&app.glfw_context, &app, args)) {
     return false;
   }
@@ -1157,7 +1164,8 @@ update_ui_audio_connection_manager(App& app, const ConnectResult& audio_connect_
     &app.cable_path_finder,
     &app.selected_instrument_components,
     audio_connect_result.new_connections,
-    audio_connect_result.new_disconnections
+    audio_connect_result.new_disconnections,
+    &app.task_pool
   });
   return ui_connect_update_result;
 }
@@ -1382,6 +1390,7 @@ void update_terrain_components(App& app, const weather::Status& weather_status,
       app.graphics_context.sampled_image_manager,
       app.transform_system,
       app.terrain_component.get_terrain(),
+      &app.task_pool,
     });
 #if 0
     for (int i = 0; i < res.num_add; i++) {
@@ -1406,7 +1415,8 @@ void update_terrain_components(App& app, const weather::Status& weather_status,
 void update_soil_component(App& app) {
   auto update_res = app.soil_component.update({
     app.graphics_context.dynamic_sampled_image_manager,
-    app.camera.get_position_xz()
+    app.camera.get_position_xz(),
+    &app.task_pool
   });
   if (update_res.show_debug_image) {
     app.render_component.debug_image_renderer.push_drawable(
@@ -1449,7 +1459,8 @@ void update_arch_component(App& app, double real_dt, const Ray& mouse_ray) {
     mouse_ray,
     app.mouse_state.left_mouse_clicked,
     proj_internodes,
-    num_proj_internodes
+    num_proj_internodes,
+    &app.task_pool
   });
 }
 
@@ -1605,7 +1616,8 @@ void update_fog_component(App& app, const weather::Status& weather_status, doubl
     weather_status,
     app.camera,
     app.terrain_component.get_terrain(),
-    app.wind_component.wind
+    app.wind_component.wind,
+    &app.task_pool
   });
 }
 
@@ -1695,6 +1707,7 @@ void update_debug_procedural_tree_component(App& app, const Ray& mouse_ray, doub
     tree::get_global_resource_spiral_around_nodes_system(),
     app.camera,
     mouse_ray,
+    &app.task_pool,
     real_dt
   });
 
@@ -1860,6 +1873,8 @@ void update_resource_spiral_around_nodes(App& app, double real_dt) {
     cull::get_global_tree_leaves_frustum_cull_data(),
     cull::get_global_branch_nodes_frustum_cull_data(),
     tree::get_global_branch_nodes_data(),
+    get_global_frame_arena(),
+    &app.task_pool,
     real_dt
   });
   tree::debug::update_debug_growth_contexts({
@@ -2147,6 +2162,7 @@ void update_glfw_context(const App& app) {
 void update(App& app) {
   auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("App/update");
   (void) profiler;
+  get_global_frame_arena()->reset();
   const double frame_dt = app.frame_timer.delta_update().count();
   const double current_time = app.elapsed_timer.delta().count();
 
@@ -2442,6 +2458,14 @@ void render_audio_gui(App& app) {
   if (gui_res.metronome_enabled) {
     metronome::ui_toggle_enabled(app.audio_component.get_metronome());
   }
+  if (gui_res.parallel_graph_render_enabled) {
+    app.audio_component.audio_graph_component.set_parallel_render_enabled(
+      gui_res.parallel_graph_render_enabled.value());
+  }
+  if (gui_res.graph_node_profiling_enabled) {
+    app.audio_component.audio_graph_component.set_node_profiling_enabled(
+      gui_res.graph_node_profiling_enabled.value());
+  }
   if (gui_res.new_bpm) {
     app.audio_component.audio_transport.set_bpm(gui_res.new_bpm.value());
   }
@@ -2908,6 +2932,7 @@ void terminate(App& app) {
   vk::destroy_graphics_context(&app.graphics_context);
   vk::destroy_and_terminate_glfw_context(&app.glfw_context);
   app.audio_component.terminate();
+  app.task_pool.stop();
 }
 
 Optional<cmd::Arguments> parse_arguments(int argc, char** argv) {
@@ -4,23 +4,25 @@
 
 GROVE_NAMESPACE_BEGIN
 
-std::vector<float> make_reflected_grid_indices(int num_pts_x, int num_pts_z) {
+void make_reflected_grid_indices(int num_pts_x, int num_pts_z, float* dst) {
   //  Expect odd number of X points, and more than 2.
   assert(num_pts_x > 2 && num_pts_x % 2 == 1);
   const auto x_dim = num_pts_x / 2;
 
-  std::vector<float> grid_indices;
-
   for (int i = 0; i < num_pts_z; i++) {
     for (int j = 0; j < num_pts_x; j++) {
       auto x_ind = -x_dim + j;
       auto z_ind = i;
 
-      grid_indices.push_back(float(x_ind));
-      grid_indices.push_back(float(z_ind));
+      *dst++ = float(x_ind);
+      *dst++ = float(z_ind);
     }
   }
+}
 
+std::vector<float> make_reflected_grid_indices(int num_pts_x, int num_pts_z) {
+  std::vector<float> grid_indices(num_reflected_grid_index_components(num_pts_x, num_pts_z));
+  make_reflected_grid_indices(num_pts_x, num_pts_z, grid_indices.data());
   return grid_indices;
 }
 
@@ -28,8 +30,7 @@ std::vector<float> make_reflected_grid_indices(const GridGeometryParams& params)
   return make_reflected_grid_indices(params.num_pts_x, params.num_pts_z);
 }
 
-std::vector<uint16_t> triangulate_reflected_grid(int num_pts_x, int num_pts_z) {
-  std::vector<uint16_t> result;
+void triangulate_reflected_grid(int num_pts_x, int num_pts_z, uint16_t* dst) {
   auto x_dim = num_pts_x / 2;
 
   for (int i = 0; i < num_pts_z-1; i++) {
@@ -46,26 +47,30 @@ std::vector<uint16_t> triangulate_reflected_grid(int num_pts_x, int num_pts_z) {
 
       if (x_ind >= 0) {
         //  Positive half.
-        result.push_back(top_left);
-        result.push_back(bottom_left);
-        result.push_back(bottom_right);
+        *dst++ = top_left;
+        *dst++ = bottom_left;
+        *dst++ = bottom_right;
 
-        result.push_back(bottom_right);
-        result.push_back(top_right);
-        result.push_back(top_left);
+        *dst++ = bottom_right;
+        *dst++ = top_right;
+        *dst++ = top_left;
       } else {
         //  Negative half.
-        result.push_back(bottom_left);
-        result.push_back(bottom_right);
-        result.push_back(top_right);
+        *dst++ = bottom_left;
+        *dst++ = bottom_right;
+        *dst++ = top_right;
 
-        result.push_back(bottom_left);
-        result.push_back(top_right);
-        result.push_back(top_left);
+        *dst++ = bottom_left;
+        *dst++ = top_right;
+        *dst++ = top_left;
       }
     }
   }
+}
 
+std::vector<uint16_t> triangulate_reflected_grid(int num_pts_x, int num_pts_z) {
+  std::vector<uint16_t> result(num_reflected_grid_triangle_indices(num_pts_x, num_pts_z));
+  triangulate_reflected_grid(num_pts_x, num_pts_z, result.data());
   return result;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <functional>
 
@@ -31,6 +33,18 @@ public:
   }
 };
 
+inline size_t num_reflected_grid_index_components(int num_pts_x, int num_pts_z) {
+  return size_t(num_pts_x) * size_t(num_pts_z) * 2;
+}
+inline size_t num_reflected_grid_triangle_indices(int num_pts_x, int num_pts_z) {
+  return size_t(num_pts_x - 1) * size_t(num_pts_z - 1) * 6;
+}
+
+//  Write into `dst`, which must hold `num_reflected_grid_index_components` or
+//  `num_reflected_grid_triangle_indices` elements, respectively.
+void make_reflected_grid_indices(int num_pts_x, int num_pts_z, float* dst);
+void triangulate_reflected_grid(int num_pts_x, int num_pts_z, uint16_t* dst);
+
 std::vector<float> make_reflected_grid_indices(int num_pts_x, int num_pts_z);
 std::vector<float> make_reflected_grid_indices(const GridGeometryParams& params);
 std::vector<uint16_t> triangulate_reflected_grid(int num_pts_x, int num_pts_z);
@@ -105,10 +105,11 @@ bool update_render_growth(tree::TreeNodeStore& tree_nodes,
 }
 
 void create_debug_tree_mesh_data(const tree::Internodes& nodes, std::vector<float>* verts,
-                                 std::vector<uint16_t>* inds) {
+                                 std::vector<uint16_t>* inds, TaskPool* task_pool) {
   tree::MakeNodeMeshParams mesh_params{};
   mesh_params.offset = {};
   mesh_params.include_uv = true;
+  mesh_params.task_pool = task_pool;
 
   const auto num_inodes = uint32_t(nodes.size());
   Vec2<int> grid_xz{5, 2};
@@ -192,7 +193,7 @@ void create_debug_tree_mesh(DebugProceduralTreeComponent& component,
                             const tree::Internodes& nodes, const InitInfo& info) {
   std::vector<float> verts;
   std::vector<uint16_t> inds;
-  create_debug_tree_mesh_data(nodes, &verts, &inds);
+  create_debug_tree_mesh_data(nodes, &verts, &inds, info.task_pool);
 
   std::vector<float> leaf_verts;
   std::vector<uint16_t> leaf_inds;
@@ -1321,7 +1322,8 @@ void update_debug_render_branch_nodes(DebugProceduralTreeComponent& component,
       auto axis_roots = tree::compute_axis_root_info(inodes);
       auto remapped_roots = tree::remap_axis_roots(inodes);
       components = tree::create_wind_branch_node_drawable_components_from_internodes(
-        info.render_branch_nodes_data, inodes, *inst.src_aabb, axis_roots, remapped_roots);
+        info.render_branch_nodes_data, inodes, *inst.src_aabb, axis_roots, remapped_roots,
+        info.task_pool);
     }
 
     if (inst.events.node_render_position_modified) {
@@ -1559,7 +1561,8 @@ DebugProceduralTreeComponent::update(const UpdateInfo& info) {
     info.proc_tree_component,
     info.tree_system,
     info.roots_system,
-    info.camera
+    info.camera,
+    info.task_pool
   });
 #endif
 
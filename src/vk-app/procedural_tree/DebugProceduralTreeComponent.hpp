@@ -17,6 +17,7 @@ namespace grove {
 class SpatiallyVaryingWind;
 class Terrain;
 class ProceduralTreeComponent;
+class TaskPool;
 
 namespace bounds {
 struct RadiusLimiter;
@@ -37,6 +38,7 @@ public:
     ArchRenderer& arch_renderer;
     ProceduralFlowerStemRenderer& proc_flower_stem_renderer;
     const Terrain& terrain;
+    TaskPool* task_pool;
   };
   struct UpdateInfo {
     const ProceduralTreeRootsRenderer::AddResourceContext& roots_renderer_context;
@@ -54,6 +56,7 @@ public:
     tree::ResourceSpiralAroundNodesSystem* resource_spiral_sys;
     const Camera& camera;
     const Ray& mouse_ray;
+    TaskPool* task_pool;
     double real_dt;
   };
   struct UpdateResult {
@@ -86,6 +86,7 @@ void insert_attraction_points(Context* context) {
 void start_growing(Context* context) {
   context->stopwatch.reset();
   insert_attraction_points(context);
+  context->attraction_points->pack();
 }
 
 void finish_growing(Context* context) {
@@ -58,6 +58,10 @@ namespace {
 
 using namespace ls;
 
+struct Config {
+  static constexpr uint32_t max_num_modules_in_repr = 512;
+};
+
 struct RandStream {
   float nextf() {
     return float(dis(gen));
@@ -101,8 +105,16 @@ struct ExecutionContext {
   std::unique_ptr<uint8_t[]> frame;
   size_t frame_size{};
 
+  std::vector<RegisterProgram> rule_programs;
+  DeriveScratch derive_scratch;
+
   std::vector<uint32_t> axiom;
   std::vector<uint8_t> axiom_data;
+
+  //  String derived at each step so far, beginning with the axiom, and the state of the random
+  //  stream after each one.
+  std::vector<DeriveResult> derived_steps;
+  std::vector<std::mt19937> derived_step_rand_states;
 };
 
 struct LSExecutionPipeline {
@@ -137,11 +149,15 @@ struct ls::LSystemComponent {
   bool use_rand_seed{};
   int num_steps{};
   bool need_run_system{};
+  bool need_clear_derived_steps{};
+  bool need_update_internodes{};
   bool need_regen_execution_context{};
   bool hide_module_contents_in_repr{true};
   bool draw_node_bounds{};
   DeriveResult latest_derive_result{};
   std::string latest_derive_result_repr{};
+  DeriveMemo derive_memo;
+  std::vector<ls::Internode> built_internodes;
   std::vector<ls::Internode> debug_internodes;
 
   ProceduralTreeRootsRenderer::DrawableHandle debug_drawable{};
@@ -498,7 +514,8 @@ bool gen_axiom(const LSExecutionPipeline& pipeline, ExecutionContext* ctx) {
   return true;
 }
 
-Optional<ExecutionContext> create_execution_context(const LSExecutionPipeline& pipeline) {
+Optional<ExecutionContext> create_execution_context(const LSExecutionPipeline& pipeline,
+                                                    DeriveMemo* memo) {
   ExecutionContext result;
   result.frame_size = pipeline.resolve_result.scope_range;
   result.frame = std::make_unique<uint8_t[]>(result.frame_size);
@@ -527,6 +544,12 @@ Optional<ExecutionContext> create_execution_context(const LSExecutionPipeline& p
   derive_ctx.stack_size = stack_size;
   derive_ctx.branch_in_t = res_res.branch_in_t;
   derive_ctx.branch_out_t = res_res.branch_out_t;
+  //  Rules call `urand`, which draws from a shared stream, so they are evaluated serially.
+  result.rule_programs = make_register_programs(&derive_ctx);
+  derive_ctx.rule_programs = result.rule_programs.data();
+  //  Entries of rules that are unchanged since the last compile remain valid.
+  prepare_derive_memo(memo, &derive_ctx);
+  derive_ctx.memo = memo;
 
   if (!gen_axiom(pipeline, &result)) {
     return NullOpt{};
@@ -535,37 +558,56 @@ Optional<ExecutionContext> create_execution_context(const LSExecutionPipeline& p
   return Optional<ExecutionContext>(std::move(result));
 }
 
+//  Steps derived by earlier runs are reused until cleared.
 Optional<DeriveResult> run_system(ExecutionContext* ctx, int num_steps) {
-  auto str = ctx->axiom;
-  auto str_data = ctx->axiom_data;
-  for (int i = 0; i < num_steps; i++) {
+  auto& steps = ctx->derived_steps;
+  auto& rand_states = ctx->derived_step_rand_states;
+  if (steps.empty()) {
+    auto& axiom = steps.emplace_back();
+    axiom.str = ctx->axiom;
+    axiom.str_data = ctx->axiom_data;
+    rand_states.push_back(globals.rand_stream.gen);
+  }
+
+  const int num_derived = int(steps.size()) - 1;
+  if (num_steps > num_derived) {
+    globals.rand_stream.gen = rand_states.back();
+  }
+  for (int i = num_derived; i < num_steps; i++) {
     DerivingString derive_str{};
-    derive_str.str_data = str_data.data();
-    derive_str.str_data_size = uint32_t(str_data.size());
-    derive_str.str = str.data();
-    derive_str.str_size = uint32_t(str.size());
-    auto derive_res = derive_branched(&ctx->derive_context, &derive_str);
-    str = derive_res.str;
-    str_data = derive_res.str_data;
+    derive_str.str_data = steps[i].str_data.data();
+    derive_str.str_data_size = uint32_t(steps[i].str_data.size());
+    derive_str.str = steps[i].str.data();
+    derive_str.str_size = uint32_t(steps[i].str.size());
+    DeriveResult next;
+    derive_branched(&ctx->derive_context, &derive_str, &ctx->derive_scratch, &next);
+    steps.push_back(std::move(next));
+    rand_states.push_back(globals.rand_stream.gen);
   }
 
   DeriveResult result;
-  result.str = std::move(str);
-  result.str_data = std::move(str_data);
+  result.str = steps[num_steps].str;
+  result.str_data = steps[num_steps].str_data;
   return Optional<DeriveResult>(std::move(result));
 }
 
+void clear_derived_steps(ExecutionContext* ctx) {
+  ctx->derived_steps.clear();
+  ctx->derived_step_rand_states.clear();
+}
+
 std::string debug_repr_derived_str(const LSExecutionPipeline& pipeline,
                                    const std::vector<uint32_t>& str,
                                    const std::vector<uint8_t>& str_data,
-                                   bool hide_mod_contents) {
+                                   bool hide_mod_contents, uint32_t max_num_modules) {
   auto dump_ctx = to_dump_context(
     pipeline.parse_result, pipeline.resolve_result, &pipeline.string_registry);
   dump_ctx.hide_module_contents = hide_mod_contents;
 
   std::string dump_str;
   uint32_t off{};
-  for (uint32_t i = 0; i < uint32_t(str.size()); i++) {
+  const auto num_modules = std::min(uint32_t(str.size()), max_num_modules);
+  for (uint32_t i = 0; i < num_modules; i++) {
     auto sz = module_type_size(
       pipeline.resolve_result.type_nodes.data(),
       pipeline.resolve_result.storage_locations.data(),
@@ -576,6 +618,9 @@ std::string debug_repr_derived_str(const LSExecutionPipeline& pipeline,
       dump_str += dump_ctx.hide_module_contents ? "," : "\n";
     }
   }
+  if (num_modules < str.size()) {
+    dump_str += "...";
+  }
 
   return dump_str;
 }
@@ -898,34 +943,32 @@ AssignDiameterParams make_assign_diameter_params(float leaf_diam, float diam_pow
   return result;
 }
 
-float assign_diameter(ls::Internode* nodes, ls::Internode* node,
-                      const AssignDiameterParams& params) {
-  auto leaf_diameter = [](const AssignDiameterParams& params) -> float {
-    return std::pow(params.leaf_diameter, params.diameter_power);
-  };
-
-  float md = leaf_diameter(params);
-  float ld = node->lateral_child_size == 0 ? md : 0.0f;
-  if (node->has_medial_child()) {
-    md = assign_diameter(nodes, nodes + node->medial_child, params);
-  }
-  for (int i = 0; i < node->lateral_child_size; i++) {
-    ld += assign_diameter(nodes, nodes + i + node->lateral_child_begin, params);
-  }
-
-  auto d = md + ld;
-  const auto min_diam = float(std::pow(d, 1.0 / params.diameter_power));
-  assert(node->diameter == 0.0f);
-  node->diameter = std::max(params.leaf_diameter, min_diam);
-  assert(std::isfinite(node->diameter) && node->diameter >= 0.0f);
-  return d;
-}
-
 void assign_diameter(ls::Internode* nodes, int num_nodes, const AssignDiameterParams& params) {
-  for (int i = 0; i < num_nodes; i++) {
-    if (nodes[i].is_root()) {
-      assign_diameter(nodes, nodes + i, params);
+  Temporary<float, 2048> store_sums;
+  float* sums = store_sums.require(num_nodes);
+  const float leaf_d = std::pow(params.leaf_diameter, params.diameter_power);
+
+  //  Children follow their parents (see `build_tree`), so in reverse order, each node is visited
+  //  after its children.
+  for (int i = num_nodes - 1; i >= 0; i--) {
+    auto& node = nodes[i];
+    float md = leaf_d;
+    float ld = node.lateral_child_size == 0 ? md : 0.0f;
+    if (node.has_medial_child()) {
+      assert(node.medial_child > i);
+      md = sums[node.medial_child];
     }
+    for (int j = 0; j < node.lateral_child_size; j++) {
+      assert(node.lateral_child_begin + j > i);
+      ld += sums[node.lateral_child_begin + j];
+    }
+
+    auto d = md + ld;
+    const auto min_diam = float(std::pow(d, 1.0 / params.diameter_power));
+    assert(node.diameter == 0.0f);
+    node.diameter = std::max(params.leaf_diameter, min_diam);
+    assert(std::isfinite(node.diameter) && node.diameter >= 0.0f);
+    sums[i] = d;
   }
 }
 
@@ -1108,6 +1151,8 @@ Vec3f get_origin(const LSystemComponent& comp, const Terrain& terrain) {
 LSystemComponent* ls::create_lsystem_component() {
   auto* res = new LSystemComponent();
   res->src_file_path = std::string{GROVE_ASSET_DIR} + "/lsystem/branch.txt";
+  //  `urand` and `urand3` draw from a shared stream, so rules that call them are not memoized.
+  res->derive_memo.pure_functions = {system_norm3};
   return res;
 }
 
@@ -1123,7 +1168,7 @@ void ls::update_lsystem_component(LSystemComponent* comp, const LSystemComponent
       comp->debug_execution_pipeline = create_execution_pipeline(src.value());
       if (comp->debug_execution_pipeline) {
         auto& pipe = comp->debug_execution_pipeline.value();
-        comp->debug_execution_context = create_execution_context(pipe);
+        comp->debug_execution_context = create_execution_context(pipe, &comp->derive_memo);
         comp->gen_execution_context_ms = float(stopwatch.delta().count() * 1e3);
       }
     }
@@ -1133,45 +1178,57 @@ void ls::update_lsystem_component(LSystemComponent* comp, const LSystemComponent
   if (comp->need_run_system && comp->debug_execution_pipeline &&
       comp->debug_execution_context) {
 
-    if (comp->use_rand_seed) {
+    auto& exec_ctx = comp->debug_execution_context.value();
+    if (comp->need_clear_derived_steps) {
+      clear_derived_steps(&exec_ctx);
+      comp->need_clear_derived_steps = false;
+    }
+    if (comp->use_rand_seed && exec_ctx.derived_steps.empty()) {
       globals.rand_stream.seed(comp->rand_seed);
     }
 
     Stopwatch stopwatch;
-    auto derive_res = run_system(&comp->debug_execution_context.value(), comp->num_steps);
+    auto derive_res = run_system(&exec_ctx, comp->num_steps);
     if (derive_res) {
       comp->latest_derive_result = std::move(derive_res.value());
       comp->latest_derive_result_repr = debug_repr_derived_str(
         comp->debug_execution_pipeline.value(),
         comp->latest_derive_result.str,
         comp->latest_derive_result.str_data,
-        comp->hide_module_contents_in_repr);
+        comp->hide_module_contents_in_repr,
+        Config::max_num_modules_in_repr);
       comp->derive_ms = float(stopwatch.delta().count() * 1e3);
 
       stopwatch.reset();
       auto view_res = to_deriving_string(comp->latest_derive_result);
       auto branch_ctx = to_extract_builtin_module_params(comp->debug_execution_pipeline.value());
       auto extracted_mods = extract_builtin_modules(view_res, branch_ctx);
-      auto inodes = build_tree(extracted_mods.data(), uint32_t(extracted_mods.size()));
-      assert(internode_relationships_valid(inodes.data(), int(inodes.size())));
+      comp->built_internodes = build_tree(extracted_mods.data(), uint32_t(extracted_mods.size()));
+      assert(internode_relationships_valid(
+        comp->built_internodes.data(), int(comp->built_internodes.size())));
       comp->build_tree_ms = float(stopwatch.delta().count() * 1e3);
-
-      //  create mesh
-      stopwatch.reset();
-      apply_length_scale(inodes.data(), int(inodes.size()), comp->length_scale);
-      assign_position(inodes.data(), int(inodes.size()), get_origin(*comp, info.terrain));
-      auto diam_params = make_assign_diameter_params(comp->leaf_diameter, comp->diameter_power);
-      assign_diameter(inodes.data(), int(inodes.size()), diam_params);
-      create_roots_drawable(
-        inodes.data(), int(inodes.size()), &comp->debug_drawable,
-        info.roots_renderer, info.roots_renderer_context);
-      comp->gen_mesh_ms = float(stopwatch.delta().count() * 1e3);
-
-      comp->debug_internodes = std::move(inodes);
+      comp->need_update_internodes = true;
     }
     comp->need_run_system = false;
   }
 
+  if (comp->need_update_internodes) {
+    //  create mesh
+    Stopwatch stopwatch;
+    auto inodes = comp->built_internodes;
+    apply_length_scale(inodes.data(), int(inodes.size()), comp->length_scale);
+    assign_position(inodes.data(), int(inodes.size()), get_origin(*comp, info.terrain));
+    auto diam_params = make_assign_diameter_params(comp->leaf_diameter, comp->diameter_power);
+    assign_diameter(inodes.data(), int(inodes.size()), diam_params);
+    create_roots_drawable(
+      inodes.data(), int(inodes.size()), &comp->debug_drawable,
+      info.roots_renderer, info.roots_renderer_context);
+    comp->gen_mesh_ms = float(stopwatch.delta().count() * 1e3);
+
+    comp->debug_internodes = std::move(inodes);
+    comp->need_update_internodes = false;
+  }
+
   if (comp->draw_node_bounds) {
     for (auto& node : comp->debug_internodes) {
       auto obb = make_node_obb(node);
@@ -1201,19 +1258,24 @@ void ls::render_lsystem_component_gui(LSystemComponent* comp) {
   if (ImGui::InputInt("Seed", &s)) {
     comp->rand_seed = uint32_t(s);
     comp->need_run_system = true;
+    comp->need_clear_derived_steps = true;
   }
 
   if (ImGui::SliderFloat("LeafDiameter", &comp->leaf_diameter, 0.01f, 0.06f)) {
-    comp->need_run_system = true;
+    comp->need_update_internodes = true;
   }
   if (ImGui::SliderFloat("DiameterPower", &comp->diameter_power, 0.5f, 2.5f)) {
-    comp->need_run_system = true;
+    comp->need_update_internodes = true;
   }
   if (ImGui::SliderFloat("LengthScale", &comp->length_scale, 0.05f, 4.0f)) {
-    comp->need_run_system = true;
+    comp->need_update_internodes = true;
+  }
+  if (ImGui::Checkbox("LockToTerrain", &comp->lock_to_terrain)) {
+    comp->need_update_internodes = true;
+  }
+  if (ImGui::InputFloat3("Origin", &comp->origin.x)) {
+    comp->need_update_internodes = true;
   }
-  ImGui::Checkbox("LockToTerrain", &comp->lock_to_terrain);
-  ImGui::InputFloat3("Origin", &comp->origin.x);
 
   ImGui::Checkbox("DrawNodeBounds", &comp->draw_node_bounds);
   ImGui::Checkbox("HideModuleContents", &comp->hide_module_contents_in_repr);
@@ -1225,6 +1287,7 @@ void ls::render_lsystem_component_gui(LSystemComponent* comp) {
   if (comp->debug_execution_pipeline && comp->debug_execution_context) {
     if (ImGui::Button("RunSystem")) {
       comp->need_run_system = true;
+      comp->need_clear_derived_steps = true;
     }
   }
 
@@ -1235,6 +1298,8 @@ void ls::render_lsystem_component_gui(LSystemComponent* comp) {
   ImGui::Text("DeriveIn: %0.3fms", comp->derive_ms);
   ImGui::Text("BuiltTreeIn: %0.3fms", comp->build_tree_ms);
   ImGui::Text("GenMeshIn: %0.3fms", comp->gen_mesh_ms);
+  ImGui::Text("MemoHits: %d; MemoMisses: %d",
+              int(comp->derive_memo.num_hits), int(comp->derive_memo.num_misses));
   ImGui::End();
 }
 
@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <cassert>
 #include <functional>
+#include <algorithm>
 
 #define GROVE_USE_OLD_INSERT_METHOD (0)
 
@@ -66,11 +67,30 @@ public:
   size_t clear_if(F&& func);
 
   const Data* find(const Vec& point);
-  void map_over_sphere(const MapFunction& map_func, const Vec& c, Float r);
+
+  //  Call `func(Node*)` for each leaf node whose span intersects the sphere.
+  template <typename F>
+  void map_over_sphere(F&& func, const Vec& c, Float r);
+
+  //  Call `func(int sphere_index, Node*)` for each leaf node whose span intersects sphere
+  //  `sphere_index`. The tree is traversed once for all spheres; spheres that are close together,
+  //  like the buds of one tree, share most of the traversal.
+  template <typename F>
+  void map_over_spheres(const Vec* centers, const Float* radii, int num_spheres, F&& func);
+
   void collect_within_sphere(std::vector<Node*>& out, const Vec& c, Float r) {
     map_over_sphere([&out](auto* node) { out.push_back(node); }, c, r);
   }
 
+  //  Reorder the nodes such that the children of each node are contiguous, with sibling groups in
+  //  depth-first Morton order, and build the compact span and child arrays used by queries. The
+  //  octree remains packed until a node is added. Node pointers and indices are invalidated.
+  void pack();
+  bool is_packed() const {
+    //  Nodes are never removed, and the structure only changes when a node is added.
+    return !nodes.empty() && packed_spans.size() == nodes.size();
+  }
+
   ArrayView<const Node> read_nodes() const {
     return make_data_array_view<const Node>(nodes);
   }
@@ -127,10 +147,47 @@ private:
     return node;
   }
 
+  template <bool Packed>
+  const Span& node_span(NodeIndex ind) const {
+    if constexpr (Packed) {
+      return packed_spans[ind];
+    } else {
+      return nodes[ind].span;
+    }
+  }
+
+  template <bool Packed>
+  int node_num_children(NodeIndex ind) const {
+    if constexpr (Packed) {
+      return packed_num_children[ind];
+    } else {
+      return nodes[ind].num_children;
+    }
+  }
+
+  template <bool Packed>
+  NodeIndex node_child(NodeIndex ind, int i) const {
+    if constexpr (Packed) {
+      return packed_first_child[ind] + NodeIndex(i);
+    } else {
+      return nodes[ind].children[i];
+    }
+  }
+
+  template <bool Packed, typename F>
+  void map_over_sphere_impl(F& func, const Vec& c, Float r);
+  template <bool Packed, typename F>
+  void map_over_spheres_impl(const Vec* centers, const Float* radii, int num_spheres, F& func);
+
 private:
   std::vector<NodeIndex> roots;
   std::vector<Node> nodes;
 
+  //  Structure of the packed octree, indexed like `nodes`.
+  std::vector<Span> packed_spans;
+  std::vector<NodeIndex> packed_first_child;
+  std::vector<uint8_t> packed_num_children;
+
   Float initial_span_size{Float(8.0)};
   Float max_span_size_split{Float(0.5)};
 };
@@ -179,6 +236,29 @@ inline bool span_span_intersect(const Span& a, const Span& b) {
   return true;
 }
 
+template <typename Span>
+inline uint8_t child_octant(const Span& parent, const Span& child) {
+  const auto quarter = parent.size * 0.25f;
+  const auto mid = parent.begin + quarter;
+  return uint8_t(uint8_t(child.begin.x > mid.x) |
+                 (uint8_t(child.begin.y > mid.y) << 1u) |
+                 (uint8_t(child.begin.z > mid.z) << 2u));
+}
+
+inline uint64_t morton_spread3(uint64_t v) {
+  v &= 0x1fffffu;
+  v = (v | (v << 32u)) & 0x1f00000000ffffull;
+  v = (v | (v << 16u)) & 0x1f0000ff0000ffull;
+  v = (v | (v << 8u)) & 0x100f00f00f00f00full;
+  v = (v | (v << 4u)) & 0x10c30c30c30c30c3ull;
+  v = (v | (v << 2u)) & 0x1249249249249249ull;
+  return v;
+}
+
+inline uint64_t morton_encode3(uint32_t x, uint32_t y, uint32_t z) {
+  return morton_spread3(x) | (morton_spread3(y) << 1u) | (morton_spread3(z) << 2u);
+}
+
 template <typename Vec>
 inline Vec make_ith_child_span_begin(uint8_t i, const Vec* begs) {
   const uint8_t i0 = i & uint8_t(1);
@@ -467,36 +547,37 @@ const Data* PointOctree<Data, Traits>::find(const Vec& point) {
 }
 
 template <typename Data, typename Traits>
-void PointOctree<Data, Traits>::map_over_sphere(const MapFunction& func, const Vec& c, Float r) {
+template <typename F>
+void PointOctree<Data, Traits>::map_over_sphere(F&& func, const Vec& c, Float r) {
+  if (is_packed()) {
+    map_over_sphere_impl<true>(func, c, r);
+  } else {
+    map_over_sphere_impl<false>(func, c, r);
+  }
+}
+
+template <typename Data, typename Traits>
+template <bool Packed, typename F>
+void PointOctree<Data, Traits>::map_over_sphere_impl(F& func, const Vec& c, Float r) {
   DynamicArray<NodeIndex, 32> rest_stack;
-  for (auto& root_ind : roots) {
-    auto& root = nodes[root_ind];
-    if (detail::span_sphere_intersect(root.span, c, r)) {
-      if (root.num_children == 0) {
-        //  Leaf
-        func(&root);
-      } else {
-        for (int i = 0; i < root.num_children; i++) {
-          auto child_ind = root.children[i];
-          if (detail::span_sphere_intersect(nodes[child_ind].span, c, r)) {
-            rest_stack.push_back(child_ind);
-          }
-        }
-      }
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    if (detail::span_sphere_intersect(node_span<Packed>(*it), c, r)) {
+      rest_stack.push_back(*it);
     }
   }
 
   while (!rest_stack.empty()) {
     auto rest_ind = rest_stack.back();
     rest_stack.pop_back();
-    auto& node = nodes[rest_ind];
-    if (node.num_children == 0) {
+    const int num_children = node_num_children<Packed>(rest_ind);
+    if (num_children == 0) {
       //  Leaf
-      func(&node);
+      func(&nodes[rest_ind]);
     } else {
-      for (int i = 0; i < node.num_children; i++) {
-        auto child_ind = node.children[i];
-        if (detail::span_sphere_intersect(nodes[child_ind].span, c, r)) {
+      //  Push in reverse, such that children are visited in order.
+      for (int i = num_children - 1; i >= 0; i--) {
+        auto child_ind = node_child<Packed>(rest_ind, i);
+        if (detail::span_sphere_intersect(node_span<Packed>(child_ind), c, r)) {
           rest_stack.push_back(child_ind);
         }
       }
@@ -504,6 +585,147 @@ void PointOctree<Data, Traits>::map_over_sphere(const MapFunction& func, const V
   }
 }
 
+template <typename Data, typename Traits>
+template <typename F>
+void PointOctree<Data, Traits>::map_over_spheres(const Vec* centers, const Float* radii,
+                                                 int num_spheres, F&& func) {
+  if (is_packed()) {
+    map_over_spheres_impl<true>(centers, radii, num_spheres, func);
+  } else {
+    map_over_spheres_impl<false>(centers, radii, num_spheres, func);
+  }
+}
+
+template <typename Data, typename Traits>
+template <bool Packed, typename F>
+void PointOctree<Data, Traits>::map_over_spheres_impl(const Vec* centers, const Float* radii,
+                                                      int num_spheres, F& func) {
+  //  Each pending node refers to the spheres that intersect it, stored in `sphere_lists`. Lists
+  //  are only ever appended above those of pending nodes, so the top node's list is intact when it
+  //  is popped, and everything past it belongs to finished subtrees. Leaves are visited as soon as
+  //  their list is known, rather than pushed.
+  struct Pending {
+    NodeIndex node;
+    uint32_t list_begin;
+    uint32_t list_size;
+  };
+
+  constexpr uint32_t all_spheres = ~0u;
+  DynamicArray<Pending, 32> pending;
+  std::vector<uint32_t> sphere_lists(std::max(num_spheres, 1) * 4);
+  uint32_t lists_size{};
+
+  auto push_intersecting = [&](NodeIndex node, uint32_t candidates_begin, uint32_t num_candidates) {
+    if (lists_size + num_candidates > sphere_lists.size()) {
+      sphere_lists.resize(2 * (lists_size + num_candidates));
+    }
+
+    const auto& span = node_span<Packed>(node);
+    uint32_t* list = sphere_lists.data() + lists_size;
+    uint32_t list_size{};
+    for (uint32_t i = 0; i < num_candidates; i++) {
+      const uint32_t si = candidates_begin == all_spheres ? i : sphere_lists[candidates_begin + i];
+      list[list_size] = si;
+      list_size += detail::span_sphere_intersect(span, centers[si], radii[si]) ? 1 : 0;
+    }
+
+    if (list_size == 0) {
+      return;
+    } else if (node_num_children<Packed>(node) == 0) {
+      //  Leaf
+      for (uint32_t i = 0; i < list_size; i++) {
+        func(int(list[i]), &nodes[node]);
+      }
+    } else {
+      pending.push_back(Pending{node, lists_size, list_size});
+      lists_size += list_size;
+    }
+  };
+
+  for (auto& root_ind : roots) {
+    push_intersecting(root_ind, all_spheres, uint32_t(num_spheres));
+  }
+
+  while (!pending.empty()) {
+    const Pending curr = pending.back();
+    pending.pop_back();
+    lists_size = curr.list_begin + curr.list_size;
+
+    const int num_children = node_num_children<Packed>(curr.node);
+    for (int i = 0; i < num_children; i++) {
+      push_intersecting(node_child<Packed>(curr.node, i), curr.list_begin, curr.list_size);
+    }
+  }
+}
+
+template <typename Data, typename Traits>
+void PointOctree<Data, Traits>::pack() {
+  const auto num_nodes = NodeIndex(nodes.size());
+  std::vector<Node> packed;
+  packed.reserve(num_nodes);
+
+  //  Roots lie on a grid with cells of size `initial_span_size`.
+  std::vector<NodeIndex> sorted_roots = roots;
+  if (!sorted_roots.empty()) {
+    Vec min_begin = nodes[sorted_roots[0]].span.begin;
+    for (auto ind : sorted_roots) {
+      min_begin = min(min_begin, nodes[ind].span.begin);
+    }
+    auto root_code = [&](NodeIndex ind) {
+      auto cell = (nodes[ind].span.begin - min_begin) / initial_span_size + Float(0.5);
+      return detail::morton_encode3(uint32_t(cell.x), uint32_t(cell.y), uint32_t(cell.z));
+    };
+    std::sort(sorted_roots.begin(), sorted_roots.end(), [&](NodeIndex a, NodeIndex b) {
+      return root_code(a) < root_code(b);
+    });
+  }
+
+  roots.clear();
+  DynamicArray<NodeIndex, 32> pending;
+  for (auto ind : sorted_roots) {
+    roots.push_back(NodeIndex(packed.size()));
+    packed.push_back(std::move(nodes[ind]));
+  }
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    pending.push_back(*it);
+  }
+
+  //  `pending` nodes have been moved to `packed`, but their children still refer to `nodes`.
+  while (!pending.empty()) {
+    const NodeIndex ind = pending.back();
+    pending.pop_back();
+
+    const int num_children = packed[ind].num_children;
+    auto children = packed[ind].children;
+    const Span span = packed[ind].span;
+    std::sort(children.begin(), children.begin() + num_children, [&](NodeIndex a, NodeIndex b) {
+      return detail::child_octant(span, nodes[a].span) < detail::child_octant(span, nodes[b].span);
+    });
+
+    const auto first_child = NodeIndex(packed.size());
+    for (int i = 0; i < num_children; i++) {
+      packed[ind].children[i] = first_child + NodeIndex(i);
+      packed.push_back(std::move(nodes[children[i]]));
+    }
+    for (int i = num_children - 1; i >= 0; i--) {
+      pending.push_back(first_child + NodeIndex(i));
+    }
+  }
+
+  assert(packed.size() == num_nodes);
+  nodes = std::move(packed);
+
+  packed_spans.resize(num_nodes);
+  packed_first_child.resize(num_nodes);
+  packed_num_children.resize(num_nodes);
+  for (NodeIndex i = 0; i < num_nodes; i++) {
+    auto& node = nodes[i];
+    packed_spans[i] = node.span;
+    packed_first_child[i] = node.num_children > 0 ? node.children[0] : 0;
+    packed_num_children[i] = node.num_children;
+  }
+}
+
 template <typename Data, typename Traits>
 void PointOctree<Data, Traits>::validate() const {
   std::vector<bool> visited(nodes.size());
@@ -4,6 +4,7 @@
 #include "bud_fate.hpp"
 #include "utility.hpp"
 #include "serialize.hpp"
+#include "snapshot.hpp"
 #include "../terrain/terrain.hpp"
 #include "../wind/SpatiallyVaryingWind.hpp"
 #include "../audio_observation/AudioObservation.hpp"
@@ -1373,6 +1374,13 @@ void handle_serialization(ProceduralTreeComponent& component, const UpdateInfo&
       }
     }
   }
+  if (component.save_snapshot_to_file_path) {
+    if (!tree::save_snapshot(
+      info.tree_system, component.save_snapshot_to_file_path.value().c_str())) {
+      GROVE_LOG_ERROR_CAPTURE_META("Failed to save snapshot.", logging_id());
+    }
+    component.save_snapshot_to_file_path = NullOpt{};
+  }
 }
 
 } //  anon
@@ -1762,6 +1770,24 @@ void ProceduralTreeComponent::on_gui_update(const ProceduralTreeGUI::GUIUpdateRe
       pending_new_trees.push_back(std::move(pend));
     }
   }
+  if (res.save_snapshot_to_file_path) {
+    save_snapshot_to_file_path = res.save_snapshot_to_file_path.value();
+  }
+  if (res.load_snapshot_from_file_path) {
+    auto* snapshot = tree::open_snapshot(res.load_snapshot_from_file_path.value().c_str());
+    if (snapshot) {
+      for (auto& entry : tree::read_entries(snapshot)) {
+        if (entry.kind == tree::SnapshotRecordKind::Tree) {
+          PendingNewTree pend{};
+          pend.deserialized = std::make_unique<tree::TreeNodeStore>(
+            tree::to_tree_node_store(entry));
+          pend.deserialized->translate(deserialized_tree_translation);
+          pending_new_trees.push_back(std::move(pend));
+        }
+      }
+      tree::close_snapshot(&snapshot);
+    }
+  }
   if (res.prune_selected_axis_index) {
     prune_selected_axis_index = res.prune_selected_axis_index.value();
   }
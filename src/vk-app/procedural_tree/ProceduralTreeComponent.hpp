@@ -302,6 +302,7 @@ public:
   bool need_reset_tform_position{};
   Optional<AudioNodeStorage::NodeID> isolated_audio_node;
   Optional<std::string> serialize_selected_to_file_path;
+  Optional<std::string> save_snapshot_to_file_path;
   Optional<int> prune_selected_axis_index;
 };
 
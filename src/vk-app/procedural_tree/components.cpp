@@ -4,6 +4,7 @@
 #include "grove/math/random.hpp"
 #include "grove/math/matrix_transform.hpp"
 #include "grove/math/constants.hpp"
+#include <atomic>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -11,9 +12,10 @@ namespace {
 
 using namespace tree;
 
-uint32_t next_tree_bud_id_value{1};
-uint32_t next_tree_internode_id_value{1};
-uint32_t next_tree_id_value{1};
+//  Buds and internodes of different trees may be spawned concurrently.
+std::atomic<uint32_t> next_tree_bud_id_value{1};
+std::atomic<uint32_t> next_tree_internode_id_value{1};
+std::atomic<uint32_t> next_tree_id_value{1};
 
 tree::Bud make_bud(tree::TreeNodeIndex parent, const Vec3f& p, const Vec3f& d,
                    float pa, float pd, float ozr, bool is_terminal) {
@@ -253,7 +253,7 @@ void tree::debug::update_fit_node_aabbs(const NodeRenderingUpdateInfo& info) {
       if (globals.use_fit2) {
         Temporary<Mat3f, 2048> store_node_frames;
         Mat3f* node_frames = store_node_frames.require(num_nodes);
-        compute_internode_frames(node_beg, num_nodes, node_frames);
+        compute_internode_frames(node_beg, num_nodes, node_frames, info.task_pool);
 
         num_gen = bounds::fit_aabbs_around_axes_radius_threshold_method(
           node_beg, node_frames, num_nodes,
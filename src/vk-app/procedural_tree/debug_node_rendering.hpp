@@ -3,6 +3,7 @@
 namespace grove {
 class ProceduralTreeComponent;
 class Camera;
+class TaskPool;
 
 namespace tree {
 struct TreeSystem;
@@ -18,6 +19,7 @@ struct NodeRenderingUpdateInfo {
   const tree::TreeSystem* tree_sys;
   const tree::RootsSystem* roots_sys;
   const Camera& camera;
+  TaskPool* task_pool;
 };
 
 void update_fit_node_aabbs(const NodeRenderingUpdateInfo& info);
@@ -6,23 +6,87 @@ GROVE_NAMESPACE_BEGIN
 
 namespace {
 
+using namespace tree;
+
 inline bool in_sphere(const Vec3f& sc, float r, const Vec3f& p) {
   auto to_point = p - sc;
   return to_point.length_squared() <= r * r;
 }
 
+bool within_occupancy_zone(const Bud& bud, const AttractionPoint& point) {
+  return point.is_active() && in_sphere(bud.position, bud.occupancy_zone_radius, point.position);
+}
+
+void consume_point(TreeID id, AttractionPoint& point) {
+  if (!point.is_consumed()) {
+    point.set_id(id.id);
+    point.set_consumed(true);
+  }
+}
+
+//  Distance from `bud` to `point` if the point is within the bud's perception volume.
+bool sensed(const Bud& bud, const AttractionPoint& point, float* distance) {
+  if (!point.is_active() || point.is_consumed()) {
+    return false;
+  }
+
+  auto to_point = point.position - bud.position;
+  auto to_point_d = to_point.length();
+
+  if (to_point_d > 0.0f && to_point_d <= bud.perception_distance) {
+    //  Within perception distance.
+    auto to_point_v = to_point / to_point_d;
+    auto v_sim = dot(to_point_v, bud.direction);
+    auto a_sim = std::acos(std::abs(v_sim));
+    if (a_sim < bud.perception_angle * 0.5f) {
+      //  Within perception volume.
+      *distance = to_point_d;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void merge_sensed_point(const Bud& bud, const AttractionPoints::Node* node, float to_point_d,
+                        SenseContext& context) {
+  auto existing_it = context.closest_points_to_buds.find(node);
+  if (existing_it == context.closest_points_to_buds.end()) {
+    context.closest_points_to_buds[node] = bud;
+  } else {
+    //  Check whether this bud is closer to the attraction point than the existing bud.
+    auto& existing_bud = existing_it->second;
+    auto existing_dist = (node->data.position - existing_bud.position).length();
+    if (to_point_d < existing_dist) {
+      //  This bud is closer to the point.
+      context.closest_points_to_buds[node] = bud;
+    }
+  }
+}
+
 } //  anon
 
 void tree::consume_within_occupancy_zone(TreeID id, const Bud& bud, AttractionPoints& points) {
-  auto radius = bud.occupancy_zone_radius;
-  points.map_over_sphere([&bud, radius, id](auto* node) {
-    if (node->data.is_active() && in_sphere(bud.position, radius, node->data.position)) {
-      if (!node->data.is_consumed()) {
-        node->data.set_id(id.id);
-        node->data.set_consumed(true);
-      }
+  points.map_over_sphere([&bud, id](auto* node) {
+    if (within_occupancy_zone(bud, node->data)) {
+      consume_point(id, node->data);
+    }
+  }, bud.position, bud.occupancy_zone_radius);
+}
+
+void tree::gather_within_occupancy_zone(const Bud& bud, AttractionPoints& points,
+                                        std::vector<AttractionPoints::Node*>& out) {
+  points.map_over_sphere([&bud, &out](auto* node) {
+    if (within_occupancy_zone(bud, node->data)) {
+      out.push_back(node);
     }
-  }, bud.position, radius);
+  }, bud.position, bud.occupancy_zone_radius);
+}
+
+void tree::consume_gathered(TreeID id, AttractionPoints::Node* const* nodes, int num_nodes) {
+  for (int i = 0; i < num_nodes; i++) {
+    consume_point(id, nodes[i]->data);
+  }
 }
 
 tree::EnvironmentInputs tree::compute_environment_input(const ClosestPointsToBuds& closest) {
@@ -58,36 +122,28 @@ tree::EnvironmentInputs tree::compute_environment_input(const ClosestPointsToBud
 
 void tree::sense_bud(const Bud& bud, AttractionPoints& points, SenseContext& context) {
   points.map_over_sphere([&](auto* node) {
-    auto& nd = node->data;
-    if (!nd.is_active() || nd.is_consumed()) {
-      return;
+    float to_point_d;
+    if (sensed(bud, node->data, &to_point_d)) {
+      merge_sensed_point(bud, node, to_point_d, context);
     }
+  }, bud.position, bud.perception_distance);
+}
 
-    auto to_point = nd.position - bud.position;
-    auto to_point_d = to_point.length();
-
-    if (to_point_d > 0.0f && to_point_d <= bud.perception_distance) {
-      //  Within perception distance.
-      auto to_point_v = to_point / to_point_d;
-      auto v_sim = dot(to_point_v, bud.direction);
-      auto a_sim = std::acos(std::abs(v_sim));
-      if (a_sim < bud.perception_angle * 0.5f) {
-        //  Within perception volume.
-        auto existing_it = context.closest_points_to_buds.find(node);
-        if (existing_it == context.closest_points_to_buds.end()) {
-          context.closest_points_to_buds[node] = bud;
-        } else {
-          //  Check whether this bud is closer to the attraction point than the existing bud.
-          auto& existing_bud = existing_it->second;
-          auto existing_dist = (nd.position - existing_bud.position).length();
-          if (to_point_d < existing_dist) {
-            //  This bud is closer to the point.
-            context.closest_points_to_buds[node] = bud;
-          }
-        }
-      }
+void tree::gather_sensed_points(const Bud& bud, AttractionPoints& points,
+                                std::vector<SensedPoint>& out) {
+  points.map_over_sphere([&](auto* node) {
+    float to_point_d;
+    if (sensed(bud, node->data, &to_point_d)) {
+      out.push_back(SensedPoint{node, to_point_d});
     }
   }, bud.position, bud.perception_distance);
 }
 
+void tree::merge_sensed_points(const Bud& bud, const SensedPoint* points, int num_points,
+                               SenseContext& context) {
+  for (int i = 0; i < num_points; i++) {
+    merge_sensed_point(bud, points[i].node, points[i].distance, context);
+  }
+}
+
 GROVE_NAMESPACE_END
@@ -4,8 +4,28 @@
 
 namespace grove::tree {
 
+struct SensedPoint {
+  const AttractionPoints::Node* node;
+  float distance;
+};
+
 void consume_within_occupancy_zone(TreeID parent_id, const Bud& bud, AttractionPoints& points);
 void sense_bud(const Bud& bud, AttractionPoints& points, SenseContext& context);
 EnvironmentInputs compute_environment_input(const ClosestPointsToBuds& closest);
 
+/*
+ * Two-phase variants of `consume_within_occupancy_zone` and `sense_bud`. The gather functions
+ * only read `points`, so they can run concurrently for different buds. Applying the gathered
+ * results bud by bud, in the order in which the one-phase functions would have been called,
+ * yields identical results.
+ */
+
+void gather_within_occupancy_zone(const Bud& bud, AttractionPoints& points,
+                                  std::vector<AttractionPoints::Node*>& out);
+void consume_gathered(TreeID parent_id, AttractionPoints::Node* const* nodes, int num_nodes);
+
+void gather_sensed_points(const Bud& bud, AttractionPoints& points, std::vector<SensedPoint>& out);
+void merge_sensed_points(const Bud& bud, const SensedPoint* points, int num_points,
+                         SenseContext& context);
+
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "render.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/Stopwatch.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <algorithm>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -38,59 +40,143 @@ void initialize_growth_cycle(GrowthContext* context) {
   context->sense_context->clear();
 }
 
-void consume(GrowthContext* context) {
-  for (auto& tree : context->trees) {
-    if (!tree.finished_growing) {
-      const tree::TreeID id = tree.nodes->id;
-      for (auto& bud : tree.nodes->buds) {
-        consume_within_occupancy_zone(id, bud, *context->attraction_points);
-      }
+constexpr int buds_per_batch = 64;
+
+/*
+ * Buds are gathered into fixed-size batches, independent of the number of threads. Each batch
+ * collects the attraction points consumed or sensed by its buds in parallel, and the results are
+ * then applied serially in bud order, so that the outcome is identical to a serial traversal.
+ */
+
+struct BudBatch {
+  void clear() {
+    consumed.clear();
+    consumed_ends.clear();
+    sensed.clear();
+    sensed_ends.clear();
+  }
+
+  std::vector<AttractionPoints::Node*> consumed;
+  std::vector<int> consumed_ends;
+  std::vector<SensedPoint> sensed;
+  std::vector<int> sensed_ends;
+};
+
+struct GrowthScratch {
+  std::vector<GrowableTree*> growing_trees;
+  std::vector<const Bud*> buds;
+  std::vector<TreeID> bud_tree_ids;
+  std::vector<BudBatch> batches;
+};
+
+template <typename F>
+void parallel_for(GrowthContext* context, int num_tasks, F&& f) {
+  if (context->task_pool) {
+    context->task_pool->parallel_for(num_tasks, std::forward<F>(f));
+  } else {
+    for (int i = 0; i < num_tasks; i++) {
+      f(i, 0);
     }
   }
 }
 
-void sense(GrowthContext* context) {
+int num_batches(const GrowthScratch& scratch) {
+  return int(scratch.batches.size());
+}
+
+int batch_begin(int batch) {
+  return batch * buds_per_batch;
+}
+
+int batch_end(const GrowthScratch& scratch, int batch) {
+  return std::min(int(scratch.buds.size()), (batch + 1) * buds_per_batch);
+}
+
+void gather_buds(GrowthContext* context, GrowthScratch& scratch) {
+  scratch.growing_trees.clear();
+  scratch.buds.clear();
+  scratch.bud_tree_ids.clear();
+
   for (auto& tree : context->trees) {
     if (!tree.finished_growing) {
+      scratch.growing_trees.push_back(&tree);
       for (auto& bud : tree.nodes->buds) {
-        sense_bud(bud, *context->attraction_points, *context->sense_context);
+        scratch.buds.push_back(&bud);
+        scratch.bud_tree_ids.push_back(tree.nodes->id);
       }
     }
   }
-  *context->environment_input = compute_environment_input(
-    context->sense_context->closest_points_to_buds);
-}
 
-void apply_environment_input(GrowthContext* context) {
-  for (auto& tree : context->trees) {
-    if (!tree.finished_growing) {
-      apply_environment_input(*tree.nodes, *context->environment_input, *tree.bud_q_params);
-    }
+  const int num_buds = int(scratch.buds.size());
+  scratch.batches.resize((num_buds + buds_per_batch - 1) / buds_per_batch);
+  for (auto& batch : scratch.batches) {
+    batch.clear();
   }
 }
 
-void compute_bud_fate(GrowthContext* context) {
-  for (auto& tree : context->trees) {
-    if (!tree.finished_growing) {
-      bud_fate(*tree.nodes, *context->environment_input, *tree.spawn_params);
+void consume(GrowthContext* context, GrowthScratch& scratch) {
+  parallel_for(context, num_batches(scratch), [context, &scratch](int b, int) {
+    auto& batch = scratch.batches[b];
+    for (int i = batch_begin(b); i < batch_end(scratch, b); i++) {
+      gather_within_occupancy_zone(*scratch.buds[i], *context->attraction_points, batch.consumed);
+      batch.consumed_ends.push_back(int(batch.consumed.size()));
+    }
+  });
+
+  //  The first bud to reach a point consumes it.
+  for (int b = 0; b < num_batches(scratch); b++) {
+    auto& batch = scratch.batches[b];
+    int beg{};
+    for (int i = batch_begin(b); i < batch_end(scratch, b); i++) {
+      const int end = batch.consumed_ends[i - batch_begin(b)];
+      consume_gathered(scratch.bud_tree_ids[i], batch.consumed.data() + beg, end - beg);
+      beg = end;
     }
   }
 }
 
-void set_render_positions(GrowthContext* context) {
-  for (auto& tree : context->trees) {
-    if (!tree.finished_growing) {
-      set_render_position(tree.nodes->internodes, 0);
+void sense(GrowthContext* context, GrowthScratch& scratch) {
+  parallel_for(context, num_batches(scratch), [context, &scratch](int b, int) {
+    auto& batch = scratch.batches[b];
+    for (int i = batch_begin(b); i < batch_end(scratch, b); i++) {
+      gather_sensed_points(*scratch.buds[i], *context->attraction_points, batch.sensed);
+      batch.sensed_ends.push_back(int(batch.sensed.size()));
+    }
+  });
+
+  //  Merging in bud order also preserves the insertion order of `closest_points_to_buds`, and thus
+  //  the order in which directions are summed below.
+  auto& sense_context = *context->sense_context;
+  for (int b = 0; b < num_batches(scratch); b++) {
+    auto& batch = scratch.batches[b];
+    int beg{};
+    for (int i = batch_begin(b); i < batch_end(scratch, b); i++) {
+      const int end = batch.sensed_ends[i - batch_begin(b)];
+      merge_sensed_points(*scratch.buds[i], batch.sensed.data() + beg, end - beg, sense_context);
+      beg = end;
     }
   }
+
+  *context->environment_input = compute_environment_input(
+    context->sense_context->closest_points_to_buds);
+}
+
+void spawn(GrowthContext* context, GrowthScratch& scratch) {
+  //  Trees share only the (read-only) environment input, so they can be grown independently.
+  const int num_trees = int(scratch.growing_trees.size());
+  parallel_for(context, num_trees, [context, &scratch](int i, int) {
+    auto& tree = *scratch.growing_trees[i];
+    apply_environment_input(*tree.nodes, *context->environment_input, *tree.bud_q_params);
+    bud_fate(*tree.nodes, *context->environment_input, *tree.spawn_params);
+    set_render_position(tree.nodes->internodes, 0);
+  });
 }
 
-int growth_cycle(GrowthContext* context) {
-  consume(context);
-  sense(context);
-  apply_environment_input(context);
-  compute_bud_fate(context);
-  set_render_positions(context);
+int growth_cycle(GrowthContext* context, GrowthScratch& scratch) {
+  gather_buds(context, scratch);
+  consume(context, scratch);
+  sense(context, scratch);
+  spawn(context, scratch);
   const int num_still_growing = check_trees_finished_growing(context);
   return num_still_growing;
 }
@@ -111,6 +197,8 @@ void insert_attraction_points(GrowthContext* context) {
 
 void start_growing(GrowthContext* context) {
   insert_attraction_points(context);
+  //  No points are added while growing, so sense queries can use the packed layout throughout.
+  context->attraction_points->pack();
 }
 
 } //  anon
@@ -132,11 +220,12 @@ GrowableTree tree::make_growable_tree(TreeNodeStore* nodes,
 
 GrowthResult tree::grow(GrowthContext* context) {
   Stopwatch stopwatch;
+  GrowthScratch scratch;
 
   start_growing(context);
   while (true) {
     initialize_growth_cycle(context);
-    if (int num_growing = growth_cycle(context); num_growing == 0) {
+    if (int num_growing = growth_cycle(context, scratch); num_growing == 0) {
       break;
     }
   }
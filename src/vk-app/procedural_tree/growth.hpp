@@ -2,6 +2,10 @@
 
 #include "components.hpp"
 
+namespace grove {
+class TaskPool;
+}
+
 namespace grove::tree {
 
 //  Write at most `max_num_points` to `dst`, return num actually written.
@@ -23,6 +27,9 @@ struct GrowthContext {
   EnvironmentInputs* environment_input;
   AttractionPoints* attraction_points;
   SenseContext* sense_context;
+  //  Optional. If provided, buds are sensed and trees are spawned in parallel. The result does
+  //  not depend on the number of threads.
+  TaskPool* task_pool{};
 };
 
 struct GrowthResult {
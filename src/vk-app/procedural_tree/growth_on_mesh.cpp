@@ -104,6 +104,13 @@ tree::project_internodes_onto_mesh(const uint32_t* tris, uint32_t num_tris,
   };
 
   assert(tri::is_ccw_or_zero(tris, num_tris, ps));
+  //  Share one adjacency structure across every projected ray.
+  ProjectRayEdgeIndices tmp_edge_indices;
+  if (!edge_indices) {
+    tmp_edge_indices = tri::build_half_edges(tris, num_tris);
+    edge_indices = &tmp_edge_indices;
+  }
+
   const auto* inode_data = internodes.data();
   tree::Internodes result_inodes;
   std::vector<NodeStackEntry> node_stack;
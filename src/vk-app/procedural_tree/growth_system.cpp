@@ -128,7 +128,7 @@ make_system_growth_context(uint32_t id, const CreateGrowthContextParams& params)
   return result;
 }
 
-tree::GrowthContext to_tree_growth_context(GrowthSystem::GrowthContext* ctx) {
+tree::GrowthContext to_tree_growth_context(GrowthSystem::GrowthContext* ctx, TaskPool* pool) {
   tree::GrowthContext result{};
   result.trees = make_data_array_view<GrowableTree>(ctx->growable_trees);
   result.attraction_points_buffer = ArrayView<Vec3f>{
@@ -137,6 +137,7 @@ tree::GrowthContext to_tree_growth_context(GrowthSystem::GrowthContext* ctx) {
   result.environment_input = &ctx->environment_input;
   result.attraction_points = &ctx->attraction_points;
   result.sense_context = &ctx->sense_context;
+  result.task_pool = pool;
   return result;
 }
 
@@ -178,8 +179,9 @@ void start_growing(GrowthSystem* sys, GrowthSystem::GrowthContext* context) {
     }
   }
 
-  context->async_future = std::async(std::launch::async, [context]() {
-    auto tree_context = to_tree_growth_context(context);
+  auto* pool = sys->task_pool;
+  context->async_future = std::async(std::launch::async, [context, pool]() {
+    auto tree_context = to_tree_growth_context(context, pool);
     context->growth_result = tree::grow(&tree_context);
     context->async_finished.store(true);
   });
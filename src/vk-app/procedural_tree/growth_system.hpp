@@ -89,6 +89,8 @@ public:
   };
 
 public:
+  //  Optional, and owned by the caller. Growth is parallelized across buds and trees if set.
+  TaskPool* task_pool{};
   std::vector<std::unique_ptr<Instance>> instances;
   std::vector<std::unique_ptr<GrowthContext>> growth_contexts;
   uint32_t next_growth_context_id{1};
@@ -2,14 +2,21 @@
 #include "render.hpp"
 #include "vk-app/procedural_flower/geometry.hpp"
 #include "grove/common/common.hpp"
+#include "grove/common/FrameArena.hpp"
+#include "grove/common/TaskPool.hpp"
 #include "grove/math/constants.hpp"
 #include "grove/math/frame.hpp"
+#include "grove/math/simd.hpp"
 #include "grove/math/util.hpp"
 
 GROVE_NAMESPACE_BEGIN
 
 namespace {
 
+struct Config {
+  static constexpr uint32_t internodes_per_task = 256;
+};
+
 struct TransformData {
   Vec3f instance_position;
   Vec3f child_instance_position;
@@ -19,12 +26,6 @@ struct TransformData {
   float child_radius;
 };
 
-struct Vertex {
-  Vec3f position;
-  Vec3f normal;
-  Vec2f uv;
-};
-
 Vec3f shape_function(const Vec2f& p, const Vec2f& num_points_xz) {
   float x_dim = std::floor(num_points_xz.x * 0.5f);
   float x_ind = p.x == x_dim ? 0.0f : p.x + x_dim;
@@ -33,67 +34,172 @@ Vec3f shape_function(const Vec2f& p, const Vec2f& num_points_xz) {
   return Vec3f{std::cos(theta), y, std::sin(theta)};
 }
 
-Vec3f instance_scale(float radius) {
-  return Vec3f{radius, 1.0f, radius};
-}
-
 Vec3f mat3_mul_vec3(const Vec3f& i, const Vec3f& j, const Vec3f& k, const Vec3f& v) {
   return i * v.x + j * v.y + k * v.z;
 }
 
-Vertex transform(const Vec2f& p, const Vec2f& num_points_xz, const TransformData& data,
-                 const Vec3f& offset) {
-  Vec3f s = shape_function(p, num_points_xz);
-  const float y = s.y;
-  Vec3f s0 = Vec3f{s.x, 0.0, s.z};
-  Vec3f s_base = s0 * instance_scale(data.radius);
-  Vec3f s_tip = s0 * instance_scale(data.child_radius);
+TransformData make_transform_data(const tree::Internode& node,
+                                  const tree::ChildRenderData& child,
+                                  float scale) {
+  TransformData result{};
+  result.instance_position = node.render_position;
+  result.child_instance_position = child.position;
+  result.direction = node.spherical_direction();
+  result.child_direction = child.direction;
+  result.radius = node.diameter * 0.5f * scale;
+  result.child_radius = child.radius * scale;
+  return result;
+}
+
+/*
+ * Ring table
+ *
+ * The shape function depends only on the grid, so it is evaluated once per mesh rather than per
+ * vertex of every node. Arrays are padded to a multiple of the simd width with copies of the
+ * last vertex.
+ */
+
+struct RingTable {
+  float* s_x;
+  float* s_z;
+  float* n_x;
+  float* n_z;
+  float* y;
+  uint32_t num_vertices;
+};
 
+struct NodeTransform {
   Vec3f is;
   Vec3f js;
   Vec3f ks;
-  make_coordinate_system_y(spherical_to_cartesian(data.direction), &is, &js, &ks);
-
   Vec3f ic;
   Vec3f jc;
   Vec3f kc;
-  make_coordinate_system_y(spherical_to_cartesian(data.child_direction), &ic, &jc, &kc);
+  Vec3f instance_position;
+  Vec3f child_instance_position;
+  float radius;
+  float child_radius;
+};
 
-  Vec3f s0n = normalize(s0);
-  Vec3f n_base = normalize(mat3_mul_vec3(is, js, ks, s0n));
-  Vec3f n_tip = normalize(mat3_mul_vec3(ic, jc, kc, s0n));
-  Vec3f n = lerp(y, n_base, n_tip);
+struct F4x3 {
+  simd::F4 x;
+  simd::F4 y;
+  simd::F4 z;
+};
 
-  if (n.length() == 0.0f) {
-    n = ConstVec3f::positive_y;
-  }
+uint32_t round_up_to_simd_width(uint32_t n) {
+  return (n + 3u) & ~3u;
+}
 
-  Vec3f p_base = mat3_mul_vec3(is, js, ks, s_base) + data.instance_position;
-  Vec3f p_tip = mat3_mul_vec3(ic, jc, kc, s_tip) + data.child_instance_position;
-  Vec3f tp = lerp(y, p_base, p_tip) + offset;
+void fill_ring_table(const RingTable& ring, const float* grid, const Vec2f& num_points_xz,
+                     uint32_t num_padded) {
+  for (uint32_t i = 0; i < num_padded; i++) {
+    const uint32_t src = std::min(i, ring.num_vertices - 1);
+    Vec3f s = shape_function(Vec2f{grid[src * 2], grid[src * 2 + 1]}, num_points_xz);
+    Vec3f s0n = normalize(Vec3f{s.x, 0.0f, s.z});
+    ring.s_x[i] = s.x;
+    ring.s_z[i] = s.z;
+    ring.n_x[i] = s0n.x;
+    ring.n_z[i] = s0n.z;
+    ring.y[i] = s.y;
+  }
+}
 
-  Vertex result{};
-  result.position = tp;
-  result.normal = n;
-  result.uv = {}; //  @TODO
+NodeTransform make_node_transform(const TransformData& data) {
+  NodeTransform result{};
+  make_coordinate_system_y(
+    spherical_to_cartesian(data.direction), &result.is, &result.js, &result.ks);
+  make_coordinate_system_y(
+    spherical_to_cartesian(data.child_direction), &result.ic, &result.jc, &result.kc);
+  result.instance_position = data.instance_position;
+  result.child_instance_position = data.child_instance_position;
+  result.radius = data.radius;
+  result.child_radius = data.child_radius;
   return result;
 }
 
-TransformData make_transform_data(const tree::Internode& node,
-                                  const tree::ChildRenderData& child,
-                                  float scale) {
-  TransformData result{};
-  result.instance_position = node.render_position;
-  result.child_instance_position = child.position;
-  result.direction = node.spherical_direction();
-  result.child_direction = child.direction;
-  result.radius = node.diameter * 0.5f * scale;
-  result.child_radius = child.radius * scale;
-  return result;
+//  Same operation order as the scalar version, so that results match it exactly.
+F4x3 mat3_mul_vec3(const Vec3f& i, const Vec3f& j, const Vec3f& k,
+                   simd::F4 x, simd::F4 y, simd::F4 z) {
+  using namespace simd;
+  return F4x3{
+    set1(i.x) * x + set1(j.x) * y + set1(k.x) * z,
+    set1(i.y) * x + set1(j.y) * y + set1(k.y) * z,
+    set1(i.z) * x + set1(j.z) * y + set1(k.z) * z,
+  };
+}
+
+F4x3 normalize_f4(const F4x3& v) {
+  using namespace simd;
+  const F4 inv_len = set1(1.0f) / sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+  return F4x3{v.x * inv_len, v.y * inv_len, v.z * inv_len};
+}
+
+F4x3 lerp_f4(simd::F4 t, const F4x3& a, const F4x3& b) {
+  using namespace simd;
+  const F4 t0 = set1(1.0f) - t;
+  return F4x3{t0 * a.x + t * b.x, t0 * a.y + t * b.y, t0 * a.z + t * b.z};
+}
+
+//  Places every vertex of the ring table between the node's base and tip frames, 4 vertices at a
+//  time.
+void transform_ring(const RingTable& ring, const NodeTransform& tform, const Vec3f& offset,
+                    bool include_uv, float* out_v) {
+  using namespace simd;
+  const F4 zero = simd::zero();
+  const F4 one = set1(1.0f);
+  const F4 r_base = set1(tform.radius);
+  const F4 r_tip = set1(tform.child_radius);
+
+  for (uint32_t i = 0; i < ring.num_vertices; i += 4) {
+    const F4 s_x = load(ring.s_x + i);
+    const F4 s_z = load(ring.s_z + i);
+    const F4 n_x = load(ring.n_x + i);
+    const F4 n_z = load(ring.n_z + i);
+    const F4 y = load(ring.y + i);
+
+    auto n_base = normalize_f4(mat3_mul_vec3(tform.is, tform.js, tform.ks, n_x, zero, n_z));
+    auto n_tip = normalize_f4(mat3_mul_vec3(tform.ic, tform.jc, tform.kc, n_x, zero, n_z));
+    auto n = lerp_f4(y, n_base, n_tip);
+    const F4 degenerate = le(n.x * n.x + n.y * n.y + n.z * n.z, zero);
+    n.x = select(degenerate, zero, n.x);
+    n.y = select(degenerate, one, n.y);
+    n.z = select(degenerate, zero, n.z);
+
+    auto p_base = mat3_mul_vec3(tform.is, tform.js, tform.ks, s_x * r_base, zero, s_z * r_base);
+    auto p_tip = mat3_mul_vec3(tform.ic, tform.jc, tform.kc, s_x * r_tip, zero, s_z * r_tip);
+    p_base.x = p_base.x + set1(tform.instance_position.x);
+    p_base.y = p_base.y + set1(tform.instance_position.y);
+    p_base.z = p_base.z + set1(tform.instance_position.z);
+    p_tip.x = p_tip.x + set1(tform.child_instance_position.x);
+    p_tip.y = p_tip.y + set1(tform.child_instance_position.y);
+    p_tip.z = p_tip.z + set1(tform.child_instance_position.z);
+    auto p = lerp_f4(y, p_base, p_tip);
+
+    alignas(16) float lanes[6][4];
+    store(lanes[0], p.x + set1(offset.x));
+    store(lanes[1], p.y + set1(offset.y));
+    store(lanes[2], p.z + set1(offset.z));
+    store(lanes[3], n.x);
+    store(lanes[4], n.y);
+    store(lanes[5], n.z);
+
+    const uint32_t num_lanes = std::min(4u, ring.num_vertices - i);
+    for (uint32_t l = 0; l < num_lanes; l++) {
+      for (int j = 0; j < 6; j++) {
+        *out_v++ = lanes[j][l];
+      }
+      if (include_uv) {
+        *out_v++ = 0.0f;  //  @TODO
+        *out_v++ = 0.0f;
+      }
+    }
+  }
 }
 
 } //  anon
 
+
 size_t tree::compute_num_indices_in_node_mesh(const Vec2<int>& geom_sizes_xz,
                                               uint32_t num_internodes) {
   return 6 * (geom_sizes_xz.x - 1) * (geom_sizes_xz.y - 1) * num_internodes;
@@ -112,47 +218,56 @@ void tree::make_node_mesh(const tree::Internode* internodes, uint32_t num_intern
   const auto [npx, npz] = geom_sizes_xz;
   const Vec2f num_points_xz{float(npx), float(npz)};
 
-  std::vector<float> grid = make_reflected_grid_indices(npx, npz);
-  std::vector<uint16_t> grid_indices = triangulate_reflected_grid(npx, npz);
-
-  size_t vi{};
-  size_t num_grid_verts = grid.size() / 2;
-  size_t num_grid_indices = grid_indices.size();
-
-  for (uint32_t ni = 0; ni < num_internodes; ni++) {
-    auto& node = internodes[ni];
-    auto child = get_child_render_data(
-      node,
-      internodes,
-      params.allow_branch_to_lateral_child,
-      params.leaf_tip_radius);
-
-    auto tform_data = make_transform_data(node, child, params.scale);
-
-    //  Copy indices before adding offset.
-    for (size_t i = 0; i < num_grid_indices; i++) {
-      size_t dst_ind = grid_indices[i] + vi;
-      assert(dst_ind < (1u << 16u));
-      *out_i++ = uint16_t(dst_ind);
-    }
-
-    for (size_t i = 0; i < num_grid_verts; i++) {
-      Vec2f p2{grid[i * 2], grid[i * 2 + 1]};
-      auto vert = transform(p2, num_points_xz, tform_data, params.offset);
-      for (int j = 0; j < 3; j++) {
-        *out_v++ = vert.position[j];
-      }
-      for (int j = 0; j < 3; j++) {
-        *out_v++ = vert.normal[j];
-      }
-      if (params.include_uv) {
-        for (int j = 0; j < 2; j++) {
-          *out_v++ = vert.uv[j];
-        }
+  auto* arena = params.arena ? params.arena : get_global_frame_arena();
+  const size_t num_grid_verts = num_reflected_grid_index_components(npx, npz) / 2;
+  const size_t num_grid_indices = num_reflected_grid_triangle_indices(npx, npz);
+  auto* grid = arena->allocate_n<float>(num_grid_verts * 2);
+  auto* grid_indices = arena->allocate_n<uint16_t>(num_grid_indices);
+  make_reflected_grid_indices(npx, npz, grid);
+  triangulate_reflected_grid(npx, npz, grid_indices);
+
+  RingTable ring{};
+  ring.num_vertices = uint32_t(num_grid_verts);
+  const uint32_t num_padded = round_up_to_simd_width(ring.num_vertices);
+  for (float** dst : {&ring.s_x, &ring.s_z, &ring.n_x, &ring.n_z, &ring.y}) {
+    *dst = arena->allocate_n<float>(num_padded);
+  }
+  fill_ring_table(ring, grid, num_points_xz, num_padded);
+
+  const uint32_t vertex_size = params.include_uv ? 8 : 6;
+  const size_t verts_per_node = num_grid_verts * vertex_size;
+  auto make_nodes = [&](uint32_t beg, uint32_t end) {
+    for (uint32_t ni = beg; ni < end; ni++) {
+      auto& node = internodes[ni];
+      auto child = get_child_render_data(
+        node,
+        internodes,
+        params.allow_branch_to_lateral_child,
+        params.leaf_tip_radius);
+
+      const auto tform = make_node_transform(make_transform_data(node, child, params.scale));
+      const size_t vi = ni * num_grid_verts;
+      uint16_t* dst_i = out_i + ni * num_grid_indices;
+      for (size_t i = 0; i < num_grid_indices; i++) {
+        size_t dst_ind = grid_indices[i] + vi;
+        assert(dst_ind < (1u << 16u));
+        dst_i[i] = uint16_t(dst_ind);
       }
-    }
 
-    vi += num_grid_verts;
+      transform_ring(ring, tform, params.offset, params.include_uv, out_v + ni * verts_per_node);
+    }
+  };
+
+  auto* pool = params.task_pool;
+  if (!pool || pool->num_workers() == 0 || num_internodes <= Config::internodes_per_task) {
+    make_nodes(0, num_internodes);
+  } else {
+    const uint32_t num_tasks =
+      (num_internodes + Config::internodes_per_task - 1) / Config::internodes_per_task;
+    pool->parallel_for(int(num_tasks), [&](int task, int) {
+      const uint32_t beg = uint32_t(task) * Config::internodes_per_task;
+      make_nodes(beg, std::min(num_internodes, beg + Config::internodes_per_task));
+    });
   }
 }
 
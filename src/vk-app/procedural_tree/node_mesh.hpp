@@ -2,9 +2,16 @@
 
 #include "components.hpp"
 
+namespace grove {
+class FrameArena;
+class TaskPool;
+}
+
 namespace grove::tree {
 
 struct MakeNodeMeshParams {
+  FrameArena* arena{};  //  scratch space for the shared grid; the global frame arena if null
+  TaskPool* task_pool{};  //  if set, internodes are processed in parallel chunks
   bool include_uv{true};
   bool allow_branch_to_lateral_child{true};
   float leaf_tip_radius{};
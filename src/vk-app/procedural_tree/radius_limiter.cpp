@@ -1,12 +1,12 @@
 #include "radius_limiter.hpp"
+#include "../bounds/accel_intersect_scratch.hpp"
 #include "grove/common/common.hpp"
-#include "grove/common/Optional.hpp"
-#include "grove/common/SlotLists.hpp"
+#include "grove/common/ArrayView.hpp"
 #include "grove/math/bounds.hpp"
 #include "grove/math/intersect.hpp"
+#include "grove/math/obb_batch.hpp"
 #include "grove/math/util.hpp"
 #include "grove/math/GridIterator3.hpp"
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <atomic>
@@ -42,6 +42,16 @@ struct RadiusLimiterElements {
   std::vector<int> free_elements;
 };
 
+/*
+ * GridCellIndices
+ *
+ * Open-addressed map from grid cell coordinates to an index into `RadiusLimiter::cells`. The
+ * coordinates are interleaved into a 48-bit Morton code, which identifies the cell with a single
+ * integer comparison and is scrambled by a multiplicative hash to select the home slot. Collisions
+ * are resolved by linear probing; erasure shifts later entries of the probe sequence back into the
+ * vacated slot, so there are no tombstones.
+ */
+
 struct GridCellIndices {
   struct Key {
     friend inline bool operator==(const Key& a, const Key& b) {
@@ -51,13 +61,16 @@ struct GridCellIndices {
     Vec3<int16_t> i;
   };
 
-  struct HashKey {
-    size_t operator()(const Key& key) const noexcept {
-      return size_t(key.i.x ^ key.i.y ^ key.i.z);
-    }
+  struct Slot {
+    uint64_t code;
+    int index;
   };
 
-  std::unordered_map<Key, int, HashKey> cell_indices;
+  static constexpr int min_capacity_log2 = 6;
+
+  std::vector<Slot> slots;
+  int capacity_log2{};
+  int size{};
   std::vector<int> free;
 };
 
@@ -67,39 +80,154 @@ GridCellIndices::Key make_key(int16_t i, int16_t j, int16_t k) {
   return res;
 }
 
-Optional<int> find(const GridCellIndices& inds, GridCellIndices::Key key) {
-  auto it = inds.cell_indices.find(key);
-  return it == inds.cell_indices.end() ? NullOpt{} : Optional<int>(it->second);
+uint64_t spread_bits3(uint64_t x) {
+  x &= 0xffffu;
+  x = (x | (x << 32u)) & 0x1f00000000ffffull;
+  x = (x | (x << 16u)) & 0x1f0000ff0000ffull;
+  x = (x | (x << 8u)) & 0x100f00f00f00f00full;
+  x = (x | (x << 4u)) & 0x10c30c30c30c30c3ull;
+  x = (x | (x << 2u)) & 0x1249249249249249ull;
+  return x;
+}
+
+uint64_t morton_code(GridCellIndices::Key key) {
+  //  Flip the sign bit so that negative coordinates precede positive ones.
+  const auto x = uint64_t(uint16_t(key.i.x) ^ 0x8000u);
+  const auto y = uint64_t(uint16_t(key.i.y) ^ 0x8000u);
+  const auto z = uint64_t(uint16_t(key.i.z) ^ 0x8000u);
+  return spread_bits3(x) | (spread_bits3(y) << 1u) | (spread_bits3(z) << 2u);
+}
+
+uint32_t home_slot(const GridCellIndices& inds, uint64_t code) {
+  return uint32_t((code * 0x9e3779b97f4a7c15ull) >> (64 - inds.capacity_log2));
+}
+
+uint32_t slot_mask(const GridCellIndices& inds) {
+  return uint32_t(inds.slots.size()) - 1;
+}
+
+//  Returns the slot holding `code`, or the empty slot at which it would be inserted.
+uint32_t probe(const GridCellIndices& inds, uint64_t code) {
+  const uint32_t mask = slot_mask(inds);
+  uint32_t s = home_slot(inds, code);
+  while (inds.slots[s].index >= 0 && inds.slots[s].code != code) {
+    s = (s + 1) & mask;
+  }
+  return s;
+}
+
+void rehash(GridCellIndices& inds, int capacity_log2) {
+  auto src = std::move(inds.slots);
+  inds.capacity_log2 = capacity_log2;
+  inds.slots.assign(size_t(1) << capacity_log2, GridCellIndices::Slot{0, -1});
+  for (auto& slot : src) {
+    if (slot.index >= 0) {
+      inds.slots[probe(inds, slot.code)] = slot;
+    }
+  }
+}
+
+int find(const GridCellIndices& inds, GridCellIndices::Key key) {
+  if (inds.slots.empty()) {
+    return -1;
+  } else {
+    return inds.slots[probe(inds, morton_code(key))].index;
+  }
 }
 
 int require(GridCellIndices& inds, GridCellIndices::Key key, int size, bool* is_new) {
-  auto it = inds.cell_indices.find(key);
-  if (it != inds.cell_indices.end()) {
+  //  Keep the load factor at or below 1/2.
+  if (2 * (inds.size + 1) > int(inds.slots.size())) {
+    rehash(inds, std::max(GridCellIndices::min_capacity_log2, inds.capacity_log2 + 1));
+  }
+
+  const uint64_t code = morton_code(key);
+  auto& slot = inds.slots[probe(inds, code)];
+  if (slot.index >= 0) {
     *is_new = false;
-    return it->second;
+    return slot.index;
+  }
 
-  } else if (!inds.free.empty()) {
-    const int res = inds.free.back();
+  int res;
+  if (!inds.free.empty()) {
+    res = inds.free.back();
     inds.free.pop_back();
-    inds.cell_indices[key] = res;
     *is_new = false;
-    return res;
-
   } else {
-    const int res = size;
-    inds.cell_indices[key] = res;
+    res = size;
     *is_new = true;
-    return res;
   }
+
+  slot.code = code;
+  slot.index = res;
+  inds.size++;
+  return res;
 }
 
-[[maybe_unused]] void release(GridCellIndices& inds, GridCellIndices::Key key, int index) {
-  assert(inds.cell_indices.count(key) > 0);
+void release(GridCellIndices& inds, GridCellIndices::Key key, int index) {
   assert(std::find(inds.free.begin(), inds.free.end(), index) == inds.free.end());
-  inds.cell_indices.erase(key);
+  const uint32_t mask = slot_mask(inds);
+  uint32_t hole = probe(inds, morton_code(key));
+  assert(inds.slots[hole].index == index);
+
+  for (uint32_t s = (hole + 1) & mask; inds.slots[s].index >= 0; s = (s + 1) & mask) {
+    //  The entry in `s` may fill the hole if the hole lies between its home slot and `s`.
+    const uint32_t home = home_slot(inds, inds.slots[s].code);
+    if (((s - home) & mask) >= ((s - hole) & mask)) {
+      inds.slots[hole] = inds.slots[s];
+      hole = s;
+    }
+  }
+
+  inds.slots[hole].index = -1;
+  inds.size--;
   inds.free.push_back(index);
 }
 
+/*
+ * CellElementIndices
+ *
+ * Element indices of each cell are stored contiguously, in blocks of power-of-two capacity carved
+ * from a shared buffer. A cell whose block fills up moves to a block twice as large, and the old
+ * block is recycled.
+ */
+
+struct CellElementIndices {
+  static constexpr uint32_t min_block_capacity = 4;
+
+  std::vector<int> indices;
+  std::vector<std::vector<uint32_t>> free_blocks;
+};
+
+int block_class(uint32_t capacity) {
+  int res{};
+  while ((CellElementIndices::min_block_capacity << res) < capacity) {
+    res++;
+  }
+  return res;
+}
+
+uint32_t acquire_block(CellElementIndices& inds, uint32_t capacity) {
+  const int cls = block_class(capacity);
+  if (cls < int(inds.free_blocks.size()) && !inds.free_blocks[cls].empty()) {
+    const uint32_t res = inds.free_blocks[cls].back();
+    inds.free_blocks[cls].pop_back();
+    return res;
+  } else {
+    const auto res = uint32_t(inds.indices.size());
+    inds.indices.resize(inds.indices.size() + capacity);
+    return res;
+  }
+}
+
+void release_block(CellElementIndices& inds, uint32_t offset, uint32_t capacity) {
+  const int cls = block_class(capacity);
+  if (cls >= int(inds.free_blocks.size())) {
+    inds.free_blocks.resize(cls + 1);
+  }
+  inds.free_blocks[cls].push_back(offset);
+}
+
 Vec3f to_float(const Vec3<int16_t>& pow2_cell_dims) {
   Vec3f r;
   for (int i = 0; i < 3; i++) {
@@ -126,62 +254,83 @@ Bounds3<int16_t> cell_index_span(const Bounds3f& aabb, const Vec3<int16_t>& pow2
 
 struct bounds::RadiusLimiter {
   struct Cell {
-    SlotLists<int>::List index_list;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t capacity;
   };
 
   Vec3<int16_t> pow2_cell_dims{};
   float expand_factor{};
 
   RadiusLimiterElements elements;
-  SlotLists<int> element_indices;
+  CellElementIndices element_indices;
 
   std::vector<Cell> cells;
   GridCellIndices cell_indices;
+
+  //  Scratch reused across queries, so that they do not allocate; mutable so that const queries
+  //  can use it, which means queries on the same limiter must not run concurrently. `visited` is a
+  //  per-element stamp marking elements already tested by the current query.
+  mutable std::vector<uint32_t> visited;
+  mutable uint32_t visit_stamp{};
+  mutable AccelIntersectScratch gather_scratch;
 };
 
 namespace {
 
+ArrayView<const int> cell_elements(const RadiusLimiter* lim, const RadiusLimiter::Cell& cell) {
+  const int* beg = lim->element_indices.indices.data() + cell.offset;
+  return ArrayView<const int>{beg, beg + cell.size};
+}
+
 void insert_index(RadiusLimiter* lim, const GridCellIndices::Key& key, int el_index) {
   bool is_new{};
   int ind = require(lim->cell_indices, key, int(lim->cells.size()), &is_new);
   if (is_new) {
-    lim->cells.emplace_back();
+    //  Released cells keep their block, so only new cells acquire one here.
+    const uint32_t cap = CellElementIndices::min_block_capacity;
+    lim->cells.push_back({acquire_block(lim->element_indices, cap), 0, cap});
   }
+
   auto& cell = lim->cells[ind];
-  cell.index_list = lim->element_indices.insert(cell.index_list, el_index);
+  auto& inds = lim->element_indices;
+  if (cell.size == cell.capacity) {
+    const uint32_t offset = acquire_block(inds, cell.capacity * 2);
+    std::copy_n(inds.indices.begin() + cell.offset, cell.size, inds.indices.begin() + offset);
+    release_block(inds, cell.offset, cell.capacity);
+    cell.offset = offset;
+    cell.capacity *= 2;
+  }
+
+  inds.indices[cell.offset + cell.size++] = el_index;
 }
 
 bool erase_index(RadiusLimiter* lim, RadiusLimiter::Cell& cell, int el_index) {
-  auto it = lim->element_indices.begin(cell.index_list);
-  bool found{};
-  for (; it != lim->element_indices.end(); ++it) {
-    if (*it == el_index) {
-      lim->element_indices.erase(&cell.index_list, it);
-      found = true;
-      break;
-    }
-  }
-  assert(found);
-  return cell.index_list.empty();
+  //  Preserve insertion order, since it determines the order in which queries visit elements.
+  auto beg = lim->element_indices.indices.begin() + cell.offset;
+  auto end = beg + cell.size;
+  auto it = std::find(beg, end, el_index);
+  assert(it != end);
+  std::copy(it + 1, end, it);
+  cell.size--;
+  return cell.size == 0;
 }
 
 void remove_index(RadiusLimiter* lim, const GridCellIndices::Key& key, int el_index) {
-  auto cell_it = find(lim->cell_indices, key);
-  assert(cell_it.has_value() && cell_it.value() < int(lim->cells.size()));
-  auto& cell = lim->cells[cell_it.value()];
+  const int cell_index = find(lim->cell_indices, key);
+  assert(cell_index >= 0 && cell_index < int(lim->cells.size()));
+  auto& cell = lim->cells[cell_index];
   if (erase_index(lim, cell, el_index)) {
-    release(lim->cell_indices, key, cell_it.value());
+    release(lim->cell_indices, key, cell_index);
   }
 }
 
 void assert_no_duplicates(const RadiusLimiter* lim) {
   std::unordered_set<int> set;
   for (auto& cell : lim->cells) {
-    auto it = lim->element_indices.cbegin(cell.index_list);
-    auto end = lim->element_indices.cend();
-    for (; it != end; ++it) {
-      assert(set.count(*it) == 0);
-      set.insert(*it);
+    for (int ind : cell_elements(lim, cell)) {
+      assert(set.count(ind) == 0);
+      set.insert(ind);
     }
     set.clear();
   }
@@ -190,29 +339,19 @@ void assert_no_duplicates(const RadiusLimiter* lim) {
 [[maybe_unused]] void assert_element_present(const RadiusLimiter* lim, const Vec3<int16_t>& beg,
                                              const Vec3<int16_t>& end, int el_index) {
   for (auto it = begin_it(beg, end); is_valid(it); ++it) {
-    auto key = GridCellIndices::Key{*it};
-    auto cell_it = find(lim->cell_indices, key);
-    assert(cell_it.has_value());
-    auto& cell = lim->cells[cell_it.value()];
-    auto ind_it = lim->element_indices.cbegin(cell.index_list);
-    bool found{};
-    for (; ind_it != lim->element_indices.cend(); ++ind_it) {
-      if (*ind_it == el_index) {
-        found = true;
-        break;
-      }
-    }
-    assert(found);
-    (void) found;
+    const int cell_index = find(lim->cell_indices, GridCellIndices::Key{*it});
+    assert(cell_index >= 0);
+    auto inds = cell_elements(lim, lim->cells[cell_index]);
+    assert(std::find(inds.begin(), inds.end(), el_index) != inds.end());
+    (void) inds;
   }
 }
 
 [[maybe_unused]] void assert_element_removed(const RadiusLimiter* lim, int el_index) {
   for (auto& cell : lim->cells) {
-    auto it = lim->element_indices.cbegin(cell.index_list);
-    auto end = lim->element_indices.cend();
-    for (; it != end; ++it) {
-      assert(*it != el_index);
+    for (int ind : cell_elements(lim, cell)) {
+      assert(ind != el_index);
+      (void) ind;
       (void) el_index;
     }
   }
@@ -225,22 +364,35 @@ Bounds3<int16_t> cell_index_span(const RadiusLimiter* lim, const OBB3f& obb) {
   return cell_index_span(obb3_to_aabb(obb), lim->pow2_cell_dims);
 }
 
-auto cbegin_it(const RadiusLimiter* lim, int16_t i, int16_t j, int16_t k) {
-  if (auto ind = find(lim->cell_indices, make_key(i, j, k))) {
-    auto& cell = lim->cells[ind.value()];
-    return lim->element_indices.cbegin(cell.index_list);
-  } else {
-    return lim->element_indices.cend();
-  }
+ArrayView<const int> cell_elements(const RadiusLimiter* lim, int16_t i, int16_t j, int16_t k) {
+  const int ind = find(lim->cell_indices, make_key(i, j, k));
+  return ind >= 0 ? cell_elements(lim, lim->cells[ind]) : ArrayView<const int>{};
 }
 
-auto cbegin_it(const RadiusLimiter* lim, const Vec3<int>& ijk) {
+ArrayView<const int> cell_elements(const RadiusLimiter* lim, const Vec3<int>& ijk) {
   constexpr int16_t min = std::numeric_limits<int16_t>::min();
   constexpr int16_t max = std::numeric_limits<int16_t>::max();
   (void) min;
   (void) max;
   assert(all(ge(ijk, Vec3<int>{min})) && all(le(ijk, Vec3<int>{max})));
-  return cbegin_it(lim, int16_t(ijk.x), int16_t(ijk.y), int16_t(ijk.z));
+  return cell_elements(lim, int16_t(ijk.x), int16_t(ijk.y), int16_t(ijk.z));
+}
+
+uint32_t begin_visit(const RadiusLimiter* lim) {
+  if (lim->visited.size() < lim->elements.elements.size()) {
+    lim->visited.resize(lim->elements.elements.size());
+  }
+  if (++lim->visit_stamp == 0) {
+    std::fill(lim->visited.begin(), lim->visited.end(), 0u);
+    lim->visit_stamp = 1;
+  }
+  return lim->visit_stamp;
+}
+
+//  Conservative test, using the bounding spheres of `a` and `b`.
+bool may_intersect(const OBB3f& a, const OBB3f& b) {
+  const float r = a.half_size.length() + b.half_size.length();
+  return (a.position - b.position).length_squared() <= r * r;
 }
 
 int to_linear_index(int16_t i, int16_t j, int16_t k, const Vec3<int16_t>& counts) {
@@ -270,31 +422,32 @@ int gather_intersecting_impl(const RadiusLimiter* lim, const OBB3f& el_obb,
   const auto span = cell_index_span(lim, el_obb);
   auto grid_it = begin_it(span.min, span.max + int16_t(1));
 
-  std::unordered_set<int> visited;
-  int num_inserted{};
+  auto& scratch = lim->gather_scratch;
+  scratch.candidates.clear();
+  scratch.bounds.clear();
 
+  const uint32_t stamp = begin_visit(lim);
   for (; is_valid(grid_it); ++grid_it) {
     auto& key = *grid_it;
-    auto it = cbegin_it(lim, key.x, key.y, key.z);
-    auto end = lim->element_indices.cend();
-    for (; it != end; ++it) {
-      const int ind = *it;
-      if (visited.count(ind) > 0) {
+    for (int ind : cell_elements(lim, key.x, key.y, key.z)) {
+      if (lim->visited[ind] == stamp) {
         continue;
-      } else {
-        visited.insert(ind);
       }
+      lim->visited[ind] = stamp;
 
       const auto& query_el = lim->elements.elements[ind];
-      auto query_obb = query_el.to_obb(query_el.radius);
-      if (obb_obb_intersect(el_obb, query_obb)) {
-        out.push_back(query_el);
-        num_inserted++;
-      }
+      scratch.candidates.push_back(uint32_t(ind));
+      scratch.bounds.push_back(query_el.to_obb(query_el.radius));
     }
   }
 
-  return num_inserted;
+  scratch.hits.resize(scratch.candidates.size());
+  const uint32_t num_hit = obb_obb_intersect(el_obb, scratch.bounds, scratch.hits.data());
+  for (uint32_t i = 0; i < num_hit; i++) {
+    out.push_back(lim->elements.elements[scratch.candidates[scratch.hits[i]]]);
+  }
+
+  return int(num_hit);
 }
 
 } //  anon
@@ -319,10 +472,8 @@ bool bounds::intersects_other(const RadiusLimiter* lim, RadiusLimiterElement el)
   for (int16_t i = span.min.x; i < span_end.x; i++) {
     for (int16_t j = span.min.y; j < span_end.y; j++) {
       for (int16_t k = span.min.z; k < span_end.z; k++) {
-        auto it = cbegin_it(lim, i, j, k);
-        auto end = lim->element_indices.cend();
-        for (; it != end; ++it) {
-          auto& query_el = lim->elements.elements[*it];
+        for (int ind : cell_elements(lim, i, j, k)) {
+          auto& query_el = lim->elements.elements[ind];
           if (query_el.aggregate_id != el.aggregate_id) {
             auto query_obb = query_el.to_obb(query_el.radius);
             if (obb_obb_intersect(el_obb, query_obb)) {
@@ -344,10 +495,8 @@ bool bounds::intersects_other_tag(const RadiusLimiter* lim, const OBB3f& el_obb,
 
   for (; is_valid(grid_it); ++grid_it) {
     auto& key = *grid_it;
-    auto it = cbegin_it(lim, key.x, key.y, key.z);
-    auto end = lim->element_indices.cend();
-    for (; it != end; ++it) {
-      auto& query_el = lim->elements.elements[*it];
+    for (int ind : cell_elements(lim, key.x, key.y, key.z)) {
+      auto& query_el = lim->elements.elements[ind];
       if (query_el.tag != tag) {
         continue;
       }
@@ -420,9 +569,7 @@ int bounds::gather_intersecting_line(const RadiusLimiter* lim, const Vec3f& p0,
       break;
     }
 
-    auto it = cbegin_it(lim, curr_index);
-    for (; it != lim->element_indices.cend(); ++it) {
-      const int element_index = *it;
+    for (const int element_index : cell_elements(lim, curr_index)) {
       if (visited.count(element_index) > 0) {
         continue;
       }
@@ -518,18 +665,28 @@ float bounds::expand(RadiusLimiter* lim, RadiusLimiterElementHandle handle, floa
   auto new_span = cell_index_span(lim, new_obb);
   auto new_span_end = new_span.max + int16_t(1);
 
+  //  An element spanning several cells is tested once. `new_obb` only shrinks, so a second test
+  //  against the same element could not shrink it further.
+  const uint32_t stamp = begin_visit(lim);
+
   for (int16_t i = new_span.min.x; i < new_span_end.x; i++) {
     for (int16_t j = new_span.min.y; j < new_span_end.y; j++) {
       for (int16_t k = new_span.min.z; k < new_span_end.z; k++) {
-        auto it = cbegin_it(lim, i, j, k);
-        auto end = lim->element_indices.cend();
-        for (; it != end; ++it) {
-          auto& query_el = lim->elements.elements[*it];
+        for (int ind : cell_elements(lim, i, j, k)) {
+          if (lim->visited[ind] == stamp) {
+            continue;
+          }
+          lim->visited[ind] = stamp;
+
+          auto& query_el = lim->elements.elements[ind];
           if (query_el.aggregate_id == el.aggregate_id) {
             //  Allow intersections between nodes that are part of the same aggregate.
             continue;
           }
           auto query_obb = query_el.to_obb(query_el.radius);
+          if (!may_intersect(query_obb, new_obb)) {
+            continue;
+          }
           int step{};
           while (expand > 1.0f && step < 32 && obb_obb_intersect(query_obb, new_obb)) {
             expand = lerp(0.5f, 1.0f, expand);
@@ -704,10 +861,8 @@ void bounds::histogram(const RadiusLimiter* lim, const Vec3<int16_t>& ori,
   for (int16_t i = lim_span.min.x; i <= lim_span.max.x; i++) {
     for (int16_t j = lim_span.min.y; j <= lim_span.max.y; j++) {
       for (int16_t k = lim_span.min.z; k <= lim_span.max.z; k++) {
-        auto it = cbegin_it(lim, i, j, k);
-        auto end = lim->element_indices.cend();
-        for (; it != end; ++it) {
-          auto& query_el = lim->elements.elements[*it];
+        for (int ind : cell_elements(lim, i, j, k)) {
+          auto& query_el = lim->elements.elements[ind];
           if (query_el.aggregate_id.id == aggregate) {
             continue;
           }
@@ -728,12 +883,15 @@ void bounds::histogram(const RadiusLimiter* lim, const Vec3<int16_t>& ori,
 RadiusLimiterStats bounds::get_stats(const RadiusLimiter* lim) {
   RadiusLimiterStats result{};
   result.num_cells = int(lim->cells.size());
-  result.num_cell_indices = int(lim->cell_indices.cell_indices.size());
+  result.num_cell_indices = lim->cell_indices.size;
   result.num_free_cell_indices = int(lim->cell_indices.free.size());
   result.num_elements = int(lim->elements.elements.size());
   result.num_free_elements = int(lim->elements.free_elements.size());
-  result.num_element_indices = int(lim->element_indices.num_nodes());
-  result.num_free_element_indices = int(lim->element_indices.num_free_nodes());
+  result.num_element_indices = int(lim->element_indices.indices.size());
+  result.num_free_element_indices = result.num_element_indices;
+  for (auto& cell : lim->cells) {
+    result.num_free_element_indices -= int(cell.size);
+  }
   return result;
 }
 
@@ -4,6 +4,7 @@
 #include "grove/math/frame.hpp"
 #include "grove/math/util.hpp"
 #include "grove/common/common.hpp"
+#include "grove/common/TaskPool.hpp"
 #include "grove/common/Temporary.hpp"
 #include "grove/common/pack.hpp"
 
@@ -13,6 +14,11 @@ namespace {
 
 using namespace tree;
 
+struct Config {
+  static constexpr int min_num_internodes_parallel_frames = 1024;
+  static constexpr int axes_per_task = 16;
+};
+
 OBB3f make_obb(const tree::Internode& internode, float diameter) {
   auto half_size_xz = diameter * 0.5f;
   auto half_size_y = internode.length * 0.5f;
@@ -105,6 +111,43 @@ bool tick_render_axis_growth_depth_first(Internodes& internodes, RenderAxisGrowt
   return true;
 }
 
+//  Carry the parent's frame along to a child on the same axis, keeping the child's x and z axes
+//  on the same side as the parent's.
+void transport_internode_frame(const Mat3f& self_frame, const Vec3f& child_direction,
+                               Mat3f& child_frame) {
+  child_frame[1] = child_direction;
+  if (std::abs(dot(child_frame[1], self_frame[2])) > 0.99f) {
+    make_coordinate_system_y(child_frame[1], &child_frame[0], &child_frame[1], &child_frame[2]);
+  } else {
+    child_frame[0] = normalize(cross(child_frame[1], self_frame[2]));
+    if (dot(child_frame[0], self_frame[0]) < 0.0f)  {
+      child_frame[0] = -child_frame[0];
+    }
+    child_frame[2] = cross(child_frame[0], child_frame[1]);
+    if (dot(child_frame[2], self_frame[2]) < 0.0f) {
+      child_frame[2] = -child_frame[2];
+    }
+  }
+}
+
+//  Frames of the nodes reachable from `root` without starting a new axis, given the root's frame.
+void compute_axis_internode_frames(const tree::Internode* nodes, int root, Mat3f* dst) {
+  int self = root;
+  while (true) {
+    auto& self_node = nodes[self];
+    int child;
+    if (self_node.has_medial_child()) {
+      child = self_node.medial_child;
+    } else if (self_node.has_lateral_child()) {
+      child = self_node.lateral_child;
+    } else {
+      break;
+    }
+    transport_internode_frame(dst[self], nodes[child].direction, dst[child]);
+    self = child;
+  }
+}
+
 } //  anon
 
 void tree::copy_diameter_to_lateral_q(Internodes& inodes) {
@@ -798,21 +841,41 @@ void tree::compute_internode_frames(const tree::Internode* nodes, int num_nodes,
       continue;
     }
 
-    auto& child_frame = dst[int(child_node - nodes)];
-    child_frame[1] = child_node->direction;
-    if (std::abs(dot(child_frame[1], self_frame[2])) > 0.99f) {
-      make_coordinate_system_y(child_frame[1], &child_frame[0], &child_frame[1], &child_frame[2]);
-    } else {
-      child_frame[0] = normalize(cross(child_frame[1], self_frame[2]));
-      if (dot(child_frame[0], self_frame[0]) < 0.0f)  {
-        child_frame[0] = -child_frame[0];
-      }
-      child_frame[2] = cross(child_frame[0], child_frame[1]);
-      if (dot(child_frame[2], self_frame[2]) < 0.0f) {
-        child_frame[2] = -child_frame[2];
-      }
+    transport_internode_frame(self_frame, child_node->direction, dst[int(child_node - nodes)]);
+  }
+}
+
+void tree::compute_internode_frames(const tree::Internode* nodes, int num_nodes, Mat3f* dst,
+                                    TaskPool* task_pool) {
+  if (!task_pool || task_pool->num_workers() == 0 ||
+      num_nodes < Config::min_num_internodes_parallel_frames) {
+    compute_internode_frames(nodes, num_nodes, dst);
+    return;
+  }
+
+  //  Frames only depend on the parent frame along an axis, and each axis starts from a frame
+  //  derived from its root's direction alone, so axes can be processed independently.
+  Temporary<int, 1024> store_roots;
+  int* roots = store_roots.require(num_nodes);
+  int num_roots{};
+  roots[num_roots++] = 0;
+  for (int i = 0; i < num_nodes; i++) {
+    if (nodes[i].has_medial_child() && nodes[i].has_lateral_child()) {
+      roots[num_roots++] = nodes[i].lateral_child;
     }
   }
+
+  const int num_tasks = (num_roots + Config::axes_per_task - 1) / Config::axes_per_task;
+  task_pool->parallel_for(num_tasks, [&](int task, int) {
+    const int beg = task * Config::axes_per_task;
+    const int end = std::min(num_roots, beg + Config::axes_per_task);
+    for (int i = beg; i < end; i++) {
+      auto& root_frame = dst[roots[i]];
+      make_coordinate_system_y(
+        nodes[roots[i]].direction, &root_frame[0], &root_frame[1], &root_frame[2]);
+      compute_axis_internode_frames(nodes, roots[i], dst);
+    }
+  });
 }
 
 GROVE_NAMESPACE_END
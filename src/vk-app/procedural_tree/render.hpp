@@ -2,6 +2,10 @@
 
 #include "components.hpp"
 
+namespace grove {
+class TaskPool;
+}
+
 namespace grove::tree {
 
 struct RemappedAxisRoot {
@@ -44,6 +48,8 @@ OBB3f internode_obb_custom_diameter(const tree::Internode& node, float diameter)
 void orient_to_internode_direction(OBB3f* dst, const tree::Internode& inode);
 RemappedAxisRoots remap_axis_roots(const tree::Internodes& internodes);
 void compute_internode_frames(const tree::Internode* node, int num_nodes, Mat3f* dst);
+void compute_internode_frames(const tree::Internode* node, int num_nodes, Mat3f* dst,
+                              TaskPool* task_pool);
 
 void copy_diameter_to_lateral_q(Internodes& inodes);
 void copy_position_to_render_position(Internodes& inodes);
@@ -13,6 +13,7 @@
 #include "grove/audio/envelope.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/Temporary.hpp"
+#include "grove/common/FrameArena.hpp"
 #include "grove/common/ArrayView.hpp"
 #include "grove/common/profile.hpp"
 #include "grove/common/Stopwatch.hpp"
@@ -69,6 +70,8 @@ struct RenderTreeSystem {
 
   bounds::AccessorID bounds_accessor_id{bounds::AccessorID::create()};
   tree::Internodes temporary_internodes;
+  std::vector<const bounds::Element*> temporary_leaf_bounds_isect;
+  bounds::AccelIntersectScratch leaf_bounds_isect_scratch;
   uint32_t num_drawables_created_this_frame{};
 
   foliage::TreeLeavesPoolAllocator tree_leaves_pool_alloc;
@@ -185,19 +188,24 @@ OBB3f get_leaf_bounds(const Internode& node, const Bounds3f& nodes_aabb,
   }
 }
 
-std::vector<const Internode*>
-select_leaf_internodes(const Internodes& nodes, const Bounds3f& nodes_aabb,
+//  Indices of leaf internodes whose bounds overlap only this tree's elements.
+ArrayView<const int>
+select_leaf_internodes(FrameArena& arena, std::vector<const bounds::Element*>& isect,
+                       bounds::AccelIntersectScratch& isect_scratch,
+                       const Internodes& nodes, const Bounds3f& nodes_aabb,
                        const bounds::Accel* accel,
                        bounds::ElementTag tree_tag, bounds::ElementTag leaf_tag,
                        const Vec3f& bounds_scale, const Vec3f& bounds_offset,
                        TreeSystemLeafBoundsDistributionStrategy distrib_strategy) {
-  std::vector<const tree::Internode*> leaf_ptrs;
-  std::vector<const bounds::Element*> isect;
-  for (auto& node : nodes) {
+  int* leaf_indices = arena.allocate_n<int>(nodes.size());
+  int num_leaves{};
+  isect.clear();
+  for (int i = 0; i < int(nodes.size()); i++) {
+    auto& node = nodes[i];
     if (node.is_leaf()) {
       auto node_bounds = get_leaf_bounds(
         node, nodes_aabb, bounds_scale, bounds_offset, distrib_strategy);
-      accel->intersects(bounds::make_query_element(node_bounds), isect);
+      bounds::intersects(accel, bounds::make_query_element(node_bounds), isect, isect_scratch);
       bool accept = true;
       for (const bounds::Element* el : isect) {
         if (el->tag != tree_tag.id && el->tag != leaf_tag.id) {
@@ -206,21 +214,12 @@ select_leaf_internodes(const Internodes& nodes, const Bounds3f& nodes_aabb,
         }
       }
       if (accept) {
-        leaf_ptrs.push_back(&node);
+        leaf_indices[num_leaves++] = i;
       }
       isect.clear();
     }
   }
-  return leaf_ptrs;
-}
-
-std::vector<int> to_leaf_internode_indices(const std::vector<const tree::Internode*>& ptrs,
-                                           const tree::Internode* p) {
-  std::vector<int> result(ptrs.size());
-  for (int i = 0; i < int(ptrs.size()); i++) {
-    result[i] = int(ptrs[i] - p);
-  }
-  return result;
+  return ArrayView<const int>{leaf_indices, leaf_indices + num_leaves};
 }
 
 void set_zero_diameter(Internodes& inodes) {
@@ -359,7 +358,8 @@ bool require_drawables(RenderTreeSystem* sys, Instance& render_inst,
   if (render_inst.enable_branch_node_drawable_components) {
     render_inst.branch_node_drawable_components =
       tree::create_wind_branch_node_drawable_components_from_internodes(
-        info.render_branch_nodes_data, internodes, internode_aabb, axis_root_info, remapped_roots);
+        info.render_branch_nodes_data, internodes, internode_aabb, axis_root_info, remapped_roots,
+        info.task_pool);
 
 #if 1
     if (render_inst.branch_node_drawable_components.wind_drawable) {
@@ -372,7 +372,8 @@ bool require_drawables(RenderTreeSystem* sys, Instance& render_inst,
 #endif
   }
 
-  const auto leaf_ptrs = select_leaf_internodes(
+  const auto leaf_indices = select_leaf_internodes(
+    *info.frame_arena, sys->temporary_leaf_bounds_isect, sys->leaf_bounds_isect_scratch,
     internodes, internode_aabb,
     accel,
     tree::get_bounds_tree_element_tag(info.tree_system),
@@ -430,8 +431,8 @@ bool require_drawables(RenderTreeSystem* sys, Instance& render_inst,
     render_inst.foliage_drawable_components =
       foliage::create_foliage_drawable_components_from_internodes(
         info.tree_leaves_frustum_cull_data,
-        info.foliage_occlusion_system, &sys->tree_leaves_pool_alloc, create_params,
-        internodes, to_leaf_internode_indices(leaf_ptrs, internodes.data()));
+        info.foliage_occlusion_system, &sys->tree_leaves_pool_alloc, info.frame_arena,
+        create_params, internodes, leaf_indices.data(), uint32_t(leaf_indices.size()));
   }
 
   //  @TODO: Avoid this copy.
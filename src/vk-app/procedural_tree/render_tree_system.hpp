@@ -2,6 +2,11 @@
 
 #include "tree_system.hpp"
 
+namespace grove {
+class FrameArena;
+class TaskPool;
+}
+
 namespace grove::foliage_occlusion {
 struct FoliageOcclusionSystem;
 }
@@ -65,6 +70,8 @@ struct RenderTreeSystemUpdateInfo {
   cull::FrustumCullData* tree_leaves_frustum_cull_data;
   cull::FrustumCullData* branch_nodes_frustum_cull_data;
   RenderBranchNodesData* render_branch_nodes_data;
+  FrameArena* frame_arena;
+  TaskPool* task_pool;
   double real_dt;
 };
 
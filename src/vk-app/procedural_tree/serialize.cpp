@@ -1,6 +1,7 @@
 #include "serialize.hpp"
 #include "grove/common/common.hpp"
 #include <fstream>
+#include <type_traits>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -17,19 +18,25 @@ struct ReadStream {
 };
 
 template <typename T>
-void write(WriteStream& stream, const T* data) {
-  size_t size = stream.size();
-  stream.resize(stream.size() + sizeof(T));
-  memcpy(stream.data() + size, data, sizeof(T));
+void write(WriteStream& stream, const T* data, size_t count = 1) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  const size_t size = stream.size();
+  stream.resize(size + sizeof(T) * count);
+  if (count > 0) {
+    memcpy(stream.data() + size, data, sizeof(T) * count);
+  }
 }
 
 template <typename T>
-bool read(const ReadStream& stream, size_t& off, T* out) {
-  if (off + sizeof(T) > stream.size) {
+bool read(const ReadStream& stream, size_t& off, T* out, size_t count = 1) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if (off > stream.size || count > (stream.size - off) / sizeof(T)) {
     return false;
   } else {
-    memcpy(out, stream.data + off, sizeof(T));
-    off += sizeof(T);
+    if (count > 0) {
+      memcpy(out, stream.data + off, sizeof(T) * count);
+    }
+    off += sizeof(T) * count;
     return true;
   }
 }
@@ -38,9 +45,7 @@ template <typename T>
 void serialize_vector(WriteStream& out, const std::vector<T>& vec) {
   size_t size = vec.size();
   write(out, &size);
-  for (auto& el : vec) {
-    write<T>(out, &el);
-  }
+  write(out, vec.data(), size);
 }
 
 template <typename T>
@@ -49,13 +54,11 @@ bool deserialize_vector(const ReadStream& stream, size_t& off, std::vector<T>* o
   if (!read(stream, off, &size)) {
     return false;
   }
-  *out = std::vector<T>(size);
-  for (size_t i = 0; i < size; i++) {
-    if (!read(stream, off, &(*out)[i])) {
-      return false;
-    }
+  if (size > (stream.size - off) / sizeof(T)) {
+    return false;
   }
-  return true;
+  out->resize(size);
+  return read(stream, off, out->data(), size);
 }
 
 void serialize(WriteStream& out, const std::vector<Internode>& inodes) {
@@ -92,6 +95,9 @@ bool deserialize(const ReadStream& stream, size_t& off, std::vector<Bud>* out) {
 
 std::vector<unsigned char> tree::serialize(const TreeNodeStore& store) {
   std::vector<unsigned char> result;
+  result.reserve(2 * sizeof(size_t) +
+                 store.internodes.size() * sizeof(Internode) +
+                 store.buds.size() * sizeof(Bud));
   grove::serialize(result, store.internodes);
   grove::serialize(result, store.buds);
   return result;
@@ -0,0 +1,696 @@
+#include "snapshot.hpp"
+#include "roots_components.hpp"
+#include "vine_system.hpp"
+#include "grove/common/common.hpp"
+#include "grove/common/platform.hpp"
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(GROVE_UNIX)
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#elif defined(GROVE_WIN)
+#include <windows.h>
+#include <io.h>
+#include <cstdio>
+#endif
+
+GROVE_NAMESPACE_BEGIN
+
+using namespace tree;
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<Internode>);
+static_assert(std::is_trivially_copyable_v<Bud>);
+static_assert(std::is_trivially_copyable_v<TreeRootNode>);
+static_assert(std::is_trivially_copyable_v<VineNode>);
+static_assert(std::is_trivially_copyable_v<Vec3f>);
+
+constexpr char file_magic[4]{'G', 'T', 'S', 'N'};
+//  Increment when the layout of a header or of a stored component changes.
+constexpr uint32_t format_version = 1;
+constexpr uint32_t record_magic = 0x44524352u;
+constexpr size_t alignment = 16;
+
+enum RecordFlags : uint32_t {
+  record_removed = 1u,
+};
+
+struct FileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t reserved0;
+  uint64_t reserved1[2];
+};
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t kind;
+  uint64_t key;
+  //  Bytes spanned by the record, including headers and padding.
+  uint64_t size;
+  uint32_t flags;
+  uint32_t num_arrays;
+};
+
+struct ArrayHeader {
+  //  Relative to the beginning of the record.
+  uint64_t offset;
+  uint64_t count;
+  uint32_t element_size;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 32 && sizeof(FileHeader) % alignment == 0);
+static_assert(sizeof(RecordHeader) == 32);
+static_assert(sizeof(ArrayHeader) == 24);
+
+const unsigned char zero_padding[alignment]{};
+
+struct WritePiece {
+  const void* data;
+  size_t size;
+};
+
+size_t align_up(size_t size) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+bool is_little_endian() {
+  const uint16_t v = 1;
+  unsigned char b;
+  memcpy(&b, &v, 1);
+  return b == 1;
+}
+
+FileHeader make_file_header() {
+  FileHeader result{};
+  memcpy(result.magic, file_magic, sizeof(file_magic));
+  result.version = format_version;
+  result.header_size = uint32_t(sizeof(FileHeader));
+  return result;
+}
+
+bool is_valid_file_header(const unsigned char* data, size_t size) {
+  if (size < sizeof(FileHeader)) {
+    return false;
+  }
+  FileHeader header;
+  memcpy(&header, data, sizeof(FileHeader));
+  return memcmp(header.magic, file_magic, sizeof(file_magic)) == 0 &&
+         header.version == format_version &&
+         header.header_size == sizeof(FileHeader);
+}
+
+uint32_t expected_element_size(SnapshotRecordKind kind, int array_index) {
+  switch (kind) {
+    case SnapshotRecordKind::Tree:
+      return array_index == 0 ? uint32_t(sizeof(Internode)) : uint32_t(sizeof(Bud));
+    case SnapshotRecordKind::AttractionPoints:
+      return uint32_t(sizeof(Vec3f));
+    case SnapshotRecordKind::Roots:
+      return uint32_t(sizeof(TreeRootNode));
+    case SnapshotRecordKind::Vine:
+      return uint32_t(sizeof(VineNode));
+    default:
+      return 0;
+  }
+}
+
+int expected_num_arrays(SnapshotRecordKind kind) {
+  return kind == SnapshotRecordKind::Tree ? 2 : 1;
+}
+
+SnapshotRecord make_record(SnapshotRecordKind kind, uint64_t key) {
+  SnapshotRecord result{};
+  result.kind = kind;
+  result.key = key;
+  return result;
+}
+
+template <typename T>
+void push_array(SnapshotRecord& record, const T* data, uint64_t count) {
+  assert(record.num_arrays < SnapshotRecord::max_num_arrays);
+  record.arrays[record.num_arrays++] = SnapshotArray{data, uint32_t(sizeof(T)), count};
+}
+
+/*
+ * Record iteration
+ */
+
+//  Invokes `f(header, arrays, record_data)` for each well-formed record after the file header, and
+//  returns the number of bytes spanned by the file header and those records. Parsing stops at the
+//  first malformed record, such as one left incomplete by an interrupted write.
+template <typename F>
+size_t parse_records(const unsigned char* data, size_t size, F&& f) {
+  size_t off = sizeof(FileHeader);
+  while (size - off >= sizeof(RecordHeader)) {
+    const unsigned char* record = data + off;
+    RecordHeader header;
+    memcpy(&header, record, sizeof(RecordHeader));
+
+    const size_t headers_size = sizeof(RecordHeader) + header.num_arrays * sizeof(ArrayHeader);
+    if (header.magic != record_magic ||
+        header.num_arrays > uint32_t(SnapshotRecord::max_num_arrays) ||
+        header.size % alignment != 0 ||
+        header.size < headers_size ||
+        header.size > size - off) {
+      break;
+    }
+
+    ArrayHeader arrays[SnapshotRecord::max_num_arrays]{};
+    bool valid_arrays{true};
+    for (uint32_t i = 0; i < header.num_arrays; i++) {
+      auto& array = arrays[i];
+      const size_t array_off = sizeof(RecordHeader) + i * sizeof(ArrayHeader);
+      memcpy(&array, record + array_off, sizeof(ArrayHeader));
+      valid_arrays = valid_arrays &&
+        array.offset % alignment == 0 &&
+        array.offset >= headers_size &&
+        array.offset <= header.size &&
+        array.element_size > 0 &&
+        array.count <= (header.size - array.offset) / array.element_size;
+    }
+    if (!valid_arrays) {
+      break;
+    }
+
+    f(header, arrays, record);
+    off += size_t(header.size);
+  }
+  return off;
+}
+
+/*
+ * Files
+ */
+
+struct MappedFile {
+  const unsigned char* data{};
+  size_t size{};
+#ifdef GROVE_WIN
+  HANDLE file{INVALID_HANDLE_VALUE};
+  HANDLE mapping{};
+#endif
+};
+
+#if defined(GROVE_UNIX)
+
+bool map_file(const char* file_path, MappedFile* out) {
+  const int fd = ::open(file_path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat sb{};
+  void* data = MAP_FAILED;
+  if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+    data = mmap(nullptr, size_t(sb.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  //  The mapping remains valid once the descriptor is closed.
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  out->data = static_cast<const unsigned char*>(data);
+  out->size = size_t(sb.st_size);
+  return true;
+}
+
+void unmap_file(MappedFile& file) {
+  if (file.data) {
+    munmap(const_cast<unsigned char*>(file.data), file.size);
+  }
+  file = {};
+}
+
+struct WriteFile {
+  int fd{-1};
+};
+
+bool open_for_write(const char* file_path, bool append, WriteFile* out) {
+  const int flags = O_WRONLY | (append ? O_APPEND : O_CREAT | O_TRUNC);
+  const int fd = ::open(file_path, flags, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  out->fd = fd;
+  return true;
+}
+
+bool write_pieces(WriteFile& file, const std::vector<WritePiece>& pieces) {
+  std::vector<iovec> iov;
+  iov.reserve(pieces.size());
+  for (auto& piece : pieces) {
+    iov.push_back(iovec{const_cast<void*>(piece.data), piece.size});
+  }
+
+  size_t next{};
+  while (next < iov.size()) {
+    const int num_write = int(std::min(iov.size() - next, size_t(IOV_MAX)));
+    const ssize_t res = writev(file.fd, iov.data() + next, num_write);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    //  Skip past fully written buffers, and advance into a partially written one.
+    auto remaining = size_t(res);
+    while (next < iov.size() && remaining >= iov[next].iov_len) {
+      remaining -= iov[next++].iov_len;
+    }
+    if (remaining > 0) {
+      iov[next].iov_base = static_cast<unsigned char*>(iov[next].iov_base) + remaining;
+      iov[next].iov_len -= remaining;
+    }
+  }
+  return true;
+}
+
+bool close_write_file(WriteFile& file) {
+  const bool success = ::close(file.fd) == 0;
+  file.fd = -1;
+  return success;
+}
+
+bool replace_file(const char* src_path, const char* dst_path) {
+  return ::rename(src_path, dst_path) == 0;
+}
+
+void remove_file(const char* file_path) {
+  ::unlink(file_path);
+}
+
+#elif defined(GROVE_WIN)
+
+bool map_file(const char* file_path, MappedFile* out) {
+  MappedFile result{};
+  //  Share write and delete access, so that a snapshot that is open can still be appended to or
+  //  replaced.
+  result.file = CreateFileA(
+    file_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (result.file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(result.file, &size) || size.QuadPart == 0) {
+    CloseHandle(result.file);
+    return false;
+  }
+
+  result.mapping = CreateFileMappingA(result.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!result.mapping) {
+    CloseHandle(result.file);
+    return false;
+  }
+
+  result.data = static_cast<const unsigned char*>(
+    MapViewOfFile(result.mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!result.data) {
+    CloseHandle(result.mapping);
+    CloseHandle(result.file);
+    return false;
+  }
+
+  result.size = size_t(size.QuadPart);
+  *out = result;
+  return true;
+}
+
+void unmap_file(MappedFile& file) {
+  if (file.data) {
+    UnmapViewOfFile(file.data);
+    CloseHandle(file.mapping);
+    CloseHandle(file.file);
+  }
+  file = {};
+}
+
+struct WriteFile {
+  FILE* file{};
+};
+
+bool open_for_write(const char* file_path, bool append, WriteFile* out) {
+  FILE* file = fopen(file_path, append ? "ab" : "wb");
+  if (!file) {
+    return false;
+  }
+  out->file = file;
+  return true;
+}
+
+bool write_pieces(WriteFile& file, const std::vector<WritePiece>& pieces) {
+  for (auto& piece : pieces) {
+    if (fwrite(piece.data, 1, piece.size, file.file) != piece.size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool close_write_file(WriteFile& file) {
+  const bool success = fclose(file.file) == 0;
+  file.file = nullptr;
+  return success;
+}
+
+bool replace_file(const char* src_path, const char* dst_path) {
+  return MoveFileExA(src_path, dst_path, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+void remove_file(const char* file_path) {
+  DeleteFileA(file_path);
+}
+
+#else
+#error "Expected one of Unix or Windows for OS."
+#endif
+
+struct EntryKey {
+  struct Hash {
+    size_t operator()(const EntryKey& k) const noexcept {
+      return std::hash<uint64_t>{}(k.key * 31u + uint64_t(k.kind));
+    }
+  };
+
+  friend inline bool operator==(const EntryKey& a, const EntryKey& b) {
+    return a.kind == b.kind && a.key == b.key;
+  }
+
+  uint32_t kind;
+  uint64_t key;
+};
+
+} //  anon
+
+struct tree::Snapshot {
+  MappedFile file;
+  std::vector<SnapshotEntry> entries;
+};
+
+void tree::push_tree(SnapshotRecords& records, uint64_t key, const TreeNodeStore& nodes) {
+  auto record = make_record(SnapshotRecordKind::Tree, key);
+  push_array(record, nodes.internodes.data(), nodes.internodes.size());
+  push_array(record, nodes.buds.data(), nodes.buds.size());
+  records.records.push_back(record);
+}
+
+void tree::push_attraction_points(SnapshotRecords& records, uint64_t key,
+                                  const Vec3f* points, int64_t num_points) {
+  assert(num_points >= 0);
+  auto record = make_record(SnapshotRecordKind::AttractionPoints, key);
+  push_array(record, points, uint64_t(num_points));
+  records.records.push_back(record);
+}
+
+void tree::push_roots(SnapshotRecords& records, uint64_t key,
+                      const TreeRootNode* nodes, int num_nodes) {
+  assert(num_nodes >= 0);
+  auto record = make_record(SnapshotRecordKind::Roots, key);
+  push_array(record, nodes, uint64_t(num_nodes));
+  records.records.push_back(record);
+}
+
+void tree::push_vine(SnapshotRecords& records, uint64_t key, const VineNode* nodes, int num_nodes) {
+  assert(num_nodes >= 0);
+  auto record = make_record(SnapshotRecordKind::Vine, key);
+  push_array(record, nodes, uint64_t(num_nodes));
+  records.records.push_back(record);
+}
+
+void tree::push_removed(SnapshotRecords& records, SnapshotRecordKind kind, uint64_t key) {
+  auto record = make_record(kind, key);
+  record.removed = true;
+  records.records.push_back(record);
+}
+
+bool tree::write_snapshot(const SnapshotRecords& records, const char* file_path, bool append) {
+  if (!is_little_endian()) {
+    return false;
+  }
+
+  //  Appending requires the existing file to be a snapshot of the current version; determine the
+  //  extent of its valid records. Readers may have the file mapped, so it is only ever modified
+  //  by appending to it, which leaves their mappings intact; it is otherwise replaced by a new
+  //  file. If the existing file ends with an incomplete record, the new file begins with its valid
+  //  records, read from `existing`.
+  MappedFile existing{};
+  size_t valid_size{};
+  if (append) {
+    if (map_file(file_path, &existing)) {
+      if (is_valid_file_header(existing.data, existing.size)) {
+        valid_size = parse_records(existing.data, existing.size, [](auto&&...) {});
+      }
+    }
+    append = valid_size > 0;
+  }
+  const bool append_in_place = append && valid_size == existing.size;
+  if (!append || append_in_place) {
+    //  The existing records are not copied, so release the file before opening it for writing.
+    unmap_file(existing);
+  }
+
+  //  Headers are gathered into one buffer, reserved up front so that pieces may point into it.
+  //  Element data are written directly from their sources.
+  size_t headers_capacity = sizeof(FileHeader);
+  for (auto& record : records.records) {
+    headers_capacity += sizeof(RecordHeader) + record.num_arrays * sizeof(ArrayHeader);
+  }
+
+  std::vector<unsigned char> headers;
+  headers.reserve(headers_capacity);
+  std::vector<WritePiece> pieces;
+
+  auto push_header_bytes = [&](const void* data, size_t size) {
+    assert(headers.size() + size <= headers_capacity);
+    const size_t off = headers.size();
+    headers.resize(off + size);
+    memcpy(headers.data() + off, data, size);
+    pieces.push_back(WritePiece{headers.data() + off, size});
+  };
+  auto push_padding = [&](size_t size) {
+    if (size > 0) {
+      pieces.push_back(WritePiece{zero_padding, size});
+    }
+  };
+
+  if (!append) {
+    const auto header = make_file_header();
+    push_header_bytes(&header, sizeof(FileHeader));
+  } else if (!append_in_place) {
+    pieces.push_back(WritePiece{existing.data, valid_size});
+  }
+
+  for (auto& record : records.records) {
+    assert(record.removed ? record.num_arrays == 0 :
+           record.num_arrays == expected_num_arrays(record.kind));
+
+    RecordHeader header{};
+    header.magic = record_magic;
+    header.kind = uint32_t(record.kind);
+    header.key = record.key;
+    header.flags = record.removed ? record_removed : 0u;
+    header.num_arrays = uint32_t(record.num_arrays);
+
+    const size_t headers_size = sizeof(RecordHeader) + record.num_arrays * sizeof(ArrayHeader);
+    ArrayHeader arrays[SnapshotRecord::max_num_arrays]{};
+    size_t off = align_up(headers_size);
+    for (int i = 0; i < record.num_arrays; i++) {
+      auto& src = record.arrays[i];
+      arrays[i].offset = off;
+      arrays[i].count = src.count;
+      arrays[i].element_size = src.element_size;
+      off = align_up(off + size_t(src.count) * src.element_size);
+    }
+    header.size = off;
+
+    push_header_bytes(&header, sizeof(RecordHeader));
+    if (record.num_arrays > 0) {
+      push_header_bytes(arrays, record.num_arrays * sizeof(ArrayHeader));
+    }
+    push_padding(align_up(headers_size) - headers_size);
+
+    for (int i = 0; i < record.num_arrays; i++) {
+      auto& src = record.arrays[i];
+      const size_t size = size_t(src.count) * src.element_size;
+      if (size > 0) {
+        pieces.push_back(WritePiece{src.data, size});
+      }
+      push_padding(align_up(size) - size);
+    }
+  }
+
+  //  Otherwise, a new file is written next to `file_path`, then renamed over it.
+  const std::string tmp_path = std::string{file_path} + ".tmp";
+  const char* write_path = append_in_place ? file_path : tmp_path.c_str();
+
+  WriteFile file{};
+  bool success = open_for_write(write_path, append_in_place, &file);
+  if (success) {
+    const bool wrote = write_pieces(file, pieces);
+    success = close_write_file(file) && wrote;
+  }
+  unmap_file(existing);
+
+  if (!append_in_place) {
+    if (success) {
+      success = replace_file(tmp_path.c_str(), file_path);
+    }
+    if (!success) {
+      remove_file(tmp_path.c_str());
+    }
+  }
+  return success;
+}
+
+Snapshot* tree::open_snapshot(const char* file_path) {
+  if (!is_little_endian()) {
+    return nullptr;
+  }
+
+  MappedFile file{};
+  if (!map_file(file_path, &file)) {
+    return nullptr;
+  }
+  if (!is_valid_file_header(file.data, file.size)) {
+    unmap_file(file);
+    return nullptr;
+  }
+
+  std::vector<SnapshotEntry> entries;
+  std::vector<bool> removed;
+  std::unordered_map<EntryKey, int, EntryKey::Hash> entry_indices;
+  bool valid_layout{true};
+
+  parse_records(file.data, file.size, [&](const RecordHeader& header, const ArrayHeader* arrays,
+                                          const unsigned char* record) {
+    const auto kind = SnapshotRecordKind(header.kind);
+    const bool is_removed = header.flags & record_removed;
+    if (expected_element_size(kind, 0) == 0) {
+      //  Unknown kind of record.
+      return;
+    }
+
+    SnapshotEntry entry{};
+    entry.kind = kind;
+    entry.key = header.key;
+    if (!is_removed) {
+      if (int(header.num_arrays) != expected_num_arrays(kind)) {
+        valid_layout = false;
+        return;
+      }
+      entry.num_arrays = int(header.num_arrays);
+      for (int i = 0; i < entry.num_arrays; i++) {
+        valid_layout = valid_layout && arrays[i].element_size == expected_element_size(kind, i);
+        entry.arrays[i] = record + arrays[i].offset;
+        entry.counts[i] = arrays[i].count;
+      }
+    }
+
+    const EntryKey key{header.kind, header.key};
+    if (auto it = entry_indices.find(key); it != entry_indices.end()) {
+      entries[it->second] = entry;
+      removed[it->second] = is_removed;
+    } else if (!is_removed) {
+      entry_indices[key] = int(entries.size());
+      entries.push_back(entry);
+      removed.push_back(false);
+    }
+  });
+
+  if (!valid_layout) {
+    unmap_file(file);
+    return nullptr;
+  }
+
+  auto* result = new Snapshot();
+  result->file = file;
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (!removed[i]) {
+      result->entries.push_back(entries[i]);
+    }
+  }
+  return result;
+}
+
+void tree::close_snapshot(Snapshot** snapshot) {
+  if (*snapshot) {
+    unmap_file((*snapshot)->file);
+    delete *snapshot;
+    *snapshot = nullptr;
+  }
+}
+
+ArrayView<const SnapshotEntry> tree::read_entries(const Snapshot* snapshot) {
+  return make_view(snapshot->entries);
+}
+
+namespace {
+
+template <typename T>
+ArrayView<const T> read_array(const SnapshotEntry& entry, int index) {
+  assert(index < entry.num_arrays);
+  auto* beg = reinterpret_cast<const T*>(entry.arrays[index]);
+  return ArrayView<const T>{beg, beg + entry.counts[index]};
+}
+
+} //  anon
+
+ArrayView<const Internode> tree::read_internodes(const SnapshotEntry& entry) {
+  assert(entry.kind == SnapshotRecordKind::Tree);
+  return read_array<Internode>(entry, 0);
+}
+
+ArrayView<const Bud> tree::read_buds(const SnapshotEntry& entry) {
+  assert(entry.kind == SnapshotRecordKind::Tree);
+  return read_array<Bud>(entry, 1);
+}
+
+ArrayView<const Vec3f> tree::read_attraction_points(const SnapshotEntry& entry) {
+  assert(entry.kind == SnapshotRecordKind::AttractionPoints);
+  return read_array<Vec3f>(entry, 0);
+}
+
+ArrayView<const TreeRootNode> tree::read_roots(const SnapshotEntry& entry) {
+  assert(entry.kind == SnapshotRecordKind::Roots);
+  return read_array<TreeRootNode>(entry, 0);
+}
+
+ArrayView<const VineNode> tree::read_vine_nodes(const SnapshotEntry& entry) {
+  assert(entry.kind == SnapshotRecordKind::Vine);
+  return read_array<VineNode>(entry, 0);
+}
+
+TreeNodeStore tree::to_tree_node_store(const SnapshotEntry& entry) {
+  auto internodes = read_internodes(entry);
+  auto buds = read_buds(entry);
+
+  TreeNodeStore result;
+  result.id = TreeID::create();
+  result.internodes.assign(internodes.begin(), internodes.end());
+  result.buds.assign(buds.begin(), buds.end());
+  for (auto& node : result.internodes) {
+    node.id = TreeInternodeID::create();
+  }
+  for (auto& bud : result.buds) {
+    bud.id = TreeBudID::create();
+  }
+  return result;
+}
+
+GROVE_NAMESPACE_END
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "components.hpp"
+#include "grove/common/ArrayView.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace grove::tree {
+
+struct TreeRootNode;
+struct VineNode;
+
+/*
+ * Snapshot
+ *
+ * Versioned, chunked binary format for scenes of trees, attraction points, roots and vines. A
+ * file holds a header followed by a sequence of records. Each record identifies a scene object by
+ * kind and key, and holds up to `max_num_arrays` arrays of trivially copyable elements. Data are
+ * little-endian and every array is 16-byte aligned within the file, so a snapshot opened with
+ * `open_snapshot` is read in place from a memory-mapped file.
+ *
+ * Records can be appended to an existing snapshot. When several records share a kind and key, the
+ * last one wins, and a `removed` record deletes the object. Writing only the objects that changed
+ * since the last save is therefore an incremental save; rewriting the whole scene compacts the
+ * file.
+ */
+
+enum class SnapshotRecordKind : uint32_t {
+  Tree = 1,
+  AttractionPoints,
+  Roots,
+  Vine,
+};
+
+struct SnapshotArray {
+  const void* data;
+  uint32_t element_size;
+  uint64_t count;
+};
+
+struct SnapshotRecord {
+  static constexpr int max_num_arrays = 2;
+
+  SnapshotRecordKind kind;
+  uint64_t key;
+  bool removed;
+  int num_arrays;
+  SnapshotArray arrays[max_num_arrays];
+};
+
+//  Records reference the arrays of their source objects, which must remain unmodified until the
+//  records are written.
+struct SnapshotRecords {
+  std::vector<SnapshotRecord> records;
+};
+
+void push_tree(SnapshotRecords& records, uint64_t key, const TreeNodeStore& nodes);
+void push_attraction_points(SnapshotRecords& records, uint64_t key,
+                            const Vec3f* points, int64_t num_points);
+void push_roots(SnapshotRecords& records, uint64_t key, const TreeRootNode* nodes, int num_nodes);
+void push_vine(SnapshotRecords& records, uint64_t key, const VineNode* nodes, int num_nodes);
+void push_removed(SnapshotRecords& records, SnapshotRecordKind kind, uint64_t key);
+
+//  If `append` is true and `file_path` is an existing snapshot, the records are appended to it;
+//  otherwise the file is replaced. Snapshots that are open remain valid: the file is never
+//  truncated or overwritten in place, but replaced by renaming a new file over it.
+bool write_snapshot(const SnapshotRecords& records, const char* file_path, bool append = false);
+
+struct Snapshot;
+
+struct SnapshotEntry {
+  SnapshotRecordKind kind;
+  uint64_t key;
+  int num_arrays;
+  const unsigned char* arrays[SnapshotRecord::max_num_arrays];
+  uint64_t counts[SnapshotRecord::max_num_arrays];
+};
+
+//  Returns null if the file cannot be mapped, or is not a snapshot of the current version.
+Snapshot* open_snapshot(const char* file_path);
+void close_snapshot(Snapshot** snapshot);
+
+//  Latest record of each object that has not been removed, in order of first appearance. Views
+//  remain valid until the snapshot is closed.
+ArrayView<const SnapshotEntry> read_entries(const Snapshot* snapshot);
+
+ArrayView<const Internode> read_internodes(const SnapshotEntry& entry);
+ArrayView<const Bud> read_buds(const SnapshotEntry& entry);
+ArrayView<const Vec3f> read_attraction_points(const SnapshotEntry& entry);
+ArrayView<const TreeRootNode> read_roots(const SnapshotEntry& entry);
+ArrayView<const VineNode> read_vine_nodes(const SnapshotEntry& entry);
+
+//  Copies the nodes of a tree entry, assigning new ids as `deserialize` does.
+TreeNodeStore to_tree_node_store(const SnapshotEntry& entry);
+
+}
@@ -0,0 +1,195 @@
+#include "vk-app/procedural_tree/growth.hpp"
+#include "vk-app/procedural_tree/attraction_points.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/math/constants.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace grove;
+using namespace grove::tree;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_trees = 128;
+  static constexpr int trees_per_row = 16;
+  static constexpr float tree_spacing = 24.0f;
+  static constexpr float tree_scale = 10.0f;
+  static constexpr int num_points = 2000;
+  static constexpr int max_num_internodes = 512;
+  static constexpr float initial_attraction_point_span_size = 512.0f;
+  static constexpr float max_attraction_point_span_size_split = 4.0f;
+};
+
+struct BenchTree {
+  TreeNodeStore nodes;
+  SpawnInternodeParams spawn_params;
+  DistributeBudQParams bud_q_params;
+  std::vector<Vec3f> attraction_points;
+};
+
+//  The default lateral bud direction is random; derive it from the parent's position instead, so
+//  that results can be compared across runs.
+Vec3f lateral_bud_direction(const Internode& parent, const Vec3f&) {
+  const auto& p = parent.position;
+  const float h = std::abs(p.x * 12.9898f + p.y * 37.719f + p.z * 78.233f);
+  const float theta = (h - std::floor(h)) * 2.0f * pif();
+  return normalize(Vec3f{std::cos(theta), 0.0f, std::sin(theta)});
+}
+
+std::vector<BenchTree> make_trees() {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+  std::vector<BenchTree> result(Config::num_trees);
+  for (int i = 0; i < Config::num_trees; i++) {
+    auto& tree = result[i];
+    const auto ori = Vec3f{
+      float(i % Config::trees_per_row) * Config::tree_spacing,
+      0.0f,
+      float(i / Config::trees_per_row) * Config::tree_spacing};
+
+    tree.spawn_params = SpawnInternodeParams::make_debug(Config::tree_scale);
+    tree.spawn_params.lateral_bud_direction_func = lateral_bud_direction;
+    tree.bud_q_params = DistributeBudQParams::make_debug();
+    tree.nodes = make_tree_node_store(ori, tree.spawn_params);
+
+    //  As `points::uniform_cylinder_to_hemisphere`, with a seeded generator.
+    const auto scale = Vec3f{2.0f, 4.0f, 2.0f} * Config::tree_scale;
+    while (int(tree.attraction_points.size()) < Config::num_points) {
+      auto p = Vec3f{dis(gen), dis(gen), dis(gen)};
+      if (p.length() > 1.0f) {
+        continue;
+      }
+      if (p.y < 0.0f) {
+        auto neg_factor = std::pow(1.0f - std::abs(p.y), 4.0f);
+        p.x *= neg_factor;
+        p.z *= neg_factor;
+      } else {
+        p.y *= 0.5f;
+      }
+      p.y = p.y * 0.5f + 0.5f;
+      tree.attraction_points.push_back(p * scale + ori);
+    }
+  }
+  return result;
+}
+
+struct RunResult {
+  std::vector<BenchTree> trees;
+  double elapsed_ms;
+  int num_internodes;
+};
+
+RunResult run(const std::vector<BenchTree>& src, TaskPool* pool) {
+  RunResult result{};
+  result.trees = src;
+
+  std::vector<MakeAttractionPoints> make_points;
+  make_points.reserve(result.trees.size());
+  for (auto& tree : result.trees) {
+    make_points.emplace_back() = [&tree](Vec3f* dst, int max_num) {
+      int ct{};
+      for (auto& p : tree.attraction_points) {
+        if (ct < max_num) {
+          dst[ct++] = p;
+        }
+      }
+      return ct;
+    };
+  }
+
+  std::vector<GrowableTree> growable;
+  for (size_t i = 0; i < result.trees.size(); i++) {
+    auto& tree = result.trees[i];
+    growable.push_back(make_growable_tree(
+      &tree.nodes, &tree.spawn_params, &tree.bud_q_params,
+      &make_points[i], Config::max_num_internodes));
+  }
+
+  std::vector<Vec3f> points_buffer(Config::num_points);
+  EnvironmentInputs environment_input;
+  SenseContext sense_context;
+  AttractionPoints attraction_points{
+    Config::initial_attraction_point_span_size,
+    Config::max_attraction_point_span_size_split
+  };
+
+  GrowthContext context{};
+  context.trees = make_data_array_view<GrowableTree>(growable);
+  context.attraction_points_buffer = make_data_array_view<Vec3f>(points_buffer);
+  context.environment_input = &environment_input;
+  context.attraction_points = &attraction_points;
+  context.sense_context = &sense_context;
+  context.task_pool = pool;
+
+  auto t0 = Clock::now();
+  (void) tree::grow(&context);
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+  for (auto& tree : result.trees) {
+    result.num_internodes += int(tree.nodes.internodes.size());
+  }
+  return result;
+}
+
+bool equal(const std::vector<BenchTree>& a, const std::vector<BenchTree>& b) {
+  for (size_t i = 0; i < a.size(); i++) {
+    auto& nodes_a = a[i].nodes.internodes;
+    auto& nodes_b = b[i].nodes.internodes;
+    if (nodes_a.size() != nodes_b.size()) {
+      return false;
+    }
+    for (size_t j = 0; j < nodes_a.size(); j++) {
+      auto& na = nodes_a[j];
+      auto& nb = nodes_b[j];
+      //  Ids are unique but depend on the order in which trees are spawned.
+      if (na.parent != nb.parent ||
+          na.medial_child != nb.medial_child ||
+          na.lateral_child != nb.lateral_child ||
+          na.position != nb.position ||
+          na.render_position != nb.render_position ||
+          na.direction != nb.direction ||
+          na.diameter != nb.diameter) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} //  anon
+
+int main(int, char**) {
+  const auto trees = make_trees();
+  const auto serial = run(trees, nullptr);
+
+  std::cout << Config::num_trees << " trees; "
+            << serial.num_internodes << " internodes; "
+            << "serial: " << serial.elapsed_ms << "ms"
+            << std::endl;
+
+  const int max_num_threads = std::max(1, int(std::thread::hardware_concurrency()));
+  bool all_equal{true};
+  for (int num_threads = 1; num_threads <= max_num_threads; num_threads *= 2) {
+    TaskPool pool;
+    pool.start(num_threads - 1);
+    const auto res = run(trees, &pool);
+    const bool same = equal(serial.trees, res.trees);
+    all_equal = all_equal && same;
+
+    std::cout << num_threads << " thread(s): " << res.elapsed_ms << "ms"
+              << "; trees/s: " << double(Config::num_trees) / (res.elapsed_ms * 1e-3)
+              << "; speedup: " << serial.elapsed_ms / res.elapsed_ms << "x"
+              << "; matches serial: " << (same ? "yes" : "no")
+              << std::endl;
+  }
+
+  return all_equal ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+#include "vk-app/procedural_tree/node_mesh.hpp"
+#include "vk-app/procedural_tree/render.hpp"
+#include "vk-app/procedural_flower/geometry.hpp"
+#include "grove/common/FrameArena.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/math/constants.hpp"
+#include "grove/math/frame.hpp"
+#include "grove/math/util.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace grove;
+using namespace grove::tree;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  //  Node meshes use 16-bit indices, so a 5x2 grid allows at most 6553 internodes.
+  static constexpr uint32_t num_internodes = 6000;
+  static constexpr int grid_x = 5;
+  static constexpr int grid_z = 2;
+  static constexpr int num_repeats = 50;
+};
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < Config::num_repeats; i++) {
+    f();
+  }
+  auto t = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return t / double(Config::num_repeats);
+}
+
+//  Random tree in the same depth-first order as grown trees, so that children follow their parent.
+std::vector<Internode> make_tree(uint32_t num_internodes, uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+  std::vector<Internode> result;
+  Internode root{};
+  root.direction = ConstVec3f::positive_y;
+  root.length = 1.0f;
+  root.diameter = 1.0f;
+  result.push_back(root);
+
+  std::vector<int> pending{0};
+  while (!pending.empty() && result.size() < num_internodes) {
+    const int self = pending.back();
+    pending.pop_back();
+    for (int c = 0; c < 2 && result.size() < num_internodes; c++) {
+      const bool lateral = c == 1;
+      //  Axes never end near the root, so that the tree cannot die out early.
+      const bool end_axis = gen() % 16 == 0 && result.size() > 64;
+      if (lateral ? gen() % 3 != 0 : end_axis) {
+        continue;
+      }
+      auto parent = result[self];
+      Internode child{};
+      child.parent = self;
+      child.render_position = parent.render_tip_position();
+      child.position = child.render_position;
+      const float spread = lateral ? 1.0f : 0.25f;
+      child.direction = normalize(
+        parent.direction + Vec3f{dis(gen), dis(gen), dis(gen)} * spread);
+      child.length = 1.0f;
+      child.diameter = parent.diameter * (lateral ? 0.7f : 0.98f);
+      const int ci = int(result.size());
+      (lateral ? result[self].lateral_child : result[self].medial_child) = ci;
+      result.push_back(child);
+      pending.push_back(ci);
+    }
+  }
+  return result;
+}
+
+/*
+ * Legacy
+ *
+ * Per-vertex evaluation of the shape function and node frames, as before the ring table.
+ */
+
+namespace legacy {
+
+Vec3f shape_function(const Vec2f& p, const Vec2f& num_points_xz) {
+  float x_dim = std::floor(num_points_xz.x * 0.5f);
+  float x_ind = p.x == x_dim ? 0.0f : p.x + x_dim;
+  float theta = (2.0f * pif()) * (x_ind / (num_points_xz.x - 1.0f));
+  float y = p.y / (num_points_xz.y - 1.0f);
+  return Vec3f{std::cos(theta), y, std::sin(theta)};
+}
+
+Vec3f mat3_mul_vec3(const Vec3f& i, const Vec3f& j, const Vec3f& k, const Vec3f& v) {
+  return i * v.x + j * v.y + k * v.z;
+}
+
+void make_node_mesh(const Internode* internodes, uint32_t num_internodes,
+                    const Vec2<int>& geom_sizes_xz, float* out_v, uint16_t* out_i) {
+  const auto [npx, npz] = geom_sizes_xz;
+  const Vec2f num_points_xz{float(npx), float(npz)};
+  auto grid = make_reflected_grid_indices(npx, npz);
+  auto grid_indices = triangulate_reflected_grid(npx, npz);
+  const size_t num_grid_verts = grid.size() / 2;
+
+  size_t vi{};
+  for (uint32_t ni = 0; ni < num_internodes; ni++) {
+    auto& node = internodes[ni];
+    auto child = get_child_render_data(node, internodes, true, 0.0f);
+    for (auto ind : grid_indices) {
+      *out_i++ = uint16_t(ind + vi);
+    }
+
+    Vec3f is, js, ks, ic, jc, kc;
+    make_coordinate_system_y(spherical_to_cartesian(node.spherical_direction()), &is, &js, &ks);
+    make_coordinate_system_y(spherical_to_cartesian(child.direction), &ic, &jc, &kc);
+    const float radius = node.diameter * 0.5f;
+
+    for (size_t i = 0; i < num_grid_verts; i++) {
+      Vec3f s = shape_function(Vec2f{grid[i * 2], grid[i * 2 + 1]}, num_points_xz);
+      const float y = s.y;
+      Vec3f s0 = Vec3f{s.x, 0.0, s.z};
+      Vec3f s0n = normalize(s0);
+      Vec3f n = lerp(y, normalize(mat3_mul_vec3(is, js, ks, s0n)),
+                     normalize(mat3_mul_vec3(ic, jc, kc, s0n)));
+      if (n.length() == 0.0f) {
+        n = ConstVec3f::positive_y;
+      }
+      Vec3f p_base = mat3_mul_vec3(is, js, ks, s0 * Vec3f{radius, 1.0f, radius}) +
+                     node.render_position;
+      Vec3f p_tip = mat3_mul_vec3(ic, jc, kc, s0 * Vec3f{child.radius, 1.0f, child.radius}) +
+                    child.position;
+      Vec3f p = lerp(y, p_base, p_tip);
+      for (int j = 0; j < 3; j++) {
+        *out_v++ = p[j];
+      }
+      for (int j = 0; j < 3; j++) {
+        *out_v++ = n[j];
+      }
+      *out_v++ = 0.0f;
+      *out_v++ = 0.0f;
+    }
+    vi += num_grid_verts;
+  }
+}
+
+} //  legacy
+
+template <typename T>
+uint32_t count_mismatches(const std::vector<T>& a, const std::vector<T>& b) {
+  uint32_t result{};
+  for (size_t i = 0; i < a.size(); i++) {
+    result += uint32_t(std::memcmp(&a[i], &b[i], sizeof(T)) != 0);
+  }
+  return result;
+}
+
+} //  anon
+
+int main(int, char**) {
+  auto nodes = make_tree(Config::num_internodes, 1);
+  const auto num_nodes = uint32_t(nodes.size());
+  const Vec2<int> grid_xz{Config::grid_x, Config::grid_z};
+  const size_t num_verts = compute_num_vertices_in_node_mesh(grid_xz, num_nodes);
+  const size_t num_inds = compute_num_indices_in_node_mesh(grid_xz, num_nodes);
+
+  TaskPool pool;
+  pool.start(TaskPool::default_num_worker_threads());
+  FrameArena arena;
+
+  std::vector<float> legacy_v(num_verts * 8);
+  std::vector<uint16_t> legacy_i(num_inds);
+  const double legacy_ms = time_ms([&]() {
+    legacy::make_node_mesh(nodes.data(), num_nodes, grid_xz, legacy_v.data(), legacy_i.data());
+  });
+
+  MakeNodeMeshParams params{};
+  params.arena = &arena;
+  std::vector<float> serial_v(num_verts * 8);
+  std::vector<uint16_t> serial_i(num_inds);
+  const double serial_ms = time_ms([&]() {
+    make_node_mesh(nodes.data(), num_nodes, grid_xz, params, serial_v.data(), serial_i.data());
+    arena.reset();
+  });
+
+  params.task_pool = &pool;
+  std::vector<float> parallel_v(num_verts * 8);
+  std::vector<uint16_t> parallel_i(num_inds);
+  const double parallel_ms = time_ms([&]() {
+    make_node_mesh(nodes.data(), num_nodes, grid_xz, params, parallel_v.data(), parallel_i.data());
+    arena.reset();
+  });
+
+  std::vector<Mat3f> serial_frames(num_nodes);
+  std::vector<Mat3f> parallel_frames(num_nodes);
+  const double serial_frames_ms = time_ms([&]() {
+    compute_internode_frames(nodes.data(), int(num_nodes), serial_frames.data());
+  });
+  const double parallel_frames_ms = time_ms([&]() {
+    compute_internode_frames(nodes.data(), int(num_nodes), parallel_frames.data(), &pool);
+  });
+
+  const uint32_t num_mesh_mismatch =
+    count_mismatches(legacy_v, serial_v) + count_mismatches(legacy_i, serial_i) +
+    count_mismatches(legacy_v, parallel_v) + count_mismatches(legacy_i, parallel_i);
+  const uint32_t num_frame_mismatch = count_mismatches(serial_frames, parallel_frames);
+
+  std::cout << num_nodes << " internodes; " << pool.num_workers() << " workers" << std::endl;
+  std::cout << "node mesh; legacy: " << legacy_ms << "ms; serial: " << serial_ms
+            << "ms; parallel: " << parallel_ms << "ms; mismatches: " << num_mesh_mismatch
+            << std::endl;
+  std::cout << "frames; serial: " << serial_frames_ms << "ms; parallel: " << parallel_frames_ms
+            << "ms; mismatches: " << num_frame_mismatch << std::endl;
+
+  pool.stop();
+  return num_mesh_mismatch == 0 && num_frame_mismatch == 0 ? 0 : 1;
+}
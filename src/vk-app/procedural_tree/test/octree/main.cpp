@@ -1,8 +1,10 @@
 #include "../../attraction_points.hpp"
 #include "../../components.hpp"
 #include "grove/math/random.hpp"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <tuple>
 
 using namespace grove;
 using namespace grove::tree;
@@ -382,6 +384,169 @@ void test_new_attraction_point() {
   printf("OK.\n");
 }
 
+struct SphereQueries {
+  std::vector<Vec3f> centers;
+  std::vector<float> radii;
+};
+
+//  Bud-like queries: small spheres clustered around a few tree origins. Spheres of the same tree
+//  are ordered along a coarse grid, such that consecutive spheres tend to be close together, as are
+//  consecutive buds of a tree.
+SphereQueries make_sphere_queries(const std::vector<Vec3f>& origins, int num_per_origin,
+                                  float tree_scale) {
+  SphereQueries result;
+  const auto scl = Vec3f{2.0f, 4.0f, 2.0f} * tree_scale;
+  for (auto& ori : origins) {
+    auto cs = points::uniform_cylinder_to_hemisphere(num_per_origin, scl, ori);
+    auto cell = [&](const Vec3f& p) {
+      auto c = floor((p - ori) / tree_scale);
+      return std::make_tuple(c.y, c.z, c.x);
+    };
+    std::sort(cs.begin(), cs.end(), [&](const Vec3f& a, const Vec3f& b) {
+      return cell(a) < cell(b);
+    });
+    for (auto& c : cs) {
+      result.centers.push_back(c);
+      result.radii.push_back(0.6f * tree_scale);
+    }
+  }
+  return result;
+}
+
+std::vector<Vec3f> collect_positions(AttractionPoints& oct, const Vec3f& c, float r) {
+  std::vector<Vec3f> result;
+  oct.map_over_sphere([&result](auto* node) {
+    if (node->data.is_active()) {
+      result.push_back(node->data.position);
+    }
+  }, c, r);
+  std::sort(result.begin(), result.end(), Vec3f::Less{});
+  return result;
+}
+
+void test_packed() {
+  const float tree_scale = 10.0f;
+  const std::vector<Vec3f> origins{Vec3f{}, Vec3f{24.0f, 0.0f, 0.0f}, Vec3f{0.0f, 0.0f, -40.0f}};
+
+  auto oct = make_default_oct();
+  std::vector<Vec3f> inserted;
+  for (auto& ori : origins) {
+    auto ps = high_above_ground_attraction_points(int(1e4), ori, tree_scale);
+    for (int i : insert_into(oct, ps, 1u)) {
+      inserted.push_back(ps[i]);
+    }
+  }
+
+  const auto queries = make_sphere_queries(origins, 64, tree_scale);
+  const int num_queries = int(queries.centers.size());
+  std::vector<std::vector<Vec3f>> expect(num_queries);
+  for (int i = 0; i < num_queries; i++) {
+    expect[i] = collect_positions(oct, queries.centers[i], queries.radii[i]);
+  }
+
+  const auto num_nodes = oct.num_nodes();
+  assert(!oct.is_packed());
+  oct.pack();
+  assert(oct.is_packed() && oct.num_nodes() == num_nodes);
+  oct.validate();
+  for (auto& p : inserted) {
+    assert(oct.find(p));
+  }
+
+  std::vector<std::vector<Vec3f>> batched(num_queries);
+  oct.map_over_spheres(
+    queries.centers.data(), queries.radii.data(), num_queries, [&batched](int i, auto* node) {
+      if (node->data.is_active()) {
+        batched[i].push_back(node->data.position);
+      }
+    });
+
+  for (int i = 0; i < num_queries; i++) {
+    assert(collect_positions(oct, queries.centers[i], queries.radii[i]) == expect[i]);
+    std::sort(batched[i].begin(), batched[i].end(), Vec3f::Less{});
+    assert(batched[i] == expect[i]);
+  }
+
+  //  Adding nodes reverts to the unpacked layout.
+  auto more_ps = high_above_ground_attraction_points(100, origins[0], tree_scale);
+  insert_into(oct, more_ps, 2u);
+  assert(!oct.is_packed());
+  oct.validate();
+  for (auto& p : inserted) {
+    assert(oct.find(p));
+  }
+
+  printf("OK.\n");
+}
+
+void profile_queries() {
+  using Clock = std::chrono::high_resolution_clock;
+  using Duration = std::chrono::duration<double>;
+
+  const float tree_scale = 10.0f;
+  const int num_trees = 20;
+  const int num_queries_per_tree = 2000;
+  constexpr int batch_size = 64;
+
+  std::vector<Vec3f> origins;
+  for (int i = 0; i < num_trees; i++) {
+    origins.push_back(random_tree_origin(Vec3f{32.0f, 0.0f, -32.0f}));
+  }
+
+  auto oct = make_default_oct();
+  for (auto& ori : origins) {
+    insert_into(oct, high_above_ground_attraction_points(int(1e4), ori, tree_scale), 1u);
+  }
+
+  const auto queries = make_sphere_queries(origins, num_queries_per_tree, tree_scale);
+  const int num_queries = int(queries.centers.size());
+
+  auto report = [num_queries](const char* name, Duration elapsed, uint64_t num_visited) {
+    printf("%s: %0.2fms; %0.0f queries/s; %llu leaves visited\n",
+           name, elapsed.count() * 1e3, double(num_queries) / elapsed.count(),
+           (unsigned long long) num_visited);
+  };
+
+  uint64_t num_visited{};
+  auto count_leaf = [&num_visited](auto* node) {
+    num_visited += node->data.is_active() ? 1 : 0;
+  };
+
+  //  The visitor as it was before `map_over_sphere` was templated.
+  const AttractionPoints::MapFunction std_function_visitor = count_leaf;
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_queries; i++) {
+    oct.map_over_sphere(std_function_visitor, queries.centers[i], queries.radii[i]);
+  }
+  report("std::function, unpacked", Clock::now() - t0, num_visited);
+
+  num_visited = 0;
+  t0 = Clock::now();
+  for (int i = 0; i < num_queries; i++) {
+    oct.map_over_sphere(count_leaf, queries.centers[i], queries.radii[i]);
+  }
+  report("inline, unpacked", Clock::now() - t0, num_visited);
+
+  oct.pack();
+  num_visited = 0;
+  t0 = Clock::now();
+  for (int i = 0; i < num_queries; i++) {
+    oct.map_over_sphere(count_leaf, queries.centers[i], queries.radii[i]);
+  }
+  report("inline, packed", Clock::now() - t0, num_visited);
+
+  num_visited = 0;
+  t0 = Clock::now();
+  for (int i = 0; i < num_queries; i += batch_size) {
+    const int n = std::min(batch_size, num_queries - i);
+    oct.map_over_spheres(
+      queries.centers.data() + i, queries.radii.data() + i, n, [&count_leaf](int, auto* node) {
+        count_leaf(node);
+      });
+  }
+  report("batched, packed", Clock::now() - t0, num_visited);
+}
+
 } //  anon
 
 int main(int, char**) {
@@ -393,6 +558,8 @@ int main(int, char**) {
   test_reinsert();
   profile_example();
   profile_several_origins();
+  test_packed();
+  profile_queries();
   return 0;
 }
 
@@ -0,0 +1,364 @@
+#include "../../radius_limiter.hpp"
+#include "grove/common/SlotLists.hpp"
+#include "grove/math/bounds.hpp"
+#include "grove/math/intersect.hpp"
+#include "grove/math/util.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace grove;
+using namespace grove::bounds;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_chains = 2048;
+  static constexpr int num_nodes_per_chain = 64;
+  static constexpr float region_size = 256.0f;
+  static constexpr float node_length = 1.0f;
+  static constexpr float initial_radius = 0.025f;
+  static constexpr int num_growth_steps = 8;
+  static constexpr float radius_increment = 0.05f;
+};
+
+/*
+ * Cell table used by RadiusLimiter before it was replaced by the open-addressed Morton table:
+ * an `unordered_map` keyed by cell coordinates hashed as `x ^ y ^ z`, with a linked list of
+ * element indices per cell. Only insertion and expansion are reproduced.
+ */
+
+struct LegacyRadiusLimiter {
+  struct Key {
+    friend inline bool operator==(const Key& a, const Key& b) {
+      return a.i == b.i;
+    }
+
+    Vec3<int16_t> i;
+  };
+
+  struct HashKey {
+    size_t operator()(const Key& key) const noexcept {
+      return size_t(key.i.x ^ key.i.y ^ key.i.z);
+    }
+  };
+
+  Vec3<int16_t> pow2_cell_dims{3};
+  float expand_factor{2.0f};
+
+  std::vector<RadiusLimiterElement> elements;
+  SlotLists<int> element_indices;
+  std::vector<SlotLists<int>::List> cells;
+  std::unordered_map<Key, int, HashKey> cell_indices;
+};
+
+Bounds3<int16_t> cell_index_span(const OBB3f& obb, const Vec3<int16_t>& pow2_cell_dims) {
+  const auto aabb = obb3_to_aabb(obb);
+  Vec3f dims;
+  for (int i = 0; i < 3; i++) {
+    dims[i] = std::pow(2.0f, float(pow2_cell_dims[i]));
+  }
+  auto p0 = floor(aabb.min / dims);
+  auto p1 = floor(aabb.max / dims);
+  auto p1_eq = p1 * dims;
+  Vec3<int16_t> p1_off{p1_eq.x == aabb.max.x, p1_eq.y == aabb.max.y, p1_eq.z == aabb.max.z};
+  Vec3<int16_t> p1i{int16_t(p1.x), int16_t(p1.y), int16_t(p1.z)};
+  return Bounds3<int16_t>{
+    Vec3<int16_t>{int16_t(p0.x), int16_t(p0.y), int16_t(p0.z)},
+    p1i - p1_off
+  };
+}
+
+void insert_index(LegacyRadiusLimiter& lim, const Vec3<int16_t>& ijk, int el_index) {
+  const auto key = LegacyRadiusLimiter::Key{ijk};
+  auto it = lim.cell_indices.find(key);
+  int cell;
+  if (it == lim.cell_indices.end()) {
+    cell = int(lim.cells.size());
+    lim.cells.emplace_back();
+    lim.cell_indices[key] = cell;
+  } else {
+    cell = it->second;
+  }
+  lim.cells[cell] = lim.element_indices.insert(lim.cells[cell], el_index);
+}
+
+RadiusLimiterElementHandle insert(LegacyRadiusLimiter& lim, RadiusLimiterElement el) {
+  el.radius *= lim.expand_factor;
+  const auto span = cell_index_span(el.to_obb(el.radius), lim.pow2_cell_dims);
+  const int el_index = int(lim.elements.size());
+  lim.elements.push_back(el);
+  for (int16_t i = span.min.x; i <= span.max.x; i++) {
+    for (int16_t j = span.min.y; j <= span.max.y; j++) {
+      for (int16_t k = span.min.z; k <= span.max.z; k++) {
+        insert_index(lim, Vec3<int16_t>{i, j, k}, el_index);
+      }
+    }
+  }
+  return RadiusLimiterElementHandle{el_index};
+}
+
+float expand(LegacyRadiusLimiter& lim, RadiusLimiterElementHandle handle, float target_radius) {
+  auto& el = lim.elements[handle.index];
+  if (el.radius >= target_radius || el.reached_maximum_radius) {
+    return std::min(el.radius, target_radius);
+  }
+
+  const auto curr_span = cell_index_span(el.to_obb(el.radius), lim.pow2_cell_dims);
+  float expand = lim.expand_factor;
+  auto new_obb = el.to_obb(target_radius * expand);
+  auto new_span = cell_index_span(new_obb, lim.pow2_cell_dims);
+
+  for (int16_t i = new_span.min.x; i <= new_span.max.x; i++) {
+    for (int16_t j = new_span.min.y; j <= new_span.max.y; j++) {
+      for (int16_t k = new_span.min.z; k <= new_span.max.z; k++) {
+        auto cell_it = lim.cell_indices.find(LegacyRadiusLimiter::Key{Vec3<int16_t>{i, j, k}});
+        if (cell_it == lim.cell_indices.end()) {
+          continue;
+        }
+        auto it = lim.element_indices.cbegin(lim.cells[cell_it->second]);
+        for (; it != lim.element_indices.cend(); ++it) {
+          auto& query_el = lim.elements[*it];
+          if (query_el.aggregate_id == el.aggregate_id) {
+            continue;
+          }
+          auto query_obb = query_el.to_obb(query_el.radius);
+          int step{};
+          while (expand > 1.0f && step < 32 && obb_obb_intersect(query_obb, new_obb)) {
+            expand = lerp(0.5f, 1.0f, expand);
+            new_obb = el.to_obb(target_radius * expand);
+            ++step;
+          }
+        }
+      }
+    }
+  }
+
+  el.radius = target_radius * expand;
+  if (expand < lim.expand_factor) {
+    el.reached_maximum_radius = true;
+  }
+
+  new_span = cell_index_span(new_obb, lim.pow2_cell_dims);
+  for (int16_t i = new_span.min.x; i <= new_span.max.x; i++) {
+    for (int16_t j = new_span.min.y; j <= new_span.max.y; j++) {
+      for (int16_t k = new_span.min.z; k <= new_span.max.z; k++) {
+        const Vec3<int16_t> ijk{i, j, k};
+        if (any(lt(ijk, curr_span.min)) || any(gt(ijk, curr_span.max))) {
+          insert_index(lim, ijk, handle.index);
+        }
+      }
+    }
+  }
+
+  return std::min(el.radius, target_radius);
+}
+
+/*
+ * Elements
+ */
+
+//  Chains of nodes following random walks, as roots do. Each chain is an aggregate, so that
+//  nodes of the same chain do not limit one another.
+std::vector<RadiusLimiterElement> make_elements() {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+  auto rand_unit = [&]() {
+    while (true) {
+      auto v = Vec3f{dis(gen), dis(gen), dis(gen)};
+      const float len = v.length();
+      if (len > 0.1f && len <= 1.0f) {
+        return v / len;
+      }
+    }
+  };
+
+  const auto tag = RadiusLimiterElementTag::create();
+  std::vector<RadiusLimiterElement> result;
+  for (int c = 0; c < Config::num_chains; c++) {
+    const auto aggregate = RadiusLimiterAggregateID::create();
+    auto p = Vec3f{dis(gen), dis(gen), dis(gen)} * Config::region_size * 0.5f;
+    auto dir = rand_unit();
+    for (int i = 0; i < Config::num_nodes_per_chain; i++) {
+      dir = normalize(dir + rand_unit() * 0.5f);
+      const auto up = std::abs(dir.y) < 0.9f ? Vec3f{0.0f, 1.0f, 0.0f} : Vec3f{1.0f, 0.0f, 0.0f};
+      const auto ax_i = normalize(cross(up, dir));
+      const auto ax_k = cross(ax_i, dir);
+
+      RadiusLimiterElement el{};
+      el.i = ax_i;
+      el.j = dir;
+      el.k = ax_k;
+      el.p = p + dir * (Config::node_length * 0.5f);
+      el.half_length = Config::node_length * 0.5f;
+      el.radius = Config::initial_radius;
+      el.aggregate_id = aggregate;
+      el.tag = tag;
+      result.push_back(el);
+      p += dir * Config::node_length;
+    }
+  }
+  return result;
+}
+
+float target_radius(int step) {
+  return Config::initial_radius + float(step + 1) * Config::radius_increment;
+}
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+struct RunResult {
+  std::vector<float> radii;
+  double insert_ms;
+  double expand_ms;
+};
+
+RunResult run_legacy(const std::vector<RadiusLimiterElement>& elements) {
+  RunResult result{};
+  LegacyRadiusLimiter lim;
+  std::vector<RadiusLimiterElementHandle> handles;
+  result.insert_ms = time_ms([&]() {
+    for (auto& el : elements) {
+      handles.push_back(insert(lim, el));
+    }
+  });
+
+  result.radii.resize(elements.size());
+  result.expand_ms = time_ms([&]() {
+    for (int s = 0; s < Config::num_growth_steps; s++) {
+      for (size_t i = 0; i < handles.size(); i++) {
+        result.radii[i] = expand(lim, handles[i], target_radius(s));
+      }
+    }
+  });
+  return result;
+}
+
+RunResult run(const std::vector<RadiusLimiterElement>& elements) {
+  RunResult result{};
+  auto* lim = create_radius_limiter();
+  std::vector<RadiusLimiterElementHandle> handles;
+  result.insert_ms = time_ms([&]() {
+    for (auto& el : elements) {
+      handles.push_back(insert(lim, el));
+    }
+  });
+
+  result.radii.resize(elements.size());
+  result.expand_ms = time_ms([&]() {
+    for (int s = 0; s < Config::num_growth_steps; s++) {
+      for (size_t i = 0; i < handles.size(); i++) {
+        result.radii[i] = expand(lim, handles[i], target_radius(s));
+      }
+    }
+  });
+
+  validate(lim);
+  destroy_radius_limiter(&lim);
+  return result;
+}
+
+//  Remove every other chain, then compare `intersects_other` against a brute force search over
+//  the remaining elements, and check that removing the rest leaves no cell behind.
+bool check_remove(const std::vector<RadiusLimiterElement>& elements) {
+  auto* lim = create_radius_limiter();
+  std::vector<RadiusLimiterElementHandle> handles;
+  for (auto& el : elements) {
+    handles.push_back(insert(lim, el));
+  }
+  for (int i = 0; i < int(handles.size()); i++) {
+    (void) expand(lim, handles[i], target_radius(Config::num_growth_steps - 1));
+  }
+
+  auto is_removed = [](int i) {
+    return (i / Config::num_nodes_per_chain) % 2 == 1;
+  };
+  for (int i = 0; i < int(handles.size()); i++) {
+    if (is_removed(i)) {
+      remove(lim, handles[i]);
+    }
+  }
+
+  bool success{true};
+  for (int i = 0; i < int(handles.size()); i += 997) {
+    if (is_removed(i)) {
+      continue;
+    }
+    const auto& el = *read_element(lim, handles[i]);
+    const auto el_obb = el.to_obb(el.radius);
+    bool expect{};
+    for (int j = 0; j < int(handles.size()) && !expect; j++) {
+      if (!is_removed(j)) {
+        const auto& query_el = *read_element(lim, handles[j]);
+        expect = query_el.aggregate_id != el.aggregate_id &&
+                 obb_obb_intersect(el_obb, query_el.to_obb(query_el.radius));
+      }
+    }
+    success = success && intersects_other(lim, el) == expect;
+  }
+
+  for (int i = 0; i < int(handles.size()); i++) {
+    if (!is_removed(i)) {
+      remove(lim, handles[i]);
+    }
+  }
+
+  const auto stats = get_stats(lim);
+  success = success &&
+    stats.num_cell_indices == 0 &&
+    stats.num_free_cell_indices == stats.num_cells &&
+    stats.num_free_element_indices == stats.num_element_indices;
+
+  destroy_radius_limiter(&lim);
+  return success;
+}
+
+void report(const char* name, const RunResult& res, int num_elements) {
+  const double num_expand = double(num_elements) * Config::num_growth_steps;
+  std::cout << name
+            << "; insert: " << res.insert_ms << "ms"
+            << "; expand: " << res.expand_ms << "ms"
+            << " (" << num_expand / (res.expand_ms * 1e-3) << " elements/s)"
+            << std::endl;
+}
+
+} //  anon
+
+int main(int, char**) {
+  const auto elements = make_elements();
+  const int num_elements = int(elements.size());
+  std::cout << num_elements << " elements; "
+            << Config::num_growth_steps << " expansion steps" << std::endl;
+
+  const auto legacy = run_legacy(elements);
+  const auto open_addressed = run(elements);
+
+  report("unordered_map", legacy, num_elements);
+  report("open addressed", open_addressed, num_elements);
+
+  int num_reached_target{};
+  for (int i = 0; i < num_elements; i++) {
+    num_reached_target += int(open_addressed.radii[i] == target_radius(Config::num_growth_steps - 1));
+  }
+
+  const bool same = legacy.radii == open_addressed.radii;
+  std::cout << "expand speedup: " << legacy.expand_ms / open_addressed.expand_ms << "x"
+            << "; reached target radius: " << num_reached_target << " / " << num_elements
+            << "; matches unordered_map: " << (same ? "yes" : "no")
+            << std::endl;
+
+  const bool removed = check_remove(elements);
+  std::cout << "remove: " << (removed ? "ok" : "failed") << std::endl;
+
+  return same && removed ? 0 : 1;
+}
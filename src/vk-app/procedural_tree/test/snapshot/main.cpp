@@ -0,0 +1,252 @@
+#include "../../snapshot.hpp"
+#include "../../serialize.hpp"
+#include "../../roots_components.hpp"
+#include "../../vine_system.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace grove;
+using namespace grove::tree;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_trees = 256;
+  static constexpr int num_internodes = 4096;
+  static constexpr int num_attraction_points = 2048;
+  static constexpr int num_root_nodes = 1024;
+  static constexpr int num_vines = 16;
+  static constexpr int num_vine_nodes = 512;
+  static constexpr int num_changed_trees = 4;
+};
+
+struct Scene {
+  std::vector<TreeNodeStore> trees;
+  std::vector<std::vector<Vec3f>> attraction_points;
+  std::vector<std::vector<TreeRootNode>> roots;
+  std::vector<std::vector<VineNode>> vines;
+};
+
+Scene make_scene() {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+  auto rand_vec = [&]() {
+    return Vec3f{dis(gen), dis(gen), dis(gen)};
+  };
+
+  Scene result;
+  for (int t = 0; t < Config::num_trees; t++) {
+    auto& tree = result.trees.emplace_back();
+    tree.id = TreeID::create();
+    for (int i = 0; i < Config::num_internodes; i++) {
+      auto node = make_internode(i - 1, rand_vec(), normalize(rand_vec()), dis(gen), 0);
+      node.diameter = dis(gen);
+      tree.internodes.push_back(node);
+      tree.buds.push_back(make_lateral_bud(i, rand_vec(), rand_vec(), 1.0f, 2.0f, dis(gen)));
+    }
+
+    auto& points = result.attraction_points.emplace_back();
+    for (int i = 0; i < Config::num_attraction_points; i++) {
+      points.push_back(rand_vec());
+    }
+
+    auto& roots = result.roots.emplace_back();
+    for (int i = 0; i < Config::num_root_nodes; i++) {
+      TreeRootNode node{};
+      node.parent = i - 1;
+      node.medial_child = i + 1 < Config::num_root_nodes ? i + 1 : -1;
+      node.lateral_child = -1;
+      node.position = rand_vec();
+      node.direction = normalize(rand_vec());
+      node.diameter = dis(gen);
+      roots.push_back(node);
+    }
+  }
+
+  for (int v = 0; v < Config::num_vines; v++) {
+    auto& vine = result.vines.emplace_back();
+    for (int i = 0; i < Config::num_vine_nodes; i++) {
+      VineNode node{};
+      node.position = rand_vec();
+      node.direction = normalize(rand_vec());
+      node.radius = dis(gen);
+      node.parent = i - 1;
+      node.medial_child = -1;
+      node.lateral_child = -1;
+      vine.push_back(node);
+    }
+  }
+  return result;
+}
+
+SnapshotRecords make_records(const Scene& scene) {
+  SnapshotRecords records;
+  for (int t = 0; t < Config::num_trees; t++) {
+    const auto key = uint64_t(t);
+    push_tree(records, key, scene.trees[t]);
+    auto& points = scene.attraction_points[t];
+    push_attraction_points(records, key, points.data(), int64_t(points.size()));
+    push_roots(records, key, scene.roots[t].data(), int(scene.roots[t].size()));
+  }
+  for (int v = 0; v < Config::num_vines; v++) {
+    push_vine(records, uint64_t(v), scene.vines[v].data(), int(scene.vines[v].size()));
+  }
+  return records;
+}
+
+template <typename T, typename U>
+bool same_bytes(const ArrayView<const T>& view, const std::vector<U>& src) {
+  return size_t(view.size()) == src.size() &&
+         (src.empty() || std::memcmp(view.data(), src.data(), src.size() * sizeof(T)) == 0);
+}
+
+//  Every live entry matches the scene object with the same kind and key.
+bool matches_scene(const Snapshot* snapshot, const Scene& scene, uint64_t removed_tree) {
+  int num_checked{};
+  for (auto& entry : read_entries(snapshot)) {
+    const auto k = size_t(entry.key);
+    bool same{};
+    switch (entry.kind) {
+      case SnapshotRecordKind::Tree:
+        same = k != removed_tree &&
+               same_bytes(read_internodes(entry), scene.trees[k].internodes) &&
+               same_bytes(read_buds(entry), scene.trees[k].buds);
+        break;
+      case SnapshotRecordKind::AttractionPoints:
+        same = same_bytes(read_attraction_points(entry), scene.attraction_points[k]);
+        break;
+      case SnapshotRecordKind::Roots:
+        same = same_bytes(read_roots(entry), scene.roots[k]);
+        break;
+      case SnapshotRecordKind::Vine:
+        same = same_bytes(read_vine_nodes(entry), scene.vines[k]);
+        break;
+    }
+    if (!same) {
+      return false;
+    }
+    num_checked++;
+  }
+
+  const int num_expect = 3 * Config::num_trees + Config::num_vines - int(removed_tree != ~0ull);
+  return num_checked == num_expect;
+}
+
+template <typename F>
+double time_ms(F&& f) {
+  auto t0 = Clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+} //  anon
+
+int main(int, char**) {
+  namespace fs = std::filesystem;
+  const auto dir = fs::temp_directory_path() / "grove_test_snapshot";
+  fs::create_directories(dir);
+  const auto snapshot_path = (dir / "scene.snapshot").string();
+
+  auto scene = make_scene();
+  bool success{true};
+
+  //  Previous format: one file per tree.
+  const double serialize_ms = time_ms([&]() {
+    for (int t = 0; t < Config::num_trees; t++) {
+      const auto path = (dir / ("tree" + std::to_string(t) + ".dat")).string();
+      success = tree::serialize_file(scene.trees[t], path.c_str()) && success;
+    }
+  });
+  const double deserialize_ms = time_ms([&]() {
+    for (int t = 0; t < Config::num_trees; t++) {
+      const auto path = (dir / ("tree" + std::to_string(t) + ".dat")).string();
+      auto res = tree::deserialize_file(path.c_str());
+      success = res && res.value().internodes.size() == scene.trees[t].internodes.size() && success;
+    }
+  });
+
+  const double write_ms = time_ms([&]() {
+    success = write_snapshot(make_records(scene), snapshot_path.c_str()) && success;
+  });
+
+  Snapshot* snapshot{};
+  const double open_ms = time_ms([&]() {
+    snapshot = open_snapshot(snapshot_path.c_str());
+  });
+  success = snapshot && matches_scene(snapshot, scene, ~0ull) && success;
+
+  std::vector<TreeNodeStore> loaded;
+  const double copy_ms = time_ms([&]() {
+    for (auto& entry : read_entries(snapshot)) {
+      if (entry.kind == SnapshotRecordKind::Tree) {
+        loaded.push_back(to_tree_node_store(entry));
+      }
+    }
+  });
+  close_snapshot(&snapshot);
+  success = int(loaded.size()) == Config::num_trees && success;
+
+  const auto full_size = fs::file_size(snapshot_path);
+
+  //  Incremental save: change a few trees and remove one.
+  const uint64_t removed_tree = 1;
+  SnapshotRecords changed;
+  for (int t = 0; t < Config::num_changed_trees; t++) {
+    const int ti = 2 + t * 7;
+    scene.trees[ti].internodes.resize(Config::num_internodes / 2);
+    scene.trees[ti].internodes[0].diameter = 123.0f;
+    push_tree(changed, uint64_t(ti), scene.trees[ti]);
+  }
+  push_removed(changed, SnapshotRecordKind::Tree, removed_tree);
+
+  const double append_ms = time_ms([&]() {
+    success = write_snapshot(changed, snapshot_path.c_str(), true) && success;
+  });
+  const auto appended_size = fs::file_size(snapshot_path);
+
+  snapshot = open_snapshot(snapshot_path.c_str());
+  const bool incremental_ok = snapshot && matches_scene(snapshot, scene, removed_tree);
+  close_snapshot(&snapshot);
+
+  //  An interrupted append leaves a partial record, which is ignored when reading and discarded by
+  //  the next append.
+  fs::resize_file(snapshot_path, appended_size + 100);
+  snapshot = open_snapshot(snapshot_path.c_str());
+  bool torn_ok = snapshot && matches_scene(snapshot, scene, removed_tree);
+  success = write_snapshot(SnapshotRecords{}, snapshot_path.c_str(), true) && success;
+  torn_ok = torn_ok && fs::file_size(snapshot_path) == appended_size;
+
+  //  A snapshot that is open remains readable while the file is repaired and then rewritten.
+  success = write_snapshot(make_records(scene), snapshot_path.c_str()) && success;
+  bool open_ok = snapshot && matches_scene(snapshot, scene, removed_tree);
+  close_snapshot(&snapshot);
+  snapshot = open_snapshot(snapshot_path.c_str());
+  open_ok = open_ok && snapshot && matches_scene(snapshot, scene, ~0ull) &&
+            !fs::exists(snapshot_path + ".tmp");
+  close_snapshot(&snapshot);
+
+  fs::remove_all(dir);
+
+  const double mb = double(full_size) / (1024.0 * 1024.0);
+  std::cout << Config::num_trees << " trees; snapshot: " << mb << "MB" << std::endl;
+  std::cout << "per-tree files; write: " << serialize_ms << "ms"
+            << "; read: " << deserialize_ms << "ms" << std::endl;
+  std::cout << "snapshot; write: " << write_ms << "ms (" << mb / (write_ms * 1e-3) << "MB/s)"
+            << "; open: " << open_ms << "ms"
+            << "; copy trees: " << copy_ms << "ms" << std::endl;
+  std::cout << "append " << Config::num_changed_trees << " trees: " << append_ms << "ms, "
+            << (appended_size - full_size) << " bytes"
+            << "; incremental: " << (incremental_ok ? "ok" : "failed")
+            << "; torn write: " << (torn_ok ? "ok" : "failed")
+            << "; rewrite while open: " << (open_ok ? "ok" : "failed") << std::endl;
+
+  success = success && incremental_ok && torn_ok && open_ok;
+  return success ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include "render.hpp"
 #include "bud_fate.hpp"
 #include "utility.hpp"
+#include "snapshot.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/Temporary.hpp"
 #include "grove/common/profile.hpp"
@@ -542,6 +543,18 @@ void on_destroy(TreeSystem* sys, Instance* inst, const UpdateInfo& info) {
 #endif
 }
 
+void gather_snapshot_changes(TreeSystem* sys) {
+  for (auto& [id, inst] : sys->instances) {
+    if (inst.events.node_structure_modified || inst.events.node_render_position_modified) {
+      sys->snapshot_changes.modified.insert(TreeInstanceHandle{id});
+    }
+  }
+}
+
+uint64_t to_snapshot_key(TreeID id) {
+  return uint64_t(id.id);
+}
+
 void update_pending_deletion(TreeSystem* sys, const UpdateInfo& info) {
   sys->just_deleted.clear();
 
@@ -554,6 +567,11 @@ void update_pending_deletion(TreeSystem* sys, const UpdateInfo& info) {
 
     if (can_destroy_now(inst)) {
       sys->just_deleted.insert(id);
+      auto& snapshot_changes = sys->snapshot_changes;
+      snapshot_changes.modified.erase(id);
+      if (!snapshot_changes.file_path.empty()) {
+        snapshot_changes.removed.push_back(inst.nodes.id);
+      }
       on_destroy(sys, &inst, info);
       sys->instances.erase(inst_it);
       del_it = sys->pending_deletion.erase(del_it);
@@ -820,6 +838,7 @@ TreeInstanceHandle tree::create_tree(TreeSystem* sys, CreateTreeParams&& params,
   *dst_id = inst.nodes.id;
   sys->instances[id] = std::move(inst);
   TreeInstanceHandle handle{id};
+  sys->snapshot_changes.modified.insert(handle);
   return handle;
 }
 
@@ -908,6 +927,7 @@ UpdateResult tree::update(TreeSystem* sys, const UpdateInfo& info) {
   grove::update_growth(sys, info);
   grove::update_render_growth(sys, info);
   grove::update_render_death(sys, info);
+  grove::gather_snapshot_changes(sys);
   grove::update_pending_deletion(sys, info);
   result.just_deleted = &sys->just_deleted;
   return result;
@@ -1009,6 +1029,46 @@ bounds::RadiusLimiterElementTag tree::get_tree_radius_limiter_element_tag(const
   return Config::tree_tag;
 }
 
+bool tree::save_snapshot(TreeSystem* sys, const char* file_path) {
+  auto& changes = sys->snapshot_changes;
+  const bool save_all = changes.file_path != file_path;
+
+  SnapshotRecords records;
+  std::vector<TreeInstanceHandle> unreadable;
+  auto push_instance = [&](TreeInstanceHandle handle, const Instance& inst) {
+    if (can_read_nodes(inst)) {
+      push_tree(records, to_snapshot_key(inst.nodes.id), inst.nodes);
+    } else {
+      unreadable.push_back(handle);
+    }
+  };
+
+  if (save_all) {
+    for (auto& [id, inst] : sys->instances) {
+      push_instance(TreeInstanceHandle{id}, inst);
+    }
+  } else {
+    for (TreeInstanceHandle handle : changes.modified) {
+      if (auto* inst = find_instance(sys, handle)) {
+        push_instance(handle, *inst);
+      }
+    }
+    for (TreeID id : changes.removed) {
+      push_removed(records, SnapshotRecordKind::Tree, to_snapshot_key(id));
+    }
+  }
+
+  if (!write_snapshot(records, file_path, !save_all)) {
+    return false;
+  }
+
+  changes.file_path = file_path;
+  changes.modified.clear();
+  changes.modified.insert(unreadable.begin(), unreadable.end());
+  changes.removed.clear();
+  return true;
+}
+
 TreeSystem::Stats tree::get_stats(const TreeSystem* sys) {
   TreeSystem::Stats result{};
   result.num_instances = int(sys->instances.size());
@@ -11,6 +11,7 @@
 #endif
 
 #include <unordered_set>
+#include <string>
 
 namespace grove::tree {
 
@@ -166,6 +167,13 @@ struct TreeSystem {
     const DeletedInstances* just_deleted;
   };
 
+  //  Trees created, modified or destroyed since the last snapshot was saved to `file_path`.
+  struct SnapshotChanges {
+    std::string file_path;
+    std::unordered_set<TreeInstanceHandle, TreeInstanceHandle::Hash> modified;
+    std::vector<TreeID> removed;
+  };
+
   struct Stats {
     int num_instances;
     int num_axis_growth_contexts;
@@ -187,6 +195,7 @@ public:
   std::unordered_set<TreeInstanceHandle, TreeInstanceHandle::Hash> pending_deletion;
   std::vector<InsertedAttractionPoints> inserted_attraction_points;
   DeletedInstances just_deleted;
+  SnapshotChanges snapshot_changes;
 
   bounds::ElementTag bounds_tree_element_tag{bounds::ElementTag::create()};
   bounds::ElementTag bounds_leaf_element_tag{bounds::ElementTag::create()};
@@ -224,6 +233,11 @@ bounds::RadiusLimiterElementTag get_tree_radius_limiter_element_tag(const TreeSy
 
 [[nodiscard]] TreeSystem::UpdateResult update(TreeSystem* sys, const TreeSystem::UpdateInfo& info);
 
+//  Saves the nodes of each tree to the snapshot at `file_path`. Saving to the same path again
+//  appends only the trees created, modified or destroyed since then; saving to a different path
+//  rewrites the whole file. Trees that are growing are saved once they can be read.
+bool save_snapshot(TreeSystem* sys, const char* file_path);
+
 TreeSystem::Stats get_stats(const TreeSystem* sys);
 
 }
\ No newline at end of file
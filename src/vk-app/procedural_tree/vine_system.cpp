@@ -945,7 +945,7 @@ VineSegmentHandle tree::start_new_vine_on_tree(VineSystem* sys, VineInstanceHand
 
 VineSegmentHandle tree::emplace_vine_from_internodes(
   VineSystem* sys, RenderVineSystem* render_sys, VineInstanceHandle handle,
-  const Internode* internodes, const Vec3f* surface_ns, int num_internodes) {
+  const Internode* internodes, const Vec3f* surface_ns, int num_internodes, TaskPool* task_pool) {
   //
   auto* inst = find_instance(sys, handle);
   assert(inst);
@@ -962,7 +962,7 @@ VineSegmentHandle tree::emplace_vine_from_internodes(
 
   Temporary<Mat3f, 2048> store_node_frames;
   auto* node_frames = store_node_frames.require(num_internodes);
-  compute_internode_frames(internodes, num_internodes, node_frames);
+  compute_internode_frames(internodes, num_internodes, node_frames, task_pool);
 
   Temporary<VineRenderNodeDescriptor, 2048> store_descs;
   auto* render_descs = store_descs.require(num_internodes);
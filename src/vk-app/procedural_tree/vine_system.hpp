@@ -6,6 +6,7 @@
 namespace grove {
 template <typename T>
 struct Vec3;
+class TaskPool;
 }
 
 namespace grove::bounds {
@@ -91,7 +92,8 @@ VineSegmentHandle start_new_vine_on_tree(VineSystem* sys, VineInstanceHandle ins
                                          TreeInstanceHandle tree, float spiral_theta);
 VineSegmentHandle emplace_vine_from_internodes(VineSystem* sys, RenderVineSystem* render_vine_sys,
                                                VineInstanceHandle inst, const Internode* internodes,
-                                               const Vec3f* surface_ns, int num_internodes);
+                                               const Vec3f* surface_ns, int num_internodes,
+                                               TaskPool* task_pool);
 void try_to_jump_to_nearby_tree(VineSystem* sys, VineInstanceHandle inst, VineSegmentHandle segment,
                                 const VineSystemTryToJumpToNearbyTreeParams& params);
 float get_global_growth_rate_scale(const VineSystem* sys);
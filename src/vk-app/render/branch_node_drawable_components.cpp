@@ -49,7 +49,7 @@ BranchNodeDrawableComponents
 tree::create_wind_branch_node_drawable_components_from_internodes(
   RenderBranchNodesData* data, const Internodes& inodes,
   const Bounds3f& eval_aabb, const AxisRootInfo& axis_roots,
-  const RemappedAxisRoots& remapped_roots) {
+  const RemappedAxisRoots& remapped_roots, TaskPool* task_pool) {
   //
   Temporary<RenderBranchNodeInstanceDescriptor, 2048> store_instance_descs;
   auto* instance_descs = store_instance_descs.require(int(inodes.size()));
@@ -57,7 +57,7 @@ tree::create_wind_branch_node_drawable_components_from_internodes(
 
   Temporary<Mat3f, 2048> store_frames;
   auto* frames = store_frames.require(int(inodes.size()));
-  compute_internode_frames(inodes.data(), int(inodes.size()), frames);
+  compute_internode_frames(inodes.data(), int(inodes.size()), frames, task_pool);
 
   const auto num_nodes = uint32_t(inodes.size());
   for (uint32_t i = 0; i < num_nodes; i++) {
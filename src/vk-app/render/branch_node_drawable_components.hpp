@@ -4,6 +4,10 @@
 #include "../procedural_tree/components.hpp"
 #include "grove/common/Optional.hpp"
 
+namespace grove {
+class TaskPool;
+}
+
 namespace grove::tree {
 
 struct RemappedAxisRoots;
@@ -17,7 +21,7 @@ BranchNodeDrawableComponents
 create_wind_branch_node_drawable_components_from_internodes(
   RenderBranchNodesData* data, const Internodes& inodes,
   const Bounds3f& eval_aabb, const AxisRootInfo& axis_root_info,
-  const RemappedAxisRoots& remapped_axis_roots);
+  const RemappedAxisRoots& remapped_axis_roots, TaskPool* task_pool);
 
 void set_position_and_radii_from_internodes(RenderBranchNodesData* data,
                                             const BranchNodeDrawableComponents& components,
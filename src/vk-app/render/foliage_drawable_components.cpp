@@ -5,6 +5,7 @@
 #include "../procedural_tree/utility.hpp"
 #include "grove/common/common.hpp"
 #include "grove/common/Temporary.hpp"
+#include "grove/common/FrameArena.hpp"
 
 GROVE_NAMESPACE_BEGIN
 
@@ -21,7 +22,7 @@ struct Config {
 };
 
 struct RenderTreeLeavesInstanceMeta {
-  PackedWindAxisRootInfo packed_wind_axis_root_info;
+  Vec4<uint32_t> packed_wind_axis_root_info[3];
 };
 
 uint32_t make_frustum_cull_instance_descs(const FoliageDistributionEntry* entries, uint32_t num_entries,
@@ -41,6 +42,7 @@ uint32_t make_frustum_cull_instance_descs(const FoliageDistributionEntry* entrie
       const auto& src_entry = entries[inst_off];
       auto& dst_inst = dst_descs[num_descs++];
 
+      dst_inst = {};
       dst_inst.aabb_p0 = src_entry.translation - global_scale;
       dst_inst.aabb_p1 = src_entry.translation + global_scale;
 #ifdef GROVE_DEBUG
@@ -310,19 +312,16 @@ FoliageDistributionParams make_from_distribution_strategy(FoliageDistributionStr
   }
 }
 
-auto make_distribution_entries_from_internodes(const Internodes& internodes,
-                                               const std::vector<int>& on_internodes,
+auto make_distribution_entries_from_internodes(FrameArena& arena, const Internodes& internodes,
+                                               const int* on_internodes, uint32_t num_on_internodes,
                                                const Bounds3f& aabb,
                                                FoliageDistributionParams distrib_params) {
   struct Result {
-    std::vector<FoliageDistributionEntry> entries;
-    std::vector<RenderTreeLeavesInstanceMeta> instance_meta;
+    FoliageDistributionEntry* entries;
+    RenderTreeLeavesInstanceMeta* instance_meta;
+    uint32_t num_entries;
   };
 
-  Result result{};
-  auto& entries = result.entries;
-  auto& instance_meta = result.instance_meta;
-
   auto axis_root_info = tree::compute_axis_root_info(internodes);
   auto remapped_roots = tree::remap_axis_roots(internodes);
 
@@ -330,30 +329,32 @@ auto make_distribution_entries_from_internodes(const Internodes& internodes,
   const auto num_steps = uint32_t(distrib_params.num_steps);
   const auto instances_per_node = num_instances_per_step * num_steps;
 
-  for (const int index : on_internodes) {
-    auto& node = internodes[index];
+  Result result{};
+  result.num_entries = num_on_internodes * instances_per_node;
+  result.entries = arena.allocate_n<FoliageDistributionEntry>(result.num_entries);
+  result.instance_meta = arena.allocate_n<RenderTreeLeavesInstanceMeta>(result.num_entries);
+
+  for (uint32_t i = 0; i < num_on_internodes; i++) {
+    auto& node = internodes[on_internodes[i]];
 
     auto root_info = tree::make_wind_axis_root_info(
       node, internodes, axis_root_info, remapped_roots, aabb);
     auto packed_root_info = tree::to_packed_wind_info(root_info, root_info);
 
-    const auto curr_offset = uint32_t(entries.size());
-    entries.resize(curr_offset + instances_per_node);
-    instance_meta.resize(curr_offset + instances_per_node);
+    const uint32_t curr_offset = i * instances_per_node;
 
     distrib_params.tip_position = node.tip_position();
     distrib_params.outwards_direction = aabb.to_fraction(
       clamp_each(node.tip_position(), aabb.min, aabb.max));
 
-    distribute_foliage_outwards_from_nodes(distrib_params, entries.data() + curr_offset);
-    for (uint32_t j = 0; j < instances_per_node; j++) {
-      RenderTreeLeavesInstanceMeta meta{};
-      meta.packed_wind_axis_root_info = packed_root_info;
-      instance_meta[curr_offset + j] = meta;
-    }
+    distribute_foliage_outwards_from_nodes(distrib_params, result.entries + curr_offset);
+    RenderTreeLeavesInstanceMeta meta{};
+    assert(packed_root_info.size() == 3);
+    std::copy(packed_root_info.begin(), packed_root_info.end(), meta.packed_wind_axis_root_info);
+    std::fill(result.instance_meta + curr_offset,
+              result.instance_meta + curr_offset + instances_per_node, meta);
   }
 
-  assert(entries.size() == instance_meta.size());
   return result;
 }
 
@@ -480,7 +481,8 @@ void set_lod_instance_meta(const FoliageDrawableComponents& comp, TreeLeavesRend
 
 FoliageDrawableComponents
 create_components_from_internodes(
-  const Internodes& internodes, const std::vector<int>& on_internodes,
+  FrameArena& arena,
+  const Internodes& internodes, const int* on_internodes, uint32_t num_on_internodes,
   const CreateFoliageDrawableComponentParams& create_params, FoliageDistributionParams distrib_params,
   float global_scale, float curl_scale, const Vec2f& lod_distance_limits,
   cull::FrustumCullData* cull_data,
@@ -495,53 +497,54 @@ create_components_from_internodes(
   const auto num_steps = uint32_t(distrib_params.num_steps);
 
   auto distrib_res = make_distribution_entries_from_internodes(
-    internodes, on_internodes, aabb, distrib_params);
+    arena, internodes, on_internodes, num_on_internodes, aabb, distrib_params);
 
-  auto& entries = distrib_res.entries;
-  auto& instance_meta = distrib_res.instance_meta;
-  const auto num_created_nodes = uint32_t(on_internodes.size());
-  const auto num_entries = uint32_t(entries.size());
+  const auto* entries = distrib_res.entries;
+  const auto* instance_meta = distrib_res.instance_meta;
+  const auto num_created_nodes = num_on_internodes;
+  const auto num_entries = distrib_res.num_entries;
 
   result.num_clusters = num_entries / (num_steps * num_instances_per_step);
   result.num_steps = num_steps;
   result.num_instances_per_step = num_instances_per_step;
 
   //  frustum cull instances
-  std::vector<cull::FrustumCullInstanceDescriptor> cull_descs(num_entries);
+  auto* cull_descs = arena.allocate_n<cull::FrustumCullInstanceDescriptor>(num_entries);
   const uint32_t num_cull_instances = make_frustum_cull_instance_descs(
-    entries.data(), num_entries, num_steps, num_instances_per_step, global_scale, cull_descs.data());
+    entries, num_entries, num_steps, num_instances_per_step, global_scale, cull_descs);
   const auto cull_group_handle = cull::create_frustum_cull_instance_group(
-    cull_data, cull_descs.data(), num_cull_instances);
+    cull_data, cull_descs, num_cull_instances);
 
   //  occlusion cluster instances
   bool enable_cpu_occlusion_clusters{};
   uint32_t num_occlusion_clusters{};
   foliage_occlusion::ClusterGroupHandle occlusion_cluster_group_handle{};
 
-  std::vector<foliage_occlusion::ClusterDescriptor> occlusion_cluster_descs;
+  foliage_occlusion::ClusterDescriptor* occlusion_cluster_descs{};
   if (enable_cpu_occlusion_clusters) {
-    occlusion_cluster_descs.resize(num_created_nodes);
+    occlusion_cluster_descs =
+      arena.allocate_n<foliage_occlusion::ClusterDescriptor>(num_created_nodes);
 
     num_occlusion_clusters = make_foliage_occlusion_cluster_descriptors(
-      entries.data(), num_entries, num_steps, num_instances_per_step,
-      Config::occlusion_cluster_create_interval, global_scale, occlusion_cluster_descs.data());
+      entries, num_entries, num_steps, num_instances_per_step,
+      Config::occlusion_cluster_create_interval, global_scale, occlusion_cluster_descs);
 
     occlusion_cluster_group_handle = foliage_occlusion::insert_cluster_group(
-      occlusion_sys, occlusion_cluster_descs.data(), num_occlusion_clusters);
+      occlusion_sys, occlusion_cluster_descs, num_occlusion_clusters);
   }
 
   //  render instances
-  std::vector<TreeLeavesRenderInstanceDescriptor> render_instances(num_entries);
+  auto* render_instances = arena.allocate_n<TreeLeavesRenderInstanceDescriptor>(num_entries);
   const uint32_t num_insts = make_render_tree_leaves_instances(
-    entries.data(), instance_meta.data(),
+    entries, instance_meta,
     num_entries, num_steps, num_instances_per_step,
-    cull_group_handle, create_params.preferred_lod, render_instances.data());
+    cull_group_handle, create_params.preferred_lod, render_instances);
 
   if (enable_cpu_occlusion_clusters) {
     link_render_instances_to_occlusion_clusters(
       occlusion_cluster_group_handle,
-      occlusion_cluster_descs.data(), num_occlusion_clusters,
-      render_instances.data(), num_insts, num_instances_per_step);
+      occlusion_cluster_descs, num_occlusion_clusters,
+      render_instances, num_insts, num_instances_per_step);
   }
 
   const auto render_group_desc = make_render_instance_group_desc(
@@ -554,11 +557,11 @@ create_components_from_internodes(
 #if 1
   result.pooled_leaf_components = create_pooled_leaf_components(
     pool_alloc, *foliage::get_global_tree_leaves_render_data(),
-    render_group_desc, render_instances.data(), num_insts);
+    render_group_desc, render_instances, num_insts);
 #else
   (void) pool_alloc;
   result.leaves_drawable = foliage::create_tree_leaves_drawable(
-    render_instances.data(), num_insts, render_group_desc);
+    render_instances, num_insts, render_group_desc);
 #endif
 
   result.cull_group_handle = cull_group_handle;
@@ -601,8 +604,10 @@ void destroy_components(FoliageDrawableComponents& components,
 FoliageDrawableComponents foliage::create_foliage_drawable_components_from_internodes(
   cull::FrustumCullData* frustum_cull_data,
   foliage_occlusion::FoliageOcclusionSystem* occlusion_system,
-  TreeLeavesPoolAllocator* pool_alloc, const CreateFoliageDrawableComponentParams& create_params,
-  const std::vector<Internode>& internodes, const std::vector<int>& subset_internodes) {
+  TreeLeavesPoolAllocator* pool_alloc, FrameArena* arena,
+  const CreateFoliageDrawableComponentParams& create_params,
+  const std::vector<Internode>& internodes,
+  const int* subset_internodes, uint32_t num_subset_internodes) {
   //
   float global_scale{};
   float curl_scale{};
@@ -615,7 +620,7 @@ FoliageDrawableComponents foliage::create_foliage_drawable_components_from_inter
 #endif
 
   auto res = create_components_from_internodes(
-    internodes, subset_internodes,
+    *arena, internodes, subset_internodes, num_subset_internodes,
     create_params, distrib_params, global_scale, curl_scale, lod_dist_lims,
     frustum_cull_data, occlusion_system, *pool_alloc);
 
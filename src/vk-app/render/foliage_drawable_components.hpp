@@ -7,6 +7,10 @@
 #include <vector>
 #include <deque>
 
+namespace grove {
+class FrameArena;
+}
+
 namespace grove::tree {
 struct Internode;
 }
@@ -66,8 +70,10 @@ FoliageDrawableComponents create_foliage_drawable_components_from_internodes(
   cull::FrustumCullData* frustum_cull_data,
   foliage_occlusion::FoliageOcclusionSystem* occlusion_system,
   TreeLeavesPoolAllocator* pool_alloc,
+  FrameArena* arena,
   const CreateFoliageDrawableComponentParams& params,
-  const std::vector<tree::Internode>& internodes, const std::vector<int>& subset_internodes);
+  const std::vector<tree::Internode>& internodes,
+  const int* subset_internodes, uint32_t num_subset_internodes);
 
 void destroy_foliage_drawable_components(
   FoliageDrawableComponents* components,
@@ -13,6 +13,7 @@
 #include "grove/common/common.hpp"
 #include "grove/common/Temporary.hpp"
 #include "grove/common/profile.hpp"
+#include "grove/common/TaskPool.hpp"
 #include "grove/load/obj.hpp"
 #include "grove/load/image.hpp"
 #include "grove/visual/Image.hpp"
@@ -21,6 +22,7 @@
 #include "grove/math/util.hpp"
 #include "grove/math/triangle.hpp"
 #include "grove/math/bounds.hpp"
+#include "grove/math/bvh.hpp"
 #include "grove/math/GridIterator3.hpp"
 #include "grove/math/frame.hpp"
 #include <unordered_map>
@@ -132,6 +134,21 @@ struct VoxelSamples {
     }
   }
 
+  //  As `sample` for each of `ps`, but looking up the block shared by consecutive points once.
+  void sample4(const Vec3<uint16_t>* ps, uint8_t* dst) const {
+    const uint8_t* block{};
+    U163 key{};
+    for (int i = 0; i < 4; i++) {
+      const U163 base = ps[i] / cache_block_dim;
+      if (i == 0 || base != key) {
+        key = base;
+        auto it = cache.find(key);
+        block = it == cache.end() ? nullptr : samples.data() + it->second;
+      }
+      dst[i] = block ? block[to_local_offset(ps[i] - base * cache_block_dim)] : uint8_t(0xff);
+    }
+  }
+
   void clear() {
     cache.clear();
     samples.clear();
@@ -543,15 +560,42 @@ void modify_mesh_data(CubeMarchMeshData& mesh_data, const U163& chunk_key,
 
 void regen_chunks(const cm::GridInfo& grid, VoxelSamples& samples,
                   const ChunkIndices& chunks, CubeMarchMeshData& mesh_data,
-                  const UpdateInfo& info) {
-  auto gen_surface = [&](const Vec3f& p) -> float {
-    auto c = cm::world_to_coord(p, grid);
-    assert(all(ge(c, Vec3f{})));
-    assert(all(le(c, grid.size)));
-    const uint8_t s = samples.sample(to_u16(c));
-    return (float(s) / float(0xff) * 2.0f - 1.0f) * max_distance(grid);
+                  cm::ChunkedVolume& volume, TaskPool* task_pool, const UpdateInfo& info) {
+  if (chunks.empty()) {
+    return;
+  }
+
+  //  Only the voxel lookup is per lane; the lanes of a row share y and z, so they usually share a
+  //  sample block. Reads of `samples` are safe across threads.
+  auto gen_surface4 = [&samples, &grid](simd::F4 x, simd::F4 y, simd::F4 z) -> simd::F4 {
+    using namespace simd;
+    float cs[3][4];
+    store(cs[0], (x - set1(grid.offset.x)) / set1(grid.scale.x));
+    store(cs[1], (y - set1(grid.offset.y)) / set1(grid.scale.y));
+    store(cs[2], (z - set1(grid.offset.z)) / set1(grid.scale.z));
+
+    Vec3<uint16_t> ps[4];
+    for (int i = 0; i < 4; i++) {
+      const Vec3f c{cs[0][i], cs[1][i], cs[2][i]};
+      assert(all(ge(c, Vec3f{})));
+      assert(all(le(c, grid.size)));
+      ps[i] = to_u16(c);
+    }
+
+    uint8_t s[4];
+    samples.sample4(ps, s);
+    const F4 fs = set(float(s[0]), float(s[1]), float(s[2]), float(s[3]));
+    return (fs / set1(float(0xff)) * set1(2.0f) - set1(1.0f)) * set1(max_distance(grid));
   };
 
+  for (const U163 chunk_key : chunks) {
+    volume.mark_chunk_dirty(to_int(chunk_key));
+  }
+
+  cm::GenTrisParams params{};
+  params.smooth = true;
+  volume.remesh_dirty(gen_surface4, 0.0f, params, task_pool);
+
   auto grid_sz = to_u16(grid.size);
   for (const U163 chunk_key : chunks) {
     auto chunk_beg = chunk_key * CubeMarchMeshData::chunk_dim;
@@ -560,15 +604,17 @@ void regen_chunks(const cm::GridInfo& grid, VoxelSamples& samples,
 
     chunk_beg = max(U163{1}, chunk_beg);
     chunk_end = min(chunk_end, grid_sz - uint16_t(1));
-    auto chunk_p0 = to_int(chunk_beg);
-    auto chunk_p1 = to_int(chunk_end);
 
-    cm::GenTrisParams params{};
-    params.smooth = true;
-
-    std::vector<Vec3f> ps;
-    std::vector<Vec3f> ns;
-    cm::simple_grid_march_range(grid, gen_surface, 0.0f, chunk_p0, chunk_p1, params, &ps, &ns);
+    //  The terrain renderer draws unindexed triangles.
+    auto& surface = volume.chunk(volume.chunk_index(to_int(chunk_key))).surface;
+    std::vector<Vec3f> ps(surface.indices.size());
+    std::vector<Vec3f> ns(surface.indices.size());
+    for (size_t i = 0; i < surface.indices.size(); i++) {
+      ps[i] = surface.positions[surface.indices[i]];
+#if GROVE_CUBE_MARCH_INCLUDE_NORMALS
+      ns[i] = surface.normals[surface.indices[i]];
+#endif
+    }
 #if GROVE_CUBE_MARCH_INCLUDE_NORMALS
 //    auto verts = to_cube_march_vertices(ps, ns);
     auto verts = to_cube_march_vertices_with_normals(ps, ns);
@@ -671,6 +717,8 @@ PlaceOnMeshResult debug_place_on_mesh(const std::vector<Vec3f>& ps, const std::v
     Vec3f{0.0f, 1.0f, 0.0f},
     tmp_bounds.data(), tmp_depths.data());
 
+  const auto tri_bvh = bvh::build_triangle_bvh(tis.data(), num_tris, ps.data());
+
   constexpr int im_dim = 128;
   int ti_im[im_dim * im_dim];
   {
@@ -728,6 +776,7 @@ PlaceOnMeshResult debug_place_on_mesh(const std::vector<Vec3f>& ps, const std::v
     place_points_params.tris = tis.data();
     place_points_params.num_tris = num_tris;
     place_points_params.ps = ps.data();
+    place_points_params.bvh = &tri_bvh;
 
     place_points_params.surface_p = box_res.p;
     place_points_params.obb3_frame = box_res.frame;
@@ -1182,6 +1231,8 @@ struct GlobalData {
 
   VoxelSamples voxel_samples;
   CubeMarchMeshData mesh_data;
+  cm::ChunkedVolume cube_march_volume;
+  bool cube_march_volume_initialized{};
 
   PlaceOnMeshResult latest_place_on_mesh_result;
   TerrainRenderer::TerrainGrassDrawableHandle grass_drawable{};
@@ -2064,7 +2115,14 @@ DebugTerrainComponent::UpdateResult DebugTerrainComponent::update(const UpdateIn
     cube_march_params.made_perimeter_wall = true;
   }
 
-  regen_chunks(define_grid(), global_data.voxel_samples, chunks, global_data.mesh_data, info);
+  if (!global_data.cube_march_volume_initialized) {
+    global_data.cube_march_volume.initialize(define_grid(), CubeMarchMeshData::chunk_dim);
+    global_data.cube_march_volume_initialized = true;
+  }
+
+  regen_chunks(
+    define_grid(), global_data.voxel_samples, chunks, global_data.mesh_data,
+    global_data.cube_march_volume, info.task_pool, info);
 
   maybe_insert_component_bounds(*this, info);
 
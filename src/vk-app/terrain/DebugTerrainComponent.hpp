@@ -14,6 +14,7 @@ namespace grove {
 
 struct TerrainGUIUpdateResult;
 class Terrain;
+class TaskPool;
 
 class DebugTerrainComponent {
 public:
@@ -88,6 +89,7 @@ public:
     vk::SampledImageManager& sampled_image_manager;
     transform::TransformSystem& tform_system;
     const Terrain& terrain;
+    TaskPool* task_pool;
   };
 
   struct AddTransformEditor {
@@ -2,29 +2,70 @@
 #include "../generative/slime_mold.hpp"
 #include "grove/common/common.hpp"
 #include "grove/math/Bounds2.hpp"
+#include <future>
+#include <vector>
 
 GROVE_NAMESPACE_BEGIN
 
 struct SoilImpl {
+  struct PendingAdd {
+    Vec2f p01;
+    float r01;
+    Vec3f value;
+  };
+
   gen::SlimeMoldParams params;
   gen::SlimeMoldConfig config;
-  gen::SlimeMoldSimulationContext sim_context{};
-  gen::DefaultSlimeMoldSimulationTextureData texture_data;
-  std::unique_ptr<gen::SlimeParticle[]> particles;
+  gen::SlimeMoldSimulation sim;
+  //  While an update runs off the main thread, reads go to the texture as of the start of that
+  //  update, and additions are applied to both it and, once the update finishes, the simulation.
+  std::unique_ptr<float[]> published_texture;
+  std::vector<PendingAdd> pending_adds;
+  std::future<void> pending_update;
   bool initialized{};
 };
 
 namespace {
 
-void set_sim_context_ptrs(gen::SlimeMoldSimulationContext& context,
-                          gen::DefaultSlimeMoldSimulationTextureData& tex_data,
-                          const gen::SlimeMoldParams* params) {
-  context.texture_data0 = tex_data.texture_data0.get();
-  context.texture_data1 = tex_data.texture_data1.get();
-  context.texture_data2 = tex_data.texture_data2.get();
-  context.signal_data = tex_data.signal_data.get();
-  context.perturb_data = tex_data.perturb_data.get();
-  context.params = params;
+void add_value(float* data, const SoilImpl::PendingAdd& add) {
+  gen::add_value(data, add.p01, add.r01, add.value);
+}
+
+void finish_pending_update(SoilImpl& impl) {
+  if (impl.pending_update.valid()) {
+    impl.pending_update.get();
+    for (auto& add : impl.pending_adds) {
+      add_value(impl.sim.texture_data(), add);
+    }
+    impl.pending_adds.clear();
+  }
+}
+
+const float* current_texture_data(const SoilImpl& impl) {
+  return impl.pending_update.valid() ? impl.published_texture.get() : impl.sim.texture_data();
+}
+
+void update_off_main_thread(SoilImpl& impl, TaskPool* task_pool) {
+  if (impl.pending_update.valid()) {
+    if (impl.pending_update.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return;
+    }
+    finish_pending_update(impl);
+  }
+
+  using Config = gen::SlimeMoldConfig;
+  constexpr int texture_size =
+    Config::texture_dim * Config::texture_dim * Config::num_texture_channels;
+  const float* src = impl.sim.texture_data();
+  std::copy(src, src + texture_size, impl.published_texture.get());
+
+  impl.pending_update = std::async(
+    std::launch::async, [sim = &impl.sim, task_pool,
+                         config = impl.config, params = impl.params]() {
+    for (int i = 0; i < config.num_steps_per_update; i++) {
+      sim->update(config, params, task_pool);
+    }
+  });
 }
 
 constexpr float world_span() {
@@ -61,22 +102,30 @@ Soil::Soil() : impl{new SoilImpl()} {
 }
 
 Soil::~Soil() {
+  if (impl) {
+    finish_pending_update(*impl);
+  }
   delete impl;
 }
 
 void Soil::initialize() {
-  impl->texture_data = gen::make_default_slime_mold_texture_data();
-  impl->particles = gen::make_slime_mold_particles(impl->config);
-  set_sim_context_ptrs(impl->sim_context, impl->texture_data, &impl->params);
+  finish_pending_update(*impl);
+  impl->sim.initialize(impl->config, gen::SlimeMoldConfig::texture_dim, impl->config.num_particles);
+  impl->published_texture = gen::make_slime_mold_texture_data();
   impl->initialized = true;
 }
 
-void Soil::update() {
-  if (impl->initialized) {
-    gen::update_slime_mold_particles(
-      impl->particles.get(),
-      impl->config,
-      &impl->sim_context);
+void Soil::update(TaskPool* task_pool) {
+  if (!impl->initialized) {
+    return;
+  }
+  if (impl->config.update_off_main_thread) {
+    update_off_main_thread(*impl, task_pool);
+  } else {
+    finish_pending_update(*impl);
+    for (int i = 0; i < impl->config.num_steps_per_update; i++) {
+      impl->sim.update(impl->config, impl->params, task_pool);
+    }
   }
 }
 
@@ -86,16 +135,23 @@ Vec3f Soil::sample_quality01(const Vec2f& world_position_xz, float radius_world)
   }
   auto p01 = world_position_to_fraction(world_position_xz);
   float r01 = world_length_to_fraction(radius_world);
-  return gen::sample_slime_mold_texture_data01(impl->texture_data.texture_data0.get(), p01, r01);
+  return gen::sample_slime_mold_texture_data01(current_texture_data(*impl), p01, r01);
 }
 
 void Soil::add_quality01(const Vec2f& world_position_xz, float radius_world, const Vec3f& value) {
-  if (impl->initialized) {
-    gen::add_value(
-      impl->texture_data.texture_data0.get(),
-      world_position_to_fraction(world_position_xz),
-      world_length_to_fraction(radius_world),
-      value);
+  if (!impl->initialized) {
+    return;
+  }
+  SoilImpl::PendingAdd add{
+    world_position_to_fraction(world_position_xz),
+    world_length_to_fraction(radius_world),
+    value
+  };
+  if (impl->pending_update.valid()) {
+    add_value(impl->published_texture.get(), add);
+    impl->pending_adds.push_back(add);
+  } else {
+    add_value(impl->sim.texture_data(), add);
   }
 }
 
@@ -109,24 +165,27 @@ Vec2f Soil::to_position01(const Vec2f& p_xz) const {
 
 void Soil::set_particle_turn_speed_power(int pow) {
   if (impl->initialized) {
-    gen::set_particle_turn_speed_power(impl->particles.get(), impl->config, pow);
+    finish_pending_update(*impl);
+    impl->sim.set_particle_turn_speed_power(impl->config, pow);
   }
 }
 
 void Soil::set_particle_speed_power(int pow) {
   if (impl->initialized) {
-    gen::set_particle_speed_power(impl->particles.get(), impl->config, pow);
+    finish_pending_update(*impl);
+    impl->sim.set_particle_speed_power(impl->config, pow);
   }
 }
 
 void Soil::set_particle_use_only_right_turns(bool v) {
   if (impl->initialized) {
-    gen::set_particle_right_only(impl->particles.get(), impl->config, v);
+    finish_pending_update(*impl);
+    impl->sim.set_particle_right_only(impl->config, v);
   }
 }
 
 const float* Soil::read_image_data() const {
-  return impl->texture_data.texture_data0.get();
+  return impl->initialized ? current_texture_data(*impl) : nullptr;
 }
 
 const gen::SlimeMoldConfig* Soil::read_config() const {
@@ -5,6 +5,7 @@
 namespace grove {
 
 struct SoilImpl;
+class TaskPool;
 
 namespace gen {
 struct SlimeMoldConfig;
@@ -20,7 +21,9 @@ public:
   Soil& operator=(const Soil& other) = delete;
 
   void initialize();
-  void update();
+  //  `task_pool` is optional. An update may run off the main thread, so the pool must outlive
+  //  this instance.
+  void update(TaskPool* task_pool);
   Vec3f sample_quality01(const Vec2f& world_position_xz, float radius_world) const;
   void add_quality01(const Vec2f& world_position_xz, float radius_world, const Vec3f& value);
   float to_length01(float v) const;
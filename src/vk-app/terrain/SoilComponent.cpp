@@ -53,7 +53,7 @@ SoilComponent::UpdateResult SoilComponent::update(const UpdateInfo& info) {
       soil.initialize();
       params.initialized = true;
     }
-    soil.update();
+    soil.update(info.task_pool);
   }
   if (debug_image_handle && params.draw_debug_image && params.initialized) {
     info.image_manager.set_data_from_contiguous_subset(
@@ -111,6 +111,12 @@ void SoilComponent::on_gui_update(const SoilGUIUpdateResult& res) {
   if (res.only_right_turns) {
     config->only_right_turns = res.only_right_turns.value();
   }
+  if (res.num_steps_per_update) {
+    config->num_steps_per_update = res.num_steps_per_update.value();
+  }
+  if (res.update_off_main_thread) {
+    config->update_off_main_thread = res.update_off_main_thread.value();
+  }
   if (res.turn_speed_power) {
     soil.set_particle_turn_speed_power(res.turn_speed_power.value());
   }
@@ -25,6 +25,7 @@ public:
   struct UpdateInfo {
     vk::DynamicSampledImageManager& image_manager;
     const Vec2f& debug_position_xz;
+    TaskPool* task_pool;
   };
   struct UpdateResult {
     Optional<vk::DynamicSampledImageManager::Handle> show_debug_image;
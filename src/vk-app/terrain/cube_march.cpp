@@ -1,6 +1,7 @@
 #include "cube_march.hpp"
 #include "grove/common/common.hpp"
 #include "grove/math/util.hpp"
+#include <algorithm>
 
 GROVE_NAMESPACE_BEGIN
 
@@ -433,6 +434,50 @@ GenTrisResult gen_tris(const Vec3f& cube, const GridInfo& grid, const GridSample
   return result;
 }
 
+#if GROVE_CUBE_MARCH_INCLUDE_NORMALS
+Vec3f sample_normal(const ChunkSamples& samples, const Vec3<int>& c) {
+  auto dx = samples.at(c.x + 1, c.y, c.z) - samples.at(c.x - 1, c.y, c.z);
+  auto dy = samples.at(c.x, c.y + 1, c.z) - samples.at(c.x, c.y - 1, c.z);
+  auto dz = samples.at(c.x, c.y, c.z + 1) - samples.at(c.x, c.y, c.z - 1);
+  return normalize(Vec3f{dx, dy, dz});
+}
+#endif
+
+Vec3<int> corner_offset(int i) {
+  auto c = corner_coord(i);
+  return Vec3<int>{int(c.x), int(c.y), int(c.z)};
+}
+
+//  Vertex on the edge between corners `i0` and `i1` of the cube at local sample coordinate `c`;
+//  computed as in `gen_tris`, so that a vertex shared between cubes is identical to the vertex
+//  each of them would have generated on its own.
+void push_edge_vertex(const ChunkSamples& samples, const GridInfo& grid, float thresh,
+                      const GenTrisParams& params, const Vec3<int>& c, int i0, int i1,
+                      IndexedSurface& dst) {
+  const auto c0 = c + corner_offset(i0);
+  const auto c1 = c + corner_offset(i1);
+  float t = 0.5f;
+  auto p0 = c0;
+  auto p1 = c1;
+  if (params.smooth) {
+    auto res = surface_estimate(
+      samples.at(c0.x, c0.y, c0.z), samples.at(c1.x, c1.y, c1.z), thresh);
+    t = res.f;
+    if (res.swapped) {
+      std::swap(p0, p1);
+    }
+  }
+
+  const auto s0 = samples.p0 - 1;
+  dst.positions.push_back(lerp(
+    t,
+    coord_to_world(grid, to_vec3f(s0 + p0)),
+    coord_to_world(grid, to_vec3f(s0 + p1))));
+#if GROVE_CUBE_MARCH_INCLUDE_NORMALS
+  dst.normals.push_back(normalize(lerp(t, sample_normal(samples, p0), sample_normal(samples, p1))));
+#endif
+}
+
 } //  anon
 
 Vec3f cm::world_to_coord(const Vec3f& p, const GridInfo& grid) {
@@ -471,4 +516,124 @@ void cm::simple_grid_march_range(const GridInfo& grid, const GenSurface& gen_sur
   }
 }
 
+void cm::resize_chunk_samples(ChunkSamples& samples, const Vec3<int>& p0, const Vec3<int>& p1) {
+  assert(all(gt(p0, Vec3<int>{})) && all(lt(p0, p1)));
+  samples.p0 = p0;
+  samples.p1 = p1;
+  samples.dims = p1 - p0 + 3;
+  samples.row_stride = (samples.dims.x + 3) & ~3;
+  samples.values.resize(size_t(samples.row_stride) * samples.dims.y * samples.dims.z);
+}
+
+void cm::march_chunk(const ChunkSamples& samples, const GridInfo& grid, float thresh,
+                     const GenTrisParams& params, std::vector<uint32_t>& edge_vertex_scratch,
+                     IndexedSurface& dst) {
+  dst.clear();
+
+  //  Vertex index of each edge from corner (i, j, k) in the +x, +y and +z directions, with corners
+  //  relative to `samples.p0`.
+  const auto corner_dims = samples.p1 - samples.p0 + 1;
+  auto edge_index = [&corner_dims](const Vec3<int>& c, int axis) {
+    return ((c.z * corner_dims.y + c.y) * corner_dims.x + c.x) * 3 + axis;
+  };
+  edge_vertex_scratch.resize(size_t(corner_dims.x) * corner_dims.y * corner_dims.z * 3);
+  std::fill(edge_vertex_scratch.begin(), edge_vertex_scratch.end(), ~0u);
+
+  const auto num_cubes = samples.p1 - samples.p0;
+  for (int k = 0; k < num_cubes.z; k++) {
+    for (int j = 0; j < num_cubes.y; j++) {
+      for (int i = 0; i < num_cubes.x; i++) {
+        //  Local sample coordinate of the cube's first corner.
+        const Vec3<int> c{i + 1, j + 1, k + 1};
+        uint8_t below_surface{};
+        for (int ci = 0; ci < 8; ci++) {
+          auto cc = c + corner_offset(ci);
+          if (samples.at(cc.x, cc.y, cc.z) < thresh) {
+            below_surface |= uint8_t(1u << ci);
+          }
+        }
+
+        const int* edge_inds = triangulation[below_surface];
+        for (int e = 0; e < 16 && edge_inds[e] >= 0; e++) {
+          const int i0 = corner_index_a[edge_inds[e]];
+          const int i1 = corner_index_b[edge_inds[e]];
+          const auto c0 = c + corner_offset(i0);
+          const auto c1 = c + corner_offset(i1);
+          const auto lo = min(c0, c1) - 1;
+          const int axis = c0.x != c1.x ? 0 : c0.y != c1.y ? 1 : 2;
+
+          uint32_t& vi = edge_vertex_scratch[edge_index(lo, axis)];
+          if (vi == ~0u) {
+            vi = uint32_t(dst.positions.size());
+            push_edge_vertex(samples, grid, thresh, params, c, i0, i1, dst);
+          }
+          dst.indices.push_back(vi);
+        }
+      }
+    }
+  }
+}
+
+void cm::ChunkedVolume::initialize(const GridInfo& grid_info, int dim) {
+  assert(dim > 0);
+  grid = grid_info;
+  chunk_dim = dim;
+
+  const Vec3<int> grid_size{int(grid.size.x), int(grid.size.y), int(grid.size.z)};
+  assert(all(gt(grid_size, Vec3<int>{2})));
+  chunks_per_dim = (grid_size - 2) / chunk_dim + 1;
+
+  chunks.clear();
+  chunks.resize(chunks_per_dim.x * chunks_per_dim.y * chunks_per_dim.z);
+  for (int k = 0; k < chunks_per_dim.z; k++) {
+    for (int j = 0; j < chunks_per_dim.y; j++) {
+      for (int i = 0; i < chunks_per_dim.x; i++) {
+        const Vec3<int> key{i, j, k};
+        auto& chunk = chunks[chunk_index(key)];
+        chunk.p0 = max(Vec3<int>{1}, key * chunk_dim);
+        chunk.p1 = min((key + 1) * chunk_dim, grid_size - 1);
+      }
+    }
+  }
+
+  dirty.clear();
+  last_remeshed.clear();
+}
+
+int cm::ChunkedVolume::chunk_index(const Vec3<int>& key) const {
+  assert(all(ge(key, Vec3<int>{})) && all(lt(key, chunks_per_dim)));
+  return (key.z * chunks_per_dim.y + key.y) * chunks_per_dim.x + key.x;
+}
+
+void cm::ChunkedVolume::mark_chunk_dirty(const Vec3<int>& key) {
+  const int ci = chunk_index(key);
+  if (!chunks[ci].dirty) {
+    chunks[ci].dirty = true;
+    dirty.push_back(ci);
+  }
+}
+
+void cm::ChunkedVolume::mark_dirty(const Vec3<int>& p0, const Vec3<int>& p1) {
+  //  The cube at `c` reads the samples [c - 1, c + 2] (corners and normals), so the samples
+  //  [p0, p1) affect the cubes [p0 - 2, p1].
+  const auto key0 = max(p0 - 2, Vec3<int>{}) / chunk_dim;
+  const auto key1 = min(p1 / chunk_dim, chunks_per_dim - 1);
+  for (int k = key0.z; k <= key1.z; k++) {
+    for (int j = key0.y; j <= key1.y; j++) {
+      for (int i = key0.x; i <= key1.x; i++) {
+        mark_chunk_dirty(Vec3<int>{i, j, k});
+      }
+    }
+  }
+}
+
+void cm::ChunkedVolume::mark_all_dirty() {
+  for (int i = 0; i < num_chunks(); i++) {
+    if (!chunks[i].dirty) {
+      chunks[i].dirty = true;
+      dirty.push_back(i);
+    }
+  }
+}
+
 GROVE_NAMESPACE_END
\ No newline at end of file
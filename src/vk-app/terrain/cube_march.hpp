@@ -1,6 +1,9 @@
 #pragma once
 
 #include "grove/math/Vec3.hpp"
+#include "grove/math/simd.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <vector>
@@ -27,4 +30,169 @@ void simple_grid_march_range(const GridInfo& grid, const GenSurface& gen_surface
                              std::vector<Vec3f>* ns);
 Vec3f world_to_coord(const Vec3f& p, const GridInfo& grid);
 
-}
\ No newline at end of file
+/*
+ * ChunkSamples
+ *
+ * Field values for the cubes [p0, p1): every cube corner, plus a one-sample apron on each side
+ * for central-difference normals. Sample (i, j, k) is at grid coordinate p0 - 1 + (i, j, k); rows
+ * along x are padded to a multiple of 4 samples.
+ */
+struct ChunkSamples {
+  int index(int i, int j, int k) const {
+    return (k * dims.y + j) * row_stride + i;
+  }
+  float at(int i, int j, int k) const {
+    return values[index(i, j, k)];
+  }
+
+  Vec3<int> p0;
+  Vec3<int> p1;
+  Vec3<int> dims;
+  int row_stride;
+  std::vector<float> values;
+};
+
+/*
+ * IndexedSurface
+ *
+ * Triangles sharing vertices: each intersected grid edge of a chunk yields one vertex.
+ */
+struct IndexedSurface {
+  void clear() {
+    positions.clear();
+    normals.clear();
+    indices.clear();
+  }
+  uint32_t num_triangles() const {
+    return uint32_t(indices.size() / 3);
+  }
+
+  std::vector<Vec3f> positions;
+  std::vector<Vec3f> normals;
+  std::vector<uint32_t> indices;
+};
+
+void resize_chunk_samples(ChunkSamples& samples, const Vec3<int>& p0, const Vec3<int>& p1);
+
+//  Evaluates the field for the cubes [p0, p1) 4 samples at a time, as `field(x, y, z)`, where `x`,
+//  `y` and `z` are `simd::F4` world space coordinates and the result is an `F4` of field values.
+//  Lanes past the end of a row repeat the row's last sample.
+template <typename F>
+void sample_chunk(const GridInfo& grid, const Vec3<int>& p0, const Vec3<int>& p1, F&& field,
+                  ChunkSamples& dst) {
+  using namespace simd;
+  resize_chunk_samples(dst, p0, p1);
+
+  const F4 off_x = set1(grid.offset.x);
+  const F4 scl_x = set1(grid.scale.x);
+  const Vec3<int> s0 = p0 - 1;
+  const int x_end = s0.x + dst.dims.x - 1;
+  for (int k = 0; k < dst.dims.z; k++) {
+    const F4 z = set1(grid.offset.z + grid.scale.z * float(s0.z + k));
+    for (int j = 0; j < dst.dims.y; j++) {
+      const F4 y = set1(grid.offset.y + grid.scale.y * float(s0.y + j));
+      float* row = dst.values.data() + dst.index(0, j, k);
+      for (int i = 0; i < dst.dims.x; i += 4) {
+        const int xi = s0.x + i;
+        const F4 xs = set(
+          float(xi),
+          float(std::min(xi + 1, x_end)),
+          float(std::min(xi + 2, x_end)),
+          float(std::min(xi + 3, x_end)));
+        const F4 x = off_x + scl_x * xs;
+        store(row + i, field(x, y, z));
+      }
+    }
+  }
+}
+
+//  Triangulates `samples` into `dst`, replacing its contents. Triangles match those of
+//  `simple_grid_march_range` over the same cubes, up to order.
+void march_chunk(const ChunkSamples& samples, const GridInfo& grid, float thresh,
+                 const GenTrisParams& params, std::vector<uint32_t>& edge_vertex_scratch,
+                 IndexedSurface& dst);
+
+/*
+ * ChunkedVolume
+ *
+ * The cubes [1, grid.size - 1) divided into chunks of `chunk_dim`^3 cubes; chunk `key` holds the
+ * cubes [key * chunk_dim, (key + 1) * chunk_dim), clamped to that range. Each chunk caches its
+ * field samples and surface; dirty chunks are resampled and remeshed in parallel.
+ */
+class ChunkedVolume {
+public:
+  struct Chunk {
+    Vec3<int> p0;
+    Vec3<int> p1;
+    ChunkSamples samples;
+    IndexedSurface surface;
+    std::vector<uint32_t> edge_vertices;
+    bool dirty;
+  };
+
+public:
+  void initialize(const GridInfo& grid, int chunk_dim);
+
+  int num_chunks() const {
+    return int(chunks.size());
+  }
+  const Vec3<int>& num_chunks_per_dim() const {
+    return chunks_per_dim;
+  }
+  int chunk_index(const Vec3<int>& key) const;
+  const Chunk& chunk(int index) const {
+    return chunks[index];
+  }
+
+  void mark_chunk_dirty(const Vec3<int>& key);
+  //  Marks every chunk whose surface depends on the samples [p0, p1).
+  void mark_dirty(const Vec3<int>& p0, const Vec3<int>& p1);
+  void mark_all_dirty();
+  int num_dirty() const {
+    return int(dirty.size());
+  }
+
+  //  Resamples and remeshes dirty chunks, in parallel if `task_pool` is non-null. `field` is as
+  //  for `sample_chunk`, and must be safe to call from multiple threads.
+  template <typename F>
+  void remesh_dirty(F&& field, float thresh, const GenTrisParams& params, TaskPool* task_pool);
+  //  Indices of the chunks remeshed by the last call to `remesh_dirty`.
+  const std::vector<int>& remeshed() const {
+    return last_remeshed;
+  }
+
+private:
+  GridInfo grid{};
+  int chunk_dim{};
+  Vec3<int> chunks_per_dim{};
+  std::vector<Chunk> chunks;
+  std::vector<int> dirty;
+  std::vector<int> last_remeshed;
+};
+
+template <typename F>
+void ChunkedVolume::remesh_dirty(F&& field, float thresh, const GenTrisParams& params,
+                                 TaskPool* task_pool) {
+  last_remeshed.swap(dirty);
+  dirty.clear();
+  for (int ci : last_remeshed) {
+    chunks[ci].dirty = false;
+  }
+
+  auto remesh = [&](int task, int) {
+    auto& chunk = chunks[last_remeshed[task]];
+    sample_chunk(grid, chunk.p0, chunk.p1, field, chunk.samples);
+    march_chunk(chunk.samples, grid, thresh, params, chunk.edge_vertices, chunk.surface);
+  };
+
+  const auto num_tasks = int(last_remeshed.size());
+  if (task_pool) {
+    task_pool->parallel_for(num_tasks, remesh);
+  } else {
+    for (int i = 0; i < num_tasks; i++) {
+      remesh(i, 0);
+    }
+  }
+}
+
+}
@@ -3,6 +3,8 @@
 #include "grove/visual/image_process.hpp"
 #include "grove/math/frame.hpp"
 #include "grove/math/intersect.hpp"
+#include "grove/math/bvh.hpp"
+#include "grove/common/Temporary.hpp"
 
 GROVE_NAMESPACE_BEGIN
 
@@ -70,6 +72,11 @@ mesh::place_points_within_obb3(const PlacePointsWithinOBB3Params& params) {
   float max_t = -infinityf();
   float min_t = infinityf();
 
+  Temporary<Ray, 256> store_rays;
+  Temporary<bvh::RayHit, 256> store_hits;
+  Ray* rays = store_rays.require(params.num_samples);
+  bvh::RayHit* hits = store_hits.require(params.num_samples);
+
   for (int i = 0; i < params.num_samples; i++) {
     Vec2f pp = 0.5f * (params.sample_positions[i] * 2.0f - 1.0f) * box_size_xz;
     const Vec3f pp3 = Vec3f{pp.x, 0.0f, pp.y};
@@ -79,13 +86,27 @@ mesh::place_points_within_obb3(const PlacePointsWithinOBB3Params& params) {
     Ray ray{};
     ray.origin = rc_p;
     ray.direction = -surface_n;
+    rays[i] = ray;
+  }
+
+  if (params.bvh) {
+    bvh::ray_intersect(
+      *params.bvh, params.tris, params.ps, rays, uint32_t(params.num_samples), hits);
+  } else {
+    for (int i = 0; i < params.num_samples; i++) {
+      int hit_tri{};
+      float hit_t{};
+      const bool hit = ray_triangle_intersect(
+        rays[i], params.ps, params.tris, int(params.num_tris), &hit_tri, &hit_t);
+      hits[i].ti = hit ? uint32_t(hit_tri) : bvh::no_hit();
+      hits[i].t = hit_t;
+    }
+  }
 
-    int hit_tri{};
-    float hit_t{};
-    const bool hit = ray_triangle_intersect(
-      ray, params.ps, params.tris, int(params.num_tris), &hit_tri, &hit_t);
-    if (hit && hit_t > 0.0f) {
-      auto hit_p = ray(hit_t);
+  for (int i = 0; i < params.num_samples; i++) {
+    const float hit_t = hits[i].t;
+    if (hits[i].ti != bvh::no_hit() && hit_t > 0.0f) {
+      auto hit_p = rays[i](hit_t);
       PlacePointsWithinOBB3Entry hit_entry{};
       hit_entry.position = hit_p;
       params.result_entries[result.num_hits++] = hit_entry;
@@ -5,6 +5,10 @@
 #include "grove/math/Mat3.hpp"
 #include "grove/math/OBB3.hpp"
 
+namespace grove::bvh {
+struct TriangleBVH;
+}
+
 namespace grove::mesh {
 
 void rasterize_bounds(const Bounds2f* bounds, const float* zs, int num_bounds,
@@ -43,6 +47,9 @@ struct PlacePointsWithinOBB3Params {
   const uint32_t* tris;
   uint32_t num_tris;
   const Vec3f* ps;
+  //  Optional hierarchy over `tris`; when non-null, sample rays are traced through it in packets
+  //  instead of against every triangle.
+  const bvh::TriangleBVH* bvh;
 
   Vec3f surface_p;
   Mat3f obb3_frame;
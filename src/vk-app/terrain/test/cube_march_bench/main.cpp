@@ -0,0 +1,177 @@
+#include "vk-app/terrain/cube_march.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace grove;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int grid_dim = 97;
+  static constexpr int chunk_dim = 32;
+  static constexpr int num_repeats = 4;
+  static constexpr float edit_radius = 6.0f;
+};
+
+template <typename F>
+double time_ms(F&& f, int num_repeats = Config::num_repeats) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < num_repeats; i++) {
+    f();
+  }
+  auto t = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return t / double(num_repeats);
+}
+
+//  Rolling ground with two spheres carved out of it. `field` and `field4` compute the same thing
+//  with the same operations, so that the two march paths can be compared exactly.
+float field(const Vec3f& p) {
+  const float h = 0.01f * p.x * p.x - 0.005f * p.z * p.z + 0.2f * p.x - 4.0f;
+  const float ground = p.y - h;
+  const float ax = p.x - 10.0f;
+  const float ay = p.y + 2.0f;
+  const float az = p.z - 4.0f;
+  const float a = std::sqrt(ax * ax + ay * ay + az * az) - 14.0f;
+  const float bx = p.x + 20.0f;
+  const float by = p.y - 6.0f;
+  const float bz = p.z + 12.0f;
+  const float b = std::sqrt(bx * bx + by * by + bz * bz) - 9.0f;
+  return std::max(ground, 0.0f - std::min(a, b));
+}
+
+simd::F4 field4(simd::F4 x, simd::F4 y, simd::F4 z) {
+  using namespace simd;
+  const F4 h = set1(0.01f) * x * x - set1(0.005f) * z * z + set1(0.2f) * x - set1(4.0f);
+  const F4 ground = y - h;
+  const F4 ax = x - set1(10.0f);
+  const F4 ay = y + set1(2.0f);
+  const F4 az = z - set1(4.0f);
+  const F4 a = sqrt(ax * ax + ay * ay + az * az) - set1(14.0f);
+  const F4 bx = x + set1(20.0f);
+  const F4 by = y - set1(6.0f);
+  const F4 bz = z + set1(12.0f);
+  const F4 b = sqrt(bx * bx + by * by + bz * bz) - set1(9.0f);
+  return max(ground, zero() - min(a, b));
+}
+
+struct Triangle {
+  float data[18];
+
+  friend bool operator<(const Triangle& a, const Triangle& b) {
+    return std::memcmp(a.data, b.data, sizeof(a.data)) < 0;
+  }
+  friend bool operator==(const Triangle& a, const Triangle& b) {
+    return std::memcmp(a.data, b.data, sizeof(a.data)) == 0;
+  }
+};
+
+std::vector<Triangle> to_triangles(const std::vector<Vec3f>& ps, const std::vector<Vec3f>& ns) {
+  std::vector<Triangle> result(ps.size() / 3);
+  for (size_t i = 0; i < ps.size(); i++) {
+    std::memcpy(result[i / 3].data + (i % 3) * 6, &ps[i], sizeof(Vec3f));
+    std::memcpy(result[i / 3].data + (i % 3) * 6 + 3, &ns[i], sizeof(Vec3f));
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<Triangle> to_triangles(const cm::ChunkedVolume& volume) {
+  std::vector<Vec3f> ps;
+  std::vector<Vec3f> ns;
+  for (int i = 0; i < volume.num_chunks(); i++) {
+    auto& surface = volume.chunk(i).surface;
+    for (uint32_t vi : surface.indices) {
+      ps.push_back(surface.positions[vi]);
+      ns.push_back(surface.normals[vi]);
+    }
+  }
+  return to_triangles(ps, ns);
+}
+
+size_t num_vertices(const cm::ChunkedVolume& volume) {
+  size_t result{};
+  for (int i = 0; i < volume.num_chunks(); i++) {
+    result += volume.chunk(i).surface.positions.size();
+  }
+  return result;
+}
+
+} //  anon
+
+int main(int, char**) {
+  cm::GridInfo grid{};
+  grid.size = Vec3f{float(Config::grid_dim)};
+  grid.scale = Vec3f{1.0f};
+  grid.offset = -grid.size * 0.5f;
+
+  cm::GenTrisParams params{};
+  params.smooth = true;
+
+  TaskPool pool;
+  pool.start(TaskPool::default_num_worker_threads());
+
+  cm::ChunkedVolume volume;
+  volume.initialize(grid, Config::chunk_dim);
+  const int num_chunks = volume.num_chunks();
+
+  std::vector<Vec3f> ref_ps;
+  std::vector<Vec3f> ref_ns;
+  const double reference_ms = time_ms([&]() {
+    ref_ps.clear();
+    ref_ns.clear();
+    cm::simple_grid_march_range(
+      grid, field, 0.0f, Vec3<int>{1}, Vec3<int>{Config::grid_dim - 1}, params, &ref_ps, &ref_ns);
+  }, 1);
+  const auto ref_tris = to_triangles(ref_ps, ref_ns);
+
+  const double serial_ms = time_ms([&]() {
+    volume.mark_all_dirty();
+    volume.remesh_dirty(field4, 0.0f, params, nullptr);
+  });
+  uint32_t num_mismatch = uint32_t(to_triangles(volume) != ref_tris);
+
+  const double parallel_ms = time_ms([&]() {
+    volume.mark_all_dirty();
+    volume.remesh_dirty(field4, 0.0f, params, &pool);
+  });
+  num_mismatch += uint32_t(to_triangles(volume) != ref_tris);
+
+  //  Remesh only the chunks touched by an edit at the center of the grid.
+  const int edit_c = Config::grid_dim / 2;
+  const int edit_r = int(Config::edit_radius);
+  int num_edited_chunks{};
+  const double edit_ms = time_ms([&]() {
+    volume.mark_dirty(Vec3<int>{edit_c - edit_r}, Vec3<int>{edit_c + edit_r + 1});
+    num_edited_chunks = volume.num_dirty();
+    volume.remesh_dirty(field4, 0.0f, params, &pool);
+  });
+  num_mismatch += uint32_t(to_triangles(volume) != ref_tris);
+
+  auto chunks_per_s = [](int n, double ms) {
+    return double(n) / (ms * 1e-3);
+  };
+
+  std::cout << num_chunks << " chunks of " << Config::chunk_dim << "^3 cubes; "
+            << ref_tris.size() << " triangles; " << ref_ps.size() << " unindexed vertices, "
+            << num_vertices(volume) << " indexed; " << pool.num_workers() << " workers"
+            << std::endl;
+  std::cout << "reference: " << reference_ms << "ms (" << chunks_per_s(num_chunks, reference_ms)
+            << " chunks/s)" << std::endl;
+  std::cout << "serial: " << serial_ms << "ms (" << chunks_per_s(num_chunks, serial_ms)
+            << " chunks/s)" << std::endl;
+  std::cout << "parallel: " << parallel_ms << "ms (" << chunks_per_s(num_chunks, parallel_ms)
+            << " chunks/s)" << std::endl;
+  std::cout << "edit: " << num_edited_chunks << " chunks in " << edit_ms << "ms ("
+            << chunks_per_s(num_edited_chunks, edit_ms) << " chunks/s)" << std::endl;
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+
+  pool.stop();
+  return num_mismatch == 0 ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+#include "../../transform_system.hpp"
+#include "../../transform_hierarchy.hpp"
+#include "grove/common/TaskPool.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace grove;
+using namespace grove::transform;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Config {
+  static constexpr int num_transforms = 100000;
+  static constexpr int num_transforms_per_tree = 100;
+  static constexpr int num_frames = 20;
+  static constexpr int num_reparented = 100;
+};
+
+std::mt19937 random_engine;
+
+float urand(float lo, float hi) {
+  return std::uniform_real_distribution<float>(lo, hi)(random_engine);
+}
+
+int irand(int lo, int hi) {
+  return std::uniform_int_distribution<int>(lo, hi - 1)(random_engine);
+}
+
+TRS<float> random_trs() {
+  TRS<float> result;
+  result.translation = Vec3f{urand(-1.0f, 1.0f), urand(-1.0f, 1.0f), urand(-1.0f, 1.0f)};
+  result.rotation = Vec4f{urand(0.9f, 1.1f), urand(0.9f, 1.1f), urand(0.9f, 1.1f), 1.0f};
+  result.scale = Vec3f{urand(0.9f, 1.1f), urand(0.9f, 1.1f), urand(0.9f, 1.1f)};
+  return result;
+}
+
+bool equal(const TRS<float>& a, const TRS<float>& b) {
+  return std::memcmp(&a.translation, &b.translation, sizeof(a.translation)) == 0 &&
+         std::memcmp(&a.rotation, &b.rotation, sizeof(a.rotation)) == 0 &&
+         std::memcmp(&a.scale, &b.scale, sizeof(a.scale)) == 0;
+}
+
+//  The same forest, as `TransformInstance`s and as `TransformHandle`s.
+struct Forest {
+  std::vector<TransformInstance*> instances;
+  std::vector<TransformHandle> handles;
+  std::vector<int> parents;
+};
+
+void make_forest(TransformSystem& sys, TransformHierarchy& hierarchy, Forest& forest) {
+  for (int i = 0; i < Config::num_transforms; i++) {
+    const int tree_begin = i - i % Config::num_transforms_per_tree;
+    const int parent = i == tree_begin ? -1 : irand(tree_begin, i);
+    const auto trs = random_trs();
+    auto* inst = sys.create(trs);
+    if (parent >= 0) {
+      inst->set_parent(forest.instances[parent]);
+    }
+    forest.instances.push_back(inst);
+    forest.handles.push_back(hierarchy.create(
+      trs, parent >= 0 ? forest.handles[parent] : TransformHandle{}));
+    forest.parents.push_back(parent);
+  }
+}
+
+bool is_ancestor(const Forest& forest, int a, int i) {
+  for (int p = i; p >= 0; p = forest.parents[p]) {
+    if (p == a) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t count_mismatches(const Forest& forest, const TransformHierarchy& hierarchy) {
+  uint32_t result{};
+  for (int i = 0; i < Config::num_transforms; i++) {
+    auto& inst = forest.instances[i];
+    result += uint32_t(!equal(inst->get_current(), hierarchy.get_current(forest.handles[i])));
+  }
+  return result;
+}
+
+template <typename F>
+double ms_per_frame(F&& f) {
+  auto t0 = Clock::now();
+  for (int i = 0; i < Config::num_frames; i++) {
+    f();
+  }
+  auto t = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  return t / double(Config::num_frames);
+}
+
+} //  anon
+
+int main(int, char**) {
+  TaskPool pool;
+  pool.start(TaskPool::default_num_worker_threads());
+
+  TransformSystem sys;
+  TransformHierarchy hierarchy;
+  Forest forest;
+  make_forest(sys, hierarchy, forest);
+  sys.update();
+  hierarchy.update();
+
+  uint32_t num_mismatch = count_mismatches(forest, hierarchy);
+  {
+    auto stats = hierarchy.get_stats();
+    std::cout << stats.num_transforms << " transforms, " << stats.num_groups
+              << " groups, max depth " << stats.max_depth << std::endl;
+  }
+
+  for (double frac : {0.01, 0.1, 1.0}) {
+    const int num_moved = int(frac * Config::num_transforms);
+    std::vector<int> moved(num_moved);
+    std::vector<TRS<float>> sources(num_moved);
+    auto randomize = [&]() {
+      for (int i = 0; i < num_moved; i++) {
+        moved[i] = irand(0, Config::num_transforms);
+        sources[i] = random_trs();
+      }
+    };
+
+    randomize();
+    const double system_ms = ms_per_frame([&]() {
+      for (int i = 0; i < num_moved; i++) {
+        forest.instances[moved[i]]->set(sources[i]);
+      }
+      sys.update();
+    });
+    const double serial_ms = ms_per_frame([&]() {
+      for (int i = 0; i < num_moved; i++) {
+        hierarchy.set(forest.handles[moved[i]], sources[i]);
+      }
+      hierarchy.update();
+    });
+    num_mismatch += count_mismatches(forest, hierarchy);
+
+    randomize();
+    for (int i = 0; i < num_moved; i++) {
+      forest.instances[moved[i]]->set(sources[i]);
+    }
+    sys.update();
+    const double parallel_ms = ms_per_frame([&]() {
+      for (int i = 0; i < num_moved; i++) {
+        hierarchy.set(forest.handles[moved[i]], sources[i]);
+      }
+      hierarchy.update(&pool);
+    });
+    num_mismatch += count_mismatches(forest, hierarchy);
+
+    std::cout << num_moved << " moved; TransformSystem: " << system_ms << "ms/frame; "
+              << "TransformHierarchy: " << serial_ms << "ms/frame; " << pool.num_workers() + 1
+              << " thread(s): " << parallel_ms << "ms/frame" << std::endl;
+  }
+
+  {
+    //  Re-parent transforms within and across trees, then destroy some.
+    const double ms = ms_per_frame([&]() {
+      for (int i = 0; i < Config::num_reparented; i++) {
+        const int child = irand(0, Config::num_transforms);
+        int parent = irand(0, Config::num_transforms);
+        if (is_ancestor(forest, child, parent)) {
+          parent = -1;
+        }
+        forest.parents[child] = parent;
+        forest.instances[child]->set_parent(parent >= 0 ? forest.instances[parent] : nullptr);
+        hierarchy.set_parent(
+          forest.handles[child], parent >= 0 ? forest.handles[parent] : TransformHandle{});
+      }
+      sys.update();
+      hierarchy.update(&pool);
+    });
+    num_mismatch += count_mismatches(forest, hierarchy);
+
+    auto stats = hierarchy.get_stats();
+    std::cout << Config::num_reparented << " re-parented; both systems: " << ms
+              << "ms/frame; " << stats.num_groups << " groups, max depth " << stats.max_depth
+              << std::endl;
+
+    //  Children of destroyed transforms become roots.
+    for (int i = 0; i < Config::num_reparented; i++) {
+      const int dst = irand(0, Config::num_transforms);
+      if (!forest.instances[dst]) {
+        continue;
+      }
+      for (int j = 0; j < Config::num_transforms; j++) {
+        if (forest.parents[j] == dst) {
+          forest.parents[j] = -1;
+          //  `TransformSystem::destroy` does not mark children as pending.
+          forest.instances[j]->set_parent(nullptr);
+        }
+      }
+      sys.destroy(forest.instances[dst]);
+      hierarchy.destroy(forest.handles[dst]);
+      forest.instances[dst] = nullptr;
+      forest.parents[dst] = -1;
+    }
+    sys.update();
+    hierarchy.update(&pool);
+    for (int i = 0; i < Config::num_transforms; i++) {
+      if (forest.instances[i]) {
+        num_mismatch += uint32_t(!equal(
+          forest.instances[i]->get_current(), hierarchy.get_current(forest.handles[i])));
+      } else {
+        num_mismatch += uint32_t(hierarchy.is_valid(forest.handles[i]));
+      }
+    }
+  }
+
+  std::cout << "mismatches: " << num_mismatch << std::endl;
+  pool.stop();
+  return num_mismatch == 0 ? 0 : 1;
+}
@@ -152,7 +152,7 @@ void transform::TransformInstance::add_child(TransformInstance* child) {
 }
 
 void transform::TransformInstance::remove_child(TransformInstance* child) {
-  for (auto* c : children) {
+  for (auto& c : children) {
     if (c == child) {
       children.erase(&c);
       return;
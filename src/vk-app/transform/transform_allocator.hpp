@@ -39,6 +39,7 @@ private:
   TransformSystem* system;
   bool allocated;
   bool pushed;
+  bool processed;
 };
 
 class TransformAllocator {
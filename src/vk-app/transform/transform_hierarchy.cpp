@@ -0,0 +1,484 @@
+#include "transform_hierarchy.hpp"
+#include "grove/common/common.hpp"
+#include "grove/common/profile.hpp"
+#include "grove/common/TaskPool.hpp"
+#include "grove/math/simd.hpp"
+#include <algorithm>
+
+GROVE_NAMESPACE_BEGIN
+
+namespace {
+
+using namespace transform;
+
+constexpr uint32_t null_index = ~0u;
+constexpr int block_size = TransformHierarchy::block_size;
+constexpr int block_stride = TransformHierarchy::block_size * TransformHierarchy::num_components;
+
+using Component = TransformHierarchy::Component;
+
+inline size_t component_index(size_t i, int component) {
+  return (i / block_size) * block_stride + component * block_size + i % block_size;
+}
+
+bool is_additive(int component) {
+  return component < Component::RotationX;
+}
+
+//  Component of `TRS<float>::identity()`.
+float identity_component(int component) {
+  return component >= Component::ScaleX ? 1.0f : 0.0f;
+}
+
+void to_components(const TRS<float>& trs, float* out) {
+  for (int i = 0; i < 3; i++) {
+    out[Component::TranslationX + i] = trs.translation[i];
+    out[Component::ScaleX + i] = trs.scale[i];
+  }
+  for (int i = 0; i < 4; i++) {
+    out[Component::RotationX + i] = trs.rotation[i];
+  }
+}
+
+TRS<float> from_components(const float* src) {
+  TRS<float> result;
+  for (int i = 0; i < 3; i++) {
+    result.translation[i] = src[Component::TranslationX + i];
+    result.scale[i] = src[Component::ScaleX + i];
+  }
+  for (int i = 0; i < 4; i++) {
+    result.rotation[i] = src[Component::RotationX + i];
+  }
+  return result;
+}
+
+//  Stable counting sort of `src` by `keys[src[i]]`, with keys in [0, num_keys).
+template <typename Keys>
+void counting_sort(const std::vector<uint32_t>& src, Keys&& keys, uint32_t num_keys,
+                   std::vector<uint32_t>& counts, std::vector<uint32_t>& dst) {
+  counts.assign(num_keys + 1, 0);
+  for (uint32_t i : src) {
+    counts[keys(i) + 1]++;
+  }
+  for (uint32_t i = 0; i < num_keys; i++) {
+    counts[i + 1] += counts[i];
+  }
+  dst.resize(src.size());
+  for (uint32_t i : src) {
+    dst[counts[keys(i)]++] = i;
+  }
+}
+
+} //  anon
+
+TransformHandle transform::TransformHierarchy::create(const TRS<float>& source,
+                                                      TransformHandle parent) {
+  uint32_t si;
+  if (!free_slots.empty()) {
+    si = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    si = uint32_t(slots.size());
+    slots.emplace_back();
+  }
+
+  const size_t di = dense_slots.size();
+  if (di % block_size == 0) {
+    sources.resize(sources.size() + block_stride);
+    currents.resize(currents.size() + block_stride);
+  }
+  float src[num_components];
+  to_components(source, src);
+  for (int i = 0; i < num_components; i++) {
+    sources[component_index(di, i)] = src[i];
+    currents[component_index(di, i)] = src[i];
+  }
+  parents.push_back(-1);
+  dense_slots.push_back(si);
+  dirty.push_back(1);
+
+  auto& slot = slots[si];
+  slot.dense_index = uint32_t(di);
+  slot.parent = null_index;
+  slot.first_child = null_index;
+  slot.next_sibling = null_index;
+  slot.prev_sibling = null_index;
+  slot.group = null_index;
+  slot.alive = true;
+  if (parent.is_valid()) {
+    link_child(slot_index(parent), si);
+  }
+  order_modified = true;
+  return TransformHandle{si + 1};
+}
+
+void transform::TransformHierarchy::destroy(TransformHandle handle) {
+  const uint32_t si = slot_index(handle);
+  uint32_t child = slots[si].first_child;
+  while (child != null_index) {
+    auto& child_slot = slots[child];
+    const uint32_t next = child_slot.next_sibling;
+    child_slot.parent = null_index;
+    child_slot.next_sibling = null_index;
+    child_slot.prev_sibling = null_index;
+    mark_dirty(child);
+    child = next;
+  }
+  slots[si].first_child = null_index;
+  unlink_child(si);
+
+  auto& slot = slots[si];
+  dense_slots[slot.dense_index] = null_index;
+  slot.alive = false;
+  free_slots.push_back(si);
+  order_modified = true;
+}
+
+void transform::TransformHierarchy::set(TransformHandle handle, const TRS<float>& source) {
+  const uint32_t si = slot_index(handle);
+  float src[num_components];
+  to_components(source, src);
+  const uint32_t di = slots[si].dense_index;
+  for (int i = 0; i < num_components; i++) {
+    sources[component_index(di, i)] = src[i];
+  }
+  mark_dirty(si);
+}
+
+void transform::TransformHierarchy::set_parent(TransformHandle handle, TransformHandle parent) {
+  const uint32_t si = slot_index(handle);
+  const uint32_t pi = parent.is_valid() ? slot_index(parent) : null_index;
+  if (slots[si].parent != pi) {
+#ifdef GROVE_DEBUG
+    for (uint32_t p = pi; p != null_index; p = slots[p].parent) {
+      assert(p != si && "Parent is a descendant of the transform.");
+    }
+#endif
+    unlink_child(si);
+    if (pi != null_index) {
+      link_child(pi, si);
+    }
+    order_modified = true;
+  }
+  mark_dirty(si);
+}
+
+void transform::TransformHierarchy::update(TaskPool* task_pool) {
+  auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("TransformHierarchy/update");
+  (void) profiler;
+  if (order_modified) {
+    rebuild();
+  }
+
+  const int num_groups = int(group_num_updated.size());
+  auto run = [this](int group, int) {
+    group_num_updated[group] = update_group(group);
+  };
+  if (task_pool && num_groups > 1) {
+    task_pool->parallel_for(num_groups, run);
+  } else {
+    for (int i = 0; i < num_groups; i++) {
+      run(i, 0);
+    }
+  }
+
+  num_updated = 0;
+  for (int n : group_num_updated) {
+    num_updated += n;
+  }
+}
+
+bool transform::TransformHierarchy::is_valid(TransformHandle handle) const {
+  return handle.is_valid() && handle.id <= slots.size() && slots[handle.id - 1].alive;
+}
+
+TransformHandle transform::TransformHierarchy::get_parent(TransformHandle handle) const {
+  const uint32_t pi = slots[slot_index(handle)].parent;
+  return pi == null_index ? TransformHandle{} : TransformHandle{pi + 1};
+}
+
+TRS<float> transform::TransformHierarchy::get_source(TransformHandle handle) const {
+  const uint32_t di = slots[slot_index(handle)].dense_index;
+  float src[num_components];
+  for (int i = 0; i < num_components; i++) {
+    src[i] = sources[component_index(di, i)];
+  }
+  return from_components(src);
+}
+
+TRS<float> transform::TransformHierarchy::get_current(TransformHandle handle) const {
+  const uint32_t di = slots[slot_index(handle)].dense_index;
+  float src[num_components];
+  for (int i = 0; i < num_components; i++) {
+    src[i] = currents[component_index(di, i)];
+  }
+  return from_components(src);
+}
+
+TransformHierarchy::Stats transform::TransformHierarchy::get_stats() const {
+  Stats result{};
+  result.num_transforms = int(slots.size() - free_slots.size());
+  result.num_groups = int(group_num_updated.size());
+  result.max_depth = max_depth;
+  result.num_rebuilds = num_rebuilds;
+  result.num_updated = num_updated;
+  return result;
+}
+
+uint32_t transform::TransformHierarchy::slot_index(TransformHandle handle) const {
+  assert(is_valid(handle));
+  return handle.id - 1;
+}
+
+void transform::TransformHierarchy::link_child(uint32_t parent, uint32_t child) {
+  auto& parent_slot = slots[parent];
+  auto& child_slot = slots[child];
+  assert(child_slot.parent == null_index);
+  child_slot.parent = parent;
+  child_slot.prev_sibling = null_index;
+  child_slot.next_sibling = parent_slot.first_child;
+  if (parent_slot.first_child != null_index) {
+    slots[parent_slot.first_child].prev_sibling = child;
+  }
+  parent_slot.first_child = child;
+}
+
+void transform::TransformHierarchy::unlink_child(uint32_t child) {
+  auto& child_slot = slots[child];
+  if (child_slot.parent == null_index) {
+    return;
+  }
+  if (child_slot.prev_sibling != null_index) {
+    slots[child_slot.prev_sibling].next_sibling = child_slot.next_sibling;
+  } else {
+    slots[child_slot.parent].first_child = child_slot.next_sibling;
+  }
+  if (child_slot.next_sibling != null_index) {
+    slots[child_slot.next_sibling].prev_sibling = child_slot.prev_sibling;
+  }
+  child_slot.parent = null_index;
+  child_slot.next_sibling = null_index;
+  child_slot.prev_sibling = null_index;
+}
+
+void transform::TransformHierarchy::mark_dirty(uint32_t si) {
+  const auto& slot = slots[si];
+  dirty[slot.dense_index] = 1;
+  if (slot.group != null_index) {
+    group_dirty[slot.group] = 1;
+  }
+}
+
+/*
+ * rebuild
+ *
+ * Orders live transforms by (group, depth). Roots are assigned to groups in their current order,
+ * so that each group holds about `target_group_size` transforms, unless a single tree is larger.
+ * The sort is stable, so transforms keep their relative order if the structure does not change.
+ * Groups are padded to a whole number of blocks, so that threads never write to the same block.
+ */
+void transform::TransformHierarchy::rebuild() {
+  auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("TransformHierarchy/rebuild");
+  (void) profiler;
+
+  order.clear();
+  for (uint32_t si : dense_slots) {
+    if (si != null_index) {
+      order.push_back(si);
+    }
+  }
+
+  //  Depth and root of each live transform, walking up to the nearest transform already visited.
+  slot_depths.assign(slots.size(), -1);
+  slot_roots.resize(slots.size());
+  max_depth = 0;
+  for (uint32_t si : order) {
+    chain.clear();
+    uint32_t p = si;
+    while (p != null_index && slot_depths[p] < 0) {
+      chain.push_back(p);
+      p = slots[p].parent;
+    }
+    int32_t depth = p == null_index ? -1 : slot_depths[p];
+    const uint32_t root = p == null_index ? chain.back() : slot_roots[p];
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      slot_depths[*it] = ++depth;
+      slot_roots[*it] = root;
+    }
+    max_depth = std::max(max_depth, int(depth));
+  }
+
+  //  Tree sizes, then groups of trees.
+  counts.assign(slots.size(), 0);
+  for (uint32_t si : order) {
+    counts[slot_roots[si]]++;
+  }
+  root_groups.resize(slots.size());
+  uint32_t num_groups{};
+  uint32_t group_size{};
+  for (uint32_t si : order) {
+    if (slots[si].parent == null_index) {
+      if (group_size >= uint32_t(target_group_size)) {
+        group_size = 0;
+      }
+      if (group_size == 0) {
+        num_groups++;
+      }
+      root_groups[si] = num_groups - 1;
+      group_size += counts[si];
+    }
+  }
+
+  //  Stable sort by depth, then by group. Afterwards, counts[i] is one past the last transform of
+  //  group i in `order`.
+  counting_sort(order, [this](uint32_t si) {
+    return uint32_t(slot_depths[si]);
+  }, uint32_t(max_depth + 1), counts, sorted);
+  counting_sort(sorted, [this](uint32_t si) {
+    return root_groups[slot_roots[si]];
+  }, num_groups, counts, order);
+
+  //  New dense order, with padding.
+  sorted.clear();
+  group_offsets.resize(num_groups + 1);
+  group_offsets[0] = 0;
+  uint32_t beg{};
+  for (uint32_t i = 0; i < num_groups; i++) {
+    const uint32_t end = counts[i];
+    sorted.insert(sorted.end(), order.begin() + beg, order.begin() + end);
+    while (sorted.size() % block_size != 0) {
+      sorted.push_back(null_index);
+    }
+    group_offsets[i + 1] = uint32_t(sorted.size());
+    beg = end;
+  }
+  group_dirty.assign(num_groups, 1);
+  group_num_updated.assign(num_groups, 0);
+
+  const auto num_dense = uint32_t(sorted.size());
+  auto permute_components = [&](std::vector<float>& data) {
+    tmp_floats.assign(size_t(num_dense / block_size) * block_stride, 0.0f);
+    for (uint32_t i = 0; i < num_dense; i++) {
+      if (sorted[i] != null_index) {
+        const uint32_t src = slots[sorted[i]].dense_index;
+        for (int c = 0; c < num_components; c++) {
+          tmp_floats[component_index(i, c)] = data[component_index(src, c)];
+        }
+      }
+    }
+    data.swap(tmp_floats);
+  };
+  permute_components(sources);
+  permute_components(currents);
+
+  std::vector<uint8_t> new_dirty(num_dense);
+  for (uint32_t i = 0; i < num_dense; i++) {
+    if (sorted[i] != null_index) {
+      new_dirty[i] = dirty[slots[sorted[i]].dense_index];
+    }
+  }
+  dirty = std::move(new_dirty);
+
+  for (uint32_t i = 0; i < num_dense; i++) {
+    if (sorted[i] != null_index) {
+      auto& slot = slots[sorted[i]];
+      slot.dense_index = i;
+      slot.group = root_groups[slot_roots[sorted[i]]];
+    }
+  }
+  parents.resize(num_dense);
+  dense_slots.resize(num_dense);
+  for (uint32_t i = 0; i < num_dense; i++) {
+    const uint32_t si = sorted[i];
+    const uint32_t pi = si == null_index ? null_index : slots[si].parent;
+    parents[i] = pi == null_index ? -1 : int32_t(slots[pi].dense_index);
+    dense_slots[i] = si;
+  }
+
+  order_modified = false;
+  num_rebuilds++;
+}
+
+/*
+ * update_group
+ *
+ * Within a group, a parent precedes its children, so dirty flags are propagated and transforms
+ * composed in one front to back pass. A block whose transforms' parents all precede it is composed
+ * with SIMD; this is every block that does not straddle two depths of the same tree. Clean
+ * transforms in a dirty block are recomputed from unchanged inputs, so their values do not change.
+ * Returns the number of dirty transforms.
+ */
+int transform::TransformHierarchy::update_group(int group) {
+  if (!group_dirty[group]) {
+    return 0;
+  }
+
+  const auto beg = int(group_offsets[group]);
+  const auto end = int(group_offsets[group + 1]);
+  assert(beg % block_size == 0 && end % block_size == 0);
+  const int32_t* par = parents.data();
+  uint8_t* dirt = dirty.data();
+  const float* src = sources.data();
+  float* cur = currents.data();
+
+  auto compose1 = [&](int i) {
+    const int32_t p = par[i];
+    for (int c = 0; c < num_components; c++) {
+      const float pv = p >= 0 ? cur[component_index(p, c)] : identity_component(c);
+      const float sv = src[component_index(i, c)];
+      cur[component_index(i, c)] = is_additive(c) ? pv + sv : pv * sv;
+    }
+  };
+
+  auto compose4 = [&](int i) {
+    const float* src_block = src + size_t(i / block_size) * block_stride;
+    float* cur_block = cur + size_t(i / block_size) * block_stride;
+    const float* parent_blocks[block_size];
+    int parent_lanes[block_size];
+    for (int j = 0; j < block_size; j++) {
+      const int32_t p = par[i + j];
+      parent_blocks[j] = p >= 0 ? cur + size_t(p / block_size) * block_stride : nullptr;
+      parent_lanes[j] = p % block_size;
+    }
+    for (int c = 0; c < num_components; c++) {
+      alignas(16) float pv[block_size];
+      for (int j = 0; j < block_size; j++) {
+        pv[j] = parent_blocks[j] ?
+          parent_blocks[j][c * block_size + parent_lanes[j]] : identity_component(c);
+      }
+      const simd::F4 a = simd::load(pv);
+      const simd::F4 b = simd::load(src_block + c * block_size);
+      simd::store(cur_block + c * block_size, is_additive(c) ? a + b : a * b);
+    }
+  };
+
+  int num_dirty{};
+  for (int i = beg; i < end; i += block_size) {
+    bool any_dirty{};
+    bool parents_precede{true};
+    for (int j = i; j < i + block_size; j++) {
+      const int32_t p = par[j];
+      dirt[j] |= p >= 0 ? dirt[p] : uint8_t(0);
+      any_dirty |= dirt[j] != 0;
+      num_dirty += int(dirt[j] != 0);
+      parents_precede &= p < i;
+    }
+    if (!any_dirty) {
+      continue;
+    } else if (parents_precede) {
+      compose4(i);
+    } else {
+      for (int j = i; j < i + block_size; j++) {
+        if (dirt[j]) {
+          compose1(j);
+        }
+      }
+    }
+  }
+
+  std::fill(dirt + beg, dirt + end, uint8_t(0));
+  group_dirty[group] = 0;
+  return num_dirty;
+}
+
+GROVE_NAMESPACE_END
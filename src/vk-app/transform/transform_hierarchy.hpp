@@ -0,0 +1,126 @@
+#pragma once
+
+#include "trs.hpp"
+#include "grove/common/identifier.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace grove {
+class TaskPool;
+}
+
+namespace grove::transform {
+
+struct TransformHandle {
+  GROVE_INTEGER_IDENTIFIER_EQUALITY(TransformHandle, id)
+  GROVE_INTEGER_IDENTIFIER_IS_VALID(id)
+  uint32_t id;
+};
+
+/*
+ * TransformHierarchy
+ *
+ * Data-oriented counterpart to `TransformSystem`, for large numbers of transforms. Transforms are
+ * referred to by handle and stored in blocks of 4, with each TRS component of a block contiguous.
+ * They are ordered so that the trees of a group of roots are contiguous and, within a group, sorted
+ * by depth; each group begins on a new block. `update` then visits each group front to back once:
+ * a transform is dirty if it or its parent is, and dirty blocks are composed with their parents'
+ * current transforms 4 at a time. Groups are independent and are updated in parallel given a
+ * `TaskPool`.
+ *
+ * The order is rebuilt by the first `update` after transforms are created, destroyed or
+ * re-parented. Current transforms are as of the last `update`, and match those computed by
+ * `TransformSystem` for the same sources and parents.
+ */
+class TransformHierarchy {
+public:
+  enum Component {
+    TranslationX = 0,
+    TranslationY,
+    TranslationZ,
+    RotationX,
+    RotationY,
+    RotationZ,
+    RotationW,
+    ScaleX,
+    ScaleY,
+    ScaleZ,
+  };
+
+  static constexpr int num_components = 10;
+  static constexpr int block_size = 4;
+  static constexpr int target_group_size = 2048;
+
+  struct Stats {
+    int num_transforms;
+    int num_groups;
+    int max_depth;
+    int num_rebuilds;
+    int num_updated;
+  };
+
+public:
+  TransformHandle create(const TRS<float>& source, TransformHandle parent = {});
+  //  Children of `handle` become roots.
+  void destroy(TransformHandle handle);
+  void set(TransformHandle handle, const TRS<float>& source);
+  void set_parent(TransformHandle handle, TransformHandle parent);
+  void update(TaskPool* task_pool = nullptr);
+
+  bool is_valid(TransformHandle handle) const;
+  TransformHandle get_parent(TransformHandle handle) const;
+  TRS<float> get_source(TransformHandle handle) const;
+  TRS<float> get_current(TransformHandle handle) const;
+  Stats get_stats() const;
+
+private:
+  struct Slot {
+    uint32_t dense_index;
+    uint32_t parent;
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint32_t prev_sibling;
+    uint32_t group;
+    bool alive;
+  };
+
+  uint32_t slot_index(TransformHandle handle) const;
+  void link_child(uint32_t parent, uint32_t child);
+  void unlink_child(uint32_t child);
+  void mark_dirty(uint32_t slot);
+  void rebuild();
+  int update_group(int group);
+
+private:
+  std::vector<Slot> slots;
+  std::vector<uint32_t> free_slots;
+
+  //  Indexed by dense index. Component `c` of the transform at dense index `i` is at
+  //  `(i / block_size) * block_size * num_components + c * block_size + i % block_size` in
+  //  `sources` and `currents`.
+  std::vector<float> sources;
+  std::vector<float> currents;
+  std::vector<int32_t> parents;  //  Dense index of the parent, or -1.
+  std::vector<uint32_t> dense_slots;  //  Slot of each dense entry, or ~0u if destroyed or padding.
+  std::vector<uint8_t> dirty;
+
+  std::vector<uint32_t> group_offsets;
+  std::vector<uint8_t> group_dirty;
+  std::vector<int> group_num_updated;
+  bool order_modified{};
+  int max_depth{};
+  int num_rebuilds{};
+  int num_updated{};
+
+  //  Scratch for `rebuild`.
+  std::vector<int32_t> slot_depths;
+  std::vector<uint32_t> slot_roots;
+  std::vector<uint32_t> root_groups;
+  std::vector<uint32_t> chain;
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> sorted;
+  std::vector<uint32_t> counts;
+  std::vector<float> tmp_floats;
+};
+
+}
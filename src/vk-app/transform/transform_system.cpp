@@ -31,52 +31,37 @@ void transform::TransformSystem::push_pending(TransformInstance* inst) {
   pending_update[num_pending++] = inst;
 }
 
+/*
+ * Each pending instance is updated along with its ancestors, from the root down. An instance is
+ * flagged once processed, so that instances shared between the ancestor chains of several pending
+ * instances are only computed once.
+ */
 void transform::TransformSystem::update() {
   auto profiler = GROVE_PROFILE_SCOPE_TIC_TOC("TransformSystem/update");
   (void) profiler;
-  processed.clear();
   for (int pend_ind = 0; pend_ind < num_pending; pend_ind++) {
     TransformInstance* next = pending_update[pend_ind];
     int temp_ind{};
-    while (true) {
-      auto proc_it = processed.find(next);
-      if (proc_it != processed.end()) {
-        break;
-      } else {
-        processed[next] = std::pair<TRS<float>, bool>{next->source, false};
-      }
+    while (next && !next->processed) {
+      next->processed = true;
+      processed.push_back(next);
       if (temp_ind == int(temporary.size())) {
         temporary.push_back(nullptr);
       }
       temporary[temp_ind++] = next;
-      if (next->parent) {
-        next = next->parent;
-      } else {
-        break;
-      }
+      next = next->parent;
     }
-    const int temp_count = temp_ind;
-    auto current = TRS<float>::identity();
-    for (int i = 0; i < temp_count; i++) {
-      int curr_ind = temp_count - i - 1;
-      TransformInstance* curr = temporary[curr_ind];
-      auto& proc = processed.at(curr);
-      if (!proc.second) {
-        if (curr->parent) {
-          auto& proc_parent = processed.at(curr->parent);
-          assert(proc_parent.second);
-          current = proc_parent.first;
-        }
-        current = apply(current, curr->source);
-        proc.second = true;
-        proc.first = current;
-      } else {
-        current = proc.first;
-      }
-      curr->current = current;
+    for (int i = temp_ind - 1; i >= 0; i--) {
+      TransformInstance* curr = temporary[i];
+      auto current = curr->parent ? curr->parent->current : TRS<float>::identity();
+      curr->current = apply(current, curr->source);
       curr->clear_pushed_pending();
     }
   }
+  for (auto* inst : processed) {
+    inst->processed = false;
+  }
+  processed.clear();
   num_pending = 0;
 }
 
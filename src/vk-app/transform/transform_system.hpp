@@ -1,7 +1,7 @@
 #pragma once
 
 #include "transform_allocator.hpp"
-#include <unordered_map>
+#include <vector>
 
 namespace grove::transform {
 
@@ -17,7 +17,7 @@ private:
   std::vector<TransformInstance*> pending_update;
   int num_pending{};
   std::vector<TransformInstance*> temporary;
-  std::unordered_map<TransformInstance*, std::pair<TRS<float>, bool>> processed;
+  std::vector<TransformInstance*> processed;
 };
 
 }
\ No newline at end of file